@@ -11,6 +11,7 @@
 #include "path_finder.h"
 
 #include <algorithm>
+#include <set>
 
 #include "config.h"
 #include "map.h"
@@ -20,6 +21,7 @@
 #include "command.h"
 #include "faction.h"
 #include "randomgen.h"
+#include "sim_benchmark.h"
 #include "leak_dumper.h"
 
 using namespace std;
@@ -64,11 +66,13 @@ PathFinder::PathFinder(const Map *map) {
 }
 
 void PathFinder::init(const Map *map) {
-	for(int factionIndex = 0; factionIndex < GameConstants::maxPlayers; ++factionIndex) {
-		FactionState &faction = factions.getFactionState(factionIndex);
+	for(int workerIndex = 0; workerIndex < WorkStealingScheduler::maxWorkerCount; ++workerIndex) {
+		for(int factionIndex = 0; factionIndex < GameConstants::maxPlayers; ++factionIndex) {
+			FactionState &faction = factions.getFactionState(factionIndex, workerIndex);
 
-		faction.nodePool.resize(pathFindNodesAbsoluteMax);
-		faction.useMaxNodeCount = PathFinder::pathFindNodesMax;
+			faction.nodePool.resize(pathFindNodesAbsoluteMax);
+			faction.useMaxNodeCount = PathFinder::pathFindNodesMax;
+		}
 	}
 	this->map= map;
 }
@@ -79,23 +83,28 @@ void PathFinder::init() {
 }
 
 PathFinder::~PathFinder() {
-	for(int factionIndex = 0; factionIndex < GameConstants::maxPlayers; ++factionIndex) {
-		FactionState &faction = factions.getFactionState(factionIndex);
+	for(int workerIndex = 0; workerIndex < WorkStealingScheduler::maxWorkerCount; ++workerIndex) {
+		for(int factionIndex = 0; factionIndex < GameConstants::maxPlayers; ++factionIndex) {
+			FactionState &faction = factions.getFactionState(factionIndex, workerIndex);
 
-		faction.nodePool.clear();
+			faction.nodePool.clear();
+		}
 	}
 	factions.clear();
 	map=NULL;
 }
 
 void PathFinder::clearCaches() {
-	for(int factionIndex = 0; factionIndex < GameConstants::maxPlayers; ++factionIndex) {
-		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
-		FactionState &faction = factions.getFactionState(factionIndex);
-		MutexSafeWrapper safeMutex(faction.getMutexPreCache(),mutexOwnerId);
-
-		faction.precachedTravelState.clear();
-		faction.precachedPath.clear();
+	for(int workerIndex = 0; workerIndex < WorkStealingScheduler::maxWorkerCount; ++workerIndex) {
+		for(int factionIndex = 0; factionIndex < GameConstants::maxPlayers; ++factionIndex) {
+			static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+			FactionState &faction = factions.getFactionState(factionIndex, workerIndex);
+			MutexSafeWrapper safeMutex(faction.getMutexPreCache(),mutexOwnerId);
+
+			faction.precachedTravelState.clear();
+			faction.precachedPath.clear();
+			faction.precacheRequests.clear();
+		}
 	}
 }
 
@@ -103,7 +112,7 @@ void PathFinder::clearUnitPrecache(Unit *unit) {
 	if(unit != NULL && factions.size() > unit->getFactionIndex()) {
 		int factionIndex = unit->getFactionIndex();
 		static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
-		FactionState &faction = factions.getFactionState(factionIndex);
+		FactionState &faction = getWorkerFactionState(factionIndex);
 		MutexSafeWrapper safeMutex(faction.getMutexPreCache(),mutexOwnerId);
 
 		faction.precachedTravelState[unit->getId()] = tsImpossible;
@@ -127,13 +136,65 @@ void PathFinder::removeUnitPrecache(Unit *unit) {
 	}
 }
 
+// Called on the main thread once the pre-cache searches of a frame are
+// done. Moves the results of the other workers into worker 0 and applies
+// the per frame pathfinding limit in unit order, so the outcome is the same
+// whichever thread searched for which unit.
+void PathFinder::commitPrecache(Faction *faction) {
+	if(faction == NULL || faction->getIndex() < 0 || faction->getIndex() >= factions.size()) {
+		return;
+	}
+	int factionIndex = faction->getIndex();
+	FactionState &mainState = factions.getFactionState(factionIndex);
+
+	std::set<int> requestedUnits;
+	for(int workerIndex = 0; workerIndex < WorkStealingScheduler::maxWorkerCount; ++workerIndex) {
+		FactionState &workerState = factions.getFactionState(factionIndex, workerIndex);
+		requestedUnits.insert(workerState.precacheRequests.begin(),workerState.precacheRequests.end());
+		workerState.precacheRequests.clear();
+
+		if(workerIndex == 0) {
+			continue;
+		}
+		for(std::map<int,TravelState>::iterator iterMap = workerState.precachedTravelState.begin();
+			iterMap != workerState.precachedTravelState.end(); ++iterMap) {
+			mainState.precachedTravelState[iterMap->first] = iterMap->second;
+		}
+		for(std::map<int,std::vector<Vec2i> >::iterator iterMap = workerState.precachedPath.begin();
+			iterMap != workerState.precachedPath.end(); ++iterMap) {
+			mainState.precachedPath[iterMap->first].swap(iterMap->second);
+		}
+		workerState.precachedTravelState.clear();
+		workerState.precachedPath.clear();
+	}
+
+	if(requestedUnits.empty() == true) {
+		return;
+	}
+	for(int index = 0; index < faction->getUnitCount(); ++index) {
+		int unitId = faction->getUnit(index)->getId();
+		if(requestedUnits.find(unitId) == requestedUnits.end()) {
+			continue;
+		}
+		if(faction->canUnitsPathfind() == true) {
+			faction->addUnitToPathfindingList(unitId);
+		}
+		else {
+			mainState.precachedTravelState[unitId] = tsImpossible;
+			mainState.precachedPath[unitId].clear();
+		}
+	}
+}
+
 TravelState PathFinder::findPath(Unit *unit, const Vec2i &finalPos, bool *wasStuck, int frameIndex) {
+	SimBenchmarkTimer benchmarkTimer(sbsPathFinding);
+
 	TravelState ts = tsImpossible;
 
 	try {
 
 	int factionIndex = unit->getFactionIndex();
-	FactionState &faction = factions.getFactionState(factionIndex);
+	FactionState &faction = getWorkerFactionState(factionIndex);
 	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
 	MutexSafeWrapper safeMutexPrecache(faction.getMutexPreCache(),mutexOwnerId);
 
@@ -143,11 +204,16 @@ TravelState PathFinder::findPath(Unit *unit, const Vec2i &finalPos, bool *wasStu
 
 	unit->setCurrentPathFinderDesiredFinalPos(finalPos);
 
-
+	faction.searchRandom = &faction.random;
 	if(frameIndex >= 0) {
 		clearUnitPrecache(unit);
+
+		// the pathfinding limit is applied in unit order by commitPrecache
+		faction.precacheRequests.push_back(unit->getId());
+		faction.precacheRandom.init(unit->getId() * 7919 + frameIndex);
+		faction.searchRandom = &faction.precacheRandom;
 	}
-	if(unit->getFaction()->canUnitsPathfind() == true) {
+	else if(unit->getFaction()->canUnitsPathfind() == true) {
 		unit->getFaction()->addUnitToPathfindingList(unit->getId());
 	}
 	else {
@@ -281,7 +347,10 @@ TravelState PathFinder::findPath(Unit *unit, const Vec2i &finalPos, bool *wasStu
 		unit->logSynchData(extractFileFromDirectoryPath(__FILE__).c_str(),__LINE__,szBuf);
 	}
 
-	ts = aStar(unit, finalPos, false, frameIndex, maxNodeCount,&searched_node_count);
+	// Long routes are planned over the cluster graph first so the cell level
+	// search only has to reach the next portal
+	Vec2i routePos = computeClusterWaypoint(unit, finalPos);
+	ts = aStar(unit, routePos, false, frameIndex, maxNodeCount,&searched_node_count, routePos != finalPos);
 	//post actions
 	switch(ts) {
 		case tsBlocked:
@@ -328,14 +397,14 @@ TravelState PathFinder::findPath(Unit *unit, const Vec2i &finalPos, bool *wasStu
 				if(unitImmediatelyBlocked == false) {
 
 					int factionIndex = unit->getFactionIndex();
-					FactionState &faction = factions.getFactionState(factionIndex);
+					FactionState &faction = getWorkerFactionState(factionIndex);
 
 					//if(Thread::isCurrentThreadMainThread() == false) {
 					//	throw megaglest_runtime_error("#2 Invalid access to FactionState random from outside main thread current id = " +
 					//			intToStr(Thread::getCurrentThreadId()) + " main = " + intToStr(Thread::getMainThreadId()));
 					//}
 
-					int tryRadius = faction.random.randRange(1,2);
+					int tryRadius = faction.searchRandom->randRange(1,2);
 					//int tryRadius = faction.random.IRandomX(1,2);
 					//int tryRadius = 1;
 
@@ -514,14 +583,14 @@ TravelState PathFinder::findPath(Unit *unit, const Vec2i &finalPos, bool *wasStu
 
 //route a unit using A* algorithm
 TravelState PathFinder::aStar(Unit *unit, const Vec2i &targetPos, bool inBailout,
-		int frameIndex, int maxNodeCount, uint32 *searched_node_count) {
+		int frameIndex, int maxNodeCount, uint32 *searched_node_count, bool waypoint) {
 	TravelState ts = tsImpossible;
 
 	try {
 
 	int unitFactionIndex = unit->getFactionIndex();
 	int factionIndex = unit->getFactionIndex();
-	FactionState &faction = factions.getFactionState(factionIndex);
+	FactionState &faction = getWorkerFactionState(factionIndex);
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled == true && frameIndex >= 0) {
 		char szBuf[8096]="";
@@ -540,7 +609,7 @@ TravelState PathFinder::aStar(Unit *unit, const Vec2i &targetPos, bool inBailout
 	if(maxNodeCount < 0) {
 
 		int factionIndex = unit->getFactionIndex();
-		FactionState &faction = factions.getFactionState(factionIndex);
+		FactionState &faction = getWorkerFactionState(factionIndex);
 
 		maxNodeCount = faction.useMaxNodeCount;
 	}
@@ -553,8 +622,9 @@ TravelState PathFinder::aStar(Unit *unit, const Vec2i &targetPos, bool inBailout
 
 	faction.nodePoolCount= 0;
 	faction.openNodesList.clear();
-	faction.openPosList.clear();
-	faction.closedNodesList.clear();
+	faction.openPosList.beginSearch(map->getW(), map->getH());
+	faction.bestClosedNode = NULL;
+	faction.closedNodesCount = 0;
 
 	// check the pre-cache to see if we can re-use a cached path
 	if(frameIndex < 0) {
@@ -685,11 +755,7 @@ TravelState PathFinder::aStar(Unit *unit, const Vec2i &targetPos, bool inBailout
 	firstNode->pos= unitPos;
 	firstNode->heuristic= heuristic(unitPos, finalPos);
 	firstNode->exploredCell= true;
-	if(faction.openNodesList.find(firstNode->heuristic) == faction.openNodesList.end()) {
-		faction.openNodesList[firstNode->heuristic].clear();
-	}
-	faction.openNodesList[firstNode->heuristic].push_back(firstNode);
-	faction.openPosList[firstNode->pos] = true;
+	addOpenNode(faction, firstNode);
 
 	//b) loop
 	bool pathFound			= true;
@@ -726,7 +792,9 @@ TravelState PathFinder::aStar(Unit *unit, const Vec2i &targetPos, bool inBailout
 
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled == true && chrono.getMillis() > 1) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] **Check if dest blocked, distance for unit [%d - %s] from [%s] to [%s] is %.2f took msecs: %lld nodeLimitReached = %d, failureCount = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,unit->getId(),unit->getFullName(false).c_str(), unitPos.getString().c_str(), finalPos.getString().c_str(), dist,(long long int)chrono.getMillis(),nodeLimitReached,failureCount);
 
-		if(nodeLimitReached == false) {
+		// A portal waypoint is only passed through, units crowding it
+		// don't make the route blocked
+		if(nodeLimitReached == false && waypoint == false) {
 			// First check if final destination blocked
 			failureCount = 0;
 			cellCount = 0;
@@ -817,7 +885,7 @@ TravelState PathFinder::aStar(Unit *unit, const Vec2i &targetPos, bool inBailout
 					unit->logSynchData(extractFileFromDirectoryPath(__FILE__).c_str(),__LINE__,szBuf);
 				}
 
-				return aStar(unit, targetPos, false, frameIndex, pathFindNodesAbsoluteMax);
+				return aStar(unit, targetPos, false, frameIndex, pathFindNodesAbsoluteMax, NULL, waypoint);
 			}
 		}
 	}
@@ -835,10 +903,10 @@ TravelState PathFinder::aStar(Unit *unit, const Vec2i &targetPos, bool inBailout
 	//if consumed all nodes find best node (to avoid strange behaviour)
 	if(nodeLimitReached == true) {
 
-		if(faction.closedNodesList.empty() == false) {
-			float bestHeuristic = truncateDecimal<float>(faction.closedNodesList.begin()->first,6);
+		if(faction.bestClosedNode != NULL) {
+			float bestHeuristic = truncateDecimal<float>(faction.bestClosedNode->heuristic,6);
 			if(lastNode != NULL && bestHeuristic < lastNode->heuristic) {
-				lastNode= faction.closedNodesList.begin()->second.front();
+				lastNode= faction.bestClosedNode;
 			}
 		}
 	}
@@ -980,14 +1048,14 @@ TravelState PathFinder::aStar(Unit *unit, const Vec2i &targetPos, bool inBailout
 
 
 	faction.openNodesList.clear();
-	faction.openPosList.clear();
-	faction.closedNodesList.clear();
+	faction.bestClosedNode = NULL;
+	faction.closedNodesCount = 0;
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled == true && chrono.getMillis() > 4) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s] Line: %d took msecs: %lld --------------------------- [END OF METHOD] ---------------------------\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
 
 	if(frameIndex >= 0) {
 
-		FactionState &faction = factions.getFactionState(factionIndex);
+		FactionState &faction = getWorkerFactionState(factionIndex);
 		faction.precachedTravelState[unit->getId()] = ts;
 	}
 	else {
@@ -1104,6 +1172,36 @@ Vec2i PathFinder::computeNearestFreePos(const Unit *unit, const Vec2i &finalPos)
 	return nearestPos;
 }
 
+Vec2i PathFinder::computeClusterWaypoint(Unit *unit, const Vec2i &finalPos) {
+	ClusterMap *clusterMap = map->getClusterMap();
+	if(clusterMap == NULL || unit->getType()->getSize() != 1) {
+		return finalPos;
+	}
+
+	const Vec2i unitPos = unit->getPos();
+	const int clusterSize = clusterMap->getClusterSize();
+	if(unitPos.dist(finalPos) < clusterSize * 2) {
+		return finalPos;
+	}
+
+	// No abstract route means the goal is walled off by terrain or
+	// buildings, the normal search already deals with that case
+	std::vector<Vec2i> waypoints;
+	if(clusterMap->findPath(unit->getCurrField(), unitPos, finalPos, waypoints) == false) {
+		return finalPos;
+	}
+
+	// Skip portals right next to the unit, but never look further ahead
+	// than a few portals so the cell search stays short
+	const unsigned int maxWaypointIndex = 3;
+	for(unsigned int i = 0; i < waypoints.size() && i <= maxWaypointIndex; ++i) {
+		if(unitPos.dist(waypoints[i]) >= clusterSize) {
+			return waypoints[i];
+		}
+	}
+	return finalPos;
+}
+
 int PathFinder::findNodeIndex(Node *node, Nodes &nodeList) {
 	int index = -1;
 	if(node != NULL) {
@@ -20,15 +20,20 @@
 #include "vec.h"
 #include <vector>
 #include <map>
+#include <algorithm>
 #include "game_constants.h"
 #include "skill_type.h"
 #include "map.h"
 #include "unit.h"
+#include "binary_heap.h"
+#include "work_stealing_scheduler.h"
 //#include "randomc.h"
 #include "leak_dumper.h"
 
 using std::vector;
 using Shared::Graphics::Vec2i;
+using Shared::Util::BinaryHeap;
+using Shared::PlatformCommon::WorkStealingScheduler;
 
 namespace Glest { namespace Game {
 
@@ -86,6 +91,54 @@ public:
 	};
 	typedef vector<Node*> Nodes;
 
+	// Flat per map table of cells already reached by the current search.
+	// Each search bumps the generation so the table never needs clearing.
+	class VisitedPosTable {
+	public:
+		VisitedPosTable() {
+			width = 0;
+			height = 0;
+			generation = 0;
+		}
+		void beginSearch(int w, int h) {
+			if(w != width || h != height) {
+				width = w;
+				height = h;
+				stamps.assign((size_t)w * (size_t)h, 0);
+				generation = 0;
+			}
+			generation++;
+			if(generation == 0) {
+				std::fill(stamps.begin(), stamps.end(), 0);
+				generation = 1;
+			}
+		}
+		inline bool isVisited(const Vec2i &pos) const {
+			if(pos.x < 0 || pos.y < 0 || pos.x >= width || pos.y >= height) {
+				return false;
+			}
+			return stamps[(size_t)pos.y * width + pos.x] == generation;
+		}
+		inline void setVisited(const Vec2i &pos) {
+			if(pos.x < 0 || pos.y < 0 || pos.x >= width || pos.y >= height) {
+				return;
+			}
+			stamps[(size_t)pos.y * width + pos.x] = generation;
+		}
+		void clear() {
+			stamps.clear();
+			width = 0;
+			height = 0;
+			generation = 0;
+		}
+
+	private:
+		std::vector<uint32> stamps;
+		int width;
+		int height;
+		uint32 generation;
+	};
+
 	class FactionState {
 	protected:
 		Mutex *factionMutexPrecache;
@@ -96,11 +149,13 @@ public:
 
 			openPosList.clear();
 			openNodesList.clear();
-			closedNodesList.clear();
+			bestClosedNode = NULL;
+			closedNodesCount = 0;
 			nodePool.clear();
 			nodePoolCount = 0;
 			this->factionIndex = factionIndex;
 			useMaxNodeCount = 0;
+			searchRandom = &random;
 
 			precachedTravelState.clear();
 			precachedPath.clear();
@@ -114,29 +169,40 @@ public:
 			return factionMutexPrecache;
 		}
 
-		std::map<Vec2i, bool> openPosList;
-		std::map<float, Nodes> openNodesList;
-		std::map<float, Nodes> closedNodesList;
+		VisitedPosTable openPosList;
+		BinaryHeap<Node *> openNodesList;
+		Node *bestClosedNode;
+		int closedNodesCount;
 		std::vector<Node> nodePool;
 
 		int nodePoolCount;
 		int factionIndex;
 		RandomGen random;
 		//CRandomMersenne random;
+		// Searches run ahead of the frame draw from a generator seeded by
+		// the unit so their result doesn't depend on the thread running them
+		RandomGen precacheRandom;
+		RandomGen *searchRandom;
 		int useMaxNodeCount;
 
 		std::map<int,TravelState> precachedTravelState;
 		std::map<int,std::vector<Vec2i> > precachedPath;
+		std::vector<int> precacheRequests;
 	};
 
+	// Holds one set of faction states per scheduler worker so units of the
+	// same faction can be searched on several threads at once. Worker 0
+	// owns the precache the frame update reads from.
 	class FactionStateManager {
 	protected:
 		typedef vector<FactionState *> FactionStateList;
 		FactionStateList factions;
 
 		void init() {
-			for(int index = 0; index < GameConstants::maxPlayers; ++index) {
-				factions.push_back(new FactionState(index));
+			for(int workerIndex = 0; workerIndex < WorkStealingScheduler::maxWorkerCount; ++workerIndex) {
+				for(int index = 0; index < GameConstants::maxPlayers; ++index) {
+					factions.push_back(new FactionState(index));
+				}
 			}
 		}
 
@@ -152,6 +218,10 @@ public:
 			FactionState *faction = factions[index];
 			return *faction;
 		}
+		FactionState & getFactionState(int index, int workerIndex) {
+			FactionState *faction = factions[workerIndex * GameConstants::maxPlayers + index];
+			return *faction;
+		}
 		void clear() {
 			for(unsigned int index = 0; index < (unsigned int)factions.size(); ++index) {
 				delete factions[index];
@@ -160,7 +230,7 @@ public:
 			factions.clear();
 		}
 		int size() {
-			return (int)factions.size();
+			return (int)factions.size() / WorkStealingScheduler::maxWorkerCount;
 		}
 	};
 
@@ -200,6 +270,7 @@ public:
 	TravelState findPath(Unit *unit, const Vec2i &finalPos, bool *wasStuck=NULL,int frameIndex=-1);
 	void clearUnitPrecache(Unit *unit);
 	void removeUnitPrecache(Unit *unit);
+	void commitPrecache(Faction *faction);
 	void clearCaches();
 
 	//bool unitCannotMove(Unit *unit);
@@ -214,7 +285,7 @@ private:
 	void init();
 
 	TravelState aStar(Unit *unit, const Vec2i &finalPos, bool inBailout,
-			int frameIndex, int maxNodeCount=-1,uint32 *searched_node_count=NULL);
+			int frameIndex, int maxNodeCount=-1,uint32 *searched_node_count=NULL, bool waypoint=false);
 	inline static Node *newNode(FactionState &faction, int maxNodeCount) {
 		if( faction.nodePoolCount < (int)faction.nodePool.size() &&
 			faction.nodePoolCount < maxNodeCount) {
@@ -226,17 +297,19 @@ private:
 		return NULL;
 	}
 
+	inline FactionState & getWorkerFactionState(int factionIndex) {
+		return factions.getFactionState(factionIndex, WorkStealingScheduler::getCurrentWorkerIndex());
+	}
+
 	Vec2i computeNearestFreePos(const Unit *unit, const Vec2i &targetPos);
+	Vec2i computeClusterWaypoint(Unit *unit, const Vec2i &finalPos);
 
 	inline static float heuristic(const Vec2i &pos, const Vec2i &finalPos) {
 		return pos.dist(finalPos);
 	}
 
 	inline static bool openPos(const Vec2i &sucPos, FactionState &faction) {
-		if(faction.openPosList.find(sucPos) == faction.openPosList.end()) {
-			return false;
-		}
-		return true;
+		return faction.openPosList.isVisited(sucPos);
 	}
 
 	inline static Node * minHeuristicFastLookup(FactionState &faction) {
@@ -244,29 +317,39 @@ private:
 			throw megaglest_runtime_error("openNodesList.empty() == true");
 		}
 
-		Node *result = faction.openNodesList.begin()->second.front();
-		faction.openNodesList.begin()->second.erase(faction.openNodesList.begin()->second.begin());
-		if(faction.openNodesList.begin()->second.empty()) {
-			faction.openNodesList.erase(faction.openNodesList.begin());
+		return faction.openNodesList.pop();
+	}
+
+	inline static void addOpenNode(FactionState &faction, Node *node) {
+		faction.openNodesList.push(node->heuristic, node);
+		faction.openPosList.setVisited(node->pos);
+	}
+
+	inline static void addClosedNode(FactionState &faction, Node *node) {
+		// Equal heuristics keep the first closed node, same as the
+		// front of the old heuristic keyed closed list
+		if(faction.bestClosedNode == NULL ||
+			node->heuristic < faction.bestClosedNode->heuristic) {
+			faction.bestClosedNode = node;
 		}
-		return result;
+		faction.closedNodesCount++;
+		faction.openPosList.setVisited(node->pos);
 	}
 
-	inline bool processNode(Unit *unit, Node *node,const Vec2i finalPos,
+	inline bool processNode(FactionState &faction, Unit *unit, Node *node,const Vec2i finalPos,
 			int x, int y, bool &nodeLimitReached,int maxNodeCount) {
 		bool result = false;
 		Vec2i sucPos= node->pos + Vec2i(x, y);
 
 		int unitFactionIndex = unit->getFactionIndex();
-		FactionState &faction = factions.getFactionState(unitFactionIndex);
 
 		bool foundOpenPosForPos = openPos(sucPos, faction);
 		bool allowUnitMoveSoon = canUnitMoveSoon(unit, node->pos, sucPos);
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled == true &&
 				SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynchMax).enabled == true) {
 			char szBuf[8096]="";
-			snprintf(szBuf,8096,"In processNode() nodeLimitReached %d unitFactionIndex %d foundOpenPosForPos %d allowUnitMoveSoon %d maxNodeCount %d node->pos = %s finalPos = %s sucPos = %s faction.openPosList.size() %lu closedNodesList.size() %lu",
-					nodeLimitReached,unitFactionIndex,foundOpenPosForPos, allowUnitMoveSoon, maxNodeCount,node->pos.getString().c_str(),finalPos.getString().c_str(),sucPos.getString().c_str(),faction.openPosList.size(),faction.closedNodesList.size());
+			snprintf(szBuf,8096,"In processNode() nodeLimitReached %d unitFactionIndex %d foundOpenPosForPos %d allowUnitMoveSoon %d maxNodeCount %d node->pos = %s finalPos = %s sucPos = %s faction.openNodesList.size() %lu closedNodesCount %d",
+					nodeLimitReached,unitFactionIndex,foundOpenPosForPos, allowUnitMoveSoon, maxNodeCount,node->pos.getString().c_str(),finalPos.getString().c_str(),sucPos.getString().c_str(),(unsigned long)faction.openNodesList.size(),faction.closedNodesCount);
 
 			if(Thread::isCurrentThreadMainThread() == false) {
 				unit->logSynchDataThreaded(__FILE__,__LINE__,szBuf);
@@ -286,11 +369,7 @@ private:
 				sucNode->next= NULL;
 				sucNode->exploredCell = map->getSurfaceCell(
 						Map::toSurfCoords(sucPos))->isExplored(unit->getTeam());
-				if(faction.openNodesList.find(sucNode->heuristic) == faction.openNodesList.end()) {
-					faction.openNodesList[sucNode->heuristic].clear();
-				}
-				faction.openNodesList[sucNode->heuristic].push_back(sucNode);
-				faction.openPosList[sucNode->pos] = true;
+				addOpenNode(faction, sucNode);
 
 				result = true;
 
@@ -345,7 +424,7 @@ private:
 			}
 		}
 
-		FactionState &faction = factions.getFactionState(unitFactionIndex);
+		FactionState &faction = getWorkerFactionState(unitFactionIndex);
 
 		while(nodeLimitReached == false) {
 			whileLoopCount++;
@@ -388,11 +467,7 @@ private:
 				break;
 			}
 
-			if(faction.closedNodesList.find(node->heuristic) == faction.closedNodesList.end()) {
-				faction.closedNodesList[node->heuristic].clear();
-			}
-			faction.closedNodesList[node->heuristic].push_back(node);
-			faction.openPosList[node->pos] = true;
+			addClosedNode(faction, node);
 
 			int failureCount 	= 0;
 			int cellCount 		= 0;
@@ -404,7 +479,7 @@ private:
 
 			//int tryDirection 	= 1;
 			//int tryDirection 	= faction.random.IRandomX(1, 4);
-			int tryDirection 	= faction.random.randRange(1, 4);
+			int tryDirection 	= faction.searchRandom->randRange(1, 4);
 			//int tryDirection 	= unit->getRandom(true)->randRange(1, 4);
 
 			if(SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled == true &&
@@ -423,7 +498,7 @@ private:
 			if(tryDirection == 4) {
 				for(int i = 1;i >= -1 && nodeLimitReached == false;--i) {
 					for(int j = -1;j <= 1 && nodeLimitReached == false;++j) {
-						if(processNode(unit, node, finalPos, i, j, nodeLimitReached, maxNodeCount) == false) {
+						if(processNode(faction, unit, node, finalPos, i, j, nodeLimitReached, maxNodeCount) == false) {
 							failureCount++;
 						}
 						cellCount++;
@@ -433,7 +508,7 @@ private:
 			else if(tryDirection == 3) {
 				for(int i = -1;i <= 1 && nodeLimitReached == false;++i) {
 					for(int j = 1;j >= -1 && nodeLimitReached == false;--j) {
-						if(processNode(unit, node, finalPos, i, j, nodeLimitReached, maxNodeCount) == false) {
+						if(processNode(faction, unit, node, finalPos, i, j, nodeLimitReached, maxNodeCount) == false) {
 							failureCount++;
 						}
 						cellCount++;
@@ -443,7 +518,7 @@ private:
 			else if(tryDirection == 2) {
 				for(int i = -1;i <= 1 && nodeLimitReached == false;++i) {
 					for(int j = -1;j <= 1 && nodeLimitReached == false;++j) {
-						if(processNode(unit, node, finalPos, i, j, nodeLimitReached, maxNodeCount) == false) {
+						if(processNode(faction, unit, node, finalPos, i, j, nodeLimitReached, maxNodeCount) == false) {
 							failureCount++;
 						}
 						cellCount++;
@@ -453,7 +528,7 @@ private:
 			else {
 				for(int i = 1;i >= -1 && nodeLimitReached == false;--i) {
 					for(int j = 1;j >= -1 && nodeLimitReached == false;--j) {
-						if(processNode(unit, node, finalPos, i, j, nodeLimitReached, maxNodeCount) == false) {
+						if(processNode(faction, unit, node, finalPos, i, j, nodeLimitReached, maxNodeCount) == false) {
 							failureCount++;
 						}
 						cellCount++;
@@ -22,11 +22,13 @@
 #include "game_constants.h"
 #include "game_util.h"
 #include "platform_util.h"
+#include "work_stealing_scheduler.h"
 #include "leak_dumper.h"
 
 using namespace std;
 using namespace Shared::Graphics;
 using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
 
 namespace Glest{ namespace Game{
 
@@ -81,6 +83,10 @@ void Logger::add(const string str,  bool renderScreen, const string statusText)
 		fprintf(f, "%s\n", str.c_str());
 		fclose(f);
 	}
+	// type loader threads only write the file, the screen is the main thread's
+	if(WorkStealingScheduler::getCurrentWorkerIndex() > 0) {
+		return;
+	}
 	this->current= str;
 	this->statusText = statusText;
 
@@ -30,6 +30,7 @@
 #include "conversion.h"
 #include "steam.h"
 #include "memory.h"
+#include "sim_benchmark.h"
 
 #include "leak_dumper.h"
 
@@ -1777,9 +1778,182 @@ void Game::processNetworkSynchChecksIfRequired() {
 	}
 }
 
+void Game::verifyReplayAgainstSavedGame() {
+	if(lastworldFrameCountForReplay < 0 || world.getFrameCount() < lastworldFrameCountForReplay) {
+		return;
+	}
+	lastworldFrameCountForReplay = -1;
+
+	if(replayVerifier.hasFactionCRCs() == false) {
+		printf("Replay reached the saved game frame %d, no faction checksums were saved to verify against.\n",world.getFrameCount());
+		return;
+	}
+
+	vector<uint32> replayCRCs;
+	for(int i = 0; i < world.getFactionCount(); ++i) {
+		replayCRCs.push_back(world.getFaction(i)->getCRC().getSum());
+	}
+	vector<int> mismatches = replayVerifier.getMismatchedFactions(replayCRCs);
+	for(unsigned int i = 0; i < mismatches.size(); ++i) {
+		int factionIndex = mismatches[i];
+		uint32 savedCRC = replayVerifier.getFactionCRC(factionIndex);
+		printf("Replay verification FAILED for faction %d at frame %d, saved CRC: %u replayed CRC: %u\n",factionIndex,world.getFrameCount(),savedCRC,replayCRCs[factionIndex]);
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled) SystemFlags::OutputDebug(SystemFlags::debugWorldSynch,"Replay verification FAILED for faction %d at frame %d, saved CRC: %u replayed CRC: %u\n",factionIndex,world.getFrameCount(),savedCRC,replayCRCs[factionIndex]);
+	}
+	if(mismatches.empty() == true) {
+		printf("Replay verification passed for %d factions at frame %d\n",world.getFactionCount(),world.getFrameCount());
+	}
+}
+
+void Game::loadReplayCommandHistory(const string &replayFile) {
+	XmlTree	xmlTreeReplay(XML_RAPIDXML_ENGINE);
+	std::map<string,string> mapExtraTagReplacementValues;
+	xmlTreeReplay.load(replayFile, Properties::getTagReplacementValues(&mapExtraTagReplacementValues),true);
+
+	const XmlNode *rootNode= xmlTreeReplay.getRootNode();
+	if(rootNode->hasChild("megaglest-saved-game") == true) {
+		rootNode = rootNode->getChild("megaglest-saved-game");
+	}
+	if(rootNode->hasChild("Game") == false) {
+		return;
+	}
+
+	XmlNode *gameNode = rootNode->getChild("Game");
+	vector<XmlNode *> networkCommandNodeList = gameNode->getChildList("NetworkCommand");
+	for(unsigned int i = 0; i < networkCommandNodeList.size(); ++i) {
+		XmlNode *node = networkCommandNodeList[i];
+		NetworkCommand command;
+		command.loadGame(node);
+		replayCommandList.push_back(make_pair(node->getAttribute("worldFrameCount")->getIntValue(),command));
+	}
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Loaded " MG_SIZE_T_SPECIFIER " replay commands from [%s]\n",replayCommandList.size(),replayFile.c_str());
+}
+
+void Game::processAIWorkerThreads(bool enableServerControlledAI, bool isNetworkGame, NetworkRole role) {
+	bool hasAIPlayer = false;
+	for(int j = 0; j < world.getFactionCount(); ++j) {
+		Faction *faction = world.getFaction(j);
+
+		//printf("Faction Index = %d enableServerControlledAI = %d, isNetworkGame = %d, role = %d isCPU player = %d scriptManager.getPlayerModifiers(j)->getAiEnabled() = %d\n",j,enableServerControlledAI,isNetworkGame,role,faction->getCpuControl(enableServerControlledAI,isNetworkGame,role),scriptManager.getPlayerModifiers(j)->getAiEnabled());
+
+		if(	faction->getCpuControl(enableServerControlledAI,isNetworkGame,role) == true &&
+			scriptManager.getPlayerModifiers(j)->getAiEnabled() == true) {
+			aiInterfaces[j]->signalWorkerThread(world.getFrameCount());
+			hasAIPlayer = true;
+		}
+	}
+
+	if(hasAIPlayer == true) {
+		//sleep(0);
+
+		Chrono chronoAI;
+		chronoAI.start();
+
+		const int MAX_FACTION_THREAD_WAIT_MILLISECONDS = 20000;
+		for(;chronoAI.getMillis() < MAX_FACTION_THREAD_WAIT_MILLISECONDS;) {
+			bool workThreadsFinished = true;
+			for(int j = 0; j < world.getFactionCount(); ++j) {
+				Faction *faction = world.getFaction(j);
+				if(faction == NULL) {
+					throw megaglest_runtime_error("faction == NULL");
+				}
+				if(	faction->getCpuControl(enableServerControlledAI,isNetworkGame,role) == true &&
+					scriptManager.getPlayerModifiers(j)->getAiEnabled() == true) {
+					if(aiInterfaces[j]->isWorkerThreadSignalCompleted(world.getFrameCount()) == false) {
+						workThreadsFinished = false;
+						break;
+					}
+				}
+			}
+			if(workThreadsFinished == false) {
+				//sleep(0);
+			}
+			else {
+				break;
+			}
+		}
+	}
+}
+
+void Game::runSimulationBenchmark(int frameTotal) {
+	NetworkRole role 				= NetworkManager::getInstance().getNetworkRole();
+	bool isNetworkGame 				= this->gameSettings.isNetworkGame();
+	bool enableServerControlledAI 	= this->gameSettings.getEnableServerControlledAI();
+
+	int startFrame = world.getFrameCount();
+	printf("Running simulation benchmark for %d frames starting at frame %d...\n",frameTotal,startFrame);
+
+	SimBenchmark::reset();
+	SimBenchmark::setEnabled(true);
+
+	uint64 worldTicks = 0;
+	uint64 startTicks = SimBenchmark::getTicks();
+	for(int frame = 0; frame < frameTotal; ++frame) {
+		if(quitPendingIndicator == true || world.getFactionCount() <= 0) {
+			break;
+		}
+
+		{
+			// the per faction sums network games compare every frame
+			SimBenchmarkTimer benchmarkTimer(sbsCRC);
+			for(int index = 0; index < world.getFactionCount(); ++index) {
+				world.getFaction(index)->getCRC();
+			}
+		}
+		{
+			SimBenchmarkTimer benchmarkTimer(sbsAI);
+			processAIWorkerThreads(enableServerControlledAI,isNetworkGame,role);
+		}
+
+		uint64 worldStartTicks = SimBenchmark::getTicks();
+		world.update();
+		worldTicks += SimBenchmark::getTicks() - worldStartTicks;
+
+		{
+			SimBenchmarkTimer benchmarkTimer(sbsCommands);
+			commander.signalNetworkUpdate(this);
+		}
+	}
+	int64 totalMicros = SimBenchmark::ticksToMicros(SimBenchmark::getTicks() - startTicks);
+	SimBenchmark::setEnabled(false);
+
+	int framesRun = world.getFrameCount() - startFrame;
+	Checksum worldCRC;
+	worldCRC.addInt(world.getFrameCount());
+	for(int index = 0; index < world.getFactionCount(); ++index) {
+		worldCRC.addUInt(world.getFaction(index)->getCRC().getSum());
+	}
+
+	printf("\n=== Simulation benchmark [%s] ===\n",this->gameSettings.getScenario() != "" ? this->gameSettings.getScenario().c_str() : this->gameSettings.getMap().c_str());
+	printf("Frames: %d in %.3f seconds, %.2f frames per second\n",framesRun,totalMicros / 1000000.0,
+			(totalMicros > 0 ? framesRun * 1000000.0 / totalMicros : 0.0));
+	printf("World update: %.3f msecs per frame\n",(framesRun > 0 ? SimBenchmark::ticksToMicros(worldTicks) / 1000.0 / framesRun : 0.0));
+	for(int section = 0; section < sbsCount; ++section) {
+		int64 sectionMicros = SimBenchmark::getSectionMicros(static_cast<SimBenchmarkSection>(section));
+		printf("  %-14s %10.3f msecs total, %8.3f per frame, %5.1f%%\n",
+				SimBenchmark::getSectionName(static_cast<SimBenchmarkSection>(section)),
+				sectionMicros / 1000.0,
+				(framesRun > 0 ? sectionMicros / 1000.0 / framesRun : 0.0),
+				(totalMicros > 0 ? sectionMicros * 100.0 / totalMicros : 0.0));
+	}
+	printf("(unit updates include pathfinding and sight changes of moving units)\n");
+	printf("(sections run on unit update workers are summed over all threads)\n");
+	printf("Peak resident memory: %.1f MB\n",getPeakResidentMemoryBytes() / (1024.0 * 1024.0));
+	printf("Final world frame: %d CRC: %u\n",world.getFrameCount(),worldCRC.getSum());
+}
+
 //update
 void Game::update() {
 	try {
+		if(SimBenchmark::getFrames() > 0 && gameStarted == true) {
+			int frameTotal = SimBenchmark::getFrames();
+			SimBenchmark::setFrames(0);
+
+			runSimulationBenchmark(frameTotal);
+			program->setShutdownApplicationEnabled(true);
+			return;
+		}
+
 		if(currentUIState != NULL) {
 			currentUIState->update();
 		}
@@ -2050,56 +2224,7 @@ void Game::update() {
 							// Signal the faction threads to do any pre-processing
 							chronoGamePerformanceCounts.start();
 
-							bool hasAIPlayer = false;
-							for(int j = 0; j < world.getFactionCount(); ++j) {
-								Faction *faction = world.getFaction(j);
-
-								//printf("Faction Index = %d enableServerControlledAI = %d, isNetworkGame = %d, role = %d isCPU player = %d scriptManager.getPlayerModifiers(j)->getAiEnabled() = %d\n",j,enableServerControlledAI,isNetworkGame,role,faction->getCpuControl(enableServerControlledAI,isNetworkGame,role),scriptManager.getPlayerModifiers(j)->getAiEnabled());
-
-								if(	faction->getCpuControl(enableServerControlledAI,isNetworkGame,role) == true &&
-									scriptManager.getPlayerModifiers(j)->getAiEnabled() == true) {
-
-									if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] [i = %d] faction = %d, factionCount = %d, took msecs: %lld [before AI updates]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,i,j,world.getFactionCount(),chrono.getMillis());
-									aiInterfaces[j]->signalWorkerThread(world.getFrameCount());
-									hasAIPlayer = true;
-								}
-							}
-
-							if(showPerfStats) {
-								sprintf(perfBuf,"In [%s::%s] Line: %d took msecs: " MG_I64_SPECIFIER "\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chronoPerf.getMillis());
-								perfList.push_back(perfBuf);
-							}
-
-							if(hasAIPlayer == true) {
-								//sleep(0);
-
-								Chrono chronoAI;
-								chronoAI.start();
-
-								const int MAX_FACTION_THREAD_WAIT_MILLISECONDS = 20000;
-								for(;chronoAI.getMillis() < MAX_FACTION_THREAD_WAIT_MILLISECONDS;) {
-									bool workThreadsFinished = true;
-									for(int j = 0; j < world.getFactionCount(); ++j) {
-										Faction *faction = world.getFaction(j);
-										if(faction == NULL) {
-											throw megaglest_runtime_error("faction == NULL");
-										}
-										if(	faction->getCpuControl(enableServerControlledAI,isNetworkGame,role) == true &&
-											scriptManager.getPlayerModifiers(j)->getAiEnabled() == true) {
-											if(aiInterfaces[j]->isWorkerThreadSignalCompleted(world.getFrameCount()) == false) {
-												workThreadsFinished = false;
-												break;
-											}
-										}
-									}
-									if(workThreadsFinished == false) {
-										//sleep(0);
-									}
-									else {
-										break;
-									}
-								}
-							}
+							processAIWorkerThreads(enableServerControlledAI,isNetworkGame,role);
 
 							addPerformanceCount("ProcessAIWorkerThreads",chronoGamePerformanceCounts.getMillis());
 						}
@@ -2211,6 +2336,8 @@ void Game::update() {
 
 					addPerformanceCount("ProcessNetworkUpdate",chronoGamePerformanceCounts.getMillis());
 
+					verifyReplayAgainstSavedGame();
+
 					if(showPerfStats) {
 						sprintf(perfBuf,"In [%s::%s] Line: %d took msecs: " MG_I64_SPECIFIER "\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chronoPerf.getMillis());
 						perfList.push_back(perfBuf);
@@ -2502,6 +2629,7 @@ void Game::update() {
 				}
 				else if(server->getStartInGameConnectionLaunch() == true) {
 					bool saveNetworkGame = false;
+					bool saveSnapshotFile = false;
 
 					ServerInterface *server = NetworkManager::getInstance().getServerInterface();
 					for(int i = 0; i < world.getFactionCount(); ++i) {
@@ -2520,6 +2648,51 @@ void Game::update() {
 					}
 
 					if(saveNetworkGame == true) {
+						// clients that support it get the game streamed over their
+						// game socket, older clients download the file by ftp
+						bool streamSnapshot = false;
+						for(int i = 0; i < world.getFactionCount(); ++i) {
+							Faction *faction = world.getFaction(i);
+
+							MutexSafeWrapper safeMutex(server->getSlotMutex(faction->getStartLocationIndex()),CODE_AT_LINE);
+							ConnectionSlot *slot =  server->getSlot(faction->getStartLocationIndex(),false);
+							if(slot != NULL && slot->getJoinGameInProgress() == true &&
+								slot->getSentSavedGameInfo() == false &&
+								slot->hasPendingGameSnapshot() == false) {
+								if(slot->getCanReceiveGameSnapshot() == true) {
+									streamSnapshot = true;
+								}
+								else {
+									saveSnapshotFile = true;
+								}
+							}
+						}
+
+						if(streamSnapshot == true) {
+							string snapshot = this->saveGameToString();
+							std::pair<unsigned char *,unsigned long> compressedResult =
+									compressMemoryToMemory((unsigned char *)snapshot.data(), (unsigned long)snapshot.size());
+							std::vector<unsigned char> compressedSnapshot(compressedResult.first, compressedResult.first + compressedResult.second);
+							delete [] compressedResult.first;
+
+							if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Streaming saved game to joining clients, size: " MG_SIZE_T_SPECIFIER " compressed: " MG_SIZE_T_SPECIFIER "\n",snapshot.size(),compressedSnapshot.size());
+
+							for(int i = 0; i < world.getFactionCount(); ++i) {
+								Faction *faction = world.getFaction(i);
+
+								MutexSafeWrapper safeMutex(server->getSlotMutex(faction->getStartLocationIndex()),CODE_AT_LINE);
+								ConnectionSlot *slot =  server->getSlot(faction->getStartLocationIndex(),false);
+								if(slot != NULL && slot->getJoinGameInProgress() == true &&
+									slot->getSentSavedGameInfo() == false &&
+									slot->hasPendingGameSnapshot() == false &&
+									slot->getCanReceiveGameSnapshot() == true) {
+									slot->setPendingGameSnapshot(compressedSnapshot, (uint32)snapshot.size());
+								}
+							}
+						}
+					}
+
+					if(saveSnapshotFile == true) {
 						//printf("Saved network game to disk\n");
 
 						string file = this->saveGame(GameConstants::saveNetworkGameFileServer,"temp/");
@@ -2554,7 +2727,8 @@ void Game::update() {
 							MutexSafeWrapper safeMutex(server->getSlotMutex(faction->getStartLocationIndex()),CODE_AT_LINE);
 							ConnectionSlot *slot =  server->getSlot(faction->getStartLocationIndex(),false);
 							if(slot != NULL && slot->getJoinGameInProgress() == true &&
-									slot->getSentSavedGameInfo() == false) {
+									slot->getSentSavedGameInfo() == false &&
+									slot->getCanReceiveGameSnapshot() == false) {
 
 								safeMutex.ReleaseLock();
 							    NetworkMessageReady networkMessageReady(0);
@@ -2569,6 +2743,8 @@ void Game::update() {
 					}
 				}
 			}
+			sendPendingGameSnapshots(server);
+
 			//else {
 			// handle setting changes from clients
 			Map *map= world.getMap();
@@ -5545,8 +5721,8 @@ string Game::getDebugStats(std::map<int,string> &factionDebugInfo) {
 		str+= "Log buffer count: " + intToStr(SystemFlags::getLogEntryBufferCount())+"\n";
 	}
 
-	str+= "UnitRangeCellsLookupItemCache: " + world.getUnitUpdater()->getUnitRangeCellsLookupItemCacheStats()+"\n";
-	str+= "ExploredCellsLookupItemCache: " 	+ world.getExploredCellsLookupItemCacheStats()+"\n";
+	str+= "UnitGrid: "                      + world.getUnitUpdater()->getUnitGridStats()+"\n";
+	str+= "TeamVisibility: "                + world.getTeamVisibilityStats()+"\n";
 	str+= "FowAlphaCellsLookupItemCache: "  + world.getFowAlphaCellsLookupItemCacheStats()+"\n";
 
 	const string selectionType = toLower(Config::getInstance().getString("SelectionType",Config::colorPicking));
@@ -5571,6 +5747,14 @@ string Game::getDebugStats(std::map<int,string> &factionDebugInfo) {
 
 	str+= "Frame count:"     + intToStr(world.getFrameCount())+"\n";
 
+	NetworkManager &networkManager= NetworkManager::getInstance();
+	if(networkManager.getNetworkRole() == nrClient) {
+		ClientInterface *clientInterface = dynamic_cast<ClientInterface *>(networkManager.getClientInterface());
+		if(clientInterface != NULL) {
+			str+= "Network wait: " + clientInterface->getNetworkWaitStats() + "\n";
+		}
+	}
+
 	//visible quad
 	if(this->masterserverMode == false) {
 		Renderer &renderer= Renderer::getInstance();
@@ -6619,82 +6803,37 @@ void Game::saveGame(){
 	config.save();
 }
 
-string Game::saveGame(string name, const string &path) {
-	Config &config= Config::getInstance();
-	// auto name file if using saved file pattern string
-	if(name == GameConstants::saveGameFilePattern) {
-		//time_t curTime = time(NULL);
-	    //struct tm *loctime = localtime (&curTime);
-		struct tm loctime = threadsafe_localtime(systemtime_now());
-	    char szBuf2[100]="";
-	    strftime(szBuf2,100,"%Y%m%d_%H%M%S",&loctime);
+void Game::sendPendingGameSnapshots(ServerInterface *server) {
+	// a few chunks per update keep the host responsive while a large
+	// game is streamed, the joining client only starts once it has all
+	static const int gameSnapshotChunksPerUpdate = 8;
 
-		char szBuf[8096]="";
-		snprintf(szBuf,8096,name.c_str(),szBuf2);
-		name = szBuf;
-	}
-	else if(name == GameConstants::saveGameFileAutoTestDefault) {
-		//time_t curTime = time(NULL);
-	    //struct tm *loctime = localtime (&curTime);
-		struct tm loctime = threadsafe_localtime(systemtime_now());
-	    char szBuf2[100]="";
-	    strftime(szBuf2,100,"%Y%m%d_%H%M%S",&loctime);
-
-		char szBuf[8096]="";
-		snprintf(szBuf,8096,name.c_str(),szBuf2);
-		name = szBuf;
-	}
-
-	// Save the file now
-	string saveGameFile = path + name;
-	if(getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) != "") {
-		saveGameFile = getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) + saveGameFile;
-	}
-	else {
-        string userData = config.getString("UserData_Root","");
-        if(userData != "") {
-        	endPathWithSlash(userData);
-        }
-        saveGameFile = userData + saveGameFile;
-	}
-	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Saving game to [%s]\n",saveGameFile.c_str());
-
-	// This condition will re-play all the commands from a replay file
-	// INSTEAD of saving from a saved game.
-	if(config.getBool("SaveCommandsForReplay","false") == true) {
-		std::map<string,string> mapTagReplacements;
-		XmlTree xmlTreeSaveGame(XML_RAPIDXML_ENGINE);
-
-		xmlTreeSaveGame.init("megaglest-saved-game");
-		XmlNode *rootNodeReplay = xmlTreeSaveGame.getRootNode();
-
-		//std::map<string,string> mapTagReplacements;
-		//time_t now = time(NULL);
-		//struct tm *loctime = localtime (&now);
-		struct tm loctime = threadsafe_localtime(systemtime_now());
-		char szBuf[4096]="";
-		strftime(szBuf,4095,"%Y-%m-%d %H:%M:%S",&loctime);
-
-		rootNodeReplay->addAttribute("version",glestVersionString, mapTagReplacements);
-		rootNodeReplay->addAttribute("timestamp",szBuf, mapTagReplacements);
+	for(int i = 0; i < world.getFactionCount(); ++i) {
+		Faction *faction = world.getFaction(i);
 
-		XmlNode *gameNodeReplay = rootNodeReplay->addChild("Game");
-		gameSettings.saveGame(gameNodeReplay);
+		MutexSafeWrapper safeMutex(server->getSlotMutex(faction->getStartLocationIndex()),CODE_AT_LINE);
+		ConnectionSlot *slot =  server->getSlot(faction->getStartLocationIndex(),false);
+		if(slot == NULL || slot->hasPendingGameSnapshot() == false) {
+			continue;
+		}
+		if(slot->isConnected() == false || slot->getJoinGameInProgress() == false) {
+			slot->clearPendingGameSnapshot();
+			continue;
+		}
 
-		gameNodeReplay->addAttribute("LastWorldFrameCount",intToStr(world.getFrameCount()), mapTagReplacements);
+		safeMutex.ReleaseLock();
+		bool finished = slot->sendPendingGameSnapshotChunks(gameSnapshotChunksPerUpdate);
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] saved game stream to slot %d at %d%%\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,faction->getStartLocationIndex(),slot->getPendingGameSnapshotProgress());
 
-		for(unsigned int i = 0; i < replayCommandList.size(); ++i) {
-			std::pair<int,NetworkCommand> &cmd = replayCommandList[i];
-			XmlNode *networkCommandNode = cmd.second.saveGame(gameNodeReplay);
-			networkCommandNode->addAttribute("worldFrameCount",intToStr(cmd.first), mapTagReplacements);
+		if(finished == true) {
+			NetworkMessageReady networkMessageReady(0);
+			slot->sendMessage(&networkMessageReady);
+			slot->setSentSavedGameInfo(true);
 		}
-
-		string replayFile = saveGameFile + ".replay";
-		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Saving game replay commands to [%s]\n",replayFile.c_str());
-		xmlTreeSaveGame.save(replayFile);
 	}
+}
 
-	XmlTree xmlTree;
+void Game::buildSaveGameXml(XmlTree &xmlTree) {
 	xmlTree.init("megaglest-saved-game");
 	XmlNode *rootNode = xmlTree.getRootNode();
 
@@ -6853,7 +6992,101 @@ string Game::saveGame(string name, const string &path) {
 	}
 
 	gameNode->addAttribute("disableSpeedChange",intToStr(disableSpeedChange), mapTagReplacements);
+}
+
+string Game::saveGameToString() {
+	XmlTree xmlTree(XML_RAPIDXML_ENGINE);
+	buildSaveGameXml(xmlTree);
+	return xmlTree.saveToString();
+}
+
+string Game::saveGame(string name, const string &path) {
+	Config &config= Config::getInstance();
+	// auto name file if using saved file pattern string
+	if(name == GameConstants::saveGameFilePattern) {
+		//time_t curTime = time(NULL);
+	    //struct tm *loctime = localtime (&curTime);
+		struct tm loctime = threadsafe_localtime(systemtime_now());
+	    char szBuf2[100]="";
+	    strftime(szBuf2,100,"%Y%m%d_%H%M%S",&loctime);
+
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,name.c_str(),szBuf2);
+		name = szBuf;
+	}
+	else if(name == GameConstants::saveGameFileAutoTestDefault) {
+		//time_t curTime = time(NULL);
+	    //struct tm *loctime = localtime (&curTime);
+		struct tm loctime = threadsafe_localtime(systemtime_now());
+	    char szBuf2[100]="";
+	    strftime(szBuf2,100,"%Y%m%d_%H%M%S",&loctime);
+
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,name.c_str(),szBuf2);
+		name = szBuf;
+	}
+
+	// Save the file now
+	string saveGameFile = path + name;
+	if(getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) != "") {
+		saveGameFile = getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) + saveGameFile;
+	}
+	else {
+        string userData = config.getString("UserData_Root","");
+        if(userData != "") {
+        	endPathWithSlash(userData);
+        }
+        saveGameFile = userData + saveGameFile;
+	}
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Saving game to [%s]\n",saveGameFile.c_str());
+
+	// This condition will re-play all the commands from a replay file
+	// INSTEAD of saving from a saved game.
+	if(config.getBool("SaveCommandsForReplay","false") == true) {
+		std::map<string,string> mapTagReplacements;
+		XmlTree xmlTreeSaveGame(XML_RAPIDXML_ENGINE);
+
+		xmlTreeSaveGame.init("megaglest-saved-game");
+		XmlNode *rootNodeReplay = xmlTreeSaveGame.getRootNode();
+
+		//std::map<string,string> mapTagReplacements;
+		//time_t now = time(NULL);
+		//struct tm *loctime = localtime (&now);
+		struct tm loctime = threadsafe_localtime(systemtime_now());
+		char szBuf[4096]="";
+		strftime(szBuf,4095,"%Y-%m-%d %H:%M:%S",&loctime);
+
+		rootNodeReplay->addAttribute("version",glestVersionString, mapTagReplacements);
+		rootNodeReplay->addAttribute("timestamp",szBuf, mapTagReplacements);
+
+		XmlNode *gameNodeReplay = rootNodeReplay->addChild("Game");
+		gameSettings.saveGame(gameNodeReplay);
+
+		gameNodeReplay->addAttribute("LastWorldFrameCount",intToStr(world.getFrameCount()), mapTagReplacements);
+
+		// faction checksums at the save frame so a replay can be
+		// verified against the saved game
+		vector<uint32> factionCRCs;
+		for(int i = 0; i < world.getFactionCount(); ++i) {
+			factionCRCs.push_back(world.getFaction(i)->getCRC().getSum());
+		}
+		ReplayVerifier saveVerifier;
+		saveVerifier.setFactionCRCs(factionCRCs);
+		saveVerifier.saveGame(gameNodeReplay, mapTagReplacements);
 
+		for(unsigned int i = 0; i < replayCommandList.size(); ++i) {
+			std::pair<int,NetworkCommand> &cmd = replayCommandList[i];
+			XmlNode *networkCommandNode = cmd.second.saveGame(gameNodeReplay);
+			networkCommandNode->addAttribute("worldFrameCount",intToStr(cmd.first), mapTagReplacements);
+		}
+
+		string replayFile = saveGameFile + ".replay";
+		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Saving game replay commands to [%s]\n",replayFile.c_str());
+		xmlTreeSaveGame.save(replayFile);
+	}
+
+	XmlTree xmlTree;
+	buildSaveGameXml(xmlTree);
 	xmlTree.save(saveGameFile);
 
 	if(masterserverMode == false) {
@@ -6870,9 +7103,9 @@ string Game::saveGame(string name, const string &path) {
 
 void Game::loadGame(string name,Program *programPtr,bool isMasterserverMode,const GameSettings *joinGameSettings) {
 	Config &config= Config::getInstance();
-	// This condition will re-play all the commands from a replay file
-	// INSTEAD of saving from a saved game.
-	if(joinGameSettings == NULL && config.getBool("SaveCommandsForReplay","false") == true) {
+	// Saved games are restored from the world snapshot, replaying all the
+	// commands from the replay file is only used to verify the snapshot.
+	if(joinGameSettings == NULL && config.getBool("VerifySavedGameWithReplay","false") == true) {
 		XmlTree	xmlTreeReplay(XML_RAPIDXML_ENGINE);
 		std::map<string,string> mapExtraTagReplacementValues;
 		xmlTreeReplay.load(name + ".replay", Properties::getTagReplacementValues(&mapExtraTagReplacementValues),true);
@@ -6918,6 +7151,8 @@ void Game::loadGame(string name,Program *programPtr,bool isMasterserverMode,cons
 		Game *newGame = new Game(programPtr, &newGameSettingsReplay, isMasterserverMode);
 		newGame->lastworldFrameCountForReplay = gameNode->getAttribute("LastWorldFrameCount")->getIntValue();
 
+		newGame->replayVerifier.loadGame(gameNode);
+
 		vector<XmlNode *> networkCommandNodeList = gameNode->getChildList("NetworkCommand");
 		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("networkCommandNodeList.size() = " MG_SIZE_T_SPECIFIER "\n",networkCommandNodeList.size());
 		for(unsigned int i = 0; i < networkCommandNodeList.size(); ++i) {
@@ -6939,6 +7174,23 @@ void Game::loadGame(string name,Program *programPtr,bool isMasterserverMode,cons
 	xmlTree.load(name, Properties::getTagReplacementValues(&mapExtraTagReplacementValues),true);
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("After load of XML\n");
 
+	loadGameFromXml(xmlTree, name, programPtr, isMasterserverMode, joinGameSettings);
+}
+
+void Game::loadGameFromString(const string &xmlData,Program *programPtr,bool isMasterserverMode,const GameSettings *joinGameSettings) {
+	XmlTree	xmlTree(XML_RAPIDXML_ENGINE);
+
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Before load of XML from memory, size: " MG_SIZE_T_SPECIFIER "\n",xmlData.size());
+	std::map<string,string> mapExtraTagReplacementValues;
+	xmlTree.loadFromString(xmlData, Properties::getTagReplacementValues(&mapExtraTagReplacementValues));
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("After load of XML from memory\n");
+
+	loadGameFromXml(xmlTree, "", programPtr, isMasterserverMode, joinGameSettings);
+}
+
+void Game::loadGameFromXml(XmlTree &xmlTree, const string &name, Program *programPtr,
+		bool isMasterserverMode, const GameSettings *joinGameSettings) {
+	Config &config= Config::getInstance();
 	const XmlNode *rootNode= xmlTree.getRootNode();
 	if(rootNode->hasChild("megaglest-saved-game") == true) {
 		rootNode = rootNode->getChild("megaglest-saved-game");
@@ -7035,6 +7287,12 @@ void Game::loadGame(string name,Program *programPtr,bool isMasterserverMode,cons
 	newGame->loadGameNode = gameNode;
 	newGame->inJoinGameLoading = (joinGameSettings != NULL);
 
+	// keep the earlier commands so the next save still writes a complete replay
+	if(joinGameSettings == NULL && config.getBool("SaveCommandsForReplay","false") == true &&
+		name != "" && fileExists(name + ".replay") == true) {
+		newGame->loadReplayCommandHistory(name + ".replay");
+	}
+
 //	newGame->mouse2d = gameNode->getAttribute("mouse2d")->getIntValue();
 //    int mouseX;
 //	newGame->mouseX = gameNode->getAttribute("mouseX")->getIntValue();
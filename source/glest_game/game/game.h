@@ -29,11 +29,13 @@
 #include "network_interface.h"
 #include "data_types.h"
 #include "selection.h"
+#include "replay_verifier.h"
 #include "leak_dumper.h"
 
 using std::vector;
 using namespace Shared::Platform;
 using namespace Shared::PlatformCommon;
+using Shared::Xml::XmlTree;
 
 namespace Shared { namespace Graphics {
 	class VideoPlayer;
@@ -196,6 +198,7 @@ private:
 	XmlNode *loadGameNode;
 	int lastworldFrameCountForReplay;
 	std::vector<std::pair<int,NetworkCommand> > replayCommandList;
+	ReplayVerifier replayVerifier;
 
 	std::vector<string> streamingVideos;
 	::Shared::Graphics::VideoPlayer *videoPlayer;
@@ -333,7 +336,10 @@ public:
 	void stopAllVideo();
 
 	string saveGame(string name, const string &path="saved/");
+	// The saved game XML, used to stream the game to joining clients
+	string saveGameToString();
 	static void loadGame(string name,Program *programPtr,bool isMasterserverMode, const GameSettings *joinGameSettings=NULL);
+	static void loadGameFromString(const string &xmlData,Program *programPtr,bool isMasterserverMode, const GameSettings *joinGameSettings=NULL);
 
 	void addNetworkCommandToReplayList(NetworkCommand* networkCommand,int worldFrameCount);
 
@@ -407,6 +413,14 @@ private:
 	bool switchSetupForSlots(ServerInterface *& serverInterface,
 			int startIndex, int endIndex, bool onlyNetworkUnassigned);
 	void processNetworkSynchChecksIfRequired();
+	void verifyReplayAgainstSavedGame();
+	void loadReplayCommandHistory(const string &replayFile);
+	void buildSaveGameXml(XmlTree &xmlTree);
+	static void loadGameFromXml(XmlTree &xmlTree, const string &name, Program *programPtr,
+			bool isMasterserverMode, const GameSettings *joinGameSettings);
+	void sendPendingGameSnapshots(ServerInterface *server);
+	void processAIWorkerThreads(bool enableServerControlledAI, bool isNetworkGame, NetworkRole role);
+	void runSimulationBenchmark(int frameTotal);
 	Stats getEndGameStats();
 	void checkWinnerStandardHeadlessOrObserver();
 	void checkWinnerStandardPlayer();
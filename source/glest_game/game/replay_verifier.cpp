@@ -0,0 +1,66 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "replay_verifier.h"
+
+#include "conversion.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class ReplayVerifier
+// =====================================================
+
+uint32 ReplayVerifier::getFactionCRC(int factionIndex) const {
+	if(factionIndex < 0 || factionIndex >= (int)factionCRCs.size()) {
+		return 0;
+	}
+	return factionCRCs[factionIndex];
+}
+
+vector<int> ReplayVerifier::getMismatchedFactions(const vector<uint32> &replayedCRCs) const {
+	vector<int> result;
+	for(int i = 0; i < (int)replayedCRCs.size(); ++i) {
+		if(replayedCRCs[i] != getFactionCRC(i)) {
+			result.push_back(i);
+		}
+	}
+	return result;
+}
+
+void ReplayVerifier::saveGame(XmlNode *gameNode, const std::map<string,string> &mapTagReplacements) const {
+	for(unsigned int i = 0; i < factionCRCs.size(); ++i) {
+		XmlNode *factionCRCNode = gameNode->addChild("FactionCRC");
+		factionCRCNode->addAttribute("index",intToStr(i), mapTagReplacements);
+		factionCRCNode->addAttribute("crc",uIntToStr(factionCRCs[i]), mapTagReplacements);
+	}
+}
+
+void ReplayVerifier::loadGame(const XmlNode *gameNode) {
+	factionCRCs.clear();
+	vector<XmlNode *> factionCRCNodeList = gameNode->getChildList("FactionCRC");
+	for(unsigned int i = 0; i < factionCRCNodeList.size(); ++i) {
+		XmlNode *node = factionCRCNodeList[i];
+		int factionIndex = node->getAttribute("index")->getIntValue();
+		if(factionIndex < 0) {
+			continue;
+		}
+		if(factionIndex >= (int)factionCRCs.size()) {
+			factionCRCs.resize(factionIndex + 1, 0);
+		}
+		factionCRCs[factionIndex] = node->getAttribute("crc")->getUIntValue();
+	}
+}
+
+}}//end namespace
@@ -0,0 +1,54 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_REPLAYVERIFIER_H_
+#define _GLEST_GAME_REPLAYVERIFIER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "data_types.h"
+#include "xml_parser.h"
+#include "leak_dumper.h"
+
+using std::string;
+using std::vector;
+using Shared::Platform::uint32;
+using Shared::Xml::XmlNode;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class ReplayVerifier
+//
+///	Faction checksums taken at the frame a game was
+/// saved, to check a replay of its commands against
+// =====================================================
+
+class ReplayVerifier {
+private:
+	vector<uint32> factionCRCs;
+
+public:
+	bool hasFactionCRCs() const						{ return factionCRCs.empty() == false; }
+	void setFactionCRCs(const vector<uint32> &crcs)	{ factionCRCs = crcs; }
+
+	// 0 for factions without a saved checksum
+	uint32 getFactionCRC(int factionIndex) const;
+	vector<int> getMismatchedFactions(const vector<uint32> &replayedCRCs) const;
+
+	void saveGame(XmlNode *gameNode, const std::map<string,string> &mapTagReplacements) const;
+	void loadGame(const XmlNode *gameNode);
+};
+
+}}//end namespace
+
+#endif
@@ -16,6 +16,7 @@
 #include "game_camera.h"
 #include "game.h"
 #include "config.h"
+#include "sim_benchmark.h"
 
 #include "leak_dumper.h"
 
@@ -523,6 +524,8 @@ void ScriptManager::onMessageBoxOk(bool popFront) {
 }
 
 void ScriptManager::onResourceHarvested(){
+	SimBenchmarkTimer benchmarkTimer(sbsScripts);
+
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugLUA).enabled) SystemFlags::OutputDebug(SystemFlags::debugLUA,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	if(this->rootNode == NULL) {
@@ -532,6 +535,8 @@ void ScriptManager::onResourceHarvested(){
 }
 
 void ScriptManager::onUnitCreated(const Unit* unit){
+	SimBenchmarkTimer benchmarkTimer(sbsScripts);
+
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugLUA).enabled) SystemFlags::OutputDebug(SystemFlags::debugLUA,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	if(this->rootNode == NULL) {
@@ -545,6 +550,8 @@ void ScriptManager::onUnitCreated(const Unit* unit){
 }
 
 void ScriptManager::onUnitDied(const Unit* unit){
+	SimBenchmarkTimer benchmarkTimer(sbsScripts);
+
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugLUA).enabled) SystemFlags::OutputDebug(SystemFlags::debugLUA,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	if(this->rootNode == NULL) {
@@ -577,6 +584,8 @@ void ScriptManager::onUnitDied(const Unit* unit){
 }
 
 void ScriptManager::onUnitAttacked(const Unit* unit) {
+	SimBenchmarkTimer benchmarkTimer(sbsScripts);
+
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugLUA).enabled) SystemFlags::OutputDebug(SystemFlags::debugLUA,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	if(this->rootNode == NULL) {
@@ -588,6 +597,8 @@ void ScriptManager::onUnitAttacked(const Unit* unit) {
 }
 
 void ScriptManager::onUnitAttacking(const Unit* unit) {
+	SimBenchmarkTimer benchmarkTimer(sbsScripts);
+
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugLUA).enabled) SystemFlags::OutputDebug(SystemFlags::debugLUA,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	if(this->rootNode == NULL) {
@@ -607,6 +618,8 @@ void ScriptManager::onGameOver(bool won) {
 }
 
 void ScriptManager::onTimerTriggerEvent() {
+	SimBenchmarkTimer benchmarkTimer(sbsScripts);
+
 	if(TimerTriggerEventList.empty() == true) {
 		return;
 	}
@@ -647,6 +660,8 @@ void ScriptManager::onTimerTriggerEvent() {
 }
 
 void ScriptManager::onCellTriggerEvent(Unit *movingUnit) {
+	SimBenchmarkTimer benchmarkTimer(sbsScripts);
+
 	if(CellTriggerEventList.empty() == true) {
 		return;
 	}
@@ -1909,6 +1924,8 @@ const string ScriptManager::getUnitPropertyName(int unitId, UnitTriggerEventType
 }
 
 void ScriptManager::onUnitTriggerEvent(const Unit *unit, UnitTriggerEventType event) {
+	SimBenchmarkTimer benchmarkTimer(sbsScripts);
+
 	//static bool inEvent = false;
 	//if(inEvent == true) {
 	//	printf("\n\n!!!!!!!!!!!!!!! File: %s line: %d unit [%d - %s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__LINE__,unit->getId(),unit->getType()->getName().c_str());
@@ -1946,6 +1963,8 @@ void ScriptManager::unregisterDayNightEvent() {
 }
 
 void ScriptManager::onDayNightTriggerEvent() {
+	SimBenchmarkTimer benchmarkTimer(sbsScripts);
+
 	if(registeredDayNightEvent == true) {
 		bool isDay = (this->getIsDayTime() == 1);
 		if((lastDayNightTriggerStatus != 1 && isDay == true) ||
@@ -0,0 +1,87 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "sim_benchmark.h"
+
+#include <SDL.h>
+#include "leak_dumper.h"
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class SimBenchmark
+// =====================================================
+
+int SimBenchmark::frames = 0;
+bool SimBenchmark::enabled = false;
+uint64 SimBenchmark::sectionTicks[SimBenchmark::threadSlotCount][sbsCount];
+int SimBenchmark::sectionDepth[SimBenchmark::threadSlotCount][sbsCount];
+
+void SimBenchmark::reset() {
+	for(int slot = 0; slot < threadSlotCount; ++slot) {
+		for(int i = 0; i < sbsCount; ++i) {
+			sectionTicks[slot][i] = 0;
+			sectionDepth[slot][i] = 0;
+		}
+	}
+}
+
+int SimBenchmark::getThreadSlot() {
+	if(Thread::isCurrentThreadMainThread() == true) {
+		return 0;
+	}
+	// pool workers other than the calling thread have indexes from 1 up
+	int workerIndex = WorkStealingScheduler::getCurrentWorkerIndex();
+	return (workerIndex > 0 && workerIndex < threadSlotCount ? workerIndex : -1);
+}
+
+uint64 SimBenchmark::getTicks() {
+	return SDL_GetPerformanceCounter();
+}
+
+int64 SimBenchmark::ticksToMicros(uint64 ticks) {
+	uint64 frequency = SDL_GetPerformanceFrequency();
+	if(frequency == 0) {
+		return 0;
+	}
+	return (int64)(ticks / frequency * 1000000 + (ticks % frequency) * 1000000 / frequency);
+}
+
+int64 SimBenchmark::getSectionMicros(SimBenchmarkSection section) {
+	uint64 ticks = 0;
+	for(int slot = 0; slot < threadSlotCount; ++slot) {
+		ticks += sectionTicks[slot][section];
+	}
+	return ticksToMicros(ticks);
+}
+
+const char *SimBenchmark::getSectionName(SimBenchmarkSection section) {
+	switch(section) {
+		case sbsUnitUpdates:
+			return "Unit updates";
+		case sbsPathFinding:
+			return "Pathfinding";
+		case sbsFogOfWar:
+			return "Fog of war";
+		case sbsAI:
+			return "AI";
+		case sbsScripts:
+			return "Scripts";
+		case sbsCommands:
+			return "Commands";
+		case sbsCRC:
+			return "CRC";
+		default:
+			return "Unknown";
+	}
+}
+
+}}//end namespace
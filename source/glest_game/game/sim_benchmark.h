@@ -0,0 +1,110 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_SIMBENCHMARK_H_
+#define _GLEST_GAME_SIMBENCHMARK_H_
+
+#include "data_types.h"
+#include "thread.h"
+#include "work_stealing_scheduler.h"
+#include "leak_dumper.h"
+
+using Shared::Platform::int64;
+using Shared::Platform::uint64;
+using Shared::Platform::Thread;
+using Shared::PlatformCommon::WorkStealingScheduler;
+
+namespace Glest{ namespace Game{
+
+enum SimBenchmarkSection {
+	sbsUnitUpdates,
+	sbsPathFinding,
+	sbsFogOfWar,
+	sbsAI,
+	sbsScripts,
+	sbsCommands,
+	sbsCRC,
+
+	sbsCount
+};
+
+// =====================================================
+// 	class SimBenchmark
+//
+///	Time spent per simulation subsystem while running
+/// with --benchmark-sim. The main thread and the unit
+/// update scheduler workers each add to their own slot
+/// and a section's total is the sum over all of them.
+/// Nested sections of the same kind are counted once.
+// =====================================================
+
+class SimBenchmark {
+private:
+	static const int threadSlotCount = WorkStealingScheduler::maxWorkerCount;
+
+	static int frames;
+	static bool enabled;
+	static uint64 sectionTicks[threadSlotCount][sbsCount];
+	static int sectionDepth[threadSlotCount][sbsCount];
+
+	// slot of the calling thread, -1 for threads that aren't timed
+	static int getThreadSlot();
+
+	friend class SimBenchmarkTimer;
+
+public:
+	static void setFrames(int value)	{ frames = value; }
+	static int getFrames()				{ return frames; }
+
+	static void setEnabled(bool value)	{ enabled = value; }
+	static bool isEnabled()				{ return enabled; }
+
+	static void reset();
+	static uint64 getTicks();
+	static int64 ticksToMicros(uint64 ticks);
+
+	static int64 getSectionMicros(SimBenchmarkSection section);
+	static const char *getSectionName(SimBenchmarkSection section);
+};
+
+// =====================================================
+// 	class SimBenchmarkTimer
+//
+///	Adds the lifetime of a scope to a benchmark section
+// =====================================================
+
+class SimBenchmarkTimer {
+private:
+	SimBenchmarkSection section;
+	int slot;
+	bool counting;
+	uint64 startTicks;
+
+public:
+	SimBenchmarkTimer(SimBenchmarkSection section) {
+		this->section = section;
+		this->slot = (SimBenchmark::enabled == true ? SimBenchmark::getThreadSlot() : -1);
+		this->counting = (slot >= 0 && SimBenchmark::sectionDepth[slot][section]++ == 0);
+		this->startTicks = (counting == true ? SimBenchmark::getTicks() : 0);
+	}
+	~SimBenchmarkTimer() {
+		if(slot >= 0) {
+			SimBenchmark::sectionDepth[slot][section]--;
+		}
+		if(counting == true) {
+			SimBenchmark::sectionTicks[slot][section] += SimBenchmark::getTicks() - startTicks;
+		}
+	}
+};
+
+}}//end namespace
+
+#endif
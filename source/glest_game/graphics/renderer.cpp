@@ -938,6 +938,14 @@ Texture3D *Renderer::newTexture3D(ResourceScope rs){
 	return textureManager[rs]->newTexture3D();
 }
 
+bool Renderer::isModelTexture(ResourceScope rs, const string &path) {
+	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
+		return false;
+	}
+
+	return textureManager[rs]->findModelTexture(path) != NULL;
+}
+
 Font2D *Renderer::newFont(ResourceScope rs){
 	if(GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true) {
 		return NULL;
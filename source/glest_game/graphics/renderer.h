@@ -477,6 +477,8 @@ public:
 
 	Texture2D *newTexture2D(ResourceScope rs);
 	Texture3D *newTexture3D(ResourceScope rs);
+	// true when model meshes share the texture loaded from path
+	bool isModelTexture(ResourceScope rs, const string &path);
 	Font2D *newFont(ResourceScope rs);
 	Font3D *newFont3D(ResourceScope rs);
 	void endFont(::Shared::Graphics::Font *font, ResourceScope rs, bool mustExistInList=false);
@@ -56,6 +56,8 @@
 #include <locale.h>
 #include "string_utils.h"
 #include "auto_test.h"
+#include "sim_benchmark.h"
+#include "network_load_test.h"
 #include "lua_script.h"
 #include "interpolation.h"
 #include "common_scoped_ptr.h"
@@ -82,7 +84,7 @@
 
 #include <stdlib.h>
 #include "network_message.h"
-#include "network_protocol.h"
+#include "packed_format.h"
 #include "conversion.h"
 #include "gen_uuid.h"
 //#include "intro.h"
@@ -3880,6 +3882,37 @@ int handleShowCRCValuesCommand(int argc, char** argv) {
 	return return_value;
 }
 
+int handleLoadTestCommand(int argc, char** argv) {
+	int clientCount = 0;
+	int keyframeCount = 0;
+	int foundParamIndIndex = -1;
+	hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_LOAD_TEST_CLIENTS]) + string("="),&foundParamIndIndex);
+	if(foundParamIndIndex >= 0) {
+		string paramValue = argv[foundParamIndIndex];
+		vector<string> paramPartTokens;
+		Tokenize(paramValue,paramPartTokens,"=");
+		if(paramPartTokens.size() >= 2 && paramPartTokens[1].length() > 0) {
+			vector<string> paramPartTokens2;
+			Tokenize(paramPartTokens[1],paramPartTokens2,",");
+			if(paramPartTokens2.size() >= 2) {
+				clientCount = strToInt(paramPartTokens2[0]);
+				keyframeCount = strToInt(paramPartTokens2[1]);
+			}
+		}
+	}
+	if(clientCount <= 0 || clientCount > GameConstants::maxPlayers || keyframeCount <= 0) {
+		printf("\nInvalid load test parameters, expected %s=clients,keyframes with 1 to %d clients\n\n",GAME_ARGS[GAME_ARG_LOAD_TEST_CLIENTS],GameConstants::maxPlayers);
+		return 1;
+	}
+
+	// normally set up by the Program, which this mode never creates
+	NetworkInterface::setAllowGameDataSynchCheck(Config::getInstance().getBool("AllowGameDataSynchCheck","false"));
+
+	int port = Config::getInstance().getInt("PortServer", intToStr(GameConstants::serverPort).c_str());
+	NetworkLoadTest loadTest(clientCount, port, keyframeCount);
+	return (loadTest.run() == true ? 0 : 1);
+}
+
 int handleListDataCommand(int argc, char** argv) {
 	int return_value = 1;
 	if(hasCommandArgument(argc, argv,GAME_ARGS[GAME_ARG_LIST_MAPS]) == true) {
@@ -4169,6 +4202,31 @@ int handleListDataCommand(int argc, char** argv) {
 	return return_value;
 }
 
+string findSavedGameFile(string fileName, const string &userData) {
+	if(fileExists(fileName) == false) {
+		// Save the file now
+		string saveGameFile = "saved/" + fileName;
+		if(getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) != "") {
+			saveGameFile = getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) + saveGameFile;
+		}
+		else {
+			saveGameFile = userData + saveGameFile;
+		}
+		if(fileExists(saveGameFile) == true) {
+			fileName = saveGameFile;
+		}
+	}
+
+	if(fileExists(fileName) == false) {
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"File specified for loading a saved game cannot be found: [%s]",fileName.c_str());
+		printf("\n\n======================================================================================\n%s\n======================================================================================\n\n\n",szBuf);
+
+		throw megaglest_runtime_error(szBuf);
+	}
+	return fileName;
+}
+
 int glestMain(int argc, char** argv) {
 #ifdef SL_LEAK_DUMP
 	//AllocInfo::set_application_binary(executable_path(argv[0],true));
@@ -4231,6 +4289,11 @@ int glestMain(int argc, char** argv) {
 		return 2;
 	}
 
+    if( hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_BENCHMARK_SIM])) == true ||
+    	hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_LOAD_TEST_CLIENTS])) == true) {
+    	GlobalStaticFlags::setIsNonGraphicalModeEnabled(true);
+    }
+
     if( hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_MASTERSERVER_MODE])) == true) {
     	//isMasterServerModeEnabled = true;
     	//Window::setMasterserverMode(isMasterServerModeEnabled);
@@ -4602,6 +4665,29 @@ int glestMain(int argc, char** argv) {
 			config.setBool("DebugNetworkPacketStats",true,true);
 		}
 
+		if(hasCommandArgument(argc, argv,GAME_ARGS[GAME_ARG_NETWORK_TELEMETRY]) == true) {
+			int foundParamIndIndex = -1;
+			hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_NETWORK_TELEMETRY]) + string("="),&foundParamIndIndex);
+			if(foundParamIndIndex < 0) {
+				hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_NETWORK_TELEMETRY]),&foundParamIndIndex);
+			}
+			string paramValue = argv[foundParamIndIndex];
+			vector<string> paramPartTokens;
+			Tokenize(paramValue,paramPartTokens,"=");
+			if(paramPartTokens.size() >= 2 && paramPartTokens[1].length() > 0) {
+				printf("*NOTE: writing network telemetry to [%s].\n",paramPartTokens[1].c_str());
+				config.setString("NetworkTelemetryFile",paramPartTokens[1],true);
+			}
+			else {
+				printf("\nInvalid missing network telemetry file specified on commandline [%s] value [%s]\n\n",argv[foundParamIndIndex],(paramPartTokens.size() >= 2 ? paramPartTokens[1].c_str() : NULL));
+				return 1;
+			}
+		}
+		// headless servers always count, --headless-server-status reports it
+		NetworkTelemetry::setEnabled(config.getString("NetworkTelemetryFile","") != "" ||
+									 config.getBool("NetworkTelemetry","false") == true ||
+									 GlobalStaticFlags::getIsNonGraphicalModeEnabled() == true);
+
 		if(hasCommandArgument(argc, argv,GAME_ARGS[GAME_ARG_ENABLE_NEW_PROTOCOL]) == true) {
 			printf("*NOTE: enabling new network protocol.\n");
 			NetworkMessage::useOldProtocol = false;
@@ -4739,7 +4825,9 @@ int glestMain(int argc, char** argv) {
         }
 
 	    if( hasCommandArgument(argc, argv,GAME_ARGS[GAME_ARG_DISABLE_SOUND]) == true ||
-	    	hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_MASTERSERVER_MODE])) == true) {
+	    	hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_MASTERSERVER_MODE])) == true ||
+	    	hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_BENCHMARK_SIM])) == true ||
+	    	hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_LOAD_TEST_CLIENTS])) == true) {
 	    	config.setString("FactorySound","None",true);
 	    	if(hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_MASTERSERVER_MODE])) == true) {
 	    		//Logger::getInstance().setMasterserverMode(true);
@@ -5172,6 +5260,10 @@ int glestMain(int argc, char** argv) {
 
     	}
 
+    	if(hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_LOAD_TEST_CLIENTS])) == true) {
+    		return handleLoadTestCommand(argc, argv);
+    	}
+
 		program= new Program();
 		mainProgram = program;
 		renderer.setProgram(program);
@@ -5235,34 +5327,40 @@ int glestMain(int argc, char** argv) {
 				vector<string> paramPartTokens;
 				Tokenize(loadfileName,paramPartTokens,"=");
 				if(paramPartTokens.size() >= 2 && paramPartTokens[1].length() > 0) {
-					fileName = paramPartTokens[1];
-
-					if(fileExists(fileName) == false) {
-						// Save the file now
-						string saveGameFile = "saved/" + fileName;
-						if(getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) != "") {
-							saveGameFile = getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) + saveGameFile;
-						}
-						else {
-							saveGameFile = userData + saveGameFile;
-						}
-						if(fileExists(saveGameFile) == true) {
-							fileName = saveGameFile;
-						}
-					}
-
-					if(fileExists(fileName) == false) {
-						char szBuf[8096]="";
-						snprintf(szBuf,8096,"File specified for loading a saved game cannot be found: [%s]",fileName.c_str());
-						printf("\n\n======================================================================================\n%s\n======================================================================================\n\n\n",szBuf);
-
-						throw megaglest_runtime_error(szBuf);
-					}
+					fileName = findSavedGameFile(paramPartTokens[1],userData);
 				}
 			}
 			program->initSavedGame(mainWindow,false,fileName);
 			gameInitialized = true;
 		}
+		else if(hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_BENCHMARK_SIM])) == true) {
+			string fileName = "";
+			int frameTotal = 0;
+			int foundParamIndIndex = -1;
+			hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_BENCHMARK_SIM]) + string("="),&foundParamIndIndex);
+			if(foundParamIndIndex >= 0) {
+				string paramValue = argv[foundParamIndIndex];
+				vector<string> paramPartTokens;
+				Tokenize(paramValue,paramPartTokens,"=");
+				if(paramPartTokens.size() >= 2 && paramPartTokens[1].length() > 0) {
+					vector<string> paramPartTokens2;
+					Tokenize(paramPartTokens[1],paramPartTokens2,",");
+					if(paramPartTokens2.size() >= 2 && paramPartTokens2[0].length() > 0) {
+						fileName = findSavedGameFile(paramPartTokens2[0],userData);
+						frameTotal = strToInt(paramPartTokens2[1]);
+					}
+				}
+			}
+			if(fileName == "" || frameTotal <= 0) {
+				char szBuf[8096]="";
+				snprintf(szBuf,8096,"Invalid benchmark parameters, expected %s=savegame,frames",GAME_ARGS[GAME_ARG_BENCHMARK_SIM]);
+				throw megaglest_runtime_error(szBuf);
+			}
+
+			SimBenchmark::setFrames(frameTotal);
+			program->initSavedGame(mainWindow,true,fileName);
+			gameInitialized = true;
+		}
 		else if(hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_PREVIEW_MAP])) == true) {
 			int foundParamIndIndex = -1;
 			hasCommandArgument(argc, argv,string(GAME_ARGS[GAME_ARG_PREVIEW_MAP]) + string("="),&foundParamIndIndex);
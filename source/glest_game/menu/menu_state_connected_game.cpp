@@ -687,6 +687,7 @@ MenuStateConnectedGame::MenuStateConnectedGame(Program *program, MainMenu *mainM
             tempFilePath = userData + tempFilePath;
     	}
     	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Temp files path [%s]\n",tempFilePath.c_str());
+    	contentSyncStagingPath = tempFilePath + "content_sync/";
 
         ftpClientThread = new FTPClientThread(portNumber,serverUrl,
         		mapsPath,tilesetsPath,techtreesPath,scenariosPath,
@@ -1360,7 +1361,9 @@ void MenuStateConnectedGame::mouseClick(int x, int y, MouseButton mouseButton){
                     		safeMutexFTPProgress.ReleaseLock();
                     	}
                     	else {
-                    		ftpClientThread->addMapToRequests(getMissingMapFromFTPServer);
+                    		if(requestContentSync(ftp_cct_Map,getMissingMapFromFTPServer) == false) {
+                    			ftpClientThread->addMapToRequests(getMissingMapFromFTPServer);
+                    		}
                     		MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
                     		fileFTPProgressList[getMissingMapFromFTPServer] = pair<int,string>(0,"");
                     		safeMutexFTPProgress.ReleaseLock();
@@ -1398,7 +1401,9 @@ void MenuStateConnectedGame::mouseClick(int x, int y, MouseButton mouseButton){
                     		safeMutexFTPProgress.ReleaseLock();
                     	}
                     	else {
-							ftpClientThread->addTilesetToRequests(getMissingTilesetFromFTPServer);
+							if(requestContentSync(ftp_cct_Tileset,getMissingTilesetFromFTPServer) == false) {
+								ftpClientThread->addTilesetToRequests(getMissingTilesetFromFTPServer);
+							}
 							MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
 							fileFTPProgressList[getMissingTilesetFromFTPServer] = pair<int,string>(0,"");
 							safeMutexFTPProgress.ReleaseLock();
@@ -1436,7 +1441,9 @@ void MenuStateConnectedGame::mouseClick(int x, int y, MouseButton mouseButton){
                     		safeMutexFTPProgress.ReleaseLock();
                     	}
                     	else {
-							ftpClientThread->addTechtreeToRequests(getMissingTechtreeFromFTPServer);
+							if(requestContentSync(ftp_cct_Techtree,getMissingTechtreeFromFTPServer) == false) {
+								ftpClientThread->addTechtreeToRequests(getMissingTechtreeFromFTPServer);
+							}
 							MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
 							fileFTPProgressList[getMissingTechtreeFromFTPServer] = pair<int,string>(0,"");
 							safeMutexFTPProgress.ReleaseLock();
@@ -1467,6 +1474,7 @@ void MenuStateConnectedGame::mouseClick(int x, int y, MouseButton mouseButton){
 			ftpClientThread = NULL;
 
             fileFTPProgressList.clear();
+            clientInterface->cancelContentRequests();
             getMissingMapFromFTPServerInProgress 		= false;
             getMissingTilesetFromFTPServerInProgress 	= false;
             getMissingTechtreeFromFTPServerInProgress 	= false;
@@ -3006,6 +3014,23 @@ void MenuStateConnectedGame::render() {
         }
         safeMutexFTPProgress.ReleaseLock();
 
+        int snapshotProgress = (clientInterface != NULL ? clientInterface->getJoinGameSnapshotProgress() : -1);
+        if(snapshotProgress >= 0) {
+        	Lang &lang= Lang::getInstance();
+        	string progressLabelPrefix = (lang.hasString("JoinGameSnapshotProgress") == true ?
+        			lang.getString("JoinGameSnapshotProgress") : string("Receiving game")) + " ";
+        	if(Renderer::renderText3DEnabled) {
+        		renderer.renderProgressBar3D(snapshotProgress,buttonCancelDownloads.getX(),
+        				buttonCancelDownloads.getY() - 20 * ((int)fileFTPProgressList.size() + 1),
+        				CoreData::getInstance().getDisplayFontSmall3D(),300,progressLabelPrefix);
+        	}
+        	else {
+        		renderer.renderProgressBar(snapshotProgress,buttonCancelDownloads.getX(),
+        				buttonCancelDownloads.getY() - 20 * ((int)fileFTPProgressList.size() + 1),
+        				CoreData::getInstance().getDisplayFontSmall(),300,progressLabelPrefix);
+        	}
+        }
+
 		renderer.renderComboBox(&comboBoxMap);
 		renderer.renderComboBox(&comboBoxLoadSetup);
 
@@ -3776,10 +3801,25 @@ void MenuStateConnectedGame::update() {
 			if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] took msecs: %lld\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
 			if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) chrono.start();
 
+			// check if we are joining an in progress game that the server
+			// streamed over the game connection
+			if( clientInterface->getJoinGameInProgress() == true &&
+				clientInterface->getJoinGameInProgressLaunch() == true &&
+			    clientInterface->getReadyForInGameJoin() == true &&
+			    clientInterface->getJoinGameSnapshotComplete() == true) {
+
+				GameSettings gameSettings = *clientInterface->getGameSettings();
+				copyToGameSettings(&gameSettings);
+
+				Game::loadGameFromString(clientInterface->takeJoinGameSnapshot(),program,false,&gameSettings);
+				return;
+			}
+
 			// check if we are joining an in progress game
 			if( clientInterface->getJoinGameInProgress() == true &&
 				clientInterface->getJoinGameInProgressLaunch() == true &&
 			    clientInterface->getReadyForInGameJoin() == true &&
+			    (clientInterface->getPeerCapabilities() & ncapGameSnapshotStream) == 0 &&
 			   ftpClientThread != NULL) {
 
 				if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] took msecs: %lld\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
@@ -3837,6 +3877,7 @@ void MenuStateConnectedGame::update() {
 				if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) chrono.start();
 
 				clientInterface->updateLobby();
+				updateContentSync(clientInterface);
 
 				if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] took msecs: %lld\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
 				if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) chrono.start();
@@ -4446,6 +4487,65 @@ bool MenuStateConnectedGame::isInSpecialKeyCaptureEvent() {
 	return result;
 }
 
+bool MenuStateConnectedGame::requestContentSync(FTP_Client_CallbackType type, const string &itemName) {
+	ContentSyncType contentType = cstMap;
+	PathType pathType = ptMaps;
+	if(type == ftp_cct_Tileset) {
+		contentType = cstTileset;
+		pathType = ptTilesets;
+	}
+	else if(type == ftp_cct_Techtree) {
+		contentType = cstTechtree;
+		pathType = ptTechs;
+	}
+
+	// downloads go to the user data folder, same as the ftp client's
+	vector<string> pathList = Config::getInstance().getPathListForType(pathType);
+	ClientInterface *clientInterface = NetworkManager::getInstance().getClientInterface();
+	if(clientInterface == NULL || pathList.empty() == true || contentSyncStagingPath == "") {
+		return false;
+	}
+	string destFolder = pathList[pathList.size() > 1 ? 1 : 0];
+	return clientInterface->requestContent(contentType, itemName, destFolder, contentSyncStagingPath);
+}
+
+void MenuStateConnectedGame::updateContentSync(ClientInterface *clientInterface) {
+	const FTP_Client_CallbackType callbackTypes[cstCount] = { ftp_cct_Map, ftp_cct_Tileset, ftp_cct_Techtree };
+	const string itemNames[cstCount] = { getMissingMapFromFTPServer, getMissingTilesetFromFTPServer, getMissingTechtreeFromFTPServer };
+
+	MutexSafeWrapper safeMutexFTPProgress((ftpClientThread != NULL ? ftpClientThread->getProgressMutex() : NULL),string(__FILE__) + "_" + intToStr(__LINE__));
+	for(int type = 0; type < cstCount; ++type) {
+		std::map<string,pair<int,string> >::iterator iterFind = fileFTPProgressList.find(itemNames[type]);
+		if(iterFind != fileFTPProgressList.end() &&
+			clientInterface->isRequestingContent(static_cast<ContentSyncType>(type), itemNames[type]) == true) {
+			iterFind->second.first = clientInterface->getContentProgress(static_cast<ContentSyncType>(type));
+		}
+	}
+	safeMutexFTPProgress.ReleaseLock();
+
+	ContentSyncClient::Result result;
+	for(;clientInterface->takeFinishedContent(result) == true;) {
+		if(result.success == true) {
+			FTPClient_CallbackEvent(result.name, callbackTypes[result.type], make_pair(ftp_crt_SUCCESS,string("")), NULL);
+		}
+		else if(ftpClientThread != NULL) {
+			// fall back to fetching the whole content over ftp
+			if(result.type == cstMap) {
+				ftpClientThread->addMapToRequests(result.name);
+			}
+			else if(result.type == cstTileset) {
+				ftpClientThread->addTilesetToRequests(result.name);
+			}
+			else {
+				ftpClientThread->addTechtreeToRequests(result.name);
+			}
+		}
+		else {
+			FTPClient_CallbackEvent(result.name, callbackTypes[result.type], make_pair(ftp_crt_FAIL,string("")), NULL);
+		}
+	}
+}
+
 void MenuStateConnectedGame::FTPClient_CallbackEvent(string itemName,
 		FTP_Client_CallbackType type, pair<FTP_Client_ResultType,string> result, void *userdata) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
@@ -31,6 +31,7 @@ namespace Shared { namespace Graphics {
 namespace Glest { namespace Game {
 
 class TechTree;
+class ClientInterface;
 
 enum JoinMenu {
 	jmSimple,
@@ -213,6 +214,7 @@ private:
     vector<pair<string,uint32> > factionCRCList;
 
     std::map<string,pair<int,string> > fileFTPProgressList;
+    string contentSyncStagingPath;
     GraphicButton buttonCancelDownloads;
 
 	GraphicLabel labelEnableSwitchTeamMode;
@@ -298,6 +300,9 @@ private:
     void showFTPMessageBox(const string &text, const string &header, bool toggle);
     virtual void FTPClient_CallbackEvent(string itemName,
     		FTP_Client_CallbackType type, pair<FTP_Client_ResultType,string> result,void *userdata);
+    // downloads over the game socket when the server supports it
+    bool requestContentSync(FTP_Client_CallbackType type, const string &itemName);
+    void updateContentSync(ClientInterface *clientInterface);
 
     int32 getNetworkPlayerStatus();
     void cleanupMapPreviewTexture();
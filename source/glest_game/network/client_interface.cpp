@@ -20,6 +20,8 @@
 #include "config.h"
 #include "lang.h"
 #include "config.h"
+#include "compression_utils.h"
+#include "sim_benchmark.h"
 #include <stdexcept>
 #include <cassert>
 
@@ -42,6 +44,10 @@ const bool debugClientInterfacePerf = false;
 const int ClientInterface::messageWaitTimeout					= 10000;	//10 seconds
 const int ClientInterface::waitSleepTime						= 10;
 const int ClientInterface::maxNetworkCommandListSendTimeWait 	= 5;
+// a signal wakes the waiting thread right away, the slices only bound
+// how late a quit or disconnect is noticed
+const int ClientInterface::commandListWaitSliceMillis			= 20;
+const int ClientInterface::messageWaitSliceMicroseconds			= 5000;
 
 // =====================================================
 //	class ClientInterfaceThread
@@ -188,10 +194,15 @@ ClientInterface::ClientInterface() : GameNetworkInterface() {
 	cachedPendingCommandsIndex 			= 0;
 	cachedLastPendingFrameCount 		= 0;
 	timeClientWaitedForLastMessage 		= 0;
+	networkCommandListReceived 			= new Trigger(networkCommandListThreadAccessor);
+
+	lastNetworkTelemetryPingTime		= 0;
+	lastNetworkTelemetryWriteTime		= 0;
 
 	flagAccessor 						= new Mutex(CODE_AT_LINE);
 
 	clientSocket						= NULL;
+	observerRelayChain					= NULL;
 	sessionKey 							= 0;
 	launchGame							= false;
 	introDone							= false;
@@ -200,6 +211,9 @@ ClientInterface::ClientInterface() : GameNetworkInterface() {
 	this->joinGameInProgressLaunch 		= false;
 	this->readyForInGameJoin 			= false;
 	this->resumeInGameJoin 				= false;
+	this->joinGameSnapshotSize 			= 0;
+	this->joinGameSnapshotCompressedSize = 0;
+	this->joinGameSnapshotComplete 		= false;
 
 	quitThreadAccessor 					= new Mutex(CODE_AT_LINE);
 	setQuitThread(false);
@@ -330,6 +344,10 @@ ClientInterface::~ClientInterface() {
 
 	//printf("C === Client destructor\n");
 
+	Trigger *commandListReceived = networkCommandListReceived;
+	networkCommandListReceived = NULL;
+	delete commandListReceived;
+
 	networkCommandListThreadAccessor = NULL;
 	safeMutex.ReleaseLock(false,true);
 
@@ -342,6 +360,10 @@ ClientInterface::~ClientInterface() {
 	delete quitThreadAccessor;
 	quitThreadAccessor = NULL;
 
+	// the client socket that fed it is gone by now
+	delete observerRelayChain;
+	observerRelayChain = NULL;
+
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("%s Line: %d\n",__FUNCTION__,__LINE__);
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 }
@@ -353,6 +375,11 @@ bool ClientInterface::getQuitThread() {
 void ClientInterface::setQuitThread(bool value) {
 	MutexSafeWrapper safeMutex(quitThreadAccessor,CODE_AT_LINE);
 	this->quitThread = value;
+	safeMutex.ReleaseLock();
+
+	if(value == true) {
+		signalNetworkCommandListReceived();
+	}
 }
 
 bool ClientInterface::getQuit() {
@@ -362,6 +389,18 @@ bool ClientInterface::getQuit() {
 void ClientInterface::setQuit(bool value) {
 	MutexSafeWrapper safeMutex(quitThreadAccessor,CODE_AT_LINE);
 	this->quit = value;
+	safeMutex.ReleaseLock();
+
+	if(value == true) {
+		signalNetworkCommandListReceived();
+	}
+}
+
+void ClientInterface::signalNetworkCommandListReceived() {
+	// wakes a game thread blocked in getNetworkCommand
+	if(networkCommandListReceived != NULL) {
+		networkCommandListReceived->signal(true);
+	}
 }
 
 bool ClientInterface::getJoinGameInProgress() {
@@ -378,6 +417,51 @@ bool ClientInterface::getReadyForInGameJoin() {
 	return readyForInGameJoin;
 }
 
+int ClientInterface::getJoinGameSnapshotProgress() {
+	MutexSafeWrapper safeMutex(flagAccessor,CODE_AT_LINE);
+	if(joinGameSnapshotCompressedSize == 0) {
+		return -1;
+	}
+	return (int)((uint64)joinGameSnapshot.size() * 100 / joinGameSnapshotCompressedSize);
+}
+
+bool ClientInterface::getJoinGameSnapshotComplete() {
+	MutexSafeWrapper safeMutex(flagAccessor,CODE_AT_LINE);
+	return joinGameSnapshotComplete;
+}
+
+string ClientInterface::takeJoinGameSnapshot() {
+	MutexSafeWrapper safeMutex(flagAccessor,CODE_AT_LINE);
+	if(joinGameSnapshotComplete == false) {
+		throw megaglest_runtime_error("The saved game from the server has not been received yet");
+	}
+	std::vector<unsigned char> compressedSnapshot;
+	compressedSnapshot.swap(joinGameSnapshot);
+	uint32 snapshotSize = joinGameSnapshotSize;
+	joinGameSnapshotSize = 0;
+	joinGameSnapshotCompressedSize = 0;
+	joinGameSnapshotComplete = false;
+	safeMutex.ReleaseLock();
+
+	std::pair<unsigned char *,unsigned long> extracted =
+			Shared::CompressionUtil::extractMemoryToMemory(&compressedSnapshot[0],
+					(unsigned long)compressedSnapshot.size(), snapshotSize);
+	string result((const char *)extracted.first, extracted.second);
+	delete [] extracted.first;
+	return result;
+}
+
+bool ClientInterface::requestContent(ContentSyncType type, const string &name, const string &destFolder, const string &stagingFolder) {
+	if(gotIntro == false || (getPeerCapabilities() & ncapContentSync) == 0 ||
+		contentSync.start(type, name, destFolder, stagingFolder) == false) {
+		return false;
+	}
+
+	NetworkMessageContentManifest networkMessageContentManifest(type, name);
+	sendMessage(&networkMessageContentManifest);
+	return true;
+}
+
 bool ClientInterface::getResumeInGameJoin() {
 	MutexSafeWrapper safeMutex(flagAccessor,CODE_AT_LINE);
 	return resumeInGameJoin;
@@ -399,6 +483,7 @@ void ClientInterface::connect(const Ip &ip, int port) {
 
 	clientSocket = new ClientSocket();
 	clientSocket->setBlock(false);
+	startObserverRelayChain();
 	clientSocket->connect(ip, port);
 	connectedTime = time(NULL);
 	//clientSocket->setBlock(true);
@@ -406,6 +491,57 @@ void ClientInterface::connect(const Ip &ip, int port) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s] END - socket = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,clientSocket->getSocketId());
 }
 
+// A chained relay has to see the stream from the first byte on, so it
+// starts before the connection does and is stopped at launch if this
+// client turns out to be a player
+void ClientInterface::startObserverRelayChain() {
+	delete observerRelayChain;
+	observerRelayChain = NULL;
+
+	int relayChainPort = Config::getInstance().getInt("ObserverRelayChainPort","0");
+	if(relayChainPort <= 0) {
+		return;
+	}
+	try {
+		observerRelayChain = new ObserverRelayChain(relayChainPort,
+				Config::getInstance().getInt("ObserverRelayChainMaxObservers","8"),
+				Config::getInstance().getInt("ObserverRelayChainMaxStreamMegabytes","32"));
+		clientSocket->setReceiveTap(observerRelayChain);
+		observerRelayChain->start();
+	}
+	catch(const exception &ex) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Warning observer relay chain bind/listen error:\n%s\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
+
+		if(clientSocket != NULL) {
+			clientSocket->setReceiveTap(NULL);
+		}
+		delete observerRelayChain;
+		observerRelayChain = NULL;
+	}
+}
+
+// Only observers pass the game on, the launch settings tell a client
+// which slot it got
+void ClientInterface::stopObserverRelayChainForPlayer() {
+	if(observerRelayChain == NULL) {
+		return;
+	}
+	int thisFactionIndex = gameSettings.getThisFactionIndex();
+	if(thisFactionIndex >= 0 &&
+		gameSettings.getFactionTypeName(thisFactionIndex) == formatString(GameConstants::OBSERVER_SLOTNAME)) {
+		return;
+	}
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] not an observer, stopping the observer relay chain\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
+
+	// no receive is using the relay once the tap is cleared
+	if(clientSocket != NULL) {
+		clientSocket->setReceiveTap(NULL);
+	}
+	delete observerRelayChain;
+	observerRelayChain = NULL;
+}
+
 void ClientInterface::reset() {
     if(getSocket() != NULL) {
     	Lang &lang= Lang::getInstance();
@@ -493,6 +629,8 @@ void ClientInterface::update() {
 			sendTextMessage(sMsg,-1, true,"");
 			sleep(1);
 		}
+
+		updateNetworkTelemetry(true);
 	}
 	catch(const megaglest_runtime_error &ex) {
 		SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
@@ -526,6 +664,9 @@ std::string ClientInterface::getServerIpAddress() {
 }
 
 void ClientInterface::updateLobby() {
+	// the lobby sends its own pings
+	updateNetworkTelemetry(false);
+
 	Chrono chrono;
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) chrono.start();
 
@@ -553,6 +694,7 @@ void ClientInterface::updateLobby() {
 				serverName		= networkMessageIntro.getName();
 				serverUUID 		= networkMessageIntro.getPlayerUUID();
 				serverPlatform 	= networkMessageIntro.getPlayerPlatform();
+				setPeerCapabilities(networkMessageIntro.getCapabilities());
 				serverFTPPort 	= networkMessageIntro.getFtpPort();
 
 				if(playerIndex < 0 || playerIndex >= GameConstants::maxPlayers) {
@@ -631,7 +773,7 @@ void ClientInterface::updateLobby() {
 							serverFTPPort,
 							lang.getLanguage(),
 							networkMessageIntro.getGameInProgress(),
-							Config::getInstance().getString("PlayerId",""),
+							(localPlayerUUID != "" ? localPlayerUUID : Config::getInstance().getString("PlayerId","")),
 							getPlatformNameString());
 					sendMessage(&sendNetworkMessageIntro);
 
@@ -691,6 +833,7 @@ void ClientInterface::updateLobby() {
 
 				if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 				this->setLastPingInfo(networkMessagePing);
+				handlePingMessage(networkMessagePing);
 			}
 		}
 		break;
@@ -966,6 +1109,7 @@ void ClientInterface::updateLobby() {
                 }
 
                 if(networkMessageLaunch.getMessageType() == nmtLaunch) {
+                	stopObserverRelayChainForPlayer();
                 	launchGame = true;
                 }
                 else if(networkMessageLaunch.getMessageType() == nmtBroadCastSetup) {
@@ -1010,13 +1154,60 @@ void ClientInterface::updateLobby() {
 		}
 		break;
 
+		case nmtGameSnapshotChunk:
+		{
+			NetworkMessageGameSnapshotChunk networkMessageChunk;
+			if(receiveMessage(&networkMessageChunk)) {
+				this->setLastPingInfoToNow();
+
+				MutexSafeWrapper safeMutexFlags(flagAccessor,CODE_AT_LINE);
+				if(networkMessageChunk.getOffset() == 0) {
+					joinGameSnapshot.clear();
+					joinGameSnapshot.reserve(networkMessageChunk.getCompressedSize());
+					joinGameSnapshotSize = networkMessageChunk.getSnapshotSize();
+					joinGameSnapshotCompressedSize = networkMessageChunk.getCompressedSize();
+					joinGameSnapshotComplete = false;
+				}
+				if(networkMessageChunk.getOffset() != joinGameSnapshot.size() ||
+					networkMessageChunk.getCompressedSize() != joinGameSnapshotCompressedSize) {
+					throw megaglest_runtime_error("Unexpected saved game chunk at offset " + uIntToStr(networkMessageChunk.getOffset()));
+				}
+				joinGameSnapshot.insert(joinGameSnapshot.end(),networkMessageChunk.getChunk(),
+						networkMessageChunk.getChunk() + networkMessageChunk.getChunkSize());
+				joinGameSnapshotComplete = (joinGameSnapshot.size() == joinGameSnapshotCompressedSize);
+			}
+		}
+		break;
+
+		case nmtContentManifest:
+		{
+			NetworkMessageContentManifest networkMessageContentManifest;
+			if(receiveMessage(&networkMessageContentManifest)) {
+				this->setLastPingInfoToNow();
+				contentSync.handleManifest(networkMessageContentManifest);
+			}
+		}
+		break;
+
+		case nmtContentChunk:
+		{
+			NetworkMessageContentChunk networkMessageContentChunk;
+			if(receiveMessage(&networkMessageContentChunk)) {
+				this->setLastPingInfoToNow();
+				contentSync.handleChunk(networkMessageContentChunk);
+			}
+		}
+		break;
+
 		case nmtCommandList:
+		case nmtCommandListCompact:
+		case nmtCommandListHeartbeat:
 			{
 
 			//make sure we read the message
 			//time_t receiveTimeElapsed = time(NULL);
 			NetworkMessageCommandList networkMessageCommandList;
-			bool gotCmd = receiveMessage(&networkMessageCommandList);
+			bool gotCmd = receiveCommandList(&networkMessageCommandList,networkMessageType);
 			if(gotCmd == false) {
 				throw megaglest_runtime_error("error retrieving nmtCommandList returned false!");
 			}
@@ -1073,6 +1264,14 @@ void ClientInterface::updateLobby() {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] took msecs: %lld\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) chrono.start();
 
+	if(gotIntro == true && clientSocket != NULL && clientSocket->isConnected() == true) {
+		vector<NetworkMessageContentChunkRequest> contentRequests;
+		contentSync.getChunkRequests(contentRequests);
+		for(unsigned int index = 0; index < contentRequests.size(); ++index) {
+			sendMessage(&contentRequests[index]);
+		}
+	}
+
 	if( clientSocket != NULL && clientSocket->isConnected() == true &&
 		gotIntro == false && difftime((long int)time(NULL),connectedTime) > GameConstants::maxClientConnectHandshakeSecs) {
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] difftime(time(NULL),connectedTime) = %f\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,difftime((long int)time(NULL),connectedTime));
@@ -1121,12 +1320,14 @@ void ClientInterface::updateFrame(int *checkFrame) {
 			switch(networkMessageType)
 			{
 				case nmtCommandList:
+				case nmtCommandListCompact:
+				case nmtCommandListHeartbeat:
 					{
 
 					//make sure we read the message
 					//time_t receiveTimeElapsed = time(NULL);
 					NetworkMessageCommandList networkMessageCommandList;
-					bool gotCmd = receiveMessage(&networkMessageCommandList);
+					bool gotCmd = receiveCommandList(&networkMessageCommandList,networkMessageType);
 					if(gotCmd == false) {
 						SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] error retrieving nmtCommandList returned false!\n",__FILE__,__FUNCTION__,__LINE__);
 						if(isConnected() == false) {
@@ -1197,6 +1398,7 @@ void ClientInterface::updateFrame(int *checkFrame) {
 							}
 						}
 					}
+					signalNetworkCommandListReceived();
 					safeMutex.ReleaseLock();
 
 					done = true;
@@ -1211,6 +1413,7 @@ void ClientInterface::updateFrame(int *checkFrame) {
 					if(receiveMessage(&networkMessagePing)) {
 						if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 						this->setLastPingInfo(networkMessagePing);
+						handlePingMessage(networkMessagePing);
 					}
 				}
 				break;
@@ -1342,6 +1545,10 @@ void ClientInterface::updateFrame(int *checkFrame) {
 								if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] gameSettings.getThisFactionIndex(i) = %d, playerIndex = %d, i = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,gameSettings.getThisFactionIndex(),playerIndex,i);
 							}
 						}
+
+						if(networkMessageLaunch.getMessageType() == nmtLaunch) {
+							stopObserverRelayChainForPlayer();
+						}
 					}
 				}
 				break;
@@ -1409,6 +1616,7 @@ bool ClientInterface::getNetworkCommand(int frameCount, int currentCachedPending
 	uint64 waitCount 						= 0;
 	uint64 frameCountAsUInt64				= frameCount;
 	timeClientWaitedForLastMessage 			= 0;
+	uint64 waitStartTicks					= 0;
 
 	//printf("In getNetworkCommand: %d [%d]\n",frameCount,currentCachedPendingCommandsIndex);
 
@@ -1472,26 +1680,30 @@ bool ClientInterface::getNetworkCommand(int frameCount, int currentCachedPending
 				break;
 			}
 			else {
-				safeMutex.ReleaseLock(true);
 				// No data for this frame
 				if(waitForData == false) {
 					if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Client waiting for packet for frame: %d, copyCachedLastPendingFrameCount = %lld\n",frameCount,(long long int)copyCachedLastPendingFrameCount);
 					chrono.start();
+					waitStartTicks = SimBenchmark::getTicks();
 				}
 				if(copyCachedLastPendingFrameCount > frameCountAsUInt64) {
+					safeMutex.ReleaseLock(true);
 					break;
 				}
+				waitForData = true;
 
-				if(waitForData == false) {
-					waitForData = true;
-					sleep(0);
-				}
+				// releases the lock while blocked so the network thread can
+				// cache the command list and signal us
+				networkCommandListReceived->waitTillSignalled(networkCommandListThreadAccessor,commandListWaitSliceMillis);
+				safeMutex.ReleaseLock(true);
 
 				waitCount++;
 				//printf("Client waiting for packet for frame: %d, currentCachedPendingCommandsIndex = %d, cachedPendingCommandsIndex = %lld\n",frameCount,currentCachedPendingCommandsIndex,(long long int)cachedPendingCommandsIndex);
 			}
 		}
 	}
+	updateNetworkWaitStats(waitForData == true ? SimBenchmark::ticksToMicros(SimBenchmark::getTicks() - waitStartTicks) : 0);
+
 	if(waitForData == true) {
 		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Client waiting for packet FINISHED for frame: %d, copyCachedLastPendingFrameCount = %lld waitCount = %llu\n",frameCount,(long long int)copyCachedLastPendingFrameCount,(long long unsigned int)waitCount);
 	}
@@ -1499,6 +1711,50 @@ bool ClientInterface::getNetworkCommand(int frameCount, int currentCachedPending
 	return result;
 }
 
+void ClientInterface::updateNetworkWaitStats(int64 waitMicros) {
+	telemetry.addWait(waitMicros);
+	if(networkWaitStats.add(waitMicros, time(NULL)) == true) {
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] network wait per frame: avg %lld usecs, max %lld usecs over %d frames\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,(long long int)networkWaitStats.getAverageMicros(),(long long int)networkWaitStats.getMaxMicros(),networkWaitStats.getAverageFrames());
+	}
+}
+
+void ClientInterface::updateNetworkTelemetry(bool sendPing) {
+	if(NetworkTelemetry::isEnabled() == false) {
+		return;
+	}
+	if(sendPing == true &&
+		difftime((long int)time(NULL),lastNetworkTelemetryPingTime) >= GameConstants::networkPingInterval) {
+		lastNetworkTelemetryPingTime = time(NULL);
+		sendPingMessage(GameConstants::networkPingInterval, (int64)time(NULL));
+	}
+
+	string telemetryFile = "";
+	if(isNetworkTelemetryWriteDue(lastNetworkTelemetryWriteTime, telemetryFile) == true) {
+		NetworkTelemetry::writeFile(telemetryFile, getNetworkTelemetryJSON());
+	}
+}
+
+string ClientInterface::getNetworkTelemetryJSON() {
+	string result = "{\n";
+	result += "\t\"role\": \"client\",\n";
+	result += "\t\"slot\": " + intToStr(playerIndex) + ",\n";
+	result += "\t\"time\": " + intToStr((int64)time(NULL)) + ",\n";
+	result += "\t\"frame\": " + intToStr(currentFrameCount) + ",\n";
+	result += "\t\"peers\": [\n";
+	result += "\t\t{\n";
+	result += "\t\t\t\"name\": \"server\",\n";
+	result += "\t\t\t\"ip\": \"" + NetworkTelemetry::escapeJSON(getServerIpAddress()) + "\",\n";
+	result += "\t\t\t\"frame\": " + uIntToStr(getCachedLastPendingFrameCount()) + ",\n";
+	result += telemetry.getJSONFields("\t\t\t") + "\n";
+	result += "\t\t}\n";
+	result += "\t]\n}\n";
+	return result;
+}
+
+string ClientInterface::getNetworkWaitStats() const {
+	return networkWaitStats.toString();
+}
+
 void ClientInterface::updateKeyframe(int frameCount) {
 	currentFrameCount = frameCount;
 
@@ -1514,6 +1770,9 @@ void ClientInterface::updateKeyframe(int frameCount) {
 			sleep(0);
 		}
 
+		if(NetworkTelemetry::isEnabled() == true) {
+			telemetry.addFrameLag((int)((int64)getCachedLastPendingFrameCount() - frameCount));
+		}
 		getNetworkCommand(frameCount,cachedPendingCommandsIndex);
 	}
 }
@@ -1617,10 +1876,10 @@ void ClientInterface::waitUntilReady(Checksum* checksum) {
 
 				}
 			}
-			else if(networkMessageType == nmtCommandList) {
+			else if(NetworkMessageCommandList::isCommandListMessageType(networkMessageType) == true) {
 				//make sure we read the message
 				NetworkMessageCommandList networkMessageCommandList;
-				bool gotCmd = receiveMessage(&networkMessageCommandList);
+				bool gotCmd = receiveCommandList(&networkMessageCommandList,networkMessageType);
 				if(gotCmd == false) {
 					throw megaglest_runtime_error("error retrieving nmtCommandList returned false!");
 				}
@@ -1741,7 +2000,10 @@ void ClientInterface::waitUntilReady(Checksum* checksum) {
 						}
 						snprintf(szBuf1,8096,statusTextFormat.c_str(),waitForHosts.c_str());
 
-						logger.add(szBuf, true, szBuf1);
+						// without a world there is no loading screen to update
+						if(checksum != NULL) {
+							logger.add(szBuf, true, szBuf1);
+						}
 
 						sleep(0);
 					}
@@ -1766,15 +2028,21 @@ void ClientInterface::waitUntilReady(Checksum* checksum) {
 			}
 
 			Shared::Platform::Window::handleEvent();
-			// sleep a bit
-			sleep(waitSleepTime);
+			// wait for the server, returns as soon as a message arrives
+			Socket *socket = getSocket(false);
+			if(socket != NULL) {
+				socket->hasDataToReadWithWait(waitSleepTime * 1000);
+			}
+			else {
+				sleep(waitSleepTime);
+			}
 		}
 	}
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s] Line: %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	//check checksum
-	if(getJoinGameInProgress() == false &&
+	if(getJoinGameInProgress() == false && checksum != NULL &&
 		networkMessageReady.getChecksum() != checksum->getSum()) {
 
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s] Line: %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
@@ -1836,6 +2104,8 @@ void ClientInterface::waitUntilReady(Checksum* checksum) {
         return;
 	}
 
+	telemetry.setReadyWait(chrono.getMillis());
+
 	MutexSafeWrapper safeMutexFlags2(flagAccessor,CODE_AT_LINE);
 	this->joinGameInProgress 		= false;
 	this->joinGameInProgressLaunch 	= false;
@@ -1954,6 +2224,7 @@ NetworkMessageType ClientInterface::waitForMessage(int waitMicroseconds)
 
 	Chrono chrono;
 	chrono.start();
+	int64 nextConnectionCheck = 250;
 
 	NetworkMessageType msg = nmtInvalid;
 	while(	msg == nmtInvalid &&
@@ -1961,7 +2232,11 @@ NetworkMessageType ClientInterface::waitForMessage(int waitMicroseconds)
 
 		msg = getNextMessageType(waitMicroseconds);
 		if(msg == nmtInvalid) {
-			if(getSocket() == NULL || (chrono.getMillis() % 250 == 0 && isConnected() == false)) {
+			bool checkConnection = (chrono.getMillis() >= nextConnectionCheck);
+			if(checkConnection == true) {
+				nextConnectionCheck = chrono.getMillis() + 250;
+			}
+			if(getSocket() == NULL || (checkConnection == true && isConnected() == false)) {
 				if(getQuit() == false) {
 					//throw megaglest_runtime_error("Disconnected");
 					//sendTextMessage("Server has Disconnected.",-1);
@@ -1995,12 +2270,13 @@ NetworkMessageType ClientInterface::waitForMessage(int waitMicroseconds)
 				close();
 				return msg;
 			}
-			// Sleep every x milli-seconds we wait to let other threads work
-			else if(chrono.getMillis() % 2 == 0) {
-				sleep(1);
-			}
+			// block until data arrives instead of sleeping, the next
+			// getNextMessageType picks it up without a scheduler delay
 			else {
-				sleep(0);
+				Socket *socket = getSocket(false);
+				if(socket != NULL) {
+					socket->hasDataToReadWithWait(messageWaitSliceMicroseconds);
+				}
 			}
 		}
 
@@ -2066,6 +2342,14 @@ void ClientInterface::close(bool lockMutex) {
 	this->joinGameInProgress 		= false;
 	this->joinGameInProgressLaunch 	= false;
 	this->readyForInGameJoin 		= false;
+	std::vector<unsigned char>().swap(this->joinGameSnapshot);
+	this->joinGameSnapshotSize 				= 0;
+	this->joinGameSnapshotCompressedSize 	= 0;
+	this->joinGameSnapshotComplete 			= false;
+	safeMutexFlags.ReleaseLock();
+
+	// staging files stay on disk so the next request resumes them
+	contentSync.cancelAll();
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] END\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 }
@@ -2118,6 +2402,7 @@ bool ClientInterface::shouldDiscardNetworkMessage(NetworkMessageType networkMess
 			NetworkMessagePing msg = NetworkMessagePing();
 			this->receiveMessage(&msg);
 			this->setLastPingInfo(msg);
+			handlePingMessage(msg);
 			}
 			break;
 		case nmtLaunch:
@@ -2228,13 +2513,31 @@ bool ClientInterface::shouldDiscardNetworkMessage(NetworkMessageType networkMess
 			this->receiveMessage(&msg);
 			}
 			break;
+
+		case nmtContentManifest:
+			{
+			discard = true;
+			NetworkMessageContentManifest msg = NetworkMessageContentManifest();
+			this->receiveMessage(&msg);
+			}
+			break;
+		case nmtContentChunk:
+			{
+			discard = true;
+			NetworkMessageContentChunk msg = NetworkMessageContentChunk();
+			this->receiveMessage(&msg);
+			}
+			break;
 	}
 
 	return discard;
 }
 
 string ClientInterface::getHumanPlayerName(int index) {
-	string  result = Config::getInstance().getString("NetPlayerName",Socket::getHostName().c_str());
+	string  result = localPlayerName;
+	if(result == "") {
+		result = Config::getInstance().getString("NetPlayerName",Socket::getHostName().c_str());
+	}
 
 	if(index >= 0 || gameSettings.getThisFactionIndex() >= 0) {
 		if(index < 0) {
@@ -2248,6 +2551,11 @@ string ClientInterface::getHumanPlayerName(int index) {
 	return result;
 }
 
+void ClientInterface::setLocalPlayerIdentity(const string &name, const string &uuid) {
+	localPlayerName = name;
+	localPlayerUUID = uuid;
+}
+
 void ClientInterface::setGameSettings(GameSettings *serverGameSettings) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s] START\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__);
 
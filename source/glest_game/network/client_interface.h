@@ -20,6 +20,8 @@
 #include <vector>
 #include "network_interface.h"
 #include "socket.h"
+#include "content_sync.h"
+#include "observer_relay.h"
 #include "leak_dumper.h"
 
 using Shared::Platform::Ip;
@@ -57,6 +59,8 @@ private:
 	static const int messageWaitTimeout;
 	static const int waitSleepTime;
 	static const int maxNetworkCommandListSendTimeWait;
+	static const int commandListWaitSliceMillis;
+	static const int messageWaitSliceMicroseconds;
 
 private:
 	ClientSocket *clientSocket;
@@ -84,6 +88,10 @@ private:
 	string serverUUID;
 	string serverPlatform;
 
+	// sent in the intro instead of the configured player name and id
+	string localPlayerName;
+	string localPlayerUUID;
+
 	ClientInterfaceThread *networkCommandListThread;
 
 	Mutex *networkCommandListThreadAccessor;
@@ -92,6 +100,14 @@ private:
 	uint64 cachedPendingCommandsIndex;
 	uint64 cachedLastPendingFrameCount;
 	int64 timeClientWaitedForLastMessage;
+	// signalled by the network thread when a command list or quit arrives
+	Trigger *networkCommandListReceived;
+
+	// time the game thread blocked on the server, only used from the game thread
+	NetworkWaitStats networkWaitStats;
+
+	time_t lastNetworkTelemetryPingTime;
+	time_t lastNetworkTelemetryWriteTime;
 
 	Mutex *flagAccessor;
 	bool joinGameInProgress;
@@ -99,6 +115,18 @@ private:
 	bool readyForInGameJoin;
 	bool resumeInGameJoin;
 
+	// compressed saved game streamed by the server for an in progress join
+	std::vector<unsigned char> joinGameSnapshot;
+	uint32 joinGameSnapshotSize;
+	uint32 joinGameSnapshotCompressedSize;
+	bool joinGameSnapshotComplete;
+
+	// content downloaded over the game socket, only used from the menu thread
+	ContentSyncClient contentSync;
+
+	// passes what the server sends on to observers of this process
+	ObserverRelayChain *observerRelayChain;
+
 	Mutex *quitThreadAccessor;
 	bool quitThread;
 
@@ -107,6 +135,9 @@ private:
 	bool getQuit();
 	void setQuit(bool value);
 
+	void startObserverRelayChain();
+	void stopObserverRelayChainForPlayer();
+
 public:
 	ClientInterface();
 	virtual ~ClientInterface();
@@ -120,17 +151,36 @@ public:
 
 	bool getReadyForInGameJoin();
 
+	// -1 until the first snapshot chunk arrived
+	int getJoinGameSnapshotProgress();
+	bool getJoinGameSnapshotComplete();
+	// Extracts the received saved game XML and releases the buffer
+	string takeJoinGameSnapshot();
+
 	bool getResumeInGameJoin();
 	void sendResumeGameMessage();
 
+	// false when the server can't send content this way, the caller
+	// then falls back to ftp
+	bool requestContent(ContentSyncType type, const string &name, const string &destFolder, const string &stagingFolder);
+	bool isRequestingContent(ContentSyncType type, const string &name) const { return contentSync.isDownloading(type, name); }
+	int getContentProgress(ContentSyncType type) const { return contentSync.getProgress(type); }
+	bool takeFinishedContent(ContentSyncClient::Result &result) { return contentSync.takeFinished(result); }
+	void cancelContentRequests() { contentSync.cancelAll(); }
+
 	uint64 getCachedLastPendingFrameCount();
 	int64 getTimeClientWaitedForLastMessage();
+	// per frame wait for command lists, average and max over the last second
+	string getNetworkWaitStats() const;
+	// the server as our only peer, see NetworkTelemetry
+	string getNetworkTelemetryJSON();
 
 	//message processing
 	virtual void update();
 	virtual void updateLobby();
 	virtual void updateKeyframe(int frameCount);
 	virtual void setKeyframe(int frameCount) { currentFrameCount = frameCount; }
+	// checksum is NULL for clients without a world, such as load test clients
 	virtual void waitUntilReady(Checksum* checksum);
 
 	// message sending
@@ -154,6 +204,7 @@ public:
 	int getGameSettingsReceivedCount() const { return gameSettingsReceivedCount; }
 
 	int getPlayerIndex() const				{return playerIndex;}
+	void setLocalPlayerIdentity(const string &name, const string &uuid);
 
 	void connect(const Ip &ip, int port);
 	void reset();
@@ -197,6 +248,9 @@ protected:
 	void updateFrame(int *checkFrame);
 	void shutdownNetworkCommandListThread(MutexSafeWrapper &safeMutexWrapper);
 	bool getNetworkCommand(int frameCount, int currentCachedPendingCommandsIndex);
+	void updateNetworkWaitStats(int64 waitMicros);
+	void updateNetworkTelemetry(bool sendPing);
+	void signalNetworkCommandListReceived();
 
 	void close(bool lockMutex);
 };
@@ -349,10 +349,209 @@ void ConnectionSlotThread::execute() {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s] Line: %d\n",__FILE__,__FUNCTION__,__LINE__);
 }
 
+// =====================================================
+//	class ConnectionSlotReactorThread
+// =====================================================
+
+ConnectionSlotReactorThread::ConnectionSlotReactorThread(ConnectionSlotCallbackInterface *slotInterface) : BaseThread() {
+	this->slotInterface 	= slotInterface;
+	uniqueID 				= "ConnectionSlotReactorThread";
+
+	for(int index = 0; index < GameConstants::maxPlayers; ++index) {
+		registeredSockets[index] 	= NULL;
+		registeredSocketIds[index] 	= 0;
+		slotPending[index] 			= false;
+		slotStarted[index] 			= false;
+	}
+	registeredListenerId 	= 0;
+	listenerPending 		= false;
+}
+
+bool ConnectionSlotReactorThread::init() {
+	return reactor.init();
+}
+
+void ConnectionSlotReactorThread::signalQuit() {
+	BaseThread::signalQuit();
+	reactor.wakeup();
+}
+
+void ConnectionSlotReactorThread::updateRegistrations() {
+	Socket *slotSockets[GameConstants::maxPlayers];
+	PLATFORM_SOCKET slotSocketIds[GameConstants::maxPlayers];
+
+	for(int index = 0; index < GameConstants::maxPlayers; ++index) {
+		slotSockets[index] 		= NULL;
+		slotSocketIds[index] 	= 0;
+		bool started 			= false;
+
+		MutexSafeWrapper safeMutex(this->slotInterface->getSlotMutex(index),CODE_AT_LINE_X(index));
+		ConnectionSlot *slot = this->slotInterface->getSlot(index,false);
+		if(slot != NULL) {
+			slotSockets[index] = slot->getSocket(true);
+			if(slotSockets[index] != NULL) {
+				slotSocketIds[index] = slotSockets[index]->getSocketId();
+			}
+			started = slot->getGameStarted();
+		}
+		safeMutex.ReleaseLock();
+
+		// Data that arrived before the game started gives no new edge
+		if(started == true && slotStarted[index] == false) {
+			slotPending[index] = true;
+		}
+		slotStarted[index] = started;
+		if(started == false) {
+			slotPending[index] = false;
+		}
+	}
+
+	// Remove every stale socket before adding new ones, a closed socket id
+	// may already have been reused by another slot
+	for(int index = 0; index < GameConstants::maxPlayers; ++index) {
+		if(slotSockets[index] != registeredSockets[index] ||
+			slotSocketIds[index] != registeredSocketIds[index]) {
+			reactor.removeSocket(registeredSocketIds[index]);
+			registeredSockets[index] 	= NULL;
+			registeredSocketIds[index] 	= 0;
+		}
+	}
+	for(int index = 0; index < GameConstants::maxPlayers; ++index) {
+		if(slotSockets[index] != NULL && registeredSockets[index] == NULL &&
+			reactor.addSocket(slotSocketIds[index],index) == true) {
+			registeredSockets[index] 	= slotSockets[index];
+			registeredSocketIds[index] 	= slotSocketIds[index];
+			slotPending[index] 			= slotStarted[index];
+		}
+	}
+
+	ServerSocket *serverSocket = this->slotInterface->getServerSocket();
+	PLATFORM_SOCKET listenerId = (serverSocket != NULL ? serverSocket->getSocketId() : 0);
+	if(listenerId != registeredListenerId) {
+		reactor.removeSocket(registeredListenerId);
+		registeredListenerId = 0;
+		if(reactor.addSocket(listenerId,GameConstants::maxPlayers) == true) {
+			registeredListenerId 	= listenerId;
+			listenerPending 		= true;
+		}
+	}
+}
+
+bool ConnectionSlotReactorThread::hasPendingSlots() const {
+	for(int index = 0; index < GameConstants::maxPlayers; ++index) {
+		if(slotPending[index] == true) {
+			return true;
+		}
+	}
+	return listenerPending;
+}
+
+void ConnectionSlotReactorThread::dispatchSlot(int slotIndex) {
+	slotPending[slotIndex] = false;
+
+	ConnectionSlotEvent eventCopy;
+	eventCopy.eventType 		= eReceiveSocketData;
+	eventCopy.connectionSlot 	= this->slotInterface->getSlot(slotIndex,true);
+	eventCopy.eventId 			= slotIndex;
+	eventCopy.socketTriggered 	= true;
+	if(eventCopy.connectionSlot == NULL || eventCopy.connectionSlot->getGameStarted() == false) {
+		return;
+	}
+
+	eventCopy.connectionSlot->updateSlot(&eventCopy);
+
+	// The update stops early for lagging clients, whatever is left
+	// over will not raise another edge so look at it again
+	MutexSafeWrapper safeMutex(this->slotInterface->getSlotMutex(slotIndex),CODE_AT_LINE_X(slotIndex));
+	ConnectionSlot *slot = this->slotInterface->getSlot(slotIndex,false);
+	Socket *socket = (slot != NULL ? slot->getSocket(true) : NULL);
+	slotPending[slotIndex] = (socket != NULL && socket->hasDataToRead() == true);
+}
+
+void ConnectionSlotReactorThread::dispatchListener() {
+	listenerPending = false;
+	if(this->slotInterface->getGameHasBeenInitiated() == false ||
+		this->slotInterface->getAllowInGameConnections() == false) {
+		return;
+	}
+
+	ServerSocket *serverSocket = this->slotInterface->getServerSocket();
+	for(int index = 0; index < GameConstants::maxPlayers &&
+		serverSocket->hasDataToRead() == true; ++index) {
+		if(this->slotInterface->isClientConnected(index) == true) {
+			continue;
+		}
+
+		ConnectionSlotEvent eventCopy;
+		eventCopy.eventType 		= eReceiveSocketData;
+		eventCopy.connectionSlot 	= this->slotInterface->getSlot(index,true);
+		eventCopy.eventId 			= index;
+		if(eventCopy.connectionSlot != NULL &&
+			eventCopy.connectionSlot->getCanAcceptConnections() == true) {
+			eventCopy.connectionSlot->updateSlot(&eventCopy);
+		}
+	}
+}
+
+void ConnectionSlotReactorThread::execute() {
+    RunningStatusSafeWrapper runningStatus(this);
+	try {
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
+
+		std::vector<SocketReactorEvent> events;
+		for(;this->slotInterface != NULL;) {
+			if(getQuitStatus() == true) {
+				break;
+			}
+
+			updateRegistrations();
+			reactor.wait(events,(hasPendingSlots() == true ? 0 : 150));
+
+			if(getQuitStatus() == true) {
+				break;
+			}
+
+			for(unsigned int index = 0; index < events.size(); ++index) {
+				int slotIndex = events[index].userData;
+				if(slotIndex == GameConstants::maxPlayers) {
+					listenerPending = true;
+				}
+				else if(slotIndex >= 0 && slotIndex < GameConstants::maxPlayers) {
+					slotPending[slotIndex] = slotStarted[slotIndex];
+				}
+			}
+
+			ExecutingTaskSafeWrapper safeExecutingTaskMutex(this);
+			for(int slotIndex = 0; slotIndex < GameConstants::maxPlayers; ++slotIndex) {
+				if(getQuitStatus() == true) {
+					break;
+				}
+				if(slotPending[slotIndex] == true) {
+					dispatchSlot(slotIndex);
+				}
+			}
+			if(listenerPending == true && getQuitStatus() == false) {
+				dispatchListener();
+			}
+		}
+
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
+	}
+	catch(const exception &ex) {
+
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",__FILE__,__FUNCTION__,__LINE__,ex.what());
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
+
+		throw megaglest_runtime_error(ex.what());
+	}
+}
+
 // =====================================================
 //	class ConnectionSlot
 // =====================================================
 
+const int ConnectionSlot::contentChunksPerUpdate = 8;
+
 ConnectionSlot::ConnectionSlot(ServerInterface* serverInterface, int playerIndex) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s] Line: %d\n",__FILE__,__FUNCTION__,__LINE__);
 
@@ -383,6 +582,8 @@ ConnectionSlot::ConnectionSlot(ServerInterface* serverInterface, int playerIndex
 	this->pauseForInGameConnection 			= false;
 	this->unPauseForInGameConnection 		= false;
 	this->sentSavedGameInfo 				= false;
+	this->pendingGameSnapshotSize 			= 0;
+	this->pendingGameSnapshotOffset 		= 0;
 
 	this->ready								= false;
 	this->gotIntro 							= false;
@@ -398,10 +599,15 @@ ConnectionSlot::ConnectionSlot(ServerInterface* serverInterface, int playerIndex
 
 	this->setSocket(NULL);
 	this->slotThreadWorker 					= NULL;
-	static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
-	this->slotThreadWorker 					= new ConnectionSlotThread(this->serverInterface,playerIndex);
-	this->slotThreadWorker->setUniqueID(mutexOwnerId);
-	this->slotThreadWorker->start();
+	this->gameStarted 						= false;
+
+	// The socket reactor of the server updates slots without a thread each
+	if(this->serverInterface->getUseSocketReactor() == false) {
+		static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+		this->slotThreadWorker 				= new ConnectionSlotThread(this->serverInterface,playerIndex);
+		this->slotThreadWorker->setUniqueID(mutexOwnerId);
+		this->slotThreadWorker->start();
+	}
 }
 
 ConnectionSlot::~ConnectionSlot() {
@@ -472,13 +678,14 @@ void ConnectionSlot::incrementAutoPauseGameCountForLag() {
 }
 
 bool ConnectionSlot::getGameStarted() {
-	bool result = false;
+	bool result = this->gameStarted;
 	if(this->slotThreadWorker != NULL) {
 		result = this->slotThreadWorker->getGameStarted();
 	}
 	return result;
 }
 void ConnectionSlot::setGameStarted(bool value) {
+	this->gameStarted = value;
 	if(this->slotThreadWorker != NULL) {
 		this->slotThreadWorker->setGameStarted(value);
 	}
@@ -573,6 +780,7 @@ void ConnectionSlot::update(bool checkForNewClients,int lockedSlotIndex) {
 
 						this->connectedTime = time(NULL);
 						this->clearChatInfo();
+						this->contentUpload.clear();
 						this->name = "";
 						this->playerStatus = npst_PickSettings;
 						this->playerLanguage = "";
@@ -679,6 +887,7 @@ void ConnectionSlot::update(bool checkForNewClients,int lockedSlotIndex) {
 							if(receiveMessage(&networkMessagePing)) {
 								if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 								lastPingInfo = networkMessagePing;
+								handlePingMessage(networkMessagePing);
 							}
 							else {
 								if(SystemFlags::getSystemSettingType(SystemFlags::debugError).enabled) SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d]\nInvalid message type before intro handshake [%d]\nDisconnecting socket for slot: %d [%s].\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,networkMessageType,this->playerIndex,this->getIpAddress().c_str());
@@ -806,13 +1015,15 @@ void ConnectionSlot::update(bool checkForNewClients,int lockedSlotIndex) {
 						break;
 
 						//command list
-						case nmtCommandList: {
+						case nmtCommandList:
+						case nmtCommandListCompact:
+						case nmtCommandListHeartbeat: {
 
 							if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] got nmtCommandList gotIntro = %d\n",__FILE__,__FUNCTION__,__LINE__,gotIntro);
 
 							if(gotIntro == true) {
 								NetworkMessageCommandList networkMessageCommandList;
-								if(receiveMessage(&networkMessageCommandList)) {
+								if(receiveCommandList(&networkMessageCommandList,networkMessageType)) {
 									currentFrameCount = networkMessageCommandList.getFrameCount();
 									lastReceiveCommandListTime = time(NULL);
 
@@ -856,6 +1067,7 @@ void ConnectionSlot::update(bool checkForNewClients,int lockedSlotIndex) {
 								this->playerLanguage = networkMessageIntro.getPlayerLanguage();
 								this->playerUUID	  = networkMessageIntro.getPlayerUUID();
 								this->platform		  = networkMessageIntro.getPlayerPlatform();
+								setPeerCapabilities(networkMessageIntro.getCapabilities());
 
 								//printf("Got uuid from client [%s]\n",this->playerUUID.c_str());
 								if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s] got name [%s] versionString [%s], msgSessionId = %d\n",__FILE__,__FUNCTION__,name.c_str(),versionString.c_str(),msgSessionId);
@@ -1270,6 +1482,51 @@ void ConnectionSlot::update(bool checkForNewClients,int lockedSlotIndex) {
 						}
 						break;
 
+						case nmtContentManifest:
+						{
+							if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] got nmtContentManifest\n",__FILE__,__FUNCTION__,__LINE__);
+
+							if(gotIntro == true) {
+								NetworkMessageContentManifest networkMessageContentManifest;
+								if(receiveMessage(&networkMessageContentManifest)) {
+									// same policy as the ftp server
+									vector<ContentChunkFile> files;
+									bool available = (networkMessageContentManifest.getStatus() == NetworkMessageContentManifest::cmsRequest &&
+											Config::getInstance().getBool("EnableFTPServer","true") == true &&
+											contentUpload.openContent(networkMessageContentManifest.getContentType(),
+													networkMessageContentManifest.getContentName(), files) == true);
+
+									NetworkMessageContentManifest networkMessageContentReply(networkMessageContentManifest.getContentType(),
+											networkMessageContentManifest.getContentName(), available, files);
+									sendMessage(&networkMessageContentReply);
+								}
+							}
+							else {
+								if(SystemFlags::getSystemSettingType(SystemFlags::debugError).enabled) SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d]\nInvalid message type before intro handshake [%d]\nDisconnecting socket for slot: %d [%s].\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,networkMessageType,this->playerIndex,this->getIpAddress().c_str());
+								this->serverInterface->notifyBadClientConnectAttempt(this->getIpAddress());
+								close();
+								return;
+							}
+						}
+						break;
+
+						case nmtContentChunkRequest:
+						{
+							if(gotIntro == true) {
+								NetworkMessageContentChunkRequest networkMessageContentChunkRequest;
+								if(receiveMessage(&networkMessageContentChunkRequest)) {
+									contentUpload.addRequest(networkMessageContentChunkRequest);
+								}
+							}
+							else {
+								if(SystemFlags::getSystemSettingType(SystemFlags::debugError).enabled) SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d]\nInvalid message type before intro handshake [%d]\nDisconnecting socket for slot: %d [%s].\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,networkMessageType,this->playerIndex,this->getIpAddress().c_str());
+								this->serverInterface->notifyBadClientConnectAttempt(this->getIpAddress());
+								close();
+								return;
+							}
+						}
+						break;
+
 						case nmtSwitchSetupRequest:
 						{
 							//printf("Got nmtSwitchSetupRequest A gotIntro = %d\n",gotIntro);
@@ -1418,6 +1675,10 @@ void ConnectionSlot::update(bool checkForNewClients,int lockedSlotIndex) {
 
 				//if(chrono.getMillis() > 1) printf("In [%s::%s Line: %d] action running for msecs: %lld\n",__FILE__,__FUNCTION__,__LINE__,(long long int)chrono.getMillis());
 
+				if(contentUpload.hasPendingChunks() == true && this->isConnected() == true) {
+					sendPendingContentChunks(contentChunksPerUpdate);
+				}
+
 				validateConnection();
 
 				//printf("#7 Server slot got currentFrameCount = %d\n",currentFrameCount);
@@ -1530,6 +1791,10 @@ void ConnectionSlot::signalUpdate(ConnectionSlotEvent *event) {
     if(slotThreadWorker != NULL) {
         slotThreadWorker->signalUpdate(event);
     }
+    else if(event != NULL) {
+    	updateSlot(event);
+    	event->eventCompleted = true;
+    }
 }
 
 bool ConnectionSlot::updateCompleted(ConnectionSlotEvent *event) {
@@ -1557,6 +1822,82 @@ void ConnectionSlot::sendMessage(NetworkMessage* networkMessage) {
 	NetworkInterface::sendMessage(networkMessage);
 }
 
+ObserverRelayResult ConnectionSlot::relayMessages(vector<NetworkMessageCommandList> &messages, bool finishing) {
+	// the socket is only deleted with this held
+	MutexSafeWrapper safeMutexSocket(mutexSocket,CODE_AT_LINE);
+	if(socket == NULL || socket->isConnected() == false ||
+		socket->flushSendQueue() == false) {
+		return orrGone;
+	}
+	if(messages.empty() == true) {
+		return orrSent;
+	}
+	if(finishing == false && socket->getSendQueueSize() > 0) {
+		return orrBusy;
+	}
+
+	socket->beginSendBatch();
+	for(unsigned int index = 0; index < messages.size(); ++index) {
+		sendMessage(&messages[index]);
+	}
+	if(socket->endSendBatch() == false) {
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] relayed batch of %d command lists failed for slot %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,(int)messages.size(),playerIndex);
+		return orrGone;
+	}
+	return orrSent;
+}
+
+void ConnectionSlot::setPendingGameSnapshot(const std::vector<unsigned char> &compressedSnapshot, uint32 snapshotSize) {
+	pendingGameSnapshot = compressedSnapshot;
+	pendingGameSnapshotSize = snapshotSize;
+	pendingGameSnapshotOffset = 0;
+}
+
+void ConnectionSlot::clearPendingGameSnapshot() {
+	std::vector<unsigned char>().swap(pendingGameSnapshot);
+	pendingGameSnapshotSize = 0;
+	pendingGameSnapshotOffset = 0;
+}
+
+int ConnectionSlot::getPendingGameSnapshotProgress() const {
+	if(pendingGameSnapshot.empty() == true) {
+		return 100;
+	}
+	return (int)((uint64)pendingGameSnapshotOffset * 100 / pendingGameSnapshot.size());
+}
+
+bool ConnectionSlot::sendPendingGameSnapshotChunks(int maxChunks) {
+	const uint32 compressedSize = (uint32)pendingGameSnapshot.size();
+	for(int index = 0; index < maxChunks && pendingGameSnapshotOffset < compressedSize; ++index) {
+		uint32 chunkSize = compressedSize - pendingGameSnapshotOffset;
+		if(chunkSize > NetworkMessageGameSnapshotChunk::maxChunkSize) {
+			chunkSize = NetworkMessageGameSnapshotChunk::maxChunkSize;
+		}
+		NetworkMessageGameSnapshotChunk networkMessageChunk(pendingGameSnapshotSize, compressedSize,
+				pendingGameSnapshotOffset, &pendingGameSnapshot[pendingGameSnapshotOffset], chunkSize);
+		sendMessage(&networkMessageChunk);
+		pendingGameSnapshotOffset += chunkSize;
+	}
+
+	if(pendingGameSnapshotOffset < compressedSize) {
+		return false;
+	}
+	clearPendingGameSnapshot();
+	return true;
+}
+
+void ConnectionSlot::sendPendingContentChunks(int maxChunks) {
+	ContentSyncType type = cstMap;
+	uint32 fileIndex = 0;
+	uint32 chunkIndex = 0;
+	vector<unsigned char> data;
+	for(int index = 0; index < maxChunks &&
+		contentUpload.getNextChunk(type, fileIndex, chunkIndex, data) == true; ++index) {
+		NetworkMessageContentChunk networkMessageChunk(type, fileIndex, chunkIndex, data);
+		sendMessage(&networkMessageChunk);
+	}
+}
+
 string ConnectionSlot::getHumanPlayerName(int index) {
 	return serverInterface->getHumanPlayerName(index);
 }
@@ -15,6 +15,9 @@
 #include "socket.h"
 #include "network_interface.h"
 #include "base_thread.h"
+#include "socket_reactor.h"
+#include "content_sync.h"
+#include "observer_relay.h"
 #include <time.h>
 #include <vector>
 
@@ -22,6 +25,8 @@
 
 using Shared::Platform::ServerSocket;
 using Shared::Platform::Socket;
+using Shared::Platform::SocketReactor;
+using Shared::Platform::SocketReactorEvent;
 using std::vector;
 
 namespace Glest{ namespace Game{
@@ -71,6 +76,8 @@ public:
 	virtual bool getAllowInGameConnections() const = 0;
 	virtual ConnectionSlot *getSlot(int index, bool lockMutex) = 0;
 	virtual Mutex *getSlotMutex(int index) = 0;
+	virtual ServerSocket *getServerSocket() = 0;
+	virtual bool getGameHasBeenInitiated() const = 0;
 
 	virtual void slotUpdateTask(ConnectionSlotEvent *event) = 0;
 	virtual ~ConnectionSlotCallbackInterface() {}
@@ -120,6 +127,45 @@ public:
     virtual bool canShutdown(bool deleteSelfIfShutdownDelayed=false);
 };
 
+// =====================================================
+//	class ConnectionSlotReactorThread
+//
+///	Takes over from the per slot threads when the
+/// socket reactor is enabled: a single edge triggered
+/// epoll set waits for all slot sockets and the
+/// listener, and ready slots are updated in turn.
+// =====================================================
+
+class ConnectionSlotReactorThread : public BaseThread
+{
+protected:
+
+	ConnectionSlotCallbackInterface *slotInterface;
+	SocketReactor reactor;
+
+	// what is currently registered in the reactor for every slot
+	Socket *registeredSockets[GameConstants::maxPlayers];
+	PLATFORM_SOCKET registeredSocketIds[GameConstants::maxPlayers];
+	PLATFORM_SOCKET registeredListenerId;
+
+	// slots that may still have unread data since the last edge
+	bool slotPending[GameConstants::maxPlayers];
+	bool slotStarted[GameConstants::maxPlayers];
+	bool listenerPending;
+
+	void updateRegistrations();
+	bool hasPendingSlots() const;
+	void dispatchSlot(int slotIndex);
+	void dispatchListener();
+
+public:
+	explicit ConnectionSlotReactorThread(ConnectionSlotCallbackInterface *slotInterface);
+
+	bool init();
+	virtual void signalQuit();
+	virtual void execute();
+};
+
 // =====================================================
 //	class ConnectionSlot
 // =====================================================
@@ -143,6 +189,7 @@ private:
 	Mutex *mutexPendingNetworkCommandList;
 	vector<NetworkCommand> vctPendingNetworkCommandList;
 	ConnectionSlotThread* slotThreadWorker;
+	bool gameStarted;
 	int currentFrameCount;
 	int currentLagCount;
 	time_t lastReceiveCommandListTime;
@@ -163,6 +210,17 @@ private:
 	bool unPauseForInGameConnection;
 	bool sentSavedGameInfo;
 
+	// compressed saved game still being streamed to a joining client,
+	// only used from the game thread
+	std::vector<unsigned char> pendingGameSnapshot;
+	uint32 pendingGameSnapshotSize;
+	uint32 pendingGameSnapshotOffset;
+
+	// maps, tilesets and techtrees the client downloads over the
+	// game socket, only used from the slot update
+	ContentSyncUpload contentUpload;
+	static const int contentChunksPerUpdate;
+
 	int autoPauseGameCountForLag;
 
 public:
@@ -190,6 +248,16 @@ public:
 	bool getSentSavedGameInfo() const { return sentSavedGameInfo; }
 	void setSentSavedGameInfo(bool value) { sentSavedGameInfo = value; }
 
+	bool getCanReceiveGameSnapshot() const { return (getPeerCapabilities() & ncapGameSnapshotStream) != 0; }
+	void setPendingGameSnapshot(const std::vector<unsigned char> &compressedSnapshot, uint32 snapshotSize);
+	void clearPendingGameSnapshot();
+	bool hasPendingGameSnapshot() const { return pendingGameSnapshot.empty() == false; }
+	int getPendingGameSnapshotProgress() const;
+	// Sends up to maxChunks parts of the pending snapshot, returns true
+	// once the last part went out
+	bool sendPendingGameSnapshotChunks(int maxChunks);
+	void sendPendingContentChunks(int maxChunks);
+
 	ConnectionSlotThread *getWorkerThread() { return slotThreadWorker; }
 
     void update(bool checkForNewClients,int lockedSlotIndex);
@@ -228,6 +296,9 @@ public:
 	bool updateCompleted(ConnectionSlotEvent *event);
 
 	virtual void sendMessage(NetworkMessage* networkMessage);
+	// Writes relayed command lists without waiting for the peer, holding
+	// only the socket so no slot lock is needed
+	ObserverRelayResult relayMessages(vector<NetworkMessageCommandList> &messages, bool finishing);
 	int getCurrentFrameCount() const { return currentFrameCount; }
 
 	int getCurrentLagCount() const { return currentLagCount; }
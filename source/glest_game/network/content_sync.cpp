@@ -0,0 +1,519 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "content_sync.h"
+
+#include <algorithm>
+#include <set>
+#include "config.h"
+#include "game_constants.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+using namespace Shared::Util;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+//	class ContentSyncSource
+// =====================================================
+
+const int ContentSyncSource::manifestCacheSeconds = 60;
+Mutex ContentSyncSource::manifestCacheAccessor(CODE_AT_LINE);
+map<string,ContentSyncSource::CachedManifest> ContentSyncSource::manifestCache;
+
+string ContentSyncSource::getContentTypeName(ContentSyncType type) {
+	switch(type) {
+		case cstMap:
+			return "maps";
+		case cstTileset:
+			return "tilesets";
+		case cstTechtree:
+			return "techs";
+		default:
+			return "";
+	}
+}
+
+bool ContentSyncSource::isValidContentName(const string &name) {
+	return (name.empty() == false &&
+			name.find('/') == string::npos &&
+			name.find('\\') == string::npos &&
+			name.find(':') == string::npos &&
+			name.find("..") == string::npos);
+}
+
+string ContentSyncSource::getContentPath(ContentSyncType type, const string &name) {
+	if(isValidContentName(name) == false) {
+		return "";
+	}
+	if(type == cstMap) {
+		return Config::getMapPath(name,"",false);
+	}
+
+	vector<string> pathList = Config::getInstance().getPathListForType(type == cstTileset ? ptTilesets : ptTechs);
+	for(unsigned int index = 0; index < pathList.size(); ++index) {
+		string path = pathList[index];
+		endPathWithSlash(path);
+		if(folderExists(path + name) == true) {
+			return path + name;
+		}
+	}
+	return "";
+}
+
+bool ContentSyncSource::getManifest(ContentSyncType type, const string &name,
+		string &contentPath, vector<ContentChunkFile> &files) {
+	files.clear();
+	contentPath = getContentPath(type, name);
+	if(contentPath == "") {
+		return false;
+	}
+
+	string cacheKey = getContentTypeName(type) + "/" + name;
+	{
+		MutexSafeWrapper safeMutex(&manifestCacheAccessor,CODE_AT_LINE);
+		map<string,CachedManifest>::iterator iterFind = manifestCache.find(cacheKey);
+		if(iterFind != manifestCache.end() && iterFind->second.path == contentPath &&
+			difftime(time(NULL),iterFind->second.created) < manifestCacheSeconds) {
+			files = iterFind->second.files;
+			return true;
+		}
+	}
+
+	// several slots may build the same manifest at once, the result is the same
+	bool result = (type == cstMap ?
+			ContentChunks::buildFileManifest(contentPath, files) :
+			ContentChunks::buildFolderManifest(contentPath, files));
+	if(result == false) {
+		return false;
+	}
+
+	MutexSafeWrapper safeMutex(&manifestCacheAccessor,CODE_AT_LINE);
+	CachedManifest &cached = manifestCache[cacheKey];
+	cached.path = contentPath;
+	cached.created = time(NULL);
+	cached.files = files;
+	return true;
+}
+
+// =====================================================
+//	class ContentSyncUpload
+// =====================================================
+
+const unsigned int ContentSyncUpload::maxPendingChunks = 4096;
+
+bool ContentSyncUpload::openContent(ContentSyncType type, const string &name, vector<ContentChunkFile> &files) {
+	// chunks still queued for the previous content of this type are stale now
+	for(deque<PendingChunk>::iterator iterChunk = pendingChunks.begin(); iterChunk != pendingChunks.end();) {
+		if(iterChunk->type == type) {
+			iterChunk = pendingChunks.erase(iterChunk);
+		}
+		else {
+			++iterChunk;
+		}
+	}
+
+	ServedContent &content = served[type];
+	content = ServedContent();
+
+	string contentPath = "";
+	if(ContentSyncSource::getManifest(type, name, contentPath, files) == false) {
+		return false;
+	}
+	content.name = name;
+	content.path = contentPath;
+	content.folder = (type != cstMap);
+	content.files = files;
+	return true;
+}
+
+void ContentSyncUpload::addRequest(const NetworkMessageContentChunkRequest &request) {
+	ContentSyncType type = request.getContentType();
+	const ServedContent &content = served[type];
+	if(content.name == "" || content.name != request.getContentName()) {
+		return;
+	}
+
+	const vector<pair<uint32,uint32> > &chunks = request.getChunks();
+	for(unsigned int index = 0; index < chunks.size() && pendingChunks.size() < maxPendingChunks; ++index) {
+		uint32 fileIndex = chunks[index].first;
+		uint32 chunkIndex = chunks[index].second;
+		if(fileIndex < content.files.size() && chunkIndex < content.files[fileIndex].chunkCRCs.size()) {
+			PendingChunk chunk;
+			chunk.type = type;
+			chunk.fileIndex = fileIndex;
+			chunk.chunkIndex = chunkIndex;
+			pendingChunks.push_back(chunk);
+		}
+	}
+}
+
+void ContentSyncUpload::clear() {
+	for(int type = 0; type < cstCount; ++type) {
+		served[type] = ServedContent();
+	}
+	pendingChunks.clear();
+}
+
+bool ContentSyncUpload::getNextChunk(ContentSyncType &type, uint32 &fileIndex, uint32 &chunkIndex, vector<unsigned char> &data) {
+	for(;pendingChunks.empty() == false;) {
+		PendingChunk chunk = pendingChunks.front();
+		pendingChunks.pop_front();
+
+		const ServedContent &content = served[chunk.type];
+		if(chunk.fileIndex >= content.files.size()) {
+			continue;
+		}
+		string file = (content.folder == true ?
+				content.path + "/" + content.files[chunk.fileIndex].path : content.path);
+		// a chunk that can't be read is left to the client's retry
+		if(ContentChunks::readChunk(file, chunk.chunkIndex, data) == true) {
+			type = chunk.type;
+			fileIndex = chunk.fileIndex;
+			chunkIndex = chunk.chunkIndex;
+			return true;
+		}
+	}
+	return false;
+}
+
+// =====================================================
+//	class ContentSyncClient
+// =====================================================
+
+const int ContentSyncClient::maxOutstandingChunks	= 32;
+const int ContentSyncClient::maxInterleavedFiles	= 4;
+const int ContentSyncClient::maxChunkRetries		= 3;
+const int ContentSyncClient::chunkTimeoutSeconds	= 10;
+
+uint32 ContentSyncClient::getExpectedChunkSize(const ContentChunkFile &file, uint32 chunkIndex) {
+	uint32 chunkStart = chunkIndex * ContentChunks::chunkSize;
+	return std::min(ContentChunks::chunkSize, file.size - chunkStart);
+}
+
+bool ContentSyncClient::copyContentFile(const string &fromFile, const string &toFile, uint32 size) {
+	vector<unsigned char> data;
+	uint32 chunkCount = ContentChunks::getChunkCount(size);
+	for(uint32 chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+		if(ContentChunks::readChunk(fromFile, chunkIndex, data) == false ||
+			ContentChunks::writeChunk(toFile, chunkIndex, &data[0], (uint32)data.size()) == false) {
+			return false;
+		}
+	}
+	return ContentChunks::setFileSize(toFile, size);
+}
+
+bool ContentSyncClient::start(ContentSyncType type, const string &name, const string &destFolder, const string &stagingFolder) {
+	if(ContentSyncSource::isValidContentName(name) == false || isDownloading(type) == true) {
+		return false;
+	}
+
+	Download &download = downloads[type];
+	download.type = type;
+	download.name = name;
+	download.destPath = destFolder;
+	endPathWithSlash(download.destPath);
+	if(type != cstMap) {
+		download.destPath += name + "/";
+	}
+	download.stagingPath = stagingFolder;
+	endPathWithSlash(download.stagingPath);
+	download.stagingPath += ContentSyncSource::getContentTypeName(type) + "/" + name + "/";
+	return true;
+}
+
+bool ContentSyncClient::isDownloading(ContentSyncType type, const string &name) const {
+	map<int,Download>::const_iterator iterFind = downloads.find(type);
+	return (iterFind != downloads.end() && iterFind->second.name == name);
+}
+
+void ContentSyncClient::cancelAll() {
+	downloads.clear();
+	finished.clear();
+}
+
+void ContentSyncClient::handleManifest(const NetworkMessageContentManifest &manifest) {
+	ContentSyncType type = manifest.getContentType();
+	map<int,Download>::iterator iterFind = downloads.find(type);
+	if(iterFind == downloads.end() || iterFind->second.name != manifest.getContentName() ||
+		iterFind->second.haveManifest == true) {
+		return;
+	}
+	Download &download = iterFind->second;
+	if(manifest.getStatus() != NetworkMessageContentManifest::cmsAvailable) {
+		finishDownload(type, false);
+		return;
+	}
+
+	// the server picks the paths, so they must stay below the content folder
+	const vector<ContentChunkFile> &files = manifest.getFiles();
+	bool validFiles = (type != cstMap || files.size() == 1);
+	for(unsigned int index = 0; index < files.size() && validFiles == true; ++index) {
+		validFiles = (type == cstMap ?
+				ContentSyncSource::isValidContentName(files[index].path) :
+				ContentChunks::isSafeRelativePath(files[index].path));
+	}
+	if(validFiles == false) {
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] rejecting manifest for [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,download.name.c_str());
+		finishDownload(type, false);
+		return;
+	}
+
+	download.files = files;
+	download.haveManifest = true;
+	download.totalBytes = 0;
+	for(unsigned int index = 0; index < files.size(); ++index) {
+		download.totalBytes += files[index].size;
+	}
+	queueStaleChunks(download);
+}
+
+// Queues the chunks neither the staging copy nor the installed copy
+// has, so a resumed or updated download only fetches what changed
+void ContentSyncClient::queueStaleChunks(Download &download) {
+	download.queuedChunks.clear();
+	download.receivedBytes = download.totalBytes;
+
+	string seedPath = ContentSyncSource::getContentPath(download.type, download.name);
+	vector<vector<uint32> > staleChunks(download.files.size());
+	for(unsigned int fileIndex = 0; fileIndex < download.files.size(); ++fileIndex) {
+		const ContentChunkFile &file = download.files[fileIndex];
+		string stagingFile = download.stagingPath + file.path;
+		vector<uint32> stale = ContentChunks::getStaleChunks(stagingFile, file);
+
+		string seedFile = "";
+		if(seedPath != "") {
+			seedFile = (download.type == cstMap ?
+					extractDirectoryPathFromFile(seedPath) + file.path : seedPath + "/" + file.path);
+		}
+		if(stale.empty() == false && seedFile != "" && fileExists(seedFile) == true) {
+			vector<uint32> seedStale = ContentChunks::getStaleChunks(seedFile, file);
+			std::set<uint32> seedStaleSet(seedStale.begin(), seedStale.end());
+
+			vector<uint32> stillStale;
+			vector<unsigned char> data;
+			for(unsigned int index = 0; index < stale.size(); ++index) {
+				uint32 chunkIndex = stale[index];
+				if(seedStaleSet.find(chunkIndex) != seedStaleSet.end() ||
+					ContentChunks::readChunk(seedFile, chunkIndex, data) == false ||
+					ContentChunks::writeChunk(stagingFile, chunkIndex, &data[0], (uint32)data.size()) == false) {
+					stillStale.push_back(chunkIndex);
+				}
+			}
+			stale.swap(stillStale);
+		}
+
+		for(unsigned int index = 0; index < stale.size(); ++index) {
+			download.receivedBytes -= getExpectedChunkSize(file, stale[index]);
+		}
+		staleChunks[fileIndex].swap(stale);
+	}
+
+	// a few files at a time share the window, so small files don't
+	// wait behind a large one and a large one still streams
+	for(unsigned int groupStart = 0; groupStart < staleChunks.size(); groupStart += maxInterleavedFiles) {
+		unsigned int groupEnd = std::min((unsigned int)staleChunks.size(), groupStart + maxInterleavedFiles);
+		for(unsigned int position = 0;; ++position) {
+			bool queuedAny = false;
+			for(unsigned int fileIndex = groupStart; fileIndex < groupEnd; ++fileIndex) {
+				if(position < staleChunks[fileIndex].size()) {
+					download.queuedChunks.push_back(ChunkRef(fileIndex, staleChunks[fileIndex][position]));
+					queuedAny = true;
+				}
+			}
+			if(queuedAny == false) {
+				break;
+			}
+		}
+	}
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] [%s] needs %d chunks, " MG_SIZE_T_SPECIFIER " files\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,download.name.c_str(),(int)download.queuedChunks.size(),download.files.size());
+}
+
+bool ContentSyncClient::retryChunk(Download &download, const ChunkRef &chunk) {
+	int &retries = download.chunkRetries[chunk];
+	if(++retries > maxChunkRetries) {
+		return false;
+	}
+	download.queuedChunks.push_front(chunk);
+	return true;
+}
+
+void ContentSyncClient::handleChunk(const NetworkMessageContentChunk &chunk) {
+	ContentSyncType type = chunk.getContentType();
+	map<int,Download>::iterator iterFind = downloads.find(type);
+	if(iterFind == downloads.end() || iterFind->second.haveManifest == false) {
+		return;
+	}
+	Download &download = iterFind->second;
+
+	// only chunks that were asked for and not yet timed out
+	ChunkRef chunkRef(chunk.getFileIndex(), chunk.getChunkIndex());
+	map<ChunkRef,time_t>::iterator iterChunk = download.outstandingChunks.find(chunkRef);
+	if(iterChunk == download.outstandingChunks.end()) {
+		return;
+	}
+	download.outstandingChunks.erase(iterChunk);
+
+	const ContentChunkFile &file = download.files[chunkRef.first];
+	bool validChunk = (chunk.getChunkSize() == getExpectedChunkSize(file, chunkRef.second) &&
+			ContentChunks::getChunkCRC(chunk.getChunk(), chunk.getChunkSize()) == file.chunkCRCs[chunkRef.second] &&
+			ContentChunks::writeChunk(download.stagingPath + file.path, chunkRef.second, chunk.getChunk(), chunk.getChunkSize()));
+	if(validChunk == true) {
+		download.receivedBytes += chunk.getChunkSize();
+	}
+	else if(retryChunk(download, chunkRef) == false) {
+		finishDownload(type, false);
+	}
+}
+
+void ContentSyncClient::getChunkRequests(vector<NetworkMessageContentChunkRequest> &requests) {
+	time_t now = time(NULL);
+	vector<pair<ContentSyncType,bool> > completed;
+
+	for(map<int,Download>::iterator iterMap = downloads.begin(); iterMap != downloads.end(); ++iterMap) {
+		Download &download = iterMap->second;
+		if(download.haveManifest == false) {
+			continue;
+		}
+
+		// the server drops requests it can't queue, ask again
+		bool failed = false;
+		for(map<ChunkRef,time_t>::iterator iterChunk = download.outstandingChunks.begin();
+			iterChunk != download.outstandingChunks.end();) {
+			if(difftime(now,iterChunk->second) >= chunkTimeoutSeconds) {
+				ChunkRef chunkRef = iterChunk->first;
+				download.outstandingChunks.erase(iterChunk++);
+				failed = (retryChunk(download, chunkRef) == false || failed);
+			}
+			else {
+				++iterChunk;
+			}
+		}
+		if(failed == true) {
+			completed.push_back(std::make_pair(download.type, false));
+			continue;
+		}
+		if(download.queuedChunks.empty() == true && download.outstandingChunks.empty() == true) {
+			completed.push_back(std::make_pair(download.type, installDownload(download)));
+			continue;
+		}
+
+		NetworkMessageContentChunkRequest request(download.type, download.name);
+		for(;download.queuedChunks.empty() == false &&
+			 (int)download.outstandingChunks.size() < maxOutstandingChunks;) {
+			ChunkRef chunkRef = download.queuedChunks.front();
+			if(request.addChunk(chunkRef.first, chunkRef.second) == false) {
+				break;
+			}
+			download.queuedChunks.pop_front();
+			download.outstandingChunks[chunkRef] = now;
+		}
+		if(request.getChunks().empty() == false) {
+			requests.push_back(request);
+		}
+	}
+
+	for(unsigned int index = 0; index < completed.size(); ++index) {
+		finishDownload(completed[index].first, completed[index].second);
+	}
+}
+
+// Cuts the staging files to size and moves them in place, the staging
+// copy is kept when anything is still off so a retry can resume
+bool ContentSyncClient::installDownload(Download &download) {
+	for(unsigned int index = 0; index < download.files.size(); ++index) {
+		const ContentChunkFile &file = download.files[index];
+		string stagingFile = download.stagingPath + file.path;
+		if(ContentChunks::setFileSize(stagingFile, file.size) == false ||
+			ContentChunks::getStaleChunks(stagingFile, file).empty() == false) {
+			if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] staging file [%s] does not match the manifest\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,stagingFile.c_str());
+			return false;
+		}
+	}
+
+	if(download.type == cstMap) {
+		const ContentChunkFile &file = download.files[0];
+		string stagingFile = download.stagingPath + file.path;
+		string destFile = download.destPath + file.path;
+		createDirectoryPaths(download.destPath);
+		if(fileExists(destFile) == true) {
+			removeFile(destFile);
+		}
+		if(renameFile(stagingFile, destFile) == false &&
+			copyContentFile(stagingFile, destFile, file.size) == false) {
+			return false;
+		}
+	}
+	else {
+		// rename wants both folders without the trailing slash
+		string stagingFolder = download.stagingPath.substr(0, download.stagingPath.size() - 1);
+		string destFolder = download.destPath.substr(0, download.destPath.size() - 1);
+		if(folderExists(destFolder) == true) {
+			removeFolder(destFolder);
+		}
+		createDirectoryPaths(extractDirectoryPathFromFile(destFolder));
+		if(renameFile(stagingFolder, destFolder) == false) {
+			for(unsigned int index = 0; index < download.files.size(); ++index) {
+				const ContentChunkFile &file = download.files[index];
+				if(copyContentFile(download.stagingPath + file.path, download.destPath + file.path, file.size) == false) {
+					return false;
+				}
+			}
+		}
+	}
+
+	if(folderExists(download.stagingPath) == true) {
+		removeFolder(download.stagingPath);
+	}
+	return true;
+}
+
+void ContentSyncClient::finishDownload(ContentSyncType type, bool success) {
+	map<int,Download>::iterator iterFind = downloads.find(type);
+	if(iterFind == downloads.end()) {
+		return;
+	}
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] [%s] finished, success = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,iterFind->second.name.c_str(),success);
+
+	Result result;
+	result.type = type;
+	result.name = iterFind->second.name;
+	result.success = success;
+	finished.push_back(result);
+	downloads.erase(iterFind);
+}
+
+int ContentSyncClient::getProgress(ContentSyncType type) const {
+	map<int,Download>::const_iterator iterFind = downloads.find(type);
+	if(iterFind == downloads.end() || iterFind->second.haveManifest == false ||
+		iterFind->second.totalBytes == 0) {
+		return 0;
+	}
+	return (int)(iterFind->second.receivedBytes * 100 / iterFind->second.totalBytes);
+}
+
+bool ContentSyncClient::takeFinished(Result &result) {
+	if(finished.empty() == true) {
+		return false;
+	}
+	result = finished.front();
+	finished.erase(finished.begin());
+	return true;
+}
+
+}}//end namespace
@@ -0,0 +1,182 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_CONTENTSYNC_H_
+#define _GLEST_GAME_CONTENTSYNC_H_
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include <time.h>
+#include "network_message.h"
+#include "content_chunks.h"
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::deque;
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+using Shared::Platform::uint64;
+using Shared::Platform::Mutex;
+using Shared::Util::ContentChunkFile;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+//	class ContentSyncSource
+//
+///	Finds maps, tilesets and techtrees on disk and
+/// builds their chunk manifests, shared by all slots
+// =====================================================
+
+class ContentSyncSource {
+private:
+	class CachedManifest {
+	public:
+		string path;
+		time_t created;
+		vector<ContentChunkFile> files;
+	};
+
+	static const int manifestCacheSeconds;
+	static Mutex manifestCacheAccessor;
+	static map<string,CachedManifest> manifestCache;
+
+public:
+	static string getContentTypeName(ContentSyncType type);
+	static bool isValidContentName(const string &name);
+
+	// file for maps, folder for tilesets and techtrees,
+	// empty when the content isn't installed
+	static string getContentPath(ContentSyncType type, const string &name);
+	static bool getManifest(ContentSyncType type, const string &name,
+			string &contentPath, vector<ContentChunkFile> &files);
+};
+
+// =====================================================
+//	class ContentSyncUpload
+//
+///	Chunks one client asked for, owned by its
+/// connection slot
+// =====================================================
+
+class ContentSyncUpload {
+private:
+	class ServedContent {
+	public:
+		string name;
+		string path;
+		bool folder;
+		vector<ContentChunkFile> files;
+
+		ServedContent() : folder(false) {}
+	};
+
+	class PendingChunk {
+	public:
+		ContentSyncType type;
+		uint32 fileIndex;
+		uint32 chunkIndex;
+	};
+
+	static const unsigned int maxPendingChunks;
+
+	ServedContent served[cstCount];
+	deque<PendingChunk> pendingChunks;
+
+public:
+	// false when the content isn't available, files holds the manifest otherwise
+	bool openContent(ContentSyncType type, const string &name, vector<ContentChunkFile> &files);
+	void addRequest(const NetworkMessageContentChunkRequest &request);
+	void clear();
+
+	bool hasPendingChunks() const { return pendingChunks.empty() == false; }
+	// reads the next requested chunk, false when none is left
+	bool getNextChunk(ContentSyncType &type, uint32 &fileIndex, uint32 &chunkIndex, vector<unsigned char> &data);
+};
+
+// =====================================================
+//	class ContentSyncClient
+//
+///	Downloads content from the server in chunks, keeps
+/// a staging copy so an interrupted transfer resumes
+/// where it stopped, only used from the menu thread
+// =====================================================
+
+class ContentSyncClient {
+public:
+	class Result {
+	public:
+		ContentSyncType type;
+		string name;
+		bool success;
+	};
+
+private:
+	typedef pair<uint32,uint32> ChunkRef;
+
+	class Download {
+	public:
+		ContentSyncType type;
+		string name;
+		string destPath;
+		string stagingPath;
+		bool haveManifest;
+		vector<ContentChunkFile> files;
+
+		deque<ChunkRef> queuedChunks;
+		map<ChunkRef,time_t> outstandingChunks;
+		map<ChunkRef,int> chunkRetries;
+		uint64 totalBytes;
+		uint64 receivedBytes;
+
+		Download() : type(cstMap), haveManifest(false), totalBytes(0), receivedBytes(0) {}
+	};
+
+	static const int maxOutstandingChunks;
+	static const int maxInterleavedFiles;
+	static const int maxChunkRetries;
+	static const int chunkTimeoutSeconds;
+
+	map<int,Download> downloads;
+	vector<Result> finished;
+
+	static uint32 getExpectedChunkSize(const ContentChunkFile &file, uint32 chunkIndex);
+	static bool copyContentFile(const string &fromFile, const string &toFile, uint32 size);
+
+	void queueStaleChunks(Download &download);
+	bool retryChunk(Download &download, const ChunkRef &chunk);
+	bool installDownload(Download &download);
+	void finishDownload(ContentSyncType type, bool success);
+
+public:
+	// destFolder receives the content, stagingFolder holds partial files
+	bool start(ContentSyncType type, const string &name, const string &destFolder, const string &stagingFolder);
+	bool isDownloading(ContentSyncType type) const { return downloads.find(type) != downloads.end(); }
+	bool isDownloading(ContentSyncType type, const string &name) const;
+	// staging files are kept so a later start resumes
+	void cancelAll();
+
+	void handleManifest(const NetworkMessageContentManifest &manifest);
+	void handleChunk(const NetworkMessageContentChunk &chunk);
+	// requests that keep the transfer window full
+	void getChunkRequests(vector<NetworkMessageContentChunkRequest> &requests);
+
+	int getProgress(ContentSyncType type) const;
+	bool takeFinished(Result &result);
+};
+
+}}//end namespace
+
+#endif
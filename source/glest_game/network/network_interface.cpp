@@ -17,9 +17,10 @@
 #include "data_types.h"
 #include "conversion.h"
 #include "platform_util.h"
+#include "config.h"
+#include "game_util.h"
 #include <fstream>
 #include "util.h"
-#include "network_protocol.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Platform;
@@ -52,6 +53,8 @@ NetworkInterface::NetworkInterface() {
 	for(unsigned int index = 0; index < (unsigned int)GameConstants::maxPlayers; ++index) {
 		networkPlayerFactionCRC[index] = 0;
 	}
+	peerCapabilities = 0;
+	lastReceivedByteCount = 0;
 }
 
 void NetworkInterface::init() {
@@ -68,6 +71,14 @@ void NetworkInterface::init() {
 	for(unsigned int index = 0; index < (unsigned int)GameConstants::maxPlayers; ++index) {
 		networkPlayerFactionCRC[index] = 0;
 	}
+	setPeerCapabilities(0);
+	lastReceivedByteCount = 0;
+}
+
+void NetworkInterface::setPeerCapabilities(uint32 capabilities) {
+	peerCapabilities = capabilities;
+	sentCommandListFrames.reset();
+	receivedCommandListFrames.reset();
 }
 
 NetworkInterface::~NetworkInterface() {
@@ -114,7 +125,70 @@ void NetworkInterface::addUnMarkedCell(const UnMarkedCell &msg) {
 void NetworkInterface::sendMessage(NetworkMessage* networkMessage){
 	Socket* socket= getSocket(false);
 
-	networkMessage->send(socket);
+	bool countBytes = (NetworkTelemetry::isEnabled() == true && socket != NULL);
+	int64 queuedBytes = (countBytes == true ? socket->getQueuedByteCount() : 0);
+
+	NetworkMessageType messageType = networkMessage->getNetworkMessageType();
+	if(messageType == nmtCommandList &&
+		(peerCapabilities & ncapCompactCommandList) != 0) {
+		static_cast<NetworkMessageCommandList *>(networkMessage)->sendCompact(socket, sentCommandListFrames);
+		// the compact form picks its own type, the bytes are what matters
+		messageType = nmtCommandListCompact;
+	}
+	else {
+		networkMessage->send(socket);
+	}
+
+	if(countBytes == true) {
+		telemetry.addSent(messageType, socket->getQueuedByteCount() - queuedBytes);
+		if(messageType == nmtPing) {
+			NetworkMessagePing *ping = static_cast<NetworkMessagePing *>(networkMessage);
+			if(ping->getPingFrequency() > 0) {
+				telemetry.addPingSent(ping->getPingTime());
+			}
+		}
+	}
+}
+
+void NetworkInterface::addReceivedTelemetry(int type) {
+	Socket* socket = getSocket(false);
+	if(NetworkTelemetry::isEnabled() == false || socket == NULL) {
+		return;
+	}
+	// includes the type byte read by getNextMessageType, a new socket
+	// starts counting from zero again
+	int64 receivedBytes = socket->getReceivedByteCount();
+	int64 bytes = receivedBytes - lastReceivedByteCount;
+	if(bytes < 0) {
+		bytes = receivedBytes;
+	}
+	lastReceivedByteCount = receivedBytes;
+	telemetry.addReceived(type, bytes);
+}
+
+bool NetworkInterface::isNetworkTelemetryWriteDue(time_t &lastWriteTime, string &file) {
+	Config &config = Config::getInstance();
+	file = config.getString("NetworkTelemetryFile","");
+	if(file == "" ||
+		NetworkTelemetry::isWriteDue(lastWriteTime, config.getInt("NetworkTelemetryIntervalSeconds","5")) == false) {
+		return false;
+	}
+	bool absolutePath = (file[0] == '/' || file[0] == '\\' || file.find(':') != string::npos);
+	if(absolutePath == false &&
+		getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) != "") {
+		file = getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) + file;
+	}
+	return true;
+}
+
+void NetworkInterface::handlePingMessage(const NetworkMessagePing &ping) {
+	if(ping.getPingFrequency() == 0) {
+		telemetry.addPingEcho(ping.getPingTime());
+	}
+	else if((peerCapabilities & ncapPingEcho) != 0) {
+		NetworkMessagePing echo(0, ping.getPingTime());
+		sendMessage(&echo);
+	}
 }
 
 NetworkMessageType NetworkInterface::getNextMessageType(int waitMilliseconds) {
@@ -207,7 +281,11 @@ bool NetworkInterface::receiveMessage(NetworkMessage* networkMessage){
 
 	Socket* socket= getSocket(false);
 
-	return networkMessage->receive(socket);
+	bool result = networkMessage->receive(socket);
+	if(result == true) {
+		addReceivedTelemetry(networkMessage->getNetworkMessageType());
+	}
+	return result;
 }
 
 bool NetworkInterface::receiveMessage(NetworkMessage* networkMessage, NetworkMessageType type) {
@@ -215,7 +293,25 @@ bool NetworkInterface::receiveMessage(NetworkMessage* networkMessage, NetworkMes
 
 	Socket* socket = getSocket(false);
 
-	return networkMessage->receive(socket, type);
+	bool result = networkMessage->receive(socket, type);
+	if(result == true) {
+		addReceivedTelemetry(type);
+	}
+	return result;
+}
+
+bool NetworkInterface::receiveCommandList(NetworkMessageCommandList* networkMessage, NetworkMessageType type) {
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s] type = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,type);
+
+	Socket* socket = getSocket(false);
+
+	bool result = (type == nmtCommandList ?
+			networkMessage->receive(socket) :
+			networkMessage->receiveCompact(socket, type, receivedCommandListFrames));
+	if(result == true) {
+		addReceivedTelemetry(type);
+	}
+	return result;
 }
 
 bool NetworkInterface::isConnected(){
@@ -22,6 +22,7 @@
 #include "checksum.h"
 #include "network_message.h"
 #include "network_types.h"
+#include "network_telemetry.h"
 #include "game_settings.h"
 #include "thread.h"
 #include "data_types.h"
@@ -202,6 +203,22 @@ protected:
 	Mutex *networkPlayerFactionCRCMutex;
 	uint32 networkPlayerFactionCRC[GameConstants::maxPlayers];
 
+	// NetworkCapabilityType bits from the intro of the other side
+	uint32 peerCapabilities;
+	NetworkCommandListFrameState sentCommandListFrames;
+	NetworkCommandListFrameState receivedCommandListFrames;
+
+	NetworkTelemetry telemetry;
+	int64 lastReceivedByteCount;
+
+	void addReceivedTelemetry(int type);
+	// the NetworkTelemetryFile to write now, relative names go to the
+	// logs folder
+	static bool isNetworkTelemetryWriteDue(time_t &lastWriteTime, string &file);
+	// echoes pings of peers that measure round trips, a ping with
+	// frequency 0 is the echo of one of ours
+	void handlePingMessage(const NetworkMessagePing &ping);
+
 public:
 	static const int readyWaitTimeout;
 	GameSettings gameSettings;
@@ -239,6 +256,12 @@ public:
 	NetworkMessageType getNextMessageType(int waitMilliseconds=0);
 	bool receiveMessage(NetworkMessage* networkMessage);
 	bool receiveMessage(NetworkMessage* networkMessage, NetworkMessageType type);
+	bool receiveCommandList(NetworkMessageCommandList* networkMessage, NetworkMessageType type);
+
+	uint32 getPeerCapabilities() const	{ return peerCapabilities; }
+	NetworkTelemetry & getTelemetry()	{ return telemetry; }
+	const NetworkTelemetry & getTelemetry() const { return telemetry; }
+	void setPeerCapabilities(uint32 capabilities);
 
 	virtual bool isConnected();
 
@@ -0,0 +1,391 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "network_load_test.h"
+
+#include <algorithm>
+#include "client_interface.h"
+#include "network_types.h"
+#include "config.h"
+#include "checksum.h"
+#include "conversion.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::PlatformCommon;
+using namespace Shared::Util;
+
+namespace Glest{ namespace Game{
+
+// scripted commands name units no world has, the server logs and drops them
+static const int loadTestUnitIdBase 		= 1000000;
+static const int loadTestUnitIdsPerClient 	= 1000;
+static const int loadTestCommandPosition 	= 64;
+
+// =====================================================
+//	class NetworkLoadTestClient
+// =====================================================
+
+NetworkLoadTestClient::NetworkLoadTestClient(NetworkLoadTest *loadTest, int clientIndex) : BaseThread() {
+	this->loadTest 			= loadTest;
+	this->clientIndex 		= clientIndex;
+	this->clientInterface 	= new ClientInterface();
+	this->commandsSent 		= 0;
+	this->commandsReceived 	= 0;
+	this->uniqueID 			= "NetworkLoadTestClient";
+
+	random.init(clientIndex + 1);
+}
+
+NetworkLoadTestClient::~NetworkLoadTestClient() {
+	delete clientInterface;
+	clientInterface = NULL;
+}
+
+void NetworkLoadTestClient::execute() {
+	RunningStatusSafeWrapper runningStatus(this);
+	try {
+		clientInterface->setLocalPlayerIdentity("LoadTest" + intToStr(clientIndex + 1),
+				"loadtest-" + intToStr(clientIndex + 1) + "-" + intToStr((int)time(NULL)));
+		clientInterface->connect(Ip("127.0.0.1"), loadTest->getPort());
+
+		if(joinLobby() == true) {
+			clientInterface->waitUntilReady(NULL);
+			if(clientInterface->isConnected() == false) {
+				errorText = "Disconnected while waiting for the server to start the game";
+			}
+			else {
+				playKeyframes();
+				if(clientInterface->isConnected() == true) {
+					clientInterface->quitGame(true);
+				}
+			}
+		}
+	}
+	catch(const exception &ex) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
+		errorText = ex.what();
+	}
+	catch(...) {
+		errorText = "Unknown error";
+	}
+
+	if(clientInterface != NULL && clientInterface->isConnected() == true) {
+		clientInterface->close();
+	}
+}
+
+bool NetworkLoadTestClient::joinLobby() {
+	bool lobbyReady 		= false;
+	bool launchRequested 	= false;
+	time_t startTime 		= time(NULL);
+
+	for(;getQuitStatus() == false;) {
+		if(difftime((long int)time(NULL),startTime) > NetworkLoadTest::getLobbyWaitSeconds()) {
+			errorText = (launchRequested == true ? "Timed out waiting for the game to launch" : "Timed out in the lobby");
+			return false;
+		}
+
+		MutexSafeWrapper safeMutex(loadTest->getLobbyAccessor(),CODE_AT_LINE);
+		clientInterface->updateLobby();
+
+		if(clientInterface->isConnected() == false) {
+			errorText = "Disconnected from the server in the lobby";
+			return false;
+		}
+		if(clientInterface->getReceivedDataSynchCheck() == true &&
+			clientInterface->getNetworkGameDataSynchCheckOk() == false) {
+			errorText = "Game data differs from the server";
+			return false;
+		}
+		if(clientInterface->getLaunchGame() == true) {
+			return true;
+		}
+
+		if(lobbyReady == false &&
+			clientInterface->getIntroDone() == true &&
+			clientInterface->getGameSettingsReceived() == true) {
+			string dataError = loadTest->checkGameData(clientInterface->getGameSettings());
+			if(dataError != "") {
+				errorText = dataError;
+				return false;
+			}
+			loadTest->setLobbyReady(clientInterface->getPlayerIndex());
+			lobbyReady = true;
+		}
+		safeMutex.ReleaseLock();
+
+		// the headless server makes the first client its admin, that one launches
+		if(lobbyReady == true && launchRequested == false &&
+			clientInterface->isMasterServerAdminOverride() == true &&
+			loadTest->isLobbyReady() == true) {
+			GameSettings settings = *clientInterface->getGameSettings();
+			if(loadTest->prepareLaunchSettings(settings) == true) {
+				clientInterface->broadcastGameStart(&settings);
+				launchRequested = true;
+			}
+		}
+
+		sleep(10);
+	}
+	return false;
+}
+
+void NetworkLoadTestClient::requestScriptedCommands(int frame) {
+	int commandCount = random.randRange(0, 2);
+	int factionIndex = clientInterface->getGameSettings()->getThisFactionIndex();
+
+	for(int index = 0; index < commandCount; ++index) {
+		NetworkCommand command;
+		command.networkCommandType 	= ((frame + index) % 2 == 0 ? nctGiveCommand : nctSetMeetingPoint);
+		command.unitId 				= loadTestUnitIdBase + clientIndex * loadTestUnitIdsPerClient + random.randRange(0, loadTestUnitIdsPerClient - 1);
+		command.commandTypeId 		= -1;
+		command.unitTypeId 			= -1;
+		command.targetId 			= -1;
+		command.positionX 			= random.randRange(0, loadTestCommandPosition - 1);
+		command.positionY 			= random.randRange(0, loadTestCommandPosition - 1);
+		command.fromFactionIndex 	= factionIndex;
+		command.unitFactionIndex 	= factionIndex;
+		command.commandStateValue 	= -1;
+		command.unitCommandGroupId 	= -1;
+
+		clientInterface->requestCommand(&command);
+		commandsSent++;
+	}
+}
+
+void NetworkLoadTestClient::playKeyframes() {
+	int framePeriod = std::max(1, clientInterface->getGameSettings()->getNetworkFramePeriod());
+	int64 nominalKeyframeMicros = (int64)framePeriod * 1000000 / std::max(1, GameConstants::updateFps);
+
+	int64 lastSentBytes 	= clientInterface->getSocket()->getSentByteCount();
+	int64 lastReceivedBytes = clientInterface->getSocket()->getReceivedByteCount();
+	int64 lastArrivalMicros = -1;
+	Chrono chrono(true);
+
+	for(int keyframe = 1; keyframe <= loadTest->getKeyframeCount() && getQuitStatus() == false; ++keyframe) {
+		int frame = keyframe * framePeriod;
+		requestScriptedCommands(frame);
+
+		int64 startMicros = chrono.getMicros();
+		clientInterface->updateKeyframe(frame);
+		int64 arrivalMicros = chrono.getMicros();
+
+		if(clientInterface->isConnected() == false) {
+			errorText = "Disconnected from the server at frame " + intToStr(frame);
+			return;
+		}
+		commandsReceived += clientInterface->getPendingCommandCount();
+		clientInterface->clearPendingCommands();
+		clientInterface->update();
+
+		keyframeWaitMicros.push_back(arrivalMicros - startMicros);
+		// keyframes that arrive later than the frame rate allows mean the server fell behind
+		if(lastArrivalMicros >= 0) {
+			serverFrameWaitMicros.push_back(std::max((int64)0, arrivalMicros - lastArrivalMicros - nominalKeyframeMicros));
+		}
+		lastArrivalMicros = arrivalMicros;
+
+		Socket *socket = clientInterface->getSocket();
+		if(socket != NULL) {
+			int64 sentBytes 	= socket->getSentByteCount();
+			int64 receivedBytes = socket->getReceivedByteCount();
+			keyframeSentBytes.push_back(sentBytes - lastSentBytes);
+			keyframeReceivedBytes.push_back(receivedBytes - lastReceivedBytes);
+			lastSentBytes 		= sentBytes;
+			lastReceivedBytes 	= receivedBytes;
+		}
+	}
+}
+
+// =====================================================
+//	class NetworkLoadTest
+// =====================================================
+
+const int NetworkLoadTest::lobbyWaitSeconds = 120;
+
+NetworkLoadTest::NetworkLoadTest(int clientCount, int port, int keyframeCount) {
+	this->clientCount 		= clientCount;
+	this->port 				= port;
+	this->keyframeCount 	= keyframeCount;
+	this->lobbyAccessor 	= new Mutex(CODE_AT_LINE);
+	this->stateAccessor 	= new Mutex(CODE_AT_LINE);
+	this->lobbyReadyCount 	= 0;
+}
+
+NetworkLoadTest::~NetworkLoadTest() {
+	delete lobbyAccessor;
+	lobbyAccessor = NULL;
+	delete stateAccessor;
+	stateAccessor = NULL;
+}
+
+uint32 NetworkLoadTest::getDataCRC(const string &type, const string &name) {
+	string key = type + ":" + name;
+	if(dataCRCs.find(key) != dataCRCs.end()) {
+		return dataCRCs[key];
+	}
+
+	Config &config = Config::getInstance();
+	uint32 crc = 0;
+	if(type == "tileset") {
+		crc = getFolderTreeContentsCheckSumRecursively(config.getPathListForType(ptTilesets,""), string("/") + name + string("/*"), ".xml", NULL);
+	}
+	else if(type == "techtree") {
+		crc = getFolderTreeContentsCheckSumRecursively(config.getPathListForType(ptTechs,""), string("/") + name + string("/*"), ".xml", NULL);
+	}
+	else {
+		string file = Config::getMapPath(name,"",false);
+		if(file != "") {
+			Checksum checksum;
+			checksum.addFile(file);
+			crc = checksum.getSum();
+		}
+	}
+	dataCRCs[key] = crc;
+	return crc;
+}
+
+string NetworkLoadTest::checkGameData(const GameSettings *settings) {
+	// the client interface already compared them while in the lobby
+	if(NetworkInterface::getAllowGameDataSynchCheck() == true) {
+		return "";
+	}
+
+	if(settings->getTilesetCRC() != getDataCRC("tileset",settings->getTileset())) {
+		return "Tileset [" + settings->getTileset() + "] differs from the server";
+	}
+	if(settings->getTechCRC() != getDataCRC("techtree",settings->getTech())) {
+		return "Techtree [" + settings->getTech() + "] differs from the server";
+	}
+	if(settings->getMapCRC() != getDataCRC("map",settings->getMap())) {
+		return "Map [" + settings->getMap() + "] differs from the server";
+	}
+	return "";
+}
+
+void NetworkLoadTest::setLobbyReady(int playerIndex) {
+	MutexSafeWrapper safeMutex(stateAccessor,CODE_AT_LINE);
+	lobbyReadyCount++;
+	playerIndexes.push_back(playerIndex);
+}
+
+bool NetworkLoadTest::isLobbyReady() {
+	MutexSafeWrapper safeMutex(stateAccessor,CODE_AT_LINE);
+	return (lobbyReadyCount >= clientCount);
+}
+
+bool NetworkLoadTest::prepareLaunchSettings(GameSettings &settings) {
+	MutexSafeWrapper safeMutex(stateAccessor,CODE_AT_LINE);
+
+	// settings from before the last client joined are not launched
+	int joinedCount = 0;
+	for(int factionIndex = 0; factionIndex < settings.getFactionCount(); ++factionIndex) {
+		ControlType control = settings.getFactionControl(factionIndex);
+		bool isLoadTestClient = (std::find(playerIndexes.begin(),playerIndexes.end(),
+				settings.getStartLocationIndex(factionIndex)) != playerIndexes.end());
+
+		if(isLoadTestClient == true && control == ctNetwork) {
+			joinedCount++;
+		}
+		else if(control == ctNetwork || control == ctNetworkUnassigned) {
+			settings.setFactionControl(factionIndex,ctCpu);
+		}
+	}
+	if(joinedCount < clientCount) {
+		return false;
+	}
+
+	// the clients have no world, so there are no faction CRCs to compare
+	settings.setFlagTypes1(settings.getFlagTypes1() & ~(ft1_network_synch_checks | ft1_network_synch_checks_verbose));
+	return true;
+}
+
+int64 NetworkLoadTest::getPercentile(vector<int64> values, int percent) const {
+	if(values.empty() == true) {
+		return 0;
+	}
+	std::sort(values.begin(),values.end());
+	size_t index = (values.size() - 1) * percent / 100;
+	return values[index];
+}
+
+bool NetworkLoadTest::run() {
+	printf("Network load test: %d client(s) against localhost:%d for %d keyframes\n",clientCount,port,keyframeCount);
+
+	vector<NetworkLoadTestClient *> clients;
+	for(int clientIndex = 0; clientIndex < clientCount; ++clientIndex) {
+		NetworkLoadTestClient *client = new NetworkLoadTestClient(this,clientIndex);
+		client->setUniqueID(string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(clientIndex));
+		client->start();
+		clients.push_back(client);
+	}
+
+	for(bool running = true; running == true;) {
+		sleep(100);
+		running = false;
+		for(unsigned int index = 0; index < clients.size(); ++index) {
+			if(clients[index]->getRunningStatus() == true || clients[index]->getHasBeginExecution() == false) {
+				running = true;
+			}
+		}
+	}
+
+	bool result = true;
+	vector<int64> waitMicros;
+	vector<int64> serverWaitMicros;
+	int64 sentBytes 		= 0;
+	int64 receivedBytes 	= 0;
+	int commandsSent 		= 0;
+	int commandsReceived 	= 0;
+	for(unsigned int index = 0; index < clients.size(); ++index) {
+		NetworkLoadTestClient *client = clients[index];
+		if(client->getErrorText() != "") {
+			printf("Client %u failed: %s\n",index + 1,client->getErrorText().c_str());
+			result = false;
+		}
+		waitMicros.insert(waitMicros.end(),client->getKeyframeWaitMicros().begin(),client->getKeyframeWaitMicros().end());
+		serverWaitMicros.insert(serverWaitMicros.end(),client->getServerFrameWaitMicros().begin(),client->getServerFrameWaitMicros().end());
+		for(unsigned int keyframe = 0; keyframe < client->getKeyframeSentBytes().size(); ++keyframe) {
+			sentBytes 		+= client->getKeyframeSentBytes()[keyframe];
+			receivedBytes 	+= client->getKeyframeReceivedBytes()[keyframe];
+		}
+		commandsSent 		+= client->getCommandsSent();
+		commandsReceived 	+= client->getCommandsReceived();
+
+		delete client;
+	}
+	clients.clear();
+
+	int64 keyframesPlayed = (int64)waitMicros.size();
+	int64 serverWaitTotal = 0;
+	for(unsigned int index = 0; index < serverWaitMicros.size(); ++index) {
+		serverWaitTotal += serverWaitMicros[index];
+	}
+
+	printf("Keyframes played: %lld\n",(long long int)keyframesPlayed);
+	printf("Keyframe latency (usecs): p50 %lld p90 %lld p99 %lld max %lld\n",
+			(long long int)getPercentile(waitMicros,50),(long long int)getPercentile(waitMicros,90),
+			(long long int)getPercentile(waitMicros,99),(long long int)getPercentile(waitMicros,100));
+	printf("Bytes per keyframe and client: sent %.1f received %.1f\n",
+			keyframesPlayed > 0 ? (double)sentBytes / keyframesPlayed : 0.0,
+			keyframesPlayed > 0 ? (double)receivedBytes / keyframesPlayed : 0.0);
+	printf("Server frame wait (usecs): total %lld p50 %lld p99 %lld max %lld\n",
+			(long long int)serverWaitTotal,(long long int)getPercentile(serverWaitMicros,50),
+			(long long int)getPercentile(serverWaitMicros,99),(long long int)getPercentile(serverWaitMicros,100));
+	printf("Commands: sent %d received %d\n",commandsSent,commandsReceived);
+
+	return result;
+}
+
+}}//end namespace
@@ -0,0 +1,132 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_NETWORKLOADTEST_H_
+#define _GLEST_GAME_NETWORKLOADTEST_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "base_thread.h"
+#include "data_types.h"
+#include "game_settings.h"
+#include "randomgen.h"
+#include "leak_dumper.h"
+
+using std::map;
+using std::string;
+using std::vector;
+using Shared::Platform::int64;
+using Shared::Platform::uint32;
+using Shared::Platform::Mutex;
+using Shared::PlatformCommon::BaseThread;
+using Shared::Util::RandomGen;
+
+namespace Glest{ namespace Game{
+
+class ClientInterface;
+class NetworkLoadTest;
+
+// =====================================================
+//	class NetworkLoadTestClient
+//
+///	One scripted player of a load test. Joins the server,
+/// plays keyframes without a world and records how long
+/// each keyframe took to arrive.
+// =====================================================
+
+class NetworkLoadTestClient : public BaseThread {
+private:
+	NetworkLoadTest *loadTest;
+	int clientIndex;
+	ClientInterface *clientInterface;
+	RandomGen random;
+
+	string errorText;
+	vector<int64> keyframeWaitMicros;
+	vector<int64> serverFrameWaitMicros;
+	vector<int64> keyframeSentBytes;
+	vector<int64> keyframeReceivedBytes;
+	int commandsSent;
+	int commandsReceived;
+
+	bool joinLobby();
+	void playKeyframes();
+	void requestScriptedCommands(int frame);
+
+public:
+	NetworkLoadTestClient(NetworkLoadTest *loadTest, int clientIndex);
+	virtual ~NetworkLoadTestClient();
+	virtual void execute();
+
+	// results are only valid once the thread has stopped running
+	const string &getErrorText() const						{ return errorText; }
+	const vector<int64> &getKeyframeWaitMicros() const		{ return keyframeWaitMicros; }
+	const vector<int64> &getServerFrameWaitMicros() const	{ return serverFrameWaitMicros; }
+	const vector<int64> &getKeyframeSentBytes() const		{ return keyframeSentBytes; }
+	const vector<int64> &getKeyframeReceivedBytes() const	{ return keyframeReceivedBytes; }
+	int getCommandsSent() const								{ return commandsSent; }
+	int getCommandsReceived() const							{ return commandsReceived; }
+};
+
+// =====================================================
+//	class NetworkLoadTest
+//
+///	Runs --load-test-clients: connects a number of scripted
+/// clients to a headless server on this machine, launches
+/// a game with AI players in the remaining slots and
+/// reports keyframe latency, bytes per keyframe and how
+/// long the server ran behind its frame rate.
+// =====================================================
+
+class NetworkLoadTest {
+private:
+	static const int lobbyWaitSeconds;
+
+	int clientCount;
+	int port;
+	int keyframeCount;
+
+	Mutex *lobbyAccessor;
+	Mutex *stateAccessor;
+	int lobbyReadyCount;
+	vector<int> playerIndexes;
+	map<string,uint32> dataCRCs;
+
+	int64 getPercentile(vector<int64> values, int percent) const;
+	uint32 getDataCRC(const string &type, const string &name);
+
+public:
+	NetworkLoadTest(int clientCount, int port, int keyframeCount);
+	~NetworkLoadTest();
+
+	int getClientCount() const		{ return clientCount; }
+	int getPort() const				{ return port; }
+	int getKeyframeCount() const	{ return keyframeCount; }
+
+	// held around lobby updates and data CRC checks of all clients
+	Mutex *getLobbyAccessor()		{ return lobbyAccessor; }
+
+	// call with the lobby accessor held, returns an error or ""
+	string checkGameData(const GameSettings *settings);
+	void setLobbyReady(int playerIndex);
+	bool isLobbyReady();
+	bool prepareLaunchSettings(GameSettings &settings);
+
+	static int getLobbyWaitSeconds()	{ return lobbyWaitSeconds; }
+
+	// returns false when any client failed
+	bool run();
+};
+
+}}//end namespace
+
+#endif
@@ -15,9 +15,10 @@
 #include "util.h"
 #include "game_settings.h"
 #include "checksum.h"
+#include "varint_buffer.h"
 #include "platform_util.h"
 #include "config.h"
-#include "network_protocol.h"
+#include "packed_fields.h"
 #include "compression_utils.h"
 #include <algorithm>
 #include <cassert>
@@ -35,6 +36,12 @@ namespace Glest{ namespace Game{
 
 bool NetworkMessage::useOldProtocol = true;
 
+// A NetworkString goes out at its full size, the "Ns" of the old format strings
+template<int S>
+static inline PackedString packedString(NetworkString<S> &value) {
+	return PackedString(value.getBuffer(), S, S);
+}
+
 auto_ptr<Mutex> NetworkMessage::mutexMessageStats(new Mutex(CODE_AT_LINE));
 Chrono NetworkMessage::statsTimer;
 Chrono NetworkMessage::lastSend;
@@ -92,18 +99,39 @@ void NetworkMessage::send(Socket* socket, const void* data, int dataSize) {
 void NetworkMessage::send(Socket* socket, const void* data, int dataSize, int8 messageType) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] socket = %p, data = %p, dataSize = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,socket,data,dataSize);
 
+	const void *parts[] 	= { &messageType, data };
+	const int partSizes[] 	= { (int)sizeof(messageType), dataSize };
+	send(socket, parts, partSizes, 2);
+}
+
+void NetworkMessage::send(Socket* socket, const void* data, int dataSize, int8 messageType, uint32 compressedLength) {
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] socket = %p, data = %p, dataSize = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,socket,data,dataSize);
+
+	const void *parts[] 	= { &messageType, &compressedLength, data };
+	const int partSizes[] 	= { (int)sizeof(messageType), (int)sizeof(compressedLength), dataSize };
+	send(socket, parts, partSizes, 3);
+}
+
+void NetworkMessage::send(Socket* socket, const void * const data[], const int dataSize[], int partCount) {
 	if(socket != NULL) {
-		int msgTypeSize = sizeof(messageType);
-		int fullMsgSize = msgTypeSize + dataSize;
+		int fullMsgSize = 0;
+		for(int index = 0; index < partCount; ++index) {
+			fullMsgSize += dataSize[index];
+		}
 
-		char *out_buffer = new char[fullMsgSize];
-		memcpy(out_buffer,&messageType,msgTypeSize);
-		memcpy(&out_buffer[msgTypeSize],(const char *)data,dataSize);
+		if(isPacketDumpEnabled() == true) {
+			// Only the packet debug output needs the message in one piece
+			vector<char> out_buffer;
+			out_buffer.reserve(fullMsgSize);
+			for(int index = 0; index < partCount; ++index) {
+				const char *part = static_cast<const char *>(data[index]);
+				out_buffer.insert(out_buffer.end(), part, part + dataSize[index]);
+			}
+			dump_packet("\nOUTGOING PACKET:\n",(fullMsgSize > 0 ? &out_buffer[0] : NULL), fullMsgSize, true);
+		}
 
-		dump_packet("\nOUTGOING PACKET:\n",out_buffer, fullMsgSize, true);
-		int sendResult = socket->send(out_buffer, fullMsgSize);
+		int sendResult = socket->sendv(data, dataSize, partCount);
 		if(sendResult != fullMsgSize) {
-			delete [] out_buffer;
 			if(socket != NULL && socket->isSocketValid() == true) {
 				char szBuf[8096]="";
 				snprintf(szBuf,8096,"Error sending NetworkMessage, sendResult = %d, dataSize = %d",sendResult,fullMsgSize);
@@ -113,42 +141,43 @@ void NetworkMessage::send(Socket* socket, const void* data, int dataSize, int8 m
 				if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s] Line: %d socket has been disconnected\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 			}
 		}
-		else {
-			delete [] out_buffer;
-		}
 	}
 }
 
-void NetworkMessage::send(Socket* socket, const void* data, int dataSize, int8 messageType, uint32 compressedLength) {
-	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] socket = %p, data = %p, dataSize = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,socket,data,dataSize);
-
-	if(socket != NULL) {
-		int msgTypeSize = sizeof(messageType);
-		int compressedSize = sizeof(compressedLength);
-		int fullMsgSize = msgTypeSize + compressedSize + dataSize;
+void NetworkMessage::sendPayload(Socket* socket, int8 messageType, const std::vector<unsigned char> &payload) {
+	VarintWriter length;
+	length.writeUInt((uint32)payload.size());
 
-		char *out_buffer = new char[fullMsgSize];
-		memcpy(out_buffer,&messageType,msgTypeSize);
-		memcpy(&out_buffer[msgTypeSize],&compressedLength,compressedSize);
-		memcpy(&out_buffer[msgTypeSize+compressedSize],(const char *)data,dataSize);
+	const void *parts[] 	= { &messageType, &length.getBuffer()[0], (payload.empty() ? NULL : &payload[0]) };
+	const int partSizes[] 	= { (int)sizeof(messageType), length.getSize(), (int)payload.size() };
+	send(socket, parts, partSizes, 3);
+}
 
-		dump_packet("\nOUTGOING PACKET:\n",out_buffer, fullMsgSize, true);
-		int sendResult = socket->send(out_buffer, fullMsgSize);
-		if(sendResult != fullMsgSize) {
-			delete [] out_buffer;
-			if(socket != NULL && socket->isSocketValid() == true) {
-				char szBuf[8096]="";
-				snprintf(szBuf,8096,"Error sending NetworkMessage, sendResult = %d, dataSize = %d",sendResult,fullMsgSize);
-				throw megaglest_runtime_error(szBuf);
-			}
-			else {
-				if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s] Line: %d socket has been disconnected\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
-			}
+bool NetworkMessage::receivePayload(Socket* socket, std::vector<unsigned char> &payload, uint32 maxPayloadSize) {
+	uint32 payloadSize = 0;
+	for(int shift = 0;; shift += 7) {
+		unsigned char value = 0;
+		if(shift >= 35 || receive(socket, &value, sizeof(value), true) == false) {
+			return false;
 		}
-		else {
-			delete [] out_buffer;
+		payloadSize |= (uint32)(value & 0x7F) << shift;
+		if((value & 0x80) == 0) {
+			break;
 		}
 	}
+	if(payloadSize > maxPayloadSize) {
+		throw megaglest_runtime_error("Invalid network message payload size: " + uIntToStr(payloadSize));
+	}
+
+	payload.resize(payloadSize);
+	return (payloadSize == 0 || receive(socket, &payload[0], payloadSize, true) == true);
+}
+
+bool NetworkMessage::isPacketDumpEnabled() {
+	Config &config = Config::getInstance();
+	return (config.getBool("DebugNetworkPacketStats","false") == true ||
+			config.getBool("DebugNetworkPackets","false") == true ||
+			config.getBool("DebugNetworkPacketSizes","false") == true);
 }
 
 void NetworkMessage::resetNetworkPacketStats() {
@@ -318,6 +347,8 @@ NetworkMessageIntro::NetworkMessageIntro() {
 	data.externalIp = 0;
 	data.ftpPort = 0;
 	data.gameInProgress = 0;
+	data.capabilitiesVersion = 0;
+	data.capabilities = 0;
 }
 
 NetworkMessageIntro::NetworkMessageIntro(int32 sessionId,const string &versionString,
@@ -340,57 +371,28 @@ NetworkMessageIntro::NetworkMessageIntro(int32 sessionId,const string &versionSt
 	data.gameInProgress = gameInProgress;
 	data.playerUUID		= playerUUID;
 	data.platform		= platform;
+
+	setCapabilities(ncapCompactCommandList | ncapGameSnapshotStream | ncapContentSync | ncapPingEcho);
 }
 
-const char * NetworkMessageIntro::getPackedMessageFormat() const {
-	return "cl128s32shcLL60sc60s60s";
+template<class Archive>
+void NetworkMessageIntro::serializeFields(Archive &archive) {
+	archive & messageType & data.sessionId & packedString(data.versionString)
+		& packedString(data.name) & data.playerIndex & data.gameState & data.externalIp
+		& data.ftpPort & packedString(data.language) & data.gameInProgress
+		& packedString(data.playerUUID) & packedString(data.platform)
+		& data.capabilitiesVersion & data.capabilities;
 }
 
 unsigned int NetworkMessageIntro::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		packedData.externalIp = 0;
-		packedData.ftpPort = 0;
-		packedData.gameInProgress = 0;
-		packedData.gameState = 0;
-		messageType = nmtIntro;
-		packedData.playerIndex = 0;
-		packedData.sessionId = 0;
-
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.sessionId,
-				packedData.versionString.getBuffer(),
-				packedData.name.getBuffer(),
-				packedData.playerIndex,
-				packedData.gameState,
-				packedData.externalIp,
-				packedData.ftpPort,
-				packedData.language.getBuffer(),
-				data.gameInProgress,
-				packedData.playerUUID.getBuffer(),
-				packedData.platform.getBuffer());
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageIntro::unpackMessage(unsigned char *buf) {
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("\nIn [%s] about to unpack...\n",__FUNCTION__);
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.sessionId,
-			data.versionString.getBuffer(),
-			data.name.getBuffer(),
-			&data.playerIndex,
-			&data.gameState,
-			&data.externalIp,
-			&data.ftpPort,
-			data.language.getBuffer(),
-			&data.gameInProgress,
-			data.playerUUID.getBuffer(),
-			data.platform.getBuffer());
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] unpacked data:\n%s\n",__FUNCTION__,this->toString().c_str());
 }
 
@@ -398,22 +400,24 @@ unsigned char * NetworkMessageIntro::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
 
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("\nIn [%s] about to pack...\n",__FUNCTION__);
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.sessionId,
-			data.versionString.getBuffer(),
-			data.name.getBuffer(),
-			data.playerIndex,
-			data.gameState,
-			data.externalIp,
-			data.ftpPort,
-			data.language.getBuffer(),
-			data.gameInProgress,
-			data.playerUUID.getBuffer(),
-			data.platform.getBuffer());
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
+uint32 NetworkMessageIntro::getCapabilities() const {
+	// a layout this build doesn't know means no shared capabilities
+	if(data.capabilitiesVersion != currentCapabilitiesVersion) {
+		return 0;
+	}
+	return data.capabilities;
+}
+
+void NetworkMessageIntro::setCapabilities(uint32 capabilities) {
+	data.capabilitiesVersion = currentCapabilitiesVersion;
+	data.capabilities = capabilities;
+}
+
 string NetworkMessageIntro::toString() const {
 	string result = "messageType = " + intToStr(messageType);
 	result += " sessionId = " + intToStr(data.sessionId);
@@ -427,6 +431,8 @@ string NetworkMessageIntro::toString() const {
 	result += " gameInProgress = " + uIntToStr(data.gameInProgress);
 	result += " playerUUID = " + data.playerUUID.getString();
 	result += " platform = " + data.platform.getString();
+	result += " capabilitiesVersion = " + uIntToStr(data.capabilitiesVersion);
+	result += " capabilities = " + uIntToStr(data.capabilities);
 
 	return result;
 }
@@ -438,6 +444,7 @@ bool NetworkMessageIntro::receive(Socket* socket) {
 		if(result == true) {
 			messageType = this->getNetworkMessageType();
 		}
+		fromEndian();
 	}
 	else {
 		unsigned char *buf = new unsigned char[getPackedSize()+1];
@@ -446,7 +453,6 @@ bool NetworkMessageIntro::receive(Socket* socket) {
 		//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 		delete [] buf;
 	}
-	fromEndian();
 
 	data.name.nullTerminate();
 	data.versionString.nullTerminate();
@@ -461,9 +467,8 @@ bool NetworkMessageIntro::receive(Socket* socket) {
 void NetworkMessageIntro::send(Socket* socket) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] sending nmtIntro, data.playerIndex = %d, data.sessionId = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,data.playerIndex,data.sessionId);
 	assert(messageType == nmtIntro);
-	toEndian();
-
 	if(useOldProtocol == true) {
+		toEndian();
 		//NetworkMessage::send(socket, &messageType, sizeof(messageType));
 		NetworkMessage::send(socket, &data, sizeof(data),messageType);
 	}
@@ -479,27 +484,15 @@ void NetworkMessageIntro::send(Socket* socket) {
 void NetworkMessageIntro::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
-		data.sessionId = Shared::PlatformByteOrder::toCommonEndian(data.sessionId);
-		data.playerIndex = Shared::PlatformByteOrder::toCommonEndian(data.playerIndex);
-		data.gameState = Shared::PlatformByteOrder::toCommonEndian(data.gameState);
-		data.externalIp = Shared::PlatformByteOrder::toCommonEndian(data.externalIp);
-		data.ftpPort = Shared::PlatformByteOrder::toCommonEndian(data.ftpPort);
-
-		data.gameInProgress = Shared::PlatformByteOrder::toCommonEndian(data.gameInProgress);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 void NetworkMessageIntro::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::fromCommonEndian(messageType);
-		data.sessionId = Shared::PlatformByteOrder::fromCommonEndian(data.sessionId);
-		data.playerIndex = Shared::PlatformByteOrder::fromCommonEndian(data.playerIndex);
-		data.gameState = Shared::PlatformByteOrder::fromCommonEndian(data.gameState);
-		data.externalIp = Shared::PlatformByteOrder::fromCommonEndian(data.externalIp);
-		data.ftpPort = Shared::PlatformByteOrder::fromCommonEndian(data.ftpPort);
-
-		data.gameInProgress = Shared::PlatformByteOrder::fromCommonEndian(data.gameInProgress);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
@@ -521,39 +514,25 @@ NetworkMessagePing::NetworkMessagePing(int32 pingFrequency, int64 pingTime){
 	pingReceivedLocalTime=0;
 }
 
-const char * NetworkMessagePing::getPackedMessageFormat() const {
-	return "clq";
+template<class Archive>
+void NetworkMessagePing::serializeFields(Archive &archive) {
+	archive & messageType & data.pingFrequency & data.pingTime;
 }
 
 unsigned int NetworkMessagePing::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		messageType = 0;
-		packedData.pingFrequency = 0;
-		packedData.pingTime = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.pingFrequency,
-				packedData.pingTime);
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessagePing::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.pingFrequency,
-			&data.pingTime);
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 }
 
 unsigned char * NetworkMessagePing::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.pingFrequency,
-			data.pingTime);
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
@@ -564,6 +543,7 @@ bool NetworkMessagePing::receive(Socket* socket){
 		if(result == true) {
 			messageType = this->getNetworkMessageType();
 		}
+		fromEndian();
 	}
 	else {
 		unsigned char *buf = new unsigned char[getPackedSize()+1];
@@ -572,7 +552,6 @@ bool NetworkMessagePing::receive(Socket* socket){
 		//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 		delete [] buf;
 	}
-	fromEndian();
 
 	pingReceivedLocalTime = time(NULL);
 	return result;
@@ -581,9 +560,8 @@ bool NetworkMessagePing::receive(Socket* socket){
 void NetworkMessagePing::send(Socket* socket) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtPing\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 	assert(messageType == nmtPing);
-	toEndian();
-
 	if(useOldProtocol == true) {
+		toEndian();
 		//NetworkMessage::send(socket, &messageType, sizeof(messageType));
 		NetworkMessage::send(socket, &data, sizeof(data), messageType);
 	}
@@ -599,17 +577,15 @@ void NetworkMessagePing::send(Socket* socket) {
 void NetworkMessagePing::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
-		data.pingFrequency = Shared::PlatformByteOrder::toCommonEndian(data.pingFrequency);
-		data.pingTime = Shared::PlatformByteOrder::toCommonEndian(data.pingTime);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 void NetworkMessagePing::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::fromCommonEndian(messageType);
-		data.pingFrequency = Shared::PlatformByteOrder::fromCommonEndian(data.pingFrequency);
-		data.pingTime = Shared::PlatformByteOrder::fromCommonEndian(data.pingTime);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
@@ -627,35 +603,25 @@ NetworkMessageReady::NetworkMessageReady(uint32 checksum) {
 	data.checksum= checksum;
 }
 
-const char * NetworkMessageReady::getPackedMessageFormat() const {
-	return "cL";
+template<class Archive>
+void NetworkMessageReady::serializeFields(Archive &archive) {
+	archive & messageType & data.checksum;
 }
 
 unsigned int NetworkMessageReady::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		packedData.checksum = 0;
-		messageType = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.checksum);
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageReady::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.checksum);
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 }
 
 unsigned char * NetworkMessageReady::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.checksum);
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
@@ -666,6 +632,7 @@ bool NetworkMessageReady::receive(Socket* socket){
 		if(result == true) {
 			messageType = this->getNetworkMessageType();
 		}
+		fromEndian();
 	}
 	else {
 		unsigned char *buf = new unsigned char[getPackedSize()+1];
@@ -675,16 +642,14 @@ bool NetworkMessageReady::receive(Socket* socket){
 		//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 		delete [] buf;
 	}
-	fromEndian();
 	return result;
 }
 
 void NetworkMessageReady::send(Socket* socket) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtReady\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 	assert(messageType == nmtReady);
-	toEndian();
-
 	if(useOldProtocol == true) {
+		toEndian();
 		//NetworkMessage::send(socket, &messageType, sizeof(messageType));
 		NetworkMessage::send(socket, &data, sizeof(data), messageType);
 	}
@@ -699,15 +664,15 @@ void NetworkMessageReady::send(Socket* socket) {
 void NetworkMessageReady::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
-		data.checksum = Shared::PlatformByteOrder::toCommonEndian(data.checksum);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 void NetworkMessageReady::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::fromCommonEndian(messageType);
-		data.checksum = Shared::PlatformByteOrder::fromCommonEndian(data.checksum);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
@@ -866,511 +831,73 @@ vector<pair<string,uint32> > NetworkMessageLaunch::getFactionCRCList() const {
 	return factionCRCList;
 }
 
-const char * NetworkMessageLaunch::getPackedMessageFormat() const {
-	return "c256s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60sllllllll60s60s60s60s60s60s60s60sLLL60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60s60sLLLLLLLLLLLLLLLLLLLLcccccccccccccccccccccccccccccccccccccccccCccLccll256s60s60s60s60s60s60s60s60sc60s";
+template<class Archive>
+void NetworkMessageLaunch::serializeFields(Archive &archive) {
+	archive & messageType
+		& packedString(data.description) & packedString(data.map)
+		& packedString(data.tileset) & packedString(data.tech);
+	for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+		archive & packedString(data.factionTypeNames[i]);
+	}
+	for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+		archive & packedString(data.networkPlayerNames[i]);
+	}
+	for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+		archive & packedString(data.networkPlayerPlatform[i]);
+	}
+	for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+		archive & data.networkPlayerStatuses[i];
+	}
+	for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+		archive & packedString(data.networkPlayerLanguages[i]);
+	}
+	archive & data.mapCRC & data.mapFilter & data.tilesetCRC & data.techCRC;
+	for(int i = 0; i < maxFactionCRCCount; ++i) {
+		archive & packedString(data.factionNameList[i]);
+	}
+	for(int i = 0; i < maxFactionCRCCount; ++i) {
+		archive & data.factionCRCList[i];
+	}
+	for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+		archive & data.factionControls[i];
+	}
+	for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+		archive & data.resourceMultiplierIndex[i];
+	}
+	archive & data.thisFactionIndex & data.factionCount;
+	for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+		archive & data.teams[i];
+	}
+	for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+		archive & data.startLocationIndex[i];
+	}
+	archive & data.defaultResources & data.defaultUnits & data.defaultVictoryConditions
+		& data.fogOfWar & data.allowObservers & data.enableObserverModeAtEndGame
+		& data.enableServerControlledAI & data.networkFramePeriod
+		& data.networkPauseGameForLaggedClients & data.pathFinderType & data.flagTypes1
+		& data.aiAcceptSwitchTeamPercentChance & data.cpuReplacementMultiplier
+		& data.masterserver_admin & data.masterserver_admin_factionIndex
+		& packedString(data.scenario);
+	for(int i = 0; i < GameConstants::maxPlayers; ++i) {
+		archive & packedString(data.networkPlayerUUID[i]);
+	}
+	archive & data.networkAllowNativeLanguageTechtree & packedString(data.gameUUID);
 }
 
 unsigned int NetworkMessageLaunch::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		packedData.aiAcceptSwitchTeamPercentChance = 0;
-		packedData.allowObservers = 0;
-		packedData.cpuReplacementMultiplier = 0;
-		packedData.defaultResources = 0;
-		packedData.defaultUnits = 0;
-		packedData.defaultVictoryConditions = 0;
-		packedData.enableObserverModeAtEndGame = 0;
-		packedData.enableServerControlledAI = 0;
-		for(unsigned int index =0; index < (unsigned int)maxFactionCRCCount; ++index) {
-			packedData.factionCRCList[index] = 0;
-		}
-		for(unsigned int index =0; index < (unsigned int)GameConstants::maxPlayers; ++index) {
-			packedData.factionControls[index] = 0;
-			packedData.networkPlayerStatuses[index] = 0;
-			packedData.resourceMultiplierIndex[index] = 0;
-			packedData.startLocationIndex[index] = 0;
-			packedData.teams[index] = 0;
-		}
-		packedData.factionCount = 0;
-		packedData.flagTypes1 = 0;
-		packedData.fogOfWar = 0;
-		packedData.mapCRC = 0;
-		packedData.mapFilter = 0;
-		packedData.masterserver_admin = 0;
-		packedData.masterserver_admin_factionIndex = 0;
-		messageType = 0;
-		packedData.networkAllowNativeLanguageTechtree = 0;
-		packedData.networkFramePeriod = 0;
-		packedData.networkPauseGameForLaggedClients = 0;
-		packedData.pathFinderType = 0;
-		packedData.techCRC = 0;
-		packedData.thisFactionIndex = 0;
-		packedData.tilesetCRC = 0;
-
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.description.getBuffer(),
-				packedData.map.getBuffer(),
-				packedData.tileset.getBuffer(),
-				packedData.tech.getBuffer(),
-				packedData.factionTypeNames[0].getBuffer(),
-				packedData.factionTypeNames[1].getBuffer(),
-				packedData.factionTypeNames[2].getBuffer(),
-				packedData.factionTypeNames[3].getBuffer(),
-				packedData.factionTypeNames[4].getBuffer(),
-				packedData.factionTypeNames[5].getBuffer(),
-				packedData.factionTypeNames[6].getBuffer(),
-				packedData.factionTypeNames[7].getBuffer(),
-				packedData.networkPlayerNames[0].getBuffer(),
-				packedData.networkPlayerNames[1].getBuffer(),
-				packedData.networkPlayerNames[2].getBuffer(),
-				packedData.networkPlayerNames[3].getBuffer(),
-				packedData.networkPlayerNames[4].getBuffer(),
-				packedData.networkPlayerNames[5].getBuffer(),
-				packedData.networkPlayerNames[6].getBuffer(),
-				packedData.networkPlayerNames[7].getBuffer(),
-				packedData.networkPlayerPlatform[0].getBuffer(),
-				packedData.networkPlayerPlatform[1].getBuffer(),
-				packedData.networkPlayerPlatform[2].getBuffer(),
-				packedData.networkPlayerPlatform[3].getBuffer(),
-				packedData.networkPlayerPlatform[4].getBuffer(),
-				packedData.networkPlayerPlatform[5].getBuffer(),
-				packedData.networkPlayerPlatform[6].getBuffer(),
-				packedData.networkPlayerPlatform[7].getBuffer(),
-				packedData.networkPlayerStatuses[0],
-				packedData.networkPlayerStatuses[1],
-				packedData.networkPlayerStatuses[2],
-				packedData.networkPlayerStatuses[3],
-				packedData.networkPlayerStatuses[4],
-				packedData.networkPlayerStatuses[5],
-				packedData.networkPlayerStatuses[6],
-				packedData.networkPlayerStatuses[7],
-				packedData.networkPlayerLanguages[0].getBuffer(),
-				packedData.networkPlayerLanguages[1].getBuffer(),
-				packedData.networkPlayerLanguages[2].getBuffer(),
-				packedData.networkPlayerLanguages[3].getBuffer(),
-				packedData.networkPlayerLanguages[4].getBuffer(),
-				packedData.networkPlayerLanguages[5].getBuffer(),
-				packedData.networkPlayerLanguages[6].getBuffer(),
-				packedData.networkPlayerLanguages[7].getBuffer(),
-				packedData.mapCRC,
-				packedData.mapFilter,
-				packedData.tilesetCRC,
-				packedData.techCRC,
-				packedData.factionNameList[0].getBuffer(),
-				packedData.factionNameList[1].getBuffer(),
-				packedData.factionNameList[2].getBuffer(),
-				packedData.factionNameList[3].getBuffer(),
-				packedData.factionNameList[4].getBuffer(),
-				packedData.factionNameList[5].getBuffer(),
-				packedData.factionNameList[6].getBuffer(),
-				packedData.factionNameList[7].getBuffer(),
-				packedData.factionNameList[8].getBuffer(),
-				packedData.factionNameList[9].getBuffer(),
-				packedData.factionNameList[10].getBuffer(),
-				packedData.factionNameList[11].getBuffer(),
-				packedData.factionNameList[12].getBuffer(),
-				packedData.factionNameList[13].getBuffer(),
-				packedData.factionNameList[14].getBuffer(),
-				packedData.factionNameList[15].getBuffer(),
-				packedData.factionNameList[16].getBuffer(),
-				packedData.factionNameList[17].getBuffer(),
-				packedData.factionNameList[18].getBuffer(),
-				packedData.factionNameList[19].getBuffer(),
-				packedData.factionCRCList[0],
-				packedData.factionCRCList[1],
-				packedData.factionCRCList[2],
-				packedData.factionCRCList[3],
-				packedData.factionCRCList[4],
-				packedData.factionCRCList[5],
-				packedData.factionCRCList[6],
-				packedData.factionCRCList[7],
-				packedData.factionCRCList[8],
-				packedData.factionCRCList[9],
-				packedData.factionCRCList[10],
-				packedData.factionCRCList[11],
-				packedData.factionCRCList[12],
-				packedData.factionCRCList[13],
-				packedData.factionCRCList[14],
-				packedData.factionCRCList[15],
-				packedData.factionCRCList[16],
-				packedData.factionCRCList[17],
-				packedData.factionCRCList[18],
-				packedData.factionCRCList[19],
-				packedData.factionControls[0],
-				packedData.factionControls[1],
-				packedData.factionControls[2],
-				packedData.factionControls[3],
-				packedData.factionControls[4],
-				packedData.factionControls[5],
-				packedData.factionControls[6],
-				packedData.factionControls[7],
-				packedData.resourceMultiplierIndex[0],
-				packedData.resourceMultiplierIndex[1],
-				packedData.resourceMultiplierIndex[2],
-				packedData.resourceMultiplierIndex[3],
-				packedData.resourceMultiplierIndex[4],
-				packedData.resourceMultiplierIndex[5],
-				packedData.resourceMultiplierIndex[6],
-				packedData.resourceMultiplierIndex[7],
-				packedData.thisFactionIndex,
-				packedData.factionCount,
-				packedData.teams[0],
-				packedData.teams[1],
-				packedData.teams[2],
-				packedData.teams[3],
-				packedData.teams[4],
-				packedData.teams[5],
-				packedData.teams[6],
-				packedData.teams[7],
-				packedData.startLocationIndex[0],
-				packedData.startLocationIndex[1],
-				packedData.startLocationIndex[2],
-				packedData.startLocationIndex[3],
-				packedData.startLocationIndex[4],
-				packedData.startLocationIndex[5],
-				packedData.startLocationIndex[6],
-				packedData.startLocationIndex[7],
-				packedData.defaultResources,
-				packedData.defaultUnits,
-				packedData.defaultVictoryConditions,
-				packedData.fogOfWar,
-				packedData.allowObservers,
-				packedData.enableObserverModeAtEndGame,
-				packedData.enableServerControlledAI,
-				packedData.networkFramePeriod,
-				packedData.networkPauseGameForLaggedClients,
-				packedData.pathFinderType,
-				packedData.flagTypes1,
-				packedData.aiAcceptSwitchTeamPercentChance,
-				packedData.cpuReplacementMultiplier,
-				packedData.masterserver_admin,
-				packedData.masterserver_admin_factionIndex,
-				packedData.scenario.getBuffer(),
-				packedData.networkPlayerUUID[0].getBuffer(),
-				packedData.networkPlayerUUID[1].getBuffer(),
-				packedData.networkPlayerUUID[2].getBuffer(),
-				packedData.networkPlayerUUID[3].getBuffer(),
-				packedData.networkPlayerUUID[4].getBuffer(),
-				packedData.networkPlayerUUID[5].getBuffer(),
-				packedData.networkPlayerUUID[6].getBuffer(),
-				packedData.networkPlayerUUID[7].getBuffer(),
-				packedData.networkAllowNativeLanguageTechtree,
-				packedData.gameUUID.getBuffer()
-		);
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageLaunch::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			data.description.getBuffer(),
-			data.map.getBuffer(),
-			data.tileset.getBuffer(),
-			data.tech.getBuffer(),
-			data.factionTypeNames[0].getBuffer(),
-			data.factionTypeNames[1].getBuffer(),
-			data.factionTypeNames[2].getBuffer(),
-			data.factionTypeNames[3].getBuffer(),
-			data.factionTypeNames[4].getBuffer(),
-			data.factionTypeNames[5].getBuffer(),
-			data.factionTypeNames[6].getBuffer(),
-			data.factionTypeNames[7].getBuffer(),
-			data.networkPlayerNames[0].getBuffer(),
-			data.networkPlayerNames[1].getBuffer(),
-			data.networkPlayerNames[2].getBuffer(),
-			data.networkPlayerNames[3].getBuffer(),
-			data.networkPlayerNames[4].getBuffer(),
-			data.networkPlayerNames[5].getBuffer(),
-			data.networkPlayerNames[6].getBuffer(),
-			data.networkPlayerNames[7].getBuffer(),
-			data.networkPlayerPlatform[0].getBuffer(),
-			data.networkPlayerPlatform[1].getBuffer(),
-			data.networkPlayerPlatform[2].getBuffer(),
-			data.networkPlayerPlatform[3].getBuffer(),
-			data.networkPlayerPlatform[4].getBuffer(),
-			data.networkPlayerPlatform[5].getBuffer(),
-			data.networkPlayerPlatform[6].getBuffer(),
-			data.networkPlayerPlatform[7].getBuffer(),
-			&data.networkPlayerStatuses[0],
-			&data.networkPlayerStatuses[1],
-			&data.networkPlayerStatuses[2],
-			&data.networkPlayerStatuses[3],
-			&data.networkPlayerStatuses[4],
-			&data.networkPlayerStatuses[5],
-			&data.networkPlayerStatuses[6],
-			&data.networkPlayerStatuses[7],
-			data.networkPlayerLanguages[0].getBuffer(),
-			data.networkPlayerLanguages[1].getBuffer(),
-			data.networkPlayerLanguages[2].getBuffer(),
-			data.networkPlayerLanguages[3].getBuffer(),
-			data.networkPlayerLanguages[4].getBuffer(),
-			data.networkPlayerLanguages[5].getBuffer(),
-			data.networkPlayerLanguages[6].getBuffer(),
-			data.networkPlayerLanguages[7].getBuffer(),
-			&data.mapFilter,
-			&data.mapCRC,
-			&data.tilesetCRC,
-			&data.techCRC,
-			data.factionNameList[0].getBuffer(),
-			data.factionNameList[1].getBuffer(),
-			data.factionNameList[2].getBuffer(),
-			data.factionNameList[3].getBuffer(),
-			data.factionNameList[4].getBuffer(),
-			data.factionNameList[5].getBuffer(),
-			data.factionNameList[6].getBuffer(),
-			data.factionNameList[7].getBuffer(),
-			data.factionNameList[8].getBuffer(),
-			data.factionNameList[9].getBuffer(),
-			data.factionNameList[10].getBuffer(),
-			data.factionNameList[11].getBuffer(),
-			data.factionNameList[12].getBuffer(),
-			data.factionNameList[13].getBuffer(),
-			data.factionNameList[14].getBuffer(),
-			data.factionNameList[15].getBuffer(),
-			data.factionNameList[16].getBuffer(),
-			data.factionNameList[17].getBuffer(),
-			data.factionNameList[18].getBuffer(),
-			data.factionNameList[19].getBuffer(),
-			&data.factionCRCList[0],
-			&data.factionCRCList[1],
-			&data.factionCRCList[2],
-			&data.factionCRCList[3],
-			&data.factionCRCList[4],
-			&data.factionCRCList[5],
-			&data.factionCRCList[6],
-			&data.factionCRCList[7],
-			&data.factionCRCList[8],
-			&data.factionCRCList[9],
-			&data.factionCRCList[10],
-			&data.factionCRCList[11],
-			&data.factionCRCList[12],
-			&data.factionCRCList[13],
-			&data.factionCRCList[14],
-			&data.factionCRCList[15],
-			&data.factionCRCList[16],
-			&data.factionCRCList[17],
-			&data.factionCRCList[18],
-			&data.factionCRCList[19],
-			&data.factionControls[0],
-			&data.factionControls[1],
-			&data.factionControls[2],
-			&data.factionControls[3],
-			&data.factionControls[4],
-			&data.factionControls[5],
-			&data.factionControls[6],
-			&data.factionControls[7],
-			&data.resourceMultiplierIndex[0],
-			&data.resourceMultiplierIndex[1],
-			&data.resourceMultiplierIndex[2],
-			&data.resourceMultiplierIndex[3],
-			&data.resourceMultiplierIndex[4],
-			&data.resourceMultiplierIndex[5],
-			&data.resourceMultiplierIndex[6],
-			&data.resourceMultiplierIndex[7],
-			&data.thisFactionIndex,
-			&data.factionCount,
-			&data.teams[0],
-			&data.teams[1],
-			&data.teams[2],
-			&data.teams[3],
-			&data.teams[4],
-			&data.teams[5],
-			&data.teams[6],
-			&data.teams[7],
-			&data.startLocationIndex[0],
-			&data.startLocationIndex[1],
-			&data.startLocationIndex[2],
-			&data.startLocationIndex[3],
-			&data.startLocationIndex[4],
-			&data.startLocationIndex[5],
-			&data.startLocationIndex[6],
-			&data.startLocationIndex[7],
-			&data.defaultResources,
-			&data.defaultUnits,
-			&data.defaultVictoryConditions,
-			&data.fogOfWar,
-			&data.allowObservers,
-			&data.enableObserverModeAtEndGame,
-			&data.enableServerControlledAI,
-			&data.networkFramePeriod,
-			&data.networkPauseGameForLaggedClients,
-			&data.pathFinderType,
-			&data.flagTypes1,
-			&data.aiAcceptSwitchTeamPercentChance,
-			&data.cpuReplacementMultiplier,
-			&data.masterserver_admin,
-			&data.masterserver_admin_factionIndex,
-			data.scenario.getBuffer(),
-			data.networkPlayerUUID[0].getBuffer(),
-			data.networkPlayerUUID[1].getBuffer(),
-			data.networkPlayerUUID[2].getBuffer(),
-			data.networkPlayerUUID[3].getBuffer(),
-			data.networkPlayerUUID[4].getBuffer(),
-			data.networkPlayerUUID[5].getBuffer(),
-			data.networkPlayerUUID[6].getBuffer(),
-			data.networkPlayerUUID[7].getBuffer(),
-			&data.networkAllowNativeLanguageTechtree,
-			data.gameUUID.getBuffer()
-	);
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 }
 
 unsigned char * NetworkMessageLaunch::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.description.getBuffer(),
-			data.map.getBuffer(),
-			data.tileset.getBuffer(),
-			data.tech.getBuffer(),
-			data.factionTypeNames[0].getBuffer(),
-			data.factionTypeNames[1].getBuffer(),
-			data.factionTypeNames[2].getBuffer(),
-			data.factionTypeNames[3].getBuffer(),
-			data.factionTypeNames[4].getBuffer(),
-			data.factionTypeNames[5].getBuffer(),
-			data.factionTypeNames[6].getBuffer(),
-			data.factionTypeNames[7].getBuffer(),
-			data.networkPlayerNames[0].getBuffer(),
-			data.networkPlayerNames[1].getBuffer(),
-			data.networkPlayerNames[2].getBuffer(),
-			data.networkPlayerNames[3].getBuffer(),
-			data.networkPlayerNames[4].getBuffer(),
-			data.networkPlayerNames[5].getBuffer(),
-			data.networkPlayerNames[6].getBuffer(),
-			data.networkPlayerNames[7].getBuffer(),
-			data.networkPlayerPlatform[0].getBuffer(),
-			data.networkPlayerPlatform[1].getBuffer(),
-			data.networkPlayerPlatform[2].getBuffer(),
-			data.networkPlayerPlatform[3].getBuffer(),
-			data.networkPlayerPlatform[4].getBuffer(),
-			data.networkPlayerPlatform[5].getBuffer(),
-			data.networkPlayerPlatform[6].getBuffer(),
-			data.networkPlayerPlatform[7].getBuffer(),
-			data.networkPlayerStatuses[0],
-			data.networkPlayerStatuses[1],
-			data.networkPlayerStatuses[2],
-			data.networkPlayerStatuses[3],
-			data.networkPlayerStatuses[4],
-			data.networkPlayerStatuses[5],
-			data.networkPlayerStatuses[6],
-			data.networkPlayerStatuses[7],
-			data.networkPlayerLanguages[0].getBuffer(),
-			data.networkPlayerLanguages[1].getBuffer(),
-			data.networkPlayerLanguages[2].getBuffer(),
-			data.networkPlayerLanguages[3].getBuffer(),
-			data.networkPlayerLanguages[4].getBuffer(),
-			data.networkPlayerLanguages[5].getBuffer(),
-			data.networkPlayerLanguages[6].getBuffer(),
-			data.networkPlayerLanguages[7].getBuffer(),
-			data.mapFilter,
-			data.mapCRC,
-			data.tilesetCRC,
-			data.techCRC,
-			data.factionNameList[0].getBuffer(),
-			data.factionNameList[1].getBuffer(),
-			data.factionNameList[2].getBuffer(),
-			data.factionNameList[3].getBuffer(),
-			data.factionNameList[4].getBuffer(),
-			data.factionNameList[5].getBuffer(),
-			data.factionNameList[6].getBuffer(),
-			data.factionNameList[7].getBuffer(),
-			data.factionNameList[8].getBuffer(),
-			data.factionNameList[9].getBuffer(),
-			data.factionNameList[10].getBuffer(),
-			data.factionNameList[11].getBuffer(),
-			data.factionNameList[12].getBuffer(),
-			data.factionNameList[13].getBuffer(),
-			data.factionNameList[14].getBuffer(),
-			data.factionNameList[15].getBuffer(),
-			data.factionNameList[16].getBuffer(),
-			data.factionNameList[17].getBuffer(),
-			data.factionNameList[18].getBuffer(),
-			data.factionNameList[19].getBuffer(),
-			data.factionCRCList[0],
-			data.factionCRCList[1],
-			data.factionCRCList[2],
-			data.factionCRCList[3],
-			data.factionCRCList[4],
-			data.factionCRCList[5],
-			data.factionCRCList[6],
-			data.factionCRCList[7],
-			data.factionCRCList[8],
-			data.factionCRCList[9],
-			data.factionCRCList[10],
-			data.factionCRCList[11],
-			data.factionCRCList[12],
-			data.factionCRCList[13],
-			data.factionCRCList[14],
-			data.factionCRCList[15],
-			data.factionCRCList[16],
-			data.factionCRCList[17],
-			data.factionCRCList[18],
-			data.factionCRCList[19],
-			data.factionControls[0],
-			data.factionControls[1],
-			data.factionControls[2],
-			data.factionControls[3],
-			data.factionControls[4],
-			data.factionControls[5],
-			data.factionControls[6],
-			data.factionControls[7],
-			data.resourceMultiplierIndex[0],
-			data.resourceMultiplierIndex[1],
-			data.resourceMultiplierIndex[2],
-			data.resourceMultiplierIndex[3],
-			data.resourceMultiplierIndex[4],
-			data.resourceMultiplierIndex[5],
-			data.resourceMultiplierIndex[6],
-			data.resourceMultiplierIndex[7],
-			data.thisFactionIndex,
-			data.factionCount,
-			data.teams[0],
-			data.teams[1],
-			data.teams[2],
-			data.teams[3],
-			data.teams[4],
-			data.teams[5],
-			data.teams[6],
-			data.teams[7],
-			data.startLocationIndex[0],
-			data.startLocationIndex[1],
-			data.startLocationIndex[2],
-			data.startLocationIndex[3],
-			data.startLocationIndex[4],
-			data.startLocationIndex[5],
-			data.startLocationIndex[6],
-			data.startLocationIndex[7],
-			data.defaultResources,
-			data.defaultUnits,
-			data.defaultVictoryConditions,
-			data.fogOfWar,
-			data.allowObservers,
-			data.enableObserverModeAtEndGame,
-			data.enableServerControlledAI,
-			data.networkFramePeriod,
-			data.networkPauseGameForLaggedClients,
-			data.pathFinderType,
-			data.flagTypes1,
-			data.aiAcceptSwitchTeamPercentChance,
-			data.cpuReplacementMultiplier,
-			data.masterserver_admin,
-			data.masterserver_admin_factionIndex,
-			data.scenario.getBuffer(),
-			data.networkPlayerUUID[0].getBuffer(),
-			data.networkPlayerUUID[1].getBuffer(),
-			data.networkPlayerUUID[2].getBuffer(),
-			data.networkPlayerUUID[3].getBuffer(),
-			data.networkPlayerUUID[4].getBuffer(),
-			data.networkPlayerUUID[5].getBuffer(),
-			data.networkPlayerUUID[6].getBuffer(),
-			data.networkPlayerUUID[7].getBuffer(),
-			data.networkAllowNativeLanguageTechtree,
-			data.gameUUID.getBuffer()
-			);
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
@@ -1452,6 +979,7 @@ bool NetworkMessageLaunch::receive(Socket* socket) {
         	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] took msecs: %lld\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
         	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) chrono.start();
 		}
+		fromEndian();
 	}
 	else {
 		unsigned char *buf = new unsigned char[getPackedSize()+1];
@@ -1460,7 +988,6 @@ bool NetworkMessageLaunch::receive(Socket* socket) {
 		//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 		delete [] buf;
 	}
-	fromEndian();
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] took msecs: %lld\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled && chrono.getMillis() > 0) chrono.start();
@@ -1521,9 +1048,8 @@ void NetworkMessageLaunch::send(Socket* socket) {
 	else {
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] messageType = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,messageType);
 	}
-	toEndian();
-
 	if(useOldProtocol == true) {
+		toEndian();
 		////NetworkMessage::send(socket, &messageType, sizeof(messageType));
 		//NetworkMessage::send(socket, &data, sizeof(data), messageType);
 
@@ -1565,80 +1091,16 @@ void NetworkMessageLaunch::send(Socket* socket) {
 void NetworkMessageLaunch::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
-		for(int i= 0; i < GameConstants::maxPlayers; ++i){
-			data.networkPlayerStatuses[i] = Shared::PlatformByteOrder::toCommonEndian(data.networkPlayerStatuses[i]);
-			data.factionCRCList[i] = Shared::PlatformByteOrder::toCommonEndian(data.factionCRCList[i]);
-			data.factionControls[i] = Shared::PlatformByteOrder::toCommonEndian(data.factionControls[i]);
-			data.resourceMultiplierIndex[i] = Shared::PlatformByteOrder::toCommonEndian(data.resourceMultiplierIndex[i]);
-			data.teams[i] = Shared::PlatformByteOrder::toCommonEndian(data.teams[i]);
-			data.startLocationIndex[i] = Shared::PlatformByteOrder::toCommonEndian(data.startLocationIndex[i]);
-		}
-		data.mapFilter = Shared::PlatformByteOrder::toCommonEndian(data.mapFilter);
-		data.mapCRC = Shared::PlatformByteOrder::toCommonEndian(data.mapCRC);
-		data.tilesetCRC = Shared::PlatformByteOrder::toCommonEndian(data.tilesetCRC);
-		data.techCRC = Shared::PlatformByteOrder::toCommonEndian(data.techCRC);
-		data.thisFactionIndex = Shared::PlatformByteOrder::toCommonEndian(data.thisFactionIndex);
-		data.factionCount = Shared::PlatformByteOrder::toCommonEndian(data.factionCount);
-		data.defaultResources = Shared::PlatformByteOrder::toCommonEndian(data.defaultResources);
-		data.defaultUnits = Shared::PlatformByteOrder::toCommonEndian(data.defaultUnits);
-
-		data.defaultVictoryConditions = Shared::PlatformByteOrder::toCommonEndian(data.defaultVictoryConditions);
-		data.fogOfWar = Shared::PlatformByteOrder::toCommonEndian(data.fogOfWar);
-		data.allowObservers = Shared::PlatformByteOrder::toCommonEndian(data.allowObservers);
-		data.enableObserverModeAtEndGame = Shared::PlatformByteOrder::toCommonEndian(data.enableObserverModeAtEndGame);
-		data.enableServerControlledAI = Shared::PlatformByteOrder::toCommonEndian(data.enableServerControlledAI);
-		data.networkFramePeriod = Shared::PlatformByteOrder::toCommonEndian(data.networkFramePeriod);
-		data.networkPauseGameForLaggedClients = Shared::PlatformByteOrder::toCommonEndian(data.networkPauseGameForLaggedClients);
-		data.pathFinderType = Shared::PlatformByteOrder::toCommonEndian(data.pathFinderType);
-		data.flagTypes1 = Shared::PlatformByteOrder::toCommonEndian(data.flagTypes1);
-
-		data.aiAcceptSwitchTeamPercentChance = Shared::PlatformByteOrder::toCommonEndian(data.aiAcceptSwitchTeamPercentChance);
-		data.cpuReplacementMultiplier = Shared::PlatformByteOrder::toCommonEndian(data.cpuReplacementMultiplier);
-		data.masterserver_admin = Shared::PlatformByteOrder::toCommonEndian(data.masterserver_admin);
-		data.masterserver_admin_factionIndex = Shared::PlatformByteOrder::toCommonEndian(data.masterserver_admin_factionIndex);
-
-		data.networkAllowNativeLanguageTechtree = Shared::PlatformByteOrder::toCommonEndian(data.networkAllowNativeLanguageTechtree);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
 void NetworkMessageLaunch::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
-		for(int i= 0; i < GameConstants::maxPlayers; ++i){
-			data.networkPlayerStatuses[i] = Shared::PlatformByteOrder::fromCommonEndian(data.networkPlayerStatuses[i]);
-			data.factionCRCList[i] = Shared::PlatformByteOrder::fromCommonEndian(data.factionCRCList[i]);
-			data.factionControls[i] = Shared::PlatformByteOrder::fromCommonEndian(data.factionControls[i]);
-			data.resourceMultiplierIndex[i] = Shared::PlatformByteOrder::fromCommonEndian(data.resourceMultiplierIndex[i]);
-			data.teams[i] = Shared::PlatformByteOrder::fromCommonEndian(data.teams[i]);
-			data.startLocationIndex[i] = Shared::PlatformByteOrder::fromCommonEndian(data.startLocationIndex[i]);
-		}
-		data.mapFilter = Shared::PlatformByteOrder::fromCommonEndian(data.mapFilter);
-		data.mapCRC = Shared::PlatformByteOrder::fromCommonEndian(data.mapCRC);
-		data.tilesetCRC = Shared::PlatformByteOrder::fromCommonEndian(data.tilesetCRC);
-		data.techCRC = Shared::PlatformByteOrder::fromCommonEndian(data.techCRC);
-		data.thisFactionIndex = Shared::PlatformByteOrder::fromCommonEndian(data.thisFactionIndex);
-		data.factionCount = Shared::PlatformByteOrder::fromCommonEndian(data.factionCount);
-		data.defaultResources = Shared::PlatformByteOrder::fromCommonEndian(data.defaultResources);
-		data.defaultUnits = Shared::PlatformByteOrder::fromCommonEndian(data.defaultUnits);
-
-		data.defaultVictoryConditions = Shared::PlatformByteOrder::fromCommonEndian(data.defaultVictoryConditions);
-		data.fogOfWar = Shared::PlatformByteOrder::fromCommonEndian(data.fogOfWar);
-		data.allowObservers = Shared::PlatformByteOrder::fromCommonEndian(data.allowObservers);
-		data.enableObserverModeAtEndGame = Shared::PlatformByteOrder::fromCommonEndian(data.enableObserverModeAtEndGame);
-		data.enableServerControlledAI = Shared::PlatformByteOrder::fromCommonEndian(data.enableServerControlledAI);
-		data.networkFramePeriod = Shared::PlatformByteOrder::fromCommonEndian(data.networkFramePeriod);
-		data.networkPauseGameForLaggedClients = Shared::PlatformByteOrder::fromCommonEndian(data.networkPauseGameForLaggedClients);
-		data.pathFinderType = Shared::PlatformByteOrder::fromCommonEndian(data.pathFinderType);
-		data.flagTypes1 = Shared::PlatformByteOrder::fromCommonEndian(data.flagTypes1);
-
-		data.aiAcceptSwitchTeamPercentChance = Shared::PlatformByteOrder::fromCommonEndian(data.aiAcceptSwitchTeamPercentChance);
-		data.cpuReplacementMultiplier = Shared::PlatformByteOrder::fromCommonEndian(data.cpuReplacementMultiplier);
-		data.masterserver_admin = Shared::PlatformByteOrder::fromCommonEndian(data.masterserver_admin);
-		data.masterserver_admin_factionIndex = Shared::PlatformByteOrder::fromCommonEndian(data.masterserver_admin_factionIndex);
-
-		data.networkAllowNativeLanguageTechtree = Shared::PlatformByteOrder::fromCommonEndian(data.networkAllowNativeLanguageTechtree);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
@@ -1661,146 +1123,68 @@ bool NetworkMessageCommandList::addCommand(const NetworkCommand* networkCommand)
 	return true;
 }
 
-const char * NetworkMessageCommandList::getPackedMessageFormatHeader() const {
-	return "cHlLLLLLLLL";
+template<class Archive>
+void NetworkMessageCommandList::serializeHeaderFields(Archive &archive) {
+	archive & data.messageType & data.header.commandCount & data.header.frameCount;
+	for(int index = 0; index < GameConstants::maxPlayers; ++index) {
+		archive & data.header.networkPlayerFactionCRC[index];
+	}
+}
+
+template<class Archive>
+void NetworkMessageCommandList::serializeCommandFields(Archive &archive, NetworkCommand &command) {
+	archive & command.networkCommandType & command.unitId & command.unitTypeId
+		& command.commandTypeId & command.positionX & command.positionY
+		& command.targetId & command.wantQueue & command.fromFactionIndex
+		& command.unitFactionUnitCount & command.unitFactionIndex
+		& command.commandStateType & command.commandStateValue
+		& command.unitCommandGroupId;
 }
 
 unsigned int NetworkMessageCommandList::getPackedSizeHeader() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		init(packedData);
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormatHeader(),
-				packedData.messageType,
-				packedData.header.commandCount,
-				packedData.header.frameCount,
-				packedData.header.networkPlayerFactionCRC[0],
-				packedData.header.networkPlayerFactionCRC[1],
-				packedData.header.networkPlayerFactionCRC[2],
-				packedData.header.networkPlayerFactionCRC[3],
-				packedData.header.networkPlayerFactionCRC[4],
-				packedData.header.networkPlayerFactionCRC[5],
-				packedData.header.networkPlayerFactionCRC[6],
-				packedData.header.networkPlayerFactionCRC[7]);
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeHeaderFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageCommandList::unpackMessageHeader(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormatHeader(),
-			&data.messageType,
-			&data.header.commandCount,
-			&data.header.frameCount,
-			&data.header.networkPlayerFactionCRC[0],
-			&data.header.networkPlayerFactionCRC[1],
-			&data.header.networkPlayerFactionCRC[2],
-			&data.header.networkPlayerFactionCRC[3],
-			&data.header.networkPlayerFactionCRC[4],
-			&data.header.networkPlayerFactionCRC[5],
-			&data.header.networkPlayerFactionCRC[6],
-			&data.header.networkPlayerFactionCRC[7]);
+	PackedFieldReader reader(buf);
+	serializeHeaderFields(reader);
 }
 
 unsigned char * NetworkMessageCommandList::packMessageHeader() {
 	unsigned char *buf = new unsigned char[getPackedSizeHeader()+1];
-	pack(buf, getPackedMessageFormatHeader(),
-			data.messageType,
-			data.header.commandCount,
-			data.header.frameCount,
-			data.header.networkPlayerFactionCRC[0],
-			data.header.networkPlayerFactionCRC[1],
-			data.header.networkPlayerFactionCRC[2],
-			data.header.networkPlayerFactionCRC[3],
-			data.header.networkPlayerFactionCRC[4],
-			data.header.networkPlayerFactionCRC[5],
-			data.header.networkPlayerFactionCRC[6],
-			data.header.networkPlayerFactionCRC[7]);
+	PackedFieldWriter writer(buf);
+	serializeHeaderFields(writer);
 	return buf;
 }
 
-const char * NetworkMessageCommandList::getPackedMessageFormatDetail() const {
-	return "hlhhhhlccHccll";
-}
-
 unsigned int NetworkMessageCommandList::getPackedSizeDetail(int count) {
-	unsigned int result = 0;
-	//if(result == 0) {
-		for(unsigned int i = 0; i < (unsigned int)count; ++i) {
-			NetworkCommand packedData;
-			unsigned char *buf = new unsigned char[sizeof(NetworkCommand)*3];
-			result += pack(buf, getPackedMessageFormatDetail(),
-					packedData.networkCommandType,
-					packedData.unitId,
-					packedData.unitTypeId,
-					packedData.commandTypeId,
-					packedData.positionX,
-					packedData.positionY,
-					packedData.targetId,
-					packedData.wantQueue,
-					packedData.fromFactionIndex,
-					packedData.unitFactionUnitCount,
-					packedData.unitFactionIndex,
-					packedData.commandStateType,
-					packedData.commandStateValue,
-					packedData.unitCommandGroupId);
-			delete [] buf;
-		}
-	//}
-	return result;
+	// every command has the same packed size
+	static unsigned int commandSize = 0;
+	if(commandSize == 0) {
+		NetworkCommand packedData;
+		PackedFieldSizer sizer;
+		serializeCommandFields(sizer, packedData);
+		commandSize = sizer.getSize();
+	}
+	return commandSize * count;
 }
 void NetworkMessageCommandList::unpackMessageDetail(unsigned char *buf,int count) {
 	data.commands.clear();
 	data.commands.resize(count);
-	//unsigned int bytes_processed_total = 0;
-	unsigned char *bufMove = buf;
+	PackedFieldReader reader(buf);
 	for(unsigned int i = 0; i < (unsigned int)count; ++i) {
-		unsigned int bytes_processed = unpack(bufMove, getPackedMessageFormatDetail(),
-				&data.commands[i].networkCommandType,
-				&data.commands[i].unitId,
-				&data.commands[i].unitTypeId,
-				&data.commands[i].commandTypeId,
-				&data.commands[i].positionX,
-				&data.commands[i].positionY,
-				&data.commands[i].targetId,
-				&data.commands[i].wantQueue,
-				&data.commands[i].fromFactionIndex,
-				&data.commands[i].unitFactionUnitCount,
-				&data.commands[i].unitFactionIndex,
-				&data.commands[i].commandStateType,
-				&data.commands[i].commandStateValue,
-				&data.commands[i].unitCommandGroupId);
-		bufMove += bytes_processed;
-		//bytes_processed_total += bytes_processed;
-	}
-	//printf("\nUnPacked detail size = %u\n",bytes_processed_total);
+		serializeCommandFields(reader, data.commands[i]);
+	}
 }
 
 unsigned char * NetworkMessageCommandList::packMessageDetail(uint16 totalCommand) {
 	int packetSize = getPackedSizeDetail(totalCommand) +1;
 	unsigned char *buf = new unsigned char[packetSize];
-	unsigned char *bufMove = buf;
-	//unsigned int bytes_processed_total = 0;
+	PackedFieldWriter writer(buf);
 	for(unsigned int i = 0; i < totalCommand; ++i) {
-		unsigned int bytes_processed = pack(bufMove, getPackedMessageFormatDetail(),
-				data.commands[i].networkCommandType,
-				data.commands[i].unitId,
-				data.commands[i].unitTypeId,
-				data.commands[i].commandTypeId,
-				data.commands[i].positionX,
-				data.commands[i].positionY,
-				data.commands[i].targetId,
-				data.commands[i].wantQueue,
-				data.commands[i].fromFactionIndex,
-				data.commands[i].unitFactionUnitCount,
-				data.commands[i].unitFactionIndex,
-				data.commands[i].commandStateType,
-				data.commands[i].commandStateValue,
-				data.commands[i].unitCommandGroupId);
-		bufMove += bytes_processed;
-		//bytes_processed_total += bytes_processed;
-	}
-	//printf("\nPacked detail size = %u, allocated = %d\n",bytes_processed_total,packetSize);
+		serializeCommandFields(writer, data.commands[i]);
+	}
 	return buf;
 }
 
@@ -1814,6 +1198,7 @@ bool NetworkMessageCommandList::receive(Socket* socket) {
 		if(result == true) {
 			data.messageType = this->getNetworkMessageType();
 		}
+		fromEndianHeader();
 
 		//printf("!!! =====> IN Network hdr cmd get frame: %d data.header.commandCount: %u\n",data.header.frameCount,data.header.commandCount);
 	}
@@ -1824,7 +1209,6 @@ bool NetworkMessageCommandList::receive(Socket* socket) {
 		//if(data.header.commandCount) printf("\n\nGot packet size = %u data.messageType = %d\n%s\ncommandcount [%u] framecount [%d]\n",getPackedSizeHeader(),data.header.messageType,buf,data.header.commandCount,data.header.frameCount);
 		delete [] buf;
 	}
-	fromEndianHeader();
 
 	if(result == true) {
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] got header, messageType = %d, commandCount = %u, frameCount = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,data.messageType,data.header.commandCount,data.header.frameCount);
@@ -1837,6 +1221,7 @@ bool NetworkMessageCommandList::receive(Socket* socket) {
 			if(useOldProtocol == true) {
 				int totalMsgSize = (sizeof(NetworkCommand) * data.header.commandCount);
 				result = NetworkMessage::receive(socket, &data.commands[0], totalMsgSize, true);
+				fromEndianDetail();
 
 //				if(data.commands[0].getNetworkCommandType() == nctPauseResume) {
 //					printf("=====> IN Network cmd type: %d [%d] frame: %d\n",data.commands[0].getNetworkCommandType(),nctPauseResume,data.header.frameCount);
@@ -1851,7 +1236,6 @@ bool NetworkMessageCommandList::receive(Socket* socket) {
 				//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 				delete [] buf;
 			}
-			fromEndianDetail();
 
 //	        for(int idx = 0 ; idx < data.header.commandCount; ++idx) {
 //	            const NetworkCommand &cmd = data.commands[idx];
@@ -1898,23 +1282,21 @@ void NetworkMessageCommandList::send(Socket* socket) {
 
 	assert(data.messageType == nmtCommandList);
 	uint16 totalCommand = data.header.commandCount;
-	toEndianHeader();
-	toEndianDetail(totalCommand);
-
 	unsigned char *buf = NULL;
 	//bool result = false;
 	if(useOldProtocol == true) {
+		toEndianHeader();
+		toEndianDetail(totalCommand);
+
 		//printf("<===== OUT Network hdr cmd type: frame: %d totalCommand: %u [%u]\n",data.header.frameCount,totalCommand,data.header.commandCount);
 		//NetworkMessage::send(socket, &data.messageType, sizeof(data.messageType));
 
 		//NetworkMessage::send(socket, &data.header, commandListHeaderSize, data.messageType);
-		unsigned char *send_buffer = getData();
-		int headerSize = sizeof(data.header);
-		uint16 totalCommand = data.header.commandCount;
-		int detailSize = (sizeof(NetworkCommand) * totalCommand);
-		int fullBufferSize = headerSize + detailSize;
-		NetworkMessage::send(socket, send_buffer, fullBufferSize, data.messageType);
-		delete [] send_buffer;
+		// Type, header and commands go out straight from the message
+		const void *parts[] 	= { &data.messageType, &data.header, (totalCommand > 0 ? &data.commands[0] : NULL) };
+		const int partSizes[] 	= { (int)sizeof(data.messageType), (int)sizeof(data.header),
+									(int)(sizeof(NetworkCommand) * totalCommand) };
+		NetworkMessage::send(socket, parts, partSizes, (totalCommand > 0 ? 3 : 2));
 	}
 	else {
 		//NetworkMessage::send(socket, &data.header, commandListHeaderSize);
@@ -1969,26 +1351,166 @@ void NetworkMessageCommandList::send(Socket* socket) {
 	}
 }
 
+static const uint32 maxCompactCommandListSize = 1024 * 1024;
+
+void NetworkMessageCommandList::sendCompact(Socket* socket, NetworkCommandListFrameState &frameState) {
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtCommandListCompact, frameCount = %d, data.header.commandCount = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,data.header.frameCount,data.header.commandCount);
+
+	int32 frameStep = data.header.frameCount - frameState.lastFrameCount;
+	uint32 crcMask = 0;
+	for(int index = 0; index < GameConstants::maxPlayers; ++index) {
+		if(data.header.networkPlayerFactionCRC[index] != 0) {
+			crcMask |= (1u << index);
+		}
+	}
+	frameState.lastFrameCount = data.header.frameCount;
+
+	if(data.header.commandCount == 0 && crcMask == 0 && frameStep == frameState.lastFrameStep) {
+		int8 messageType = nmtCommandListHeartbeat;
+		NetworkMessage::send(socket, &messageType, sizeof(messageType));
+		return;
+	}
+	frameState.lastFrameStep = frameStep;
+
+	// unit ids and positions are stored relative to the previous command,
+	// commands of one selection are next to each other in the list
+	VarintWriter payload;
+	payload.writeInt(frameStep);
+	payload.writeUInt(crcMask);
+	for(int index = 0; index < GameConstants::maxPlayers; ++index) {
+		if((crcMask & (1u << index)) != 0) {
+			payload.writeFixedUInt(data.header.networkPlayerFactionCRC[index]);
+		}
+	}
+	payload.writeUInt(data.header.commandCount);
+
+	NetworkCommand previous;
+	for(int index = 0; index < data.header.commandCount; ++index) {
+		const NetworkCommand &cmd = data.commands[index];
+		payload.writeInt(cmd.networkCommandType);
+		payload.writeInt((int32)((uint32)cmd.unitId - (uint32)previous.unitId));
+		payload.writeInt(cmd.unitTypeId);
+		payload.writeInt(cmd.commandTypeId);
+		payload.writeInt(cmd.positionX - previous.positionX);
+		payload.writeInt(cmd.positionY - previous.positionY);
+		payload.writeInt(cmd.targetId);
+		payload.writeInt(cmd.wantQueue);
+		payload.writeInt(cmd.fromFactionIndex);
+		payload.writeUInt(cmd.unitFactionUnitCount);
+		payload.writeInt(cmd.unitFactionIndex);
+		payload.writeInt(cmd.commandStateType);
+		payload.writeInt(cmd.commandStateValue);
+		payload.writeInt(cmd.unitCommandGroupId);
+		previous = cmd;
+	}
+
+	// the payload size comes first so the receiver can read it in one call
+	VarintWriter message;
+	message.writeUInt(payload.getSize());
+	std::vector<unsigned char> buffer = message.getBuffer();
+	buffer.insert(buffer.end(),payload.getBuffer().begin(),payload.getBuffer().end());
+	NetworkMessage::send(socket, &buffer[0], (int)buffer.size(), (int8)nmtCommandListCompact);
+}
+
+bool NetworkMessageCommandList::receiveCompact(Socket* socket, NetworkMessageType type, NetworkCommandListFrameState &frameState) {
+	init(data);
+	data.messageType = nmtCommandList;
+	data.commands.clear();
+
+	if(type == nmtCommandListHeartbeat) {
+		data.header.frameCount = frameState.lastFrameCount + frameState.lastFrameStep;
+		frameState.lastFrameCount = data.header.frameCount;
+		return true;
+	}
+	if(type != nmtCommandListCompact) {
+		return receive(socket);
+	}
+
+	uint32 payloadSize = 0;
+	for(int shift = 0;; shift += 7) {
+		unsigned char value = 0;
+		if(shift >= 35 || NetworkMessage::receive(socket, &value, sizeof(value), true) == false) {
+			return false;
+		}
+		payloadSize |= (uint32)(value & 0x7F) << shift;
+		if((value & 0x80) == 0) {
+			break;
+		}
+	}
+	if(payloadSize == 0 || payloadSize > maxCompactCommandListSize) {
+		throw megaglest_runtime_error("Invalid compact command list size: " + uIntToStr(payloadSize));
+	}
+
+	std::vector<unsigned char> payload(payloadSize);
+	if(NetworkMessage::receive(socket, &payload[0], payloadSize, true) == false) {
+		return false;
+	}
+
+	VarintReader reader(&payload[0], payloadSize);
+	int32 frameStep = reader.readInt();
+	uint32 crcMask = reader.readUInt();
+	for(int index = 0; index < GameConstants::maxPlayers; ++index) {
+		if((crcMask & (1u << index)) != 0) {
+			data.header.networkPlayerFactionCRC[index] = reader.readFixedUInt();
+		}
+	}
+	uint32 commandCount = reader.readUInt();
+	if(commandCount > payloadSize || commandCount > 0xFFFF) {
+		throw megaglest_runtime_error("Invalid compact command list command count: " + uIntToStr(commandCount));
+	}
+
+	data.commands.resize(commandCount);
+	NetworkCommand previous;
+	for(unsigned int index = 0; index < commandCount; ++index) {
+		NetworkCommand &cmd = data.commands[index];
+		cmd.networkCommandType = reader.readInt();
+		cmd.unitId = (int32)((uint32)previous.unitId + (uint32)reader.readInt());
+		cmd.unitTypeId = reader.readInt();
+		cmd.commandTypeId = reader.readInt();
+		cmd.positionX = previous.positionX + reader.readInt();
+		cmd.positionY = previous.positionY + reader.readInt();
+		cmd.targetId = reader.readInt();
+		cmd.wantQueue = reader.readInt();
+		cmd.fromFactionIndex = reader.readInt();
+		cmd.unitFactionUnitCount = reader.readUInt();
+		cmd.unitFactionIndex = reader.readInt();
+		cmd.commandStateType = reader.readInt();
+		cmd.commandStateValue = reader.readInt();
+		cmd.unitCommandGroupId = reader.readInt();
+		previous = cmd;
+	}
+	if(reader.hasFailed() == true || reader.isAtEnd() == false) {
+		throw megaglest_runtime_error("Invalid compact command list received, size = " + uIntToStr(payloadSize));
+	}
+
+	data.header.commandCount = commandCount;
+	data.header.frameCount = frameState.lastFrameCount + frameStep;
+	frameState.lastFrameCount = data.header.frameCount;
+	frameState.lastFrameStep = frameStep;
+
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled == true) {
+		for(int idx = 0 ; idx < data.header.commandCount; ++idx) {
+			const NetworkCommand &cmd = data.commands[idx];
+
+			SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] index = %d, received compact networkCommand [%s]\n",
+					extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,idx, cmd.toString().c_str());
+		}
+	}
+	return true;
+}
+
 void NetworkMessageCommandList::toEndianHeader() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		data.messageType = Shared::PlatformByteOrder::toCommonEndian(data.messageType);
-		data.header.commandCount = Shared::PlatformByteOrder::toCommonEndian(data.header.commandCount);
-		data.header.frameCount = Shared::PlatformByteOrder::toCommonEndian(data.header.frameCount);
-		for(int index = 0; index < GameConstants::maxPlayers; ++index) {
-			data.header.networkPlayerFactionCRC[index] = Shared::PlatformByteOrder::toCommonEndian(data.header.networkPlayerFactionCRC[index]);
-		}
+		PackedFieldToCommonEndian archive;
+		serializeHeaderFields(archive);
 	}
 }
 void NetworkMessageCommandList::fromEndianHeader() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		data.messageType = Shared::PlatformByteOrder::fromCommonEndian(data.messageType);
-		data.header.commandCount = Shared::PlatformByteOrder::fromCommonEndian(data.header.commandCount);
-		data.header.frameCount = Shared::PlatformByteOrder::fromCommonEndian(data.header.frameCount);
-		for(int index = 0; index < GameConstants::maxPlayers; ++index) {
-			data.header.networkPlayerFactionCRC[index] = Shared::PlatformByteOrder::fromCommonEndian(data.header.networkPlayerFactionCRC[index]);
-		}
+		PackedFieldFromCommonEndian archive;
+		serializeHeaderFields(archive);
 	}
 }
 
@@ -2042,45 +1564,26 @@ NetworkMessageText * NetworkMessageText::getCopy() const {
 	return copy;
 }
 
-const char * NetworkMessageText::getPackedMessageFormat() const {
-	return "c500scc60s";
+template<class Archive>
+void NetworkMessageText::serializeFields(Archive &archive) {
+	archive & messageType & packedString(data.text) & data.teamIndex & data.playerIndex
+		& packedString(data.targetLanguage);
 }
 
 unsigned int NetworkMessageText::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		messageType = nmtText;
-		packedData.playerIndex = 0;
-		packedData.teamIndex = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.text.getBuffer(),
-				packedData.teamIndex,
-				packedData.playerIndex,
-				packedData.targetLanguage.getBuffer());
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageText::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			data.text.getBuffer(),
-			&data.teamIndex,
-			&data.playerIndex,
-			data.targetLanguage.getBuffer());
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 }
 
 unsigned char * NetworkMessageText::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.text.getBuffer(),
-			data.teamIndex,
-			data.playerIndex,
-			data.targetLanguage.getBuffer());
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
@@ -2091,6 +1594,7 @@ bool NetworkMessageText::receive(Socket* socket) {
 		if(result == true) {
 			messageType = this->getNetworkMessageType();
 		}
+		fromEndian();
 	}
 	else {
 		unsigned char *buf = new unsigned char[getPackedSize()+1];
@@ -2099,7 +1603,6 @@ bool NetworkMessageText::receive(Socket* socket) {
 		//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 		delete [] buf;
 	}
-	fromEndian();
 
 	data.text.nullTerminate();
 	data.targetLanguage.nullTerminate();
@@ -2111,9 +1614,8 @@ void NetworkMessageText::send(Socket* socket) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtText\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	assert(messageType == nmtText);
-	toEndian();
-
 	if(useOldProtocol == true) {
+		toEndian();
 		//NetworkMessage::send(socket, &messageType, sizeof(messageType));
 		NetworkMessage::send(socket, &data, sizeof(data), messageType);
 	}
@@ -2128,17 +1630,15 @@ void NetworkMessageText::send(Socket* socket) {
 void NetworkMessageText::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
-		data.teamIndex = Shared::PlatformByteOrder::toCommonEndian(data.teamIndex);
-		data.playerIndex = Shared::PlatformByteOrder::toCommonEndian(data.playerIndex);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 void NetworkMessageText::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::fromCommonEndian(messageType);
-		data.teamIndex = Shared::PlatformByteOrder::fromCommonEndian(data.teamIndex);
-		data.playerIndex = Shared::PlatformByteOrder::fromCommonEndian(data.playerIndex);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
@@ -2150,31 +1650,25 @@ NetworkMessageQuit::NetworkMessageQuit(){
 	messageType = nmtQuit;
 }
 
-const char * NetworkMessageQuit::getPackedMessageFormat() const {
-	return "c";
+template<class Archive>
+void NetworkMessageQuit::serializeFields(Archive &archive) {
+	archive & messageType;
 }
 
 unsigned int NetworkMessageQuit::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		//Data packedData;
-		messageType = 0;
-		unsigned char *buf = new unsigned char[sizeof(messageType)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType);
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageQuit::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType);
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 }
 
 unsigned char * NetworkMessageQuit::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType);
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
@@ -2182,6 +1676,7 @@ bool NetworkMessageQuit::receive(Socket* socket) {
 	bool result = false;
 	if(useOldProtocol == true) {
 		result = NetworkMessage::receive(socket, &messageType, sizeof(messageType),true);
+		fromEndian();
 	}
 	else {
 		//fromEndian();
@@ -2191,7 +1686,6 @@ bool NetworkMessageQuit::receive(Socket* socket) {
 		//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 		delete [] buf;
 	}
-	fromEndian();
 
 	return result;
 }
@@ -2200,9 +1694,8 @@ void NetworkMessageQuit::send(Socket* socket) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtQuit\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	assert(messageType == nmtQuit);
-	toEndian();
-
 	if(useOldProtocol == true) {
+		toEndian();
 		NetworkMessage::send(socket, &messageType, sizeof(messageType));
 	}
 	else {
@@ -2216,13 +1709,15 @@ void NetworkMessageQuit::send(Socket* socket) {
 void NetworkMessageQuit::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 void NetworkMessageQuit::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::fromCommonEndian(messageType);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
@@ -2341,107 +1836,55 @@ string NetworkMessageSynchNetworkGameData::getTechCRCFileMismatchReport(vector<s
 	return result;
 }
 
-const char * NetworkMessageSynchNetworkGameData::getPackedMessageFormatHeader() const {
-	return "c255s255s255sLLLL";
+template<class Archive>
+void NetworkMessageSynchNetworkGameData::serializeHeaderFields(Archive &archive) {
+	archive & data.messageType
+		& packedString(data.header.map) & packedString(data.header.tileset)
+		& packedString(data.header.tech) & data.header.mapCRC
+		& data.header.tilesetCRC & data.header.techCRC & data.header.techCRCFileCount;
 }
 
-unsigned int NetworkMessageSynchNetworkGameData::getPackedSizeHeader() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		packedData.messageType=0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormatHeader(),
-				packedData.messageType,
-				packedData.header.map.getBuffer(),
-				packedData.header.tileset.getBuffer(),
-				packedData.header.tech.getBuffer(),
-				packedData.header.mapCRC,
-				packedData.header.tilesetCRC,
-				packedData.header.techCRC,
-				packedData.header.techCRCFileCount);
-		delete [] buf;
+template<class Archive>
+void NetworkMessageSynchNetworkGameData::serializeDetailFields(Archive &archive) {
+	for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
+		archive & packedString(data.detail.techCRCFileList[i]);
+	}
+	for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
+		archive & data.detail.techCRCFileCRCList[i];
 	}
-	return result;
+}
+
+unsigned int NetworkMessageSynchNetworkGameData::getPackedSizeHeader() {
+	PackedFieldSizer sizer;
+	serializeHeaderFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageSynchNetworkGameData::unpackMessageHeader(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormatHeader(),
-			&data.messageType,
-			data.header.map.getBuffer(),
-			data.header.tileset.getBuffer(),
-			data.header.tech.getBuffer(),
-			&data.header.mapCRC,
-			&data.header.tilesetCRC,
-			&data.header.techCRC,
-			&data.header.techCRCFileCount);
+	PackedFieldReader reader(buf);
+	serializeHeaderFields(reader);
 }
 
 unsigned char * NetworkMessageSynchNetworkGameData::packMessageHeader() {
 	unsigned char *buf = new unsigned char[getPackedSizeHeader()+1];
-	pack(buf, getPackedMessageFormatHeader(),
-			data.messageType,
-			data.header.map.getBuffer(),
-			data.header.tileset.getBuffer(),
-			data.header.tech.getBuffer(),
-			data.header.mapCRC,
-			data.header.tilesetCRC,
-			data.header.techCRC,
-			data.header.techCRCFileCount);
-
+	PackedFieldWriter writer(buf);
+	serializeHeaderFields(writer);
 	return buf;
 }
 
 unsigned int NetworkMessageSynchNetworkGameData::getPackedSizeDetail() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		DataDetail packedData;
-		for(unsigned int index = 0; index < (unsigned int)maxFileCRCCount; ++index) {
-			packedData.techCRCFileCRCList[index] = 0;
-		}
-		unsigned char *buf = new unsigned char[sizeof(DataDetail)*3];
-
-		for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
-			result += pack(buf, "255s",
-					packedData.techCRCFileList[i].getBuffer());
-			buf += result;
-		}
-		for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
-			result += pack(buf, "L",
-					packedData.techCRCFileCRCList[i]);
-			buf += result;
-		}
-
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeDetailFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageSynchNetworkGameData::unpackMessageDetail(unsigned char *buf) {
-	for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
-		unsigned int bytes_processed = unpack(buf, "255s",
-				data.detail.techCRCFileList[i].getBuffer());
-		buf += bytes_processed;
-	}
-	for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
-		unsigned int bytes_processed = unpack(buf, "L",
-				&data.detail.techCRCFileCRCList[i]);
-		buf += bytes_processed;
-	}
+	PackedFieldReader reader(buf);
+	serializeDetailFields(reader);
 }
 
 unsigned char * NetworkMessageSynchNetworkGameData::packMessageDetail() {
-	unsigned char *buf = new unsigned char[sizeof(DataDetail)*3 +1];
-	unsigned char *bufMove = buf;
-	for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
-		unsigned int bytes_processed = pack(bufMove, "255s",
-				data.detail.techCRCFileList[i].getBuffer());
-		bufMove += bytes_processed;
-	}
-	for(unsigned int i = 0; i < (unsigned int)maxFileCRCCount; ++i) {
-		unsigned int bytes_processed = pack(bufMove, "L",
-				data.detail.techCRCFileCRCList[i]);
-		bufMove += bytes_processed;
-	}
-
+	unsigned char *buf = new unsigned char[getPackedSizeDetail()+1];
+	PackedFieldWriter writer(buf);
+	serializeDetailFields(writer);
 	return buf;
 }
 
@@ -2537,21 +1980,15 @@ void NetworkMessageSynchNetworkGameData::send(Socket* socket) {
 void NetworkMessageSynchNetworkGameData::toEndianHeader() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		data.messageType = Shared::PlatformByteOrder::toCommonEndian(data.messageType);
-		data.header.mapCRC = Shared::PlatformByteOrder::toCommonEndian(data.header.mapCRC);
-		data.header.tilesetCRC = Shared::PlatformByteOrder::toCommonEndian(data.header.tilesetCRC);
-		data.header.techCRC = Shared::PlatformByteOrder::toCommonEndian(data.header.techCRC);
-		data.header.techCRCFileCount = Shared::PlatformByteOrder::toCommonEndian(data.header.techCRCFileCount);
+		PackedFieldToCommonEndian archive;
+		serializeHeaderFields(archive);
 	}
 }
 void NetworkMessageSynchNetworkGameData::fromEndianHeader() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		data.messageType = Shared::PlatformByteOrder::fromCommonEndian(data.messageType);
-		data.header.mapCRC = Shared::PlatformByteOrder::fromCommonEndian(data.header.mapCRC);
-		data.header.tilesetCRC = Shared::PlatformByteOrder::fromCommonEndian(data.header.tilesetCRC);
-		data.header.techCRC = Shared::PlatformByteOrder::fromCommonEndian(data.header.techCRC);
-		data.header.techCRCFileCount = Shared::PlatformByteOrder::fromCommonEndian(data.header.techCRCFileCount);
+		PackedFieldFromCommonEndian archive;
+		serializeHeaderFields(archive);
 	}
 }
 
@@ -2786,47 +2223,26 @@ NetworkMessageSynchNetworkGameDataFileCRCCheck::NetworkMessageSynchNetworkGameDa
     data.fileName       = fileName;
 }
 
-const char * NetworkMessageSynchNetworkGameDataFileCRCCheck::getPackedMessageFormat() const {
-	return "cLLL256s";
+template<class Archive>
+void NetworkMessageSynchNetworkGameDataFileCRCCheck::serializeFields(Archive &archive) {
+	archive & messageType & data.totalFileCount & data.fileIndex & data.fileCRC
+		& packedString(data.fileName);
 }
 
 unsigned int NetworkMessageSynchNetworkGameDataFileCRCCheck::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		packedData.fileCRC = 0;
-		packedData.fileIndex = 0;
-		messageType = nmtSynchNetworkGameDataFileCRCCheck;
-		packedData.totalFileCount = 0;
-
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.totalFileCount,
-				packedData.fileIndex,
-				packedData.fileCRC,
-				packedData.fileName.getBuffer());
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageSynchNetworkGameDataFileCRCCheck::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.totalFileCount,
-			&data.fileIndex,
-			&data.fileCRC,
-			data.fileName.getBuffer());
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 }
 
 unsigned char * NetworkMessageSynchNetworkGameDataFileCRCCheck::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.totalFileCount,
-			data.fileIndex,
-			data.fileCRC,
-			data.fileName.getBuffer());
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
@@ -2834,6 +2250,7 @@ bool NetworkMessageSynchNetworkGameDataFileCRCCheck::receive(Socket* socket) {
 	bool result = false;
 	if(useOldProtocol == true) {
 		result = NetworkMessage::receive(socket, &data, sizeof(data),true);
+		fromEndian();
 	}
 	else {
 		unsigned char *buf = new unsigned char[getPackedSize()+1];
@@ -2842,7 +2259,6 @@ bool NetworkMessageSynchNetworkGameDataFileCRCCheck::receive(Socket* socket) {
 		//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 		delete [] buf;
 	}
-	fromEndian();
 	data.fileName.nullTerminate();
 
 	return result;
@@ -2852,9 +2268,8 @@ void NetworkMessageSynchNetworkGameDataFileCRCCheck::send(Socket* socket) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtSynchNetworkGameDataFileCRCCheck\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	assert(messageType == nmtSynchNetworkGameDataFileCRCCheck);
-	toEndian();
-
 	if(useOldProtocol == true) {
+		toEndian();
 		//NetworkMessage::send(socket, &messageType, sizeof(messageType));
 		NetworkMessage::send(socket, &data, sizeof(data), messageType);
 	}
@@ -2869,20 +2284,16 @@ void NetworkMessageSynchNetworkGameDataFileCRCCheck::send(Socket* socket) {
 void NetworkMessageSynchNetworkGameDataFileCRCCheck::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
-		data.totalFileCount = Shared::PlatformByteOrder::toCommonEndian(data.totalFileCount);
-		data.fileIndex = Shared::PlatformByteOrder::toCommonEndian(data.fileIndex);
-		data.fileCRC = Shared::PlatformByteOrder::toCommonEndian(data.fileCRC);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
 void NetworkMessageSynchNetworkGameDataFileCRCCheck::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::fromCommonEndian(messageType);
-		data.totalFileCount = Shared::PlatformByteOrder::fromCommonEndian(data.totalFileCount);
-		data.fileIndex = Shared::PlatformByteOrder::fromCommonEndian(data.fileIndex);
-		data.fileCRC = Shared::PlatformByteOrder::fromCommonEndian(data.fileCRC);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 // =====================================================
@@ -2896,34 +2307,25 @@ NetworkMessageSynchNetworkGameDataFileGet::NetworkMessageSynchNetworkGameDataFil
     data.fileName       = fileName;
 }
 
-const char * NetworkMessageSynchNetworkGameDataFileGet::getPackedMessageFormat() const {
-	return "c256s";
+template<class Archive>
+void NetworkMessageSynchNetworkGameDataFileGet::serializeFields(Archive &archive) {
+	archive & messageType & packedString(data.fileName);
 }
 
 unsigned int NetworkMessageSynchNetworkGameDataFileGet::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		messageType = nmtSynchNetworkGameDataFileGet;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.fileName.getBuffer());
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageSynchNetworkGameDataFileGet::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			data.fileName.getBuffer());
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 }
 
 unsigned char * NetworkMessageSynchNetworkGameDataFileGet::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.fileName.getBuffer());
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
@@ -2931,6 +2333,7 @@ bool NetworkMessageSynchNetworkGameDataFileGet::receive(Socket* socket) {
 	bool result = false;
 	if(useOldProtocol == true) {
 		result = NetworkMessage::receive(socket, &data, sizeof(data),true);
+		fromEndian();
 	}
 	else {
 		unsigned char *buf = new unsigned char[getPackedSize()+1];
@@ -2939,7 +2342,6 @@ bool NetworkMessageSynchNetworkGameDataFileGet::receive(Socket* socket) {
 		//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 		delete [] buf;
 	}
-	fromEndian();
 	data.fileName.nullTerminate();
 
 	return result;
@@ -2949,8 +2351,8 @@ void NetworkMessageSynchNetworkGameDataFileGet::send(Socket* socket) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtSynchNetworkGameDataFileGet\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	assert(messageType == nmtSynchNetworkGameDataFileGet);
-	toEndian();
 	if(useOldProtocol == true) {
+		toEndian();
 		//NetworkMessage::send(socket, &messageType, sizeof(messageType));
 		NetworkMessage::send(socket, &data, sizeof(data), messageType);
 	}
@@ -2965,13 +2367,15 @@ void NetworkMessageSynchNetworkGameDataFileGet::send(Socket* socket) {
 void NetworkMessageSynchNetworkGameDataFileGet::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 void NetworkMessageSynchNetworkGameDataFileGet::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::fromCommonEndian(messageType);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
@@ -3007,61 +2411,27 @@ SwitchSetupRequest::SwitchSetupRequest(string selectedFactionName, int8 currentF
     data.language = language;
 }
 
-const char * SwitchSetupRequest::getPackedMessageFormat() const {
-	return "c256sccc80scc60s";
+template<class Archive>
+void SwitchSetupRequest::serializeFields(Archive &archive) {
+	archive & messageType & packedString(data.selectedFactionName) & data.currentSlotIndex
+		& data.toSlotIndex & data.toTeam & packedString(data.networkPlayerName)
+		& data.networkPlayerStatus & data.switchFlags & packedString(data.language);
 }
 
 unsigned int SwitchSetupRequest::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		packedData.currentSlotIndex = 0;
-		messageType = nmtSwitchSetupRequest;
-		packedData.networkPlayerStatus = 0;
-		packedData.switchFlags = 0;
-		packedData.toSlotIndex = 0;
-		packedData.toTeam = 0;
-
-		unsigned char *buf = new unsigned char[sizeof(Data)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.selectedFactionName.getBuffer(),
-				packedData.currentSlotIndex,
-				packedData.toSlotIndex,
-				packedData.toTeam,
-				packedData.networkPlayerName.getBuffer(),
-				packedData.networkPlayerStatus,
-				packedData.switchFlags,
-				packedData.language.getBuffer());
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void SwitchSetupRequest::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			data.selectedFactionName.getBuffer(),
-			&data.currentSlotIndex,
-			&data.toSlotIndex,
-			&data.toTeam,
-			data.networkPlayerName.getBuffer(),
-			&data.networkPlayerStatus,
-			&data.switchFlags,
-			data.language.getBuffer());
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 }
 
 unsigned char * SwitchSetupRequest::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.selectedFactionName.getBuffer(),
-			data.currentSlotIndex,
-			data.toSlotIndex,
-			data.toTeam,
-			data.networkPlayerName.getBuffer(),
-			data.networkPlayerStatus,
-			data.switchFlags,
-			data.language.getBuffer());
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
@@ -3074,6 +2444,7 @@ bool SwitchSetupRequest::receive(Socket* socket) {
 			messageType = nmtSwitchSetupRequest;
 		}
 
+		fromEndian();
 	}
 	else {
 		//fromEndian();
@@ -3083,7 +2454,6 @@ bool SwitchSetupRequest::receive(Socket* socket) {
 		//printf("Got packet size = %u data.messageType = %d\n%s\nTeam = %d faction [%s] currentFactionIndex = %d toFactionIndex = %d\n",getPackedSize(),data.messageType,buf,data.toTeam,data.selectedFactionName.getBuffer(),data.currentFactionIndex,data.toFactionIndex);
 		delete [] buf;
 	}
-	fromEndian();
 
 	data.selectedFactionName.nullTerminate();
 	data.networkPlayerName.nullTerminate();
@@ -3098,9 +2468,8 @@ void SwitchSetupRequest::send(Socket* socket) {
 	assert(messageType == nmtSwitchSetupRequest);
 
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line %d] data.networkPlayerName [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,data.networkPlayerName.getString().c_str());
-	toEndian();
-
 	if(useOldProtocol == true) {
+		toEndian();
 		//NetworkMessage::send(socket, &messageType, sizeof(messageType));
 		NetworkMessage::send(socket, &data, sizeof(data), messageType);
 	}
@@ -3115,23 +2484,15 @@ void SwitchSetupRequest::send(Socket* socket) {
 void SwitchSetupRequest::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
-		data.currentSlotIndex = Shared::PlatformByteOrder::toCommonEndian(data.currentSlotIndex);
-		data.toSlotIndex = Shared::PlatformByteOrder::toCommonEndian(data.toSlotIndex);
-		data.toTeam = Shared::PlatformByteOrder::toCommonEndian(data.toTeam);
-		data.networkPlayerStatus = Shared::PlatformByteOrder::toCommonEndian(data.networkPlayerStatus);
-		data.switchFlags = Shared::PlatformByteOrder::toCommonEndian(data.switchFlags);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 void SwitchSetupRequest::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::fromCommonEndian(messageType);
-		data.currentSlotIndex = Shared::PlatformByteOrder::fromCommonEndian(data.currentSlotIndex);
-		data.toSlotIndex = Shared::PlatformByteOrder::fromCommonEndian(data.toSlotIndex);
-		data.toTeam = Shared::PlatformByteOrder::fromCommonEndian(data.toTeam);
-		data.networkPlayerStatus = Shared::PlatformByteOrder::fromCommonEndian(data.networkPlayerStatus);
-		data.switchFlags = Shared::PlatformByteOrder::fromCommonEndian(data.switchFlags);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
@@ -3143,35 +2504,25 @@ PlayerIndexMessage::PlayerIndexMessage(int16 playerIndex) {
 	data.playerIndex=playerIndex;
 }
 
-const char * PlayerIndexMessage::getPackedMessageFormat() const {
-	return "ch";
+template<class Archive>
+void PlayerIndexMessage::serializeFields(Archive &archive) {
+	archive & messageType & data.playerIndex;
 }
 
 unsigned int PlayerIndexMessage::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		messageType = 0;
-		packedData.playerIndex = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.playerIndex);
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void PlayerIndexMessage::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.playerIndex);
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 }
 
 unsigned char * PlayerIndexMessage::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.playerIndex);
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
@@ -3183,6 +2534,7 @@ bool PlayerIndexMessage::receive(Socket* socket) {
 			messageType = nmtPlayerIndexMessage;
 		}
 
+		fromEndian();
 	}
 	else {
 		//fromEndian();
@@ -3192,16 +2544,14 @@ bool PlayerIndexMessage::receive(Socket* socket) {
 		//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 		delete [] buf;
 	}
-	fromEndian();
 
 	return result;
 }
 
 void PlayerIndexMessage::send(Socket* socket) {
 	assert(messageType == nmtPlayerIndexMessage);
-	toEndian();
-
 	if(useOldProtocol == true) {
+		toEndian();
 		//NetworkMessage::send(socket, &messageType, sizeof(messageType));
 		NetworkMessage::send(socket, &data, sizeof(data), messageType);
 	}
@@ -3217,15 +2567,15 @@ void PlayerIndexMessage::send(Socket* socket) {
 void PlayerIndexMessage::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
-		data.playerIndex = Shared::PlatformByteOrder::toCommonEndian(data.playerIndex);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 void PlayerIndexMessage::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::fromCommonEndian(messageType);
-		data.playerIndex = Shared::PlatformByteOrder::fromCommonEndian(data.playerIndex);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
@@ -3238,35 +2588,25 @@ NetworkMessageLoadingStatus::NetworkMessageLoadingStatus(uint32 status)
 	data.status=status;
 }
 
-const char * NetworkMessageLoadingStatus::getPackedMessageFormat() const {
-	return "cL";
+template<class Archive>
+void NetworkMessageLoadingStatus::serializeFields(Archive &archive) {
+	archive & messageType & data.status;
 }
 
 unsigned int NetworkMessageLoadingStatus::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		messageType = 0;
-		packedData.status = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.status);
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageLoadingStatus::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.status);
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 }
 
 unsigned char * NetworkMessageLoadingStatus::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.status);
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
@@ -3277,6 +2617,7 @@ bool NetworkMessageLoadingStatus::receive(Socket* socket) {
 		if(result == true) {
 			messageType = nmtLoadingStatusMessage;
 		}
+		fromEndian();
 	}
 	else {
 		//fromEndian();
@@ -3286,16 +2627,14 @@ bool NetworkMessageLoadingStatus::receive(Socket* socket) {
 		//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 		delete [] buf;
 	}
-	fromEndian();
 
 	return result;
 }
 
 void NetworkMessageLoadingStatus::send(Socket* socket) {
 	assert(messageType == nmtLoadingStatusMessage);
-	toEndian();
-
 	if(useOldProtocol == true) {
+		toEndian();
 		//NetworkMessage::send(socket, &messageType, sizeof(messageType));
 		NetworkMessage::send(socket, &data, sizeof(data), messageType);
 	}
@@ -3310,15 +2649,15 @@ void NetworkMessageLoadingStatus::send(Socket* socket) {
 void NetworkMessageLoadingStatus::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
-		data.status = Shared::PlatformByteOrder::toCommonEndian(data.status);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 void NetworkMessageLoadingStatus::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::fromCommonEndian(messageType);
-		data.status = Shared::PlatformByteOrder::fromCommonEndian(data.status);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
@@ -3348,53 +2687,26 @@ NetworkMessageMarkCell * NetworkMessageMarkCell::getCopy() const {
 	return copy;
 }
 
-const char * NetworkMessageMarkCell::getPackedMessageFormat() const {
-	return "chhcc500s";
+template<class Archive>
+void NetworkMessageMarkCell::serializeFields(Archive &archive) {
+	archive & messageType & data.targetX & data.targetY & data.factionIndex
+		& data.playerIndex & packedString(data.text);
 }
 
 unsigned int NetworkMessageMarkCell::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		packedData.factionIndex = 0;
-		messageType = nmtMarkCell;
-		packedData.playerIndex = 0;
-		packedData.targetX = 0;
-		packedData.targetY = 0;
-
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.targetX,
-				packedData.targetY,
-				packedData.factionIndex,
-				packedData.playerIndex,
-				packedData.text.getBuffer());
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageMarkCell::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.targetX,
-			&data.targetY,
-			&data.factionIndex,
-			&data.playerIndex,
-			data.text.getBuffer());
-
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 }
 
 unsigned char * NetworkMessageMarkCell::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.targetX,
-			data.targetY,
-			data.factionIndex,
-			data.playerIndex,
-			data.text.getBuffer());
-
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
@@ -3405,6 +2717,7 @@ bool NetworkMessageMarkCell::receive(Socket* socket){
 		if(result == true) {
 			messageType = nmtMarkCell;
 		}
+		fromEndian();
 	}
 	else {
 		unsigned char *buf = new unsigned char[getPackedSize()+1];
@@ -3413,7 +2726,6 @@ bool NetworkMessageMarkCell::receive(Socket* socket){
 		//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 		delete [] buf;
 	}
-	fromEndian();
 
 	data.text.nullTerminate();
 	return result;
@@ -3423,9 +2735,8 @@ void NetworkMessageMarkCell::send(Socket* socket) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtMarkCell\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	assert(messageType == nmtMarkCell);
-	toEndian();
-
 	if(useOldProtocol == true) {
+		toEndian();
 		//NetworkMessage::send(socket, &messageType, sizeof(messageType));
 		NetworkMessage::send(socket, &data, sizeof(data), messageType);
 	}
@@ -3440,21 +2751,15 @@ void NetworkMessageMarkCell::send(Socket* socket) {
 void NetworkMessageMarkCell::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
-		data.targetX = Shared::PlatformByteOrder::toCommonEndian(data.targetX);
-		data.targetY = Shared::PlatformByteOrder::toCommonEndian(data.targetY);
-		data.factionIndex = Shared::PlatformByteOrder::toCommonEndian(data.factionIndex);
-		data.playerIndex = Shared::PlatformByteOrder::toCommonEndian(data.playerIndex);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 void NetworkMessageMarkCell::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::fromCommonEndian(messageType);
-		data.targetX = Shared::PlatformByteOrder::fromCommonEndian(data.targetX);
-		data.targetY = Shared::PlatformByteOrder::fromCommonEndian(data.targetY);
-		data.factionIndex = Shared::PlatformByteOrder::fromCommonEndian(data.factionIndex);
-		data.playerIndex = Shared::PlatformByteOrder::fromCommonEndian(data.playerIndex);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
@@ -3482,45 +2787,25 @@ NetworkMessageUnMarkCell * NetworkMessageUnMarkCell::getCopy() const {
 	return copy;
 }
 
-const char * NetworkMessageUnMarkCell::getPackedMessageFormat() const {
-	return "chhc";
+template<class Archive>
+void NetworkMessageUnMarkCell::serializeFields(Archive &archive) {
+	archive & messageType & data.targetX & data.targetY & data.factionIndex;
 }
 
 unsigned int NetworkMessageUnMarkCell::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		packedData.factionIndex = 0;
-		messageType = 0;
-		packedData.targetX = 0;
-		packedData.targetY = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.targetX,
-				packedData.targetY,
-				packedData.factionIndex);
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageUnMarkCell::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.targetX,
-			&data.targetY,
-			&data.factionIndex);
-
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 }
 
 unsigned char * NetworkMessageUnMarkCell::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.targetX,
-			data.targetY,
-			data.factionIndex);
-
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
@@ -3531,6 +2816,7 @@ bool NetworkMessageUnMarkCell::receive(Socket* socket){
 		if(result == true) {
 			messageType = nmtUnMarkCell;
 		}
+		fromEndian();
 	}
 	else {
 		unsigned char *buf = new unsigned char[getPackedSize()+1];
@@ -3539,7 +2825,6 @@ bool NetworkMessageUnMarkCell::receive(Socket* socket){
 		//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 		delete [] buf;
 	}
-	fromEndian();
 
 	return result;
 }
@@ -3548,9 +2833,8 @@ void NetworkMessageUnMarkCell::send(Socket* socket) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtUnMarkCell\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	assert(messageType == nmtUnMarkCell);
-	toEndian();
-
 	if(useOldProtocol == true) {
+		toEndian();
 		//NetworkMessage::send(socket, &messageType, sizeof(messageType));
 		NetworkMessage::send(socket, &data, sizeof(data), messageType);
 	}
@@ -3565,19 +2849,15 @@ void NetworkMessageUnMarkCell::send(Socket* socket) {
 void NetworkMessageUnMarkCell::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
-		data.targetX = Shared::PlatformByteOrder::toCommonEndian(data.targetX);
-		data.targetY = Shared::PlatformByteOrder::toCommonEndian(data.targetY);
-		data.factionIndex = Shared::PlatformByteOrder::toCommonEndian(data.factionIndex);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 void NetworkMessageUnMarkCell::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::fromCommonEndian(messageType);
-		data.targetX = Shared::PlatformByteOrder::fromCommonEndian(data.targetX);
-		data.targetY = Shared::PlatformByteOrder::fromCommonEndian(data.targetY);
-		data.factionIndex = Shared::PlatformByteOrder::fromCommonEndian(data.factionIndex);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 
@@ -3599,45 +2879,25 @@ NetworkMessageHighlightCell::NetworkMessageHighlightCell(Vec2i target, int facti
 	data.factionIndex 	= factionIndex;
 }
 
-const char * NetworkMessageHighlightCell::getPackedMessageFormat() const {
-	return "chhc";
+template<class Archive>
+void NetworkMessageHighlightCell::serializeFields(Archive &archive) {
+	archive & messageType & data.targetX & data.targetY & data.factionIndex;
 }
 
 unsigned int NetworkMessageHighlightCell::getPackedSize() {
-	static unsigned int result = 0;
-	if(result == 0) {
-		Data packedData;
-		packedData.factionIndex = 0;
-		messageType = 0;
-		packedData.targetX = 0;
-		packedData.targetY = 0;
-		unsigned char *buf = new unsigned char[sizeof(packedData)*3];
-		result = pack(buf, getPackedMessageFormat(),
-				messageType,
-				packedData.targetX,
-				packedData.targetY,
-				packedData.factionIndex);
-		delete [] buf;
-	}
-	return result;
+	PackedFieldSizer sizer;
+	serializeFields(sizer);
+	return sizer.getSize();
 }
 void NetworkMessageHighlightCell::unpackMessage(unsigned char *buf) {
-	unpack(buf, getPackedMessageFormat(),
-			&messageType,
-			&data.targetX,
-			&data.targetY,
-			&data.factionIndex);
-
+	PackedFieldReader reader(buf);
+	serializeFields(reader);
 }
 
 unsigned char * NetworkMessageHighlightCell::packMessage() {
 	unsigned char *buf = new unsigned char[getPackedSize()+1];
-	pack(buf, getPackedMessageFormat(),
-			messageType,
-			data.targetX,
-			data.targetY,
-			data.factionIndex);
-
+	PackedFieldWriter writer(buf);
+	serializeFields(writer);
 	return buf;
 }
 
@@ -3648,6 +2908,7 @@ bool NetworkMessageHighlightCell::receive(Socket* socket) {
 		if(result == true) {
 			messageType = nmtHighlightCell;
 		}
+		fromEndian();
 	}
 	else {
 		unsigned char *buf = new unsigned char[getPackedSize()+1];
@@ -3656,7 +2917,6 @@ bool NetworkMessageHighlightCell::receive(Socket* socket) {
 		//printf("Got packet size = %u data.messageType = %d\n%s\n",getPackedSize(),data.messageType,buf);
 		delete [] buf;
 	}
-	fromEndian();
 	return result;
 }
 
@@ -3664,9 +2924,8 @@ void NetworkMessageHighlightCell::send(Socket* socket) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtMarkCell\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	assert(messageType == nmtHighlightCell);
-	toEndian();
-
 	if(useOldProtocol == true) {
+		toEndian();
 		//NetworkMessage::send(socket, &messageType, sizeof(messageType));
 		NetworkMessage::send(socket, &data, sizeof(data), messageType);
 	}
@@ -3681,19 +2940,301 @@ void NetworkMessageHighlightCell::send(Socket* socket) {
 void NetworkMessageHighlightCell::toEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
-		data.targetX = Shared::PlatformByteOrder::toCommonEndian(data.targetX);
-		data.targetY = Shared::PlatformByteOrder::toCommonEndian(data.targetY);
-		data.factionIndex = Shared::PlatformByteOrder::toCommonEndian(data.factionIndex);
+		PackedFieldToCommonEndian archive;
+		serializeFields(archive);
 	}
 }
 void NetworkMessageHighlightCell::fromEndian() {
 	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
 	if(bigEndianSystem == true) {
-		messageType = Shared::PlatformByteOrder::fromCommonEndian(messageType);
-		data.targetX = Shared::PlatformByteOrder::fromCommonEndian(data.targetX);
-		data.targetY = Shared::PlatformByteOrder::fromCommonEndian(data.targetY);
-		data.factionIndex = Shared::PlatformByteOrder::fromCommonEndian(data.factionIndex);
+		PackedFieldFromCommonEndian archive;
+		serializeFields(archive);
+	}
+}
+
+// =====================================================
+//	class NetworkMessageGameSnapshotChunk
+// =====================================================
+
+// upper limit for both the compressed and the extracted saved game
+static const uint32 maxGameSnapshotSize = 256 * 1024 * 1024;
+
+NetworkMessageGameSnapshotChunk::NetworkMessageGameSnapshotChunk() {
+	messageType = nmtGameSnapshotChunk;
+	header.snapshotSize = 0;
+	header.compressedSize = 0;
+	header.offset = 0;
+	header.chunkSize = 0;
+}
+
+NetworkMessageGameSnapshotChunk::NetworkMessageGameSnapshotChunk(uint32 snapshotSize, uint32 compressedSize,
+		uint32 offset, const unsigned char *chunkData, uint32 chunkSize) {
+	messageType = nmtGameSnapshotChunk;
+	header.snapshotSize = snapshotSize;
+	header.compressedSize = compressedSize;
+	header.offset = offset;
+	header.chunkSize = chunkSize;
+	chunk.assign(chunkData, chunkData + chunkSize);
+}
+
+bool NetworkMessageGameSnapshotChunk::receive(Socket* socket) {
+	if(NetworkMessage::receive(socket, &header, sizeof(header), true) == false) {
+		return false;
+	}
+	fromEndian();
+
+	if(header.chunkSize == 0 || header.chunkSize > maxChunkSize ||
+		header.snapshotSize > maxGameSnapshotSize || header.compressedSize > maxGameSnapshotSize ||
+		header.offset >= header.compressedSize || header.chunkSize > header.compressedSize - header.offset) {
+		throw megaglest_runtime_error("Invalid game snapshot chunk received, offset = " + uIntToStr(header.offset) +
+				" size = " + uIntToStr(header.chunkSize) + " total = " + uIntToStr(header.compressedSize));
+	}
+
+	chunk.resize(header.chunkSize);
+	return NetworkMessage::receive(socket, &chunk[0], header.chunkSize, true);
+}
+
+void NetworkMessageGameSnapshotChunk::send(Socket* socket) {
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtGameSnapshotChunk, offset = %u size = %u\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,header.offset,header.chunkSize);
+
+	assert(messageType == nmtGameSnapshotChunk);
+	assert(header.chunkSize == chunk.size());
+	toEndian();
+
+	const void *parts[] 	= { &messageType, &header, getChunk() };
+	const int partSizes[] 	= { (int)sizeof(messageType), (int)sizeof(header), (int)chunk.size() };
+	NetworkMessage::send(socket, parts, partSizes, 3);
+	fromEndian();
+}
+
+void NetworkMessageGameSnapshotChunk::toEndian() {
+	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
+	if(bigEndianSystem == true) {
+		messageType = Shared::PlatformByteOrder::toCommonEndian(messageType);
+		header.snapshotSize = Shared::PlatformByteOrder::toCommonEndian(header.snapshotSize);
+		header.compressedSize = Shared::PlatformByteOrder::toCommonEndian(header.compressedSize);
+		header.offset = Shared::PlatformByteOrder::toCommonEndian(header.offset);
+		header.chunkSize = Shared::PlatformByteOrder::toCommonEndian(header.chunkSize);
+	}
+}
+void NetworkMessageGameSnapshotChunk::fromEndian() {
+	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
+	if(bigEndianSystem == true) {
+		header.snapshotSize = Shared::PlatformByteOrder::fromCommonEndian(header.snapshotSize);
+		header.compressedSize = Shared::PlatformByteOrder::fromCommonEndian(header.compressedSize);
+		header.offset = Shared::PlatformByteOrder::fromCommonEndian(header.offset);
+		header.chunkSize = Shared::PlatformByteOrder::fromCommonEndian(header.chunkSize);
+	}
+}
+
+// =====================================================
+//	class NetworkMessageContentManifest
+// =====================================================
+
+static const uint32 maxContentManifestSize		= 64 * 1024 * 1024;
+static const uint32 maxContentChunkRequestSize	= 64 * 1024;
+
+NetworkMessageContentManifest::NetworkMessageContentManifest() {
+	contentType = cstMap;
+	status = cmsRequest;
+}
+
+NetworkMessageContentManifest::NetworkMessageContentManifest(ContentSyncType contentType, const string &contentName) {
+	this->contentType = contentType;
+	this->contentName = contentName;
+	this->status = cmsRequest;
+}
+
+NetworkMessageContentManifest::NetworkMessageContentManifest(ContentSyncType contentType, const string &contentName,
+		bool available, const std::vector<ContentChunkFile> &files) {
+	this->contentType = contentType;
+	this->contentName = contentName;
+	this->status = (available == true ? cmsAvailable : cmsUnavailable);
+	if(available == true) {
+		this->files = files;
+	}
+}
+
+bool NetworkMessageContentManifest::receive(Socket* socket) {
+	std::vector<unsigned char> payload;
+	if(receivePayload(socket, payload, maxContentManifestSize) == false) {
+		return false;
+	}
+
+	VarintReader reader((payload.empty() ? NULL : &payload[0]), (int)payload.size());
+	contentType = reader.readByte();
+	contentName = reader.readString();
+	status = reader.readByte();
+	uint32 fileCount = reader.readUInt();
+	if(contentType < 0 || contentType >= cstCount || status < cmsRequest || status > cmsUnavailable ||
+		fileCount > payload.size()) {
+		throw megaglest_runtime_error("Invalid content manifest received for [" + contentName + "]");
+	}
+
+	files.resize(fileCount);
+	for(unsigned int index = 0; index < fileCount && reader.hasFailed() == false; ++index) {
+		ContentChunkFile &file = files[index];
+		file.path = reader.readString();
+		file.size = reader.readUInt();
+		uint32 chunkCount = ContentChunks::getChunkCount(file.size);
+		if(chunkCount > payload.size()) {
+			throw megaglest_runtime_error("Invalid content manifest file size for [" + file.path + "]");
+		}
+		file.chunkCRCs.resize(chunkCount);
+		for(unsigned int chunkIndex = 0; chunkIndex < chunkCount; ++chunkIndex) {
+			file.chunkCRCs[chunkIndex] = reader.readFixedUInt();
+		}
+	}
+	if(reader.hasFailed() == true || reader.isAtEnd() == false) {
+		throw megaglest_runtime_error("Invalid content manifest received, size = " + uIntToStr((uint32)payload.size()));
+	}
+	return true;
+}
+
+void NetworkMessageContentManifest::send(Socket* socket) {
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtContentManifest, contentType = %d name [%s] status = %d files = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,contentType,contentName.c_str(),status,(int)files.size());
+
+	VarintWriter payload;
+	payload.writeByte(contentType);
+	payload.writeString(contentName);
+	payload.writeByte(status);
+	payload.writeUInt((uint32)files.size());
+	for(unsigned int index = 0; index < files.size(); ++index) {
+		const ContentChunkFile &file = files[index];
+		payload.writeString(file.path);
+		payload.writeUInt(file.size);
+		for(unsigned int chunkIndex = 0; chunkIndex < file.chunkCRCs.size(); ++chunkIndex) {
+			payload.writeFixedUInt(file.chunkCRCs[chunkIndex]);
+		}
+	}
+	sendPayload(socket, (int8)nmtContentManifest, payload.getBuffer());
+}
+
+// =====================================================
+//	class NetworkMessageContentChunkRequest
+// =====================================================
+
+NetworkMessageContentChunkRequest::NetworkMessageContentChunkRequest() {
+	contentType = cstMap;
+}
+
+NetworkMessageContentChunkRequest::NetworkMessageContentChunkRequest(ContentSyncType contentType, const string &contentName) {
+	this->contentType = contentType;
+	this->contentName = contentName;
+}
+
+bool NetworkMessageContentChunkRequest::addChunk(uint32 fileIndex, uint32 chunkIndex) {
+	if(chunks.size() >= maxChunkCount) {
+		return false;
+	}
+	chunks.push_back(std::make_pair(fileIndex, chunkIndex));
+	return true;
+}
+
+bool NetworkMessageContentChunkRequest::receive(Socket* socket) {
+	std::vector<unsigned char> payload;
+	if(receivePayload(socket, payload, maxContentChunkRequestSize) == false) {
+		return false;
+	}
+
+	VarintReader reader((payload.empty() ? NULL : &payload[0]), (int)payload.size());
+	contentType = reader.readByte();
+	contentName = reader.readString();
+	uint32 chunkCount = reader.readUInt();
+	if(contentType < 0 || contentType >= cstCount || chunkCount > maxChunkCount) {
+		throw megaglest_runtime_error("Invalid content chunk request received for [" + contentName + "]");
+	}
+
+	chunks.resize(chunkCount);
+	for(unsigned int index = 0; index < chunkCount; ++index) {
+		chunks[index].first = reader.readUInt();
+		chunks[index].second = reader.readUInt();
+	}
+	if(reader.hasFailed() == true || reader.isAtEnd() == false) {
+		throw megaglest_runtime_error("Invalid content chunk request received, size = " + uIntToStr((uint32)payload.size()));
+	}
+	return true;
+}
+
+void NetworkMessageContentChunkRequest::send(Socket* socket) {
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtContentChunkRequest, contentType = %d name [%s] chunks = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,contentType,contentName.c_str(),(int)chunks.size());
+
+	VarintWriter payload;
+	payload.writeByte(contentType);
+	payload.writeString(contentName);
+	payload.writeUInt((uint32)chunks.size());
+	for(unsigned int index = 0; index < chunks.size(); ++index) {
+		payload.writeUInt(chunks[index].first);
+		payload.writeUInt(chunks[index].second);
+	}
+	sendPayload(socket, (int8)nmtContentChunkRequest, payload.getBuffer());
+}
+
+// =====================================================
+//	class NetworkMessageContentChunk
+// =====================================================
+
+NetworkMessageContentChunk::NetworkMessageContentChunk() {
+	messageType = nmtContentChunk;
+	header.contentType = cstMap;
+	header.fileIndex = 0;
+	header.chunkIndex = 0;
+	header.chunkSize = 0;
+}
+
+NetworkMessageContentChunk::NetworkMessageContentChunk(ContentSyncType contentType, uint32 fileIndex,
+		uint32 chunkIndex, const std::vector<unsigned char> &chunkData) {
+	messageType = nmtContentChunk;
+	header.contentType = contentType;
+	header.fileIndex = fileIndex;
+	header.chunkIndex = chunkIndex;
+	header.chunkSize = (uint32)chunkData.size();
+	chunk = chunkData;
+}
+
+bool NetworkMessageContentChunk::receive(Socket* socket) {
+	if(NetworkMessage::receive(socket, &header, sizeof(header), true) == false) {
+		return false;
+	}
+	fromEndian();
+
+	if(header.contentType < 0 || header.contentType >= cstCount ||
+		header.chunkSize == 0 || header.chunkSize > ContentChunks::chunkSize) {
+		throw megaglest_runtime_error("Invalid content chunk received, file = " + uIntToStr(header.fileIndex) +
+				" chunk = " + uIntToStr(header.chunkIndex) + " size = " + uIntToStr(header.chunkSize));
+	}
+
+	chunk.resize(header.chunkSize);
+	return NetworkMessage::receive(socket, &chunk[0], header.chunkSize, true);
+}
+
+void NetworkMessageContentChunk::send(Socket* socket) {
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] nmtContentChunk, file = %u chunk = %u size = %u\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,header.fileIndex,header.chunkIndex,header.chunkSize);
+
+	assert(messageType == nmtContentChunk);
+	assert(header.chunkSize == chunk.size());
+	toEndian();
+
+	const void *parts[] 	= { &messageType, &header, getChunk() };
+	const int partSizes[] 	= { (int)sizeof(messageType), (int)sizeof(header), (int)chunk.size() };
+	NetworkMessage::send(socket, parts, partSizes, 3);
+	fromEndian();
+}
+
+void NetworkMessageContentChunk::toEndian() {
+	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
+	if(bigEndianSystem == true) {
+		header.fileIndex = Shared::PlatformByteOrder::toCommonEndian(header.fileIndex);
+		header.chunkIndex = Shared::PlatformByteOrder::toCommonEndian(header.chunkIndex);
+		header.chunkSize = Shared::PlatformByteOrder::toCommonEndian(header.chunkSize);
+	}
+}
+void NetworkMessageContentChunk::fromEndian() {
+	static bool bigEndianSystem = Shared::PlatformByteOrder::isBigEndian();
+	if(bigEndianSystem == true) {
+		header.fileIndex = Shared::PlatformByteOrder::fromCommonEndian(header.fileIndex);
+		header.chunkIndex = Shared::PlatformByteOrder::fromCommonEndian(header.chunkIndex);
+		header.chunkSize = Shared::PlatformByteOrder::fromCommonEndian(header.chunkSize);
 	}
 }
 
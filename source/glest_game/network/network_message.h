@@ -18,12 +18,14 @@
 #include "byte_order.h"
 #include <map>
 #include "common_scoped_ptr.h"
+#include "content_chunks.h"
 #include "leak_dumper.h"
 
 using Shared::Platform::Socket;
 using Shared::Platform::int8;
 using Shared::Platform::uint8;
 using Shared::Platform::int16;
+using Shared::Util::ContentChunkFile;
 
 namespace Glest{ namespace Game{
 
@@ -49,6 +51,12 @@ enum NetworkMessageType {
 	nmtMarkCell,
 	nmtUnMarkCell,
 	nmtHighlightCell,
+	nmtCommandListCompact,
+	nmtCommandListHeartbeat,
+	nmtGameSnapshotChunk,
+	nmtContentManifest,
+	nmtContentChunkRequest,
+	nmtContentChunk,
 //	nmtCompressedPacket,
 
 	nmtCount
@@ -62,6 +70,21 @@ enum NetworkGameStateType {
 	nmgstCount
 };
 
+enum NetworkCapabilityType {
+	ncapCompactCommandList	= 0x01,
+	ncapGameSnapshotStream	= 0x02,
+	ncapContentSync			= 0x04,
+	ncapPingEcho			= 0x08
+};
+
+enum ContentSyncType {
+	cstMap,
+	cstTileset,
+	cstTechtree,
+
+	cstCount
+};
+
 static const int maxLanguageStringSize= 60;
 static const int maxNetworkMessageSize= 20000;
 
@@ -104,6 +127,8 @@ private:
 	static Chrono lastRecv;
 	static std::map<NetworkMessageStatisticType,int64> mapMessageStats;
 
+	static bool isPacketDumpEnabled();
+
 public:
 	static void resetNetworkPacketStats();
 	static string getNetworkPacketStats();
@@ -127,8 +152,12 @@ protected:
 	void send(Socket* socket, const void* data, int dataSize);
 	void send(Socket* socket, const void* data, int dataSize, int8 messageType);
 	void send(Socket* socket, const void* data, int dataSize, int8 messageType, uint32 compressedLength);
+	// Sends the parts of one message with a single gather write
+	void send(Socket* socket, const void * const data[], const int dataSize[], int partCount);
+	// A varint length followed by that many bytes, for messages of variable size
+	void sendPayload(Socket* socket, int8 messageType, const std::vector<unsigned char> &payload);
+	bool receivePayload(Socket* socket, std::vector<unsigned char> &payload, uint32 maxPayloadSize);
 
-	virtual const char * getPackedMessageFormat() const = 0;
 	virtual unsigned int getPackedSize() = 0;
 	virtual void unpackMessage(unsigned char *buf) = 0;
 	virtual unsigned char * packMessage() = 0;
@@ -162,8 +191,12 @@ private:
 		int8 gameInProgress;
 		NetworkString<maxSmallStringSize> playerUUID;
 		NetworkString<maxSmallStringSize> platform;
+		// layout of the capabilities field, 0 when the sender has none
+		uint8 capabilitiesVersion;
+		uint32 capabilities;
 	};
 
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 
@@ -173,6 +206,8 @@ private:
 protected:
 
 public:
+	static const uint8 currentCapabilitiesVersion = 1;
+
 	NetworkMessageIntro();
 	NetworkMessageIntro(int32 sessionId, const string &versionString,
 			const string &name, int playerIndex, NetworkGameStateType gameState,
@@ -180,7 +215,6 @@ public:
 			int gameInProgress, const string &playerUUID, const string &platform);
 
 
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -204,6 +238,10 @@ public:
 	string getPlayerUUID() const				{ return data.playerUUID.getString();}
 	string getPlayerPlatform() const			{ return data.platform.getString();}
 
+	// NetworkCapabilityType bits supported by the sender
+	uint32 getCapabilities() const;
+	void setCapabilities(uint32 capabilities);
+
 	virtual bool receive(Socket* socket);
 	virtual void send(Socket* socket);
 
@@ -225,6 +263,7 @@ private:
 		int32 pingFrequency;
 		int64 pingTime;
 	};
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 
@@ -233,7 +272,6 @@ private:
 	int64 pingReceivedLocalTime;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -271,6 +309,7 @@ private:
 	struct Data{
 		uint32 checksum;
 	};
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 
@@ -278,7 +317,6 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -368,6 +406,7 @@ private:
 		int8 networkAllowNativeLanguageTechtree;
 		NetworkString<maxSmallStringSize> gameUUID;
 	};
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 	std::pair<unsigned char *,unsigned long> getCompressedMessage();
@@ -375,7 +414,6 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -412,6 +450,23 @@ public:
 //	Message to order a commands to several units
 // =====================================================
 
+// Frame numbers last sent or received as compact command lists on one
+// connection. Compact frame counts are stored relative to it, and a
+// heartbeat repeats the previous frame step.
+class NetworkCommandListFrameState {
+public:
+	int32 lastFrameCount;
+	int32 lastFrameStep;
+
+	NetworkCommandListFrameState() {
+		reset();
+	}
+	void reset() {
+		lastFrameCount = 0;
+		lastFrameStep = 0;
+	}
+};
+
 #pragma pack(push, 1)
 class NetworkMessageCommandList: public NetworkMessage {
 
@@ -439,6 +494,8 @@ private:
 			data_ref.header.networkPlayerFactionCRC[index] = 0;
 		}
 	}
+	template<class Archive> void serializeHeaderFields(Archive &archive);
+	template<class Archive> static void serializeCommandFields(Archive &archive, NetworkCommand &command);
 	void toEndianHeader();
 	void fromEndianHeader();
 	void toEndianDetail(uint16 totalCommand);
@@ -448,17 +505,14 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const { return NULL; }
 	virtual unsigned int getPackedSize() { return 0; }
 	virtual void unpackMessage(unsigned char *buf) { };
 	virtual unsigned char * packMessage() { return NULL; }
 
-	const char * getPackedMessageFormatHeader() const;
 	unsigned int getPackedSizeHeader();
 	void unpackMessageHeader(unsigned char *buf);
 	unsigned char * packMessageHeader();
 
-	const char * getPackedMessageFormatDetail() const;
 	unsigned int getPackedSizeDetail(int count);
 	void unpackMessageDetail(unsigned char *buf,int count);
 	unsigned char * packMessageDetail(uint16 totalCommand);
@@ -485,6 +539,16 @@ public:
 
 	virtual bool receive(Socket* socket);
 	virtual void send(Socket* socket);
+
+	// Varint encoding used when the peer announced ncapCompactCommandList.
+	// A list without commands or checksums that continues the previous
+	// frame step is sent as a single nmtCommandListHeartbeat byte.
+	void sendCompact(Socket* socket, NetworkCommandListFrameState &frameState);
+	bool receiveCompact(Socket* socket, NetworkMessageType type, NetworkCommandListFrameState &frameState);
+
+	static bool isCommandListMessageType(NetworkMessageType type) {
+		return (type == nmtCommandList || type == nmtCommandListCompact || type == nmtCommandListHeartbeat);
+	}
 };
 #pragma pack(pop)
 
@@ -508,6 +572,7 @@ private:
 		int8 playerIndex;
 		NetworkString<maxLanguageStringSize> targetLanguage;
 	};
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 
@@ -515,7 +580,6 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -556,6 +620,7 @@ private:
 	//struct Data{
 	//	int8 messageType;
 	//};
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 
@@ -563,7 +628,6 @@ private:
 	//Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -627,6 +691,8 @@ private:
 		DataHeader header;
 		DataDetail detail;
 	};
+	template<class Archive> void serializeHeaderFields(Archive &archive);
+	template<class Archive> void serializeDetailFields(Archive &archive);
 	void toEndianHeader();
 	void fromEndianHeader();
 	void toEndianDetail(uint32 totalFileCount);
@@ -636,12 +702,10 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const { return NULL; }
 	virtual unsigned int getPackedSize() { return 0; }
 	virtual void unpackMessage(unsigned char *buf) { };
 	virtual unsigned char * packMessage() { return NULL; }
 
-	const char * getPackedMessageFormatHeader() const;
 	unsigned int getPackedSizeHeader();
 	void unpackMessageHeader(unsigned char *buf);
 	unsigned char * packMessageHeader();
@@ -727,7 +791,6 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const { return NULL; }
 	virtual unsigned int getPackedSize() { return 0; }
 	virtual void unpackMessage(unsigned char *buf) { };
 	virtual unsigned char * packMessage() { return NULL; }
@@ -781,6 +844,7 @@ private:
 		uint32 fileCRC;
 		NetworkString<maxStringSize> fileName;
 	};
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 
@@ -788,7 +852,6 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -833,6 +896,7 @@ private:
 
 		NetworkString<maxStringSize> fileName;
 	};
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 
@@ -840,7 +904,6 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -900,6 +963,7 @@ private:
 		int8 switchFlags;
 		NetworkString<maxLanguageStringSize> language;
 	};
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 
@@ -907,7 +971,6 @@ private:
 	Data data;
 
 public:
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -959,6 +1022,7 @@ private:
 
 		int16 playerIndex;
 	};
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 
@@ -966,7 +1030,6 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -1024,6 +1087,7 @@ private:
 
 		uint32 status;
 	};
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 
@@ -1031,7 +1095,6 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -1077,6 +1140,7 @@ private:
 		int8 playerIndex;
 		NetworkString<maxTextStringSize> text;
 	};
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 
@@ -1084,7 +1148,6 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -1129,6 +1192,7 @@ private:
 		int16 targetY;
 		int8 factionIndex;
 	};
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 
@@ -1136,7 +1200,6 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -1181,6 +1244,7 @@ private:
 		int16 targetY;
 		int8 factionIndex;
 	};
+	template<class Archive> void serializeFields(Archive &archive);
 	void toEndian();
 	void fromEndian();
 
@@ -1188,7 +1252,6 @@ private:
 	Data data;
 
 protected:
-	virtual const char * getPackedMessageFormat() const;
 	virtual unsigned int getPackedSize();
 	virtual void unpackMessage(unsigned char *buf);
 	virtual unsigned char * packMessage();
@@ -1211,6 +1274,199 @@ public:
 };
 #pragma pack(pop)
 
+// =====================================================
+//	class NetworkMessageGameSnapshotChunk
+//
+//	Part of a compressed saved game streamed by the
+//	server to a client joining a game in progress
+// =====================================================
+
+#pragma pack(push, 1)
+class NetworkMessageGameSnapshotChunk: public NetworkMessage {
+public:
+	static const uint32 maxChunkSize = 16384;
+
+private:
+	int8 messageType;
+	struct DataHeader {
+		uint32 snapshotSize;
+		uint32 compressedSize;
+		uint32 offset;
+		uint32 chunkSize;
+	};
+	void toEndian();
+	void fromEndian();
+
+private:
+	DataHeader header;
+	std::vector<unsigned char> chunk;
+
+protected:
+	virtual unsigned int getPackedSize() { return 0; }
+	virtual void unpackMessage(unsigned char *buf) { };
+	virtual unsigned char * packMessage() { return NULL; }
+
+public:
+	NetworkMessageGameSnapshotChunk();
+	NetworkMessageGameSnapshotChunk(uint32 snapshotSize, uint32 compressedSize,
+			uint32 offset, const unsigned char *chunkData, uint32 chunkSize);
+
+	virtual size_t getDataSize() const { return sizeof(DataHeader) + chunk.size(); }
+
+	virtual NetworkMessageType getNetworkMessageType() const {
+		return nmtGameSnapshotChunk;
+	}
+
+	uint32 getSnapshotSize() const		{ return header.snapshotSize; }
+	uint32 getCompressedSize() const	{ return header.compressedSize; }
+	uint32 getOffset() const			{ return header.offset; }
+	uint32 getChunkSize() const			{ return header.chunkSize; }
+	const unsigned char * getChunk() const { return (chunk.empty() ? NULL : &chunk[0]); }
+
+	virtual bool receive(Socket* socket);
+	virtual void send(Socket* socket);
+};
+#pragma pack(pop)
+
+// =====================================================
+//	class NetworkMessageContentManifest
+//
+//	Asks the server for the chunk list of a map, tileset
+//	or techtree, and carries the server's answer
+// =====================================================
+
+class NetworkMessageContentManifest: public NetworkMessage {
+public:
+	enum Status {
+		cmsRequest,
+		cmsAvailable,
+		cmsUnavailable
+	};
+
+private:
+	int8 contentType;
+	string contentName;
+	int8 status;
+	std::vector<ContentChunkFile> files;
+
+protected:
+	virtual unsigned int getPackedSize() { return 0; }
+	virtual void unpackMessage(unsigned char *buf) { };
+	virtual unsigned char * packMessage() { return NULL; }
+
+public:
+	NetworkMessageContentManifest();
+	NetworkMessageContentManifest(ContentSyncType contentType, const string &contentName);
+	NetworkMessageContentManifest(ContentSyncType contentType, const string &contentName,
+			bool available, const std::vector<ContentChunkFile> &files);
+
+	// only known once the payload is encoded
+	virtual size_t getDataSize() const { return 0; }
+
+	virtual NetworkMessageType getNetworkMessageType() const {
+		return nmtContentManifest;
+	}
+
+	ContentSyncType getContentType() const					{ return static_cast<ContentSyncType>(contentType); }
+	const string &getContentName() const					{ return contentName; }
+	Status getStatus() const								{ return static_cast<Status>(status); }
+	const std::vector<ContentChunkFile> &getFiles() const	{ return files; }
+
+	virtual bool receive(Socket* socket);
+	virtual void send(Socket* socket);
+};
+
+// =====================================================
+//	class NetworkMessageContentChunkRequest
+//
+//	Chunks of a manifest the client still needs
+// =====================================================
+
+class NetworkMessageContentChunkRequest: public NetworkMessage {
+public:
+	static const uint32 maxChunkCount = 256;
+
+private:
+	int8 contentType;
+	string contentName;
+	std::vector<std::pair<uint32,uint32> > chunks;
+
+protected:
+	virtual unsigned int getPackedSize() { return 0; }
+	virtual void unpackMessage(unsigned char *buf) { };
+	virtual unsigned char * packMessage() { return NULL; }
+
+public:
+	NetworkMessageContentChunkRequest();
+	NetworkMessageContentChunkRequest(ContentSyncType contentType, const string &contentName);
+
+	// only known once the payload is encoded
+	virtual size_t getDataSize() const { return 0; }
+
+	virtual NetworkMessageType getNetworkMessageType() const {
+		return nmtContentChunkRequest;
+	}
+
+	ContentSyncType getContentType() const	{ return static_cast<ContentSyncType>(contentType); }
+	const string &getContentName() const	{ return contentName; }
+	// file index and chunk index pairs
+	const std::vector<std::pair<uint32,uint32> > &getChunks() const { return chunks; }
+	bool addChunk(uint32 fileIndex, uint32 chunkIndex);
+
+	virtual bool receive(Socket* socket);
+	virtual void send(Socket* socket);
+};
+
+// =====================================================
+//	class NetworkMessageContentChunk
+//
+//	One chunk of a content file sent by the server
+// =====================================================
+
+#pragma pack(push, 1)
+class NetworkMessageContentChunk: public NetworkMessage {
+private:
+	int8 messageType;
+	struct DataHeader {
+		int8 contentType;
+		uint32 fileIndex;
+		uint32 chunkIndex;
+		uint32 chunkSize;
+	};
+	void toEndian();
+	void fromEndian();
+
+private:
+	DataHeader header;
+	std::vector<unsigned char> chunk;
+
+protected:
+	virtual unsigned int getPackedSize() { return 0; }
+	virtual void unpackMessage(unsigned char *buf) { };
+	virtual unsigned char * packMessage() { return NULL; }
+
+public:
+	NetworkMessageContentChunk();
+	NetworkMessageContentChunk(ContentSyncType contentType, uint32 fileIndex,
+			uint32 chunkIndex, const std::vector<unsigned char> &chunkData);
+
+	virtual size_t getDataSize() const { return sizeof(DataHeader) + chunk.size(); }
+
+	virtual NetworkMessageType getNetworkMessageType() const {
+		return nmtContentChunk;
+	}
+
+	ContentSyncType getContentType() const	{ return static_cast<ContentSyncType>(header.contentType); }
+	uint32 getFileIndex() const				{ return header.fileIndex; }
+	uint32 getChunkIndex() const			{ return header.chunkIndex; }
+	uint32 getChunkSize() const				{ return header.chunkSize; }
+	const unsigned char * getChunk() const	{ return (chunk.empty() ? NULL : &chunk[0]); }
+
+	virtual bool receive(Socket* socket);
+	virtual void send(Socket* socket);
+};
+#pragma pack(pop)
+
 }}//end namespace
 
 #endif
@@ -0,0 +1,365 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "network_telemetry.h"
+
+#include <cstdio>
+#include "conversion.h"
+#include "platform_common.h"
+#include "sim_benchmark.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+using namespace Shared::Util;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+//	class NetworkTelemetry
+// =====================================================
+
+const int NetworkTelemetry::roundTripBucketMillis[roundTripBucketCount - 1] = { 10, 25, 50, 100, 200, 400, 800 };
+const int NetworkTelemetry::frameLagBucketFrames[frameLagBucketCount - 1] 	= { 0, 1, 3, 7, 15, 31, 63 };
+
+bool NetworkTelemetry::enabled = false;
+
+NetworkTelemetry::NetworkTelemetry() {
+	mutex = new Mutex(CODE_AT_LINE);
+	reset();
+}
+
+NetworkTelemetry::~NetworkTelemetry() {
+	delete mutex;
+	mutex = NULL;
+}
+
+void NetworkTelemetry::reset() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+
+	for(int type = 0; type < nmtCount; ++type) {
+		sent[type].count 		= 0;
+		sent[type].bytes 		= 0;
+		received[type].count 	= 0;
+		received[type].bytes 	= 0;
+	}
+
+	pendingPingTime 		= 0;
+	pendingPingTicks 		= 0;
+	for(int index = 0; index < roundTripBucketCount; ++index) {
+		roundTripBuckets[index] = 0;
+	}
+	roundTripSamples 		= 0;
+	roundTripMillisTotal 	= 0;
+	roundTripMillisMin 		= 0;
+	roundTripMillisMax 		= 0;
+	roundTripMillisLast 	= 0;
+
+	for(int index = 0; index < frameLagBucketCount; ++index) {
+		frameLagBuckets[index] = 0;
+	}
+	frameLagSamples 		= 0;
+	frameLagMax 			= 0;
+	frameLagLast 			= 0;
+
+	waitSamples 			= 0;
+	waitMicrosTotal 		= 0;
+	waitMicrosMax 			= 0;
+	readyWaitMillis 		= 0;
+}
+
+const char * NetworkTelemetry::getMessageTypeName(int type) {
+	switch(type) {
+		case nmtIntro:								return "intro";
+		case nmtPing:								return "ping";
+		case nmtReady:								return "ready";
+		case nmtLaunch:								return "launch";
+		case nmtCommandList:						return "commandList";
+		case nmtText:								return "text";
+		case nmtQuit:								return "quit";
+		case nmtSynchNetworkGameData:				return "synchNetworkGameData";
+		case nmtSynchNetworkGameDataStatus:			return "synchNetworkGameDataStatus";
+		case nmtSynchNetworkGameDataFileCRCCheck:	return "synchNetworkGameDataFileCRCCheck";
+		case nmtSynchNetworkGameDataFileGet:		return "synchNetworkGameDataFileGet";
+		case nmtBroadCastSetup:						return "broadCastSetup";
+		case nmtSwitchSetupRequest:					return "switchSetupRequest";
+		case nmtPlayerIndexMessage:					return "playerIndex";
+		case nmtLoadingStatusMessage:				return "loadingStatus";
+		case nmtMarkCell:							return "markCell";
+		case nmtUnMarkCell:							return "unMarkCell";
+		case nmtHighlightCell:						return "highlightCell";
+		case nmtCommandListCompact:					return "commandListCompact";
+		case nmtCommandListHeartbeat:				return "commandListHeartbeat";
+		case nmtGameSnapshotChunk:					return "gameSnapshotChunk";
+		case nmtContentManifest:					return "contentManifest";
+		case nmtContentChunkRequest:				return "contentChunkRequest";
+		case nmtContentChunk:						return "contentChunk";
+		default:									return "invalid";
+	}
+}
+
+string NetworkTelemetry::escapeJSON(const string &value) {
+	string result;
+	result.reserve(value.size());
+	for(unsigned int index = 0; index < value.size(); ++index) {
+		unsigned char character = value[index];
+		switch(character) {
+			case '"':	result += "\\\"";	break;
+			case '\\':	result += "\\\\";	break;
+			case '\n':	result += "\\n";	break;
+			case '\r':	result += "\\r";	break;
+			case '\t':	result += "\\t";	break;
+			default:
+				if(character < 0x20) {
+					char szBuf[8]="";
+					snprintf(szBuf,8,"\\u%04x",character);
+					result += szBuf;
+				}
+				else {
+					// utf8 passes through as is
+					result += (char)character;
+				}
+				break;
+		}
+	}
+	return result;
+}
+
+bool NetworkTelemetry::isWriteDue(time_t &lastWriteTime, int intervalSeconds) {
+	if(enabled == false) {
+		return false;
+	}
+	if(lastWriteTime != 0 &&
+		difftime((long int)time(NULL),lastWriteTime) < intervalSeconds) {
+		return false;
+	}
+	lastWriteTime = time(NULL);
+	return true;
+}
+
+bool NetworkTelemetry::writeFile(const string &file, const string &json) {
+	string tempFile = file + ".tmp";
+#ifdef WIN32
+	FILE *fp = _wfopen(utf8_decode(tempFile).c_str(), L"wb");
+#else
+	FILE *fp = fopen(tempFile.c_str(), "wb");
+#endif
+	if(fp == NULL) {
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] cannot write [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,tempFile.c_str());
+		return false;
+	}
+	bool result = (fwrite(json.c_str(), 1, json.size(), fp) == json.size());
+	result = (fclose(fp) == 0 && result);
+
+	// rename does not replace an existing file everywhere
+	if(result == true && fileExists(file) == true) {
+		removeFile(file);
+	}
+	return (result == true && renameFile(tempFile, file) == true);
+}
+
+int NetworkTelemetry::getBucket(const int limits[], int limitCount, int64 value) {
+	int bucket = 0;
+	for(; bucket < limitCount && value > limits[bucket]; ++bucket) {
+	}
+	return bucket;
+}
+
+void NetworkTelemetry::addSent(int type, int64 bytes) {
+	if(enabled == false || type < 0 || type >= nmtCount) {
+		return;
+	}
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	sent[type].count++;
+	sent[type].bytes += bytes;
+}
+
+void NetworkTelemetry::addReceived(int type, int64 bytes) {
+	if(enabled == false || type < 0 || type >= nmtCount) {
+		return;
+	}
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	received[type].count++;
+	received[type].bytes += bytes;
+}
+
+void NetworkTelemetry::addPingSent(int64 pingTime) {
+	if(enabled == false) {
+		return;
+	}
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	pendingPingTime 	= pingTime;
+	pendingPingTicks 	= SimBenchmark::getTicks();
+}
+
+void NetworkTelemetry::addPingEcho(int64 pingTime) {
+	if(enabled == false) {
+		return;
+	}
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	// echoes of older pings or of pings sent before we were enabled
+	if(pendingPingTicks == 0 || pingTime != pendingPingTime) {
+		return;
+	}
+	int64 millis = SimBenchmark::ticksToMicros(SimBenchmark::getTicks() - pendingPingTicks) / 1000;
+	pendingPingTicks = 0;
+
+	roundTripBuckets[getBucket(roundTripBucketMillis, roundTripBucketCount - 1, millis)]++;
+	if(roundTripSamples == 0 || millis < roundTripMillisMin) {
+		roundTripMillisMin = millis;
+	}
+	if(millis > roundTripMillisMax) {
+		roundTripMillisMax = millis;
+	}
+	roundTripSamples++;
+	roundTripMillisTotal 	+= millis;
+	roundTripMillisLast 	= millis;
+}
+
+void NetworkTelemetry::addFrameLag(int frames) {
+	if(enabled == false) {
+		return;
+	}
+	if(frames < 0) {
+		frames = 0;
+	}
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	frameLagBuckets[getBucket(frameLagBucketFrames, frameLagBucketCount - 1, frames)]++;
+	if(frames > frameLagMax) {
+		frameLagMax = frames;
+	}
+	frameLagSamples++;
+	frameLagLast = frames;
+}
+
+void NetworkTelemetry::addWait(int64 micros) {
+	if(enabled == false) {
+		return;
+	}
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	waitSamples++;
+	waitMicrosTotal += micros;
+	if(micros > waitMicrosMax) {
+		waitMicrosMax = micros;
+	}
+}
+
+void NetworkTelemetry::setReadyWait(int64 millis) {
+	if(enabled == false) {
+		return;
+	}
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	readyWaitMillis = millis;
+}
+
+static string getHistogramJSON(const int limits[], const uint64 counts[], int bucketCount) {
+	string result = "\"limits\": [";
+	for(int index = 0; index < bucketCount - 1; ++index) {
+		result += (index > 0 ? ", " : "") + intToStr(limits[index]);
+	}
+	result += "], \"counts\": [";
+	for(int index = 0; index < bucketCount; ++index) {
+		result += (index > 0 ? ", " : "") + uIntToStr(counts[index]);
+	}
+	result += "]";
+	return result;
+}
+
+string NetworkTelemetry::getJSONFields(const string &indent) const {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+
+	string result;
+	for(int direction = 0; direction < 2; ++direction) {
+		const MessageCounter *counters = (direction == 0 ? sent : received);
+		result += indent + (direction == 0 ? "\"sent\": {" : "\"received\": {");
+
+		bool first = true;
+		for(int type = 0; type < nmtCount; ++type) {
+			if(counters[type].count == 0) {
+				continue;
+			}
+			result += string(first ? "\n" : ",\n") + indent + "\t\"" + getMessageTypeName(type) + "\": { \"count\": " +
+					  uIntToStr(counters[type].count) + ", \"bytes\": " + uIntToStr(counters[type].bytes) + " }";
+			first = false;
+		}
+		result += (first ? "" : "\n" + indent) + "},\n";
+	}
+
+	result += indent + "\"roundTripMillis\": { \"samples\": " + uIntToStr(roundTripSamples) +
+			  ", \"last\": " + intToStr(roundTripMillisLast) +
+			  ", \"min\": " + intToStr(roundTripMillisMin) +
+			  ", \"avg\": " + intToStr(roundTripSamples > 0 ? roundTripMillisTotal / (int64)roundTripSamples : 0) +
+			  ", \"max\": " + intToStr(roundTripMillisMax) + ", " +
+			  getHistogramJSON(roundTripBucketMillis, roundTripBuckets, roundTripBucketCount) + " },\n";
+
+	result += indent + "\"frameLag\": { \"samples\": " + uIntToStr(frameLagSamples) +
+			  ", \"last\": " + intToStr(frameLagLast) +
+			  ", \"max\": " + intToStr(frameLagMax) + ", " +
+			  getHistogramJSON(frameLagBucketFrames, frameLagBuckets, frameLagBucketCount) + " },\n";
+
+	result += indent + "\"wait\": { \"samples\": " + uIntToStr(waitSamples) +
+			  ", \"totalMicros\": " + intToStr(waitMicrosTotal) +
+			  ", \"avgMicros\": " + intToStr(waitSamples > 0 ? waitMicrosTotal / (int64)waitSamples : 0) +
+			  ", \"maxMicros\": " + intToStr(waitMicrosMax) +
+			  ", \"readyWaitMillis\": " + intToStr(readyWaitMillis) + " }";
+	return result;
+}
+
+// =====================================================
+//	class NetworkWaitStats
+// =====================================================
+
+NetworkWaitStats::NetworkWaitStats() {
+	lastFrameMicros 	= 0;
+	intervalMicrosTotal = 0;
+	intervalMicrosMax 	= 0;
+	intervalFrames 		= 0;
+	intervalStartTime 	= 0;
+	averageMicros 		= 0;
+	maxMicros 			= 0;
+	averageFrames 		= 0;
+}
+
+bool NetworkWaitStats::add(int64 waitMicros, time_t now) {
+	lastFrameMicros = waitMicros;
+	intervalMicrosTotal += waitMicros;
+	if(waitMicros > intervalMicrosMax) {
+		intervalMicrosMax = waitMicros;
+	}
+	intervalFrames++;
+
+	if(intervalStartTime == 0) {
+		intervalStartTime = now;
+		return false;
+	}
+	if(difftime((long int)now,intervalStartTime) < 1) {
+		return false;
+	}
+	averageMicros 	= intervalMicrosTotal / intervalFrames;
+	maxMicros 		= intervalMicrosMax;
+	averageFrames 	= intervalFrames;
+
+	intervalMicrosTotal = 0;
+	intervalMicrosMax 	= 0;
+	intervalFrames 		= 0;
+	intervalStartTime 	= now;
+	return true;
+}
+
+string NetworkWaitStats::toString() const {
+	char szBuf[8096]="";
+	snprintf(szBuf,8096,"last: %lld us avg: %lld us max: %lld us",
+			(long long int)lastFrameMicros,(long long int)averageMicros,(long long int)maxMicros);
+	return szBuf;
+}
+
+}}//end namespace
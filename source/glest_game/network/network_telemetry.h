@@ -0,0 +1,150 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_NETWORKTELEMETRY_H_
+#define _GLEST_GAME_NETWORKTELEMETRY_H_
+
+#include <string>
+#include <time.h>
+#include "network_message.h"
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::string;
+using Shared::Platform::int64;
+using Shared::Platform::uint64;
+using Shared::Platform::Mutex;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+//	class NetworkTelemetry
+//
+///	Message, round trip, frame lag and wait counters of
+/// one peer, written out as JSON for monitoring
+// =====================================================
+
+class NetworkTelemetry {
+public:
+	static const int roundTripBucketCount	= 8;
+	static const int frameLagBucketCount	= 8;
+
+private:
+	class MessageCounter {
+	public:
+		uint64 count;
+		uint64 bytes;
+	};
+
+	// upper bounds, the last bucket takes everything above
+	static const int roundTripBucketMillis[roundTripBucketCount - 1];
+	static const int frameLagBucketFrames[frameLagBucketCount - 1];
+
+	static bool enabled;
+
+	Mutex *mutex;
+
+	MessageCounter sent[nmtCount];
+	MessageCounter received[nmtCount];
+
+	// ping time and local ticks of the last ping we sent, an echo of it
+	// gives the round trip
+	int64 pendingPingTime;
+	uint64 pendingPingTicks;
+	uint64 roundTripBuckets[roundTripBucketCount];
+	uint64 roundTripSamples;
+	int64 roundTripMillisTotal;
+	int64 roundTripMillisMin;
+	int64 roundTripMillisMax;
+	int64 roundTripMillisLast;
+
+	uint64 frameLagBuckets[frameLagBucketCount];
+	uint64 frameLagSamples;
+	int frameLagMax;
+	int frameLagLast;
+
+	uint64 waitSamples;
+	int64 waitMicrosTotal;
+	int64 waitMicrosMax;
+	int64 readyWaitMillis;
+
+	static int getBucket(const int limits[], int limitCount, int64 value);
+
+	// not copyable, owns its mutex
+	NetworkTelemetry(const NetworkTelemetry& obj);
+	NetworkTelemetry & operator=(const NetworkTelemetry& obj);
+
+public:
+	NetworkTelemetry();
+	~NetworkTelemetry();
+
+	// nothing is counted while disabled, so the hooks cost one check
+	static void setEnabled(bool value)	{ enabled = value; }
+	static bool isEnabled()				{ return enabled; }
+
+	static const char * getMessageTypeName(int type);
+	static string escapeJSON(const string &value);
+	// true once every intervalSeconds
+	static bool isWriteDue(time_t &lastWriteTime, int intervalSeconds);
+	// replaces the file in one step so readers never see half a document
+	static bool writeFile(const string &file, const string &json);
+
+	void reset();
+
+	void addSent(int type, int64 bytes);
+	void addReceived(int type, int64 bytes);
+	void addPingSent(int64 pingTime);
+	void addPingEcho(int64 pingTime);
+	void addFrameLag(int frames);
+	void addWait(int64 micros);
+	void setReadyWait(int64 millis);
+
+	// the counters as the body of a JSON object, without braces
+	string getJSONFields(const string &indent) const;
+};
+
+// =====================================================
+//	class NetworkWaitStats
+//
+///	Time the game thread blocked on the server per frame,
+/// averaged over intervals of one second
+// =====================================================
+
+class NetworkWaitStats {
+private:
+	int64 lastFrameMicros;
+	int64 intervalMicrosTotal;
+	int64 intervalMicrosMax;
+	int intervalFrames;
+	time_t intervalStartTime;
+
+	int64 averageMicros;
+	int64 maxMicros;
+	int averageFrames;
+
+public:
+	NetworkWaitStats();
+
+	// true when the wait closed an interval and the average and max
+	// were updated
+	bool add(int64 waitMicros, time_t now);
+
+	int64 getLastFrameMicros() const	{ return lastFrameMicros; }
+	int64 getAverageMicros() const		{ return averageMicros; }
+	int64 getMaxMicros() const			{ return maxMicros; }
+	int getAverageFrames() const		{ return averageFrames; }
+
+	string toString() const;
+};
+
+}}//end namespace
+
+#endif
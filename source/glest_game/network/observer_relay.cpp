@@ -0,0 +1,381 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "observer_relay.h"
+
+#include <algorithm>
+#include "platform_util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+using namespace Shared::Util;
+
+namespace Glest{ namespace Game{
+
+const int ObserverRelay::flushMilliseconds			= 50;
+const int ObserverRelay::maxBatchesPerFlush			= 4;
+const int ObserverRelay::maxBatchWaitMilliseconds	= 1000;
+
+// =====================================================
+//	class ObserverRelay
+// =====================================================
+
+ObserverRelay::ObserverRelay(ObserverRelaySink *sink, int delayKeyframes, int batchKeyframes, int maxBacklogKeyframes) {
+	this->sink					= sink;
+	this->delayKeyframes		= max(delayKeyframes, 0);
+	this->batchKeyframes		= max(batchKeyframes, 1);
+	this->maxBacklogKeyframes	= max(maxBacklogKeyframes, this->batchKeyframes);
+
+	relayAccessor	= new Mutex(CODE_AT_LINE);
+	writeAccessor	= new Mutex(CODE_AT_LINE);
+	trimmedCount	= 0;
+	receivedCount	= 0;
+	finishing		= false;
+	flushThread		= NULL;
+}
+
+ObserverRelay::~ObserverRelay() {
+	if(flushThread != NULL) {
+		time_t elapsed = time(NULL);
+		flushThread->signalQuit();
+		for(;flushThread->canShutdown(false) == false &&
+			difftime((long int)time(NULL),elapsed) <= 15;) {
+			//sleep(150);
+		}
+		if(flushThread->canShutdown(true)) {
+			delete flushThread;
+		}
+		flushThread = NULL;
+	}
+
+	delete writeAccessor;
+	writeAccessor = NULL;
+	delete relayAccessor;
+	relayAccessor = NULL;
+}
+
+void ObserverRelay::start() {
+	if(flushThread == NULL) {
+		static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+		flushThread = new SimpleTaskThread(this,0,flushMilliseconds);
+		flushThread->setUniqueID(mutexOwnerId);
+		flushThread->start();
+	}
+}
+
+void ObserverRelay::addTarget(int slotIndex) {
+	MutexSafeWrapper safeMutex(relayAccessor,CODE_AT_LINE);
+	if(targets.find(slotIndex) == targets.end()) {
+		targets[slotIndex] = trimmedCount;
+	}
+}
+
+void ObserverRelay::removeTarget(int slotIndex) {
+	MutexSafeWrapper safeMutexWrite(writeAccessor,CODE_AT_LINE);
+	MutexSafeWrapper safeMutex(relayAccessor,CODE_AT_LINE);
+	targets.erase(slotIndex);
+}
+
+bool ObserverRelay::hasTarget(int slotIndex) {
+	MutexSafeWrapper safeMutex(relayAccessor,CODE_AT_LINE);
+	return (targets.find(slotIndex) != targets.end());
+}
+
+int ObserverRelay::getTargetCount() {
+	MutexSafeWrapper safeMutex(relayAccessor,CODE_AT_LINE);
+	return (int)targets.size();
+}
+
+void ObserverRelay::addCommandList(const NetworkMessageCommandList &commandList) {
+	MutexSafeWrapper safeMutex(relayAccessor,CODE_AT_LINE);
+	keyframes.push_back(commandList);
+	keyframeMillis.push_back(Chrono::getCurMillis());
+	receivedCount++;
+}
+
+void ObserverRelay::finish() {
+	vector<int> slotIndexes;
+	{
+		MutexSafeWrapper safeMutex(relayAccessor,CODE_AT_LINE);
+		finishing = true;
+		for(map<int,int64>::iterator iterMap = targets.begin(); iterMap != targets.end(); ++iterMap) {
+			slotIndexes.push_back(iterMap->first);
+		}
+	}
+
+	// a target that has to go is dropped by the relay thread on its next flush
+	for(unsigned int index = 0; index < slotIndexes.size(); ++index) {
+		flushTarget(slotIndexes[index]);
+	}
+}
+
+// Sends the due keyframes of one target, returns false when
+// the target has to be dropped
+bool ObserverRelay::flushTarget(int slotIndex) {
+	MutexSafeWrapper safeMutexWrite(writeAccessor,CODE_AT_LINE);
+	for(int batch = 0; batch < maxBatchesPerFlush; ++batch) {
+		vector<NetworkMessageCommandList> commandLists;
+		bool finishingNow = false;
+		{
+			MutexSafeWrapper safeMutex(relayAccessor,CODE_AT_LINE);
+			map<int,int64>::iterator iterFind = targets.find(slotIndex);
+			if(iterFind == targets.end()) {
+				return true;
+			}
+			int64 sentCount = iterFind->second;
+			if(receivedCount - sentCount > delayKeyframes + maxBacklogKeyframes) {
+				return false;
+			}
+
+			finishingNow = finishing;
+			int64 dueCount = receivedCount - sentCount - (finishingNow == true ? 0 : delayKeyframes);
+			int64 sendCount = 0;
+			if(finishingNow == true || dueCount >= batchKeyframes) {
+				sendCount = min(dueCount, (finishingNow == true ? dueCount : (int64)batchKeyframes));
+			}
+			else if(dueCount > 0) {
+				// the oldest due keyframe became due when the keyframe
+				// delayKeyframes after it arrived
+				int64 dueMillis = keyframeMillis[sentCount + delayKeyframes - trimmedCount];
+				if(Chrono::getCurMillis() - dueMillis >= maxBatchWaitMilliseconds) {
+					sendCount = dueCount;
+				}
+			}
+			if(sendCount > 0) {
+				deque<NetworkMessageCommandList>::iterator iterFirst = keyframes.begin() + (sentCount - trimmedCount);
+				commandLists.assign(iterFirst, iterFirst + sendCount);
+			}
+		}
+
+		// called with nothing due as well, to push out what the target still has queued
+		ObserverRelayResult result = sink->relayCommandLists(slotIndex, commandLists, finishingNow);
+		if(result == orrGone) {
+			return false;
+		}
+		else if(result == orrBusy || commandLists.empty() == true) {
+			return true;
+		}
+
+		MutexSafeWrapper safeMutex(relayAccessor,CODE_AT_LINE);
+		map<int,int64>::iterator iterFind = targets.find(slotIndex);
+		if(iterFind != targets.end()) {
+			iterFind->second += commandLists.size();
+		}
+	}
+	return true;
+}
+
+void ObserverRelay::trimKeyframes() {
+	MutexSafeWrapper safeMutex(relayAccessor,CODE_AT_LINE);
+	int64 keepFrom = receivedCount;
+	for(map<int,int64>::iterator iterMap = targets.begin(); iterMap != targets.end(); ++iterMap) {
+		keepFrom = min(keepFrom, iterMap->second);
+	}
+	for(; trimmedCount < keepFrom; ++trimmedCount) {
+		keyframes.pop_front();
+		keyframeMillis.pop_front();
+	}
+}
+
+void ObserverRelay::simpleTask(BaseThread *callingThread,void *userdata) {
+	vector<int> slotIndexes;
+	{
+		MutexSafeWrapper safeMutex(relayAccessor,CODE_AT_LINE);
+		for(map<int,int64>::iterator iterMap = targets.begin(); iterMap != targets.end(); ++iterMap) {
+			slotIndexes.push_back(iterMap->first);
+		}
+	}
+
+	for(unsigned int index = 0; index < slotIndexes.size() &&
+		callingThread->getQuitStatus() == false; ++index) {
+		int slotIndex = slotIndexes[index];
+		if(flushTarget(slotIndex) == false) {
+			if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] dropping observer in slot %d, too far behind or gone\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,slotIndex);
+
+			removeTarget(slotIndex);
+			sink->dropRelayTarget(slotIndex);
+		}
+	}
+
+	trimKeyframes();
+}
+
+// =====================================================
+//	class ObserverRelayChain
+// =====================================================
+
+const int ObserverRelayChain::flushMilliseconds	= 50;
+const int ObserverRelayChain::maxChunkBytes		= 64 * 1024;
+
+ObserverRelayChain::ObserverRelayChain(int port, int maxObservers, int maxStreamMegabytes) : listenSocket(true) {
+	this->maxObservers	= max(maxObservers, 1);
+	maxStreamBytes		= (size_t)max(maxStreamMegabytes, 1) * 1024 * 1024;
+	streamAccessor		= new Mutex(CODE_AT_LINE);
+	trimmedBytes		= 0;
+	flushThread			= NULL;
+
+	listenSocket.setBlock(false);
+	listenSocket.setBindPort(port);
+	listenSocket.listen(this->maxObservers);
+}
+
+ObserverRelayChain::~ObserverRelayChain() {
+	if(flushThread != NULL) {
+		time_t elapsed = time(NULL);
+		flushThread->signalQuit();
+		for(;flushThread->canShutdown(false) == false &&
+			difftime((long int)time(NULL),elapsed) <= 15;) {
+			//sleep(150);
+		}
+		if(flushThread->canShutdown(true)) {
+			delete flushThread;
+		}
+		flushThread = NULL;
+	}
+
+	for(unsigned int index = 0; index < observers.size(); ++index) {
+		delete observers[index].first;
+	}
+	observers.clear();
+
+	delete streamAccessor;
+	streamAccessor = NULL;
+}
+
+void ObserverRelayChain::start() {
+	if(flushThread == NULL) {
+		static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+		flushThread = new SimpleTaskThread(this,0,flushMilliseconds);
+		flushThread->setUniqueID(mutexOwnerId);
+		flushThread->start();
+	}
+}
+
+int ObserverRelayChain::getObserverCount() {
+	MutexSafeWrapper safeMutex(streamAccessor,CODE_AT_LINE);
+	return (int)observers.size();
+}
+
+void ObserverRelayChain::socketDataReceived(const void *data, int dataSize) {
+	const char *dataBuf = static_cast<const char *>(data);
+	MutexSafeWrapper safeMutex(streamAccessor,CODE_AT_LINE);
+	stream.insert(stream.end(), dataBuf, dataBuf + dataSize);
+}
+
+void ObserverRelayChain::acceptObservers() {
+	for(Socket *socket = listenSocket.accept(false); socket != NULL;
+		socket = listenSocket.accept(false)) {
+		MutexSafeWrapper safeMutex(streamAccessor,CODE_AT_LINE);
+		if((int)observers.size() >= maxObservers || trimmedBytes > 0) {
+			if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] chained observer from [%s] refused, observers: %d start of stream gone: %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,socket->getIpAddress().c_str(),(int)observers.size(),(trimmedBytes > 0));
+
+			safeMutex.ReleaseLock();
+			delete socket;
+			continue;
+		}
+
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] chained observer connected from [%s], %d bytes to catch up\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,socket->getIpAddress().c_str(),(int)stream.size());
+
+		socket->setBlock(false);
+		socket->enableSendQueue();
+		observers.push_back(make_pair(socket, (int64)0));
+	}
+}
+
+// Reads and drops what the observer sent and hands it the next part of
+// the stream, returns false once the observer is gone
+bool ObserverRelayChain::flushObserver(Socket *socket, int64 &sentBytes) {
+	char discardBuffer[4096];
+	while(socket->isConnected() == true && socket->hasDataToRead() == true) {
+		if(socket->receive(discardBuffer, sizeof(discardBuffer), false) <= 0) {
+			return false;
+		}
+	}
+	if(socket->isConnected() == false || socket->flushSendQueue() == false) {
+		return false;
+	}
+
+	// one chunk at a time keeps a slow observer's queue small, the stream
+	// is only locked for the copy so the client is never held up
+	MutexSafeWrapper safeMutex(streamAccessor,CODE_AT_LINE);
+	size_t streamPos = (size_t)(sentBytes - trimmedBytes);
+	if(socket->getSendQueueSize() > 0 || streamPos >= stream.size()) {
+		return true;
+	}
+	int chunkBytes = (int)min(stream.size() - streamPos, (size_t)maxChunkBytes);
+	if(socket->send(&stream[streamPos], chunkBytes) != chunkBytes) {
+		return false;
+	}
+	sentBytes += chunkBytes;
+	return true;
+}
+
+// Once the stream outgrew its limit, drops observers more than half the
+// limit behind and the bytes every remaining observer already got. Each
+// trim leaves at most half the limit so the copies stay rare.
+void ObserverRelayChain::trimStream() {
+	MutexSafeWrapper safeMutex(streamAccessor,CODE_AT_LINE);
+	if(stream.size() <= maxStreamBytes) {
+		return;
+	}
+	if(trimmedBytes == 0) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] observer relay chain stream passed %d bytes, no more chained observers are accepted\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,(int)maxStreamBytes);
+	}
+
+	const int64 streamEnd = trimmedBytes + (int64)stream.size();
+	int64 keepFrom = streamEnd;
+	vector<Socket *> droppedObservers;
+	for(unsigned int index = 0; index < observers.size();) {
+		if(streamEnd - observers[index].second > (int64)(maxStreamBytes / 2)) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] dropping chained observer, %lld bytes behind\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,(long long int)(streamEnd - observers[index].second));
+
+			droppedObservers.push_back(observers[index].first);
+			observers.erase(observers.begin() + index);
+			continue;
+		}
+		keepFrom = min(keepFrom, observers[index].second);
+		++index;
+	}
+
+	stream.erase(stream.begin(), stream.begin() + (size_t)(keepFrom - trimmedBytes));
+	trimmedBytes = keepFrom;
+	safeMutex.ReleaseLock();
+
+	for(unsigned int index = 0; index < droppedObservers.size(); ++index) {
+		delete droppedObservers[index];
+	}
+}
+
+void ObserverRelayChain::simpleTask(BaseThread *callingThread,void *userdata) {
+	acceptObservers();
+
+	// only this thread changes the observer list
+	for(unsigned int index = 0; index < observers.size() &&
+		callingThread->getQuitStatus() == false;) {
+		if(flushObserver(observers[index].first, observers[index].second) == false) {
+			if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] chained observer disconnected\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
+
+			MutexSafeWrapper safeMutex(streamAccessor,CODE_AT_LINE);
+			Socket *socket = observers[index].first;
+			observers.erase(observers.begin() + index);
+			safeMutex.ReleaseLock();
+
+			delete socket;
+			continue;
+		}
+		++index;
+	}
+
+	trimStream();
+}
+
+}}//end namespace
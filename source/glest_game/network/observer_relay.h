@@ -0,0 +1,181 @@
+// ==============================================================
+//	This file is part of MegaGlest (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_OBSERVERRELAY_H_
+#define _GLEST_GAME_OBSERVERRELAY_H_
+
+#include <deque>
+#include <map>
+#include <vector>
+#include "network_message.h"
+#include "socket.h"
+#include "simple_threads.h"
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::deque;
+using std::map;
+using std::pair;
+using std::vector;
+using Shared::Platform::int64;
+using Shared::Platform::Mutex;
+using Shared::Platform::ServerSocket;
+using Shared::Platform::Socket;
+using Shared::Platform::SocketReceiveTap;
+using Shared::PlatformCommon::BaseThread;
+using Shared::PlatformCommon::SimpleTaskThread;
+using Shared::PlatformCommon::SimpleTaskCallbackInterface;
+
+namespace Glest{ namespace Game{
+
+enum ObserverRelayResult {
+	orrSent,
+	orrBusy,	// nothing new was taken, try again on the next flush
+	orrGone
+};
+
+// =====================================================
+//	class ObserverRelaySink
+//
+///	Writes relayed keyframes to one target, implemented by
+/// the server that owns the connection slots
+// =====================================================
+
+class ObserverRelaySink {
+public:
+	// Hands the command lists to the target without waiting for it, what
+	// the target can't take yet stays queued on its socket. An empty list
+	// only pushes out what is queued. While queued bytes are left nothing
+	// new is taken and orrBusy returned, unless the relay is finishing.
+	virtual ObserverRelayResult relayCommandLists(int slotIndex, vector<NetworkMessageCommandList> &commandLists, bool finishing) = 0;
+	virtual void dropRelayTarget(int slotIndex) = 0;
+
+	virtual ~ObserverRelaySink() {}
+};
+
+// =====================================================
+//	class ObserverRelay
+//
+///	Keeps the keyframes of a running game and feeds them
+/// to observer slots from its own thread, a fixed number
+/// of keyframes behind the players and several at a time.
+/// Observers never hold up the players: a target that
+/// can't take more data is skipped and one that falls too
+/// far behind is dropped.
+// =====================================================
+
+class ObserverRelay : public SimpleTaskCallbackInterface {
+private:
+	static const int flushMilliseconds;
+	static const int maxBatchesPerFlush;
+	// a batch that isn't full goes out once its oldest keyframe waited this long
+	static const int maxBatchWaitMilliseconds;
+
+	ObserverRelaySink *sink;
+	int delayKeyframes;
+	int batchKeyframes;
+	int maxBacklogKeyframes;
+
+	Mutex *relayAccessor;
+	deque<NetworkMessageCommandList> keyframes;
+	// when each held keyframe arrived
+	deque<int64> keyframeMillis;
+	// number of keyframes trimmed from the front of the buffer
+	int64 trimmedCount;
+	int64 receivedCount;
+	// keyframes already sent, by slot index
+	map<int,int64> targets;
+	bool finishing;
+
+	// Held while a target is written to, removeTarget waits for it so
+	// the owner of a target can't go away under a write
+	Mutex *writeAccessor;
+
+	SimpleTaskThread *flushThread;
+
+	bool flushTarget(int slotIndex);
+	void trimKeyframes();
+
+public:
+	ObserverRelay(ObserverRelaySink *sink, int delayKeyframes, int batchKeyframes, int maxBacklogKeyframes);
+	virtual ~ObserverRelay();
+
+	void start();
+
+	// a new target starts with the oldest keyframe still held
+	void addTarget(int slotIndex);
+	void removeTarget(int slotIndex);
+	bool hasTarget(int slotIndex);
+	int getTargetCount();
+
+	int getDelayKeyframes() const	{ return delayKeyframes; }
+
+	void addCommandList(const NetworkMessageCommandList &commandList);
+
+	// Hands every held keyframe to the targets right away, the game is
+	// over so nothing is held back for the delay or a full batch anymore
+	void finish();
+
+	virtual void simpleTask(BaseThread *callingThread,void *userdata);
+};
+
+// =====================================================
+//	class ObserverRelayChain
+//
+///	Passes the stream a client gets from its server on to
+/// observers connected to this process, so a second
+/// MegaGlest process can relay a game. Downstream observers
+/// get the stream from the first byte, going through the
+/// same intro, launch and keyframes this client did, so the
+/// start is kept until the stream outgrows its limit. From
+/// then on no more observers are accepted and only the part
+/// the slowest observer still needs is held, an observer
+/// falling further behind than half the limit is dropped.
+/// What they send is dropped.
+// =====================================================
+
+class ObserverRelayChain : public SocketReceiveTap, public SimpleTaskCallbackInterface {
+private:
+	static const int flushMilliseconds;
+	// bytes handed to a downstream socket at a time
+	static const int maxChunkBytes;
+
+	ServerSocket listenSocket;
+	int maxObservers;
+	size_t maxStreamBytes;
+
+	Mutex *streamAccessor;
+	vector<char> stream;
+	// bytes trimmed from the front of the stream
+	int64 trimmedBytes;
+	// downstream sockets and how much of the stream each was sent
+	vector<pair<Socket *,int64> > observers;
+
+	SimpleTaskThread *flushThread;
+
+	void acceptObservers();
+	bool flushObserver(Socket *socket, int64 &sentBytes);
+	void trimStream();
+
+public:
+	ObserverRelayChain(int port, int maxObservers, int maxStreamMegabytes);
+	virtual ~ObserverRelayChain();
+
+	void start();
+	int getObserverCount();
+
+	virtual void socketDataReceived(const void *data, int dataSize);
+	virtual void simpleTask(BaseThread *callingThread,void *userdata);
+};
+
+}}//end namespace
+
+#endif
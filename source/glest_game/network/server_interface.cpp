@@ -25,6 +25,7 @@
 #include "miniftpserver.h"
 #include "map_preview.h"
 #include "stats.h"
+#include "sim_benchmark.h"
 #include <time.h>
 #include <set>
 #include <iostream>
@@ -55,6 +56,28 @@ const int MASTERSERVER_HEARTBEAT_GAME_STATUS_SECONDS 		= 30;
 
 const int MAX_EMPTY_NETWORK_COMMAND_LIST_BROADCAST_INTERVAL_MILLISECONDS = 4000;
 
+// Keeps the slot send batches open for the lifetime of the object so that
+// an exception can not leave a batch unsent
+class SlotSendBatchSafeWrapper {
+protected:
+	ServerInterface *serverInterface;
+
+public:
+	explicit SlotSendBatchSafeWrapper(ServerInterface *serverInterface) {
+		this->serverInterface = serverInterface;
+		this->serverInterface->beginSlotSendBatches();
+	}
+	~SlotSendBatchSafeWrapper() {
+		// may run while an exception unwinds, so nothing can leave here
+		try {
+			this->serverInterface->endSlotSendBatches();
+		}
+		catch(const exception &ex) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
+		}
+	}
+};
+
 ServerInterface::ServerInterface(bool publishEnabled, ClientLagCallbackInterface *clientLagCallbackInterface) : GameNetworkInterface() {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
@@ -91,6 +114,13 @@ ServerInterface::ServerInterface(bool publishEnabled, ClientLagCallbackInterface
 	lastGlobalLagCheckTime			= 0;
 	masterserverAdminRequestLaunch	= false;
 	lastListenerSlotCheckTime		= 0;
+	lastNetworkTelemetryPingTime	= 0;
+	lastNetworkTelemetryWriteTime	= 0;
+	slotReactorThread				= NULL;
+	observerRelayAccessor			= new Mutex(CODE_AT_LINE);
+	observerRelay					= NULL;
+	useSocketReactor				= (Config::getInstance().getBool("EnableSocketReactor","false") == true &&
+									   SocketReactor::isSupported() == true);
 
 	// This is an admin port listening only on the localhost intended to
 	// give current connection status info
@@ -129,6 +159,22 @@ ServerInterface::ServerInterface(bool publishEnabled, ClientLagCallbackInterface
 	serverSocket.setBlock(false);
 	serverSocket.setBindPort(Config::getInstance().getInt("PortServer", intToStr(GameConstants::serverPort).c_str()));
 
+	if(useSocketReactor == true) {
+		static string mutexOwnerId = string(extractFileFromDirectoryPath(__FILE__).c_str()) + string("_") + intToStr(__LINE__);
+		slotReactorThread = new ConnectionSlotReactorThread(this);
+		slotReactorThread->setUniqueID(mutexOwnerId);
+		if(slotReactorThread->init() == true) {
+			slotReactorThread->start();
+		}
+		else {
+			// Fall back to a thread per slot
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] socket reactor could not be created\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
+			delete slotReactorThread;
+			slotReactorThread = NULL;
+			useSocketReactor = false;
+		}
+	}
+
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	gameStatsThreadAccessor 	= new Mutex(CODE_AT_LINE);
@@ -276,12 +322,107 @@ void ServerInterface::shutdownMasterserverPublishThread() {
 	}
 }
 
+void ServerInterface::startObserverRelay() {
+	shutdownObserverRelay();
+	if(Config::getInstance().getBool("ObserverRelay","false") == false) {
+		return;
+	}
+
+	ObserverRelay *relay = new ObserverRelay(this,
+			Config::getInstance().getInt("ObserverRelayDelayKeyframes","10"),
+			Config::getInstance().getInt("ObserverRelayBatchKeyframes","4"),
+			Config::getInstance().getInt("ObserverRelayMaxBacklogKeyframes","600"));
+
+	const string observerSlotName = formatString(GameConstants::OBSERVER_SLOTNAME);
+	for(int startIndex = 0; startIndex < GameConstants::maxPlayers; ++startIndex) {
+		int factionIndex = gameSettings.getFactionIndexForStartLocation(startIndex);
+		if(factionIndex < 0 || gameSettings.getFactionTypeName(factionIndex) != observerSlotName) {
+			continue;
+		}
+		MutexSafeWrapper safeMutexSlot(slotAccessorMutexes[startIndex],CODE_AT_LINE_X(startIndex));
+		ConnectionSlot *connectionSlot = slots[startIndex];
+		Socket *socket = (connectionSlot != NULL ? connectionSlot->getSocket(true) : NULL);
+		if(socket != NULL && connectionSlot->isConnected() == true) {
+			// nothing sent to an observer may wait on it, not even pings or text
+			socket->enableSendQueue();
+			relay->addTarget(startIndex);
+		}
+	}
+
+	if(relay->getTargetCount() == 0) {
+		delete relay;
+		return;
+	}
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] relaying to %d observers, %d keyframes behind\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,relay->getTargetCount(),relay->getDelayKeyframes());
+
+	relay->start();
+	MutexSafeWrapper safeMutex(observerRelayAccessor,CODE_AT_LINE);
+	observerRelay = relay;
+}
+
+void ServerInterface::shutdownObserverRelay() {
+	MutexSafeWrapper safeMutex(observerRelayAccessor,CODE_AT_LINE);
+	ObserverRelay *relay = observerRelay;
+	observerRelay = NULL;
+	safeMutex.ReleaseLock();
+
+	delete relay;
+}
+
+bool ServerInterface::isObserverRelayTarget(int slotIndex) {
+	MutexSafeWrapper safeMutex(observerRelayAccessor,CODE_AT_LINE);
+	return (observerRelay != NULL && observerRelay->hasTarget(slotIndex) == true);
+}
+
+// Waits for a write to the slot in progress, so the slot can go after this
+void ServerInterface::removeObserverRelayTarget(int slotIndex) {
+	MutexSafeWrapper safeMutex(observerRelayAccessor,CODE_AT_LINE);
+	if(observerRelay != NULL) {
+		observerRelay->removeTarget(slotIndex);
+	}
+}
+
+// Called from the relay thread without the slot lock, the slot stays
+// because removeSlot and addSlot remove the target before it goes
+ObserverRelayResult ServerInterface::relayCommandLists(int slotIndex, vector<NetworkMessageCommandList> &commandLists, bool finishing) {
+	ConnectionSlot *connectionSlot = slots[slotIndex];
+	if(exitServer == true || connectionSlot == NULL) {
+		return orrGone;
+	}
+	return connectionSlot->relayMessages(commandLists, finishing);
+}
+
+void ServerInterface::dropRelayTarget(int slotIndex) {
+	MutexSafeWrapper safeMutexSlot(slotAccessorMutexes[slotIndex],CODE_AT_LINE_X(slotIndex));
+	ConnectionSlot *connectionSlot = slots[slotIndex];
+	if(connectionSlot != NULL && connectionSlot->isConnected() == true) {
+		connectionSlot->close();
+	}
+}
+
 ServerInterface::~ServerInterface() {
 	//printf("===> Destructor for ServerInterface\n");
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	masterController.clearSlaves(true);
 	exitServer = true;
+
+	// The relay writes to slots from its own thread
+	shutdownObserverRelay();
+
+	// The reactor updates slots so it has to be gone before they are
+	if(slotReactorThread != NULL) {
+		slotReactorThread->signalQuit();
+		if(slotReactorThread->shutdownAndWait() == true) {
+			delete slotReactorThread;
+		}
+		else {
+			slotReactorThread->setDeleteSelfOnExecutionDone(true);
+			slotReactorThread->setDeleteAfterExecute(true);
+		}
+		slotReactorThread = NULL;
+	}
+
 	for(int index = 0; index < GameConstants::maxPlayers; ++index) {
 		if(slots[index] != NULL) {
 			MutexSafeWrapper safeMutex(slotAccessorMutexes[index],CODE_AT_LINE_X(index));
@@ -319,6 +460,9 @@ ServerInterface::~ServerInterface() {
 	delete inBroadcastMessageThreadAccessor;
 	inBroadcastMessageThreadAccessor = NULL;
 
+	delete observerRelayAccessor;
+	observerRelayAccessor = NULL;
+
 	delete serverSynchAccessor;
 	serverSynchAccessor = NULL;
 
@@ -464,6 +608,7 @@ void ServerInterface::addSlot(int playerIndex) {
 
 	ConnectionSlot *slot = slots[playerIndex];
 	if(slot != NULL) {
+		removeObserverRelayTarget(playerIndex);
 		slots[playerIndex] = NULL;
 	}
 	slots[playerIndex] = new ConnectionSlot(this, playerIndex);
@@ -533,6 +678,7 @@ void ServerInterface::removeSlot(int playerIndex, int lockedSlotIndex) {
 	}
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] playerIndex = %d, lockedSlotIndex = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,playerIndex,lockedSlotIndex);
 
+	removeObserverRelayTarget(playerIndex);
 	slots[playerIndex]= NULL;
 	safeMutexSlot.ReleaseLock();
 	safeMutex.ReleaseLock();
@@ -705,7 +851,8 @@ std::pair<bool,bool> ServerInterface::clientLagCheck(ConnectionSlot *connectionS
 
 	if(alreadyInLagCheck == true ||
 		(connectionSlot != NULL && (connectionSlot->getSkipLagCheck() == true ||
-		 connectionSlot->getConnectHasHandshaked() == false))) {
+		 connectionSlot->getConnectHasHandshaked() == false ||
+		 isObserverRelayTarget(connectionSlot->getPlayerIndex()) == true))) {
 		return clientLagExceededOrWarned;
 	}
 
@@ -722,6 +869,7 @@ std::pair<bool,bool> ServerInterface::clientLagCheck(ConnectionSlot *connectionS
 				double clientLag 		= this->getCurrentFrameCount() - connectionSlot->getCurrentFrameCount();
 				double clientLagCount 	= (gameSettings.getNetworkFramePeriod() > 0 ? (clientLag / gameSettings.getNetworkFramePeriod()) : 0);
 				connectionSlot->setCurrentLagCount(clientLagCount);
+				connectionSlot->getTelemetry().addFrameLag((int)clientLag);
 
 				double clientLagTime 	= difftime((long int)time(NULL),connectionSlot->getLastReceiveCommandListTime());
 
@@ -904,7 +1052,8 @@ void ServerInterface::signalClientsToRecieveData(std::map<PLATFORM_SOCKET,bool>
 	//printf("====================================In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
 	//printf("Signal clients get new data\n");
-	const bool newThreadManager = Config::getInstance().getBool("EnableNewThreadManager","false");
+	const bool newThreadManager = (Config::getInstance().getBool("EnableNewThreadManager","false") == true &&
+								   useSocketReactor == false);
 	if(newThreadManager == true) {
 		masterController.clearSlaves(true);
 		std::vector<SlaveThreadControllerInterface *> slaveThreadList;
@@ -1009,6 +1158,7 @@ void ServerInterface::checkForCompletedClientsUsingLoop(
 
 	//time_t waitForThreadElapsed = time(NULL);
 	Chrono waitForThreadElapsed(true);
+	uint64 waitStartTicks = (NetworkTelemetry::isEnabled() == true ? SimBenchmark::getTicks() : 0);
 
 	std::map<int, bool> slotsCompleted;
 	for (bool threadsDone = false; exitServer == false && threadsDone == false &&
@@ -1048,6 +1198,9 @@ void ServerInterface::checkForCompletedClientsUsingLoop(
 					}
 					else {
 						slotsCompleted[index] = true;
+						if(waitStartTicks != 0) {
+							connectionSlot->getTelemetry().addWait(SimBenchmark::ticksToMicros(SimBenchmark::getTicks() - waitStartTicks));
+						}
 					}
 				}
 				catch (const exception &ex) {
@@ -1080,7 +1233,8 @@ void ServerInterface::checkForCompletedClients(std::map<int,bool> & mapSlotSigna
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
-	const bool newThreadManager = Config::getInstance().getBool("EnableNewThreadManager","false");
+	const bool newThreadManager = (Config::getInstance().getBool("EnableNewThreadManager","false") == true &&
+								   useSocketReactor == false);
 	if(newThreadManager == true) {
 		checkForCompletedClientsUsingThreadManager(mapSlotSignalledList, errorMsgList);
 	}
@@ -1490,8 +1644,11 @@ void ServerInterface::update() {
 
 		//printf("\nServerInterface::update -- B\n");
 
-		processTextMessageQueue();
-		processBroadCastMessageQueue();
+		{
+			SlotSendBatchSafeWrapper safeSendBatch(this);
+			processTextMessageQueue();
+			processBroadCastMessageQueue();
+		}
 
 		checkForAutoResumeForLaggingClients();
 
@@ -1652,6 +1809,8 @@ void ServerInterface::update() {
 
 		checkListenerSlots();
 
+		updateNetworkTelemetry();
+
 		//printf("START Server update #15\n");
 	}
 	catch(const exception &ex) {
@@ -1694,6 +1853,8 @@ void ServerInterface::updateKeyframe(int frameCount) {
 	}
 
 	try {
+		SlotSendBatchSafeWrapper safeSendBatch(this);
+
 		// Possible cause of out of synch since we have more commands that need
 		// to be sent in this frame
 		if(requestedCommands.empty() == false) {
@@ -1738,6 +1899,12 @@ void ServerInterface::updateKeyframe(int frameCount) {
 				lastBroadcastCommandsTimer.start();
 			}
 			broadcastMessage(&networkMessageCommandList);
+
+			MutexSafeWrapper safeMutexRelay(observerRelayAccessor,CODE_AT_LINE);
+			if(observerRelay != NULL) {
+				observerRelay->addCommandList(networkMessageCommandList);
+			}
+			safeMutexRelay.ReleaseLock();
 		}
 	}
 	catch(const exception &ex) {
@@ -1971,6 +2138,7 @@ void ServerInterface::waitUntilReady(Checksum *checksum) {
 
 							connectionSlot->setReady();
 							connectionSlot->setGameStarted(true);
+							connectionSlot->getTelemetry().setReadyWait(chrono.getMillis());
 						}
 						else if(networkMessageType != nmtInvalid) {
 							string sErr = "Unexpected network message: " + intToStr(networkMessageType);
@@ -2172,6 +2340,51 @@ void ServerInterface::processBroadCastMessageQueue() {
 	}
 }
 
+void ServerInterface::beginSlotSendBatches() {
+	for(int index = 0; index < GameConstants::maxPlayers; ++index) {
+		MutexSafeWrapper safeMutexSlot(slotAccessorMutexes[index],CODE_AT_LINE_X(index));
+		ConnectionSlot *connectionSlot = slots[index];
+		Socket *socket = (connectionSlot != NULL ? connectionSlot->getSocket(true) : NULL);
+		if(socket != NULL) {
+			socket->beginSendBatch();
+		}
+	}
+}
+
+void ServerInterface::endSlotSendBatches() {
+	std::vector<string> errorMsgList;
+	// A slot that lost its socket in between took its batch with it
+	for(int index = 0; index < GameConstants::maxPlayers; ++index) {
+		MutexSafeWrapper safeMutexSlot(slotAccessorMutexes[index],CODE_AT_LINE_X(index));
+		ConnectionSlot *connectionSlot = slots[index];
+		Socket *socket = (connectionSlot != NULL ? connectionSlot->getSocket(true) : NULL);
+		if(socket == NULL || socket->isSendBatchOpen() == false || socket->endSendBatch() == true) {
+			continue;
+		}
+
+		// the same as a failed direct send in broadcastMessage
+		if(socket->isSocketValid() == true) {
+			char szBuf[8096]="";
+			snprintf(szBuf,8096,"Error sending NetworkMessage batch to slot %d",index);
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,szBuf);
+			errorMsgList.push_back(szBuf);
+			connectionSlot->close();
+		}
+		else {
+			if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s] Line: %d socket has been disconnected\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
+		}
+		if(gameHasBeenInitiated == true && connectionSlot->isConnected() == false &&
+			this->getAllowInGameConnections() == false) {
+			removeSlot(index,index);
+		}
+	}
+
+	// sent once the slot locks are released, like the broadcast errors
+	for(unsigned int index = 0; index < errorMsgList.size(); ++index) {
+		sendTextMessage(errorMsgList[index],-1, true, "");
+	}
+}
+
 void ServerInterface::queueBroadcastMessage(NetworkMessage *networkMessage, int excludeSlot) {
 	MutexSafeWrapper safeMutexSlot(broadcastMessageQueueThreadAccessor,CODE_AT_LINE);
 	pair<NetworkMessage*,int> item;
@@ -2264,6 +2477,13 @@ void ServerInterface::sendUnMarkCellMessage(Vec2i targetPos, int factionIndex, i
 void ServerInterface::quitGame(bool userManuallyQuit) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s] Line: %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
+	// observers get the rest of the game before they see the quit
+	MutexSafeWrapper safeMutexRelay(observerRelayAccessor,CODE_AT_LINE);
+	if(observerRelay != NULL) {
+		observerRelay->finish();
+	}
+	safeMutexRelay.ReleaseLock();
+
 	NetworkMessageQuit networkMessageQuit;
 	broadcastMessage(&networkMessageQuit);
 
@@ -2378,6 +2598,8 @@ bool ServerInterface::launchGame(const GameSettings *gameSettings) {
 		NetworkMessageLaunch networkMessageLaunch(gameSettings,nmtLaunch);
 		broadcastMessage(&networkMessageLaunch);
 
+		startObserverRelay();
+
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] needToRepublishToMasterserver = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,needToRepublishToMasterserver);
 
 		shutdownMasterserverPublishThread();
@@ -2527,6 +2749,13 @@ void ServerInterface::broadcastMessage(NetworkMessage *networkMessage, int exclu
 	    }
 
 		for(int slotIndex = 0; exitServer == false && slotIndex < GameConstants::maxPlayers; ++slotIndex) {
+			// The relay thread writes the command lists of its targets,
+			// the players never wait for an observer's slot
+			if(networkMessage->getNetworkMessageType() == nmtCommandList &&
+				isObserverRelayTarget(slotIndex) == true) {
+				continue;
+			}
+
 			MutexSafeWrapper safeMutexSlot(NULL,CODE_AT_LINE_X(slotIndex));
 			if(slotIndex != lockedSlotIndex) {
 				if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] i = %d, lockedSlotIndex = %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,slotIndex,lockedSlotIndex);
@@ -3033,6 +3262,50 @@ void ServerInterface::simpleTask(BaseThread *callingThread,void *userdata) {
 	}
 }
 
+void ServerInterface::updateNetworkTelemetry() {
+	if(NetworkTelemetry::isEnabled() == false) {
+		return;
+	}
+	// the lobby pings on its own, in game we keep pinging for round trips
+	if(gameHasBeenInitiated == true &&
+		difftime((long int)time(NULL),lastNetworkTelemetryPingTime) >= GameConstants::networkPingInterval) {
+		lastNetworkTelemetryPingTime = time(NULL);
+		queueBroadcastMessage(new NetworkMessagePing(GameConstants::networkPingInterval,time(NULL)));
+	}
+
+	string telemetryFile = "";
+	if(isNetworkTelemetryWriteDue(lastNetworkTelemetryWriteTime, telemetryFile) == true) {
+		NetworkTelemetry::writeFile(telemetryFile, getNetworkTelemetryJSON());
+	}
+}
+
+std::string ServerInterface::getNetworkTelemetryJSON() const {
+	string result = "{\n";
+	result += "\t\"role\": \"server\",\n";
+	result += "\t\"time\": " + intToStr((int64)time(NULL)) + ",\n";
+	result += "\t\"frame\": " + intToStr(currentFrameCount) + ",\n";
+	result += "\t\"peers\": [";
+
+	bool first = true;
+	for(int slotIndex = 0; exitServer == false && slotIndex < GameConstants::maxPlayers; ++slotIndex) {
+		MutexSafeWrapper safeMutexSlot(slotAccessorMutexes[slotIndex],CODE_AT_LINE_X(slotIndex));
+		ConnectionSlot *slot = slots[slotIndex];
+		if(slot == NULL || slot->isConnected() == false) {
+			continue;
+		}
+		result += string(first ? "\n" : ",\n") + "\t\t{\n";
+		result += "\t\t\t\"slot\": " + intToStr(slotIndex) + ",\n";
+		result += "\t\t\t\"name\": \"" + NetworkTelemetry::escapeJSON(slot->getName()) + "\",\n";
+		result += "\t\t\t\"ip\": \"" + NetworkTelemetry::escapeJSON(slot->getIpAddress()) + "\",\n";
+		result += "\t\t\t\"frame\": " + intToStr(slot->getCurrentFrameCount()) + ",\n";
+		result += slot->getTelemetry().getJSONFields("\t\t\t") + "\n";
+		result += "\t\t}";
+		first = false;
+	}
+	result += (first ? "" : "\n\t") + string("]\n}\n");
+	return result;
+}
+
 std::string ServerInterface::DumpStatsToLog(bool dumpToStringOnly) const {
 	string headlessLogFile = Config::getInstance().getString("HeadlessLogFile","headless.log");
 	if(getGameReadWritePath(GameConstants::path_logs_CacheLookupKey) != "") {
@@ -3103,6 +3376,12 @@ std::string ServerInterface::DumpStatsToLog(bool dumpToStringOnly) const {
 	out << "Total Slot Count: " << connectedSlotCount 	<< std::endl;
 	out << "========================================="  << std::endl;
 
+	if(NetworkTelemetry::isEnabled() == true) {
+		out << "Network telemetry:" << std::endl;
+		out << getNetworkTelemetryJSON();
+		out << "========================================="  << std::endl;
+	}
+
 	std::string result = out.str();
 
 	if(dumpToStringOnly == false) {
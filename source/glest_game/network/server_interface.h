@@ -21,6 +21,7 @@
 #include "game_constants.h"
 #include "network_interface.h"
 #include "connection_slot.h"
+#include "observer_relay.h"
 #include "socket.h"
 #include "leak_dumper.h"
 
@@ -40,7 +41,8 @@ class ServerInterface: public GameNetworkInterface,
                        public ConnectionSlotCallbackInterface,
                        // This is for publishing game status to the masterserver
                        public SimpleTaskCallbackInterface,
-                       public FTPClientValidationInterface {
+                       public FTPClientValidationInterface,
+                       public ObserverRelaySink {
 
 class TextMessageQueue {
 public:
@@ -96,6 +98,12 @@ private:
 	ServerSocket *serverSocketAdmin;
 	MasterSlaveThreadController masterController;
 
+	bool useSocketReactor;
+	ConnectionSlotReactorThread *slotReactorThread;
+
+	Mutex *observerRelayAccessor;
+	ObserverRelay *observerRelay;
+
 	bool gameHasBeenInitiated;
 	int gameSettingsUpdateCount;
 
@@ -105,6 +113,9 @@ private:
 
 	time_t resumeGameStartTime;
 
+	time_t lastNetworkTelemetryPingTime;
+	time_t lastNetworkTelemetryWriteTime;
+
 	Mutex *gameStatsThreadAccessor;
 	Stats *gameStats;
 
@@ -158,10 +169,14 @@ public:
 
     virtual void quitGame(bool userManuallyQuit);
     virtual string getNetworkStatus();
-    ServerSocket *getServerSocket() {
+    virtual ServerSocket *getServerSocket() {
         return &serverSocket;
     }
 
+    bool getUseSocketReactor() const {
+    	return useSocketReactor;
+    }
+
     SwitchSetupRequest **getSwitchSetupRequests();
     SwitchSetupRequest *getSwitchSetupRequests(int index);
     void setSwitchSetupRequests(int index,SwitchSetupRequest *ptr);
@@ -215,6 +230,9 @@ public:
     }
 
     void queueBroadcastMessage(NetworkMessage *networkMessage, int excludeSlot = -1);
+    // Messages sent to a slot between these two go out as one write
+    void beginSlotSendBatches();
+    void endSlotSendBatches();
     virtual string getHumanPlayerName(int index = -1);
     virtual int getHumanPlayerIndex() const;
     bool getNeedToRepublishToMasterserver() const {
@@ -227,7 +245,7 @@ public:
 
     void setPublishEnabled(bool value);
 
-    bool getGameHasBeenInitiated() const {
+    virtual bool getGameHasBeenInitiated() const {
     	return gameHasBeenInitiated;
     }
 
@@ -237,12 +255,20 @@ public:
     }
 
     virtual void simpleTask(BaseThread *callingThread,void *userdata);
+
+    // Observers fed by the relay get command lists late and in batches
+    bool isObserverRelayTarget(int slotIndex);
+    virtual ObserverRelayResult relayCommandLists(int slotIndex, vector<NetworkMessageCommandList> &commandLists, bool finishing);
+    virtual void dropRelayTarget(int slotIndex);
+
     void addClientToServerIPAddress(uint32 clientIp, uint32 ServerIp);
     virtual int isValidClientType(uint32 clientIp);
     virtual int isClientAllowedToGetFile(uint32 clientIp, const char *username, const char *filename);
 
     void notifyBadClientConnectAttempt(string ipAddress);
     std::string DumpStatsToLog(bool dumpToStringOnly) const;
+    // counters of every connected slot, see NetworkTelemetry
+    std::string getNetworkTelemetryJSON() const;
 
     virtual void saveGame(XmlNode *rootNode);
 
@@ -252,6 +278,7 @@ public:
 
 private:
 
+    void updateNetworkTelemetry();
     void broadcastMessageToConnectedClients(NetworkMessage *networkMessage, int excludeSlot = -1);
     bool shouldDiscardNetworkMessage(NetworkMessageType networkMessageType, ConnectionSlot *connectionSlot);
     void updateSlot(ConnectionSlotEvent *event);
@@ -287,6 +314,10 @@ protected:
 
     void shutdownMasterserverPublishThread();
 
+    void startObserverRelay();
+    void shutdownObserverRelay();
+    void removeObserverRelayTarget(int slotIndex);
+
 
 };
 
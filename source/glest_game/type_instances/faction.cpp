@@ -480,6 +480,7 @@ Faction::Faction() {
 
 void Faction::init() {
 	unitsMutex = new Mutex(CODE_AT_LINE);
+	precacheResourceTargetMutex = new Mutex(CODE_AT_LINE);
 	texture = NULL;
 	//lastResourceTargettListPurge = 0;
 	cachingDisabled=false;
@@ -538,6 +539,9 @@ Faction::~Faction() {
 	delete unitsMutex;
 	unitsMutex = NULL;
 
+	delete precacheResourceTargetMutex;
+	precacheResourceTargetMutex = NULL;
+
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 }
 
@@ -753,7 +757,9 @@ void Faction::init(
 		loadGame(loadWorldNode, this->index,game->getGameSettings(),game->getWorld());
 	}
 
-	if( game->getGameSettings()->getPathFinderType() == pfBasic) {
+	// the unit update scheduler replaces the per faction worker threads
+	if( game->getGameSettings()->getPathFinderType() == pfBasic &&
+		World::isUnitUpdateSchedulerEnabled() == false) {
 		if(workerThread != NULL) {
 			workerThread->signalQuit();
 			if(workerThread->shutdownAndWait() == true) {
@@ -1575,7 +1581,18 @@ Vec2i Faction::getClosestResourceTypeTargetFromCache(Unit *unit, const ResourceT
 //				throw megaglest_runtime_error("#1 Invalid access to Faction random from outside main thread current id = " +
 //						intToStr(Thread::getCurrentThreadId()) + " main = " + intToStr(Thread::getMainThreadId()));
 //			}
-			int tryRadius = random.randRange(0,1);
+			int tryRadius = 0;
+			if(frameIndex >= 0) {
+				// Units of this faction are pre-processed on several threads
+				// at once, draw from a generator seeded by the unit so the
+				// result doesn't depend on the thread running it
+				RandomGen precacheRandom;
+				precacheRandom.init(unit->getId() * 7919 + frameIndex);
+				tryRadius = precacheRandom.randRange(0,1);
+			}
+			else {
+				tryRadius = random.randRange(0,1);
+			}
 			//int tryRadius = unit->getRandom(true)->randRange(0,1);
 			//int tryRadius = 0;
 			if(tryRadius == 0) {
@@ -1677,7 +1694,15 @@ Vec2i Faction::getClosestResourceTypeTargetFromCache(Unit *unit, const ResourceT
 					}
 				}
 
-				cleanupResourceTypeTargetCache(&deleteList,frameIndex);
+				if(frameIndex >= 0) {
+					// other units of the faction may be reading the cache now
+					static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+					MutexSafeWrapper safeMutex(precacheResourceTargetMutex,mutexOwnerId);
+					precacheResourceTargetDeleteList.insert(precacheResourceTargetDeleteList.end(),deleteList.begin(),deleteList.end());
+				}
+				else {
+					cleanupResourceTypeTargetCache(&deleteList,frameIndex);
+				}
 			}
 		}
 	}
@@ -1857,6 +1882,21 @@ void Faction::cleanupResourceTypeTargetCache(std::vector<Vec2i> *deleteListPtr,i
 	}
 }
 
+// Called on the main thread once the units are pre-processed, so every
+// lookup of the pass saw the cache as it was before the pass whichever
+// thread ran it.
+void Faction::commitPrecacheResourceTargets() {
+	static string mutexOwnerId = string(__FILE__) + string("_") + intToStr(__LINE__);
+	MutexSafeWrapper safeMutex(precacheResourceTargetMutex,mutexOwnerId);
+	if(precacheResourceTargetDeleteList.empty() == false) {
+		std::vector<Vec2i> deleteList;
+		deleteList.swap(precacheResourceTargetDeleteList);
+		safeMutex.ReleaseLock();
+
+		cleanupResourceTypeTargetCache(&deleteList,-1);
+	}
+}
+
 //std::vector<Vec2i> Faction::findCachedPath(const Vec2i &target, Unit *unit) {
 //	std::vector<Vec2i> result;
 //	if(cachingDisabled == false) {
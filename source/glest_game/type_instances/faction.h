@@ -58,19 +58,6 @@ public:
 	std::map<Vec2i,float> surfPosAlphaList;
 };
 
-class ExploredCellsLookupItem {
-public:
-
-	ExploredCellsLookupItem() {
-		ExploredCellsLookupItemCacheTimerCountIndex = 0;
-	}
-	int ExploredCellsLookupItemCacheTimerCountIndex;
-	std::vector<SurfaceCell *> exploredCellList;
-	std::vector<SurfaceCell *> visibleCellList;
-
-	static time_t lastDebug;
-};
-
 // =====================================================
 // 	class Faction
 //
@@ -160,6 +147,10 @@ private:
 	bool cachingDisabled;
 	std::map<Vec2i,int> cacheResourceTargetList;
 	std::map<Vec2i,bool> cachedCloseResourceTargetLookupList;
+	// stale targets found while the units are pre-processed on several
+	// threads, they are erased from the cache in commitPrecacheResourceTargets
+	Mutex *precacheResourceTargetMutex;
+	std::vector<Vec2i> precacheResourceTargetDeleteList;
 
 	RandomGen random;
 	FactionThread *workerThread;
@@ -346,6 +337,7 @@ public:
 	Vec2i getClosestResourceTypeTargetFromCache(Unit *unit, const ResourceType *type,int frameIndex);
 	Vec2i getClosestResourceTypeTargetFromCache(const Vec2i &pos, const ResourceType *type);
 	void cleanupResourceTypeTargetCache(std::vector<Vec2i> *deleteListPtr,int frameIndex);
+	void commitPrecacheResourceTargets();
 	inline int getCacheResourceTargetListSize() const { return (int)cacheResourceTargetList.size(); }
 
 //	Unit * findClosestUnitWithSkillClass(const Vec2i &pos,const CommandClass &cmdClass,
@@ -33,6 +33,7 @@ Resource::Resource() {
     this->amount= 0;
 	pos= Vec2i(0);
 	balance= 0;
+	crcDirty= true;
 
 	addItemToVault(&this->amount,this->amount);
 	addItemToVault(&this->balance,this->balance);
@@ -43,6 +44,7 @@ void Resource::init(const ResourceType *rt, int amount) {
     this->amount= amount;        
 	pos= Vec2i(0);
 	balance= 0;
+	crcDirty= true;
 
 	addItemToVault(&this->amount,this->amount);
 	addItemToVault(&this->balance,this->balance);
@@ -52,6 +54,7 @@ void Resource::init(const ResourceType *rt, const Vec2i &pos) {
 	this->type=rt;
 	amount=rt->getDefResPerPatch();
 	this->pos= pos;
+	crcDirty= true;
 
 	addItemToVault(&this->amount,this->amount);
 	addItemToVault(&this->balance,this->balance);
@@ -82,18 +85,21 @@ int Resource::getBalance() const {
 void Resource::setAmount(int amount) {
 	checkItemInVault(&this->amount,this->amount);
 	this->amount= amount;
+	crcDirty= true;
 	addItemToVault(&this->amount,this->amount);
 }
 
 void Resource::setBalance(int balance) {
 	checkItemInVault(&this->balance,this->balance);
 	this->balance= balance;
+	crcDirty= true;
 	addItemToVault(&this->balance,this->balance);
 }
 
 bool Resource::decAmount(int i) {
 	checkItemInVault(&this->amount,this->amount);
 	amount -= i;
+	crcDirty= true;
 	addItemToVault(&this->amount,this->amount);
 
     if(amount > 0) {
@@ -126,6 +132,7 @@ void Resource::loadGame(const XmlNode *rootNode, int index,const TechTree *techT
 		type = techTree->getResourceType(resourceNode->getAttribute("type")->getValue());
 		pos = Vec2i::strToVec2(resourceNode->getAttribute("pos")->getValue());
 		balance = resourceNode->getAttribute("balance")->getIntValue();
+		crcDirty = true;
 	}
 }
 
@@ -141,15 +148,19 @@ std::string Resource::toString() const {
 }
 
 Checksum Resource::getCRC() {
-	Checksum crcForResource;
+	if(crcDirty == true) {
+		Checksum crcForResource;
 
-	crcForResource.addInt(amount);
-	crcForResource.addString(type->getName(false));
-	crcForResource.addInt(pos.x);
-	crcForResource.addInt(pos.y);
-	crcForResource.addInt(balance);
+		crcForResource.addInt(amount);
+		crcForResource.addString(type->getName(false));
+		crcForResource.addInt(pos.x);
+		crcForResource.addInt(pos.y);
+		crcForResource.addInt(balance);
 
-	return crcForResource;
+		crc = crcForResource;
+		crcDirty = false;
+	}
+	return crc;
 }
 
 }}//end namespace
@@ -46,6 +46,10 @@ private:
 	Vec2i pos;	
 	int balance;
 
+	// checksum of the values above, recomputed only after they changed
+	bool crcDirty;
+	Checksum crc;
+
 public:
 	Resource();
     void init(const ResourceType *rt, int amount);
@@ -566,6 +566,11 @@ Unit::Unit(int id, UnitPathInterface *unitpath, const Vec2i &pos,
     random.setDisableLastCallerTracking(isNetworkCRCEnabled() == false);
 	pathFindRefreshCellCount = random.randRange(10,20,intToStr(__LINE__));
 
+	sightStampApplied = false;
+	sightStampPos = Vec2i(-1,-1);
+	sightStampRange = -1;
+	sightStampTeam = -1;
+
 	if(map->isInside(pos) == false || map->isInsideSurface(map->toSurfCoords(pos)) == false) {
 		throw megaglest_runtime_error("#2 Invalid path position = " + pos.getString());
 	}
@@ -709,6 +714,11 @@ Unit::~Unit() {
 	renderer.removeUnitFromQuadCache(this);
 	if(game != NULL) {
 		game->removeUnitFromSelection(this);
+
+		if(sightStampApplied == true && game->getWorld() != NULL) {
+			game->getWorld()->retireSightStamp(sightStampTeam, sightStampPos, sightStampRange);
+			sightStampApplied = false;
+		}
 	}
 
 	//MutexSafeWrapper safeMutex1(&mutexDeletedUnits,string(__FILE__) + "_" + intToStr(__LINE__));
@@ -2861,6 +2871,10 @@ bool Unit::update() {
 		else {
 			progress= PROGRESS_SPEED_MULTIPLIER;
 			deadCount++;
+			if(deadCount == 1) {
+				// putrefacting units no longer block their cells
+				map->invalidateMoveCache();
+			}
 			if(deadCount >= maxDeadCount) {
 				toBeUndertaken= true;
 				return_value = false;
@@ -4235,9 +4249,12 @@ void Unit::setMeshPosInParticleSystem(UnitParticleSystem *ups){
 		for(unsigned int i=0; i<model->getMeshCount() ; i++){
 			//printf("meshName=%s\n",unitModel->getMesh(i)->getName().c_str());
 			if(model->getMesh(i)->getName()==meshName){
+				// meshes rendered from VBOs have no vertices left to place the particles on
 				const InterpolationData *data=model->getMesh(i)->getInterpolationData();
-				const Vec3f *verticepos=data->getVertices();
-				ups->setMeshPos(Vec3f(verticepos->x,verticepos->y,verticepos->z));
+				if(data != NULL && data->getVertices() != NULL) {
+					const Vec3f *verticepos=data->getVertices();
+					ups->setMeshPos(Vec3f(verticepos->x,verticepos->y,verticepos->z));
+				}
 				foundMesh=true;
 				break;
 			}
@@ -4469,32 +4486,41 @@ uint32 Unit::getFrameCount() const {
 }
 
 void Unit::exploreCells(bool forceRefresh) {
+	if(game == NULL) {
+		throw megaglest_runtime_error("game == NULL");
+	}
+	else if(game->getWorld() == NULL) {
+		throw megaglest_runtime_error("game->getWorld() == NULL");
+	}
+	World *world = game->getWorld();
+
 	if(this->isOperative() == true) {
 		const Vec2i &newPos = this->getCenteredPos();
 		int sightRange 		= this->getType()->getTotalSight(this->getTotalUpgrade());
 		int teamIndex 		= this->getTeam();
 
-		if(game == NULL) {
-			throw megaglest_runtime_error("game == NULL");
-		}
-		else if(game->getWorld() == NULL) {
-			throw megaglest_runtime_error("game->getWorld() == NULL");
+		// Nothing to do while the unit keeps its cell, sight and team
+		if( !forceRefresh && sightStampApplied == true &&
+			sightStampPos == newPos && sightStampRange == sightRange &&
+			sightStampTeam == teamIndex) {
+			return;
 		}
 
-		// Try the local unit exploration cache
-		if( !forceRefresh &&
-			cacheExploredCellsKey.first == newPos &&
-			cacheExploredCellsKey.second == sightRange) {
-			game->getWorld()->exploreCells(teamIndex, cacheExploredCells);
+		// The old stamp stays until the next fog of war update so the cells
+		// we just left are still visible until then
+		if(sightStampApplied == true) {
+			world->retireSightStamp(sightStampTeam, sightStampPos, sightStampRange);
 		}
-		else {
-			// Try the world exploration scan or possible cache
-			cacheExploredCells = game->getWorld()->exploreCells(newPos, sightRange, teamIndex, this);
+		world->applySightStamp(teamIndex, newPos, sightRange, this);
 
-			// Cache the result for this unit
-			cacheExploredCellsKey.first = newPos;
-			cacheExploredCellsKey.second = sightRange;
-		}
+		sightStampApplied 	= true;
+		sightStampPos 		= newPos;
+		sightStampRange 	= sightRange;
+		sightStampTeam 		= teamIndex;
+	}
+	else if(sightStampApplied == true) {
+		world->retireSightStamp(sightStampTeam, sightStampPos, sightStampRange);
+		sightStampApplied = false;
 	}
 }
 
@@ -4717,10 +4743,6 @@ void Unit::clearCaches() {
 	cachedFow.surfPosAlphaList.clear();
 	cachedFowPos = Vec2i(0,0);
 
-	cacheExploredCells.exploredCellList.clear();
-	cacheExploredCells.visibleCellList.clear();
-	cacheExploredCellsKey.first = Vec2i(-1,-1);
-	cacheExploredCellsKey.second = -1;
 
 	if(unitPath != NULL) {
 		unitPath->clearCaches();
@@ -488,8 +488,11 @@ private:
 	FowAlphaCellsLookupItem cachedFow;
 	Vec2i cachedFowPos;
 
-	ExploredCellsLookupItem cacheExploredCells;
-	std::pair<Vec2i, int> cacheExploredCellsKey;
+	// sight stamp this unit currently holds in the team visibility map
+	bool sightStampApplied;
+	Vec2i sightStampPos;
+	int sightStampRange;
+	int sightStampTeam;
 
 	Vec2i lastHarvestedResourcePos;
 
@@ -20,13 +20,168 @@
 #include "platform_util.h"
 #include "game_util.h"
 #include "conversion.h"
+#include "config.h"
+#include "lang.h"
+#include "sound_file_loader.h"
+#include "work_stealing_scheduler.h"
+#include "common_scoped_ptr.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Util;
 using namespace Shared::Xml;
+using namespace Shared::PlatformCommon;
 
 namespace Glest{ namespace Game{
 
+// Singletons and language strings the type loaders share are
+// created on the main thread, the pool threads then only read them
+static void prepareTypeLoader() {
+	Lang &lang= Lang::getInstance();
+	lang.getString("LogScreenGameLoadingUnitType","",true);
+	lang.getString("LogScreenGameLoadingUnitTypeSkills","",true);
+	lang.getString("LogScreenGameLoadingUpgradeType","",true);
+	lang.getTechTreeString("TypeLoaderPrepare","");
+
+	SkillTypeFactory::getInstance();
+	CommandTypeFactory::getInstance();
+	Shared::Sound::SoundFileLoaderFactory::getInstance();
+}
+
+// =====================================================
+// 	class TypeLoaderTaskList
+//
+///	Loads one unit or upgrade type per task on the type
+/// loader pool, each into its own checksums and file
+/// list so they can be merged back in type order
+// =====================================================
+
+class TypeLoaderTaskList : public WorkStealingTaskInterface {
+private:
+	const FactionType *factionType;
+	std::vector<UnitType> *unitTypes;
+	std::vector<UpgradeType> *upgradeTypes;
+	const TechTree *techTree;
+	string techTreePath;
+	string currentPath;
+	bool loadUpgrades;
+	bool validationMode;
+
+	Mutex mutexProgress;
+	int loadedCount;
+	int progressBaseValue;
+
+	std::vector<Checksum> checksums;
+	std::vector<Checksum> techtreeChecksums;
+	std::vector<std::map<string,vector<pair<string, string> > > > loadedFileLists;
+	std::vector<string> errors;
+	std::vector<bool> errorsWantStackTrace;
+
+public:
+	// upgradeTypes is NULL when the unit types are loaded
+	TypeLoaderTaskList(const FactionType *factionType, std::vector<UnitType> *unitTypes,
+			std::vector<UpgradeType> *upgradeTypes, const TechTree *techTree,
+			const string &currentPath, bool validationMode) {
+		this->factionType = factionType;
+		this->unitTypes = unitTypes;
+		this->upgradeTypes = upgradeTypes;
+		this->techTree = techTree;
+		this->techTreePath = techTree->getPath();
+		this->currentPath = currentPath;
+		this->loadUpgrades = (upgradeTypes != NULL);
+		this->validationMode = validationMode;
+		this->loadedCount = 0;
+		this->progressBaseValue = Logger::getInstance().getProgress();
+
+		int typeCount = getTypeCount();
+		checksums.resize(typeCount);
+		techtreeChecksums.resize(typeCount);
+		loadedFileLists.resize(typeCount);
+		errors.resize(typeCount);
+		errorsWantStackTrace.resize(typeCount,false);
+	}
+
+	int getTypeCount() const {
+		return (int)(loadUpgrades == true ? upgradeTypes->size() : unitTypes->size());
+	}
+
+	virtual void executeTask(int workerIndex, int taskIndex) {
+		try {
+			if(loadUpgrades == true) {
+				UpgradeType &upgradeType = (*upgradeTypes)[taskIndex];
+				string str= currentPath + "upgrades/" + upgradeType.getName();
+				upgradeType.load(str, techTree, factionType, &checksums[taskIndex],
+						&techtreeChecksums[taskIndex],loadedFileLists[taskIndex],validationMode);
+			}
+			else {
+				UnitType &unitType = (*unitTypes)[taskIndex];
+				string str= currentPath + "units/" + unitType.getName();
+				unitType.loaddd(taskIndex, str, techTree,techTreePath, factionType, &checksums[taskIndex],
+						&techtreeChecksums[taskIndex],loadedFileLists[taskIndex],validationMode);
+			}
+		}
+		catch(megaglest_runtime_error& ex) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
+			if(validationMode == false) {
+				errors[taskIndex] = ex.what();
+				errorsWantStackTrace[taskIndex] = ex.wantStackTrace();
+			}
+		}
+		catch(const exception &e) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,e.what());
+			errors[taskIndex] = e.what();
+			errorsWantStackTrace[taskIndex] = true;
+		}
+
+		MutexSafeWrapper safeMutex(&mutexProgress);
+		loadedCount++;
+		int loaded = loadedCount;
+		safeMutex.ReleaseLock();
+
+		// the logger screen and the event queue belong to the main thread
+		if(workerIndex == 0) {
+			if(loadUpgrades == false) {
+				Logger::getInstance().setProgress(progressBaseValue+(int)(((double)loaded / (double)getTypeCount()) * 100.0/techTree->getTypeCount()));
+			}
+			SDL_PumpEvents();
+		}
+	}
+
+	// the first failed type in load order, empty when all loaded
+	int getFirstErrorIndex() const {
+		for(int index = 0; index < (int)errors.size(); ++index) {
+			if(errors[index] != "") {
+				return index;
+			}
+		}
+		return -1;
+	}
+	const string &getError(int index) const		{ return errors[index]; }
+	bool getErrorWantStackTrace(int index) const	{ return errorsWantStackTrace[index]; }
+
+	// adds what every type loaded the way loading them one after
+	// the other would have
+	void mergeResults(Checksum* checksum, Checksum *techtreeChecksum,
+			std::map<string,vector<pair<string, string> > > &loadedFileList) {
+		Renderer &renderer= Renderer::getInstance();
+		for(int index = 0; index < (int)loadedFileLists.size(); ++index) {
+			checksum->addFiles(checksums[index]);
+			techtreeChecksum->addFiles(techtreeChecksums[index]);
+
+			std::map<string,vector<pair<string, string> > > &typeFileList = loadedFileLists[index];
+			for(std::map<string,vector<pair<string, string> > >::iterator iterMap = typeFileList.begin();
+				iterMap != typeFileList.end(); ++iterMap) {
+				// a shared model texture is listed for the type that loaded it first
+				if(loadedFileList.find(iterMap->first) != loadedFileList.end() &&
+					renderer.isModelTexture(rsGame, iterMap->first) == true) {
+					continue;
+				}
+				vector<pair<string, string> > &files = loadedFileList[iterMap->first];
+				files.insert(files.end(),iterMap->second.begin(),iterMap->second.end());
+			}
+		}
+	}
+};
+
 // ======================================================
 //          Class FactionType
 // ======================================================
@@ -168,28 +323,57 @@ void FactionType::load(const string &factionName, const TechTree *techTree, Chec
 			SDL_PumpEvents();
 		}
 
+		// b1) load units, b2) load upgrades
+		// Types only see each other through the names set by the preload,
+		// so with more than one core each type loads on the type loader
+		// pool and what it adds is merged back in type order.
+		auto_ptr<WorkStealingScheduler> typeLoader;
+		int typeLoaderThreads = Config::getInstance().getInt("TypeLoaderThreads","0");
+		if(typeLoaderThreads != 1 && WorkStealingScheduler::getDefaultWorkerCount() > 1 &&
+			(unitTypes.size() > 1 || upgradeTypes.size() > 1)) {
+			prepareTypeLoader();
+			typeLoader.reset(new WorkStealingScheduler(typeLoaderThreads,1));
+		}
+
 		// b1) load units
 		try {
-			Logger &logger= Logger::getInstance();
-			int progressBaseValue=logger.getProgress();
-			for(int i = 0; i < (int)unitTypes.size(); ++i) {
-				string str= currentPath + "units/" + unitTypes[i].getName();
+			if(typeLoader.get() != NULL) {
+				TypeLoaderTaskList taskList(this, &unitTypes, NULL, techTree, currentPath, validationMode);
+				typeLoader->run(&taskList,taskList.getTypeCount());
 
-				try {
-					unitTypes[i].loaddd(i, str, techTree,techTreePath, this, checksum,techtreeChecksum,
-						loadedFileList,validationMode);
-					logger.setProgress(progressBaseValue+(int)((((double)i + 1.0) / (double)unitTypes.size()) * 100.0/techTree->getTypeCount()));
-					SDL_PumpEvents();
+				int errorIndex = taskList.getFirstErrorIndex();
+				if(errorIndex >= 0) {
+					throw megaglest_runtime_error(taskList.getError(errorIndex),!taskList.getErrorWantStackTrace(errorIndex));
 				}
-				catch(megaglest_runtime_error& ex) {
-					if(validationMode == false) {
-						throw;
+				taskList.mergeResults(checksum, techtreeChecksum, loadedFileList);
+			}
+			else {
+				Logger &logger= Logger::getInstance();
+				int progressBaseValue=logger.getProgress();
+				for(int i = 0; i < (int)unitTypes.size(); ++i) {
+					string str= currentPath + "units/" + unitTypes[i].getName();
+
+					try {
+						unitTypes[i].loaddd(i, str, techTree,techTreePath, this, checksum,techtreeChecksum,
+							loadedFileList,validationMode);
+						logger.setProgress(progressBaseValue+(int)((((double)i + 1.0) / (double)unitTypes.size()) * 100.0/techTree->getTypeCount()));
+						SDL_PumpEvents();
 					}
-					else {
-						SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
+					catch(megaglest_runtime_error& ex) {
+						if(validationMode == false) {
+							throw;
+						}
+						else {
+							SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
+						}
 					}
 				}
 			}
+
+			// boost names are numbered in unit order however the units loaded
+			for(int i = 0; i < (int)unitTypes.size(); ++i) {
+				unitTypes[i].setAttackBoostAutoNames();
+			}
 		}
 	    catch(megaglest_runtime_error& ex) {
 			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
@@ -202,23 +386,35 @@ void FactionType::load(const string &factionName, const TechTree *techTree, Chec
 
 		// b2) load upgrades
 		try{
-			for(int i = 0; i < (int)upgradeTypes.size(); ++i) {
-				string str= currentPath + "upgrades/" + upgradeTypes[i].getName();
+			if(typeLoader.get() != NULL) {
+				TypeLoaderTaskList taskList(this, &unitTypes, &upgradeTypes, techTree, currentPath, validationMode);
+				typeLoader->run(&taskList,taskList.getTypeCount());
 
-				try {
-					upgradeTypes[i].load(str, techTree, this, checksum,
-							techtreeChecksum,loadedFileList,validationMode);
+				int errorIndex = taskList.getFirstErrorIndex();
+				if(errorIndex >= 0) {
+					throw megaglest_runtime_error(taskList.getError(errorIndex),!taskList.getErrorWantStackTrace(errorIndex));
 				}
-				catch(megaglest_runtime_error& ex) {
-					if(validationMode == false) {
-						throw;
+				taskList.mergeResults(checksum, techtreeChecksum, loadedFileList);
+			}
+			else {
+				for(int i = 0; i < (int)upgradeTypes.size(); ++i) {
+					string str= currentPath + "upgrades/" + upgradeTypes[i].getName();
+
+					try {
+						upgradeTypes[i].load(str, techTree, this, checksum,
+								techtreeChecksum,loadedFileList,validationMode);
 					}
-					else {
-						SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
+					catch(megaglest_runtime_error& ex) {
+						if(validationMode == false) {
+							throw;
+						}
+						else {
+							SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,ex.what());
+						}
 					}
-				}
 
-				SDL_PumpEvents();
+					SDL_PumpEvents();
+				}
 			}
 		}
 		catch(const exception &e){
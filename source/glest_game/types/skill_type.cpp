@@ -338,9 +338,7 @@ void SkillType::loadAttackBoost(const XmlNode *attackBoostsNode, const XmlNode *
 
         attackBoostNode = findAttackBoostDetails(attackBoost.name,attackBoostsNode,attackBoostNode);
     }
-    else {
-        attackBoost.name = "attack-boost-autoname-" + intToStr(getNextAttackBoostId());
-    }
+    // unnamed boosts get theirs from setAttackBoostAutoName() in load order
     string targetType = attackBoostNode->getChild("target")->getAttribute("value")->getValue();
 
     attackBoost.allowMultipleBoosts = false;
@@ -414,6 +412,13 @@ void SkillType::loadAttackBoost(const XmlNode *attackBoostsNode, const XmlNode *
     }
 }
 
+void SkillType::setAttackBoostAutoName() {
+	if(attackBoost.enabled == true && attackBoost.name == "") {
+		attackBoost.name = "attack-boost-autoname-" + intToStr(getNextAttackBoostId());
+		attackBoost.boostUpgrade.setUpgradeName(attackBoost.name);
+	}
+}
+
 void SkillType::load(const XmlNode *sn, const XmlNode *attackBoostsNode,
 		const string &dir, const TechTree *tt, const FactionType *ft,
 		std::map<string,vector<pair<string, string> > > &loadedFileList,
@@ -218,6 +218,8 @@ public:
     bool CanCycleNextRandomAnimation(const int *animationRandomCycleCount) const;
 
     static void resetNextAttackBoostId() { nextAttackBoostId=0; }
+    // numbers an attack boost without a name, called in load order
+    void setAttackBoostAutoName();
 
     const AnimationAttributes getAnimationAttribute(int index) const;
     int getAnimationCount() const { return (int)animations.size(); }
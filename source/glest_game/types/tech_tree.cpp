@@ -18,6 +18,8 @@
 #include "faction_type.h"
 #include "logger.h"
 #include "xml_parser.h"
+#include "xml_binary_cache.h"
+#include "config.h"
 #include "platform_util.h"
 #include "game_util.h"
 #include "window.h"
@@ -206,6 +208,25 @@ string TechTree::findPath(const string &techName, const vector<string> &pathTech
 }
 
 
+// Parsed XML of a techtree from the last time it was loaded, stale once
+// the CRC of its XML files changes. NULL when caching is off.
+static XmlBinaryCache * createXmlCache(const vector<string> &pathList, const string &techName,
+		const string &treePath) {
+	string cachePath = getCRCCacheFilePath();
+	if(cachePath == "" || Config::getInstance().getBool("TechtreeXmlCache","true") == false) {
+		return NULL;
+	}
+
+	uint32 techCRC = getFolderTreeContentsCheckSumRecursively(pathList, "/" + techName + "/*", ".xml", NULL);
+	Checksum fileChecksum;
+	fileChecksum.addString(treePath);
+	string cacheFile = cachePath + "XML_CACHE_" + uIntToStr(fileChecksum.getSum());
+
+	XmlBinaryCache *xmlCache = new XmlBinaryCache(cacheFile, techCRC);
+	xmlCache->load();
+	return xmlCache;
+}
+
 void TechTree::load(const string &dir, set<string> &factions, Checksum* checksum,
 		Checksum *techtreeChecksum,
 		std::map<string,vector<pair<string, string> > > &loadedFileList,
@@ -225,6 +246,11 @@ void TechTree::load(const string &dir, set<string> &factions, Checksum* checksum
 	snprintf(szBuf,8096,Lang::getInstance().getString("LogScreenGameLoadingTechtree","",true).c_str(),formatString(getName(true)).c_str());
 	Logger::getInstance().add(szBuf, true);
 
+	// resource, techtree and faction XML all come from the cache when it
+	// is current, deactivated again when it goes out of scope
+	auto_ptr<XmlBinaryCache> xmlCache(createXmlCache(pathList, name, treePath));
+	XmlBinaryCache::setActive(xmlCache.get());
+
 	vector<string> filenames;
 	//load resources
 	string str= currentPath + "resources/*.";
@@ -375,6 +401,12 @@ void TechTree::load(const string &dir, set<string> &factions, Checksum* checksum
         *techtreeChecksum = checksumValue;
     }
 
+    XmlBinaryCache::setActive(NULL);
+    if(xmlCache.get() != NULL) {
+    	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("XML cache for techtree [%s] hits: %d misses: %d\n",name.c_str(),xmlCache->getHitCount(),xmlCache->getMissCount());
+    	xmlCache->save();
+    }
+
     if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 }
 
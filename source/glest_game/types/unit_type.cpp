@@ -1284,6 +1284,14 @@ string UnitType::getReqDesc(bool translatedValue) const{
 		return ProducibleType::getReqDesc(translatedValue)+"\n" + lang.getString("Limits") + " " + resultTxt;
 }
 
+void UnitType::setAttackBoostAutoNames() {
+	for(int i = 0; i < (int)skillTypes.size(); ++i) {
+		if(skillTypes[i] != NULL) {
+			skillTypes[i]->setAttackBoostAutoName();
+		}
+	}
+}
+
 string UnitType::getName(bool translatedValue) const {
 	if(translatedValue == false) return name;
 
@@ -249,6 +249,8 @@ public:
     		Checksum* techtreeChecksum,
     		std::map<string,vector<pair<string, string> > > &loadedFileList,
     		bool validationMode=false);
+    // after the units of a faction are loaded, in their order
+    void setAttackBoostAutoNames();
 
     virtual string getName(bool translatedValue=false) const;
 
@@ -1160,9 +1160,13 @@ void TotalUpgrade::reset() {
 	prodSpeedUpgradeIsMultiplierValueList.clear();
 	prodSpeedMorphIsMultiplierValueList.clear();
 	attackSpeedIsMultiplierValueList.clear();
+
+	crcDirty = true;
 }
 
 void TotalUpgrade::sum(const UpgradeTypeBase *ut, const Unit *unit, bool boostMode) {
+	crcDirty = true;
+
 	maxHpIsMultiplier			= ut->getMaxHpIsMultiplier();
 	sightIsMultiplier			= ut->getSightIsMultiplier();
 	maxEpIsMultiplier			= ut->getMaxEpIsMultiplier();
@@ -1414,11 +1418,14 @@ void TotalUpgrade::apply(int sourceUnitId, const UpgradeTypeBase *ut, const Unit
 
 	boostUpgrade->sum(ut,unit, true);
 	boostUpgrades.push_back(boostUpgrade);
+	crcDirty = true;
 }
 
 void TotalUpgrade::deapply(int sourceUnitId, const UpgradeTypeBase *ut,int destUnitId) {
 	//printf("<****** About to de-apply boost: %s\nTo unit: %d\n\n",ut->toString().c_str(),destUnitId);
 
+	crcDirty = true;
+
 	bool removedBoost = false;
 	for(unsigned int index = 0; index < boostUpgrades.size(); ++index) {
 		TotalUpgrade *boost = boostUpgrades[index];
@@ -1578,6 +1585,15 @@ void TotalUpgrade::incLevel(const UnitType *ut) {
 	maxEp += ut->getMaxEp()*50/100;
 	sight += ut->getSight()*20/100;
 	armor += ut->getArmor()*50/100;
+	crcDirty = true;
+}
+
+Checksum TotalUpgrade::getCRC() {
+	if(crcDirty == true) {
+		crc = UpgradeTypeBase::getCRC();
+		crcDirty = false;
+	}
+	return crc;
 }
 
 void TotalUpgrade::saveGame(XmlNode *rootNode) const {
@@ -1701,6 +1717,7 @@ void TotalUpgrade::saveGame(XmlNode *rootNode) const {
 
 void TotalUpgrade::loadGame(const XmlNode *rootNode) {
 	const XmlNode *upgradeTypeBaseNode = rootNode->getChild("TotalUpgrade");
+	crcDirty = true;
 
 	//description = upgradeTypeBaseNode->getAttribute("description")->getValue();
 
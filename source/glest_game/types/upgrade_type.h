@@ -148,6 +148,7 @@ public:
 	virtual void copyDataFrom(UpgradeTypeBase *source);
 
     virtual string getUpgradeName() const { return upgradename; }
+    void setUpgradeName(const string &upgradename) { this->upgradename = upgradename; }
     virtual int getMaxHp() const			{return maxHp;}
     virtual int getMaxHpRegeneration() const			{return maxHpRegeneration;}
     virtual int getSight() const			{return sight;}
@@ -357,6 +358,10 @@ private:
 	int boostUpgradeDestUnit;
 	std::vector<TotalUpgrade *> boostUpgrades;
 
+	// checksum of the values above, recomputed only after they changed
+	bool crcDirty;
+	Checksum crc;
+
 public:
 	TotalUpgrade();
 	virtual ~TotalUpgrade() {}
@@ -437,6 +442,11 @@ public:
 	 * @rootNode The node of the unit that this TotalUpgrade object belongs to.
 	 */
 	void loadGame(const XmlNode *rootNode);
+
+	/**
+	 * Same checksum as UpgradeTypeBase::getCRC, kept until the upgrade changes.
+	 */
+	virtual Checksum getCRC();
 };
 
 }}//end namespace
@@ -28,11 +28,13 @@
 #include "map_preview.h"
 #include "world.h"
 #include "byte_order.h"
+#include "work_stealing_scheduler.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Graphics;
 using namespace Shared::Util;
 using namespace Shared::Platform;
+using Shared::PlatformCommon::WorkStealingScheduler;
 
 namespace Glest{ namespace Game{
 
@@ -132,10 +134,9 @@ SurfaceCell::SurfaceCell() {
 	nearSubmerged = false;
 	cellChangedFromOriginalMapLoad = false;
 
-	for(int index = 0; index < GameConstants::maxPlayers + GameConstants::specialFactions; ++index) {
-		setVisible(index,false);
-		setExplored(index,false);
-	}
+	teamVisibility = NULL;
+	surfaceX = 0;
+	surfaceY = 0;
 }
 
 SurfaceCell::~SurfaceCell() {
@@ -169,64 +170,23 @@ bool SurfaceCell::decAmount(int value) {
 
 	return object->getResource()->decAmount(value);
 }
-void SurfaceCell::setExplored(int teamIndex, bool explored) {
-	if(teamIndex < 0 || teamIndex >= GameConstants::maxPlayers + GameConstants::specialFactions) {
-		char szBuf[8096]="";
-		snprintf(szBuf,8096,"Invalid value for teamIndex [%d]",teamIndex);
-		printf("%s\n",szBuf);
-		throw megaglest_runtime_error(szBuf);
-	}
-
-	this->explored[teamIndex]= explored;
-	//printf("Setting explored to %d for teamIndex %d\n",explored,teamIndex);
-}
-
-void SurfaceCell::setVisible(int teamIndex, bool visible) {
-	if(teamIndex < 0 || teamIndex >= GameConstants::maxPlayers + GameConstants::specialFactions) {
-		char szBuf[8096]="";
-		snprintf(szBuf,8096,"Invalid value for teamIndex [%d]",teamIndex);
-		printf("%s\n",szBuf);
-		throw megaglest_runtime_error(szBuf);
-	}
-
-    this->visible[teamIndex]= visible;
-
-	if(SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled == true &&
-			SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynchMax).enabled == true) {
-		char szBuf[8096]="";
-		snprintf(szBuf,8096,"In setVisible() teamIndex %d visible %d",teamIndex,visible);
-
-//		if(frameIndex < 0) {
-//			unit->logSynchData(__FILE__,__LINE__,szBuf);
-//		}
-//		else {
-//			unit->logSynchDataThreaded(__FILE__,__LINE__,szBuf);
-//		}
-
-		if(Thread::isCurrentThreadMainThread()) {
-			//unit->logSynchDataThreaded(__FILE__,__LINE__,szBuf);
-			SystemFlags::OutputDebug(SystemFlags::debugWorldSynch,szBuf);
-		}
-		else {
-			//unit->logSynchData(__FILE__,__LINE__,szBuf);
-			printf("%s",szBuf);
-		}
-
-	}
-
+void SurfaceCell::setTeamVisibility(const TeamVisibilityMap *teamVisibility, int surfaceX, int surfaceY) {
+	this->teamVisibility = teamVisibility;
+	this->surfaceX = surfaceX;
+	this->surfaceY = surfaceY;
 }
 
 string SurfaceCell::isVisibleString() const	{
 	string result = "isVisibleList = ";
 	for(int index = 0; index < GameConstants::maxPlayers + GameConstants::specialFactions; ++index) {
-		result += string(visible[index] ? "true" : "false");
+		result += string(isVisible(index) ? "true" : "false");
 	}
 	return result;
 }
 string SurfaceCell::isExploredString() const {
 	string result = "isExploredList = ";
 	for(int index = 0; index < GameConstants::maxPlayers + GameConstants::specialFactions; ++index) {
-		result += string(explored[index] ? "true" : "false");
+		result += string(isExplored(index) ? "true" : "false");
 	}
 	return result;
 }
@@ -329,6 +289,86 @@ void SurfaceCell::loadGame(const XmlNode *rootNode, int index, World *world) {
 //		}
 	}
 }
+// =====================================================
+// 	class ClusterMap
+// =====================================================
+
+bool ClusterMapPassability::isPassable(int x, int y) const {
+	if(map->isInside(x, y) == false || map->isInsideSurface(Map::toSurfCoords(Vec2i(x, y))) == false) {
+		return false;
+	}
+	const Cell *cell = map->getCell(x, y);
+	if(field == fLand) {
+		const SurfaceCell *sc = map->getSurfaceCell(Map::toSurfCoords(Vec2i(x, y)));
+		if(sc->isFree() == false || map->getDeepSubmerged(cell) == true) {
+			return false;
+		}
+	}
+	// Only buildings block the abstract graph, mobile units come and go
+	const Unit *unit = cell->getUnit(field);
+	return (unit == NULL || unit->getType()->isMobile() == true);
+}
+
+ClusterMap::ClusterMap(const Map *map) {
+	this->map = map;
+	this->initialized = false;
+	this->mutex = new ReadWriteMutex();
+	for(int i = 0; i < fieldCount; ++i) {
+		passability[i].map = map;
+		passability[i].field = static_cast<Field>(i);
+	}
+}
+
+ClusterMap::~ClusterMap() {
+	delete mutex;
+	mutex = NULL;
+}
+
+void ClusterMap::initGraphs() {
+	for(int i = 0; i < fieldCount; ++i) {
+		graphs[i].init(map->getW(), map->getH(), &passability[i]);
+	}
+	initialized = true;
+}
+
+void ClusterMap::setDirty(const Vec2i &pos, int size) {
+	ReadWriteMutexSafeWrapper safeMutex(mutex,false,string(__FILE__) + "_" + intToStr(__LINE__));
+	if(initialized == false) {
+		return;
+	}
+	for(int i = 0; i < fieldCount; ++i) {
+		graphs[i].setDirty(pos.x, pos.y, size);
+	}
+}
+
+void ClusterMap::setAllDirty() {
+	ReadWriteMutexSafeWrapper safeMutex(mutex,false,string(__FILE__) + "_" + intToStr(__LINE__));
+	if(initialized == false) {
+		return;
+	}
+	for(int i = 0; i < fieldCount; ++i) {
+		graphs[i].setAllDirty();
+	}
+}
+
+bool ClusterMap::findPath(Field field, const Vec2i &from, const Vec2i &to, std::vector<Vec2i> &waypoints) {
+	for(;;) {
+		ReadWriteMutexSafeWrapper safeMutex(mutex,true,string(__FILE__) + "_" + intToStr(__LINE__));
+		if(initialized == true && graphs[field].isDirty() == false) {
+			// the search state lives in this call so workers don't wait on each other
+			ClusterGraphSearch search;
+			return graphs[field].findPath(search, from, to, waypoints);
+		}
+		safeMutex.ReleaseLock();
+
+		ReadWriteMutexSafeWrapper safeMutexWrite(mutex,false,string(__FILE__) + "_" + intToStr(__LINE__));
+		if(initialized == false) {
+			initGraphs();
+		}
+		graphs[field].update();
+	}
+}
+
 // =====================================================
 // 	class Map
 // =====================================================
@@ -355,6 +395,7 @@ Map::Map() {
 	surfaceSize=(surfaceW * surfaceH);
 	maxPlayers=0;
 	maxMapHeight=0;
+	clusterMap= NULL;
 }
 
 Map::~Map() {
@@ -366,6 +407,8 @@ Map::~Map() {
 	surfaceCells = NULL;
 	delete [] startLocations;
 	startLocations = NULL;
+	delete clusterMap;
+	clusterMap = NULL;
 }
 
 void Map::end(){
@@ -482,6 +525,13 @@ Checksum Map::load(const string &path, TechTree *techTree, Tileset *tileset) {
 			//cells
 			cells= new Cell[getCellArraySize()];
 			surfaceCells= new SurfaceCell[getSurfaceCellArraySize()];
+			teamVisibility.init(surfaceW, surfaceH, GameConstants::maxPlayers + GameConstants::specialFactions);
+			for(int j = 0; j < surfaceH; ++j) {
+				for(int i = 0; i < surfaceW; ++i) {
+					getSurfaceCell(i, j)->setTeamVisibility(&teamVisibility, i, j);
+				}
+			}
+			unitGrid.init(w, h);
 
 			//read heightmap
 			for(int j = 0; j < surfaceH; ++j) {
@@ -573,6 +623,10 @@ void Map::init(Tileset *tileset) {
 	computeInterpolatedHeights();
 	computeNearSubmerged();
 	computeCellColors();
+
+	delete clusterMap;
+	clusterMap= new ClusterMap(this);
+	moveCache.init(w, h, WorkStealingScheduler::maxWorkerCount * mcqCount * GameConstants::maxPlayers * fieldCount * moveCacheMaxUnitSize);
 }
 
 
@@ -932,79 +986,133 @@ bool Map::canMorph(const Vec2i &pos,const Unit *currentUnit,const UnitType *targ
 
 // ==================== unit placement ====================
 
-//checks if a unit can move from between 2 cells
-bool Map::canMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2, std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<Field,bool> > > > *lookupCache) const {
-	int size= unit->getType()->getSize();
-	Field field= unit->getCurrField();
+int Map::getMoveCacheLayer(MoveCacheQuery query, const Unit *unit, int size, Field field) const {
+	int slot = unit->getFactionIndex();
+	if(moveCache.getLayerCount() <= 0 || slot < 0 || slot >= GameConstants::maxPlayers ||
+		size < 1 || size > moveCacheMaxUnitSize) {
+		return -1;
+	}
+	// each scheduler worker fills its own layers
+	int worker = WorkStealingScheduler::getCurrentWorkerIndex();
+	return (((worker * mcqCount + query) * GameConstants::maxPlayers + slot) * fieldCount + field) * moveCacheMaxUnitSize + (size - 1);
+}
 
-	if(lookupCache != NULL) {
-		std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<Field,bool> > > >::const_iterator iterFind1 = lookupCache->find(pos1);
-		if(iterFind1 != lookupCache->end()) {
-			std::map<Vec2i, std::map<int, std::map<Field,bool> > >::const_iterator iterFind2 = iterFind1->second.find(pos2);
-			if(iterFind2 != iterFind1->second.end()) {
-				std::map<int, std::map<Field,bool> >::const_iterator iterFind3 = iterFind2->second.find(size);
-				if(iterFind3 != iterFind2->second.end()) {
-					std::map<Field,bool>::const_iterator iterFind4 = iterFind3->second.find(field);
-					if(iterFind4 != iterFind3->second.end()) {
-						// Found this result in the cache
-						return iterFind4->second;
-					}
-				}
-			}
+//returns true if the unit would overlap its own cells at pos
+bool Map::isOwnFootprint(const Unit *unit, const Vec2i &pos, int size) const {
+	const Vec2i unitPos = unit->getPosNotThreadSafe();
+	return pos.x < unitPos.x + size && unitPos.x < pos.x + size &&
+		   pos.y < unitPos.y + size && unitPos.y < pos.y + size;
+}
+
+bool Map::isBadHarvestMove(const Unit *unit, const Vec2i &pos) const {
+	Command *command= unit->getCurrCommand();
+	if(command != NULL) {
+		const HarvestCommandType *hct = dynamic_cast<const HarvestCommandType*>(command->getCommandType());
+		if(hct != NULL && unit->isBadHarvestPos(pos) == true) {
+			return true;
 		}
 	}
+	return false;
+}
 
-	for(int i=pos2.x; i<pos2.x+size; ++i) {
-		for(int j=pos2.y; j<pos2.y+size; ++j) {
+bool Map::areCellsFree(const Unit *unit, const Vec2i &pos, int size, Field field) const {
+	for(int i=pos.x; i<pos.x+size; ++i) {
+		for(int j=pos.y; j<pos.y+size; ++j) {
 			if(isInside(i, j) && isInsideSurface(toSurfCoords(Vec2i(i,j)))) {
 				if(getCell(i, j)->getUnit(field) != unit) {
 					if(isFreeCell(Vec2i(i, j), field) == false) {
-						if(lookupCache != NULL) {
-							(*lookupCache)[pos1][pos2][size][field]=false;
-						}
-
 						return false;
 					}
 				}
 			}
 			else {
-				if(lookupCache != NULL) {
-					(*lookupCache)[pos1][pos2][size][field]=false;
-				}
-
 				return false;
 			}
 		}
 	}
+	return true;
+}
 
-	bool isBadHarvestPos = false;
-	//if(unit != NULL) {
-		Command *command= unit->getCurrCommand();
-		if(command != NULL) {
-			const HarvestCommandType *hct = dynamic_cast<const HarvestCommandType*>(command->getCommandType());
-			if(hct != NULL && unit->isBadHarvestPos(pos2) == true) {
-				isBadHarvestPos = true;
+bool Map::areCellsAproxFree(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2, int size, Field field, int teamIndex) const {
+	//single cell units
+	if(size == 1) {
+		if(isAproxFreeCell(pos2, field, teamIndex) == false) {
+			return false;
+		}
+		if(pos1.x != pos2.x && pos1.y != pos2.y) {
+			if(isAproxFreeCell(Vec2i(pos1.x, pos2.y), field, teamIndex) == false) {
+				return false;
+			}
+			if(isAproxFreeCell(Vec2i(pos2.x, pos1.y), field, teamIndex) == false) {
+				return false;
 			}
 		}
-	//}
+		return true;
+	}
 
-	if(isBadHarvestPos == true) {
-		if(lookupCache != NULL) {
-			(*lookupCache)[pos1][pos2][size][field]=false;
+	//multi cell units
+	for(int i = pos2.x; i < pos2.x + size; ++i) {
+		for(int j = pos2.y; j < pos2.y + size; ++j) {
+			Vec2i cellPos = Vec2i(i,j);
+			if(isInside(cellPos) && isInsideSurface(toSurfCoords(cellPos))) {
+				if(getCell(cellPos)->getUnit(unit->getCurrField()) != unit) {
+					if(isAproxFreeCell(cellPos, field, teamIndex) == false) {
+						return false;
+					}
+				}
+			}
+			else {
+				return false;
+			}
 		}
+	}
+	return true;
+}
 
+bool Map::areCellsAproxFreeSoon(const Vec2i &originPos, const Vec2i &pos1, const Vec2i &pos2, Field field, int teamIndex) const {
+	if(isAproxFreeCellOrMightBeFreeSoon(originPos, pos2, field, teamIndex) == false) {
 		return false;
 	}
+	if(pos1.x != pos2.x && pos1.y != pos2.y) {
+		if(isAproxFreeCellOrMightBeFreeSoon(originPos, Vec2i(pos1.x, pos2.y), field, teamIndex) == false) {
+			return false;
+		}
+		if(isAproxFreeCellOrMightBeFreeSoon(originPos, Vec2i(pos2.x, pos1.y), field, teamIndex) == false) {
+			return false;
+		}
+	}
+	return true;
+}
 
-	if(lookupCache != NULL) {
-		(*lookupCache)[pos1][pos2][size][field]=true;
+//checks if a unit can move from between 2 cells
+bool Map::canMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2) const {
+	int size= unit->getType()->getSize();
+	Field field= unit->getCurrField();
+
+	// Single steps away from the unit's own cells only depend on the
+	// cell contents and can be shared by every unit of the faction
+	int layer = -1;
+	int direction = CellMoveCache::getDirection(pos1, pos2);
+	if(direction >= 0 && isInside(pos1) && isOwnFootprint(unit, pos2, size) == false) {
+		layer = getMoveCacheLayer(mcqCanMove, unit, size, field);
 	}
 
-    return true;
+	bool cellsFree = false;
+	if(layer < 0 || moveCache.lookup(layer, pos1, direction, cellsFree) == false) {
+		cellsFree = areCellsFree(unit, pos2, size, field);
+		if(layer >= 0) {
+			moveCache.store(layer, pos1, direction, cellsFree);
+		}
+	}
+	if(cellsFree == false) {
+		return false;
+	}
+
+	return (isBadHarvestMove(unit, pos2) == false);
 }
 
 //checks if a unit can move from between 2 cells using only visible cells (for pathfinding)
-bool Map::aproxCanMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2, std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<int, std::map<Field,bool> > > > > *lookupCache) const {
+bool Map::aproxCanMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2) const {
 	if(isInside(pos1) == false || isInsideSurface(toSurfCoords(pos1)) == false ||
 	   isInside(pos2) == false || isInsideSurface(toSurfCoords(pos2)) == false) {
 
@@ -1019,143 +1127,62 @@ bool Map::aproxCanMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2, s
 	int teamIndex= unit->getTeam();
 	Field field= unit->getCurrField();
 
-	if(lookupCache != NULL) {
-		std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<int, std::map<Field,bool> > > > >::const_iterator iterFind1 = lookupCache->find(pos1);
-		if(iterFind1 != lookupCache->end()) {
-			std::map<Vec2i, std::map<int, std::map<int, std::map<Field,bool> > > >::const_iterator iterFind2 = iterFind1->second.find(pos2);
-			if(iterFind2 != iterFind1->second.end()) {
-				std::map<int, std::map<int, std::map<Field,bool> > >::const_iterator iterFind3 = iterFind2->second.find(teamIndex);
-				if(iterFind3 != iterFind2->second.end()) {
-					std::map<int, std::map<Field,bool> >::const_iterator iterFind4 = iterFind3->second.find(size);
-					if(iterFind4 != iterFind3->second.end()) {
-						std::map<Field,bool>::const_iterator iterFind5 = iterFind4->second.find(field);
-						if(iterFind5 != iterFind4->second.end()) {
-							// Found this result in the cache
-							if(iterFind5->second == false) {
-								//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
-							}
-							return iterFind5->second;
-						}
-					}
-				}
-			}
-		}
+	int layer = -1;
+	int direction = CellMoveCache::getDirection(pos1, pos2);
+	if(direction >= 0 && (size == 1 || isOwnFootprint(unit, pos2, size) == false)) {
+		layer = getMoveCacheLayer(mcqAproxCanMove, unit, size, field);
 	}
 
-	//single cell units
-	if(size == 1) {
-		if(isAproxFreeCell(pos2, field, teamIndex) == false) {
-			if(lookupCache != NULL) {
-				(*lookupCache)[pos1][pos2][teamIndex][size][field]=false;
-			}
-
-			//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
-			return false;
-		}
-		if(pos1.x != pos2.x && pos1.y != pos2.y) {
-			if(isAproxFreeCell(Vec2i(pos1.x, pos2.y), field, teamIndex) == false) {
-				if(lookupCache != NULL) {
-					(*lookupCache)[pos1][pos2][teamIndex][size][field]=false;
-				}
-
-				//Unit *cellUnit = getCell(Vec2i(pos1.x, pos2.y))->getUnit(field);
-				//Object * obj = getSurfaceCell(toSurfCoords(Vec2i(pos1.x, pos2.y)))->getObject();
-
-				//printf("[%s] Line: %d returning false cell [%s] free [%d] cell unitid = %d object class = %d\n",__FUNCTION__,__LINE__,Vec2i(pos1.x, pos2.y).getString().c_str(),this->isFreeCell(Vec2i(pos1.x, pos2.y),field),(cellUnit != NULL ? cellUnit->getId() : -1),(obj != NULL ? obj->getType()->getClass() : -1));
-				//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
-				return false;
-			}
-			if(isAproxFreeCell(Vec2i(pos2.x, pos1.y), field, teamIndex) == false) {
-				if(lookupCache != NULL) {
-					(*lookupCache)[pos1][pos2][teamIndex][size][field]=false;
-				}
-
-				//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
-				return false;
-			}
-		}
-
-		bool isBadHarvestPos = false;
-		//if(unit != NULL) {
-			Command *command= unit->getCurrCommand();
-			if(command != NULL) {
-				const HarvestCommandType *hct = dynamic_cast<const HarvestCommandType*>(command->getCommandType());
-				if(hct != NULL && unit->isBadHarvestPos(pos2) == true) {
-					isBadHarvestPos = true;
-				}
-			}
-		//}
-
-		if(unit == NULL || isBadHarvestPos == true) {
-			if(lookupCache != NULL) {
-				(*lookupCache)[pos1][pos2][teamIndex][size][field]=false;
-			}
-
-			//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
-			return false;
-		}
-
-		if(lookupCache != NULL) {
-			(*lookupCache)[pos1][pos2][teamIndex][size][field]=true;
+	bool cellsFree = false;
+	if(layer < 0 || moveCache.lookup(layer, pos1, direction, cellsFree) == false) {
+		cellsFree = areCellsAproxFree(unit, pos1, pos2, size, field, teamIndex);
+		if(layer >= 0) {
+			moveCache.store(layer, pos1, direction, cellsFree);
 		}
-
-		return true;
 	}
-	//multi cell units
-	else {
-		for(int i = pos2.x; i < pos2.x + size; ++i) {
-			for(int j = pos2.y; j < pos2.y + size; ++j) {
-
-				Vec2i cellPos = Vec2i(i,j);
-				if(isInside(cellPos) && isInsideSurface(toSurfCoords(cellPos))) {
-					if(getCell(cellPos)->getUnit(unit->getCurrField()) != unit) {
-						if(isAproxFreeCell(cellPos, field, teamIndex) == false) {
-							if(lookupCache != NULL) {
-								(*lookupCache)[pos1][pos2][teamIndex][size][field]=false;
-							}
-
-							//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
-							return false;
-						}
-					}
-				}
-				else {
-
-					if(lookupCache != NULL) {
-						(*lookupCache)[pos1][pos2][teamIndex][size][field]=false;
-					}
-
-					//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
-					return false;
-				}
-			}
-		}
-
-		bool isBadHarvestPos = false;
-		Command *command= unit->getCurrCommand();
-		if(command != NULL) {
-			const HarvestCommandType *hct = dynamic_cast<const HarvestCommandType*>(command->getCommandType());
-			if(hct != NULL && unit->isBadHarvestPos(pos2) == true) {
-				isBadHarvestPos = true;
-			}
-		}
+	if(cellsFree == false) {
+		return false;
+	}
 
-		if(isBadHarvestPos == true) {
-			if(lookupCache != NULL) {
-				(*lookupCache)[pos1][pos2][teamIndex][size][field]=false;
-			}
+	return (isBadHarvestMove(unit, pos2) == false);
+}
 
-			//printf("[%s] Line: %d returning false\n",__FUNCTION__,__LINE__);
-			return false;
-		}
+bool Map::aproxCanMoveSoonCached(Unit *unit, const Vec2i &pos1, const Vec2i &pos2, bool &result) const {
+	if(unit->getType()->getSize() != 1 ||
+		(SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled == true &&
+		 SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynchMax).enabled == true)) {
+		return false;
+	}
+	int direction = CellMoveCache::getDirection(pos1, pos2);
+	if(direction < 0) {
+		return false;
+	}
+	// Mobile units further than 5 cells away from the unit count as free
+	// soon, so only steps where every tested cell is that far away give the
+	// same answer for every unit of the faction
+	const Vec2i originPos = unit->getPosNotThreadSafe();
+	if(originPos.dist(pos1) <= 7) {
+		return false;
+	}
+	Field field= unit->getCurrField();
+	int layer = getMoveCacheLayer(mcqAproxCanMoveSoon, unit, 1, field);
+	if(layer < 0) {
+		return false;
+	}
 
-		if(lookupCache != NULL) {
-			(*lookupCache)[pos1][pos2][teamIndex][size][field]=true;
-		}
+	bool cellsFree = false;
+	if(moveCache.lookup(layer, pos1, direction, cellsFree) == false) {
+		cellsFree = areCellsAproxFreeSoon(originPos, pos1, pos2, field, unit->getTeam());
+		moveCache.store(layer, pos1, direction, cellsFree);
 	}
+	result = (cellsFree == true && isBadHarvestMove(unit, pos2) == false);
 	return true;
 }
 
+void Map::invalidateMoveCache() {
+	moveCache.invalidate();
+}
+
 
 Vec2i Map::computeRefPos(const Selection *selection) const {
     Vec2i total= Vec2i(0);
@@ -1353,6 +1380,7 @@ void Map::putUnitCells(Unit *unit, const Vec2i &pos, bool ignoreSkill, bool thre
 	if(unit == NULL) {
 		throw megaglest_runtime_error("ut == NULL");
 	}
+	moveCache.invalidate();
 	putUnitCellsPrivate(unit, pos, unit->getType(), false, threaded);
 
 	// block space for morphing units
@@ -1422,11 +1450,11 @@ void Map::putUnitCellsPrivate(Unit *unit, const Vec2i &pos, const UnitType *ut,
 								   getCell(currPos)->getUnit(field) == unit) {
 					if(isMorph) {
 						// unit is beeing morphed to another unit with maybe other field.
-						getCell(currPos)->setUnit(field, unit);
+						setCellUnit(currPos, field, unit);
 						canPutInCell = false;
 					}
 					if(canPutInCell == true) {
-						getCell(currPos)->setUnit(unit->getCurrField(), unit);
+						setCellUnit(currPos, unit->getCurrField(), unit);
 					}
 				}
 				else if(canPutInCell == true) {
@@ -1450,6 +1478,20 @@ void Map::putUnitCellsPrivate(Unit *unit, const Vec2i &pos, const UnitType *ut,
 	if(canPutInCell == true) {
         unit->setPos(pos, false, threaded);
 	}
+	if(clusterMap != NULL && ut->isMobile() == false) {
+		clusterMap->setDirty(pos, ut->getSize());
+	}
+}
+
+void Map::setCellUnit(const Vec2i &pos, int field, Unit *unit) {
+	Cell *cell = getCell(pos);
+	if(cell->getUnit(field) != NULL) {
+		unitGrid.remove(pos.x, pos.y, field);
+	}
+	cell->setUnit(field, unit);
+	if(unit != NULL) {
+		unitGrid.add(pos.x, pos.y, field, unit);
+	}
 }
 
 //removes a unit from cells
@@ -1458,6 +1500,7 @@ void Map::clearUnitCells(Unit *unit, const Vec2i &pos, bool ignoreSkill) {
 	if(unit == NULL) {
 		throw megaglest_runtime_error("unit == NULL");
 	}
+	moveCache.invalidate();
 
 	const UnitType *ut= unit->getType();
 	Field currentField=unit->getCurrField();
@@ -1500,7 +1543,7 @@ void Map::clearUnitCells(Unit *unit, const Vec2i &pos, bool ignoreSkill) {
 
                 // Only clear the cell if its the unit we expect to clear out of it
                 if(getCell(currPos)->getUnit(currentField) == unit) {
-                    getCell(currPos)->setUnit(currentField, NULL);
+                    setCellUnit(currPos, currentField, NULL);
                 }
 			}
 			else if(ut->hasCellMap() == true &&
@@ -1515,6 +1558,9 @@ void Map::clearUnitCells(Unit *unit, const Vec2i &pos, bool ignoreSkill) {
 			}
 		}
 	}
+	if(clusterMap != NULL && ut->isMobile() == false) {
+		clusterMap->setDirty(pos, ut->getSize());
+	}
 }
 
 // ==================== misc ====================
@@ -1624,6 +1670,10 @@ void Map::flatternTerrain(const Unit *unit){
             }
         }
     }
+	if(clusterMap != NULL) {
+		// Heights are per surface cell so the neighbouring cells may change too
+		clusterMap->setDirty(unit->getPosNotThreadSafe() - Vec2i(cellScale), unit->getType()->getSize() + cellScale * 2);
+	}
 }
 
 //compute normals
@@ -1809,54 +1859,17 @@ void Map::saveGame(XmlNode *rootNode) const {
 //	SurfaceCell *surfaceCells;
 	//printf("getSurfaceCellArraySize() = %d\n",getSurfaceCellArraySize());
 
-	string exploredList = "";
-	string visibleList = "";
-
 	for(unsigned int i = 0; i < (unsigned int)getSurfaceCellArraySize(); ++i) {
 		SurfaceCell &surfaceCell = surfaceCells[i];
-
-		if(exploredList != "") {
-			exploredList += ",";
-		}
-
-		for(unsigned int j = 0; j < (unsigned int)GameConstants::maxPlayers; ++j) {
-			if(j > 0) {
-				exploredList += "|";
-			}
-
-			exploredList += intToStr(surfaceCell.isExplored(j));
-		}
-
-		if(visibleList != "") {
-			visibleList += ",";
-		}
-
-		for(unsigned int j = 0; j < (unsigned int)GameConstants::maxPlayers; ++j) {
-			if(j > 0) {
-				visibleList += "|";
-			}
-
-			visibleList += intToStr(surfaceCell.isVisible(j));
-		}
-
 		surfaceCell.saveGame(mapNode,i);
-
-		if(i > 0 && i % 100 == 0) {
-			XmlNode *surfaceCellNode = mapNode->addChild("SurfaceCell");
-			surfaceCellNode->addAttribute("batchIndex",intToStr(i), mapTagReplacements);
-			surfaceCellNode->addAttribute("exploredList",exploredList, mapTagReplacements);
-			surfaceCellNode->addAttribute("visibleList",visibleList, mapTagReplacements);
-
-			exploredList = "";
-			visibleList = "";
-		}
 	}
 
-	if(exploredList != "") {
-		XmlNode *surfaceCellNode = mapNode->addChild("SurfaceCell");
-		surfaceCellNode->addAttribute("batchIndex",intToStr(getSurfaceCellArraySize()), mapTagReplacements);
-		surfaceCellNode->addAttribute("exploredList",exploredList, mapTagReplacements);
-		surfaceCellNode->addAttribute("visibleList",visibleList, mapTagReplacements);
+	// visible cells follow from the unit sight stamps, only the explored
+	// cells need to be kept
+	for(unsigned int i = 0; i < (unsigned int)GameConstants::maxPlayers; ++i) {
+		XmlNode *teamExploredNode = mapNode->addChild("TeamExplored");
+		teamExploredNode->addAttribute("teamIndex",intToStr(i), mapTagReplacements);
+		teamExploredNode->addAttribute("runs",teamVisibility.getExploredRuns(i), mapTagReplacements);
 	}
 
 //	Vec2i *startLocations;
@@ -1898,80 +1911,50 @@ void Map::loadGame(const XmlNode *rootNode, World *world) {
 		surfaceCell.loadGame(mapNode,i,world);
 	}
 
+	vector<XmlNode *> teamExploredNodeList = mapNode->getChildList("TeamExplored");
+	for(unsigned int i = 0; i < teamExploredNodeList.size(); ++i) {
+		XmlNode *teamExploredNode = teamExploredNodeList[i];
+
+		int teamIndex = teamExploredNode->getAttribute("teamIndex")->getIntValue();
+		if(teamIndex >= 0 && teamIndex < teamVisibility.getTeamCount()) {
+			teamVisibility.setExploredRuns(teamIndex,teamExploredNode->getAttribute("runs")->getValue());
+		}
+	}
+
+	// saves from older versions list every cell
 	int surfaceCellIndexExplored = 0;
-	int surfaceCellIndexVisible = 0;
 	vector<XmlNode *> surfaceCellNodeList = mapNode->getChildList("SurfaceCell");
 	for(unsigned int i = 0; i < surfaceCellNodeList.size(); ++i) {
 		XmlNode *surfaceCellNode = surfaceCellNodeList[i];
 
-		//XmlNode *surfaceCellNode = mapNode->getChild("SurfaceCell");
 		string exploredList = surfaceCellNode->getAttribute("exploredList")->getValue();
-		string visibleList = surfaceCellNode->getAttribute("visibleList")->getValue();
-		//int batchIndex = surfaceCellNode->getAttribute("batchIndex")->getIntValue();
 
 		vector<string> tokensExplored;
 		Tokenize(exploredList,tokensExplored,",");
-
-		//printf("=====================\nNew batchIndex = %d batchsize = %d\n",batchIndex,tokensExplored.size());
-		//for(unsigned int j = 0; j < tokensExplored.size(); ++j) {
-			//string valueList = tokensExplored[j];
-			//printf("valueList [%s]\n",valueList.c_str());
-		//}
-		for(unsigned int j = 0; j < tokensExplored.size(); ++j) {
+		for(unsigned int j = 0; j < tokensExplored.size() &&
+			surfaceCellIndexExplored < getSurfaceCellArraySize(); ++j) {
 			string valueList = tokensExplored[j];
 
-			//int surfaceCellIndex = (i * tokensExplored.size()) + j;
-			//printf("Loading sc = %d batchIndex = %d\n",surfaceCellIndexExplored,batchIndex);
-			SurfaceCell &surfaceCell = surfaceCells[surfaceCellIndexExplored];
-
 			vector<string> tokensExploredValue;
 			Tokenize(valueList,tokensExploredValue,"|");
-
-//			if(tokensExploredValue.size() != GameConstants::maxPlayers) {
-//				for(unsigned int k = 0; k < tokensExploredValue.size(); ++k) {
-//					string value = tokensExploredValue[k];
-//					printf("k = %d [%s]\n",k,value.c_str());
-//				}
-//				throw megaglest_runtime_error("tokensExploredValue.size() [" + intToStr(tokensExploredValue.size()) + "] != GameConstants::maxPlayers");
-//			}
-			for(unsigned int k = 0; k < tokensExploredValue.size(); ++k) {
+			for(unsigned int k = 0; k < tokensExploredValue.size() &&
+				k < (unsigned int)teamVisibility.getTeamCount(); ++k) {
 				string value = tokensExploredValue[k];
 
-				surfaceCell.setExplored(k,strToInt(value) != 0);
-
-				//if(surfaceCell.isExplored(k) == true) {
-				//	printf("Setting cell at index: %d for team: %d to: %d [%s]\n",surfaceCellIndexExplored,k,surfaceCell.isExplored(k),value.c_str());
-				//}
+				teamVisibility.setExplored(k,surfaceCellIndexExplored % surfaceW,
+						surfaceCellIndexExplored / surfaceW,strToInt(value) != 0);
 			}
 			surfaceCellIndexExplored++;
 		}
-
-		vector<string> tokensVisible;
-		Tokenize(visibleList,tokensVisible,",");
-		for(unsigned int j = 0; j < tokensVisible.size(); ++j) {
-			string valueList = tokensVisible[j];
-
-			//int surfaceCellIndex = (i * tokensVisible.size()) + j;
-			SurfaceCell &surfaceCell = surfaceCells[surfaceCellIndexVisible];
-
-			vector<string> tokensVisibleValue;
-			Tokenize(valueList,tokensVisibleValue,"|");
-
-//			if(tokensVisibleValue.size() != GameConstants::maxPlayers) {
-//				throw megaglest_runtime_error("tokensVisibleValue.size() [" + intToStr(tokensVisibleValue.size()) + "] != GameConstants::maxPlayers");
-//			}
-
-			for(unsigned int k = 0; k < tokensVisibleValue.size(); ++k) {
-				string value = tokensVisibleValue[k];
-
-				surfaceCell.setVisible(k,strToInt(value) != 0);
-			}
-			surfaceCellIndexVisible++;
-		}
 	}
 
     computeNormals();
 	computeInterpolatedHeights();
+
+	if(clusterMap != NULL) {
+		clusterMap->setAllDirty();
+	}
+	moveCache.invalidate();
 }
 
 // =====================================================
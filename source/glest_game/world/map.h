@@ -28,6 +28,10 @@
 #include "unit_type.h"
 #include "command.h"
 #include "checksum.h"
+#include "cluster_graph.h"
+#include "cell_move_cache.h"
+#include "team_visibility_map.h"
+#include "cell_bucket_grid.h"
 #include "leak_dumper.h"
 
 
@@ -40,6 +44,11 @@ using Shared::Graphics::Vec4f;
 using Shared::Graphics::Vec2f;
 using Shared::Graphics::Vec2i;
 using Shared::Graphics::Texture2D;
+using Shared::Map::ClusterGraph;
+using Shared::Map::ClusterGraphPassability;
+using Shared::Map::CellMoveCache;
+using Shared::Map::TeamVisibilityMap;
+using Shared::Map::CellBucketGrid;
 
 class Tileset;
 class Unit;
@@ -47,6 +56,7 @@ class Resource;
 class TechTree;
 class GameSettings;
 class World;
+class Map;
 
 // =====================================================
 // 	class Cell
@@ -130,9 +140,10 @@ private:
 	//object & resource
 	Object *object;
 
-	//visibility
-	bool visible[GameConstants::maxPlayers + GameConstants::specialFactions];
-    bool explored[GameConstants::maxPlayers + GameConstants::specialFactions];
+	//visibility, kept per team by the map
+	const TeamVisibilityMap *teamVisibility;
+	int surfaceX;
+	int surfaceY;
 
 	//cache
 	bool nearSubmerged;
@@ -156,8 +167,14 @@ public:
 	inline const Vec2f &getSurfTexCoord() const		{return surfTexCoord;}
 	inline bool getNearSubmerged() const				{return nearSubmerged;}
 
-	inline bool isVisible(int teamIndex) const		{return visible[teamIndex];}
-	inline bool isExplored(int teamIndex) const		{return explored[teamIndex];}
+	inline bool isVisible(int teamIndex) const {
+		return teamIndex >= 0 && teamIndex < teamVisibility->getTeamCount() &&
+				teamVisibility->isVisible(teamIndex, surfaceX, surfaceY);
+	}
+	inline bool isExplored(int teamIndex) const {
+		return teamIndex >= 0 && teamIndex < teamVisibility->getTeamCount() &&
+				teamVisibility->isExplored(teamIndex, surfaceX, surfaceY);
+	}
 	string isVisibleString() const;
 	string isExploredString() const;
 
@@ -171,8 +188,7 @@ public:
 	inline void setObject(Object *object)				{this->object= object;}
 	inline void setFowTexCoord(const Vec2f &ftc)		{this->fowTexCoord= ftc;}
 	inline void setSurfTexCoord(const Vec2f &stc)		{this->surfTexCoord= stc;}
-	void setExplored(int teamIndex, bool explored);
-    void setVisible(int teamIndex, bool visible);
+	void setTeamVisibility(const TeamVisibilityMap *teamVisibility, int surfaceX, int surfaceY);
     inline void setNearSubmerged(bool nearSubmerged)	{this->nearSubmerged= nearSubmerged;}
 
 	//misc
@@ -199,13 +215,45 @@ public:
 ///	Represents the game map (and loads it from a gbm file)
 // =====================================================
 
-class FastAINodeCache {
+// =====================================================
+// 	class ClusterMap
+//
+///	Hierarchical path planning graph built from the map
+/// terrain and building footprints, one graph per field
+// =====================================================
+
+class ClusterMapPassability : public ClusterGraphPassability {
 public:
-	explicit FastAINodeCache(Unit *unit) {
-		this->unit = unit;
-	}
-	Unit *unit;
-	std::map<Vec2i,std::map<Vec2i,bool> > cachedCanMoveSoonList;
+	const Map *map;
+	Field field;
+
+	ClusterMapPassability() : map(NULL), field(fLand) {}
+	virtual bool isPassable(int x, int y) const;
+};
+
+class ClusterMap {
+private:
+	const Map *map;
+	ClusterMapPassability passability[fieldCount];
+	ClusterGraph graphs[fieldCount];
+	bool initialized;
+	// searches share the read lock, init and rebuilds take the write lock
+	ReadWriteMutex *mutex;
+
+	ClusterMap(ClusterMap&);
+	void operator=(ClusterMap&);
+
+	void initGraphs();
+
+public:
+	explicit ClusterMap(const Map *map);
+	~ClusterMap();
+
+	void setDirty(const Vec2i &pos, int size);
+	void setAllDirty();
+
+	int getClusterSize() const { return ClusterGraph::defaultClusterSize; }
+	bool findPath(Field field, const Vec2i &from, const Vec2i &to, std::vector<Vec2i> &waypoints);
 };
 
 class Map {
@@ -213,6 +261,15 @@ public:
 	static const int cellScale;	//number of cells per surfaceCell
 	static const int mapScale;	//horizontal scale of surface
 
+	enum MoveCacheQuery {
+		mcqCanMove,
+		mcqAproxCanMove,
+		mcqAproxCanMoveSoon,
+
+		mcqCount
+	};
+	static const int moveCacheMaxUnitSize = 4;
+
 private:
 	string title;
 	float waterLevel;
@@ -232,16 +289,27 @@ private:
 	Checksum checksumValue;
 	float maxMapHeight;
 	string mapFile;
+	ClusterMap *clusterMap;
+	mutable CellMoveCache moveCache;
+	TeamVisibilityMap teamVisibility;
+	CellBucketGrid<Unit *> unitGrid;
 
 private:
 	Map(Map&);
 	void operator=(Map&);
 
+	void setCellUnit(const Vec2i &pos, int field, Unit *unit);
+
 public:
 	Map();
 	~Map();
 	void end(); //to kill particles
 	Checksum * getChecksumValue() { return &checksumValue; }
+	ClusterMap * getClusterMap() const { return clusterMap; }
+	TeamVisibilityMap * getTeamVisibility() { return &teamVisibility; }
+	const TeamVisibilityMap * getTeamVisibility() const { return &teamVisibility; }
+	// units per cell and field, kept in step with Cell::getUnit
+	const CellBucketGrid<Unit *> & getUnitGrid() const { return unitGrid; }
 
 	void init(Tileset *tileset);
 	Checksum load(const string &path, TechTree *techTree, Tileset *tileset);
@@ -335,8 +403,9 @@ public:
 	//bool canOccupy(const Vec2i &pos, Field field, const UnitType *ut, CardinalDir facing);
 
 	//unit placement
-	bool aproxCanMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2, std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<int, std::map<Field,bool> > > > > *lookupCache=NULL) const;
-	bool canMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2,std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<Field,bool> > > > *lookupCache=NULL) const;
+	bool aproxCanMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2) const;
+	bool canMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2) const;
+	void invalidateMoveCache();
     void putUnitCells(Unit *unit, const Vec2i &pos,bool ignoreSkill = false, bool threaded = false);
 	void clearUnitCells(Unit *unit, const Vec2i &pos,bool ignoreSkill = false);
 
@@ -418,6 +487,11 @@ public:
 			throw megaglest_runtime_error("unit == NULL");
 		}
 
+		bool cachedResult = false;
+		if(aproxCanMoveSoonCached(unit, pos1, pos2, cachedResult) == true) {
+			return cachedResult;
+		}
+
 		int size= unit->getType()->getSize();
 		int teamIndex= unit->getTeam();
 		Field field= unit->getCurrField();
@@ -625,6 +699,14 @@ private:
 	void computeNearSubmerged();
 	void computeCellColors();
     void putUnitCellsPrivate(Unit *unit, const Vec2i &pos, const UnitType *ut, bool isMorph, bool threaded);
+
+	int getMoveCacheLayer(MoveCacheQuery query, const Unit *unit, int size, Field field) const;
+	bool isOwnFootprint(const Unit *unit, const Vec2i &pos, int size) const;
+	bool isBadHarvestMove(const Unit *unit, const Vec2i &pos) const;
+	bool areCellsFree(const Unit *unit, const Vec2i &pos, int size, Field field) const;
+	bool areCellsAproxFree(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2, int size, Field field, int teamIndex) const;
+	bool areCellsAproxFreeSoon(const Vec2i &originPos, const Vec2i &pos1, const Vec2i &pos2, Field field, int teamIndex) const;
+	bool aproxCanMoveSoonCached(Unit *unit, const Vec2i &pos1, const Vec2i &pos2, bool &result) const;
 };
 
 
@@ -42,6 +42,9 @@ Minimap::Minimap() {
 	gameSettings= NULL;
 	tex=NULL;
 	fowTex=NULL;
+	fowUpdateCount= 0;
+	fowLastUpdateFull= true;
+	fowFullUpdateNeeded= true;
 }
 
 void Minimap::init(int w, int h, const World *world, bool fogOfWar) {
@@ -71,6 +74,9 @@ void Minimap::init(int w, int h, const World *world, bool fogOfWar) {
 
 		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
+		fowCellUpdates.assign(potW * potH, 0);
+		fowFullUpdateNeeded= true;
+
 		fowPixmap0->setPixels(&f,1);
 		if((this->gameSettings->getFlagTypes1() & ft1_show_map_resources) == ft1_show_map_resources) {
 			f = 0.f;
@@ -148,9 +154,41 @@ void Minimap::incFowTextureAlphaSurface(const Vec2i sPos, float alpha,
 				fowPixmap1Copy->setPixel(sPos.x, sPos.y, alpha);
 			}
 		}
+		else if(isIncrementalUpdate == false) {
+			fowFullUpdateNeeded = true;
+		}
 	}
 }
 
+void Minimap::addFowChangedArea(const Vec2i &surfPos, int surfRadius) {
+	if(fowPixmap1 != NULL) {
+		fowNewAreas.push_back(FowArea(surfPos - Vec2i(surfRadius, surfRadius),
+				surfPos + Vec2i(surfRadius, surfRadius)));
+	}
+}
+
+bool Minimap::isFowAreaChanged(const Vec2i &surfPos, int surfRadius) const {
+	for(unsigned int index = 0; index < fowUpdateAreas.size(); ++index) {
+		const FowArea &area = fowUpdateAreas[index];
+		if(surfPos.x + surfRadius >= area.first.x && surfPos.x - surfRadius <= area.second.x &&
+			surfPos.y + surfRadius >= area.first.y && surfPos.y - surfRadius <= area.second.y) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Minimap::isFowCellChanged(const Vec2i &surfPos) const {
+	if(fowLastUpdateFull == true) {
+		return true;
+	}
+	if(fowPixmap1 == NULL || surfPos.x < 0 || surfPos.y < 0 ||
+		surfPos.x >= fowPixmap1->getW() || surfPos.y >= fowPixmap1->getH()) {
+		return false;
+	}
+	return fowCellUpdates[surfPos.y * fowPixmap1->getW() + surfPos.x] == fowUpdateCount;
+}
+
 void Minimap::copyFowTexAlphaSurface() {
 	if(fowPixmap1_default != NULL && fowPixmap1 != NULL) {
 		fowPixmap1_default->copy(fowPixmap1);
@@ -166,11 +204,13 @@ void Minimap::restoreFowTexAlphaSurface() {
 	if(fowPixmap1Copy != NULL && fowPixmap1Copy_default != NULL) {
 		fowPixmap1Copy->copy(fowPixmap1Copy_default);
 	}
+	fowFullUpdateNeeded = true;
 }
 
 void Minimap::setFogOfWar(bool value) {
 	fogOfWar = value;
 	resetFowTex();
+	fowFullUpdateNeeded = true;
 }
 
 void Minimap::copyFowTex() {
@@ -188,57 +228,124 @@ void Minimap::restoreFowTex() {
 	if(fowPixmap1 != NULL && fowPixmap1Copy != NULL) {
 		fowPixmap1->copy(fowPixmap1Copy);
 	}
+	fowFullUpdateNeeded = true;
 }
 
-void Minimap::resetFowTex() {
-	if(fowTex && fowPixmap0 && fowPixmap1) {
-		Pixmap2D *tmpPixmap= fowPixmap0;
-		fowPixmap0= fowPixmap1;
-		fowPixmap1= tmpPixmap;
-
-		// Could turn off ONLY fog of war by setting below to false
-		bool overridefogOfWarValue = fogOfWar;
+// Fades a cell like a full reset with fog of war does, without swapping
+// the pixmaps: pixmap 0 takes the last alpha and pixmap 1 the new one
+void Minimap::resetFowTexCell(int x, int y) {
+	float p0 = fowPixmap0->getPixelf(x, y);
+	float p1 = fowPixmap1->getPixelf(x, y);
+	fowPixmap0->setPixel(x, y, p1);
+	if(p1 <= p0) {
+		fowPixmap1->setPixel(x, y, min(p0, exploredAlpha));
+	}
+}
 
-		for(int indexPixelWidth = 0;
-				indexPixelWidth < fowTex->getPixmap()->getW();
-				++indexPixelWidth){
-			for(int indexPixelHeight = 0;
-					indexPixelHeight < fowTex->getPixmap()->getH();
-					++indexPixelHeight){
-				if ((fogOfWar == false && overridefogOfWarValue == false)) {
-					//(gameSettings->getFlagTypes1() & ft1_show_map_resources) != ft1_show_map_resources) {
-					//printf("Line: %d\n",__LINE__);
+bool Minimap::resetFowTex(bool changedAreasOnly) {
+	if(fowTex == NULL || fowPixmap0 == NULL || fowPixmap1 == NULL) {
+		return false;
+	}
 
-					float p0 = fowPixmap0->getPixelf(indexPixelWidth, indexPixelHeight);
-					float p1 = fowPixmap1->getPixelf(indexPixelWidth, indexPixelHeight);
-					if (p0 > p1) {
-						fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, p0);
-					}
-					else {
-						fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, p1);
+	fowUpdateCount++;
+	fowUpdateAreas = fowLastNewAreas;
+	fowUpdateAreas.insert(fowUpdateAreas.end(), fowNewAreas.begin(), fowNewAreas.end());
+	fowLastNewAreas.swap(fowNewAreas);
+	fowNewAreas.clear();
+
+	if(changedAreasOnly == true && fogOfWar == true && fowFullUpdateNeeded == false) {
+		const int w = fowPixmap1->getW();
+		const int h = fowPixmap1->getH();
+
+		fowUpdatedCells.clear();
+		for(unsigned int index = 0; index < fowUpdateAreas.size(); ++index) {
+			const FowArea &area = fowUpdateAreas[index];
+			for(int y = max(area.first.y, 0); y <= min(area.second.y, h - 1); ++y) {
+				for(int x = max(area.first.x, 0); x <= min(area.second.x, w - 1); ++x) {
+					int cellIndex = y * w + x;
+					if(fowCellUpdates[cellIndex] != fowUpdateCount) {
+						fowCellUpdates[cellIndex] = fowUpdateCount;
+						fowUpdatedCells.push_back(cellIndex);
 					}
 				}
-				else if((fogOfWar && overridefogOfWarValue) ||
-					(gameSettings->getFlagTypes1() & ft1_show_map_resources) == ft1_show_map_resources) {
-					//printf("Line: %d\n",__LINE__);
+			}
+		}
 
-					float p0= fowPixmap0->getPixelf(indexPixelWidth, indexPixelHeight);
-					float p1= fowPixmap1->getPixelf(indexPixelWidth, indexPixelHeight);
+		// cells the last update faded and this one leaves alone keep their alpha
+		if(fowLastUpdateFull == true) {
+			for(int cellIndex = 0; cellIndex < w * h; ++cellIndex) {
+				if(fowCellUpdates[cellIndex] != fowUpdateCount) {
+					fowPixmap0->setPixel(cellIndex % w, cellIndex / w, fowPixmap1->getPixelf(cellIndex % w, cellIndex / w));
+				}
+			}
+		}
+		else {
+			for(unsigned int index = 0; index < fowLastUpdatedCells.size(); ++index) {
+				int cellIndex = fowLastUpdatedCells[index];
+				if(fowCellUpdates[cellIndex] != fowUpdateCount) {
+					fowPixmap0->setPixel(cellIndex % w, cellIndex / w, fowPixmap1->getPixelf(cellIndex % w, cellIndex / w));
+				}
+			}
+		}
 
-					if(p1 > exploredAlpha) {
-						fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, exploredAlpha);
-					}
-					if(p0 > p1) {
-						fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, p0);
-					}
+		for(unsigned int index = 0; index < fowUpdatedCells.size(); ++index) {
+			resetFowTexCell(fowUpdatedCells[index] % w, fowUpdatedCells[index] / w);
+		}
+		fowLastUpdatedCells.swap(fowUpdatedCells);
+		fowLastUpdateFull = false;
+		return true;
+	}
+
+	fowLastUpdateFull = true;
+	fowFullUpdateNeeded = false;
+
+	Pixmap2D *tmpPixmap= fowPixmap0;
+	fowPixmap0= fowPixmap1;
+	fowPixmap1= tmpPixmap;
+
+	// Could turn off ONLY fog of war by setting below to false
+	bool overridefogOfWarValue = fogOfWar;
+
+	for(int indexPixelWidth = 0;
+			indexPixelWidth < fowTex->getPixmap()->getW();
+			++indexPixelWidth){
+		for(int indexPixelHeight = 0;
+				indexPixelHeight < fowTex->getPixmap()->getH();
+				++indexPixelHeight){
+			if ((fogOfWar == false && overridefogOfWarValue == false)) {
+				//(gameSettings->getFlagTypes1() & ft1_show_map_resources) != ft1_show_map_resources) {
+				//printf("Line: %d\n",__LINE__);
+
+				float p0 = fowPixmap0->getPixelf(indexPixelWidth, indexPixelHeight);
+				float p1 = fowPixmap1->getPixelf(indexPixelWidth, indexPixelHeight);
+				if (p0 > p1) {
+					fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, p0);
 				}
 				else {
-					//printf("Line: %d\n",__LINE__);
-					fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, 1.f);
+					fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, p1);
 				}
 			}
+			else if((fogOfWar && overridefogOfWarValue) ||
+				(gameSettings->getFlagTypes1() & ft1_show_map_resources) == ft1_show_map_resources) {
+				//printf("Line: %d\n",__LINE__);
+
+				float p0= fowPixmap0->getPixelf(indexPixelWidth, indexPixelHeight);
+				float p1= fowPixmap1->getPixelf(indexPixelWidth, indexPixelHeight);
+
+				if(p1 > exploredAlpha) {
+					fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, exploredAlpha);
+				}
+				if(p0 > p1) {
+					fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, p0);
+				}
+			}
+			else {
+				//printf("Line: %d\n",__LINE__);
+				fowPixmap1->setPixel(indexPixelWidth, indexPixelHeight, 1.f);
+			}
 		}
 	}
+	return false;
 }
 
 void Minimap::updateFowTex(float t) {
@@ -323,6 +430,7 @@ void Minimap::loadGame(const XmlNode *rootNode) {
 			fowPixmap1->getPixels()[pixelIndex] = fowPixmap1Node->getAttribute("pixel")->getIntValue();
 		}
 	}
+	fowFullUpdateNeeded = true;
 }
 
 }}//end namespace
@@ -20,6 +20,7 @@
 #include "pixmap.h"
 #include "texture.h"
 #include "xml_parser.h"
+#include <vector>
 #include "leak_dumper.h"
 
 namespace Glest{ namespace Game{
@@ -60,9 +61,27 @@ private:
 	bool fogOfWar;
 	const GameSettings *gameSettings;
 
+	// Areas of the fog of war texture whose team visibility changed. A
+	// cell that lost its sight fades over two updates, so an update only
+	// for changed areas rebuilds the ones of the last update as well.
+	typedef std::pair<Vec2i,Vec2i> FowArea;
+	std::vector<FowArea> fowNewAreas;
+	std::vector<FowArea> fowLastNewAreas;
+	std::vector<FowArea> fowUpdateAreas;
+	// update that last rebuilt each cell and the cells of the last update
+	std::vector<int> fowCellUpdates;
+	std::vector<int> fowUpdatedCells;
+	std::vector<int> fowLastUpdatedCells;
+	int fowUpdateCount;
+	bool fowLastUpdateFull;
+	// the pixmaps were changed outside an update
+	bool fowFullUpdateNeeded;
+
 private:
 	static const float exploredAlpha;
 
+	void resetFowTexCell(int x, int y);
+
 public:
     void init(int x, int y, const World *world, bool fogOfWar);
 	Minimap();
@@ -72,7 +91,13 @@ public:
 	const Texture2D *getTexture() const		{return tex;}
 
 	void incFowTextureAlphaSurface(const Vec2i sPos, float alpha, bool isIncrementalUpdate=false);
-	void resetFowTex();
+	// Starts a fog of war texture update. With changedAreasOnly only the
+	// changed areas are rebuilt when the texture allows it, the result
+	// tells whether it did.
+	bool resetFowTex(bool changedAreasOnly=false);
+	void addFowChangedArea(const Vec2i &surfPos, int surfRadius);
+	bool isFowAreaChanged(const Vec2i &surfPos, int surfRadius) const;
+	bool isFowCellChanged(const Vec2i &surfPos) const;
 	void updateFowTex(float t);
 	void setFogOfWar(bool value);
 
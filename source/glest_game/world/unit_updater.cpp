@@ -40,12 +40,9 @@ namespace Glest{ namespace Game{
 // 	class UnitUpdater
 // =====================================================
 
-time_t UnitRangeCellsLookupItem::lastDebug = 0;
-
 // ===================== PUBLIC ========================
 
-UnitUpdater::UnitUpdater() : mutexAttackWarnings(new Mutex(CODE_AT_LINE)),
-		mutexUnitRangeCellsLookupItemCache(new Mutex(CODE_AT_LINE)) {
+UnitUpdater::UnitUpdater() : mutexAttackWarnings(new Mutex(CODE_AT_LINE)) {
     this->game= NULL;
 	this->gui= NULL;
 	this->gameCamera= NULL;
@@ -54,7 +51,6 @@ UnitUpdater::UnitUpdater() : mutexAttackWarnings(new Mutex(CODE_AT_LINE)),
 	this->console= NULL;
 	this->scriptManager= NULL;
 	this->pathFinder = NULL;
-	//UnitRangeCellsLookupItemCacheTimerCount = 0;
 	attackWarnRange=0;
 }
 
@@ -69,7 +65,6 @@ void UnitUpdater::init(Game *game){
 	this->scriptManager= game->getScriptManager();
 	this->pathFinder = NULL;
 	attackWarnRange=Config::getInstance().getFloat("AttackWarnRange","50.0");
-	//UnitRangeCellsLookupItemCacheTimerCount = 0;
 
 	switch(this->game->getGameSettings()->getPathFinderType()) {
 		case pfBasic:
@@ -93,9 +88,16 @@ void UnitUpdater::removeUnitPrecache(Unit *unit) {
 	}
 }
 
-UnitUpdater::~UnitUpdater() {
-	//UnitRangeCellsLookupItemCache.clear();
+void UnitUpdater::commitPrecache(Faction *faction) {
+	if(faction != NULL) {
+		faction->commitPrecacheResourceTargets();
+	}
+	if(pathFinder != NULL) {
+		pathFinder->commitPrecache(faction);
+	}
+}
 
+UnitUpdater::~UnitUpdater() {
 	delete pathFinder;
 	pathFinder = NULL;
 
@@ -111,8 +113,6 @@ UnitUpdater::~UnitUpdater() {
 	delete mutexAttackWarnings;
 	mutexAttackWarnings = NULL;
 
-	delete mutexUnitRangeCellsLookupItemCache;
-	mutexUnitRangeCellsLookupItemCache = NULL;
 }
 
 // ==================== progress skills ====================
@@ -1822,6 +1822,10 @@ void UnitUpdater::updateHarvest(Unit *unit, int frameIndex) {
 								//const ResourceType *rt = r->getType();
 								sc->deleteResource();
 								world->removeResourceTargetFromCache(unitTargetPos);
+								if(map->getClusterMap() != NULL) {
+									map->getClusterMap()->setDirty(Map::toUnitCoords(Map::toSurfCoords(unitTargetPos)), Map::cellScale);
+								}
+								map->invalidateMoveCache();
 
 								switch(this->game->getGameSettings()->getPathFinderType()) {
 									case pfBasic:
@@ -2834,82 +2838,71 @@ bool UnitUpdater::attackableOnRange(Unit *unit, Unit **rangedPtr, const AttackSk
 	return unitOnRange(unit, range, rangedPtr, ast, evalMode);
 }
 
-bool UnitUpdater::findCachedCellsEnemies(Vec2i center, int range, int size, vector<Unit*> &enemies,
-										 const AttackSkillType *ast, const Unit *unit,
-										 const Unit *commandTarget) {
-	bool result = false;
-	MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache,string(__FILE__) + "_" + intToStr(__LINE__));
-	std::map<Vec2i, std::map<int, std::map<int, UnitRangeCellsLookupItem > > >::iterator iterFind = UnitRangeCellsLookupItemCache.find(center);
-
-	if(iterFind != UnitRangeCellsLookupItemCache.end()) {
-		std::map<int, std::map<int, UnitRangeCellsLookupItem > >::iterator iterFind3 = iterFind->second.find(size);
-		if(iterFind3 != iterFind->second.end()) {
-			std::map<int, UnitRangeCellsLookupItem>::iterator iterFind4 = iterFind3->second.find(range);
-			if(iterFind4 != iterFind3->second.end()) {
-				result = true;
-
-				std::vector<Cell *> &cellList = iterFind4->second.rangeCellList;
-				for(int idx = 0; idx < (int)cellList.size(); ++idx) {
-					Cell *cell = cellList[idx];
-
-					findEnemiesForCell(ast,cell,unit,commandTarget,enemies);
-				}
-			}
+// Collects the units held by the cells in range, in the order a column by
+// column scan of those cells would find them
+void UnitUpdater::findUnitCellsInRange(const Vec2i &center, const Vec2f &floatCenter, int range,
+										int size, vector<UnitCellEntry> &cellUnits) const {
+	map->getUnitGrid().query(center.x - range, center.y - range,
+							center.x + range + size - 1, center.y + range + size - 1, cellUnits);
+
+	int inRangeCount = 0;
+	for(int idx = 0; idx < (int)cellUnits.size(); ++idx) {
+		const UnitCellEntry &cellUnit = cellUnits[idx];
+		//cells in range
+#ifdef USE_STREFLOP
+		if(streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float)cellUnit.x, (float)cellUnit.y)))) <= (range+1)) {
+#else
+		if(floor(floatCenter.dist(Vec2f((float)cellUnit.x, (float)cellUnit.y))) <= (range+1)) {
+#endif
+			cellUnits[inRangeCount++] = cellUnit;
 		}
 	}
-
-	return result;
+	cellUnits.resize(inRangeCount);
 }
 
-void UnitUpdater::findEnemiesForCell(const AttackSkillType *ast, Cell *cell, const Unit *unit,
+void UnitUpdater::findEnemiesForCell(const AttackSkillType *ast, const UnitCellEntry &cellUnit, const Unit *unit,
 									 const Unit *commandTarget,vector<Unit*> &enemies) {
-	//all fields
-	for(int k = 0; k < fieldCount; k++) {
-		Field f= static_cast<Field>(k);
+	Field f= static_cast<Field>(cellUnit.layer);
 
-		//check field
-		if((ast == NULL || ast->getAttackField(f))) {
-			Unit *possibleEnemy = cell->getUnit(f);
+	//check field
+	if((ast == NULL || ast->getAttackField(f))) {
+		Unit *possibleEnemy = cellUnit.item;
 
-			//check enemy
-			if(possibleEnemy != NULL && possibleEnemy->isAlive()) {
-				if((unit->isAlly(possibleEnemy) == false && commandTarget == NULL) ||
-					commandTarget == possibleEnemy) {
+		//check enemy
+		if(possibleEnemy != NULL && possibleEnemy->isAlive()) {
+			if((unit->isAlly(possibleEnemy) == false && commandTarget == NULL) ||
+				commandTarget == possibleEnemy) {
 
-					enemies.push_back(possibleEnemy);
-				}
+				enemies.push_back(possibleEnemy);
 			}
 		}
 	}
 }
 
 void UnitUpdater::findEnemiesForCell(const Vec2i pos, int size, int sightRange, const Faction *faction, vector<Unit*> &enemies, bool attackersOnly) const {
+	vector<UnitCellEntry> cellUnits;
+	map->getUnitGrid().query(pos.x - sightRange, pos.y - sightRange,
+							pos.x + size + sightRange - 1, pos.y + size + sightRange - 1, cellUnits);
+
 	//all fields
 	for(int k = 0; k < fieldCount; k++) {
-		Field f= static_cast<Field>(k);
-
-		for(int i = pos.x - sightRange; i < pos.x + size + sightRange; ++i) {
-			for(int j = pos.y - sightRange; j < pos.y + size + sightRange; ++j) {
-				Vec2i testPos(i,j);
-				if( map->isInside(testPos) &&
-						map->isInsideSurface(map->toSurfCoords(testPos))) {
-					Cell *cell = map->getCell(testPos);
-					//check field
-					Unit *possibleEnemy = cell->getUnit(f);
-
-					//check enemy
-					if(possibleEnemy != NULL && possibleEnemy->isAlive()) {
-						if(faction->getTeam() != possibleEnemy->getTeam()) {
-							if(attackersOnly == true) {
-								if(possibleEnemy->getType()->hasCommandClass(ccAttack) || possibleEnemy->getType()->hasCommandClass(ccAttackStopped)) {
-									enemies.push_back(possibleEnemy);
-								}
-							}
-							else {
-								enemies.push_back(possibleEnemy);
-							}
+		for(int idx = 0; idx < (int)cellUnits.size(); ++idx) {
+			if(cellUnits[idx].layer != k) {
+				continue;
+			}
+			Unit *possibleEnemy = cellUnits[idx].item;
+
+			//check enemy
+			if(possibleEnemy != NULL && possibleEnemy->isAlive()) {
+				if(faction->getTeam() != possibleEnemy->getTeam()) {
+					if(attackersOnly == true) {
+						if(possibleEnemy->getType()->hasCommandClass(ccAttack) || possibleEnemy->getType()->hasCommandClass(ccAttackStopped)) {
+							enemies.push_back(possibleEnemy);
 						}
 					}
+					else {
+						enemies.push_back(possibleEnemy);
+					}
 				}
 			}
 		}
@@ -2938,36 +2931,11 @@ bool UnitUpdater::unitOnRange(Unit *unit, int range, Unit **rangedPtr,
 	Vec2i center 		= unit->getPos();
 	Vec2f floatCenter	= unit->getFloatCenteredPos();
 
-	//bool foundInCache = true;
-	if(findCachedCellsEnemies(center,range,size,enemies,ast,
-							  unit,commandTarget) == false) {
-
-		//foundInCache = false;
-		//nearby cells
-		UnitRangeCellsLookupItem cacheItem;
-		for(int i = center.x - range; i < center.x + range + size; ++i) {
-			for(int j = center.y - range; j < center.y + range + size; ++j) {
-				//cells inside map and in range
-#ifdef USE_STREFLOP
-				if(map->isInside(i, j) && streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float)i, (float)j)))) <= (range+1)){
-#else
-				if(map->isInside(i, j) && floor(floatCenter.dist(Vec2f((float)i, (float)j))) <= (range+1)){
-#endif
-					Cell *cell = map->getCell(i,j);
-					findEnemiesForCell(ast,cell,unit,commandTarget,enemies);
-
-					cacheItem.rangeCellList.push_back(cell);
-				}
-			}
-		}
-
-
-		// Ok update our caches with the latest info
-		if(cacheItem.rangeCellList.empty() == false) {
-			MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache,string(__FILE__) + "_" + intToStr(__LINE__));
-
-			UnitRangeCellsLookupItemCache[center][size][range] = cacheItem;
-		}
+	//nearby cells
+	vector<UnitCellEntry> cellUnits;
+	findUnitCellsInRange(center,floatCenter,range,size,cellUnits);
+	for(int idx = 0; idx < (int)cellUnits.size(); ++idx) {
+		findEnemiesForCell(ast,cellUnits[idx],unit,commandTarget,enemies);
 	}
 
 	//attack enemies that can attack first
@@ -3220,35 +3188,11 @@ vector<Unit*> UnitUpdater::enemyUnitsOnRange(const Unit *unit,const AttackSkillT
 	Vec2i center 		= unit->getPosNotThreadSafe();
 	Vec2f floatCenter	= unit->getFloatCenteredPos();
 
-	//bool foundInCache = true;
-	if(findCachedCellsEnemies(center,range,size,enemies,ast,
-							  unit,commandTarget) == false) {
-
-		//foundInCache = false;
-		//nearby cells
-		UnitRangeCellsLookupItem cacheItem;
-		for(int i = center.x - range; i < center.x + range + size; ++i) {
-			for(int j = center.y - range; j < center.y + range + size; ++j) {
-				//cells inside map and in range
-#ifdef USE_STREFLOP
-				if(map->isInside(i, j) && streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float)i, (float)j)))) <= (range+1)){
-#else
-				if(map->isInside(i, j) && floor(floatCenter.dist(Vec2f((float)i, (float)j))) <= (range+1)){
-#endif
-					Cell *cell = map->getCell(i,j);
-					findEnemiesForCell(ast,cell,unit,commandTarget,enemies);
-
-					cacheItem.rangeCellList.push_back(cell);
-				}
-			}
-		}
-
-		// Ok update our caches with the latest info
-		if(cacheItem.rangeCellList.empty() == false) {
-			MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache,string(__FILE__) + "_" + intToStr(__LINE__));
-
-			UnitRangeCellsLookupItemCache[center][size][range] = cacheItem;
-		}
+	//nearby cells
+	vector<UnitCellEntry> cellUnits;
+	findUnitCellsInRange(center,floatCenter,range,size,cellUnits);
+	for(int idx = 0; idx < (int)cellUnits.size(); ++idx) {
+		findEnemiesForCell(ast,cellUnits[idx],unit,commandTarget,enemies);
 	}
 
 	}
@@ -3271,33 +3215,22 @@ vector<Unit*> UnitUpdater::enemyUnitsOnRange(const Unit *unit,const AttackSkillT
 }
 
 
-void UnitUpdater::findUnitsForCell(Cell *cell, vector<Unit*> &units) {
-	//all fields
-	if(cell != NULL) {
-		for(int k = 0; k < fieldCount; k++) {
-			Field f= static_cast<Field>(k);
-
-			//check field
-			Unit *cellUnit = cell->getUnit(f);
-
-			if(cellUnit != NULL && cellUnit->isAlive()) {
-				// check if unit already is in list
-				bool found = false;
-				//printf("---- search for cellUnit=%d\n",cellUnit->getId());
-				for (unsigned int i = 0; i < units.size(); ++i) {
-					Unit *unitInList = units[i];
-					//printf("compare unitInList=%d cellUnit=%d\n",unitInList->getId(),cellUnit->getId());
-					if (unitInList->getId() == cellUnit->getId()){
-						found=true;
-						break;
-					}
-				}
-				if(found==false){
-					//printf(">>> adding cellUnit=%d\n",cellUnit->getId());
-					units.push_back(cellUnit);
-				}
+void UnitUpdater::findUnitsForCell(const UnitCellEntry &cellUnit, vector<Unit*> &units) {
+	Unit *cellUnitPtr = cellUnit.item;
+
+	if(cellUnitPtr != NULL && cellUnitPtr->isAlive()) {
+		// check if unit already is in list
+		bool found = false;
+		for (unsigned int i = 0; i < units.size(); ++i) {
+			Unit *unitInList = units[i];
+			if (unitInList->getId() == cellUnitPtr->getId()){
+				found=true;
+				break;
 			}
 		}
+		if(found==false){
+			units.push_back(cellUnitPtr);
+		}
 	}
 }
 
@@ -3311,56 +3244,24 @@ vector<Unit*> UnitUpdater::findUnitsInRange(const Unit *unit, int radius) {
 	Vec2f floatCenter	= unit->getFloatCenteredPos();
 
 	//nearby cells
-	//UnitRangeCellsLookupItem cacheItem;
-	for(int i = center.x - range; i < center.x + range + size; ++i) {
-		for(int j = center.y - range; j < center.y + range + size; ++j) {
-			//cells inside map and in range
-#ifdef USE_STREFLOP
-			if(map->isInside(i, j) && streflop::floor(static_cast<streflop::Simple>(floatCenter.dist(Vec2f((float)i, (float)j)))) <= (range+1)){
-#else
-			if(map->isInside(i, j) && floor(floatCenter.dist(Vec2f((float)i, (float)j))) <= (range+1)){
-#endif
-				Cell *cell = map->getCell(i,j);
-				findUnitsForCell(cell,units);
-			}
-		}
+	vector<UnitCellEntry> cellUnits;
+	findUnitCellsInRange(center,floatCenter,range,size,cellUnits);
+	for(int idx = 0; idx < (int)cellUnits.size(); ++idx) {
+		findUnitsForCell(cellUnits[idx],units);
 	}
 
 	return units;
 }
 
-string UnitUpdater::getUnitRangeCellsLookupItemCacheStats() {
+string UnitUpdater::getUnitGridStats() {
 	string result = "";
+	if(map != NULL) {
+		const CellBucketGrid<Unit *> &unitGrid = map->getUnitGrid();
 
-	int posCount = 0;
-	int sizeCount = 0;
-	int rangeCount = 0;
-	int rangeCountCellCount = 0;
-
-	MutexSafeWrapper safeMutex(mutexUnitRangeCellsLookupItemCache,string(__FILE__) + "_" + intToStr(__LINE__));
-	for(std::map<Vec2i, std::map<int, std::map<int, UnitRangeCellsLookupItem > > >::iterator iterMap1 = UnitRangeCellsLookupItemCache.begin();
-		iterMap1 != UnitRangeCellsLookupItemCache.end(); ++iterMap1) {
-		posCount++;
-
-		for(std::map<int, std::map<int, UnitRangeCellsLookupItem > >::iterator iterMap2 = iterMap1->second.begin();
-			iterMap2 != iterMap1->second.end(); ++iterMap2) {
-			sizeCount++;
-
-			for(std::map<int, UnitRangeCellsLookupItem>::iterator iterMap3 = iterMap2->second.begin();
-				iterMap3 != iterMap2->second.end(); ++iterMap3) {
-				rangeCount++;
-
-				rangeCountCellCount += (int)iterMap3->second.rangeCellList.size();
-			}
-		}
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"unit cells [%d] buckets [%d]",unitGrid.getEntryCount(),unitGrid.getBucketCount());
+		result = szBuf;
 	}
-
-	uint64 totalBytes = rangeCountCellCount * sizeof(Cell *);
-	totalBytes /= 1000;
-
-	char szBuf[8096]="";
-	snprintf(szBuf,8096,"pos [%d] size [%d] range [%d][%d] total KB: %s",posCount,sizeCount,rangeCount,rangeCountCellCount,formatNumber(totalBytes).c_str());
-	result = szBuf;
 	return result;
 }
 
@@ -21,10 +21,12 @@
 #include "particle.h"
 #include "randomgen.h"
 #include "command.h"
+#include "cell_bucket_grid.h"
 #include "leak_dumper.h"
 
 using Shared::Graphics::ParticleObserver;
 using Shared::Util::RandomGen;
+using Shared::Map::CellBucketGrid;
 
 namespace Glest{ namespace Game{
 
@@ -44,15 +46,6 @@ class PathFinder;
 class ParticleDamager;
 class Cell;
 
-class UnitRangeCellsLookupItem {
-public:
-
-	//int UnitRangeCellsLookupItemCacheTimerCountIndex;
-	std::vector<Cell *> rangeCellList;
-
-	static time_t lastDebug;
-};
-
 class AttackWarningData {
 public:
 	Vec2f attackPosition;
@@ -84,16 +77,11 @@ private:
 	float attackWarnRange;
 	AttackWarnings attackWarnings;
 
-	Mutex *mutexUnitRangeCellsLookupItemCache;
-	std::map<Vec2i, std::map<int, std::map<int, UnitRangeCellsLookupItem > > > UnitRangeCellsLookupItemCache;
-	//std::map<int,ExploredCellsLookupKey> ExploredCellsLookupItemCacheTimer;
-	//int UnitRangeCellsLookupItemCacheTimerCount;
+	typedef CellBucketGrid<Unit *>::Entry UnitCellEntry;
 
-	bool findCachedCellsEnemies(Vec2i center, int range,
-								int size, vector<Unit*> &enemies,
-								const AttackSkillType *ast, const Unit *unit,
-								const Unit *commandTarget);
-	void findEnemiesForCell(const AttackSkillType *ast, Cell *cell, const Unit *unit,
+	void findUnitCellsInRange(const Vec2i &center, const Vec2f &floatCenter, int range,
+								int size, vector<UnitCellEntry> &cellUnits) const;
+	void findEnemiesForCell(const AttackSkillType *ast, const UnitCellEntry &cellUnit, const Unit *unit,
 							const Unit *commandTarget,vector<Unit*> &enemies);
 
 public:
@@ -121,6 +109,7 @@ public:
 
 	void clearUnitPrecache(Unit *unit);
 	void removeUnitPrecache(Unit *unit);
+	void commitPrecache(Faction *faction);
 
 	inline unsigned int getAttackWarningCount() const { return (unsigned int)attackWarnings.size(); }
 	std::pair<bool,Unit *> unitBeingAttacked(const Unit *unit);
@@ -130,7 +119,7 @@ public:
 
 	vector<Unit*> findUnitsInRange(const Unit *unit, int radius);
 
-	string getUnitRangeCellsLookupItemCacheStats();
+	string getUnitGridStats();
 
 	void saveGame(XmlNode *rootNode);
 	void loadGame(const XmlNode *rootNode);
@@ -161,7 +150,7 @@ private:
 	void SwapActiveCommandState(Unit *unit, CommandStateType commandStateType,
 								const CommandType *commandType,
 								int originalValue,int newValue);
-	void findUnitsForCell(Cell *cell, vector<Unit*> &units);
+	void findUnitsForCell(const UnitCellEntry &cellUnit, vector<Unit*> &units);
 
 };
 
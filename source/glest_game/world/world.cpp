@@ -26,6 +26,7 @@
 #include <iostream>
 #include "sound.h"
 #include "sound_renderer.h"
+#include "sim_benchmark.h"
 
 #include "leak_dumper.h"
 
@@ -38,11 +39,6 @@ namespace Glest{ namespace Game{
 // 	class World
 // =====================================================
 
-// This limit is to keep RAM use under control while offering better performance.
-int MaxExploredCellsLookupItemCache = 9500;
-//int MaxExploredCellsLookupItemCache = 0;
-time_t ExploredCellsLookupItem::lastDebug = 0;
-
 // ===================== PUBLIC ========================
 
 World::World() : mutexFactionNextUnitId(new Mutex(CODE_AT_LINE)) {
@@ -53,9 +49,7 @@ World::World() : mutexFactionNextUnitId(new Mutex(CODE_AT_LINE)) {
 
 	animatedTilesetObjectPosListLoaded = false;
 
-	ExploredCellsLookupItemCache.clear();
-	ExploredCellsLookupItemCacheTimer.clear();
-	ExploredCellsLookupItemCacheTimerCount = 0;
+	retiredSightStamps.clear();
 
 	nextCommandGroupId = 0;
 	techTree = NULL;
@@ -80,6 +74,7 @@ World::World() : mutexFactionNextUnitId(new Mutex(CODE_AT_LINE)) {
 	disableAttackEffects = false;
 
 	loadWorldNode = NULL;
+	unitUpdateScheduler = NULL;
 	cacheFowAlphaTexture = false;
 	cacheFowAlphaTextureFogOfWarValue = false;
 
@@ -91,8 +86,7 @@ void World::cleanup() {
 
 	animatedTilesetObjectPosListLoaded = false;
 
-	ExploredCellsLookupItemCache.clear();
-	ExploredCellsLookupItemCacheTimer.clear();
+	retiredSightStamps.clear();
 	//FowAlphaCellsLookupItemCache.clear();
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
@@ -102,6 +96,8 @@ void World::cleanup() {
 	}
 
 	masterController.clearSlaves(true);
+	delete unitUpdateScheduler;
+	unitUpdateScheduler = NULL;
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 	for(int i= 0; i < (int)factions.size(); ++i){
 		delete factions[i];
@@ -155,8 +151,7 @@ void World::endScenario() {
 
     animatedTilesetObjectPosListLoaded = false;
 
-    ExploredCellsLookupItemCache.clear();
-    ExploredCellsLookupItemCacheTimer.clear();
+    retiredSightStamps.clear();
 
 	fogOfWarOverride = false;
 	originalGameFogOfWar = fogOfWar;
@@ -176,14 +171,15 @@ void World::end(){
 
     animatedTilesetObjectPosListLoaded = false;
 
-    ExploredCellsLookupItemCache.clear();
-    ExploredCellsLookupItemCacheTimer.clear();
+    retiredSightStamps.clear();
 
 	for(int i= 0; i < (int)factions.size(); ++i){
 		factions[i]->end();
 	}
 
 	masterController.clearSlaves(true);
+	delete unitUpdateScheduler;
+	unitUpdateScheduler = NULL;
 	for(int i= 0; i < (int)factions.size(); ++i){
 		delete factions[i];
 	}
@@ -327,8 +323,7 @@ void World::init(Game *game, bool createUnits, bool initFactions){
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
-	ExploredCellsLookupItemCache.clear();
-	ExploredCellsLookupItemCacheTimer.clear();
+	retiredSightStamps.clear();
 
 	this->game = game;
 	scriptManager= game->getScriptManager();
@@ -392,24 +387,14 @@ void World::init(Game *game, bool createUnits, bool initFactions){
 		map.loadGame(loadWorldNode,this);
 
 		if(fogOfWar == false) {
-		    for(int i=0; i< map.getSurfaceW(); ++i) {
-		        for(int j=0; j< map.getSurfaceH(); ++j) {
-
-					SurfaceCell *sc= map.getSurfaceCell(i, j);
-					if(sc == NULL) {
-						throw megaglest_runtime_error("sc == NULL");
-					}
-
-					for (int k = 0; k < GameConstants::maxPlayers; k++) {
-						//sc->setExplored(k, (game->getGameSettings()->getFlagTypes1() & ft1_show_map_resources) == ft1_show_map_resources);
-						sc->setVisible(k, !fogOfWar);
-					}
-					for (int k = GameConstants::maxPlayers; k < GameConstants::maxPlayers + GameConstants::specialFactions; k++) {
-						sc->setExplored(k, true);
-						sc->setVisible(k, true);
-					}
-		        }
-		    }
+			TeamVisibilityMap *teamVisibility = map.getTeamVisibility();
+			for (int k = 0; k < GameConstants::maxPlayers; k++) {
+				teamVisibility->setRevealed(k, !fogOfWar);
+			}
+			for (int k = GameConstants::maxPlayers; k < GameConstants::maxPlayers + GameConstants::specialFactions; k++) {
+				teamVisibility->setAllExplored(k, true);
+				teamVisibility->setRevealed(k, true);
+			}
 		}
 		else {
 			restoreExploredFogOfWarCells();
@@ -573,7 +558,50 @@ void World::updateAllTilesetObjects() {
 //	}
 }
 
+// =====================================================
+// 	class UnitUpdateTaskList
+//
+///	Pre-processes one unit per task on the unit update
+/// scheduler. Units of one faction run on several workers
+/// at once, whatever they share is only read while they
+/// run and their results are committed in unit order.
+// =====================================================
+
+class UnitUpdateTaskList : public WorkStealingTaskInterface {
+private:
+	UnitUpdater *unitUpdater;
+	int frameIndex;
+	std::vector<Unit *> units;
+
+public:
+	UnitUpdateTaskList(UnitUpdater *unitUpdater, int frameIndex) {
+		this->unitUpdater = unitUpdater;
+		this->frameIndex = frameIndex;
+	}
+
+	void addUnit(Unit *unit) {
+		if(unit == NULL) {
+			throw megaglest_runtime_error("unit == NULL");
+		}
+		units.push_back(unit);
+	}
+	int getUnitCount() const { return (int)units.size(); }
+
+	virtual void executeTask(int workerIndex, int taskIndex) {
+		Unit *unit = units[taskIndex];
+		if(unit->needToUpdate() == true) {
+			unitUpdater->updateUnitCommand(unit,frameIndex);
+		}
+	}
+};
+
+bool World::isUnitUpdateSchedulerEnabled() {
+	return Config::getInstance().getBool("EnableUnitUpdateScheduler","true");
+}
+
 void World::updateAllFactionUnits() {
+	SimBenchmarkTimer benchmarkTimer(sbsUnitUpdates);
+
 	bool showPerfStats = Config::getInstance().getBool("ShowPerfStats","false");
 	Chrono chronoPerf;
 	if(showPerfStats) chronoPerf.start();
@@ -618,7 +646,36 @@ void World::updateAllFactionUnits() {
 	chrono.start();
 
 	const bool newThreadManager = Config::getInstance().getBool("EnableNewThreadManager","false");
-	if(newThreadManager == true) {
+	if(unitUpdateScheduler != NULL) {
+		// Pre-process the units of every faction on the scheduler pool, the
+		// results are committed per faction in unit order further down
+		UnitUpdateTaskList taskList(&unitUpdater,frameCount);
+		for(int i = 0; i < factionCount; ++i) {
+			Faction *faction = getFaction(i);
+			int unitCount = faction->getUnitCount();
+			for(int j = 0; j < unitCount; ++j) {
+				taskList.addUnit(faction->getUnit(j));
+			}
+		}
+
+		// the threaded synch logs are plain lists, keep them in unit order
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled == true) {
+			for(int index = 0; index < taskList.getUnitCount(); ++index) {
+				taskList.executeTask(0,index);
+			}
+		}
+		else {
+			unitUpdateScheduler->run(&taskList,taskList.getUnitCount());
+		}
+
+		if(SystemFlags::VERBOSE_MODE_ENABLED && chrono.getMillis() >= 10) printf("In [%s::%s Line: %d] *** Unit scheduler preprocessing took [%lld] msecs for %d units on %d workers for frameCount = %d.\n",__FILE__,__FUNCTION__,__LINE__,(long long int)chrono.getMillis(),taskList.getUnitCount(),unitUpdateScheduler->getWorkerCount(),frameCount);
+
+		if(showPerfStats) {
+			sprintf(perfBuf,"In [%s::%s] Line: %d took msecs: " MG_I64_SPECIFIER "\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chronoPerf.getMillis());
+			perfList.push_back(perfBuf);
+		}
+	}
+	else if(newThreadManager == true) {
 		masterController.signalSlaves(&frameCount);
 		bool slavesCompleted = masterController.waitTillSlavesTrigger(20000);
 
@@ -685,6 +742,7 @@ void World::updateAllFactionUnits() {
 		Faction *faction = getFaction(i);
 
 		faction->dumpWorldSynchThreadedLogList();
+		unitUpdater.commitPrecache(faction);
 		faction->clearUnitsPathfinding();
 
 		std::map<CommandClass,int> mapCommandCount;
@@ -1716,10 +1774,6 @@ void World::moveToUnit(int unitId, int destUnitId) {
 }
 
 void World::clearCaches() {
-	ExploredCellsLookupItemCache.clear();
-	ExploredCellsLookupItemCacheTimer.clear();
-	ExploredCellsLookupItemCacheTimerCount = 0;
-
 	unitUpdater.clearCaches();
 }
 
@@ -1955,6 +2009,17 @@ void World::initCells(bool fogOfWar) {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 
 	Logger::getInstance().add(Lang::getInstance().getString("LogScreenGameLoadingStateCells","",true), true);
+
+	TeamVisibilityMap *teamVisibility = map.getTeamVisibility();
+	for (int k = 0; k < GameConstants::maxPlayers; k++) {
+		teamVisibility->setAllExplored(k, (game->getGameSettings()->getFlagTypes1() & ft1_show_map_resources) == ft1_show_map_resources);
+		teamVisibility->setRevealed(k, !fogOfWar);
+	}
+	for (int k = GameConstants::maxPlayers; k < GameConstants::maxPlayers + GameConstants::specialFactions; k++) {
+		teamVisibility->setAllExplored(k, true);
+		teamVisibility->setRevealed(k, true);
+	}
+
     for(int i=0; i< map.getSurfaceW(); ++i) {
         for(int j=0; j< map.getSurfaceH(); ++j) {
 
@@ -1969,16 +2034,6 @@ void World::initCells(bool fogOfWar) {
 				i/(next2Power(map.getSurfaceW())-1.f),
 				j/(next2Power(map.getSurfaceH())-1.f)));
 
-			for (int k = 0; k < GameConstants::maxPlayers; k++) {
-				sc->setExplored(k, (game->getGameSettings()->getFlagTypes1() & ft1_show_map_resources) == ft1_show_map_resources);
-				sc->setVisible(k, !fogOfWar);
-			}
-
-			for (int k = GameConstants::maxPlayers; k < GameConstants::maxPlayers + GameConstants::specialFactions; k++) {
-				sc->setExplored(k, true);
-				sc->setVisible(k, true);
-			}
-
 			if(SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled == true) {
 				char szBuf[8096]="";
 				snprintf(szBuf,8096,"In initCells() x = %d y = %d %s %s",i,j,sc->isVisibleString().c_str(),sc->isExploredString().c_str());
@@ -1989,6 +2044,7 @@ void World::initCells(bool fogOfWar) {
 			}
 		}
     }
+
     if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 }
 
@@ -2087,7 +2143,11 @@ void World::initFactionTypes(GameSettings *gs) {
 		}
 	}
 
-	if(Config::getInstance().getBool("EnableNewThreadManager","false") == true) {
+	if(isUnitUpdateSchedulerEnabled() == true) {
+		delete unitUpdateScheduler;
+		unitUpdateScheduler = new WorkStealingScheduler(Config::getInstance().getInt("UnitUpdateSchedulerThreads","0"));
+	}
+	else if(Config::getInstance().getBool("EnableNewThreadManager","false") == true) {
 		std::vector<SlaveThreadControllerInterface *> slaveThreadList;
 		for(unsigned int i = 0; i < factions.size(); ++i) {
 			Faction *faction = factions[i];
@@ -2341,144 +2401,51 @@ void World::initMap() {
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
 }
 
-void World::exploreCells(int teamIndex, ExploredCellsLookupItem &exploredCellsCache) {
-	std::vector<SurfaceCell*> &cellList = exploredCellsCache.exploredCellList;
-	for (int idx2 = 0; idx2 < (int)cellList.size(); ++idx2) {
-		SurfaceCell* sc = cellList[idx2];
-		sc->setExplored(teamIndex, true);
-	}
-	cellList = exploredCellsCache.visibleCellList;
-	for (int idx2 = 0; idx2 < (int)cellList.size(); ++idx2) {
-		SurfaceCell* sc = cellList[idx2];
-		sc->setVisible(teamIndex, true);
-	}
-}
-
 // ==================== exploration ====================
 
-ExploredCellsLookupItem World::exploreCells(const Vec2i &newPos, int sightRange, int teamIndex, Unit *unit) {
-	// cache lookup of previously calculated cells + sight range
-	if(MaxExploredCellsLookupItemCache > 0) {
-		if(difftime(time(NULL),ExploredCellsLookupItem::lastDebug) >= 10) {
-			ExploredCellsLookupItem::lastDebug = time(NULL);
-			if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] ExploredCellsLookupItemCache.size() = %d\n",__FILE__,__FUNCTION__,__LINE__,ExploredCellsLookupItemCache.size());
-			if(SystemFlags::getSystemSettingType(SystemFlags::debugPerformance).enabled) SystemFlags::OutputDebug(SystemFlags::debugPerformance,"In [%s::%s Line: %d] ExploredCellsLookupItemCache.size() = %d\n",__FILE__,__FUNCTION__,__LINE__,ExploredCellsLookupItemCache.size());
-		}
-
-		// Ok we limit the cache size due to possible RAM constraints when
-		// the threshold is met
-		bool MaxExploredCellsLookupItemCacheTriggered = false;
-		if((int)ExploredCellsLookupItemCache.size() >= MaxExploredCellsLookupItemCache) {
-			MaxExploredCellsLookupItemCacheTriggered = true;
-			// Snag the oldest entry in the list
-			std::map<int,ExploredCellsLookupKey>::reverse_iterator purgeItem = ExploredCellsLookupItemCacheTimer.rbegin();
+void World::applySightStamp(int teamIndex, const Vec2i &pos, int sightRange, Unit *unit) {
+	SimBenchmarkTimer benchmarkTimer(sbsFogOfWar);
 
-			ExploredCellsLookupItemCache[purgeItem->second.pos].erase(purgeItem->second.sightRange);
-
-			if(ExploredCellsLookupItemCache[purgeItem->second.pos].empty() == true) {
-				ExploredCellsLookupItemCache.erase(purgeItem->second.pos);
-			}
+	Vec2i surfPos= Map::toSurfCoords(pos);
+	int surfSightRange= sightRange / Map::cellScale+1;
 
-			ExploredCellsLookupItemCacheTimer.erase(purgeItem->first);
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled == true &&
+			SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynchMax).enabled == true) {
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"In applySightStamp() surfPos = %s sightRange = %d surfSightRange = %d teamIndex = %d",
+				surfPos.getString().c_str(),sightRange,surfSightRange,teamIndex);
+		if(Thread::isCurrentThreadMainThread() == false) {
+			unit->logSynchDataThreaded(__FILE__,__LINE__,szBuf);
 		}
-
-		// Check the cache for the pos, sightrange and use from
-		// cache if already found
-		std::map<Vec2i, std::map<int, ExploredCellsLookupItem> >::iterator iterFind = ExploredCellsLookupItemCache.find(newPos);
-		if(iterFind != ExploredCellsLookupItemCache.end()) {
-
-			std::map<int, ExploredCellsLookupItem>::iterator iterFind2 = iterFind->second.find(sightRange);
-			if(iterFind2 != iterFind->second.end()) {
-
-				ExploredCellsLookupItem &exploredCellsCache = iterFind2->second;
-				exploreCells(teamIndex, exploredCellsCache);
-
-				// Only start worrying about updating the cache timer if we
-				// have hit the threshold
-				if(MaxExploredCellsLookupItemCacheTriggered == true) {
-					// Remove the old timer entry since the search key id is stale
-					ExploredCellsLookupItemCacheTimer.erase(exploredCellsCache.ExploredCellsLookupItemCacheTimerCountIndex);
-					exploredCellsCache.ExploredCellsLookupItemCacheTimerCountIndex = ExploredCellsLookupItemCacheTimerCount++;
-
-					ExploredCellsLookupKey lookupKey;
-					lookupKey.pos = newPos;
-					lookupKey.sightRange = sightRange;
-					lookupKey.teamIndex = teamIndex;
-
-					// Add a new search key since we just used this exploredCellsCache
-					ExploredCellsLookupItemCacheTimer[exploredCellsCache.ExploredCellsLookupItemCacheTimerCountIndex] = lookupKey;
-				}
-
-				return exploredCellsCache;
-			}
+		else {
+			unit->logSynchData(__FILE__,__LINE__,szBuf);
 		}
 	}
 
-	Vec2i newSurfPos= Map::toSurfCoords(newPos);
-	int surfSightRange= sightRange / Map::cellScale+1;
-
-	// Explore, this code is quite expensive when we have lots of units
-	ExploredCellsLookupItem exploredCellsCache;
-	exploredCellsCache.exploredCellList.reserve(surfSightRange + indirectSightRange * 4);
-	exploredCellsCache.visibleCellList.reserve(surfSightRange + indirectSightRange * 4);
-
-	//int loopCount = 0;
-    for(int i = -surfSightRange - indirectSightRange -1; i <= surfSightRange + indirectSightRange +1; ++i) {
-        for(int j = -surfSightRange - indirectSightRange -1; j <= surfSightRange + indirectSightRange +1; ++j) {
-        	//loopCount++;
-        	Vec2i currRelPos= Vec2i(i, j);
-            Vec2i currPos= newSurfPos + currRelPos;
-            if(map.isInsideSurface(currPos) == true){
-				SurfaceCell *sc= map.getSurfaceCell(currPos);
-				if(sc == NULL) {
-					throw megaglest_runtime_error("sc == NULL");
-				}
-
-				//explore
-				float posLength = currRelPos.length();
-				bool updateExplored = (posLength < surfSightRange + indirectSightRange + 1);
-				bool updateVisible = (posLength < surfSightRange);
-
-				if(SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynch).enabled == true &&
-						SystemFlags::getSystemSettingType(SystemFlags::debugWorldSynchMax).enabled == true) {
-					char szBuf[8096]="";
-					snprintf(szBuf,8096,"In exploreCells() currRelPos = %s currPos = %s posLength = %f updateExplored = %d updateVisible = %d sightRange = %d teamIndex = %d",
-							currRelPos.getString().c_str(), currPos.getString().c_str(),posLength,updateExplored, updateVisible, sightRange, teamIndex);
-					if(Thread::isCurrentThreadMainThread() == false) {
-						unit->logSynchDataThreaded(__FILE__,__LINE__,szBuf);
-					}
-					else {
-						unit->logSynchData(__FILE__,__LINE__,szBuf);
-					}
-				}
+	map.getTeamVisibility()->addStamp(teamIndex, surfPos, surfSightRange,
+			surfSightRange + indirectSightRange + 1);
+	if(teamIndex == thisTeamIndex) {
+		minimap.addFowChangedArea(surfPos, surfSightRange + indirectSightRange + 1);
+	}
+}
 
-				if(updateExplored) {
-                    sc->setExplored(teamIndex, true);
-                    exploredCellsCache.exploredCellList.push_back(sc);
-				}
-				//visible
-				if(updateVisible) {
-					sc->setVisible(teamIndex, true);
-					exploredCellsCache.visibleCellList.push_back(sc);
-				}
-            }
-        }
-    }
+void World::retireSightStamp(int teamIndex, const Vec2i &pos, int sightRange) {
+	retiredSightStamps.push_back(SightStamp(teamIndex, pos, sightRange));
+	if(teamIndex == thisTeamIndex) {
+		minimap.addFowChangedArea(Map::toSurfCoords(pos), sightRange / Map::cellScale + 1 + indirectSightRange + 1);
+	}
+}
 
-    // Ok update our caches with the latest info for this position, sight and team
-    if(MaxExploredCellsLookupItemCache > 0) {
-		if(exploredCellsCache.exploredCellList.empty() == false || exploredCellsCache.visibleCellList.empty() == false) {
-			exploredCellsCache.ExploredCellsLookupItemCacheTimerCountIndex = ExploredCellsLookupItemCacheTimerCount++;
-			ExploredCellsLookupItemCache[newPos][sightRange] = exploredCellsCache;
+void World::removeRetiredSightStamps() {
+	SimBenchmarkTimer benchmarkTimer(sbsFogOfWar);
 
-			ExploredCellsLookupKey lookupKey;
-			lookupKey.pos 			= newPos;
-			lookupKey.sightRange 	= sightRange;
-			lookupKey.teamIndex 	= teamIndex;
-			ExploredCellsLookupItemCacheTimer[exploredCellsCache.ExploredCellsLookupItemCacheTimerCountIndex] = lookupKey;
-		}
-    }
-    return exploredCellsCache;
+	TeamVisibilityMap *teamVisibility = map.getTeamVisibility();
+	for(unsigned int index = 0; index < retiredSightStamps.size(); ++index) {
+		const SightStamp &stamp = retiredSightStamps[index];
+		teamVisibility->removeStamp(stamp.teamIndex, Map::toSurfCoords(stamp.pos),
+				stamp.sightRange / Map::cellScale+1);
+	}
+	retiredSightStamps.clear();
 }
 
 bool World::showWorldForPlayer(int factionIndex, bool excludeFogOfWarCheck) const {
@@ -2538,50 +2505,29 @@ bool World::showWorldForPlayer(int factionIndex, bool excludeFogOfWarCheck) cons
 
 //computes the fog of war texture, contained in the minimap
 void World::computeFow() {
+	SimBenchmarkTimer benchmarkTimer(sbsFogOfWar);
+
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s] Line: %d in frame: %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,getFrameCount());
 
 	Chrono chronoGamePerformanceCounts;
-	if(this->game) chronoGamePerformanceCounts.start();
-
-	minimap.resetFowTex();
-
-	if(this->game) this->game->addPerformanceCount("world minimap.resetFowTex",chronoGamePerformanceCounts.getMillis());
 
 	// reset cells
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s] Line: %d in frame: %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,getFrameCount());
 
-	if(this->game) chronoGamePerformanceCounts.start();
-
-	// Once we have calculated fog of war texture alpha, they are cached so we
-	// restore the default texture in one shot for speed
-	if(fogOfWar && cacheFowAlphaTexture == true) {
-		if(cacheFowAlphaTextureFogOfWarValue != fogOfWar) {
-			cacheFowAlphaTexture = false;
-		}
-		else {
-			minimap.restoreFowTexAlphaSurface();
-		}
+	if(fogOfWar && cacheFowAlphaTexture == true &&
+		cacheFowAlphaTextureFogOfWarValue != fogOfWar) {
+		cacheFowAlphaTexture = false;
 	}
 	int resetFowAlphaFactionCount = 0;
+	bool resetFowAlpha = false;
 
+	// Cell visibility is kept up to date by the unit sight stamps, here we
+	// only find out whether the fog of war texture alpha must be reset
 	for(int factionIndex = 0; factionIndex < GameConstants::maxPlayers + GameConstants::specialFactions; ++factionIndex) {
 		if(factionIndex >= getFactionCount()) {
 			continue;
 		}
 		Faction *faction = getFaction(factionIndex);
-//	for(int indexTeamFaction = 0;
-//			indexTeamFaction < GameConstants::maxPlayers + GameConstants::specialFactions;
-//			++indexTeamFaction) {
-
-		// If fog of war enabled set cell visible to false and later set those close to units to true
-		if(fogOfWar) {
-			for(int indexSurfaceW = 0; indexSurfaceW < map.getSurfaceW(); ++indexSurfaceW) {
-				for(int indexSurfaceH = 0; indexSurfaceH < map.getSurfaceH(); ++indexSurfaceH) {
-					// set all cells to not visible
-					map.getSurfaceCell(indexSurfaceW, indexSurfaceH)->setVisible(faction->getTeam(), false);
-				}
-			}
-		}
 
 		// Remove fog of war for factions NOT on my team which i can see
 		if(!fogOfWar || (faction->getTeam() != thisTeamIndex)) {
@@ -2590,71 +2536,67 @@ void World::computeFow() {
 			if(showWorldForFaction == true) {
 				resetFowAlphaFactionCount++;
 			}
-			for(int indexSurfaceW = 0; indexSurfaceW < map.getSurfaceW(); ++indexSurfaceW) {
-				for(int indexSurfaceH = 0; indexSurfaceH < map.getSurfaceH(); ++indexSurfaceH) {
-					// reset fog of ware texture alpha values
-					if(!fogOfWar || (cacheFowAlphaTexture == false &&
-						showWorldForFaction == true &&
-							resetFowAlphaFactionCount <= 1)) {
-						const Vec2i surfPos(indexSurfaceW,indexSurfaceH);
-
-						//compute max alpha
-						float maxAlpha= 0.0f;
-						if(surfPos.x > 1 && surfPos.y > 1 &&
-						   surfPos.x < map.getSurfaceW() - 2 &&
-						   surfPos.y < map.getSurfaceH() - 2) {
-							maxAlpha= 1.f;
-						}
-						else if(surfPos.x > 0 && surfPos.y > 0 &&
-								surfPos.x < map.getSurfaceW() - 1 &&
-								surfPos.y < map.getSurfaceH() - 1){
-							maxAlpha= 0.3f;
-						}
-
-						// compute alpha
-						float alpha = maxAlpha;
-						minimap.incFowTextureAlphaSurface(surfPos, alpha);
-					}
-				}
+			if(!fogOfWar || (cacheFowAlphaTexture == false &&
+				showWorldForFaction == true &&
+					resetFowAlphaFactionCount <= 1)) {
+				resetFowAlpha = true;
 			}
 		}
 		// Remove fog of war for factions on my team
 		else if(fogOfWar && (faction->getTeam() == thisTeamIndex)) {
 			bool showWorldForFaction = showWorldForPlayer(factionIndex);
 			//printf("#2 showWorldForFaction thisFactionIndex = %d thisTeamIndex = %d showWorldForFaction = %d\n",thisFactionIndex,thisTeamIndex,showWorldForFaction);
-			if(showWorldForFaction == true) {
-				for(int indexSurfaceW = 0; indexSurfaceW < map.getSurfaceW(); ++indexSurfaceW) {
-					for(int indexSurfaceH = 0; indexSurfaceH < map.getSurfaceH(); ++indexSurfaceH) {
-						// reset fog of ware texture alpha values
-						if(!fogOfWar || (cacheFowAlphaTexture == false &&
-							showWorldForFaction == true)) {
-							const Vec2i surfPos(indexSurfaceW,indexSurfaceH);
-
-							//compute max alpha
-							float maxAlpha= 0.0f;
-							if(surfPos.x > 1 && surfPos.y > 1 &&
-							   surfPos.x < map.getSurfaceW() - 2 &&
-							   surfPos.y < map.getSurfaceH() - 2) {
-								maxAlpha= 1.f;
-							}
-							else if(surfPos.x > 0 && surfPos.y > 0 &&
-									surfPos.x < map.getSurfaceW() - 1 &&
-									surfPos.y < map.getSurfaceH() - 1){
-								maxAlpha= 0.3f;
-							}
-
-							// compute alpha
-							float alpha = maxAlpha;
-							minimap.incFowTextureAlphaSurface(surfPos, alpha);
-						}
-					}
-				}
+			if(showWorldForFaction == true && cacheFowAlphaTexture == false) {
+				resetFowAlpha = true;
 			}
 		}
+	}
+
+	if(this->game) chronoGamePerformanceCounts.start();
+
+	// Plain fog of war only rebuilds the texture where our team's sight
+	// stamps changed, anything that shows the whole map rebuilds all of it
+	bool changedFowAreasOnly = minimap.resetFowTex(fogOfWar && cacheFowAlphaTexture == false && resetFowAlpha == false);
+
+	if(this->game) this->game->addPerformanceCount("world minimap.resetFowTex",chronoGamePerformanceCounts.getMillis());
 
-		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s] Line: %d in frame: %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,getFrameCount());
+	if(this->game) chronoGamePerformanceCounts.start();
+
+	// Once we have calculated fog of war texture alpha, they are cached so we
+	// restore the default texture in one shot for speed
+	if(fogOfWar && cacheFowAlphaTexture == true) {
+		minimap.restoreFowTexAlphaSurface();
+	}
+
+	// reset fog of war texture alpha values, the alpha only ever goes up so
+	// one pass covers every faction that asked for it
+	if(resetFowAlpha == true) {
+		for(int indexSurfaceW = 0; indexSurfaceW < map.getSurfaceW(); ++indexSurfaceW) {
+			for(int indexSurfaceH = 0; indexSurfaceH < map.getSurfaceH(); ++indexSurfaceH) {
+				const Vec2i surfPos(indexSurfaceW,indexSurfaceH);
+
+				//compute max alpha
+				float maxAlpha= 0.0f;
+				if(surfPos.x > 1 && surfPos.y > 1 &&
+				   surfPos.x < map.getSurfaceW() - 2 &&
+				   surfPos.y < map.getSurfaceH() - 2) {
+					maxAlpha= 1.f;
+				}
+				else if(surfPos.x > 0 && surfPos.y > 0 &&
+						surfPos.x < map.getSurfaceW() - 1 &&
+						surfPos.y < map.getSurfaceH() - 1){
+					maxAlpha= 0.3f;
+				}
+
+				// compute alpha
+				float alpha = maxAlpha;
+				minimap.incFowTextureAlphaSurface(surfPos, alpha);
+			}
+		}
 	}
 
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s] Line: %d in frame: %d\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,getFrameCount());
+
 	// Once we have calculated fog of war texture alpha, will we cache it so that we
 	// can restore it later
 	if(fogOfWar && cacheFowAlphaTexture == false && resetFowAlphaFactionCount > 0) {
@@ -2670,6 +2612,17 @@ void World::computeFow() {
 	//compute cells
 	if(this->game) chronoGamePerformanceCounts.start();
 
+	// exploration, only units that moved, died or changed their sight
+	// range touch the team visibility map
+	for(int factionIndex = 0; factionIndex < getFactionCount(); ++factionIndex) {
+		Faction *faction = getFaction(factionIndex);
+		int unitCount = faction->getUnitCount();
+		for(int unitIndex = 0; unitIndex < unitCount; ++unitIndex) {
+			faction->getUnit(unitIndex)->exploreCells();
+		}
+	}
+	removeRetiredSightStamps();
+
 	for(int factionIndex = 0; factionIndex < getFactionCount(); ++factionIndex) {
 		Faction *faction = getFaction(factionIndex);
 		bool cellVisibleForFaction = showWorldForPlayer(thisFactionIndex);
@@ -2678,8 +2631,6 @@ void World::computeFow() {
 		int unitCount = faction->getUnitCount();
 		for(int unitIndex = 0; unitIndex < unitCount; ++unitIndex) {
 			Unit *unit= faction->getUnit(unitIndex);
-			// exploration
-			unit->exploreCells();
 
 			// fire particle visible
 			ParticleSystem *fire = unit->getFire();
@@ -2696,25 +2647,38 @@ void World::computeFow() {
 				fire->setActive(cellVisible);
 			}
 
-			// compute fog of war render texture
+			// compute fog of war render texture, the cells of a unit away from
+			// any changed area still have its alpha
 			if(fogOfWar == true &&
 				faction->getTeam() == thisTeamIndex &&
 					unit->isOperative() == true) {
 
 				//printf("computeFow unit->isOperative() == true\n");
 
+				if(changedFowAreasOnly == true) {
+					int surfFowRange = unit->getType()->getTotalSight(unit->getTotalUpgrade()) / Map::cellScale + 1 + indirectSightRange + 1;
+					if(minimap.isFowAreaChanged(Map::toSurfCoords(unit->getCenteredPos()), surfFowRange) == false) {
+						continue;
+					}
+				}
+
 				const FowAlphaCellsLookupItem &cellList = unit->getCachedFow();
 				for(std::map<Vec2i,float>::const_iterator iterMap = cellList.surfPosAlphaList.begin();
 					iterMap != cellList.surfPosAlphaList.end(); ++iterMap) {
 					const Vec2i &surfPos = iterMap->first;
 					const float &alpha = iterMap->second;
 
-					minimap.incFowTextureAlphaSurface(surfPos, alpha, true);
+					if(changedFowAreasOnly == false || minimap.isFowCellChanged(surfPos) == true) {
+						minimap.incFowTextureAlphaSurface(surfPos, alpha, true);
+					}
 				}
 			}
 		}
 	}
 
+	// cached movement answers depend on what each team can see
+	map.invalidateMoveCache();
+
 	if(this->game) this->game->addPerformanceCount("world compute cells",chronoGamePerformanceCounts.getMillis());
 }
 
@@ -2860,35 +2824,18 @@ void World::removeResourceTargetFromCache(const Vec2i &pos) {
 	}
 }
 
-string World::getExploredCellsLookupItemCacheStats() {
+string World::getTeamVisibilityStats() {
 	string result = "";
 
-	int posCount = 0;
-	int sightCount = 0;
-	int exploredCellCount = 0;
-	int visibleCellCount = 0;
-
-	for(std::map<Vec2i, std::map<int, ExploredCellsLookupItem > >::iterator iterMap1 = ExploredCellsLookupItemCache.begin();
-		iterMap1 != ExploredCellsLookupItemCache.end(); ++iterMap1) {
-		posCount++;
-
-		for(std::map<int, ExploredCellsLookupItem >::iterator iterMap2 = iterMap1->second.begin();
-			iterMap2 != iterMap1->second.end(); ++iterMap2) {
-			sightCount++;
-
-			exploredCellCount += (int)iterMap2->second.exploredCellList.size();
-			visibleCellCount += (int)iterMap2->second.visibleCellList.size();
-		}
+	const TeamVisibilityMap *teamVisibility = map.getTeamVisibility();
+	if(thisTeamIndex >= 0 && thisTeamIndex < teamVisibility->getTeamCount()) {
+		char szBuf[8096]="";
+		snprintf(szBuf,8096,"visible [%d] explored [%d] retired stamps [%d]",
+				teamVisibility->getVisibleCellCount(thisTeamIndex),
+				teamVisibility->getExploredCellCount(thisTeamIndex),
+				(int)retiredSightStamps.size());
+		result = szBuf;
 	}
-
-	uint64 totalBytes = exploredCellCount * sizeof(SurfaceCell *);
-	totalBytes += visibleCellCount * sizeof(SurfaceCell *);
-
-	totalBytes /= 1000;
-
-	char szBuf[8096]="";
-	snprintf(szBuf,8096,"pos [%d] sight [%d] [%d][%d] total KB: %s",posCount,sightCount,exploredCellCount,visibleCellCount,formatNumber(totalBytes).c_str());
-	result = szBuf;
 	return result;
 }
 
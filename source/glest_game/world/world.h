@@ -35,6 +35,7 @@
 #include "unit_updater.h"
 #include "randomgen.h"
 #include "game_constants.h"
+#include "work_stealing_scheduler.h"
 #include "leak_dumper.h"
 
 namespace Glest{ namespace Game{
@@ -42,6 +43,7 @@ namespace Glest{ namespace Game{
 using Shared::Graphics::Quad2i;
 using Shared::Graphics::Rect2i;
 using Shared::Util::RandomGen;
+using Shared::PlatformCommon::WorkStealingScheduler;
 
 class Faction;
 class Unit;
@@ -61,21 +63,25 @@ class StrSound;
 ///	The game world: Map + Tileset + TechTree
 // =====================================================
 
-class ExploredCellsLookupKey {
+class SightStamp {
 public:
+	SightStamp(int teamIndex, const Vec2i &pos, int sightRange) {
+		this->teamIndex = teamIndex;
+		this->pos = pos;
+		this->sightRange = sightRange;
+	}
 
+	int teamIndex;
 	Vec2i pos;
 	int sightRange;
-	int teamIndex;
 };
 
 class World {
 private:
 	typedef vector<Faction *> Factions;
 
-	std::map<Vec2i, std::map<int, ExploredCellsLookupItem > > ExploredCellsLookupItemCache;
-	std::map<int,ExploredCellsLookupKey> ExploredCellsLookupItemCacheTimer;
-	int ExploredCellsLookupItemCacheTimerCount;
+	// stamps of units that moved or died since the last fog of war update
+	std::vector<SightStamp> retiredSightStamps;
 
 public:
 	static const int generationArea= 100;
@@ -132,6 +138,7 @@ private:
 	const XmlNode *loadWorldNode;
 
 	MasterSlaveThreadController masterController;
+	WorkStealingScheduler *unitUpdateScheduler;
 
 	bool originalGameFogOfWar;
 	std::map<int,std::pair<const Unit *,const FogOfWarSkillType *> > mapFogOfWarUnitList;
@@ -297,11 +304,12 @@ public:
 	}
 	bool canTickWorld() const;
 
-	ExploredCellsLookupItem exploreCells(const Vec2i &newPos, int sightRange, int teamIndex, Unit *unit);
-	void exploreCells(int teamIndex,ExploredCellsLookupItem &exploredCellsCache);
+	void applySightStamp(int teamIndex, const Vec2i &pos, int sightRange, Unit *unit);
+	void retireSightStamp(int teamIndex, const Vec2i &pos, int sightRange);
 	bool showWorldForPlayer(int factionIndex, bool excludeFogOfWarCheck=false) const;
 
 	inline UnitUpdater * getUnitUpdater() { return &unitUpdater; }
+	static bool isUnitUpdateSchedulerEnabled();
 
 	void playStaticVideo(const string &playVideo);
 	void playStreamingVideo(const string &playVideo);
@@ -310,7 +318,7 @@ public:
 
 	void removeResourceTargetFromCache(const Vec2i &pos);
 
-	string getExploredCellsLookupItemCacheStats();
+	string getTeamVisibilityStats();
 	string getFowAlphaCellsLookupItemCacheStats();
 	string getAllFactionsCacheStats();
 
@@ -342,6 +350,7 @@ private:
 	//misc
 	void tick();
 	void computeFow();
+	void removeRetiredSightStamps();
 
 	void updateAllTilesetObjects();
 	void updateAllFactionUnits();
@@ -28,6 +28,10 @@ using std::string;
 using std::map;
 using std::pair;
 
+namespace Shared{ namespace Platform{
+	class Mutex;
+}}
+
 namespace Shared { namespace Graphics {
 
 class Model;
@@ -36,6 +40,58 @@ class ShadowVolumeData;
 class InterpolationData;
 class TextureManager;
 
+// =====================================================
+//	class SharedMeshData
+//
+//	Vertex data and VBOs of a mesh, shared by all the
+//	meshes a model manager loaded with the same frames
+// =====================================================
+
+class SharedMeshData {
+	friend class Mesh;
+private:
+	uint32 key;
+	// 64 bit hash of the arrays, all there is to compare once they are freed
+	uint64 hash;
+	uint32 frameCount;
+	uint32 vertexCount;
+	uint32 indexCount;
+
+	Vec3f *vertices;
+	Vec3f *normals;
+	Vec2f *texCoords;
+	uint32 *indices;
+
+	// meshes using the data, changed under the mutex of their manager
+	vector<Mesh *> meshes;
+	Shared::Platform::Mutex *mutex;
+
+	bool    hasBuiltVBOs;
+	uint32	m_nVBOVertices;
+	uint32	m_nVBOTexCoords;
+	uint32	m_nVBONormals;
+	uint32	m_nVBOIndexes;
+
+	SharedMeshData(const SharedMeshData &obj);
+	SharedMeshData & operator=(const SharedMeshData &obj);
+
+	// the arrays are freed once they are in the VBOs, every mesh
+	// using the data renders from the VBOs then
+	void BuildVBOs();
+	static uint64 computeHash(const Mesh *mesh);
+
+public:
+	// takes over the arrays of the mesh
+	SharedMeshData(Mesh *mesh, uint32 key, Shared::Platform::Mutex *mutex);
+	~SharedMeshData();
+
+	static uint32 computeKey(const Mesh *mesh);
+	bool hasSameData(const Mesh *mesh) const;
+
+	uint32 getKey() const				{return key;}
+	int getReferenceCount() const		{return (int)meshes.size();}
+};
+
 // =====================================================
 //	class Mesh
 //
@@ -43,6 +99,7 @@ class TextureManager;
 // =====================================================
 
 class Mesh {
+	friend class SharedMeshData;
 private:
 	//mesh data
 	Texture2D *textures[meshTextureCount];
@@ -87,6 +144,11 @@ private:
 	uint32	m_nVBONormals;					// Normal VBO Name
 	uint32	m_nVBOIndexes;					// Indexes VBO Name
 
+	// NULL while the mesh owns its vertex data
+	SharedMeshData *sharedData;
+
+	void useSharedVBOs();
+
 public:
 	//init & end
 	Mesh();
@@ -113,6 +175,11 @@ public:
 	void BuildVBOs();
 	void ReleaseVBOs();
 
+	//sharing, the model manager counts the references under its lock
+	const SharedMeshData *getSharedData() const	{return sharedData;}
+	void shareData(SharedMeshData *sharedData);
+	void releaseSharedData();
+
 	//data
 	const Vec3f *getVertices() const 	{return vertices;}
 	const Vec3f *getNormals() const 	{return normals;}
@@ -14,10 +14,15 @@
 
 #include "model.h"
 #include <vector>
+#include <map>
 #include "leak_dumper.h"
 
 using namespace std;
 
+namespace Shared{ namespace Platform{
+	class Mutex;
+}}
+
 namespace Shared{ namespace Graphics{
 
 class TextureManager;
@@ -30,14 +35,43 @@ class ModelManager{
 protected:
 	typedef vector<Model*> ModelContainer;
 
+	// a model everybody loading its file shares
+	class ModelReference {
+	public:
+		Model *model;
+		int referenceCount;
+		// files its load added to the loaded file list
+		vector<string> files;
+
+		ModelReference() : model(NULL), referenceCount(0) {}
+	};
+	typedef std::map<string,ModelReference> ModelReferenceMap;
+	// mesh data of the models by a checksum of its content
+	typedef std::map<uint32,vector<SharedMeshData *> > SharedMeshDataMap;
+
 protected:
 	ModelContainer models;
+	ModelReferenceMap modelReferences;
+	SharedMeshDataMap sharedMeshData;
 	TextureManager *textureManager;
+	// models may be loaded by several threads at once
+	Shared::Platform::Mutex *mutex;
+
+	void shareMeshData(Model *model, const vector<uint32> &keys);
+	void releaseMeshData(Model *model);
+	void addLoadedFiles(const vector<string> &files, const string &path,
+			std::map<string,vector<pair<string, string> > > *loadedFileList, string *sourceLoader);
+
+private:
+	ModelManager(const ModelManager &obj);
+	ModelManager & operator=(const ModelManager &obj);
 
 public:
 	ModelManager();
 	virtual ~ModelManager();
 
+	// a file that is loaded already gives the same model again,
+	// every call has to be ended by one endModel
 	Model *newModel(const string &path,bool deletePixMapAfterLoad,std::map<string,vector<pair<string, string> > > *loadedFileList, string *sourceLoader);
 
 	void init();
@@ -46,6 +80,9 @@ public:
 	void endLastModel(bool mustExistInList=false);
 
 	void setTextureManager(TextureManager *textureManager)	{this->textureManager= textureManager;}
+
+	int getModelCount() const				{return (int)models.size();}
+	int getSharedMeshDataCount() const;
 };
 
 }}//end namespace
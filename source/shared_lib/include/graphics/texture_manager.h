@@ -13,11 +13,16 @@
 #define _SHARED_GRAPHICS_TEXTUREMANAGER_H_
 
 #include <vector>
+#include <map>
 #include "texture.h"
 #include "leak_dumper.h"
 
 using std::vector;
 
+namespace Shared{ namespace Platform{
+	class Mutex;
+}}
+
 namespace Shared{ namespace Graphics{
 
 // =====================================================
@@ -25,15 +30,27 @@ namespace Shared{ namespace Graphics{
 // =====================================================
 typedef vector<Texture*> TextureContainer;
 
-//manages textures, creation on request and deletion on destruction
+//manages textures, creation on request and deletion on destruction,
+//textures may be created by several loader threads at once
 class TextureManager{
 	
 protected:
 	TextureContainer textures;
+	// textures of models by the file they were loaded from
+	std::map<string,Texture2D *> modelTextures;
+	// meshes using a model texture, it ends with the last of them
+	std::map<const Texture *,int> modelTextureReferences;
+	Shared::Platform::Mutex *mutex;
 	
 	Texture::Filter textureFilter;
 	int maxAnisotropy;
 
+	void removeModelTexture(Texture *texture);
+
+private:
+	TextureManager(const TextureManager &obj);
+	TextureManager & operator=(const TextureManager &obj);
+
 public:
 	TextureManager();
 	~TextureManager();
@@ -51,6 +68,13 @@ public:
 	int getMaxAnisotropy() const {return maxAnisotropy;}
 
 	Texture *getTexture(const string &path);
+	// Model meshes share the texture of a file. created is set for the
+	// caller that has to load it, when models load on several threads
+	// the pixels may not be there yet for the others.
+	Texture2D *findModelTexture(const string &path);
+	Texture2D *getModelTexture(const string &path, bool &created);
+	// one more mesh ends the texture before it is gone
+	void addModelTextureReference(Texture2D *texture);
 	Texture1D *newTexture1D();
 	Texture2D *newTexture2D();
 	Texture3D *newTexture3D();
@@ -0,0 +1,159 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_MAP_CELLBUCKETGRID_H_
+#define _SHARED_MAP_CELLBUCKETGRID_H_
+
+#include <vector>
+#include <algorithm>
+#include "leak_dumper.h"
+
+namespace Shared { namespace Map {
+
+// ===============================================
+//	class CellBucketGrid
+//
+///	Spatial index of items that occupy single cells.
+/// Every cell holds at most one item per layer, the
+/// entries are kept in coarse square buckets so a
+/// rectangle query only visits the buckets it overlaps
+/// instead of every cell.
+// ===============================================
+
+template<typename T>
+class CellBucketGrid {
+public:
+	static const int bucketShift = 3;	//8x8 cells per bucket
+
+	class Entry {
+	public:
+		T item;
+		int x;
+		int y;
+		int layer;
+	};
+
+private:
+	// cell scan order: by column, then row, then layer
+	class EntryLess {
+	public:
+		bool operator()(const Entry &a, const Entry &b) const {
+			if(a.x != b.x) {
+				return a.x < b.x;
+			}
+			if(a.y != b.y) {
+				return a.y < b.y;
+			}
+			return a.layer < b.layer;
+		}
+	};
+
+	int width;
+	int height;
+	int bucketsW;
+	int bucketsH;
+	int entryCount;
+	std::vector<std::vector<Entry> > buckets;
+
+	inline std::vector<Entry> &getBucket(int x, int y) {
+		return buckets[(y >> bucketShift) * bucketsW + (x >> bucketShift)];
+	}
+
+public:
+	CellBucketGrid() {
+		width = 0;
+		height = 0;
+		bucketsW = 0;
+		bucketsH = 0;
+		entryCount = 0;
+	}
+
+	void init(int width, int height) {
+		this->width = width;
+		this->height = height;
+		this->bucketsW = (width + (1 << bucketShift) - 1) >> bucketShift;
+		this->bucketsH = (height + (1 << bucketShift) - 1) >> bucketShift;
+		this->entryCount = 0;
+		buckets.clear();
+		buckets.resize(bucketsW * bucketsH);
+	}
+
+	void clear() {
+		for(unsigned int i = 0; i < buckets.size(); ++i) {
+			buckets[i].clear();
+		}
+		entryCount = 0;
+	}
+
+	inline int getEntryCount() const	{ return entryCount; }
+	inline int getBucketCount() const	{ return (int)buckets.size(); }
+
+	// Stores item as the occupant of the cell and layer, replacing
+	// whatever occupied it before
+	void add(int x, int y, int layer, T item) {
+		std::vector<Entry> &bucket = getBucket(x, y);
+		for(unsigned int i = 0; i < bucket.size(); ++i) {
+			if(bucket[i].x == x && bucket[i].y == y && bucket[i].layer == layer) {
+				bucket[i].item = item;
+				return;
+			}
+		}
+		Entry entry;
+		entry.item = item;
+		entry.x = x;
+		entry.y = y;
+		entry.layer = layer;
+		bucket.push_back(entry);
+		entryCount++;
+	}
+
+	void remove(int x, int y, int layer) {
+		std::vector<Entry> &bucket = getBucket(x, y);
+		for(unsigned int i = 0; i < bucket.size(); ++i) {
+			if(bucket[i].x == x && bucket[i].y == y && bucket[i].layer == layer) {
+				bucket[i] = bucket.back();
+				bucket.pop_back();
+				entryCount--;
+				return;
+			}
+		}
+	}
+
+	// Appends the entries inside the inclusive rectangle to result,
+	// sorted in the order a column by column cell scan finds them
+	void query(int x0, int y0, int x1, int y1, std::vector<Entry> &result) const {
+		if(x0 < 0) x0 = 0;
+		if(y0 < 0) y0 = 0;
+		if(x1 >= width) x1 = width - 1;
+		if(y1 >= height) y1 = height - 1;
+		if(x0 > x1 || y0 > y1) {
+			return;
+		}
+
+		size_t first = result.size();
+		for(int bucketY = (y0 >> bucketShift); bucketY <= (y1 >> bucketShift); ++bucketY) {
+			for(int bucketX = (x0 >> bucketShift); bucketX <= (x1 >> bucketShift); ++bucketX) {
+				const std::vector<Entry> &bucket = buckets[bucketY * bucketsW + bucketX];
+				for(unsigned int i = 0; i < bucket.size(); ++i) {
+					const Entry &entry = bucket[i];
+					if(entry.x >= x0 && entry.x <= x1 && entry.y >= y0 && entry.y <= y1) {
+						result.push_back(entry);
+					}
+				}
+			}
+		}
+		std::sort(result.begin() + first, result.end(), EntryLess());
+	}
+};
+
+}}//end namespace
+
+#endif
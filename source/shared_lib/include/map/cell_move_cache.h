@@ -0,0 +1,136 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_MAP_CELLMOVECACHE_H_
+#define _SHARED_MAP_CELLMOVECACHE_H_
+
+#include "data_types.h"
+#include "vec.h"
+#include <vector>
+#include "leak_dumper.h"
+
+using Shared::Platform::uint8;
+using Shared::Platform::uint16;
+using Shared::Platform::uint32;
+using Shared::Graphics::Vec2i;
+
+namespace Shared { namespace Map {
+
+// ===============================================
+//	class CellMoveCache
+//
+///	Caches the result of single step movement queries.
+/// Each layer holds one entry per cell with a bit for
+/// each of the 8 step directions. Layers are allocated
+/// when first used and all of them are invalidated at
+/// once by bumping the epoch.
+// ===============================================
+
+class CellMoveCache {
+public:
+	static const int directionCount = 8;
+
+private:
+	class Entry {
+	public:
+		uint16 stamp;
+		uint8 known;
+		uint8 values;
+	};
+
+	class Layer {
+	public:
+		uint32 epoch;
+		uint16 generation;
+		std::vector<Entry> entries;
+	};
+
+	int width;
+	int height;
+	uint32 epoch;
+	std::vector<Layer *> layers;
+
+	CellMoveCache(CellMoveCache&);
+	void operator=(CellMoveCache&);
+
+	Layer *createLayer(int layerIndex);
+	void resetLayer(Layer *layer);
+
+	inline Layer *getLayer(int layerIndex) {
+		Layer *layer = layers[layerIndex];
+		if(layer == NULL) {
+			layer = createLayer(layerIndex);
+		}
+		if(layer->epoch != epoch) {
+			resetLayer(layer);
+		}
+		return layer;
+	}
+
+public:
+	CellMoveCache();
+	~CellMoveCache();
+
+	void init(int width, int height, int layerCount);
+	void clear();
+
+	inline void invalidate()				{ epoch++; }
+	inline uint32 getEpoch() const			{ return epoch; }
+	inline int getLayerCount() const		{ return (int)layers.size(); }
+
+	// Returns the direction index of a single step or -1 if the
+	// two positions are equal or not adjacent
+	inline static int getDirection(const Vec2i &from, const Vec2i &to) {
+		int dx = to.x - from.x;
+		int dy = to.y - from.y;
+		if(dx < -1 || dx > 1 || dy < -1 || dy > 1) {
+			return -1;
+		}
+		int index = (dy + 1) * 3 + (dx + 1);
+		if(index == 4) {
+			return -1;
+		}
+		return (index > 4 ? index - 1 : index);
+	}
+
+	// Layers are only touched by the thread that owns them, so
+	// concurrent callers must use distinct layer indexes
+	inline bool lookup(int layerIndex, const Vec2i &pos, int direction, bool &result) {
+		Layer *layer = getLayer(layerIndex);
+		const Entry &entry = layer->entries[pos.y * width + pos.x];
+		if(entry.stamp != layer->generation || (entry.known & (1 << direction)) == 0) {
+			return false;
+		}
+		result = (entry.values & (1 << direction)) != 0;
+		return true;
+	}
+
+	inline void store(int layerIndex, const Vec2i &pos, int direction, bool result) {
+		Layer *layer = getLayer(layerIndex);
+		Entry &entry = layer->entries[pos.y * width + pos.x];
+		if(entry.stamp != layer->generation) {
+			entry.stamp = layer->generation;
+			entry.known = 0;
+			entry.values = 0;
+		}
+		entry.known |= (1 << direction);
+		if(result == true) {
+			entry.values |= (1 << direction);
+		}
+		else {
+			entry.values &= ~(1 << direction);
+		}
+	}
+};
+
+}}//end namespace
+
+#endif
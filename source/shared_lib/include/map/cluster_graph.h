@@ -0,0 +1,162 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_MAP_CLUSTERGRAPH_H_
+#define _SHARED_MAP_CLUSTERGRAPH_H_
+
+#include "data_types.h"
+#include "vec.h"
+#include <vector>
+#include "leak_dumper.h"
+
+using Shared::Platform::uint32;
+using Shared::Graphics::Vec2i;
+
+namespace Shared { namespace Map {
+
+// ===============================================
+//	class ClusterGraphPassability
+//
+///	Answers whether a single grid cell can be entered
+// ===============================================
+
+class ClusterGraphPassability {
+public:
+	virtual ~ClusterGraphPassability() {}
+	virtual bool isPassable(int x, int y) const = 0;
+};
+
+// ===============================================
+//	class ClusterGraphSearch
+//
+///	Scratch state of one search over a ClusterGraph, each
+/// thread searching the same graph needs its own
+// ===============================================
+
+class ClusterGraphSearch {
+private:
+	friend class ClusterGraph;
+
+	std::vector<uint32> nodeStamps;
+	std::vector<uint32> closedStamps;
+	std::vector<int> nodeCosts;
+	std::vector<int> nodeParents;
+	uint32 nodeGeneration;
+	// cells of the one cluster being flooded, indexed from its origin
+	std::vector<uint32> cellStamps;
+	std::vector<int> cellCosts;
+	uint32 cellGeneration;
+
+	void beginNodeSearch(int nodeSlots);
+	void beginCellSearch(int cellSlots);
+
+public:
+	ClusterGraphSearch();
+};
+
+// ===============================================
+//	class ClusterGraph
+//
+///	Hierarchical path planning graph (HPA*). The grid is split
+/// into square clusters, passable runs along cluster borders
+/// become portal nodes, and portals inside a cluster are joined
+/// by their exact in-cluster path cost. Clusters are rebuilt
+/// lazily after being marked dirty.
+// ===============================================
+
+class ClusterGraph {
+public:
+	static const int defaultClusterSize		= 16;
+	static const int straightCost			= 10;
+	static const int diagonalCost			= 14;
+
+private:
+	class Entrance {
+	public:
+		Vec2i inside;
+		Vec2i outside;
+	};
+
+	class Cluster {
+	public:
+		std::vector<Vec2i> nodes;
+		// peers[i] are the portal positions in neighbour clusters reachable from nodes[i]
+		std::vector<std::vector<Vec2i> > peers;
+		// distances[i * nodes.size() + j], -1 when unreachable inside the cluster
+		std::vector<int> distances;
+	};
+
+	const ClusterGraphPassability *passability;
+	int width;
+	int height;
+	int clusterSize;
+	int clustersW;
+	int clustersH;
+
+	std::vector<Cluster> clusters;
+	std::vector<std::vector<Entrance> > eastEntrances;
+	std::vector<std::vector<Entrance> > southEntrances;
+	std::vector<char> dirtyClusters;
+	bool anyDirty;
+
+	std::vector<int> nodeOffsets;
+	std::vector<int> nodeClusters;
+	int nodeCount;
+
+	// scratch for rebuilding clusters and for findPath without a search
+	ClusterGraphSearch ownSearch;
+
+	inline int clusterIndex(int cx, int cy) const { return cy * clustersW + cx; }
+	inline int clusterIndexForPos(const Vec2i &pos) const {
+		return clusterIndex(pos.x / clusterSize, pos.y / clusterSize);
+	}
+	void getClusterBounds(int index, Vec2i &origin, Vec2i &end) const;
+
+	bool canStep(const Vec2i &from, const Vec2i &to) const;
+	void buildBorder(int cx, int cy, bool east);
+	void buildClusterNodes(int index);
+	void buildClusterDistances(int index);
+	void computeNodeOffsets();
+	int findLocalNode(int index, const Vec2i &pos) const;
+	void clusterDistancesFrom(ClusterGraphSearch &search, int index, const Vec2i &from, std::vector<int> &result) const;
+
+	static int octileDistance(const Vec2i &a, const Vec2i &b);
+
+public:
+	ClusterGraph();
+
+	void init(int width, int height, const ClusterGraphPassability *passability,
+			  int clusterSize=defaultClusterSize);
+	void clear();
+
+	void setDirty(int x, int y, int size);
+	void setAllDirty();
+	void update();
+
+	int getClusterSize() const	{ return clusterSize; }
+	int getNodeCount() const	{ return nodeCount; }
+	bool isDirty() const		{ return anyDirty; }
+	bool isSameCluster(const Vec2i &a, const Vec2i &b) const;
+
+	// Finds a route over the abstract graph and returns the portal positions
+	// to pass through followed by the goal itself. Returns false when the two
+	// positions are not connected.
+	bool findPath(const Vec2i &from, const Vec2i &to, std::vector<Vec2i> &waypoints,
+				  int *expandedNodes=NULL);
+	// Same search on a graph that is already up to date, only the given
+	// search state is written so several threads can search at once
+	bool findPath(ClusterGraphSearch &search, const Vec2i &from, const Vec2i &to,
+				  std::vector<Vec2i> &waypoints, int *expandedNodes=NULL) const;
+};
+
+}}//end namespace
+
+#endif
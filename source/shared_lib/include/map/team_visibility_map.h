@@ -0,0 +1,117 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_MAP_TEAMVISIBILITYMAP_H_
+#define _SHARED_MAP_TEAMVISIBILITYMAP_H_
+
+#include "data_types.h"
+#include "vec.h"
+#include <vector>
+#include <string>
+#include "leak_dumper.h"
+
+using Shared::Platform::uint16;
+using Shared::Platform::uint32;
+using Shared::Graphics::Vec2i;
+
+namespace Shared { namespace Map {
+
+// ===============================================
+//	class TeamVisibilityMap
+//
+///	Per team fog of war state. Units add a circular
+/// sight stamp when they arrive in a cell and remove
+/// it when they leave, every cell counts the stamps
+/// covering it. Visible and explored state is kept as
+/// one bit row per team, explored bits are never
+/// cleared by removing a stamp. A revealed team sees
+/// every cell regardless of its stamps.
+// ===============================================
+
+class TeamVisibilityMap {
+private:
+	int width;
+	int height;
+	int teamCount;
+	int wordsPerRow;
+
+	std::vector<uint16> stampCounts;
+	std::vector<uint32> visibleBits;
+	std::vector<uint32> exploredBits;
+	std::vector<bool> revealedTeams;
+
+	// half widths of each row of a circle, indexed by radius
+	std::vector<std::vector<int> > circleSpans;
+
+	TeamVisibilityMap(TeamVisibilityMap&);
+	void operator=(TeamVisibilityMap&);
+
+	const std::vector<int> &getCircleSpans(int radius);
+
+	inline int getCountIndex(int teamIndex, int x, int y) const {
+		return (teamIndex * height + y) * width + x;
+	}
+	inline int getWordIndex(int teamIndex, int x, int y) const {
+		return (teamIndex * height + y) * wordsPerRow + (x >> 5);
+	}
+
+public:
+	TeamVisibilityMap();
+	~TeamVisibilityMap();
+
+	void init(int width, int height, int teamCount);
+	void clear();
+
+	inline int getWidth() const				{ return width; }
+	inline int getHeight() const			{ return height; }
+	inline int getTeamCount() const			{ return teamCount; }
+
+	inline bool isVisible(int teamIndex, int x, int y) const {
+		return revealedTeams[teamIndex] == true ||
+				(visibleBits[getWordIndex(teamIndex, x, y)] & (1u << (x & 31))) != 0;
+	}
+	inline bool isExplored(int teamIndex, int x, int y) const {
+		return (exploredBits[getWordIndex(teamIndex, x, y)] & (1u << (x & 31))) != 0;
+	}
+	inline int getStampCount(int teamIndex, int x, int y) const {
+		return stampCounts[getCountIndex(teamIndex, x, y)];
+	}
+
+	inline bool isRevealed(int teamIndex) const	{ return revealedTeams[teamIndex]; }
+
+	void setExplored(int teamIndex, int x, int y, bool value);
+	void setAllExplored(int teamIndex, bool value);
+	void setRevealed(int teamIndex, bool value);
+
+	// Explored state of one team as comma separated run lengths of
+	// alternating unexplored and explored cells in row order
+	std::string getExploredRuns(int teamIndex) const;
+	void setExploredRuns(int teamIndex, const std::string &runs);
+
+	// Cells closer than visibleRadius to center become visible and
+	// cells closer than exploredRadius become explored. The index
+	// (y * width + x) of every cell whose state changed is appended
+	// to changedCells when it is not NULL.
+	void addStamp(int teamIndex, const Vec2i &center, int visibleRadius, int exploredRadius,
+					std::vector<int> *changedCells=NULL);
+
+	// Undoes addStamp for the visible part, cells that lose their last
+	// stamp become not visible
+	void removeStamp(int teamIndex, const Vec2i &center, int visibleRadius,
+					std::vector<int> *changedCells=NULL);
+
+	int getVisibleCellCount(int teamIndex) const;
+	int getExploredCellCount(int teamIndex) const;
+};
+
+}}//end namespace
+
+#endif
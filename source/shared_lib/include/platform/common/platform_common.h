@@ -245,6 +245,7 @@ bool removeFile(string file);
 bool renameFile(string oldFile, string newFile);
 void removeFolder(const string &path);
 off_t getFileSize(string filename);
+time_t getFileModificationTime(string filename);
 bool searchAndReplaceTextInFile(string fileName, string findText, string replaceText, bool simulateOnly);
 void copyFileTo(string fromFileName, string toFileName);
 
@@ -261,6 +262,9 @@ string getCommandLine();
 
 string getUserHome();
 
+// Largest resident set size of this process so far, 0 if unknown
+int64 getPeakResidentMemoryBytes();
+
 #define SPACES " "
 
 inline string trim_at_delim (const string & s, const string &t)  {
@@ -0,0 +1,143 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+#ifndef _SHARED_PLATFORMCOMMON_WORKSTEALINGSCHEDULER_H_
+#define _SHARED_PLATFORMCOMMON_WORKSTEALINGSCHEDULER_H_
+
+#include "base_thread.h"
+#include <string>
+#include <deque>
+#include <vector>
+#include "leak_dumper.h"
+
+using namespace Shared::Platform;
+using namespace std;
+
+namespace Shared { namespace PlatformCommon {
+
+//
+// This interface describes the methods a task list run by the
+// WorkStealingScheduler must implement
+//
+class WorkStealingTaskInterface {
+public:
+	// Called once for every task index, workerIndex is 0 for the
+	// thread that called WorkStealingScheduler::run
+	virtual void executeTask(int workerIndex, int taskIndex) = 0;
+
+	virtual ~WorkStealingTaskInterface() {}
+};
+
+class WorkStealingScheduler;
+
+// =====================================================
+//	class WorkStealingWorkerThread
+// =====================================================
+
+class WorkStealingWorkerThread : public BaseThread
+{
+protected:
+	WorkStealingScheduler *scheduler;
+	int workerIndex;
+	Semaphore semTaskSignalled;
+
+	virtual void setQuitStatus(bool value);
+
+public:
+	WorkStealingWorkerThread(WorkStealingScheduler *scheduler, int workerIndex);
+	virtual ~WorkStealingWorkerThread();
+
+	virtual void execute();
+	virtual bool canShutdown(bool deleteSelfIfShutdownDelayed=false);
+
+	void signalTask();
+	int getWorkerIndex() const { return workerIndex; }
+};
+
+// =====================================================
+//	class WorkStealingScheduler
+//
+///	Runs a list of independent tasks on a fixed pool of
+/// threads. The tasks are split into chunks which are
+/// dealt out to per worker queues, a worker that runs
+/// out of chunks steals from the back of another
+/// worker's queue. The calling thread works as worker 0
+/// and run() returns once every task has finished.
+// =====================================================
+
+class WorkStealingScheduler {
+public:
+	static const int maxWorkerCount = 16;
+
+private:
+	class TaskChunk {
+	public:
+		TaskChunk(int first, int last) : first(first), last(last) {}
+		int first;
+		int last;
+	};
+
+	class WorkerQueue {
+	public:
+		WorkerQueue() : mutex(NULL) {}
+		Mutex *mutex;
+		std::deque<TaskChunk> chunks;
+	};
+
+	// pool threads of every scheduler that is alive, more than one
+	// may run at a time, e.g. the type loaders next to the game's
+	static const int maxRegisteredThreads = maxWorkerCount * 4;
+	static Mutex mutexWorkerThreads;
+	static unsigned long workerThreadIds[maxRegisteredThreads];
+	static int workerThreadIndexes[maxRegisteredThreads];
+
+	int workerCount;
+	int chunkSize;
+	std::vector<WorkerQueue> queues;
+	std::vector<WorkStealingWorkerThread *> threads;
+
+	WorkStealingTaskInterface *tasks;
+	Mutex *mutexPending;
+	int pendingChunks;
+	string taskError;
+	Semaphore semCompleted;
+
+	WorkStealingScheduler(const WorkStealingScheduler &obj);
+	WorkStealingScheduler & operator=(const WorkStealingScheduler &obj);
+
+	bool takeChunk(int workerIndex, TaskChunk &chunk);
+	void executeChunk(int workerIndex, const TaskChunk &chunk);
+
+public:
+	explicit WorkStealingScheduler(int workerCount=0, int chunkSize=4);
+	~WorkStealingScheduler();
+
+	int getWorkerCount() const { return workerCount; }
+	int getChunkSize() const { return chunkSize; }
+
+	// Runs taskCount tasks and blocks until all of them are done. The
+	// first error thrown by a task is rethrown once the others finish.
+	void run(WorkStealingTaskInterface *tasks, int taskCount);
+
+	// Called by the worker threads while the scheduler is running
+	void workerLoop(int workerIndex);
+	static void registerWorkerThread(int workerIndex, unsigned long threadId);
+	static void unregisterWorkerThread(unsigned long threadId);
+
+	// Index of the pool thread running the caller, 0 for any thread
+	// that doesn't belong to a scheduler pool
+	static int getCurrentWorkerIndex();
+
+	static int getDefaultWorkerCount();
+};
+
+}}//end namespace
+
+#endif
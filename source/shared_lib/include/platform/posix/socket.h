@@ -114,6 +114,18 @@ public:
 	string getString() const;
 };
 
+// =====================================================
+//	class SocketReceiveTap
+//
+///	Gets a copy of every byte a socket receives
+// =====================================================
+class SocketReceiveTap {
+public:
+	virtual void socketDataReceived(const void *data, int dataSize) = 0;
+
+	virtual ~SocketReceiveTap() {}
+};
+
 // =====================================================
 //	class Socket
 // =====================================================
@@ -152,6 +164,21 @@ protected:
 	bool isSocketBlocking;
 	time_t lastSocketError;
 
+	// bytes of an open send batch, kept between batches to reuse the memory
+	std::vector<char> sendBatchBuffer;
+	int sendBatchDepth;
+
+	// bytes a socket with a send queue could not write yet
+	std::vector<char> sendQueueBuffer;
+	bool sendQueueEnabled;
+	int maxSendQueueBytes;
+
+	SocketReceiveTap *receiveTap;
+
+	// bytes that went through the socket since it was created
+	int64 sentByteCount;
+	int64 receivedByteCount;
+
 	static string host_name;
 	static std::vector<string> intfTypes;
 
@@ -187,6 +214,8 @@ public:
 
 	int getDataToRead(bool wantImmediateReply=false);
 	int send(const void *data, int dataSize);
+	// Sends bufferCount buffers as one write, returns the total bytes sent
+	int sendv(const void * const data[], const int dataSize[], int bufferCount);
 	int receive(void *data, int dataSize, bool tryReceiveUntilDataSizeMet);
 	int peek(void *data, int dataSize, bool mustGetData=true,int *pLastSocketError=NULL);
 
@@ -194,6 +223,27 @@ public:
 	static void setBlock(bool block, PLATFORM_SOCKET socket);
 	bool getBlock();
 
+	// While a batch is open sends are only appended to a buffer of the
+	// socket, closing the outermost batch writes them out at once
+	void beginSendBatch();
+	bool endSendBatch();
+	bool isSendBatchOpen();
+
+	// With a send queue sends never wait for the peer, whatever the socket
+	// can't take right away is kept and goes out ahead of later sends. A
+	// peer that lets more than maxQueueBytes pile up is disconnected.
+	static const int defaultMaxSendQueueBytes;
+	void enableSendQueue(int maxQueueBytes=defaultMaxSendQueueBytes);
+	bool flushSendQueue();
+	int64 getSendQueueSize();
+
+	void setReceiveTap(SocketReceiveTap *tap);
+
+	int64 getSentByteCount();
+	// sent bytes plus what waits in an open batch
+	int64 getQueuedByteCount();
+	int64 getReceivedByteCount();
+
 	bool isReadable(bool lockMutex=false);
 	bool isWritable(struct timeval *timeVal=NULL,bool lockMutex=false);
 	bool isConnected();
@@ -212,6 +262,9 @@ public:
 	uint32 getConnectedIPAddress(string IP="");
 
 protected:
+	bool appendToSendBatch(const void *data, int dataSize);
+	bool writeSendQueue();
+
 	static void throwException(string str);
 	static void getLocalIPAddressListForPlatform(std::vector<std::string> &ipList);
 };
@@ -0,0 +1,83 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_PLATFORM_SOCKETREACTOR_H_
+#define _SHARED_PLATFORM_SOCKETREACTOR_H_
+
+#include "socket.h"
+#include <vector>
+#include "leak_dumper.h"
+
+namespace Shared { namespace Platform {
+
+// =====================================================
+//	class SocketReactorEvent
+// =====================================================
+
+class SocketReactorEvent {
+public:
+	SocketReactorEvent() {
+		userData = -1;
+		readable = false;
+		writable = false;
+		hangup = false;
+	}
+
+	int userData;
+	bool readable;
+	bool writable;
+	bool hangup;
+};
+
+// =====================================================
+//	class SocketReactor
+//
+///	Waits for any number of sockets with a single
+/// edge triggered epoll set. An event is only reported
+/// when new data arrives, so the caller has to keep
+/// reading a socket until it is drained. Only available
+/// on Linux, isSupported() returns false elsewhere.
+// =====================================================
+
+class SocketReactor {
+private:
+	int pollId;
+	int wakeupId;
+
+	SocketReactor(const SocketReactor &);
+	void operator=(const SocketReactor &);
+
+public:
+	SocketReactor();
+	~SocketReactor();
+
+	static bool isSupported();
+
+	// Creates the epoll set, returns false when that fails
+	bool init();
+	bool isInitialized() const	{ return pollId >= 0; }
+
+	// userData is returned with the events of the socket and must not be
+	// negative. Adding a socket again updates its data and interests.
+	bool addSocket(PLATFORM_SOCKET socket, int userData, bool wantWritable=false);
+	void removeSocket(PLATFORM_SOCKET socket);
+
+	// Waits up to timeoutMilliseconds (-1 waits forever) and replaces the
+	// contents of events. Returns the number of events.
+	int wait(std::vector<SocketReactorEvent> &events, int timeoutMilliseconds);
+
+	// Makes a wait in another thread return at once
+	void wakeup();
+};
+
+}}//end namespace
+
+#endif
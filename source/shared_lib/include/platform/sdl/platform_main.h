@@ -28,6 +28,8 @@ const char  *GAME_ARGS[] = {
 	"--autostart-lastgame",
 	"--load-saved-game",
 	"--auto-test",
+	"--benchmark-sim",
+	"--load-test-clients",
 	"--connect",
 	"--connecthost",
 	"--starthost",
@@ -95,6 +97,7 @@ const char  *GAME_ARGS[] = {
 	"--debug-network-packets",
 	"--debug-network-packet-sizes",
 	"--debug-network-packet-stats",
+	"--network-telemetry",
 	"--enable-new-protocol",
 
 	"--create-data-archives",
@@ -112,6 +115,8 @@ enum GAME_ARG_TYPE {
 	GAME_ARG_AUTOSTART_LASTGAME,
 	GAME_ARG_AUTOSTART_LAST_SAVED_GAME,
 	GAME_ARG_AUTO_TEST,
+	GAME_ARG_BENCHMARK_SIM,
+	GAME_ARG_LOAD_TEST_CLIENTS,
 	GAME_ARG_CONNECT,
 	GAME_ARG_CLIENT,
 	GAME_ARG_SERVER,
@@ -182,6 +187,7 @@ enum GAME_ARG_TYPE {
 	GAME_ARG_DEBUG_NETWORK_PACKETS,
 	GAME_ARG_DEBUG_NETWORK_PACKET_SIZES,
 	GAME_ARG_DEBUG_NETWORK_PACKET_STATS,
+	GAME_ARG_NETWORK_TELEMETRY,
 	GAME_ARG_ENABLE_NEW_PROTOCOL,
 
 	GAME_ARG_CREATE_DATA_ARCHIVES,
@@ -222,6 +228,22 @@ void printParameterHelp(const char *argv0, bool foundInvalidArgs) {
 	printf("\n\n                     \tafter the game is finished or the time runs out. If z is");
 	printf("\n\n                     \tnot specified (or is empty) then auto test continues to cycle.");
 
+	printf("\n\n%s=x,y  \tRun a headless simulation benchmark.",GAME_ARGS[GAME_ARG_BENCHMARK_SIM]);
+	printf("\n\n                     \tWhere x is the name of the saved game file to load.");
+	printf("\n\n                     \tWhere y is the # of world frames to simulate, without");
+	printf("\n\n                     \trendering, sound or frame pacing. When done the frame rate,");
+	printf("\n\n                     \ttime per subsystem, peak memory and final world CRC are");
+	printf("\n\n                     \tprinted and the game exits.");
+
+	printf("\n\n%s=x,y  \tRun a network load test against a local headless server.",GAME_ARGS[GAME_ARG_LOAD_TEST_CLIENTS]);
+	printf("\n\n                     \tWhere x is the # of scripted clients to connect to the");
+	printf("\n\n                     \tserver on this machine, using the configured server port.");
+	printf("\n\n                     \tWhere y is the # of network keyframes to play. The clients");
+	printf("\n\n                     \tjoin, check the game data CRCs, launch the game with AI");
+	printf("\n\n                     \tplayers in the free slots and stream scripted commands.");
+	printf("\n\n                     \tWhen done keyframe latency percentiles, bytes per keyframe");
+	printf("\n\n                     \tand server frame wait time are printed and the game exits.");
+
 	printf("\n\n%s=x:y  \t\tAuto connect to host server at IP or hostname x using",GAME_ARGS[GAME_ARG_CONNECT]);
 	printf("\n\n                     \t    port y. Shortcut version of using %s and %s.",GAME_ARGS[GAME_ARG_CLIENT],GAME_ARGS[GAME_ARG_USE_PORTS]);
 	printf("\n\n                     \t*NOTE: to automatically connect to the first LAN host you may");
@@ -260,6 +282,10 @@ void printParameterHelp(const char *argv0, bool foundInvalidArgs) {
 
 	printf("\n\n%s=x  \tSet server title.",GAME_ARGS[GAME_ARG_SERVER_TITLE]);
 
+	printf("\n\n%s=x  ",GAME_ARGS[GAME_ARG_NETWORK_TELEMETRY]);
+	printf("\n\n                     \tWrite per peer network statistics as JSON to file x,");
+	printf("\n\n                     \t    relative names go to the logs folder.");
+
 	printf("\n\n%s=x  \tAuto load a scenario by scenario name.",GAME_ARGS[GAME_ARG_LOADSCENARIO]);
 	printf("\n\n%s=x  \t\tAuto load a mod by mod pathname.",GAME_ARGS[GAME_ARG_MOD]);
 
@@ -0,0 +1,150 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_UTIL_BINARYHEAP_H_
+#define _SHARED_UTIL_BINARYHEAP_H_
+
+#include <vector>
+#include <stdexcept>
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Platform;
+
+namespace Shared { namespace Util {
+
+// =====================================================
+//	class BinaryHeap
+//
+///	Array backed min-heap. Entries with equal keys are
+/// popped in the order they were pushed, which gives the
+/// same ordering as a std::map<Key, std::vector<T> > used
+/// as a bucketed FIFO priority queue.
+// =====================================================
+
+template<typename T, typename Key = float>
+class BinaryHeap {
+private:
+	class Entry {
+	public:
+		Key key;
+		uint32 sequence;
+		T value;
+	};
+
+	std::vector<Entry> entries;
+	uint32 nextSequence;
+
+	inline static bool less(const Entry &a, const Entry &b) {
+		if(a.key < b.key) {
+			return true;
+		}
+		if(b.key < a.key) {
+			return false;
+		}
+		return a.sequence < b.sequence;
+	}
+
+	inline void siftUp(size_t index) {
+		Entry entry = entries[index];
+		while(index > 0) {
+			size_t parent = (index - 1) / 2;
+			if(less(entry, entries[parent]) == false) {
+				break;
+			}
+			entries[index] = entries[parent];
+			index = parent;
+		}
+		entries[index] = entry;
+	}
+
+	inline void siftDown(size_t index) {
+		const size_t count = entries.size();
+		Entry entry = entries[index];
+		for(;;) {
+			size_t child = index * 2 + 1;
+			if(child >= count) {
+				break;
+			}
+			if(child + 1 < count && less(entries[child + 1], entries[child])) {
+				child++;
+			}
+			if(less(entries[child], entry) == false) {
+				break;
+			}
+			entries[index] = entries[child];
+			index = child;
+		}
+		entries[index] = entry;
+	}
+
+public:
+	BinaryHeap() {
+		nextSequence = 0;
+	}
+
+	inline void reserve(size_t count) {
+		entries.reserve(count);
+	}
+
+	inline void clear() {
+		entries.clear();
+		nextSequence = 0;
+	}
+
+	inline bool empty() const {
+		return entries.empty();
+	}
+
+	inline size_t size() const {
+		return entries.size();
+	}
+
+	inline void push(const Key &key, const T &value) {
+		Entry entry;
+		entry.key = key;
+		entry.sequence = nextSequence++;
+		entry.value = value;
+		entries.push_back(entry);
+		siftUp(entries.size() - 1);
+	}
+
+	inline const T & top() const {
+		if(entries.empty() == true) {
+			throw std::runtime_error("BinaryHeap::top() called on empty heap");
+		}
+		return entries.front().value;
+	}
+
+	inline const Key & topKey() const {
+		if(entries.empty() == true) {
+			throw std::runtime_error("BinaryHeap::topKey() called on empty heap");
+		}
+		return entries.front().key;
+	}
+
+	inline T pop() {
+		if(entries.empty() == true) {
+			throw std::runtime_error("BinaryHeap::pop() called on empty heap");
+		}
+		T result = entries.front().value;
+		entries.front() = entries.back();
+		entries.pop_back();
+		if(entries.empty() == false) {
+			siftDown(0);
+		}
+		return result;
+	}
+};
+
+}}//end namespace
+
+#endif
@@ -56,6 +56,9 @@ public:
 	uint32 addUInt(const uint32 &value);
 	uint32 addInt64(const int64 &value);
 	void addFile(const string &path);
+	// the files of another checksum, the order files are added in
+	// doesn't change the sum
+	void addFiles(const Checksum &checksum);
 
 	static void removeFileFromCache(const string file);
 	static void clearFileCache();
@@ -0,0 +1,78 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_UTIL_CONTENTCHUNKS_H_
+#define _SHARED_UTIL_CONTENTCHUNKS_H_
+
+#include <string>
+#include <vector>
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::string;
+using std::vector;
+using namespace Shared::Platform;
+
+namespace Shared { namespace Util {
+
+// =====================================================
+//	class ContentChunkFile
+//
+///	One file of a content manifest, path is relative to
+/// the content root and uses forward slashes
+// =====================================================
+
+class ContentChunkFile {
+public:
+	string path;
+	uint32 size;
+	vector<uint32> chunkCRCs;
+
+	ContentChunkFile() : size(0) {}
+};
+
+// =====================================================
+//	class ContentChunks
+//
+///	Splits content files into fixed size chunks with a
+/// CRC each, so a transfer can skip chunks the receiver
+/// already has and resume a partial file.
+// =====================================================
+
+class ContentChunks {
+public:
+	static const uint32 chunkSize;
+
+	static uint32 getChunkCount(uint32 fileSize);
+	static uint32 getChunkCRC(const unsigned char *data, uint32 size);
+
+	// false when the file can't be read
+	static bool getFileChunks(const string &file, ContentChunkFile &result);
+	// the file alone, with its name as the path
+	static bool buildFileManifest(const string &file, vector<ContentChunkFile> &result);
+	// all files below folder, sorted by path
+	static bool buildFolderManifest(const string &folder, vector<ContentChunkFile> &result);
+
+	// relative, no parent references and no drive letters
+	static bool isSafeRelativePath(const string &path);
+
+	// chunks of remote that the local file lacks or has different
+	static vector<uint32> getStaleChunks(const string &localFile, const ContentChunkFile &remote);
+
+	static bool readChunk(const string &file, uint32 chunkIndex, vector<unsigned char> &data);
+	// creates the file and its folders when needed
+	static bool writeChunk(const string &file, uint32 chunkIndex, const unsigned char *data, uint32 size);
+	static bool setFileSize(const string &file, uint32 size);
+};
+
+}}//end namespace
+
+#endif
@@ -0,0 +1,155 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_UTIL_PACKEDFIELDS_H_
+#define _SHARED_UTIL_PACKEDFIELDS_H_
+
+#include "data_types.h"
+#include "byte_order.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Platform;
+
+namespace Shared { namespace Util {
+
+// =====================================================
+//	class PackedString
+//
+///	A char buffer sent as a 16 bit length followed by
+/// packedSize - 1 bytes, what "Ns" meant in the pack()
+/// format strings. The buffer may be smaller than the
+/// packed size, reads never write past its end and
+/// always consume the packed size.
+// =====================================================
+
+class PackedString {
+public:
+	char *buffer;
+	int bufferSize;
+	int packedSize;
+
+	PackedString(char *buffer, int bufferSize, int packedSize) :
+		buffer(buffer), bufferSize(bufferSize), packedSize(packedSize) {}
+};
+
+// =====================================================
+//	Packed field archives
+//
+///	A message lists its fields once in a template
+/// member and runs it with one of these:
+///
+///		template<class Archive>
+///		void serializeFields(Archive &archive) {
+///			archive & messageType & data.frameCount;
+///		}
+///
+/// Field types pick the overload at compile time, so
+/// there is no format string to parse and a field can't
+/// be packed with the wrong width. Integers are big
+/// endian on the wire like packi16() and friends.
+// =====================================================
+
+class PackedFieldSizer {
+private:
+	unsigned int size;
+
+public:
+	PackedFieldSizer() : size(0) {}
+	unsigned int getSize() const						{ return size; }
+
+	PackedFieldSizer & operator&(int8)					{ size += 1; return *this; }
+	PackedFieldSizer & operator&(uint8)					{ size += 1; return *this; }
+	PackedFieldSizer & operator&(int16)					{ size += 2; return *this; }
+	PackedFieldSizer & operator&(uint16)				{ size += 2; return *this; }
+	PackedFieldSizer & operator&(int32)					{ size += 4; return *this; }
+	PackedFieldSizer & operator&(uint32)				{ size += 4; return *this; }
+	PackedFieldSizer & operator&(int64)					{ size += 8; return *this; }
+	PackedFieldSizer & operator&(uint64)				{ size += 8; return *this; }
+	PackedFieldSizer & operator&(const PackedString &value) { size += 2 + value.packedSize - 1; return *this; }
+};
+
+class PackedFieldWriter {
+private:
+	unsigned char *buffer;
+	unsigned int position;
+
+	template<class T>
+	inline void write(T value) {
+		for(int shift = (int)(sizeof(T) - 1) * 8; shift >= 0; shift -= 8) {
+			buffer[position++] = (unsigned char)(value >> shift);
+		}
+	}
+
+public:
+	explicit PackedFieldWriter(unsigned char *buffer) : buffer(buffer), position(0) {}
+	unsigned int getPosition() const					{ return position; }
+
+	PackedFieldWriter & operator&(int8 value)			{ buffer[position++] = (unsigned char)value; return *this; }
+	PackedFieldWriter & operator&(uint8 value)			{ buffer[position++] = value; return *this; }
+	PackedFieldWriter & operator&(int16 value)			{ write((uint16)value); return *this; }
+	PackedFieldWriter & operator&(uint16 value)			{ write(value); return *this; }
+	PackedFieldWriter & operator&(int32 value)			{ write((uint32)value); return *this; }
+	PackedFieldWriter & operator&(uint32 value)			{ write(value); return *this; }
+	PackedFieldWriter & operator&(int64 value)			{ write((uint64)value); return *this; }
+	PackedFieldWriter & operator&(uint64 value)			{ write(value); return *this; }
+	// the whole packed width is written, bytes behind the terminator
+	// included, the buffer is padded with zeros when it is smaller
+	PackedFieldWriter & operator&(const PackedString &value);
+};
+
+class PackedFieldReader {
+private:
+	const unsigned char *buffer;
+	unsigned int position;
+
+	template<class T>
+	inline T read() {
+		T value = 0;
+		for(unsigned int index = 0; index < sizeof(T); ++index) {
+			value = (T)((value << 8) | buffer[position++]);
+		}
+		return value;
+	}
+
+public:
+	explicit PackedFieldReader(const unsigned char *buffer) : buffer(buffer), position(0) {}
+	unsigned int getPosition() const					{ return position; }
+
+	PackedFieldReader & operator&(int8 &value)			{ value = (int8)buffer[position++]; return *this; }
+	PackedFieldReader & operator&(uint8 &value)			{ value = buffer[position++]; return *this; }
+	PackedFieldReader & operator&(int16 &value)			{ value = (int16)read<uint16>(); return *this; }
+	PackedFieldReader & operator&(uint16 &value)		{ value = read<uint16>(); return *this; }
+	PackedFieldReader & operator&(int32 &value)			{ value = (int32)read<uint32>(); return *this; }
+	PackedFieldReader & operator&(uint32 &value)		{ value = read<uint32>(); return *this; }
+	PackedFieldReader & operator&(int64 &value)			{ value = (int64)read<uint64>(); return *this; }
+	PackedFieldReader & operator&(uint64 &value)		{ value = read<uint64>(); return *this; }
+	// takes what fits into the buffer and always terminates it
+	PackedFieldReader & operator&(const PackedString &value);
+};
+
+// Byte order of the raw structs the old protocol sends, strings stay as they are
+class PackedFieldToCommonEndian {
+public:
+	template<class T>
+	PackedFieldToCommonEndian & operator&(T &value) { value = Shared::PlatformByteOrder::toCommonEndian(value); return *this; }
+	PackedFieldToCommonEndian & operator&(const PackedString &) { return *this; }
+};
+
+class PackedFieldFromCommonEndian {
+public:
+	template<class T>
+	PackedFieldFromCommonEndian & operator&(T &value) { value = Shared::PlatformByteOrder::fromCommonEndian(value); return *this; }
+	PackedFieldFromCommonEndian & operator&(const PackedString &) { return *this; }
+};
+
+}}//end namespace
+
+#endif
@@ -9,14 +9,16 @@
 //	License, or (at your option) any later version
 // ==============================================================
 
-#ifndef NETWORK_PROTOCOL_H_
-#define NETWORK_PROTOCOL_H_
+#ifndef _SHARED_UTIL_PACKEDFORMAT_H_
+#define _SHARED_UTIL_PACKEDFORMAT_H_
 
-namespace Glest{ namespace Game{
+namespace Shared { namespace Util {
 
+// Format string packing network messages used before PackedFieldWriter,
+// the unit tests compare both layouts
 unsigned int pack(unsigned char *buf, const char *format, ...);
 unsigned int unpack(unsigned char *buf, const char *format, ...);
 
-}};
+}}//end namespace
 
-#endif /* NETWORK_PROTOCOL_H_ */
+#endif
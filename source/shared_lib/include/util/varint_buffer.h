@@ -0,0 +1,93 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_UTIL_VARINTBUFFER_H_
+#define _SHARED_UTIL_VARINTBUFFER_H_
+
+#include <string>
+#include <vector>
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Platform;
+
+namespace Shared { namespace Util {
+
+// =====================================================
+//	class VarintWriter
+//
+///	Appends little endian base 128 varints to a byte
+/// buffer. Signed values are zigzag mapped first so
+/// small negative numbers stay short as well.
+// =====================================================
+
+class VarintWriter {
+private:
+	std::vector<unsigned char> buffer;
+
+public:
+	static inline uint32 zigzagEncode(int32 value) {
+		return ((uint32)value << 1) ^ (uint32)(value >> 31);
+	}
+
+	void clear()									{ buffer.clear(); }
+	const std::vector<unsigned char> &getBuffer() const { return buffer; }
+	int getSize() const								{ return (int)buffer.size(); }
+
+	void writeByte(unsigned char value)				{ buffer.push_back(value); }
+	void writeUInt(uint32 value);
+	void writeInt(int32 value)						{ writeUInt(zigzagEncode(value)); }
+	// four bytes, least significant first, for values such as checksums
+	// that would only grow when written as a varint
+	void writeFixedUInt(uint32 value);
+	// length as a varint followed by the bytes
+	void writeString(const std::string &value);
+
+	// bytes needed to write value with writeUInt
+	static int getUIntSize(uint32 value);
+};
+
+// =====================================================
+//	class VarintReader
+//
+///	Reads what VarintWriter wrote. Reading past the end
+/// or a varint longer than five bytes marks the reader
+/// as failed and returns 0 from then on.
+// =====================================================
+
+class VarintReader {
+private:
+	const unsigned char *data;
+	int size;
+	int position;
+	bool failed;
+
+public:
+	VarintReader(const unsigned char *data, int size);
+
+	static inline int32 zigzagDecode(uint32 value) {
+		return (int32)(value >> 1) ^ -(int32)(value & 1);
+	}
+
+	bool hasFailed() const							{ return failed; }
+	bool isAtEnd() const							{ return position >= size; }
+	int getPosition() const							{ return position; }
+
+	unsigned char readByte();
+	uint32 readUInt();
+	int32 readInt()									{ return zigzagDecode(readUInt()); }
+	uint32 readFixedUInt();
+	std::string readString();
+};
+
+}}//end namespace
+
+#endif
@@ -0,0 +1,82 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_XML_XMLARENA_H_
+#define _SHARED_XML_XMLARENA_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <stddef.h>
+#include "leak_dumper.h"
+
+using std::string;
+
+namespace Shared { namespace Xml {
+
+class XmlNode;
+class XmlAttribute;
+
+// =====================================================
+//	class XmlArena
+//
+///	Memory of one parsed XML tree. Nodes and attributes
+/// are cut from a few large blocks and the rapidxml
+/// buffer stays alive, so attribute names and values
+/// can point into it instead of being copied. The tree
+/// gives everything back at once when it is cleared.
+// =====================================================
+
+class XmlArena {
+private:
+	static const size_t minBlockSize;
+	static const size_t maxBlockSize;
+
+	std::vector<char *> blocks;
+	char *currentBlock;
+	size_t blockSize;
+	size_t blockUsed;
+	size_t allocatedBytes;
+
+	std::vector<char> buffer;
+	// first characters of the tags values may contain
+	bool tagStartCharacters[256];
+
+	// not copyable, owns its blocks
+	XmlArena(const XmlArena& obj);
+	XmlArena & operator=(const XmlArena& obj);
+
+public:
+	XmlArena();
+	~XmlArena();
+
+	void *allocate(size_t size);
+
+	// constructed in place, they are destroyed by XmlNode::release
+	XmlNode *newNode();
+	XmlAttribute *newAttribute();
+
+	// the text rapidxml parses in place, sizes the blocks to come
+	std::vector<char> &getBuffer()			{ return buffer; }
+	void setBufferSize(size_t size);
+
+	// one replacement map for all values of the tree
+	void setTagReplacementValues(const std::map<string,string> &mapTagReplacementValues);
+	// false when applying the tags can't change the value
+	bool mayContainTags(const char *value) const;
+
+	size_t getAllocatedBytes() const		{ return allocatedBytes + buffer.capacity(); }
+	int getBlockCount() const				{ return (int)blocks.size(); }
+};
+
+}}//end namespace
+
+#endif
@@ -0,0 +1,124 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_XML_XMLBINARYCACHE_H_
+#define _SHARED_XML_XMLBINARYCACHE_H_
+
+#include <string>
+#include <map>
+#include <vector>
+#include <time.h>
+#include "data_types.h"
+#include "leak_dumper.h"
+
+using std::string;
+using Shared::Platform::uint32;
+using Shared::Platform::int64;
+
+namespace Shared { namespace Platform {
+	class Mutex;
+}}
+
+namespace Shared { namespace Util {
+	class VarintWriter;
+	class VarintReader;
+}}
+
+namespace Shared { namespace Xml {
+
+class XmlNode;
+
+// =====================================================
+//	class XmlBinaryCache
+//
+///	Parsed XML trees of a set of files, tags already
+/// replaced, kept in one binary file that is read with
+/// a single read. The whole cache is thrown away when
+/// the content checksum it was built for changes, and
+/// every entry also remembers the time and size of its
+/// file, so the XML stays the source of truth.
+///
+/// While a cache is active XmlTree::load takes trees
+/// from it and records the ones it had to parse.
+// =====================================================
+
+class XmlBinaryCache {
+public:
+	static const uint32 cacheFileMagic;
+	static const uint32 cacheVersion;
+
+private:
+	class Entry {
+	public:
+		int64 fileTime;
+		int64 fileSize;
+		uint32 tagChecksum;
+		bool skipUpdatePathClimbingParts;
+		string data;
+		bool used;
+	};
+
+	static XmlBinaryCache *activeCache;
+
+	Shared::Platform::Mutex *mutex;
+	string file;
+	uint32 contentChecksum;
+	std::map<string,Entry> entries;
+	bool dirty;
+	int hitCount;
+	int missCount;
+
+	static void encodeNode(const XmlNode *node, Shared::Util::VarintWriter &writer,
+			std::map<string,uint32> &stringIndex);
+	static XmlNode *decodeNode(Shared::Util::VarintReader &reader,
+			const std::vector<string> &strings, int depth);
+
+	// not copyable, owns its mutex
+	XmlBinaryCache(const XmlBinaryCache& obj);
+	XmlBinaryCache & operator=(const XmlBinaryCache& obj);
+
+public:
+	XmlBinaryCache(const string &file, uint32 contentChecksum);
+	~XmlBinaryCache();
+
+	// used by XmlTree::load, NULL when no cache is active
+	static void setActive(XmlBinaryCache *cache)	{ activeCache = cache; }
+	static XmlBinaryCache *getActive()				{ return activeCache; }
+
+	static uint32 getTagChecksum(const std::map<string,string> &mapTagReplacementValues);
+
+	// a tree as a self contained blob with its own string table
+	static string encodeTree(const XmlNode *rootNode);
+	// NULL when the blob is damaged
+	static XmlNode *decodeTree(const string &data);
+
+	// false when there is no file or it was built for other content
+	bool load();
+	// writes only when something changed, entries of files that are
+	// gone are dropped
+	bool save();
+
+	// a new tree the caller owns, NULL when the file is not cached or
+	// changed since
+	XmlNode *getTree(const string &path, const std::map<string,string> &mapTagReplacementValues,
+			bool skipUpdatePathClimbingParts);
+	void addTree(const string &path, const std::map<string,string> &mapTagReplacementValues,
+			bool skipUpdatePathClimbingParts, const XmlNode *rootNode);
+
+	const string &getFile() const	{ return file; }
+	int getEntryCount() const		{ return (int)entries.size(); }
+	int getHitCount() const			{ return hitCount; }
+	int getMissCount() const		{ return missCount; }
+};
+
+}}//end namespace
+
+#endif
@@ -15,6 +15,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <string.h>
 
 #if defined(WANT_XERCES)
 
@@ -64,6 +65,39 @@ class XmlIo;
 class XmlTree;
 class XmlNode;
 class XmlAttribute;
+class XmlBinaryCache;
+class XmlArena;
+
+// =====================================================
+// 	class XmlStringView
+//
+///	Characters owned by someone else, the parse buffer
+/// of an arena tree or an attribute's own string. Always
+/// followed by a terminating 0.
+// =====================================================
+
+class XmlStringView {
+private:
+	const char *data;
+	size_t length;
+
+public:
+	XmlStringView() : data(""), length(0) {}
+	XmlStringView(const char *data, size_t length) : data(data), length(length) {}
+	explicit XmlStringView(const string &value) : data(value.c_str()), length(value.size()) {}
+
+	const char *c_str() const	{ return data; }
+	size_t size() const			{ return length; }
+	bool empty() const			{ return length == 0; }
+	string str() const			{ return string(data, length); }
+
+	bool operator==(const string &value) const {
+		return length == value.size() && memcmp(data, value.data(), length) == 0;
+	}
+	bool operator==(const char *value) const {
+		return strcmp(data, value) == 0;
+	}
+};
 
 #if defined(WANT_XERCES)
 // =====================================================
@@ -124,8 +158,13 @@ public:
 	static bool isInitialized();
 	void cleanup();
 
-	XmlNode *load(const string &path, const std::map<string,string> &mapTagReplacementValues,bool noValidation=false,bool skipStackTrace=false,bool skipUpdatePathClimbingParts=false);
+	// with an arena the tree is built in it and has to be freed with XmlNode::release
+	XmlNode *load(const string &path, const std::map<string,string> &mapTagReplacementValues,bool noValidation=false,bool skipStackTrace=false,bool skipUpdatePathClimbingParts=false,XmlArena *arena=NULL);
 	void save(const string &path, const XmlNode *node);
+
+	// Same as load and save but without touching the filesystem
+	XmlNode *loadFromString(const string &xmlData, const std::map<string,string> &mapTagReplacementValues,bool skipUpdatePathClimbingParts=false,XmlArena *arena=NULL);
+	string saveToString(const XmlNode *node);
 };
 
 // =====================================================
@@ -136,9 +175,15 @@ class XmlTree{
 private:
 	XmlNode *rootNode;
 	string loadPath;
+	// trees of other threads loading the same file are no recursion
+	unsigned long loadThreadId;
 	xml_engine_parser_type engine_type;
 	bool skipStackCheck;
 	bool skipUpdatePathClimbingParts;
+	// parsed trees live in here, NULL for trees that were built or
+	// came from the binary cache
+	XmlArena *arena;
+	bool arenaEnabled;
 private:
 	XmlTree(XmlTree&);
 	void operator =(XmlTree&);
@@ -149,10 +194,17 @@ public:
 	~XmlTree();
 
 	void setSkipUpdatePathClimbingParts(bool value);
+	// on by default, parsed trees are then allocated in one arena
+	void setArenaEnabled(bool value)	{ arenaEnabled = value; }
+	const XmlArena *getArena() const	{ return arena; }
 	void init(const string &name);
 	void load(const string &path, const std::map<string,string> &mapTagReplacementValues, bool noValidation=false,bool skipStackCheck=false,bool skipStackTrace=false);
 	void save(const string &path);
 
+	// Only supported by the rapidxml engine
+	void loadFromString(const string &xmlData, const std::map<string,string> &mapTagReplacementValues);
+	string saveToString();
+
 	XmlNode *getRootNode() const	{return rootNode;}
 };
 
@@ -167,11 +219,21 @@ private:
 	vector<XmlNode*> children;
 	vector<XmlAttribute*> attributes;
 	mutable const XmlNode* superNode;
+	// set when the node was allocated in an arena
+	XmlArena *arena;
+
+	// builds trees from its binary form without parsing
+	friend class XmlBinaryCache;
+	friend class XmlArena;
 
 private:
 	XmlNode(XmlNode&);
 	void operator =(XmlNode&);
 
+	explicit XmlNode(XmlArena *arena);
+	void init(xml_node<> *node, const std::map<string,string> &mapTagReplacementValues,bool skipUpdatePathClimbingParts);
+	void releaseContent();
+
 	string getTreeString() const;
 	bool hasChildNoSuper(const string& childName) const;
 
@@ -187,6 +249,11 @@ public:
 	XmlNode(xml_node<> *node, const std::map<string,string> &mapTagReplacementValues,bool skipUpdatePathClimbingParts=false);
 	XmlNode(const string &name);
 	~XmlNode();
+
+	// a parsed tree allocated in the arena
+	static XmlNode *newArenaNode(XmlArena *arena, xml_node<> *node, const std::map<string,string> &mapTagReplacementValues,bool skipUpdatePathClimbingParts=false);
+	// deletes the node or, when it lives in an arena, only destroys it
+	static void release(XmlNode *node);
 	
 	void setSuper(const XmlNode* superNode) const { this->superNode = superNode; }
 
@@ -222,14 +289,30 @@ class XmlAttribute {
 private:
 	string value;
 	string name;
+	// where the name and value are read from, the strings above or
+	// the parse buffer of an arena tree when no tag had to be replaced
+	XmlStringView valueView;
+	XmlStringView nameView;
 	bool skipRestrictionCheck;
 	bool usesCommondata;
-	std::map<string,string> mapTagReplacementValues;
+	// set when the attribute was allocated in an arena
+	XmlArena *arena;
+
+	friend class XmlBinaryCache;
+	friend class XmlArena;
+	friend class XmlNode;
 
 private:
 	XmlAttribute(XmlAttribute&);
 	void operator =(XmlAttribute&);
 
+	explicit XmlAttribute(XmlArena *arena);
+	void init(xml_attribute<> *attribute, const std::map<string,string> &mapTagReplacementValues);
+	void setName(const string &name);
+
+	// value with the tags already replaced
+	XmlAttribute(const string &name, const string &value, bool skipRestrictionCheck, bool usesCommondata);
+
 public:
 
 #if defined(WANT_XERCES)
@@ -242,7 +325,13 @@ public:
 	XmlAttribute(const string &name, const string &value, const std::map<string,string> &mapTagReplacementValues);
 
 public:
-	const string getName() const	{return name;}
+	// deletes the attribute or, when it lives in an arena, only destroys it
+	static void release(XmlAttribute *attribute);
+
+	const string getName() const		{return nameView.str();}
+	XmlStringView getNameView() const	{return nameView;}
+	// the value as it is, without prefix or restriction check
+	XmlStringView getValueView() const	{return valueView;}
 	const string getValue(string prefixValue="", bool trimValueWithStartingSlash=false) const;
 
 	bool getBoolValue() const;
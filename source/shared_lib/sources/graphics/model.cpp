@@ -21,9 +21,12 @@
 #include "platform_common.h"
 #include "opengl.h"
 #include "platform_util.h"
+#include "work_stealing_scheduler.h"
+#include "checksum.h"
 //#include <memory>
 #include <map>
 #include <vector>
+#include <algorithm>
 #include "leak_dumper.h"
 
 using namespace Shared::Platform;
@@ -195,6 +198,179 @@ void fromEndianMeshHeaderV2(MeshHeaderV2 &header) {
 	}
 }
 
+// =====================================================
+//	VBOs
+// =====================================================
+
+static void buildMeshVBOs(uint32 frameCount, uint32 vertexCount, uint32 indexCount,
+		const Vec3f *vertices, const Vec2f *texCoords, const Vec3f *normals, const uint32 *indices,
+		uint32 &vboVertices, uint32 &vboTexCoords, uint32 &vboNormals, uint32 &vboIndexes) {
+	// Generate And Bind The Vertex Buffer
+	glGenBuffersARB( 1,(GLuint*) &vboVertices );					// Get A Valid Name
+	glBindBufferARB( GL_ARRAY_BUFFER_ARB, vboVertices );			// Bind The Buffer
+	// Load The Data
+	glBufferDataARB( GL_ARRAY_BUFFER_ARB,  sizeof(Vec3f)*frameCount*vertexCount, vertices, GL_STATIC_DRAW_ARB );
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+	// Generate And Bind The Texture Coordinate Buffer
+	glGenBuffersARB( 1, (GLuint*)&vboTexCoords );					// Get A Valid Name
+	glBindBufferARB( GL_ARRAY_BUFFER_ARB, vboTexCoords );		// Bind The Buffer
+	// Load The Data
+	glBufferDataARB( GL_ARRAY_BUFFER_ARB, sizeof(Vec2f)*vertexCount, texCoords, GL_STATIC_DRAW_ARB );
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+	// Generate And Bind The Normal Buffer
+	glGenBuffersARB( 1, (GLuint*)&vboNormals );					// Get A Valid Name
+	glBindBufferARB( GL_ARRAY_BUFFER_ARB, vboNormals );			// Bind The Buffer
+	// Load The Data
+	glBufferDataARB( GL_ARRAY_BUFFER_ARB,  sizeof(Vec3f)*frameCount*vertexCount, normals, GL_STATIC_DRAW_ARB );
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+	// Generate And Bind The Index Buffer
+	glGenBuffersARB( 1, (GLuint*)&vboIndexes );					// Get A Valid Name
+	glBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, vboIndexes );			// Bind The Buffer
+	// Load The Data
+	glBufferDataARB( GL_ELEMENT_ARRAY_BUFFER_ARB,  sizeof(uint32)*indexCount, indices, GL_STATIC_DRAW_ARB );
+	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+}
+
+static void releaseMeshVBOs(uint32 &vboVertices, uint32 &vboTexCoords, uint32 &vboNormals, uint32 &vboIndexes) {
+	glDeleteBuffersARB( 1, (GLuint*)&vboVertices );
+	glDeleteBuffersARB( 1, (GLuint*)&vboTexCoords );
+	glDeleteBuffersARB( 1, (GLuint*)&vboNormals );
+	glDeleteBuffersARB( 1, (GLuint*)&vboIndexes );
+	vboVertices		= 0;
+	vboTexCoords	= 0;
+	vboNormals		= 0;
+	vboIndexes		= 0;
+}
+
+// =====================================================
+//	class SharedMeshData
+// =====================================================
+
+SharedMeshData::SharedMeshData(Mesh *mesh, uint32 key, Mutex *mutex) {
+	this->key		= key;
+	this->hash		= computeHash(mesh);
+	this->mutex		= mutex;
+
+	frameCount		= mesh->frameCount;
+	vertexCount		= mesh->vertexCount;
+	indexCount		= mesh->indexCount;
+	vertices		= mesh->vertices;
+	normals			= mesh->normals;
+	texCoords		= mesh->texCoords;
+	indices			= mesh->indices;
+
+	hasBuiltVBOs	= false;
+	m_nVBOVertices	= 0;
+	m_nVBOTexCoords	= 0;
+	m_nVBONormals	= 0;
+	m_nVBOIndexes	= 0;
+}
+
+SharedMeshData::~SharedMeshData() {
+	if(hasBuiltVBOs == true && getVBOSupported() == true) {
+		releaseMeshVBOs(m_nVBOVertices, m_nVBOTexCoords, m_nVBONormals, m_nVBOIndexes);
+	}
+	delete [] vertices;
+	vertices=NULL;
+	delete [] normals;
+	normals=NULL;
+	delete [] texCoords;
+	texCoords=NULL;
+	delete [] indices;
+	indices=NULL;
+}
+
+uint32 SharedMeshData::computeKey(const Mesh *mesh) {
+	Checksum checksum;
+	checksum.addUInt(mesh->frameCount);
+	checksum.addUInt(mesh->vertexCount);
+	checksum.addUInt(mesh->indexCount);
+	if(mesh->vertices != NULL) {
+		checksum.addBytes(mesh->vertices, sizeof(Vec3f) * mesh->frameCount * mesh->vertexCount);
+	}
+	if(mesh->normals != NULL) {
+		checksum.addBytes(mesh->normals, sizeof(Vec3f) * mesh->frameCount * mesh->vertexCount);
+	}
+	if(mesh->texCoords != NULL) {
+		checksum.addBytes(mesh->texCoords, sizeof(Vec2f) * mesh->vertexCount);
+	}
+	if(mesh->indices != NULL) {
+		checksum.addBytes(mesh->indices, sizeof(uint32) * mesh->indexCount);
+	}
+	return checksum.getSum();
+}
+
+// FNV-1a over the counts and arrays
+static void addHashBytes(uint64 &hash, const void *data, size_t size) {
+	const unsigned char *bytes = static_cast<const unsigned char *>(data);
+	for(size_t i = 0; i < size; ++i) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+}
+
+uint64 SharedMeshData::computeHash(const Mesh *mesh) {
+	uint64 hash = 14695981039346656037ULL;
+	addHashBytes(hash, &mesh->frameCount, sizeof(mesh->frameCount));
+	addHashBytes(hash, &mesh->vertexCount, sizeof(mesh->vertexCount));
+	addHashBytes(hash, &mesh->indexCount, sizeof(mesh->indexCount));
+	if(mesh->vertices != NULL) {
+		addHashBytes(hash, mesh->vertices, sizeof(Vec3f) * mesh->frameCount * mesh->vertexCount);
+	}
+	if(mesh->normals != NULL) {
+		addHashBytes(hash, mesh->normals, sizeof(Vec3f) * mesh->frameCount * mesh->vertexCount);
+	}
+	if(mesh->texCoords != NULL) {
+		addHashBytes(hash, mesh->texCoords, sizeof(Vec2f) * mesh->vertexCount);
+	}
+	if(mesh->indices != NULL) {
+		addHashBytes(hash, mesh->indices, sizeof(uint32) * mesh->indexCount);
+	}
+	return hash;
+}
+
+bool SharedMeshData::hasSameData(const Mesh *mesh) const {
+	if(frameCount != mesh->frameCount || vertexCount != mesh->vertexCount ||
+		indexCount != mesh->indexCount) {
+		return false;
+	}
+	if(mesh->vertices == NULL || mesh->normals == NULL || mesh->texCoords == NULL || mesh->indices == NULL) {
+		return false;
+	}
+	// data that went to the graphics card only has its hash left to compare
+	if(vertices == NULL) {
+		return hash == computeHash(mesh);
+	}
+	return memcmp(vertices, mesh->vertices, sizeof(Vec3f) * frameCount * vertexCount) == 0 &&
+			memcmp(normals, mesh->normals, sizeof(Vec3f) * frameCount * vertexCount) == 0 &&
+			memcmp(texCoords, mesh->texCoords, sizeof(Vec2f) * vertexCount) == 0 &&
+			memcmp(indices, mesh->indices, sizeof(uint32) * indexCount) == 0;
+}
+
+void SharedMeshData::BuildVBOs() {
+	if(hasBuiltVBOs == false) {
+		buildMeshVBOs(frameCount, vertexCount, indexCount,
+				vertices, texCoords, normals, indices,
+				m_nVBOVertices, m_nVBOTexCoords, m_nVBONormals, m_nVBOIndexes);
+		hasBuiltVBOs = true;
+
+		// all meshes render from the VBOs now, models loaded later with the
+		// same data are matched by the hash and share the VBOs right away
+		MutexSafeWrapper safeMutex(mutex);
+		delete [] vertices; vertices = NULL;
+		delete [] texCoords; texCoords = NULL;
+		delete [] normals; normals = NULL;
+		delete [] indices; indices = NULL;
+
+		for(unsigned int i = 0; i < meshes.size(); ++i) {
+			meshes[i]->useSharedVBOs();
+		}
+	}
+}
+
 // =====================================================
 //	class Mesh
 // =====================================================
@@ -235,6 +411,8 @@ Mesh::Mesh() {
 	m_nVBOTexCoords	= 0;
 	m_nVBONormals	= 0;
 	m_nVBOIndexes	= 0;
+
+	sharedData		= NULL;
 }
 
 Mesh::~Mesh() {
@@ -277,6 +455,8 @@ void Mesh::init() {
 }
 
 void Mesh::end() {
+	// the model manager has released shared data under its lock already
+	releaseSharedData();
 	ReleaseVBOs();
 
 	delete [] vertices;
@@ -335,60 +515,103 @@ void Mesh::BuildVBOs() {
 		if(hasBuiltVBOs == false) {
 			//printf("In [%s::%s Line: %d] setting up a VBO...\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__);
 
-			// Generate And Bind The Vertex Buffer
-			glGenBuffersARB( 1,(GLuint*) &m_nVBOVertices );					// Get A Valid Name
-			glBindBufferARB( GL_ARRAY_BUFFER_ARB, m_nVBOVertices );			// Bind The Buffer
-			// Load The Data
-			glBufferDataARB( GL_ARRAY_BUFFER_ARB,  sizeof(Vec3f)*frameCount*vertexCount, vertices, GL_STATIC_DRAW_ARB );
-			glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-
-			// Generate And Bind The Texture Coordinate Buffer
-			glGenBuffersARB( 1, (GLuint*)&m_nVBOTexCoords );					// Get A Valid Name
-			glBindBufferARB( GL_ARRAY_BUFFER_ARB, m_nVBOTexCoords );		// Bind The Buffer
-			// Load The Data
-			glBufferDataARB( GL_ARRAY_BUFFER_ARB, sizeof(Vec2f)*vertexCount, texCoords, GL_STATIC_DRAW_ARB );
-			glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-
-			// Generate And Bind The Normal Buffer
-			glGenBuffersARB( 1, (GLuint*)&m_nVBONormals );					// Get A Valid Name
-			glBindBufferARB( GL_ARRAY_BUFFER_ARB, m_nVBONormals );			// Bind The Buffer
-			// Load The Data
-			glBufferDataARB( GL_ARRAY_BUFFER_ARB,  sizeof(Vec3f)*frameCount*vertexCount, normals, GL_STATIC_DRAW_ARB );
-			glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
-
-			// Generate And Bind The Index Buffer
-			glGenBuffersARB( 1, (GLuint*)&m_nVBOIndexes );					// Get A Valid Name
-			glBindBufferARB( GL_ELEMENT_ARRAY_BUFFER_ARB, m_nVBOIndexes );			// Bind The Buffer
-			// Load The Data
-			glBufferDataARB( GL_ELEMENT_ARRAY_BUFFER_ARB,  sizeof(uint32)*indexCount, indices, GL_STATIC_DRAW_ARB );
-			glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
-
-			// Our Copy Of The Data Is No Longer Necessary, It Is Safe In The Graphics Card
-			delete [] vertices; vertices = NULL;
-			delete [] texCoords; texCoords = NULL;
-			delete [] normals; normals = NULL;
-			delete [] indices; indices = NULL;
-
-			delete interpolationData;
-			interpolationData = NULL;
-
-			hasBuiltVBOs = true;
+			if(sharedData != NULL) {
+				// sets up this mesh and all others using the data
+				sharedData->BuildVBOs();
+			}
+			else {
+				buildMeshVBOs(frameCount, vertexCount, indexCount,
+						vertices, texCoords, normals, indices,
+						m_nVBOVertices, m_nVBOTexCoords, m_nVBONormals, m_nVBOIndexes);
+
+				// Our Copy Of The Data Is No Longer Necessary, It Is Safe In The Graphics Card
+				delete [] vertices; vertices = NULL;
+				delete [] texCoords; texCoords = NULL;
+				delete [] normals; normals = NULL;
+				delete [] indices; indices = NULL;
+
+				delete interpolationData;
+				interpolationData = NULL;
+
+				hasBuiltVBOs = true;
+			}
 		}
 	}
 }
 
+// the shared arrays are gone, like a mesh that built its own VBOs
+// nothing is left to interpolate
+void Mesh::useSharedVBOs() {
+	m_nVBOVertices	= sharedData->m_nVBOVertices;
+	m_nVBOTexCoords	= sharedData->m_nVBOTexCoords;
+	m_nVBONormals	= sharedData->m_nVBONormals;
+	m_nVBOIndexes	= sharedData->m_nVBOIndexes;
+
+	vertices	= NULL;
+	normals		= NULL;
+	texCoords	= NULL;
+	indices		= NULL;
+
+	delete interpolationData;
+	interpolationData = NULL;
+
+	hasBuiltVBOs = true;
+}
+
 void Mesh::ReleaseVBOs() {
 	if(getVBOSupported() == true) {
 		if(hasBuiltVBOs == true) {
-			glDeleteBuffersARB( 1, (GLuint*)&m_nVBOVertices );					// Get A Valid Name
-			glDeleteBuffersARB( 1, (GLuint*)&m_nVBOTexCoords );					// Get A Valid Name
-			glDeleteBuffersARB( 1, (GLuint*)&m_nVBONormals );					// Get A Valid Name
-			glDeleteBuffersARB( 1, (GLuint*)&m_nVBOIndexes );					// Get A Valid Name
+			if(sharedData == NULL) {
+				releaseMeshVBOs(m_nVBOVertices, m_nVBOTexCoords, m_nVBONormals, m_nVBOIndexes);
+			}
 			hasBuiltVBOs = false;
 		}
 	}
 }
 
+void Mesh::shareData(SharedMeshData *sharedData) {
+	if(this->sharedData != NULL || hasBuiltVBOs == true) {
+		throw megaglest_runtime_error("Mesh [" + name + "] can't share its data twice");
+	}
+	// the first mesh with the data gave its arrays to it
+	if(vertices != sharedData->vertices) delete [] vertices;
+	if(normals != sharedData->normals) delete [] normals;
+	if(texCoords != sharedData->texCoords) delete [] texCoords;
+	if(indices != sharedData->indices) delete [] indices;
+
+	vertices	= sharedData->vertices;
+	normals		= sharedData->normals;
+	texCoords	= sharedData->texCoords;
+	indices		= sharedData->indices;
+
+	this->sharedData = sharedData;
+	sharedData->meshes.push_back(this);
+	if(sharedData->hasBuiltVBOs == true) {
+		useSharedVBOs();
+	}
+}
+
+void Mesh::releaseSharedData() {
+	if(sharedData != NULL) {
+		vertices	= NULL;
+		normals		= NULL;
+		texCoords	= NULL;
+		indices		= NULL;
+
+		hasBuiltVBOs	= false;
+		m_nVBOVertices	= 0;
+		m_nVBOTexCoords	= 0;
+		m_nVBONormals	= 0;
+		m_nVBOIndexes	= 0;
+
+		sharedData->meshes.erase(std::remove(sharedData->meshes.begin(), sharedData->meshes.end(), this), sharedData->meshes.end());
+		if(sharedData->meshes.empty() == true) {
+			delete sharedData;
+		}
+		sharedData = NULL;
+	}
+}
+
 // ==================== load ====================
 
 string Mesh::findAlternateTexture(vector<string> conversionList, string textureFile) {
@@ -467,34 +690,9 @@ void Mesh::loadV2(int meshIndex, const string &dir, FILE *f, TextureManager *tex
 
 		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] v2 model texture [%s] meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshIndex,modelFile.c_str());
 
-		textures[mtDiffuse]= dynamic_cast<Texture2D*>(textureManager->getTexture(texPath));
-		if(textures[mtDiffuse] == NULL) {
-			if(fileExists(texPath) == false) {
-				vector<string> conversionList;
-				conversionList.push_back("png");
-				conversionList.push_back("jpg");
-				conversionList.push_back("tga");
-				conversionList.push_back("bmp");
-				texPath = findAlternateTexture(conversionList, texPath);
-			}
-			if(fileExists(texPath) == true) {
-				if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] v2 model texture [%s] meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshIndex,modelFile.c_str());
-
-				textures[mtDiffuse]= textureManager->newTexture2D();
-				textures[mtDiffuse]->load(texPath);
-				if(loadedFileList) {
-					(*loadedFileList)[texPath].push_back(make_pair(sourceLoader,sourceLoader));
-				}
-				texturesOwned[mtDiffuse]=true;
-				textures[mtDiffuse]->init(textureManager->getTextureFilter(),textureManager->getMaxAnisotropy());
-				if(deletePixMapAfterLoad == true) {
-					textures[mtDiffuse]->deletePixels();
-				}
-			}
-			else {
-				SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error v2 model is missing texture [%s] meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshIndex,modelFile.c_str());
-			}
-		}
+		textures[mtDiffuse]= loadMeshTexture(meshIndex, mtDiffuse, textureManager, texPath,
+				-1, texturesOwned[mtDiffuse], deletePixMapAfterLoad,
+				loadedFileList, sourceLoader, modelFile);
 	}
 
 	//read data
@@ -609,36 +807,9 @@ void Mesh::loadV3(int meshIndex, const string &dir, FILE *f,
 
 		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] v3 model texture [%s] meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshIndex,modelFile.c_str());
 
-		textures[mtDiffuse]= dynamic_cast<Texture2D*>(textureManager->getTexture(texPath));
-		if(textures[mtDiffuse] == NULL) {
-			if(fileExists(texPath) == false) {
-				vector<string> conversionList;
-				conversionList.push_back("png");
-				conversionList.push_back("jpg");
-				conversionList.push_back("tga");
-				conversionList.push_back("bmp");
-				texPath = findAlternateTexture(conversionList, texPath);
-			}
-
-			if(fileExists(texPath) == true) {
-				if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] v3 model texture [%s] meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshIndex,modelFile.c_str());
-
-				textures[mtDiffuse]= textureManager->newTexture2D();
-				textures[mtDiffuse]->load(texPath);
-				if(loadedFileList) {
-					(*loadedFileList)[texPath].push_back(make_pair(sourceLoader,sourceLoader));
-				}
-
-				texturesOwned[mtDiffuse]=true;
-				textures[mtDiffuse]->init(textureManager->getTextureFilter(),textureManager->getMaxAnisotropy());
-				if(deletePixMapAfterLoad == true) {
-					textures[mtDiffuse]->deletePixels();
-				}
-			}
-			else {
-				SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error v3 model is missing texture [%s] meshHeader.properties = %d meshIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,texPath.c_str(),meshHeader.properties,meshIndex,modelFile.c_str());
-			}
-		}
+		textures[mtDiffuse]= loadMeshTexture(meshIndex, mtDiffuse, textureManager, texPath,
+				-1, texturesOwned[mtDiffuse], deletePixMapAfterLoad,
+				loadedFileList, sourceLoader, modelFile);
 	}
 
 	//read data
@@ -709,7 +880,8 @@ Texture2D* Mesh::loadMeshTexture(int meshIndex, int textureIndex,
 
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] #1 load texture [%s] modelFile [%s]\n",__FUNCTION__,textureFile.c_str(),modelFile.c_str());
 
-	Texture2D* texture = dynamic_cast<Texture2D*>(textureManager->getTexture(textureFile));
+	bool created = false;
+	Texture2D* texture = textureManager->findModelTexture(textureFile);
 	if(texture == NULL) {
 		if(fileExists(textureFile) == false) {
 			vector<string> conversionList;
@@ -723,31 +895,44 @@ Texture2D* Mesh::loadMeshTexture(int meshIndex, int textureIndex,
 		}
 
 		if(fileExists(textureFile) == true) {
-			if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] #3 load texture [%s] modelFile [%s]\n",__FUNCTION__,textureFile.c_str(),modelFile.c_str());
-			//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] texture exists loading [%s]\n",__FUNCTION__,textureFile.c_str());
+			texture = textureManager->getModelTexture(textureFile, created);
+		}
+		else {
+			if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] #3 cannot load texture [%s] modelFile [%s]\n",__FUNCTION__,textureFile.c_str(),modelFile.c_str());
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error model is missing texture [%s] textureFlags = %d meshIndex = %d textureIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,textureFile.c_str(),textureFlags,meshIndex,textureIndex,modelFile.c_str());
+		}
+	}
 
-			texture = textureManager->newTexture2D();
-			if(textureChannelCount != -1) {
-				texture->getPixmap()->init(textureChannelCount);
-			}
-			texture->load(textureFile);
-			if(loadedFileList) {
-				(*loadedFileList)[textureFile].push_back(make_pair(sourceLoader,sourceLoader));
-			}
+	if(created == true) {
+		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] #3 load texture [%s] modelFile [%s]\n",__FUNCTION__,textureFile.c_str(),modelFile.c_str());
 
-			//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] texture loaded [%s]\n",__FUNCTION__,textureFile.c_str());
+		if(textureChannelCount != -1) {
+			texture->getPixmap()->init(textureChannelCount);
+		}
+		texture->load(textureFile);
+		if(loadedFileList) {
+			(*loadedFileList)[textureFile].push_back(make_pair(sourceLoader,sourceLoader));
+		}
+		textureOwned = true;
 
-			textureOwned = true;
+		// GL belongs to the main thread, textures loaded by a pool thread
+		// are uploaded when their manager is initialized
+		if(WorkStealingScheduler::getCurrentWorkerIndex() == 0) {
 			texture->init(textureManager->getTextureFilter(),textureManager->getMaxAnisotropy());
 			if(deletePixMapAfterLoad == true) {
 				texture->deletePixels();
 			}
-
-			//if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] texture inited [%s]\n",__FUNCTION__,textureFile.c_str());
 		}
-		else {
-			if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s] #3 cannot load texture [%s] modelFile [%s]\n",__FUNCTION__,textureFile.c_str(),modelFile.c_str());
-			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error v4 model is missing texture [%s] textureFlags = %d meshIndex = %d textureIndex = %d modelFile [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,textureFile.c_str(),textureFlags,meshIndex,textureIndex,modelFile.c_str());
+	}
+	else if(texture != NULL) {
+		// every mesh using the texture keeps it alive
+		textureManager->addModelTextureReference(texture);
+		textureOwned = true;
+
+		if(loadedFileList && loadedFileList->find(textureFile) == loadedFileList->end()) {
+			// loaders running in parallel each have their own list, the
+			// first of them in load order keeps this when they are merged
+			(*loadedFileList)[textureFile].push_back(make_pair(sourceLoader,sourceLoader));
 		}
 	}
 
@@ -888,6 +1073,9 @@ void Mesh::load(int meshIndex, const string &dir, FILE *f, TextureManager *textu
 void Mesh::save(int meshIndex, const string &dir, FILE *f, TextureManager *textureManager,
 		string convertTextureToFormat, std::map<string,int> &textureDeleteList,
 		bool keepsmallest,string modelFile) {
+	if(hasBuiltVBOs == true) {
+		throw megaglest_runtime_error("Mesh [" + name + "] of [" + modelFile + "] can't be saved, its vertex data is in VBOs only");
+	}
 	MeshHeader meshHeader;
 	memset(&meshHeader, 0, sizeof(struct MeshHeader));
 
@@ -1447,12 +1635,18 @@ public:
 };
 
 void Mesh::setVertices(Vec3f *data, uint32 count) {
+	if(sharedData != NULL) {
+		throw megaglest_runtime_error("Mesh [" + name + "] shares its data with other models");
+	}
 	delete [] this->vertices;
 	this->vertices = data;
 
 	this->vertexCount = count;
 }
 void Mesh::setNormals(Vec3f *data, uint32 count) {
+	if(sharedData != NULL) {
+		throw megaglest_runtime_error("Mesh [" + name + "] shares its data with other models");
+	}
 	delete [] this->normals;
 	this->normals = data;
 
@@ -1460,6 +1654,9 @@ void Mesh::setNormals(Vec3f *data, uint32 count) {
 }
 
 void Mesh::setTexCoords(Vec2f *data, uint32 count) {
+	if(sharedData != NULL) {
+		throw megaglest_runtime_error("Mesh [" + name + "] shares its data with other models");
+	}
 	delete [] this->texCoords;
 	this->texCoords = data;
 
@@ -1467,6 +1664,9 @@ void Mesh::setTexCoords(Vec2f *data, uint32 count) {
 }
 
 void Mesh::setIndices(uint32 *data, uint32 count) {
+	if(sharedData != NULL) {
+		throw megaglest_runtime_error("Mesh [" + name + "] shares its data with other models");
+	}
 	delete [] this->indices;
 	this->indices = data;
 
@@ -1716,7 +1916,7 @@ void Model::autoJoinMeshFrames() {
 						base->setNormals(joined_normals, newVertexCount);
 
 						// If we have texture coords join them
-						if(base->getTextureFlags() & 1) {
+						if(base->getTexCoords() != NULL && mesh->getTexCoords() != NULL) {
 							Vec2f *joined_texCoords = new Vec2f[newVertexCount];
 
 							// update texture coord buffers with joined mesh data
@@ -15,6 +15,7 @@
 #include "graphics_factory.h"
 #include <cstdlib>
 #include <stdexcept>
+#include <algorithm>
 #include "util.h"
 #include "platform_util.h"
 #include "leak_dumper.h"
@@ -34,18 +35,117 @@ ModelManager::ModelManager(){
 	}
 
 	textureManager= NULL;
+	mutex= new Mutex(CODE_AT_LINE);
 }
 
 ModelManager::~ModelManager(){
 	end();
+	delete mutex;
+	mutex= NULL;
 }
 
 Model *ModelManager::newModel(const string &path,bool deletePixMapAfterLoad,std::map<string,vector<pair<string, string> > > *loadedFileList, string *sourceLoader){
-	Model *model= GraphicsInterface::getInstance().getFactory()->newModel(path,textureManager,deletePixMapAfterLoad,loadedFileList,sourceLoader);
+	MutexSafeWrapper safeMutex(mutex);
+	ModelReferenceMap::iterator iterMap = modelReferences.find(path);
+	if(iterMap != modelReferences.end()) {
+		ModelReference &reference = iterMap->second;
+		reference.referenceCount++;
+		addLoadedFiles(reference.files, path, loadedFileList, sourceLoader);
+		return reference.model;
+	}
+	safeMutex.ReleaseLock(true);
+
+	// the file is read outside the lock so models load in parallel
+	std::map<string,vector<pair<string, string> > > modelFiles;
+	Model *model= GraphicsInterface::getInstance().getFactory()->newModel(path,textureManager,deletePixMapAfterLoad,&modelFiles,sourceLoader);
+
+	vector<string> files;
+	for(std::map<string,vector<pair<string, string> > >::iterator iterFiles = modelFiles.begin();
+		iterFiles != modelFiles.end(); ++iterFiles) {
+		files.push_back(iterFiles->first);
+	}
+	vector<uint32> keys;
+	for(uint32 i = 0; i < model->getMeshCount(); ++i) {
+		keys.push_back(SharedMeshData::computeKey(model->getMesh(i)));
+	}
+
+	safeMutex.Lock();
+	shareMeshData(model, keys);
 	models.push_back(model);
+
+	// when another thread loaded the file meanwhile this model stays
+	// on its own, its textures may already be used by the other one
+	ModelReference &reference = modelReferences[path];
+	if(reference.model == NULL) {
+		reference.model = model;
+		reference.referenceCount = 1;
+		reference.files = files;
+	}
+	addLoadedFiles(files, path, loadedFileList, sourceLoader);
 	return model;
 }
 
+void ModelManager::addLoadedFiles(const vector<string> &files, const string &path,
+		std::map<string,vector<pair<string, string> > > *loadedFileList, string *sourceLoader) {
+	if(loadedFileList != NULL) {
+		string loader = (sourceLoader != NULL ? *sourceLoader : "");
+		for(unsigned int i = 0; i < files.size(); ++i) {
+			// like a load, textures are only listed for the first loader
+			if(files[i] == path || loadedFileList->find(files[i]) == loadedFileList->end()) {
+				(*loadedFileList)[files[i]].push_back(make_pair(loader,loader));
+			}
+		}
+	}
+}
+
+void ModelManager::shareMeshData(Model *model, const vector<uint32> &keys) {
+	for(uint32 i = 0; i < model->getMeshCount(); ++i) {
+		Mesh *mesh = model->getMeshPtr(i);
+
+		vector<SharedMeshData *> &sameKey = sharedMeshData[keys[i]];
+		SharedMeshData *data = NULL;
+		for(unsigned int j = 0; j < sameKey.size(); ++j) {
+			if(sameKey[j]->hasSameData(mesh) == true) {
+				data = sameKey[j];
+				break;
+			}
+		}
+		if(data == NULL) {
+			data = new SharedMeshData(mesh, keys[i], mutex);
+			sameKey.push_back(data);
+		}
+		mesh->shareData(data);
+	}
+}
+
+void ModelManager::releaseMeshData(Model *model) {
+	for(uint32 i = 0; i < model->getMeshCount(); ++i) {
+		Mesh *mesh = model->getMeshPtr(i);
+		const SharedMeshData *data = mesh->getSharedData();
+		if(data != NULL && data->getReferenceCount() == 1) {
+			SharedMeshDataMap::iterator iterMap = sharedMeshData.find(data->getKey());
+			if(iterMap != sharedMeshData.end()) {
+				vector<SharedMeshData *> &sameKey = iterMap->second;
+				sameKey.erase(std::remove(sameKey.begin(), sameKey.end(), data), sameKey.end());
+				if(sameKey.empty() == true) {
+					sharedMeshData.erase(iterMap);
+				}
+			}
+		}
+		mesh->releaseSharedData();
+	}
+}
+
+int ModelManager::getSharedMeshDataCount() const {
+	MutexSafeWrapper safeMutex(mutex);
+	int result = 0;
+	for(SharedMeshDataMap::const_iterator iterMap = sharedMeshData.begin();
+		iterMap != sharedMeshData.end(); ++iterMap) {
+		result += (int)iterMap->second.size();
+	}
+	return result;
+}
+
 void ModelManager::init(){
 	for(size_t i=0; i<models.size(); ++i){
 		if(models[i] != NULL) {
@@ -55,27 +155,43 @@ void ModelManager::init(){
 } 
 
 void ModelManager::end(){
+	MutexSafeWrapper safeMutex(mutex);
 	for(size_t i=0; i<models.size(); ++i){
 		if(models[i] != NULL) {
+			releaseMeshData(models[i]);
 			models[i]->end();
 			delete models[i];
 			models[i]=NULL;
 		}
 	}
 	models.clear();
+	modelReferences.clear();
+	sharedMeshData.clear();
 }
 
 void ModelManager::endModel(Model *model,bool mustExistInList) {
 	if(model != NULL) {
+		MutexSafeWrapper safeMutex(mutex);
+		ModelReferenceMap::iterator iterMap = modelReferences.find(model->getFileName());
+		if(iterMap != modelReferences.end() && iterMap->second.model == model) {
+			// others still use it
+			if(--iterMap->second.referenceCount > 0) {
+				return;
+			}
+			modelReferences.erase(iterMap);
+		}
+
 		bool found = false;
 		for(unsigned int idx = 0; idx < models.size(); idx++) {
 			Model *curModel = models[idx];
 			if(curModel == model) {
 				found = true;
 				models.erase(models.begin() + idx);
+				releaseMeshData(model);
 				break;
 			}
 		}
+		safeMutex.ReleaseLock();
 
 		if(found == false && mustExistInList == true) {
 			throw std::runtime_error("found == false in endModel");
@@ -87,17 +203,14 @@ void ModelManager::endModel(Model *model,bool mustExistInList) {
 }
 
 void ModelManager::endLastModel(bool mustExistInList) {
-	bool found = false;
-	if(models.size() > 0) {
-		found = true;
-		size_t index = models.size()-1;
-		Model *curModel = models[index];
-		models.erase(models.begin() + index);
-
-		curModel->end();
-		delete curModel;
+	MutexSafeWrapper safeMutex(mutex);
+	Model *model = (models.empty() == false ? models.back() : NULL);
+	safeMutex.ReleaseLock();
+
+	if(model != NULL) {
+		endModel(model,mustExistInList);
 	}
-	if(found == false && mustExistInList == true) {
+	else if(mustExistInList == true) {
 		throw std::runtime_error("found == false in endLastModel");
 	}
 }
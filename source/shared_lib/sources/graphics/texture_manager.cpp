@@ -36,12 +36,15 @@ TextureManager::TextureManager() {
 	}
 
 
+	mutex= new Mutex(CODE_AT_LINE);
 	textureFilter= Texture::fBilinear;
 	maxAnisotropy= 1;
 }
 
 TextureManager::~TextureManager(){
 	end();
+	delete mutex;
+	mutex= NULL;
 }
 
 void TextureManager::initTexture(Texture *texture) {
@@ -50,8 +53,28 @@ void TextureManager::initTexture(Texture *texture) {
 	}
 }
 
+void TextureManager::removeModelTexture(Texture *texture) {
+	for(std::map<string,Texture2D *>::iterator iterMap = modelTextures.begin();
+		iterMap != modelTextures.end(); ++iterMap) {
+		if(iterMap->second == texture) {
+			modelTextures.erase(iterMap);
+			break;
+		}
+	}
+}
+
 void TextureManager::endTexture(Texture *texture,bool mustExistInList) {
 	if(texture != NULL) {
+		MutexSafeWrapper safeMutex(mutex);
+		std::map<const Texture *,int>::iterator iterReferences = modelTextureReferences.find(texture);
+		if(iterReferences != modelTextureReferences.end()) {
+			// other meshes still use it
+			if(--iterReferences->second > 0) {
+				return;
+			}
+			modelTextureReferences.erase(iterReferences);
+		}
+		removeModelTexture(texture);
 		bool found = false;
 		for(unsigned int idx = 0; idx < textures.size(); idx++) {
 			Texture *curTexture = textures[idx];
@@ -61,6 +84,7 @@ void TextureManager::endTexture(Texture *texture,bool mustExistInList) {
 				break;
 			}
 		}
+		safeMutex.ReleaseLock();
 		if(found == false && mustExistInList == true) {
 			throw std::runtime_error("found == false in endTexture");
 		}
@@ -71,11 +95,15 @@ void TextureManager::endTexture(Texture *texture,bool mustExistInList) {
 
 void TextureManager::endLastTexture(bool mustExistInList) {
 	bool found = false;
+	MutexSafeWrapper safeMutex(mutex);
 	if(textures.size() > 0) {
 		found = true;
 		int index = (int)textures.size()-1;
 		Texture *curTexture = textures[index];
 		textures.erase(textures.begin() + index);
+		modelTextureReferences.erase(curTexture);
+		removeModelTexture(curTexture);
+		safeMutex.ReleaseLock();
 
 		curTexture->end();
 		delete curTexture;
@@ -102,6 +130,8 @@ void TextureManager::init(bool forceInit) {
 }
 
 void TextureManager::end(){
+	modelTextures.clear();
+	modelTextureReferences.clear();
 	for(unsigned int i=0; i<textures.size(); ++i){
 		if(textures[i] != NULL) {
 			textures[i]->end();
@@ -120,6 +150,12 @@ void TextureManager::setMaxAnisotropy(int maxAnisotropy){
 }
 
 Texture *TextureManager::getTexture(const string &path){
+	MutexSafeWrapper safeMutex(mutex);
+	std::map<string,Texture2D *>::iterator iterMap = modelTextures.find(path);
+	if(iterMap != modelTextures.end()) {
+		return iterMap->second;
+	}
+	// other textures only know their file once they are loaded
 	for(unsigned int i=0; i<textures.size(); ++i){
 		if(textures[i]->getPath()==path){
 			return textures[i];
@@ -128,8 +164,40 @@ Texture *TextureManager::getTexture(const string &path){
 	return NULL;
 }
 
+Texture2D *TextureManager::findModelTexture(const string &path) {
+	MutexSafeWrapper safeMutex(mutex);
+	std::map<string,Texture2D *>::iterator iterMap = modelTextures.find(path);
+	return (iterMap != modelTextures.end() ? iterMap->second : NULL);
+}
+
+Texture2D *TextureManager::getModelTexture(const string &path, bool &created) {
+	MutexSafeWrapper safeMutex(mutex);
+	created = false;
+	std::map<string,Texture2D *>::iterator iterMap = modelTextures.find(path);
+	if(iterMap != modelTextures.end()) {
+		return iterMap->second;
+	}
+
+	// known by its file before it is loaded, so nobody else loads it
+	Texture2D *texture2D= GraphicsInterface::getInstance().getFactory()->newTexture2D();
+	textures.push_back(texture2D);
+	modelTextures[path]= texture2D;
+	modelTextureReferences[texture2D]= 1;
+	created = true;
+	return texture2D;
+}
+
+void TextureManager::addModelTextureReference(Texture2D *texture) {
+	MutexSafeWrapper safeMutex(mutex);
+	std::map<const Texture *,int>::iterator iterReferences = modelTextureReferences.find(texture);
+	if(iterReferences != modelTextureReferences.end()) {
+		iterReferences->second++;
+	}
+}
+
 Texture1D *TextureManager::newTexture1D(){
 	Texture1D *texture1D= GraphicsInterface::getInstance().getFactory()->newTexture1D();
+	MutexSafeWrapper safeMutex(mutex);
 	textures.push_back(texture1D);
 
 	return texture1D;
@@ -137,6 +205,7 @@ Texture1D *TextureManager::newTexture1D(){
 
 Texture2D *TextureManager::newTexture2D(){
 	Texture2D *texture2D= GraphicsInterface::getInstance().getFactory()->newTexture2D();
+	MutexSafeWrapper safeMutex(mutex);
 	textures.push_back(texture2D);
 
 	return texture2D;
@@ -144,6 +213,7 @@ Texture2D *TextureManager::newTexture2D(){
 
 Texture3D *TextureManager::newTexture3D(){
 	Texture3D *texture3D= GraphicsInterface::getInstance().getFactory()->newTexture3D();
+	MutexSafeWrapper safeMutex(mutex);
 	textures.push_back(texture3D);
 
 	return texture3D;
@@ -152,6 +222,7 @@ Texture3D *TextureManager::newTexture3D(){
 
 TextureCube *TextureManager::newTextureCube(){
 	TextureCube *textureCube= GraphicsInterface::getInstance().getFactory()->newTextureCube();
+	MutexSafeWrapper safeMutex(mutex);
 	textures.push_back(textureCube);
 
 	return textureCube;
@@ -0,0 +1,73 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "cell_move_cache.h"
+#include "leak_dumper.h"
+
+namespace Shared { namespace Map {
+
+// =====================================================
+//	class CellMoveCache
+// =====================================================
+
+CellMoveCache::CellMoveCache() {
+	width = 0;
+	height = 0;
+	epoch = 1;
+}
+
+CellMoveCache::~CellMoveCache() {
+	clear();
+}
+
+void CellMoveCache::init(int width, int height, int layerCount) {
+	clear();
+	this->width = width;
+	this->height = height;
+	layers.assign(layerCount, (Layer *)NULL);
+}
+
+void CellMoveCache::clear() {
+	for(unsigned int i = 0; i < layers.size(); ++i) {
+		delete layers[i];
+	}
+	layers.clear();
+	width = 0;
+	height = 0;
+	epoch++;
+}
+
+CellMoveCache::Layer *CellMoveCache::createLayer(int layerIndex) {
+	Layer *layer = new Layer();
+	layer->epoch = 0;
+	layer->generation = 0;
+	Entry empty;
+	empty.stamp = 0;
+	empty.known = 0;
+	empty.values = 0;
+	layer->entries.assign(width * height, empty);
+	layers[layerIndex] = layer;
+	return layer;
+}
+
+void CellMoveCache::resetLayer(Layer *layer) {
+	layer->epoch = epoch;
+	layer->generation++;
+	// stamps are only 16 bits wide, wipe them when the generation wraps
+	if(layer->generation == 0) {
+		for(unsigned int i = 0; i < layer->entries.size(); ++i) {
+			layer->entries[i].stamp = 0;
+		}
+		layer->generation = 1;
+	}
+}
+
+}}//end namespace
@@ -0,0 +1,551 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "cluster_graph.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include "binary_heap.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+using namespace std;
+
+namespace Shared { namespace Map {
+
+// Border runs at least this long get a portal at each end instead of one in the middle
+static const int splitEntranceLength = 6;
+
+// ===============================================
+//	class ClusterGraphSearch
+// ===============================================
+
+ClusterGraphSearch::ClusterGraphSearch() {
+	nodeGeneration = 0;
+	cellGeneration = 0;
+}
+
+void ClusterGraphSearch::beginNodeSearch(int nodeSlots) {
+	if((int)nodeStamps.size() != nodeSlots) {
+		nodeStamps.assign(nodeSlots, 0);
+		closedStamps.assign(nodeSlots, 0);
+		nodeCosts.assign(nodeSlots, 0);
+		nodeParents.assign(nodeSlots, -1);
+		nodeGeneration = 0;
+	}
+	nodeGeneration++;
+	if(nodeGeneration == 0) {
+		std::fill(nodeStamps.begin(), nodeStamps.end(), 0);
+		std::fill(closedStamps.begin(), closedStamps.end(), 0);
+		nodeGeneration = 1;
+	}
+}
+
+void ClusterGraphSearch::beginCellSearch(int cellSlots) {
+	if((int)cellStamps.size() < cellSlots) {
+		cellStamps.assign(cellSlots, 0);
+		cellCosts.assign(cellSlots, 0);
+		cellGeneration = 0;
+	}
+	cellGeneration++;
+	if(cellGeneration == 0) {
+		std::fill(cellStamps.begin(), cellStamps.end(), 0);
+		cellGeneration = 1;
+	}
+}
+
+// ===============================================
+//	class ClusterGraph
+// ===============================================
+
+ClusterGraph::ClusterGraph() {
+	passability = NULL;
+	width = 0;
+	height = 0;
+	clusterSize = defaultClusterSize;
+	clustersW = 0;
+	clustersH = 0;
+	anyDirty = false;
+	nodeCount = 0;
+}
+
+void ClusterGraph::init(int width, int height, const ClusterGraphPassability *passability, int clusterSize) {
+	if(passability == NULL) {
+		throw runtime_error("ClusterGraph::init passability == NULL");
+	}
+	if(clusterSize < 2) {
+		throw runtime_error("ClusterGraph::init clusterSize < 2");
+	}
+
+	clear();
+
+	this->passability = passability;
+	this->width = width;
+	this->height = height;
+	this->clusterSize = clusterSize;
+	this->clustersW = (width + clusterSize - 1) / clusterSize;
+	this->clustersH = (height + clusterSize - 1) / clusterSize;
+
+	int totalClusters = clustersW * clustersH;
+	clusters.resize(totalClusters);
+	eastEntrances.resize(totalClusters);
+	southEntrances.resize(totalClusters);
+	nodeOffsets.resize(totalClusters, 0);
+
+	setAllDirty();
+}
+
+void ClusterGraph::clear() {
+	passability = NULL;
+	width = 0;
+	height = 0;
+	clustersW = 0;
+	clustersH = 0;
+	clusters.clear();
+	eastEntrances.clear();
+	southEntrances.clear();
+	dirtyClusters.clear();
+	anyDirty = false;
+	nodeOffsets.clear();
+	nodeClusters.clear();
+	nodeCount = 0;
+	ownSearch = ClusterGraphSearch();
+}
+
+void ClusterGraph::setDirty(int x, int y, int size) {
+	if(clustersW <= 0 || clustersH <= 0) {
+		return;
+	}
+	int minCX = max(0, x / clusterSize);
+	int minCY = max(0, y / clusterSize);
+	int maxCX = min(clustersW - 1, (x + size - 1) / clusterSize);
+	int maxCY = min(clustersH - 1, (y + size - 1) / clusterSize);
+	for(int cy = minCY; cy <= maxCY; ++cy) {
+		for(int cx = minCX; cx <= maxCX; ++cx) {
+			dirtyClusters[clusterIndex(cx, cy)] = 1;
+			anyDirty = true;
+		}
+	}
+}
+
+void ClusterGraph::setAllDirty() {
+	dirtyClusters.assign(clustersW * clustersH, 1);
+	anyDirty = (dirtyClusters.empty() == false);
+}
+
+bool ClusterGraph::isSameCluster(const Vec2i &a, const Vec2i &b) const {
+	return (a.x / clusterSize == b.x / clusterSize) && (a.y / clusterSize == b.y / clusterSize);
+}
+
+void ClusterGraph::getClusterBounds(int index, Vec2i &origin, Vec2i &end) const {
+	origin = Vec2i((index % clustersW) * clusterSize, (index / clustersW) * clusterSize);
+	end = Vec2i(min(origin.x + clusterSize, width), min(origin.y + clusterSize, height));
+}
+
+int ClusterGraph::octileDistance(const Vec2i &a, const Vec2i &b) {
+	int dx = abs(a.x - b.x);
+	int dy = abs(a.y - b.y);
+	return straightCost * (dx + dy) + (diagonalCost - 2 * straightCost) * min(dx, dy);
+}
+
+bool ClusterGraph::canStep(const Vec2i &from, const Vec2i &to) const {
+	if(passability->isPassable(to.x, to.y) == false) {
+		return false;
+	}
+	// same corner rule as Map::aproxCanMove, no cutting diagonally past a blocked cell
+	if(from.x != to.x && from.y != to.y) {
+		if(passability->isPassable(from.x, to.y) == false ||
+		   passability->isPassable(to.x, from.y) == false) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void ClusterGraph::buildBorder(int cx, int cy, bool east) {
+	int index = clusterIndex(cx, cy);
+	vector<Entrance> &entrances = (east ? eastEntrances[index] : southEntrances[index]);
+	entrances.clear();
+
+	if((east == true && cx + 1 >= clustersW) || (east == false && cy + 1 >= clustersH)) {
+		return;
+	}
+
+	Vec2i origin, end;
+	getClusterBounds(index, origin, end);
+
+	// walk along the border, side A is inside this cluster and side B is in the neighbour
+	int borderLength = (east ? end.y - origin.y : end.x - origin.x);
+	int runStart = -1;
+	for(int i = 0; i <= borderLength; ++i) {
+		bool open = false;
+		Vec2i sideA, sideB;
+		if(i < borderLength) {
+			if(east == true) {
+				sideA = Vec2i(end.x - 1, origin.y + i);
+				sideB = Vec2i(end.x, origin.y + i);
+			}
+			else {
+				sideA = Vec2i(origin.x + i, end.y - 1);
+				sideB = Vec2i(origin.x + i, end.y);
+			}
+			open = passability->isPassable(sideA.x, sideA.y) &&
+				   passability->isPassable(sideB.x, sideB.y);
+		}
+
+		if(open == true && runStart < 0) {
+			runStart = i;
+		}
+		else if(open == false && runStart >= 0) {
+			int runLength = i - runStart;
+			vector<int> offsets;
+			if(runLength < splitEntranceLength) {
+				offsets.push_back(runStart + runLength / 2);
+			}
+			else {
+				offsets.push_back(runStart);
+				offsets.push_back(i - 1);
+			}
+			for(unsigned int j = 0; j < (unsigned int)offsets.size(); ++j) {
+				Entrance entrance;
+				if(east == true) {
+					entrance.inside = Vec2i(end.x - 1, origin.y + offsets[j]);
+					entrance.outside = Vec2i(end.x, origin.y + offsets[j]);
+				}
+				else {
+					entrance.inside = Vec2i(origin.x + offsets[j], end.y - 1);
+					entrance.outside = Vec2i(origin.x + offsets[j], end.y);
+				}
+				entrances.push_back(entrance);
+			}
+			runStart = -1;
+		}
+	}
+}
+
+void ClusterGraph::buildClusterNodes(int index) {
+	Cluster &cluster = clusters[index];
+	cluster.nodes.clear();
+	cluster.peers.clear();
+
+	int cx = index % clustersW;
+	int cy = index / clustersW;
+
+	// gather portals in a fixed order (east, south, west, north) so rebuilds are deterministic
+	vector<pair<Vec2i,Vec2i> > portals;
+	for(unsigned int i = 0; i < (unsigned int)eastEntrances[index].size(); ++i) {
+		portals.push_back(make_pair(eastEntrances[index][i].inside,eastEntrances[index][i].outside));
+	}
+	for(unsigned int i = 0; i < (unsigned int)southEntrances[index].size(); ++i) {
+		portals.push_back(make_pair(southEntrances[index][i].inside,southEntrances[index][i].outside));
+	}
+	if(cx > 0) {
+		const vector<Entrance> &west = eastEntrances[clusterIndex(cx - 1, cy)];
+		for(unsigned int i = 0; i < (unsigned int)west.size(); ++i) {
+			portals.push_back(make_pair(west[i].outside,west[i].inside));
+		}
+	}
+	if(cy > 0) {
+		const vector<Entrance> &north = southEntrances[clusterIndex(cx, cy - 1)];
+		for(unsigned int i = 0; i < (unsigned int)north.size(); ++i) {
+			portals.push_back(make_pair(north[i].outside,north[i].inside));
+		}
+	}
+
+	for(unsigned int i = 0; i < (unsigned int)portals.size(); ++i) {
+		int localIndex = findLocalNode(index, portals[i].first);
+		if(localIndex < 0) {
+			cluster.nodes.push_back(portals[i].first);
+			cluster.peers.push_back(vector<Vec2i>());
+			localIndex = (int)cluster.nodes.size() - 1;
+		}
+		cluster.peers[localIndex].push_back(portals[i].second);
+	}
+}
+
+int ClusterGraph::findLocalNode(int index, const Vec2i &pos) const {
+	const vector<Vec2i> &nodes = clusters[index].nodes;
+	for(unsigned int i = 0; i < (unsigned int)nodes.size(); ++i) {
+		if(nodes[i] == pos) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void ClusterGraph::clusterDistancesFrom(ClusterGraphSearch &search, int index, const Vec2i &from, vector<int> &result) const {
+	const Cluster &cluster = clusters[index];
+	result.assign(cluster.nodes.size(), -1);
+
+	Vec2i origin, end;
+	getClusterBounds(index, origin, end);
+
+	search.beginCellSearch(clusterSize * clusterSize);
+	vector<uint32> &cellStamps = search.cellStamps;
+	vector<int> &cellCosts = search.cellCosts;
+	const uint32 cellGeneration = search.cellGeneration;
+
+	BinaryHeap<int,int> open;
+	int startCell = (from.y - origin.y) * clusterSize + (from.x - origin.x);
+	cellStamps[startCell] = cellGeneration;
+	cellCosts[startCell] = 0;
+	open.push(0, startCell);
+
+	while(open.empty() == false) {
+		int cost = open.topKey();
+		int cell = open.pop();
+		if(cost != cellCosts[cell]) {
+			continue;
+		}
+		Vec2i pos(origin.x + cell % clusterSize, origin.y + cell / clusterSize);
+		for(int i = -1; i <= 1; ++i) {
+			for(int j = -1; j <= 1; ++j) {
+				if(i == 0 && j == 0) {
+					continue;
+				}
+				Vec2i sucPos = pos + Vec2i(i, j);
+				if(sucPos.x < origin.x || sucPos.y < origin.y || sucPos.x >= end.x || sucPos.y >= end.y) {
+					continue;
+				}
+				if(canStep(pos, sucPos) == false) {
+					continue;
+				}
+				int sucCost = cost + (i != 0 && j != 0 ? diagonalCost : straightCost);
+				int sucCell = (sucPos.y - origin.y) * clusterSize + (sucPos.x - origin.x);
+				if(cellStamps[sucCell] != cellGeneration || sucCost < cellCosts[sucCell]) {
+					cellStamps[sucCell] = cellGeneration;
+					cellCosts[sucCell] = sucCost;
+					open.push(sucCost, sucCell);
+				}
+			}
+		}
+	}
+
+	for(unsigned int i = 0; i < (unsigned int)cluster.nodes.size(); ++i) {
+		int cell = (cluster.nodes[i].y - origin.y) * clusterSize + (cluster.nodes[i].x - origin.x);
+		if(cellStamps[cell] == cellGeneration) {
+			result[i] = cellCosts[cell];
+		}
+	}
+}
+
+void ClusterGraph::buildClusterDistances(int index) {
+	Cluster &cluster = clusters[index];
+	int count = (int)cluster.nodes.size();
+	cluster.distances.assign(count * count, -1);
+
+	vector<int> row;
+	for(int i = 0; i < count; ++i) {
+		clusterDistancesFrom(ownSearch, index, cluster.nodes[i], row);
+		for(int j = 0; j < count; ++j) {
+			cluster.distances[i * count + j] = row[j];
+		}
+	}
+}
+
+void ClusterGraph::computeNodeOffsets() {
+	nodeCount = 0;
+	nodeClusters.clear();
+	for(unsigned int i = 0; i < (unsigned int)clusters.size(); ++i) {
+		nodeOffsets[i] = nodeCount;
+		nodeCount += (int)clusters[i].nodes.size();
+		nodeClusters.resize(nodeCount, i);
+	}
+}
+
+void ClusterGraph::update() {
+	if(anyDirty == false || passability == NULL) {
+		return;
+	}
+
+	// a dirty cluster invalidates the four borders it shares with its
+	// neighbours and the portal nodes of every cluster on those borders
+	vector<char> eastDirty(clusters.size(), 0);
+	vector<char> southDirty(clusters.size(), 0);
+	vector<char> nodesDirty(clusters.size(), 0);
+	for(int cy = 0; cy < clustersH; ++cy) {
+		for(int cx = 0; cx < clustersW; ++cx) {
+			int index = clusterIndex(cx, cy);
+			if(dirtyClusters[index] == 0) {
+				continue;
+			}
+			eastDirty[index] = 1;
+			southDirty[index] = 1;
+			nodesDirty[index] = 1;
+			if(cx > 0) {
+				eastDirty[clusterIndex(cx - 1, cy)] = 1;
+				nodesDirty[clusterIndex(cx - 1, cy)] = 1;
+			}
+			if(cy > 0) {
+				southDirty[clusterIndex(cx, cy - 1)] = 1;
+				nodesDirty[clusterIndex(cx, cy - 1)] = 1;
+			}
+			if(cx + 1 < clustersW) {
+				nodesDirty[clusterIndex(cx + 1, cy)] = 1;
+			}
+			if(cy + 1 < clustersH) {
+				nodesDirty[clusterIndex(cx, cy + 1)] = 1;
+			}
+		}
+	}
+
+	for(int cy = 0; cy < clustersH; ++cy) {
+		for(int cx = 0; cx < clustersW; ++cx) {
+			int index = clusterIndex(cx, cy);
+			if(eastDirty[index] != 0) {
+				buildBorder(cx, cy, true);
+			}
+			if(southDirty[index] != 0) {
+				buildBorder(cx, cy, false);
+			}
+		}
+	}
+
+	for(unsigned int index = 0; index < (unsigned int)clusters.size(); ++index) {
+		if(nodesDirty[index] != 0) {
+			buildClusterNodes(index);
+			buildClusterDistances(index);
+		}
+	}
+
+	computeNodeOffsets();
+	std::fill(dirtyClusters.begin(), dirtyClusters.end(), 0);
+	anyDirty = false;
+}
+
+bool ClusterGraph::findPath(const Vec2i &from, const Vec2i &to, vector<Vec2i> &waypoints, int *expandedNodes) {
+	update();
+	return findPath(ownSearch, from, to, waypoints, expandedNodes);
+}
+
+bool ClusterGraph::findPath(ClusterGraphSearch &search, const Vec2i &from, const Vec2i &to,
+							vector<Vec2i> &waypoints, int *expandedNodes) const {
+	waypoints.clear();
+	if(expandedNodes != NULL) {
+		*expandedNodes = 0;
+	}
+	if(passability == NULL || anyDirty == true ||
+		from.x < 0 || from.y < 0 || from.x >= width || from.y >= height ||
+		to.x < 0 || to.y < 0 || to.x >= width || to.y >= height) {
+		return false;
+	}
+
+	if(isSameCluster(from, to) == true) {
+		waypoints.push_back(to);
+		return true;
+	}
+
+	int startCluster = clusterIndexForPos(from);
+	int goalCluster = clusterIndexForPos(to);
+	vector<int> startDistances;
+	vector<int> goalDistances;
+	clusterDistancesFrom(search, startCluster, from, startDistances);
+	clusterDistancesFrom(search, goalCluster, to, goalDistances);
+
+	search.beginNodeSearch(nodeCount + 1);
+	vector<uint32> &searchStamps = search.nodeStamps;
+	vector<uint32> &closedStamps = search.closedStamps;
+	vector<int> &searchCosts = search.nodeCosts;
+	vector<int> &searchParents = search.nodeParents;
+	const uint32 searchGeneration = search.nodeGeneration;
+
+	const int goalId = nodeCount;
+	BinaryHeap<int,int> open;
+
+	for(unsigned int i = 0; i < (unsigned int)startDistances.size(); ++i) {
+		if(startDistances[i] < 0) {
+			continue;
+		}
+		int id = nodeOffsets[startCluster] + i;
+		searchStamps[id] = searchGeneration;
+		searchCosts[id] = startDistances[i];
+		searchParents[id] = -1;
+		open.push(startDistances[i] + octileDistance(clusters[startCluster].nodes[i], to), id);
+	}
+
+	int expanded = 0;
+	bool found = false;
+	while(open.empty() == false) {
+		int id = open.pop();
+		if(closedStamps[id] == searchGeneration) {
+			continue;
+		}
+		closedStamps[id] = searchGeneration;
+		if(id == goalId) {
+			found = true;
+			break;
+		}
+		expanded++;
+
+		int index = nodeClusters[id];
+		int localIndex = id - nodeOffsets[index];
+		const Cluster &cluster = clusters[index];
+		const Vec2i &pos = cluster.nodes[localIndex];
+		const int cost = searchCosts[id];
+		const int count = (int)cluster.nodes.size();
+
+		// candidate successors as (id, cost)
+		vector<pair<int,int> > successors;
+		for(int j = 0; j < count; ++j) {
+			int distance = cluster.distances[localIndex * count + j];
+			if(j != localIndex && distance >= 0) {
+				successors.push_back(make_pair(nodeOffsets[index] + j, cost + distance));
+			}
+		}
+		const vector<Vec2i> &peers = cluster.peers[localIndex];
+		for(unsigned int j = 0; j < (unsigned int)peers.size(); ++j) {
+			int peerCluster = clusterIndexForPos(peers[j]);
+			int peerLocal = findLocalNode(peerCluster, peers[j]);
+			if(peerLocal >= 0) {
+				successors.push_back(make_pair(nodeOffsets[peerCluster] + peerLocal, cost + straightCost));
+			}
+		}
+		if(index == goalCluster && goalDistances[localIndex] >= 0) {
+			successors.push_back(make_pair(goalId, cost + goalDistances[localIndex]));
+		}
+
+		for(unsigned int j = 0; j < (unsigned int)successors.size(); ++j) {
+			int sucId = successors[j].first;
+			int sucCost = successors[j].second;
+			if(closedStamps[sucId] == searchGeneration) {
+				continue;
+			}
+			if(searchStamps[sucId] != searchGeneration || sucCost < searchCosts[sucId]) {
+				searchStamps[sucId] = searchGeneration;
+				searchCosts[sucId] = sucCost;
+				searchParents[sucId] = id;
+				int estimate = 0;
+				if(sucId != goalId) {
+					int sucIndex = nodeClusters[sucId];
+					estimate = octileDistance(clusters[sucIndex].nodes[sucId - nodeOffsets[sucIndex]], to);
+				}
+				open.push(sucCost + estimate, sucId);
+			}
+		}
+	}
+
+	if(expandedNodes != NULL) {
+		*expandedNodes = expanded;
+	}
+	if(found == false) {
+		return false;
+	}
+
+	for(int id = searchParents[goalId]; id >= 0; id = searchParents[id]) {
+		int index = nodeClusters[id];
+		waypoints.push_back(clusters[index].nodes[id - nodeOffsets[index]]);
+	}
+	std::reverse(waypoints.begin(), waypoints.end());
+	waypoints.push_back(to);
+	return true;
+}
+
+}}//end namespace
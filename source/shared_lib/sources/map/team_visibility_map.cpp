@@ -0,0 +1,272 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "team_visibility_map.h"
+#include "conversion.h"
+#include <stdlib.h>
+#include "leak_dumper.h"
+
+using Shared::Util::intToStr;
+
+namespace Shared { namespace Map {
+
+static int countBits(uint32 value) {
+	value = value - ((value >> 1) & 0x55555555u);
+	value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+	return (int)((((value + (value >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+}
+
+static void appendRun(std::string &runs, int runLength) {
+	if(runs.empty() == false) {
+		runs += ",";
+	}
+	runs += intToStr(runLength);
+}
+
+// =====================================================
+//	class TeamVisibilityMap
+// =====================================================
+
+TeamVisibilityMap::TeamVisibilityMap() {
+	width = 0;
+	height = 0;
+	teamCount = 0;
+	wordsPerRow = 0;
+}
+
+TeamVisibilityMap::~TeamVisibilityMap() {
+	clear();
+}
+
+void TeamVisibilityMap::init(int width, int height, int teamCount) {
+	clear();
+	this->width = width;
+	this->height = height;
+	this->teamCount = teamCount;
+	this->wordsPerRow = (width + 31) / 32;
+
+	stampCounts.assign(teamCount * width * height, 0);
+	visibleBits.assign(teamCount * height * wordsPerRow, 0);
+	exploredBits.assign(teamCount * height * wordsPerRow, 0);
+	revealedTeams.assign(teamCount, false);
+}
+
+void TeamVisibilityMap::clear() {
+	stampCounts.clear();
+	visibleBits.clear();
+	exploredBits.clear();
+	revealedTeams.clear();
+	width = 0;
+	height = 0;
+	teamCount = 0;
+	wordsPerRow = 0;
+}
+
+const std::vector<int> &TeamVisibilityMap::getCircleSpans(int radius) {
+	if(radius >= (int)circleSpans.size()) {
+		circleSpans.resize(radius + 1);
+	}
+	std::vector<int> &spans = circleSpans[radius];
+	if(spans.empty() == true && radius > 0) {
+		// same shape as testing Vec2i(dx, dy).length() < radius
+		spans.resize(radius);
+		int halfWidth = radius - 1;
+		for(int dy = 0; dy < radius; ++dy) {
+			for(;halfWidth > 0 && halfWidth * halfWidth + dy * dy >= radius * radius; --halfWidth) {
+			}
+			spans[dy] = halfWidth;
+		}
+	}
+	return spans;
+}
+
+void TeamVisibilityMap::setExplored(int teamIndex, int x, int y, bool value) {
+	uint32 &word = exploredBits[getWordIndex(teamIndex, x, y)];
+	if(value == true) {
+		word |= (1u << (x & 31));
+	}
+	else {
+		word &= ~(1u << (x & 31));
+	}
+}
+
+void TeamVisibilityMap::setAllExplored(int teamIndex, bool value) {
+	// bits past the row end stay clear so the cell counts remain exact
+	uint32 tailMask = ((width & 31) == 0 ? 0xFFFFFFFFu : (1u << (width & 31)) - 1);
+	for(int y = 0; y < height; ++y) {
+		uint32 *row = &exploredBits[getWordIndex(teamIndex, 0, y)];
+		for(int word = 0; word < wordsPerRow; ++word) {
+			row[word] = (value == true ? 0xFFFFFFFFu : 0);
+		}
+		row[wordsPerRow - 1] &= tailMask;
+	}
+}
+
+void TeamVisibilityMap::setRevealed(int teamIndex, bool value) {
+	revealedTeams[teamIndex] = value;
+}
+
+std::string TeamVisibilityMap::getExploredRuns(int teamIndex) const {
+	std::string runs;
+	bool runValue = false;
+	int runLength = 0;
+	for(int y = 0; y < height; ++y) {
+		const uint32 *row = &exploredBits[getWordIndex(teamIndex, 0, y)];
+		for(int x = 0; x < width; x += 32) {
+			int wordBits = (width - x < 32 ? width - x : 32);
+			uint32 mask = (wordBits == 32 ? 0xFFFFFFFFu : (1u << wordBits) - 1);
+			uint32 word = row[x >> 5] & mask;
+
+			// whole words continuing the current run are skipped at once
+			if(word == (runValue == true ? mask : 0)) {
+				runLength += wordBits;
+				continue;
+			}
+			for(int bit = 0; bit < wordBits; ++bit) {
+				bool value = ((word >> bit) & 1) != 0;
+				if(value != runValue) {
+					appendRun(runs, runLength);
+					runValue = value;
+					runLength = 0;
+				}
+				runLength++;
+			}
+		}
+	}
+	appendRun(runs, runLength);
+	return runs;
+}
+
+void TeamVisibilityMap::setExploredRuns(int teamIndex, const std::string &runs) {
+	setAllExplored(teamIndex, false);
+
+	const int cellCount = width * height;
+	const char *cursor = runs.c_str();
+	bool runValue = false;
+	int cellIndex = 0;
+	while(*cursor != '\0' && cellIndex < cellCount) {
+		char *runEnd = NULL;
+		int runLength = (int)strtol(cursor, &runEnd, 10);
+		if(runEnd == cursor || runLength < 0) {
+			break;
+		}
+		if(runLength > cellCount - cellIndex) {
+			runLength = cellCount - cellIndex;
+		}
+		if(runValue == true) {
+			for(int index = cellIndex; index < cellIndex + runLength; ++index) {
+				setExplored(teamIndex, index % width, index / width, true);
+			}
+		}
+		cellIndex += runLength;
+		runValue = !runValue;
+
+		cursor = (*runEnd == ',' ? runEnd + 1 : runEnd);
+	}
+}
+
+void TeamVisibilityMap::addStamp(int teamIndex, const Vec2i &center, int visibleRadius,
+									int exploredRadius, std::vector<int> *changedCells) {
+	if(teamIndex < 0 || teamIndex >= teamCount) {
+		return;
+	}
+
+	const std::vector<int> &exploredSpans = getCircleSpans(exploredRadius);
+	for(int dy = 1 - exploredRadius; dy < exploredRadius; ++dy) {
+		int y = center.y + dy;
+		if(y < 0 || y >= height) {
+			continue;
+		}
+		int halfWidth = exploredSpans[dy < 0 ? -dy : dy];
+		int xStart = (center.x - halfWidth < 0 ? 0 : center.x - halfWidth);
+		int xEnd = (center.x + halfWidth >= width ? width - 1 : center.x + halfWidth);
+		for(int x = xStart; x <= xEnd; ++x) {
+			uint32 &word = exploredBits[getWordIndex(teamIndex, x, y)];
+			uint32 bit = (1u << (x & 31));
+			if((word & bit) == 0) {
+				word |= bit;
+				if(changedCells != NULL) {
+					changedCells->push_back(y * width + x);
+				}
+			}
+		}
+	}
+
+	const std::vector<int> &visibleSpans = getCircleSpans(visibleRadius);
+	for(int dy = 1 - visibleRadius; dy < visibleRadius; ++dy) {
+		int y = center.y + dy;
+		if(y < 0 || y >= height) {
+			continue;
+		}
+		int halfWidth = visibleSpans[dy < 0 ? -dy : dy];
+		int xStart = (center.x - halfWidth < 0 ? 0 : center.x - halfWidth);
+		int xEnd = (center.x + halfWidth >= width ? width - 1 : center.x + halfWidth);
+		uint16 *counts = &stampCounts[getCountIndex(teamIndex, 0, y)];
+		for(int x = xStart; x <= xEnd; ++x) {
+			if(counts[x]++ == 0) {
+				visibleBits[getWordIndex(teamIndex, x, y)] |= (1u << (x & 31));
+				if(changedCells != NULL) {
+					changedCells->push_back(y * width + x);
+				}
+			}
+		}
+	}
+}
+
+void TeamVisibilityMap::removeStamp(int teamIndex, const Vec2i &center, int visibleRadius,
+									std::vector<int> *changedCells) {
+	if(teamIndex < 0 || teamIndex >= teamCount) {
+		return;
+	}
+
+	const std::vector<int> &visibleSpans = getCircleSpans(visibleRadius);
+	for(int dy = 1 - visibleRadius; dy < visibleRadius; ++dy) {
+		int y = center.y + dy;
+		if(y < 0 || y >= height) {
+			continue;
+		}
+		int halfWidth = visibleSpans[dy < 0 ? -dy : dy];
+		int xStart = (center.x - halfWidth < 0 ? 0 : center.x - halfWidth);
+		int xEnd = (center.x + halfWidth >= width ? width - 1 : center.x + halfWidth);
+		uint16 *counts = &stampCounts[getCountIndex(teamIndex, 0, y)];
+		for(int x = xStart; x <= xEnd; ++x) {
+			if(counts[x] > 0 && --counts[x] == 0) {
+				visibleBits[getWordIndex(teamIndex, x, y)] &= ~(1u << (x & 31));
+				if(changedCells != NULL) {
+					changedCells->push_back(y * width + x);
+				}
+			}
+		}
+	}
+}
+
+int TeamVisibilityMap::getVisibleCellCount(int teamIndex) const {
+	if(revealedTeams[teamIndex] == true) {
+		return width * height;
+	}
+	int result = 0;
+	int first = getWordIndex(teamIndex, 0, 0);
+	for(int index = first; index < first + height * wordsPerRow; ++index) {
+		result += countBits(visibleBits[index]);
+	}
+	return result;
+}
+
+int TeamVisibilityMap::getExploredCellCount(int teamIndex) const {
+	int result = 0;
+	int first = getWordIndex(teamIndex, 0, 0);
+	for(int index = first; index < first + height * wordsPerRow; ++index) {
+		result += countBits(exploredBits[index]);
+	}
+	return result;
+}
+
+}}//end namespace
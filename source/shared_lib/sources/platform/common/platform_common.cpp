@@ -22,11 +22,13 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <direct.h>
+#include <psapi.h>
 
 #else
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
 #endif
@@ -1997,6 +1999,23 @@ off_t getFileSize(string filename) {
   return 0;
 }
 
+time_t getFileModificationTime(string filename) {
+#ifdef WIN32
+  #if defined(__MINGW32__)
+  struct _stat stbuf;
+  #else
+  struct _stat64i32 stbuf;
+  #endif
+  if(_wstat(utf8_decode(filename).c_str(), &stbuf) != -1) {
+#else
+  struct stat stbuf;
+  if(stat(filename.c_str(), &stbuf) != -1) {
+#endif
+	  return stbuf.st_mtime;
+  }
+  return 0;
+}
+
 string executable_path(const string &exeName, bool includeExeNameInPath) {
 	string value = "";
 #ifdef _WIN32
@@ -2329,6 +2348,27 @@ string getUserHome() {
 	return home_folder;
 }
 
+int64 getPeakResidentMemoryBytes() {
+	int64 result = 0;
+#ifdef WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) != 0) {
+		result = (int64)counters.PeakWorkingSetSize;
+	}
+#else
+	struct rusage usage;
+	if(getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+		result = (int64)usage.ru_maxrss;
+#else
+		// reported in kilobytes everywhere but OS X
+		result = (int64)usage.ru_maxrss * 1024;
+#endif
+	}
+#endif
+	return result;
+}
+
 string safeCharPtrCopy(const char *ptr,int maxLength) {
 	string result = "";
 	if(ptr == NULL) {
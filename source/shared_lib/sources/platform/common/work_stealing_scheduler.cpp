@@ -0,0 +1,303 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "work_stealing_scheduler.h"
+#include "platform_common.h"
+#include "util.h"
+#include "conversion.h"
+#include "platform_util.h"
+#include <SDL_cpuinfo.h>
+#include "leak_dumper.h"
+
+using namespace Shared::Util;
+
+namespace Shared { namespace PlatformCommon {
+
+// =====================================================
+//	class WorkStealingWorkerThread
+// =====================================================
+
+WorkStealingWorkerThread::WorkStealingWorkerThread(WorkStealingScheduler *scheduler, int workerIndex) : BaseThread() {
+	this->scheduler = scheduler;
+	this->workerIndex = workerIndex;
+	uniqueID = "WorkStealingWorkerThread";
+}
+
+WorkStealingWorkerThread::~WorkStealingWorkerThread() {
+	this->scheduler = NULL;
+}
+
+void WorkStealingWorkerThread::setQuitStatus(bool value) {
+	BaseThread::setQuitStatus(value);
+	if(value == true) {
+		signalTask();
+	}
+}
+
+void WorkStealingWorkerThread::signalTask() {
+	semTaskSignalled.signal();
+}
+
+bool WorkStealingWorkerThread::canShutdown(bool deleteSelfIfShutdownDelayed) {
+	bool ret = (getExecutingTask() == false);
+	if(ret == false && deleteSelfIfShutdownDelayed == true) {
+	    setDeleteSelfOnExecutionDone(deleteSelfIfShutdownDelayed);
+	    deleteSelfIfRequired();
+	    signalQuit();
+	}
+	return ret;
+}
+
+void WorkStealingWorkerThread::execute() {
+    RunningStatusSafeWrapper runningStatus(this);
+	try {
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] worker %d\n",__FILE__,__FUNCTION__,__LINE__,workerIndex);
+
+		WorkStealingScheduler::registerWorkerThread(workerIndex,Thread::getCurrentThreadId());
+
+		for(;this->scheduler != NULL;) {
+			if(getQuitStatus() == true) {
+				break;
+			}
+
+			semTaskSignalled.waitTillSignalled();
+
+			if(getQuitStatus() == true) {
+				break;
+			}
+
+			ExecutingTaskSafeWrapper safeExecutingTaskMutex(this);
+			this->scheduler->workerLoop(workerIndex);
+		}
+
+		WorkStealingScheduler::unregisterWorkerThread(Thread::getCurrentThreadId());
+	}
+	catch(const exception &ex) {
+		WorkStealingScheduler::unregisterWorkerThread(Thread::getCurrentThreadId());
+
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] Error [%s]\n",__FILE__,__FUNCTION__,__LINE__,ex.what());
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d]\n",__FILE__,__FUNCTION__,__LINE__);
+
+		throw megaglest_runtime_error(ex.what());
+	}
+	if(SystemFlags::getSystemSettingType(SystemFlags::debugSystem).enabled) SystemFlags::OutputDebug(SystemFlags::debugSystem,"In [%s::%s Line: %d] worker %d ENDING\n",__FILE__,__FUNCTION__,__LINE__,workerIndex);
+}
+
+// =====================================================
+//	class WorkStealingScheduler
+// =====================================================
+
+Mutex WorkStealingScheduler::mutexWorkerThreads;
+unsigned long WorkStealingScheduler::workerThreadIds[WorkStealingScheduler::maxRegisteredThreads] = { 0 };
+int WorkStealingScheduler::workerThreadIndexes[WorkStealingScheduler::maxRegisteredThreads] = { 0 };
+
+WorkStealingScheduler::WorkStealingScheduler(int workerCount, int chunkSize) {
+	if(workerCount <= 0) {
+		workerCount = getDefaultWorkerCount();
+	}
+	this->workerCount = (workerCount > maxWorkerCount ? maxWorkerCount : workerCount);
+	this->chunkSize = (chunkSize > 0 ? chunkSize : 1);
+	this->tasks = NULL;
+	this->mutexPending = new Mutex(CODE_AT_LINE);
+	this->pendingChunks = 0;
+
+	queues.resize(this->workerCount);
+	for(int index = 0; index < this->workerCount; ++index) {
+		queues[index].mutex = new Mutex(CODE_AT_LINE);
+	}
+
+	// worker 0 is whoever calls run()
+	for(int index = 1; index < this->workerCount; ++index) {
+		WorkStealingWorkerThread *thread = new WorkStealingWorkerThread(this,index);
+		thread->setUniqueID(CODE_AT_LINE_X(index));
+		thread->start();
+		threads.push_back(thread);
+	}
+}
+
+WorkStealingScheduler::~WorkStealingScheduler() {
+	for(unsigned int index = 0; index < threads.size(); ++index) {
+		WorkStealingWorkerThread *thread = threads[index];
+		thread->signalQuit();
+		if(thread->shutdownAndWait() == true) {
+			delete thread;
+		}
+	}
+	threads.clear();
+
+	for(unsigned int index = 0; index < queues.size(); ++index) {
+		delete queues[index].mutex;
+		queues[index].mutex = NULL;
+	}
+	queues.clear();
+
+	delete mutexPending;
+	mutexPending = NULL;
+}
+
+int WorkStealingScheduler::getDefaultWorkerCount() {
+	int cpuCount = SDL_GetCPUCount();
+	if(cpuCount < 1) {
+		cpuCount = 1;
+	}
+	return (cpuCount > maxWorkerCount ? maxWorkerCount : cpuCount);
+}
+
+void WorkStealingScheduler::registerWorkerThread(int workerIndex, unsigned long threadId) {
+	if(workerIndex <= 0 || workerIndex >= maxWorkerCount || threadId == 0) {
+		return;
+	}
+	static string mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutexWorkerThreads,mutexOwnerId);
+	for(int slot = 0; slot < maxRegisteredThreads; ++slot) {
+		if(workerThreadIds[slot] == 0) {
+			// index first, getCurrentWorkerIndex reads without the lock
+			workerThreadIndexes[slot] = workerIndex;
+			workerThreadIds[slot] = threadId;
+			return;
+		}
+	}
+}
+
+void WorkStealingScheduler::unregisterWorkerThread(unsigned long threadId) {
+	static string mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(&mutexWorkerThreads,mutexOwnerId);
+	for(int slot = 0; slot < maxRegisteredThreads; ++slot) {
+		if(workerThreadIds[slot] == threadId) {
+			workerThreadIds[slot] = 0;
+		}
+	}
+}
+
+int WorkStealingScheduler::getCurrentWorkerIndex() {
+	unsigned long threadId = Thread::getCurrentThreadId();
+	for(int slot = 0; slot < maxRegisteredThreads; ++slot) {
+		if(workerThreadIds[slot] == threadId) {
+			return workerThreadIndexes[slot];
+		}
+	}
+	return 0;
+}
+
+bool WorkStealingScheduler::takeChunk(int workerIndex, TaskChunk &chunk) {
+	static string mutexOwnerId = CODE_AT_LINE;
+
+	// own queue first, in order
+	WorkerQueue &ownQueue = queues[workerIndex];
+	MutexSafeWrapper safeMutex(ownQueue.mutex,mutexOwnerId);
+	if(ownQueue.chunks.empty() == false) {
+		chunk = ownQueue.chunks.front();
+		ownQueue.chunks.pop_front();
+		return true;
+	}
+	safeMutex.ReleaseLock();
+
+	// then steal from the back of the other queues
+	for(int offset = 1; offset < workerCount; ++offset) {
+		WorkerQueue &victimQueue = queues[(workerIndex + offset) % workerCount];
+		MutexSafeWrapper safeMutexVictim(victimQueue.mutex,mutexOwnerId);
+		if(victimQueue.chunks.empty() == false) {
+			chunk = victimQueue.chunks.back();
+			victimQueue.chunks.pop_back();
+			return true;
+		}
+	}
+	return false;
+}
+
+void WorkStealingScheduler::executeChunk(int workerIndex, const TaskChunk &chunk) {
+	string error = "";
+	try {
+		for(int taskIndex = chunk.first; taskIndex < chunk.last; ++taskIndex) {
+			tasks->executeTask(workerIndex,taskIndex);
+		}
+	}
+	catch(const exception &ex) {
+		error = ex.what();
+		if(error == "") {
+			error = "unknown task error";
+		}
+	}
+	catch(...) {
+		error = "unknown task error";
+	}
+
+	static string mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(mutexPending,mutexOwnerId);
+	if(error != "" && taskError == "") {
+		taskError = error;
+	}
+	pendingChunks--;
+	bool lastChunk = (pendingChunks == 0);
+	safeMutex.ReleaseLock();
+
+	if(lastChunk == true) {
+		semCompleted.signal();
+	}
+}
+
+void WorkStealingScheduler::workerLoop(int workerIndex) {
+	TaskChunk chunk(0,0);
+	for(;takeChunk(workerIndex, chunk) == true;) {
+		executeChunk(workerIndex, chunk);
+	}
+}
+
+void WorkStealingScheduler::run(WorkStealingTaskInterface *tasks, int taskCount) {
+	if(tasks == NULL) {
+		throw megaglest_runtime_error("tasks == NULL");
+	}
+	if(taskCount <= 0) {
+		return;
+	}
+
+	int chunkCount = (taskCount + chunkSize - 1) / chunkSize;
+
+	static string mutexOwnerId = CODE_AT_LINE;
+	MutexSafeWrapper safeMutex(mutexPending,mutexOwnerId);
+	this->tasks = tasks;
+	this->pendingChunks = chunkCount;
+	this->taskError = "";
+	safeMutex.ReleaseLock();
+
+	// deal out neighbouring chunks to the same worker
+	for(int workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
+		int firstChunk = (int)((int64)chunkCount * workerIndex / workerCount);
+		int lastChunk = (int)((int64)chunkCount * (workerIndex + 1) / workerCount);
+
+		MutexSafeWrapper safeMutexQueue(queues[workerIndex].mutex,mutexOwnerId);
+		for(int chunkIndex = firstChunk; chunkIndex < lastChunk; ++chunkIndex) {
+			int first = chunkIndex * chunkSize;
+			int last = (first + chunkSize < taskCount ? first + chunkSize : taskCount);
+			queues[workerIndex].chunks.push_back(TaskChunk(first,last));
+		}
+	}
+
+	for(unsigned int index = 0; index < threads.size(); ++index) {
+		threads[index]->signalTask();
+	}
+
+	workerLoop(0);
+
+	// completion latch, the last chunk to finish releases it
+	semCompleted.waitTillSignalled();
+
+	safeMutex.Lock();
+	string error = taskError;
+	this->tasks = NULL;
+	safeMutex.ReleaseLock();
+
+	if(error != "") {
+		throw megaglest_runtime_error(error);
+	}
+}
+
+}}//end namespace
@@ -45,6 +45,7 @@
   #include <unistd.h>
   #include <stdlib.h>
   #include <sys/socket.h>
+  #include <sys/uio.h>
   #include <netdb.h>
   #include <netinet/in.h>
   #include <net/if.h>
@@ -70,6 +71,7 @@ namespace Shared{ namespace Platform{
 bool Socket::disableNagle = false;
 int Socket::DEFAULT_SOCKET_SENDBUF_SIZE = -1;
 int Socket::DEFAULT_SOCKET_RECVBUF_SIZE = -1;
+const int Socket::defaultMaxSendQueueBytes = 32 * 1024 * 1024;
 string Socket::host_name = "";
 std::vector<string> Socket::intfTypes;
 
@@ -884,6 +886,12 @@ Socket::Socket(PLATFORM_SOCKET sock) {
 	this->sock= sock;
 	this->isSocketBlocking = true;
 	this->connectedIpAddress = "";
+	this->sendBatchDepth = 0;
+	this->sendQueueEnabled = false;
+	this->maxSendQueueBytes = defaultMaxSendQueueBytes;
+	this->receiveTap = NULL;
+	this->sentByteCount = 0;
+	this->receivedByteCount = 0;
 }
 
 Socket::Socket() {
@@ -904,6 +912,12 @@ Socket::Socket() {
 	//this->pingThread = NULL;
 
 	this->connectedIpAddress = "";
+	this->sendBatchDepth = 0;
+	this->sendQueueEnabled = false;
+	this->maxSendQueueBytes = defaultMaxSendQueueBytes;
+	this->receiveTap = NULL;
+	this->sentByteCount = 0;
+	this->receivedByteCount = 0;
 
 	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
 	if(isSocketValid() == false) {
@@ -1286,6 +1300,30 @@ int Socket::getDataToRead(bool wantImmediateReply) {
 int Socket::send(const void *data, int dataSize) {
 	const int MAX_SEND_WAIT_SECONDS = 3;
 
+	if(appendToSendBatch(data, dataSize) == true) {
+		return dataSize;
+	}
+
+	MutexSafeWrapper safeMutexQueue(dataSynchAccessorWrite,CODE_AT_LINE);
+	if(sendQueueEnabled == true) {
+		const char *queueBuf = static_cast<const char *>(data);
+		sendQueueBuffer.insert(sendQueueBuffer.end(), queueBuf, queueBuf + dataSize);
+		bool written = writeSendQueue();
+		int queuedBytes = (int)sendQueueBuffer.size();
+		safeMutexQueue.ReleaseLock();
+
+		if(written == true && queuedBytes > maxSendQueueBytes) {
+			SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] send queue overflow, %d bytes queued for [%s], disconnecting\n",__FILE__,__FUNCTION__,__LINE__,queuedBytes,getIpAddress().c_str());
+			written = false;
+		}
+		if(written == false) {
+			disconnectSocket();
+			return -1;
+		}
+		return dataSize;
+	}
+	safeMutexQueue.ReleaseLock();
+
 	int bytesSent= 0;
 	if(isSocketValid() == true)	{
 		errno = 0;
@@ -1455,9 +1493,194 @@ int Socket::send(const void *data, int dataSize) {
 
 	if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] sock = %d, bytesSent = %d\n",__FILE__,__FUNCTION__,__LINE__,sock,bytesSent);
 
+	if(bytesSent > 0) {
+		MutexSafeWrapper safeMutex(dataSynchAccessorWrite,CODE_AT_LINE);
+		sentByteCount += bytesSent;
+	}
 	return static_cast<int>(bytesSent);
 }
 
+int Socket::sendv(const void * const data[], const int dataSize[], int bufferCount) {
+	const int MAX_SEND_BUFFERS = 16;
+
+	int totalSize = 0;
+	for(int index = 0; index < bufferCount; ++index) {
+		totalSize += dataSize[index];
+	}
+
+	// Keep other writers out until every buffer is on its way
+	MutexSafeWrapper safeMutex(dataSynchAccessorWrite,CODE_AT_LINE);
+
+	// a send queue has to keep its bytes ahead of the new ones
+	bool useGatherWrite = (sendBatchDepth <= 0 && sendQueueEnabled == false &&
+						   bufferCount <= MAX_SEND_BUFFERS);
+#ifdef WIN32
+	useGatherWrite = false;
+#endif
+	if(useGatherWrite == false) {
+		// Without a gather write the buffers are joined in the batch buffer
+		beginSendBatch();
+		for(int index = 0; index < bufferCount; ++index) {
+			appendToSendBatch(data[index], dataSize[index]);
+		}
+		return (endSendBatch() == true ? totalSize : -1);
+	}
+
+	int totalBytesSent = 0;
+#ifndef WIN32
+	if(isSocketValid() == true) {
+		struct iovec vectors[MAX_SEND_BUFFERS];
+		for(int index = 0; index < bufferCount; ++index) {
+			vectors[index].iov_base = const_cast<void *>(data[index]);
+			vectors[index].iov_len 	= dataSize[index];
+		}
+		struct msghdr message;
+		memset(&message, 0, sizeof(message));
+		message.msg_iov 	= vectors;
+		message.msg_iovlen 	= bufferCount;
+
+#ifdef __APPLE__
+		ssize_t bytesSent = ::sendmsg(sock, &message, SO_NOSIGPIPE);
+#else
+		ssize_t bytesSent = ::sendmsg(sock, &message, MSG_NOSIGNAL | MSG_DONTWAIT);
+#endif
+		if(bytesSent > 0) {
+			sentByteCount += bytesSent;
+		}
+		if(bytesSent == totalSize) {
+			return totalSize;
+		}
+		if(bytesSent > 0) {
+			totalBytesSent = (int)bytesSent;
+		}
+	}
+#endif
+
+	// Whatever the single write did not take goes through send() which waits
+	// for the socket and retries
+	int skipBytes = totalBytesSent;
+	for(int index = 0; index < bufferCount; ++index) {
+		if(skipBytes >= dataSize[index]) {
+			skipBytes -= dataSize[index];
+			continue;
+		}
+		const char *sendBuf = static_cast<const char *>(data[index]);
+		int remainingSize = dataSize[index] - skipBytes;
+		int bytesSent = send(&sendBuf[skipBytes], remainingSize);
+		skipBytes = 0;
+		if(bytesSent != remainingSize) {
+			return (bytesSent > 0 ? totalBytesSent + bytesSent : (totalBytesSent > 0 ? totalBytesSent : bytesSent));
+		}
+		totalBytesSent += bytesSent;
+	}
+	return totalBytesSent;
+}
+
+bool Socket::appendToSendBatch(const void *data, int dataSize) {
+	MutexSafeWrapper safeMutex(dataSynchAccessorWrite,CODE_AT_LINE);
+	if(sendBatchDepth <= 0) {
+		return false;
+	}
+	const char *appendBuf = static_cast<const char *>(data);
+	sendBatchBuffer.insert(sendBatchBuffer.end(), appendBuf, appendBuf + dataSize);
+	return true;
+}
+
+void Socket::beginSendBatch() {
+	MutexSafeWrapper safeMutex(dataSynchAccessorWrite,CODE_AT_LINE);
+	sendBatchDepth++;
+}
+
+bool Socket::endSendBatch() {
+	MutexSafeWrapper safeMutex(dataSynchAccessorWrite,CODE_AT_LINE);
+	if(sendBatchDepth <= 0 || --sendBatchDepth > 0 || sendBatchBuffer.empty() == true) {
+		return true;
+	}
+
+	int batchSize = (int)sendBatchBuffer.size();
+	int bytesSent = send(&sendBatchBuffer[0], batchSize);
+	// clear() keeps the capacity for the next batch
+	sendBatchBuffer.clear();
+	return (bytesSent == batchSize);
+}
+
+bool Socket::isSendBatchOpen() {
+	MutexSafeWrapper safeMutex(dataSynchAccessorWrite,CODE_AT_LINE);
+	return (sendBatchDepth > 0);
+}
+
+void Socket::enableSendQueue(int maxQueueBytes) {
+	MutexSafeWrapper safeMutex(dataSynchAccessorWrite,CODE_AT_LINE);
+	sendQueueEnabled = true;
+	maxSendQueueBytes = maxQueueBytes;
+}
+
+// Writes as much of the send queue as the socket takes without waiting,
+// the caller holds the write mutex. Returns false on a socket error.
+bool Socket::writeSendQueue() {
+	if(sendQueueBuffer.empty() == true) {
+		return true;
+	}
+	if(isSocketValid() == false) {
+		return false;
+	}
+
+	errno = 0;
+#ifdef __APPLE__
+	ssize_t bytesSent = ::send(sock, &sendQueueBuffer[0], sendQueueBuffer.size(), SO_NOSIGPIPE);
+#else
+	ssize_t bytesSent = ::send(sock, &sendQueueBuffer[0], sendQueueBuffer.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+#endif
+	if(bytesSent < 0) {
+		int lastSocketError = getLastSocketError();
+		if(lastSocketError == PLATFORM_SOCKET_TRY_AGAIN) {
+			return true;
+		}
+		if(SystemFlags::getSystemSettingType(SystemFlags::debugNetwork).enabled) SystemFlags::OutputDebug(SystemFlags::debugNetwork,"In [%s::%s Line: %d] ERROR WRITING SEND QUEUE, queued = %d error = %s\n",__FILE__,__FUNCTION__,__LINE__,(int)sendQueueBuffer.size(),getLastSocketErrorFormattedText(&lastSocketError).c_str());
+		return false;
+	}
+
+	sentByteCount += bytesSent;
+	sendQueueBuffer.erase(sendQueueBuffer.begin(), sendQueueBuffer.begin() + bytesSent);
+	return true;
+}
+
+bool Socket::flushSendQueue() {
+	MutexSafeWrapper safeMutex(dataSynchAccessorWrite,CODE_AT_LINE);
+	bool written = writeSendQueue();
+	safeMutex.ReleaseLock();
+
+	if(written == false) {
+		disconnectSocket();
+	}
+	return written;
+}
+
+int64 Socket::getSendQueueSize() {
+	MutexSafeWrapper safeMutex(dataSynchAccessorWrite,CODE_AT_LINE);
+	return (int64)sendQueueBuffer.size();
+}
+
+void Socket::setReceiveTap(SocketReceiveTap *tap) {
+	MutexSafeWrapper safeMutex(dataSynchAccessorRead,CODE_AT_LINE);
+	receiveTap = tap;
+}
+
+int64 Socket::getSentByteCount() {
+	MutexSafeWrapper safeMutex(dataSynchAccessorWrite,CODE_AT_LINE);
+	return sentByteCount;
+}
+
+int64 Socket::getQueuedByteCount() {
+	MutexSafeWrapper safeMutex(dataSynchAccessorWrite,CODE_AT_LINE);
+	return sentByteCount + (int64)sendBatchBuffer.size() + (int64)sendQueueBuffer.size();
+}
+
+int64 Socket::getReceivedByteCount() {
+	MutexSafeWrapper safeMutex(dataSynchAccessorRead,CODE_AT_LINE);
+	return receivedByteCount;
+}
+
 int Socket::receive(void *data, int dataSize, bool tryReceiveUntilDataSizeMet) {
 	ssize_t bytesReceived = 0;
 
@@ -1465,6 +1688,12 @@ int Socket::receive(void *data, int dataSize, bool tryReceiveUntilDataSizeMet) {
 		MutexSafeWrapper safeMutex(dataSynchAccessorRead,CODE_AT_LINE);
 		if(isSocketValid() == true)	{
 			bytesReceived = recv(sock, reinterpret_cast<char*>(data), dataSize, 0);
+			if(bytesReceived > 0) {
+				receivedByteCount += bytesReceived;
+				if(receiveTap != NULL) {
+					receiveTap->socketDataReceived(data, (int)bytesReceived);
+				}
+			}
 		}
 	    safeMutex.ReleaseLock();
 	}
@@ -1499,6 +1728,12 @@ int Socket::receive(void *data, int dataSize, bool tryReceiveUntilDataSizeMet) {
 					errno = 0;
 					bytesReceived = recv(sock, reinterpret_cast<char*>(data), dataSize, 0);
 					lastSocketError = getLastSocketError();
+					if(bytesReceived > 0) {
+						receivedByteCount += bytesReceived;
+						if(receiveTap != NULL) {
+							receiveTap->socketDataReceived(data, (int)bytesReceived);
+						}
+					}
 					//safeBlock.Restore();
 					safeMutex.ReleaseLock();
 
@@ -0,0 +1,149 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "socket_reactor.h"
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+#include "leak_dumper.h"
+
+namespace Shared { namespace Platform {
+
+// the wakeup descriptor is registered with a user data no socket can have
+static const int reactorWakeupUserData = -1;
+static const int reactorMaxEvents = 64;
+
+// =====================================================
+//	class SocketReactor
+// =====================================================
+
+SocketReactor::SocketReactor() {
+	pollId = -1;
+	wakeupId = -1;
+}
+
+SocketReactor::~SocketReactor() {
+#if defined(__linux__)
+	if(wakeupId >= 0) {
+		::close(wakeupId);
+	}
+	if(pollId >= 0) {
+		::close(pollId);
+	}
+#endif
+	wakeupId = -1;
+	pollId = -1;
+}
+
+bool SocketReactor::isSupported() {
+#if defined(__linux__)
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool SocketReactor::init() {
+#if defined(__linux__)
+	if(pollId >= 0) {
+		return true;
+	}
+	pollId = epoll_create1(EPOLL_CLOEXEC);
+	if(pollId < 0) {
+		return false;
+	}
+	wakeupId = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(wakeupId >= 0) {
+		struct epoll_event event;
+		event.events = EPOLLIN | EPOLLET;
+		event.data.u64 = 0;
+		event.data.fd = reactorWakeupUserData;
+		epoll_ctl(pollId, EPOLL_CTL_ADD, wakeupId, &event);
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool SocketReactor::addSocket(PLATFORM_SOCKET socket, int userData, bool wantWritable) {
+#if defined(__linux__)
+	if(pollId < 0 || userData < 0 || Socket::isSocketValid(&socket) == false) {
+		return false;
+	}
+	struct epoll_event event;
+	event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+	if(wantWritable == true) {
+		event.events |= EPOLLOUT;
+	}
+	event.data.u64 = 0;
+	event.data.fd = userData;
+	if(epoll_ctl(pollId, EPOLL_CTL_ADD, socket, &event) == 0) {
+		return true;
+	}
+	return (errno == EEXIST && epoll_ctl(pollId, EPOLL_CTL_MOD, socket, &event) == 0);
+#else
+	return false;
+#endif
+}
+
+void SocketReactor::removeSocket(PLATFORM_SOCKET socket) {
+#if defined(__linux__)
+	if(pollId >= 0 && Socket::isSocketValid(&socket) == true) {
+		// closed sockets have already left the set, so errors are expected
+		struct epoll_event event;
+		epoll_ctl(pollId, EPOLL_CTL_DEL, socket, &event);
+	}
+#endif
+}
+
+int SocketReactor::wait(std::vector<SocketReactorEvent> &events, int timeoutMilliseconds) {
+	events.clear();
+#if defined(__linux__)
+	if(pollId < 0) {
+		return 0;
+	}
+	struct epoll_event readyEvents[reactorMaxEvents];
+	int readyCount = epoll_wait(pollId, readyEvents, reactorMaxEvents, timeoutMilliseconds);
+	for(int index = 0; index < readyCount; ++index) {
+		const struct epoll_event &readyEvent = readyEvents[index];
+		if(readyEvent.data.fd == reactorWakeupUserData) {
+			uint64_t wakeups = 0;
+			while(read(wakeupId, &wakeups, sizeof(wakeups)) > 0) {
+			}
+			continue;
+		}
+
+		SocketReactorEvent event;
+		event.userData = readyEvent.data.fd;
+		event.readable = ((readyEvent.events & EPOLLIN) != 0);
+		event.writable = ((readyEvent.events & EPOLLOUT) != 0);
+		event.hangup = ((readyEvent.events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0);
+		events.push_back(event);
+	}
+#endif
+	return (int)events.size();
+}
+
+void SocketReactor::wakeup() {
+#if defined(__linux__)
+	if(wakeupId >= 0) {
+		uint64_t value = 1;
+		ssize_t written = write(wakeupId, &value, sizeof(value));
+		(void)written;
+	}
+#endif
+}
+
+}}//end namespace
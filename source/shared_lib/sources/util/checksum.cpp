@@ -76,6 +76,28 @@ unsigned int crc_table[256] =
 	0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94, 0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d
 };
 
+// Tables for slicing-by-8, crcSliceTables.table[0] is crc_table and every
+// further table advances the crc by one more zero byte. This processes eight
+// bytes per step and gives exactly the same sums as the byte wise loop.
+class CrcSliceTables {
+public:
+	uint32 table[8][256];
+
+	CrcSliceTables() {
+		for(int index = 0; index < 256; ++index) {
+			table[0][index] = crc_table[index];
+		}
+		for(int index = 0; index < 256; ++index) {
+			for(int slice = 1; slice < 8; ++slice) {
+				uint32 previous = table[slice - 1][index];
+				table[slice][index] = (previous >> 8) ^ table[0][previous & 0xff];
+			}
+		}
+	}
+};
+
+static CrcSliceTables crcSliceTables;
+
 Checksum::Checksum() {
 	sum= 0;
 	r= 55665;
@@ -101,11 +123,21 @@ uint32 Checksum::addByte(const char value) {
 
 uint32 Checksum::addBytes(const void *_data, size_t _size) {
 	const unsigned char *rVal = reinterpret_cast<const unsigned char *>(_data);
-	sum = ~sum;
+	const uint32 (*table)[256] = crcSliceTables.table;
+
+	uint32 crc = ~sum;
+	for(; _size >= 8; _size -= 8, rVal += 8) {
+		uint32 low = crc ^ ((uint32)rVal[0] | ((uint32)rVal[1] << 8) |
+						((uint32)rVal[2] << 16) | ((uint32)rVal[3] << 24));
+		crc = table[7][low & 0xff] ^ table[6][(low >> 8) & 0xff] ^
+			table[5][(low >> 16) & 0xff] ^ table[4][low >> 24] ^
+			table[3][rVal[4]] ^ table[2][rVal[5]] ^
+			table[1][rVal[6]] ^ table[0][rVal[7]];
+	}
 	while (_size--) {
-		sum = (sum >> 8) ^ crc_table[*rVal++ ^ (sum & 0xff)];
+		crc = (crc >> 8) ^ table[0][*rVal++ ^ (crc & 0xff)];
 	}
-	sum = ~sum;
+	sum = ~crc;
 
 	return sum;
 }
@@ -115,56 +147,38 @@ void Checksum::addSum(uint32 value) {
 	sum += value;
 }
 
+// Integers are added low byte first whatever the host byte order is
 uint32 Checksum::addInt(const int32 &value) {
-	int8 byte 	= (value >>  0) & 0xFF;
-	addByte(byte);
-	byte  		= (value >>  8) & 0xFF;
-	addByte(byte);
-	byte 		= (value >> 16) & 0xFF;
-	addByte(byte);
-	byte 		= (value >> 24) & 0xFF;
-	addByte(byte);
-
-	return sum;
+	return addUInt((uint32)value);
 }
 
 uint32 Checksum::addUInt(const uint32 &value) {
-	int8 byte 	= (value >>  0) & 0xFF;
-	addByte(byte);
-	byte  		= (value >>  8) & 0xFF;
-	addByte(byte);
-	byte 		= (value >> 16) & 0xFF;
-	addByte(byte);
-	byte 		= (value >> 24) & 0xFF;
-	addByte(byte);
+	unsigned char bytes[4];
+	bytes[0] = (value >>  0) & 0xFF;
+	bytes[1] = (value >>  8) & 0xFF;
+	bytes[2] = (value >> 16) & 0xFF;
+	bytes[3] = (value >> 24) & 0xFF;
 
-	return sum;
+	return addBytes(bytes, 4);
 }
 
 uint32 Checksum::addInt64(const int64 &value) {
-	int8 byte 	= (value >>  0) & 0xFF;
-	addByte(byte);
-	byte  		= (value >>  8) & 0xFF;
-	addByte(byte);
-	byte 		= (value >> 16) & 0xFF;
-	addByte(byte);
-	byte 		= (value >> 24) & 0xFF;
-	addByte(byte);
-	byte 		= (value >> 32) & 0xFF;
-	addByte(byte);
-	byte 		= (value >> 40) & 0xFF;
-	addByte(byte);
-	byte 		= (value >> 48) & 0xFF;
-	addByte(byte);
-	byte 		= (value >> 56) & 0xFF;
-	addByte(byte);
-
-	return sum;
+	unsigned char bytes[8];
+	bytes[0] = (value >>  0) & 0xFF;
+	bytes[1] = (value >>  8) & 0xFF;
+	bytes[2] = (value >> 16) & 0xFF;
+	bytes[3] = (value >> 24) & 0xFF;
+	bytes[4] = (value >> 32) & 0xFF;
+	bytes[5] = (value >> 40) & 0xFF;
+	bytes[6] = (value >> 48) & 0xFF;
+	bytes[7] = (value >> 56) & 0xFF;
+
+	return addBytes(bytes, 8);
 }
 
 void Checksum::addString(const string &value) {
-	for(unsigned int i = 0; i < value.size(); ++i) {
-		addByte(value[i]);
+	if(value.empty() == false) {
+		addBytes(value.data(), value.size());
 	}
 }
 
@@ -174,6 +188,13 @@ void Checksum::addFile(const string &path) {
 	}
 }
 
+void Checksum::addFiles(const Checksum &checksum) {
+	for(std::map<string,uint32>::const_iterator iterMap = checksum.fileList.begin();
+		iterMap != checksum.fileList.end(); ++iterMap) {
+		fileList[iterMap->first] = 0;
+	}
+}
+
 bool Checksum::addFileToSum(const string &path) {
 
 // OLD SLOW FILE I/O
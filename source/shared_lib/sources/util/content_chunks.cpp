@@ -0,0 +1,201 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "content_chunks.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef WIN32
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif
+
+#include "checksum.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::PlatformCommon;
+
+namespace Shared { namespace Util {
+
+const uint32 ContentChunks::chunkSize = 16384;
+
+static FILE * openContentFile(const string &file, const char *mode) {
+#ifdef WIN32
+	return _wfopen(utf8_decode(file).c_str(), utf8_decode(mode).c_str());
+#else
+	return fopen(file.c_str(), mode);
+#endif
+}
+
+static bool compareContentChunkFiles(const ContentChunkFile &left, const ContentChunkFile &right) {
+	return left.path < right.path;
+}
+
+// =====================================================
+//	class ContentChunks
+// =====================================================
+
+uint32 ContentChunks::getChunkCount(uint32 fileSize) {
+	return (fileSize + chunkSize - 1) / chunkSize;
+}
+
+uint32 ContentChunks::getChunkCRC(const unsigned char *data, uint32 size) {
+	Checksum checksum;
+	checksum.addBytes(data, size);
+	return checksum.getSum();
+}
+
+bool ContentChunks::getFileChunks(const string &file, ContentChunkFile &result) {
+	result.size = 0;
+	result.chunkCRCs.clear();
+
+	FILE *fp = openContentFile(file, "rb");
+	if(fp == NULL) {
+		return false;
+	}
+	vector<unsigned char> buffer(chunkSize);
+	for(;;) {
+		size_t readBytes = fread(&buffer[0], 1, chunkSize, fp);
+		if(readBytes > 0) {
+			result.chunkCRCs.push_back(getChunkCRC(&buffer[0], (uint32)readBytes));
+			result.size += (uint32)readBytes;
+		}
+		if(readBytes < chunkSize) {
+			break;
+		}
+	}
+	bool readError = (ferror(fp) != 0);
+	fclose(fp);
+	return (readError == false);
+}
+
+bool ContentChunks::buildFileManifest(const string &file, vector<ContentChunkFile> &result) {
+	result.clear();
+	ContentChunkFile contentFile;
+	if(getFileChunks(file, contentFile) == false) {
+		return false;
+	}
+	contentFile.path = extractFileFromDirectoryPath(file);
+	result.push_back(contentFile);
+	return true;
+}
+
+bool ContentChunks::buildFolderManifest(const string &folder, vector<ContentChunkFile> &result) {
+	result.clear();
+	if(folderExists(folder) == false) {
+		return false;
+	}
+	string rootFolder = folder;
+	endPathWithSlash(rootFolder);
+
+	vector<string> files = getFolderTreeContentsListRecursively(rootFolder + "{,.}*", "", false, NULL);
+	for(unsigned int index = 0; index < files.size(); ++index) {
+		ContentChunkFile contentFile;
+		if(getFileChunks(files[index], contentFile) == false) {
+			return false;
+		}
+		contentFile.path = files[index].substr(rootFolder.size());
+		replaceAll(contentFile.path, "\\", "/");
+		result.push_back(contentFile);
+	}
+	std::sort(result.begin(), result.end(), compareContentChunkFiles);
+	return true;
+}
+
+bool ContentChunks::isSafeRelativePath(const string &path) {
+	if(path.empty() == true || path[0] == '/' || path[0] == '\\' ||
+		path.find(':') != string::npos) {
+		return false;
+	}
+	string normalized = "/" + path + "/";
+	replaceAll(normalized, "\\", "/");
+	return (normalized.find("/../") == string::npos &&
+			normalized.find("/./") == string::npos &&
+			normalized.find("//") == string::npos);
+}
+
+vector<uint32> ContentChunks::getStaleChunks(const string &localFile, const ContentChunkFile &remote) {
+	vector<uint32> result;
+	ContentChunkFile local;
+	getFileChunks(localFile, local);
+
+	for(uint32 chunkIndex = 0; chunkIndex < remote.chunkCRCs.size(); ++chunkIndex) {
+		// a short last chunk only matches a local chunk of the same length
+		uint32 remoteChunkEnd = std::min(remote.size, (chunkIndex + 1) * chunkSize);
+		bool sameChunk = (chunkIndex < local.chunkCRCs.size() &&
+						  local.chunkCRCs[chunkIndex] == remote.chunkCRCs[chunkIndex] &&
+						  local.size >= remoteChunkEnd &&
+						  (remoteChunkEnd % chunkSize == 0 || local.size == remoteChunkEnd));
+		if(sameChunk == false) {
+			result.push_back(chunkIndex);
+		}
+	}
+	return result;
+}
+
+bool ContentChunks::readChunk(const string &file, uint32 chunkIndex, vector<unsigned char> &data) {
+	data.clear();
+	FILE *fp = openContentFile(file, "rb");
+	if(fp == NULL) {
+		return false;
+	}
+	bool result = false;
+	if(fseek(fp, (long)chunkIndex * chunkSize, SEEK_SET) == 0) {
+		data.resize(chunkSize);
+		size_t readBytes = fread(&data[0], 1, chunkSize, fp);
+		data.resize(readBytes);
+		result = (ferror(fp) == 0 && readBytes > 0);
+	}
+	fclose(fp);
+	return result;
+}
+
+bool ContentChunks::writeChunk(const string &file, uint32 chunkIndex, const unsigned char *data, uint32 size) {
+	FILE *fp = openContentFile(file, "r+b");
+	if(fp == NULL) {
+		createDirectoryPaths(extractDirectoryPathFromFile(file));
+		fp = openContentFile(file, "w+b");
+		if(fp == NULL) {
+			return false;
+		}
+	}
+	// seeking past the end leaves a gap that later chunks fill
+	bool result = (fseek(fp, (long)chunkIndex * chunkSize, SEEK_SET) == 0 &&
+				   fwrite(data, 1, size, fp) == size);
+	result = (fclose(fp) == 0 && result);
+	return result;
+}
+
+bool ContentChunks::setFileSize(const string &file, uint32 size) {
+	FILE *fp = openContentFile(file, "r+b");
+	if(fp == NULL) {
+		createDirectoryPaths(extractDirectoryPathFromFile(file));
+		fp = openContentFile(file, "w+b");
+		if(fp == NULL) {
+			return false;
+		}
+	}
+	fflush(fp);
+#ifdef WIN32
+	bool result = (_chsize(_fileno(fp), (long)size) == 0);
+#else
+	bool result = (ftruncate(fileno(fp), (off_t)size) == 0);
+#endif
+	result = (fclose(fp) == 0 && result);
+	return result;
+}
+
+}}//end namespace
@@ -0,0 +1,55 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "packed_fields.h"
+#include <cstring>
+#include "leak_dumper.h"
+
+namespace Shared { namespace Util {
+
+// =====================================================
+//	class PackedFieldWriter
+// =====================================================
+
+PackedFieldWriter & PackedFieldWriter::operator&(const PackedString &value) {
+	int length = value.packedSize - 1;
+	write((uint16)length);
+
+	int copyLength = (value.bufferSize < length ? value.bufferSize : length);
+	memcpy(&buffer[position], value.buffer, copyLength);
+	if(copyLength < length) {
+		memset(&buffer[position + copyLength], 0, length - copyLength);
+	}
+	position += length;
+	return *this;
+}
+
+// =====================================================
+//	class PackedFieldReader
+// =====================================================
+
+PackedFieldReader & PackedFieldReader::operator&(const PackedString &value) {
+	// every field has its packed width, a larger length from the other
+	// side must not move us past the message
+	int length = value.packedSize - 1;
+	int sentLength = read<uint16>();
+
+	int copyLength = (sentLength < length ? sentLength : length);
+	if(copyLength > value.bufferSize - 1) {
+		copyLength = value.bufferSize - 1;
+	}
+	memcpy(value.buffer, &buffer[position], copyLength);
+	value.buffer[copyLength] = '\0';
+	position += length;
+	return *this;
+}
+
+}}//end namespace
@@ -8,7 +8,7 @@
 //	by the Free Software Foundation; either version 2 of the
 //	License, or (at your option) any later version
 // ==============================================================
-#include "network_protocol.h"
+#include "packed_format.h"
 #include <stdarg.h>
 #include <cstring>
 #include <ctype.h>
@@ -18,9 +18,8 @@
 #include "leak_dumper.h"
 
 using namespace Shared::Platform;
-using namespace Shared::Util;
 
-namespace Glest{ namespace Game{
+namespace Shared { namespace Util {
 
 #pragma pack(push, 1)
 
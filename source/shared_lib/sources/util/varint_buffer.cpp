@@ -0,0 +1,103 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "varint_buffer.h"
+#include "leak_dumper.h"
+
+namespace Shared { namespace Util {
+
+// =====================================================
+//	class VarintWriter
+// =====================================================
+
+void VarintWriter::writeUInt(uint32 value) {
+	while(value >= 0x80) {
+		buffer.push_back((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	buffer.push_back((unsigned char)value);
+}
+
+void VarintWriter::writeFixedUInt(uint32 value) {
+	buffer.push_back((unsigned char)(value & 0xFF));
+	buffer.push_back((unsigned char)((value >> 8) & 0xFF));
+	buffer.push_back((unsigned char)((value >> 16) & 0xFF));
+	buffer.push_back((unsigned char)((value >> 24) & 0xFF));
+}
+
+void VarintWriter::writeString(const std::string &value) {
+	writeUInt((uint32)value.size());
+	buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+int VarintWriter::getUIntSize(uint32 value) {
+	int result = 1;
+	for(;value >= 0x80; value >>= 7) {
+		result++;
+	}
+	return result;
+}
+
+// =====================================================
+//	class VarintReader
+// =====================================================
+
+VarintReader::VarintReader(const unsigned char *data, int size) {
+	this->data = data;
+	this->size = size;
+	this->position = 0;
+	this->failed = false;
+}
+
+unsigned char VarintReader::readByte() {
+	if(failed == true || position >= size) {
+		failed = true;
+		return 0;
+	}
+	return data[position++];
+}
+
+uint32 VarintReader::readUInt() {
+	uint32 result = 0;
+	for(int shift = 0; shift < 35; shift += 7) {
+		unsigned char value = readByte();
+		if(failed == true) {
+			return 0;
+		}
+		result |= (uint32)(value & 0x7F) << shift;
+		if((value & 0x80) == 0) {
+			return result;
+		}
+	}
+	failed = true;
+	return 0;
+}
+
+uint32 VarintReader::readFixedUInt() {
+	uint32 result = readByte();
+	result |= (uint32)readByte() << 8;
+	result |= (uint32)readByte() << 16;
+	result |= (uint32)readByte() << 24;
+	return (failed == true ? 0 : result);
+}
+
+std::string VarintReader::readString() {
+	uint32 length = readUInt();
+	if(failed == true || length > (uint32)(size - position)) {
+		failed = true;
+		return "";
+	}
+	std::string result((const char *)&data[position], length);
+	position += length;
+	return result;
+}
+
+}}//end namespace
@@ -0,0 +1,124 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "xml_arena.h"
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include "xml_parser.h"
+#include "platform_util.h"
+#include "conversion.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Platform;
+using namespace Shared::Util;
+
+namespace Shared { namespace Xml {
+
+const size_t XmlArena::minBlockSize	= 4096;
+const size_t XmlArena::maxBlockSize	= 256 * 1024;
+
+// every allocation keeps this alignment
+static const size_t arenaAlignment	= 16;
+
+XmlArena::XmlArena() {
+	currentBlock	= NULL;
+	blockSize		= minBlockSize;
+	blockUsed		= 0;
+	allocatedBytes	= 0;
+	memset(tagStartCharacters, 0, sizeof(tagStartCharacters));
+}
+
+XmlArena::~XmlArena() {
+	for(unsigned int i = 0; i < blocks.size(); ++i) {
+		free(blocks[i]);
+	}
+	blocks.clear();
+}
+
+void XmlArena::setBufferSize(size_t size) {
+	buffer.resize(size);
+
+	// nodes and attributes take about as much room as their text
+	size_t wantedBlockSize = size * 2;
+	blockSize = (wantedBlockSize < minBlockSize ? minBlockSize :
+				(wantedBlockSize > maxBlockSize ? maxBlockSize : wantedBlockSize));
+}
+
+void *XmlArena::allocate(size_t size) {
+	size = (size + arenaAlignment - 1) & ~(arenaAlignment - 1);
+	if(currentBlock == NULL || blockUsed + size > blockSize) {
+		// an oversized request gets a block of its own
+		size_t newBlockSize = (size > blockSize ? size : blockSize);
+		char *block = (char *)malloc(newBlockSize);
+		if(block == NULL) {
+			throw megaglest_runtime_error("Out of memory for an XML tree of " + uIntToStr((unsigned int)newBlockSize) + " bytes");
+		}
+		blocks.push_back(block);
+		allocatedBytes += newBlockSize;
+		if(size > blockSize) {
+			return block;
+		}
+		currentBlock = block;
+		blockUsed = 0;
+	}
+	void *result = currentBlock + blockUsed;
+	blockUsed += size;
+	return result;
+}
+
+void XmlArena::setTagReplacementValues(const std::map<string,string> &mapTagReplacementValues) {
+	memset(tagStartCharacters, 0, sizeof(tagStartCharacters));
+	for(std::map<string,string>::const_iterator iterMap = mapTagReplacementValues.begin();
+		iterMap != mapTagReplacementValues.end(); ++iterMap) {
+		if(iterMap->first.empty() == false) {
+			tagStartCharacters[(unsigned char)iterMap->first[0]] = true;
+		}
+	}
+	// path variables are replaced whatever the map holds
+	tagStartCharacters[(unsigned char)'~'] = true;
+	tagStartCharacters[(unsigned char)'$'] = true;
+	tagStartCharacters[(unsigned char)'%'] = true;
+	tagStartCharacters[(unsigned char)'{'] = true;
+}
+
+bool XmlArena::mayContainTags(const char *value) const {
+	for(const unsigned char *character = (const unsigned char *)value; *character != 0; ++character) {
+		if(tagStartCharacters[*character] == true) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// the leak dumper turns new into its own tracking call, which
+// placement new can't go through
+#if defined(new)
+#pragma push_macro("new")
+#undef new
+#define XML_ARENA_RESTORE_NEW
+#endif
+
+XmlNode *XmlArena::newNode() {
+	return ::new(allocate(sizeof(XmlNode))) XmlNode(this);
+}
+
+XmlAttribute *XmlArena::newAttribute() {
+	return ::new(allocate(sizeof(XmlAttribute))) XmlAttribute(this);
+}
+
+#if defined(XML_ARENA_RESTORE_NEW)
+#pragma pop_macro("new")
+#undef XML_ARENA_RESTORE_NEW
+#endif
+
+}}//end namespace
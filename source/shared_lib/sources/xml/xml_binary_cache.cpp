@@ -0,0 +1,389 @@
+// ==============================================================
+//	This file is part of MegaGlest Shared Library (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "xml_binary_cache.h"
+
+#include <stdio.h>
+#include "xml_parser.h"
+#include "varint_buffer.h"
+#include "checksum.h"
+#include "conversion.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::PlatformCommon;
+using namespace Shared::Util;
+
+namespace Shared { namespace Xml {
+
+// the file starts with "MGXC"
+const uint32 XmlBinaryCache::cacheFileMagic	= 0x4358474D;
+// bump whenever the layout below or what the parser produces changes
+const uint32 XmlBinaryCache::cacheVersion	= 1;
+
+XmlBinaryCache *XmlBinaryCache::activeCache	= NULL;
+
+// trees deeper than this are taken as a damaged blob
+static const int maxNodeDepth				= 256;
+
+enum XmlBinaryCacheAttributeFlags {
+	xbcSkipRestrictionCheck		= 0x01,
+	xbcUsesCommondata			= 0x02
+};
+
+static void writeInt64(VarintWriter &writer, int64 value) {
+	writer.writeFixedUInt((uint32)((uint64)value & 0xFFFFFFFF));
+	writer.writeFixedUInt((uint32)((uint64)value >> 32));
+}
+
+static int64 readInt64(VarintReader &reader) {
+	uint64 low = reader.readFixedUInt();
+	uint64 high = reader.readFixedUInt();
+	return (int64)((high << 32) | low);
+}
+
+static uint32 addString(const string &value, std::map<string,uint32> &stringIndex) {
+	std::map<string,uint32>::iterator iterFind = stringIndex.find(value);
+	if(iterFind != stringIndex.end()) {
+		return iterFind->second;
+	}
+	uint32 index = (uint32)stringIndex.size();
+	stringIndex[value] = index;
+	return index;
+}
+
+// =====================================================
+//	class XmlBinaryCache
+// =====================================================
+
+XmlBinaryCache::XmlBinaryCache(const string &file, uint32 contentChecksum) {
+	this->mutex				= new Mutex(CODE_AT_LINE);
+	this->file				= file;
+	this->contentChecksum	= contentChecksum;
+	this->dirty				= false;
+	this->hitCount			= 0;
+	this->missCount			= 0;
+}
+
+XmlBinaryCache::~XmlBinaryCache() {
+	if(activeCache == this) {
+		activeCache = NULL;
+	}
+	delete mutex;
+	mutex = NULL;
+}
+
+uint32 XmlBinaryCache::getTagChecksum(const std::map<string,string> &mapTagReplacementValues) {
+	Checksum checksum;
+	for(std::map<string,string>::const_iterator iterMap = mapTagReplacementValues.begin();
+			iterMap != mapTagReplacementValues.end(); ++iterMap) {
+		checksum.addString(iterMap->first);
+		checksum.addString(iterMap->second);
+	}
+	return checksum.getSum();
+}
+
+void XmlBinaryCache::encodeNode(const XmlNode *node, VarintWriter &writer,
+		std::map<string,uint32> &stringIndex) {
+	writer.writeUInt(addString(node->name, stringIndex));
+	writer.writeUInt(addString(node->text, stringIndex));
+
+	writer.writeUInt((uint32)node->attributes.size());
+	for(unsigned int i = 0; i < node->attributes.size(); ++i) {
+		const XmlAttribute *attribute = node->attributes[i];
+		writer.writeUInt(addString(attribute->nameView.str(), stringIndex));
+		writer.writeUInt(addString(attribute->valueView.str(), stringIndex));
+		writer.writeByte((unsigned char)((attribute->skipRestrictionCheck ? xbcSkipRestrictionCheck : 0) |
+										 (attribute->usesCommondata ? xbcUsesCommondata : 0)));
+	}
+
+	writer.writeUInt((uint32)node->children.size());
+	for(unsigned int i = 0; i < node->children.size(); ++i) {
+		encodeNode(node->children[i], writer, stringIndex);
+	}
+}
+
+string XmlBinaryCache::encodeTree(const XmlNode *rootNode) {
+	// names repeat a lot so the nodes only refer to a table of them
+	VarintWriter nodeWriter;
+	std::map<string,uint32> stringIndex;
+	encodeNode(rootNode, nodeWriter, stringIndex);
+
+	std::vector<const string *> strings(stringIndex.size());
+	for(std::map<string,uint32>::const_iterator iterMap = stringIndex.begin();
+			iterMap != stringIndex.end(); ++iterMap) {
+		strings[iterMap->second] = &iterMap->first;
+	}
+
+	VarintWriter writer;
+	writer.writeUInt((uint32)strings.size());
+	for(unsigned int i = 0; i < strings.size(); ++i) {
+		writer.writeString(*strings[i]);
+	}
+
+	const std::vector<unsigned char> &header = writer.getBuffer();
+	const std::vector<unsigned char> &nodes = nodeWriter.getBuffer();
+	string result;
+	result.reserve(header.size() + nodes.size());
+	result.append(header.begin(), header.end());
+	result.append(nodes.begin(), nodes.end());
+	return result;
+}
+
+XmlNode *XmlBinaryCache::decodeNode(VarintReader &reader, const std::vector<string> &strings, int depth) {
+	uint32 nameIndex = reader.readUInt();
+	uint32 textIndex = reader.readUInt();
+	if(reader.hasFailed() == true || depth > maxNodeDepth ||
+		nameIndex >= strings.size() || textIndex >= strings.size()) {
+		return NULL;
+	}
+
+	XmlNode *node = new XmlNode(strings[nameIndex]);
+	node->text = strings[textIndex];
+
+	uint32 attributeCount = reader.readUInt();
+	if(reader.hasFailed() == false) {
+		node->attributes.reserve(attributeCount < 64 ? attributeCount : 64);
+	}
+	for(uint32 i = 0; i < attributeCount && reader.hasFailed() == false; ++i) {
+		uint32 attributeNameIndex = reader.readUInt();
+		uint32 valueIndex = reader.readUInt();
+		unsigned char flags = reader.readByte();
+		if(reader.hasFailed() == true ||
+			attributeNameIndex >= strings.size() || valueIndex >= strings.size()) {
+			delete node;
+			return NULL;
+		}
+		node->attributes.push_back(new XmlAttribute(strings[attributeNameIndex], strings[valueIndex],
+				(flags & xbcSkipRestrictionCheck) != 0, (flags & xbcUsesCommondata) != 0));
+	}
+
+	uint32 childCount = reader.readUInt();
+	if(reader.hasFailed() == false) {
+		node->children.reserve(childCount < 64 ? childCount : 64);
+	}
+	for(uint32 i = 0; i < childCount && reader.hasFailed() == false; ++i) {
+		XmlNode *child = decodeNode(reader, strings, depth + 1);
+		if(child == NULL) {
+			delete node;
+			return NULL;
+		}
+		node->children.push_back(child);
+	}
+
+	if(reader.hasFailed() == true) {
+		delete node;
+		return NULL;
+	}
+	return node;
+}
+
+XmlNode *XmlBinaryCache::decodeTree(const string &data) {
+	VarintReader reader((const unsigned char *)data.data(), (int)data.size());
+
+	uint32 stringCount = reader.readUInt();
+	// every string takes at least its length byte
+	if(reader.hasFailed() == true || stringCount > data.size()) {
+		return NULL;
+	}
+	std::vector<string> strings(stringCount);
+	for(uint32 i = 0; i < stringCount && reader.hasFailed() == false; ++i) {
+		strings[i] = reader.readString();
+	}
+	if(reader.hasFailed() == true) {
+		return NULL;
+	}
+
+	XmlNode *rootNode = decodeNode(reader, strings, 0);
+	if(rootNode != NULL && reader.isAtEnd() == false) {
+		delete rootNode;
+		rootNode = NULL;
+	}
+	return rootNode;
+}
+
+bool XmlBinaryCache::load() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	entries.clear();
+	dirty = false;
+
+	if(file == "" || fileExists(file) == false) {
+		return false;
+	}
+
+	// one read for the whole file
+	std::vector<unsigned char> buffer;
+#ifdef WIN32
+	FILE *fp = _wfopen(utf8_decode(file).c_str(), L"rb");
+#else
+	FILE *fp = fopen(file.c_str(), "rb");
+#endif
+	if(fp == NULL) {
+		return false;
+	}
+	off_t fileSize = getFileSize(file);
+	if(fileSize > 0) {
+		buffer.resize((size_t)fileSize);
+		if(fread(&buffer[0], 1, buffer.size(), fp) != buffer.size()) {
+			buffer.clear();
+		}
+	}
+	fclose(fp);
+	if(buffer.empty() == true) {
+		dirty = true;
+		return false;
+	}
+
+	VarintReader reader(&buffer[0], (int)buffer.size());
+	if(reader.readFixedUInt() != cacheFileMagic ||
+		reader.readUInt() != cacheVersion ||
+		reader.readFixedUInt() != contentChecksum) {
+		if(SystemFlags::VERBOSE_MODE_ENABLED) printf("XML cache [%s] is stale, rebuilding it\n",file.c_str());
+		dirty = true;
+		return false;
+	}
+
+	uint32 entryCount = reader.readUInt();
+	for(uint32 i = 0; i < entryCount && reader.hasFailed() == false; ++i) {
+		string path = reader.readString();
+		Entry entry;
+		entry.fileTime						= readInt64(reader);
+		entry.fileSize						= readInt64(reader);
+		entry.tagChecksum					= reader.readFixedUInt();
+		entry.skipUpdatePathClimbingParts	= (reader.readByte() != 0);
+		entry.data							= reader.readString();
+		entry.used							= false;
+		if(reader.hasFailed() == false) {
+			entries[path] = entry;
+		}
+	}
+	if(reader.hasFailed() == true || reader.isAtEnd() == false) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] XML cache [%s] is damaged, rebuilding it\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,file.c_str());
+		entries.clear();
+		dirty = true;
+		return false;
+	}
+
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("XML cache [%s] has %d files\n",file.c_str(),(int)entries.size());
+	return true;
+}
+
+bool XmlBinaryCache::save() {
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	if(dirty == false || file == "") {
+		return true;
+	}
+
+	VarintWriter writer;
+	writer.writeFixedUInt(cacheFileMagic);
+	writer.writeUInt(cacheVersion);
+	writer.writeFixedUInt(contentChecksum);
+
+	std::vector<std::map<string,Entry>::const_iterator> keep;
+	for(std::map<string,Entry>::const_iterator iterMap = entries.begin();
+			iterMap != entries.end(); ++iterMap) {
+		if(iterMap->second.used == true || fileExists(iterMap->first) == true) {
+			keep.push_back(iterMap);
+		}
+	}
+	writer.writeUInt((uint32)keep.size());
+	for(unsigned int i = 0; i < keep.size(); ++i) {
+		const Entry &entry = keep[i]->second;
+		writer.writeString(keep[i]->first);
+		writeInt64(writer, entry.fileTime);
+		writeInt64(writer, entry.fileSize);
+		writer.writeFixedUInt(entry.tagChecksum);
+		writer.writeByte(entry.skipUpdatePathClimbingParts ? 1 : 0);
+		writer.writeString(entry.data);
+	}
+
+	string tempFile = file + ".tmp";
+#ifdef WIN32
+	FILE *fp = _wfopen(utf8_decode(tempFile).c_str(), L"wb");
+#else
+	FILE *fp = fopen(tempFile.c_str(), "wb");
+#endif
+	if(fp == NULL) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] cannot write XML cache [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,tempFile.c_str());
+		return false;
+	}
+	const std::vector<unsigned char> &buffer = writer.getBuffer();
+	bool result = (fwrite(&buffer[0], 1, buffer.size(), fp) == buffer.size());
+	result = (fclose(fp) == 0 && result);
+
+	// rename does not replace an existing file everywhere
+	if(result == true && fileExists(file) == true) {
+		removeFile(file);
+	}
+	result = (result == true && renameFile(tempFile, file) == true);
+	if(result == true) {
+		dirty = false;
+	}
+
+	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("XML cache [%s] saved %d files in %d bytes, %d hits %d misses\n",file.c_str(),(int)keep.size(),(int)buffer.size(),hitCount,missCount);
+	return result;
+}
+
+XmlNode *XmlBinaryCache::getTree(const string &path, const std::map<string,string> &mapTagReplacementValues,
+		bool skipUpdatePathClimbingParts) {
+	// stat the file before taking the lock, other loaders keep going
+	int64 fileTime = (int64)getFileModificationTime(path);
+	int64 fileSize = (int64)getFileSize(path);
+	uint32 tagChecksum = getTagChecksum(mapTagReplacementValues);
+
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	std::map<string,Entry>::iterator iterFind = entries.find(path);
+	if(iterFind == entries.end() ||
+		iterFind->second.fileTime != fileTime ||
+		iterFind->second.fileSize != fileSize ||
+		iterFind->second.skipUpdatePathClimbingParts != skipUpdatePathClimbingParts ||
+		iterFind->second.tagChecksum != tagChecksum) {
+		missCount++;
+		return NULL;
+	}
+	iterFind->second.used = true;
+	// decode a copy so other loaders can replace the entry meanwhile
+	string data = iterFind->second.data;
+	safeMutex.ReleaseLock();
+
+	XmlNode *rootNode = decodeTree(data);
+
+	safeMutex.Lock();
+	if(rootNode == NULL) {
+		SystemFlags::OutputDebug(SystemFlags::debugError,"In [%s::%s Line: %d] XML cache entry for [%s] is damaged\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,path.c_str());
+		missCount++;
+		return NULL;
+	}
+	hitCount++;
+	return rootNode;
+}
+
+void XmlBinaryCache::addTree(const string &path, const std::map<string,string> &mapTagReplacementValues,
+		bool skipUpdatePathClimbingParts, const XmlNode *rootNode) {
+	if(rootNode == NULL) {
+		return;
+	}
+	Entry entry;
+	entry.fileTime						= (int64)getFileModificationTime(path);
+	entry.fileSize						= (int64)getFileSize(path);
+	entry.tagChecksum					= getTagChecksum(mapTagReplacementValues);
+	entry.skipUpdatePathClimbingParts	= skipUpdatePathClimbingParts;
+	entry.data							= encodeTree(rootNode);
+	entry.used							= true;
+
+	MutexSafeWrapper safeMutex(mutex,CODE_AT_LINE);
+	entries[path] = entry;
+	dirty = true;
+}
+
+}}//end namespace
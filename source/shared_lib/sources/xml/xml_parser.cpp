@@ -11,11 +11,14 @@
 
 #include "data_types.h"
 #include "xml_parser.h"
+#include "xml_binary_cache.h"
+#include "xml_arena.h"
 
 #include <fstream>
 #include <stdexcept>
 #include <vector>
 #include <algorithm>
+#include <iterator>
 
 #include "conversion.h"
 
@@ -340,7 +343,7 @@ XmlIoRapid::~XmlIoRapid() {
 }
 
 XmlNode *XmlIoRapid::load(const string &path, const std::map<string,string> &mapTagReplacementValues,
-		bool noValidation,bool skipStackTrace,bool skipUpdatePathClimbingParts) {
+		bool noValidation,bool skipStackTrace,bool skipUpdatePathClimbingParts,XmlArena *arena) {
 	bool showPerfStats = SystemFlags::VERBOSE_MODE_ENABLED;
 	Chrono chrono;
 	chrono.start();
@@ -387,9 +390,16 @@ XmlNode *XmlIoRapid::load(const string &path, const std::map<string,string> &map
         }
         //printf("File size is: " MG_I64_SPECIFIER " for [%s]\n",file_size,path.c_str());
 
-        // Load data and add terminating 0
-        vector<char> buffer;
-        buffer.resize((unsigned int)file_size + 100);
+        // Load data and add terminating 0, an arena keeps the text
+        // because its attributes point into it
+        vector<char> localBuffer;
+        vector<char> &buffer = (arena != NULL ? arena->getBuffer() : localBuffer);
+        if(arena != NULL) {
+        	arena->setBufferSize((unsigned int)file_size + 100);
+        }
+        else {
+        	buffer.resize((unsigned int)file_size + 100);
+        }
         xmlFile.read(&buffer.front(), static_cast<streamsize>(file_size));
         buffer[(unsigned int)file_size] = 0;
 
@@ -406,7 +416,9 @@ XmlNode *XmlIoRapid::load(const string &path, const std::map<string,string> &map
 
         if(showPerfStats) printf("In [%s::%s Line: %d] took msecs: " MG_I64_SPECIFIER "\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
 
-		rootNode= new XmlNode(doc.first_node(),mapTagReplacementValues, skipUpdatePathClimbingParts);
+		rootNode= (arena != NULL ?
+				XmlNode::newArenaNode(arena, doc.first_node(),mapTagReplacementValues, skipUpdatePathClimbingParts) :
+				new XmlNode(doc.first_node(),mapTagReplacementValues, skipUpdatePathClimbingParts));
 
 		if(showPerfStats) printf("In [%s::%s Line: %d] took msecs: " MG_I64_SPECIFIER "\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,chrono.getMillis());
 
@@ -444,6 +456,30 @@ XmlNode *XmlIoRapid::load(const string &path, const std::map<string,string> &map
 	return rootNode;
 }
 
+static void buildXmlDocument(xml_document<> &doc, const XmlNode *node) {
+	// xml declaration
+	xml_node<>* decl = doc.allocate_node(node_declaration);
+	decl->append_attribute(doc.allocate_attribute(doc.allocate_string("version"), doc.allocate_string("1.0")));
+	decl->append_attribute(doc.allocate_attribute(doc.allocate_string("encoding"), doc.allocate_string("utf-8")));
+	decl->append_attribute(doc.allocate_attribute(doc.allocate_string("standalone"), doc.allocate_string("no")));
+	doc.append_node(decl);
+
+	// root node
+	xml_node<>* root = doc.allocate_node(node_element, doc.allocate_string(node->getName().c_str()));
+	for(unsigned int i = 0; i < node->getAttributeCount() ; ++i){
+		XmlAttribute *attr = node->getAttribute(i);
+		root->append_attribute(doc.allocate_attribute(
+				doc.allocate_string(attr->getName().c_str()),
+				doc.allocate_string(attr->getValue("",false).c_str())));
+	}
+	doc.append_node(root);
+
+	// child nodes
+	for(unsigned int i = 0; i < node->getChildCount(); ++i) {
+		root->append_node(node->getChild(i)->buildElement(&doc));
+	}
+}
+
 void XmlIoRapid::save(const string &path, const XmlNode *node){
 	try {
 		if(node == NULL) {
@@ -451,28 +487,7 @@ void XmlIoRapid::save(const string &path, const XmlNode *node){
 		}
 
 		xml_document<> doc;
-
-		// xml declaration
-		xml_node<>* decl = doc.allocate_node(node_declaration);
-		decl->append_attribute(doc.allocate_attribute(doc.allocate_string("version"), doc.allocate_string("1.0")));
-		decl->append_attribute(doc.allocate_attribute(doc.allocate_string("encoding"), doc.allocate_string("utf-8")));
-		decl->append_attribute(doc.allocate_attribute(doc.allocate_string("standalone"), doc.allocate_string("no")));
-		doc.append_node(decl);
-
-		// root node
-		xml_node<>* root = doc.allocate_node(node_element, doc.allocate_string(node->getName().c_str()));
-		for(unsigned int i = 0; i < node->getAttributeCount() ; ++i){
-			XmlAttribute *attr = node->getAttribute(i);
-			root->append_attribute(doc.allocate_attribute(
-					doc.allocate_string(attr->getName().c_str()),
-					doc.allocate_string(attr->getValue("",false).c_str())));
-		}
-		doc.append_node(root);
-
-		// child nodes
-		for(unsigned int i = 0; i < node->getChildCount(); ++i) {
-			root->append_node(node->getChild(i)->buildElement(&doc));
-		}
+		buildXmlDocument(doc, node);
 
 //		std::string xml_as_string;
 //		// watch for name collisions here, print() is a very common function name!
@@ -511,11 +526,64 @@ void XmlIoRapid::save(const string &path, const XmlNode *node){
 	}
 }
 
+XmlNode *XmlIoRapid::loadFromString(const string &xmlData, const std::map<string,string> &mapTagReplacementValues,
+		bool skipUpdatePathClimbingParts,XmlArena *arena) {
+	XmlNode *rootNode = NULL;
+	try {
+		if(xmlData.empty() == true) {
+			throw megaglest_runtime_error("Invalid empty XML data");
+		}
+
+		// rapidxml parses in place and needs a terminating 0
+		vector<char> localBuffer;
+		vector<char> &buffer = (arena != NULL ? arena->getBuffer() : localBuffer);
+		if(arena != NULL) {
+			arena->setBufferSize(xmlData.size() + 1);
+		}
+		else {
+			buffer.resize(xmlData.size() + 1);
+		}
+		copy(xmlData.begin(),xmlData.end(),buffer.begin());
+		buffer[xmlData.size()] = 0;
+		replaceAllBetweenTokens(buffer, "<!--","-->", "", true);
+
+		xml_document<> doc;
+		doc.parse<parse_no_data_nodes|parse_validate_closing_tags>(&buffer.front());
+
+		rootNode= (arena != NULL ?
+				XmlNode::newArenaNode(arena, doc.first_node(),mapTagReplacementValues, skipUpdatePathClimbingParts) :
+				new XmlNode(doc.first_node(),mapTagReplacementValues, skipUpdatePathClimbingParts));
+	}
+	catch(parse_error& ex) {
+		throw megaglest_runtime_error(string("Error loading XML from memory\nMessage: ") + ex.what(),true);
+	}
+	catch(megaglest_runtime_error& ex) {
+		throw megaglest_runtime_error(string("Error loading XML from memory\nMessage: ") + ex.what(),!ex.wantStackTrace());
+	}
+	return rootNode;
+}
+
+string XmlIoRapid::saveToString(const XmlNode *node) {
+	if(node == NULL) {
+		throw megaglest_runtime_error("node == NULL during save!");
+	}
+
+	xml_document<> doc;
+	buildXmlDocument(doc, node);
+
+	string result;
+	print(std::back_inserter(result), doc, print_no_indenting);
+	return result;
+}
+
 // =====================================================
 //	class XmlTree
 // =====================================================
 XmlTree::XmlTree(xml_engine_parser_type engine_type) {
 	rootNode= NULL;
+	loadThreadId= 0;
+	arena= NULL;
+	arenaEnabled= true;
 
 	switch(engine_type) {
 #if defined(WANT_XERCES)
@@ -561,16 +629,20 @@ void XmlTree::load(const string &path, const std::map<string,string> &mapTagRepl
 		Mutex &mutex = CacheManager::getMutexForItem<LoadStack>(loadStackCacheName);
 		MutexSafeWrapper safeMutex(&mutex);
 
+		unsigned long threadId = Thread::getCurrentThreadId();
 		for(LoadStack::iterator it= loadStack.begin(); it!= loadStack.end(); ++it){
-			if((*it)->loadPath == path){
+			if((*it)->loadThreadId == threadId && (*it)->loadPath == path){
 				throw megaglest_runtime_error(path + " recursively included");
 			}
 		}
+		loadPath = path;
+		loadThreadId = threadId;
 		loadStack.push_back(this);
 		safeMutex.ReleaseLock();
 	}
-
-	loadPath = path;
+	else {
+		loadPath = path;
+	}
 
 #if defined(WANT_XERCES)
 	if(this->engine_type == XML_XERCES_ENGINE) {
@@ -579,7 +651,20 @@ void XmlTree::load(const string &path, const std::map<string,string> &mapTagRepl
 	else
 #endif
 	{
-		this->rootNode= XmlIoRapid::getInstance().load(path, mapTagReplacementValues, noValidation,skipStackTrace, this->skipUpdatePathClimbingParts);
+		// a techtree being loaded may already have this tree parsed
+		XmlBinaryCache *binaryCache = XmlBinaryCache::getActive();
+		if(binaryCache != NULL) {
+			this->rootNode= binaryCache->getTree(path, mapTagReplacementValues, this->skipUpdatePathClimbingParts);
+		}
+		if(this->rootNode == NULL) {
+			if(arenaEnabled == true) {
+				arena= new XmlArena();
+			}
+			this->rootNode= XmlIoRapid::getInstance().load(path, mapTagReplacementValues, noValidation,skipStackTrace, this->skipUpdatePathClimbingParts, arena);
+			if(binaryCache != NULL) {
+				binaryCache->addTree(path, mapTagReplacementValues, this->skipUpdatePathClimbingParts, this->rootNode);
+			}
+		}
 	}
 
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("In [%s::%s Line: %d] about to load [%s]\n",extractFileFromDirectoryPath(__FILE__).c_str(),__FUNCTION__,__LINE__,path.c_str());
@@ -598,6 +683,27 @@ void XmlTree::save(const string &path) {
 	}
 }
 
+void XmlTree::loadFromString(const string &xmlData, const std::map<string,string> &mapTagReplacementValues) {
+	clearRootNode();
+	if(this->engine_type != XML_RAPIDXML_ENGINE) {
+		throw megaglest_runtime_error("Loading XML from memory requires the rapidxml engine");
+	}
+	// nothing on disk can include itself, so the load stack is not needed
+	this->skipStackCheck = true;
+	loadPath = "";
+	if(arenaEnabled == true) {
+		arena= new XmlArena();
+	}
+	this->rootNode= XmlIoRapid::getInstance().loadFromString(xmlData, mapTagReplacementValues, this->skipUpdatePathClimbingParts, arena);
+}
+
+string XmlTree::saveToString() {
+	if(this->engine_type != XML_RAPIDXML_ENGINE) {
+		throw megaglest_runtime_error("Saving XML to memory requires the rapidxml engine");
+	}
+	return XmlIoRapid::getInstance().saveToString(rootNode);
+}
+
 void XmlTree::clearRootNode() {
 	if(this->skipStackCheck == false) {
 		LoadStack &loadStack = CacheManager::getCachedItem<LoadStack>(loadStackCacheName);
@@ -611,8 +717,12 @@ void XmlTree::clearRootNode() {
 		safeMutex.ReleaseLock();
 	}
 
-	delete rootNode;
+	// nodes of an arena only need their strings and lists freed, the
+	// arena then gives back all of its blocks at once
+	XmlNode::release(rootNode);
 	rootNode=NULL;
+	delete arena;
+	arena=NULL;
 }
 
 XmlTree::~XmlTree() {
@@ -626,7 +736,7 @@ XmlTree::~XmlTree() {
 
 #if defined(WANT_XERCES)
 
-XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacementValues): superNode(NULL) {
+XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacementValues): superNode(NULL), arena(NULL) {
     if(node == NULL || node->getNodeName() == NULL) {
         throw megaglest_runtime_error("XML structure seems to be corrupt!",true);
     }
@@ -676,15 +786,42 @@ XmlNode::XmlNode(DOMNode *node, const std::map<string,string> &mapTagReplacement
 #endif
 
 XmlNode::XmlNode(xml_node<> *node, const std::map<string,string> &mapTagReplacementValues,
-		bool skipUpdatePathClimbingParts) : superNode(NULL) {
+		bool skipUpdatePathClimbingParts) : superNode(NULL), arena(NULL) {
+	try {
+		init(node, mapTagReplacementValues, skipUpdatePathClimbingParts);
+	}
+	catch(...) {
+		releaseContent();
+		throw;
+	}
+}
+
+XmlNode::XmlNode(XmlArena *arena) : superNode(NULL), arena(arena) {
+}
+
+XmlNode *XmlNode::newArenaNode(XmlArena *arena, xml_node<> *node, const std::map<string,string> &mapTagReplacementValues,
+		bool skipUpdatePathClimbingParts) {
+	arena->setTagReplacementValues(mapTagReplacementValues);
+
+	XmlNode *rootNode = arena->newNode();
+	try {
+		rootNode->init(node, mapTagReplacementValues, skipUpdatePathClimbingParts);
+	}
+	catch(...) {
+		release(rootNode);
+		throw;
+	}
+	return rootNode;
+}
+
+void XmlNode::init(xml_node<> *node, const std::map<string,string> &mapTagReplacementValues,
+		bool skipUpdatePathClimbingParts) {
 	if(node == NULL || node->name() == NULL) {
         throw megaglest_runtime_error("XML structure seems to be corrupt!",true);
     }
 
 	//get name
 	name = node->name();
-	children.reserve(1000);
-	attributes.reserve(1000);
 
 	//check document
 	if(node->type() == node_document) {
@@ -693,20 +830,36 @@ XmlNode::XmlNode(xml_node<> *node, const std::map<string,string> &mapTagReplacem
 
 	if(SystemFlags::VERBOSE_MODE_ENABLED) printf("Found XML Node\nName [%s]\nValue [%s]\n",name.c_str(),node->value());
 
-	//check children
+	//check children, they are added before they load so a failing one is freed with the rest
+	size_t childCount = 0;
+	for(xml_node<> *currentNode = node->first_node();
+			currentNode; currentNode = currentNode->next_sibling()) {
+		if(currentNode->type() == node_element) {
+			childCount++;
+		}
+	}
+	children.reserve(childCount);
 	for(xml_node<> *currentNode = node->first_node();
 			currentNode; currentNode = currentNode->next_sibling()) {
 		if(currentNode != NULL && currentNode->type() == node_element) {
-			XmlNode *xmlNode= new XmlNode(currentNode, mapTagReplacementValues, skipUpdatePathClimbingParts);
+			XmlNode *xmlNode= (arena != NULL ? arena->newNode() : new XmlNode((XmlArena *)NULL));
 			children.push_back(xmlNode);
+			xmlNode->init(currentNode, mapTagReplacementValues, skipUpdatePathClimbingParts);
 		}
     }
 
 	//check attributes
+	size_t attributeCount = 0;
 	for (xml_attribute<> *attr = node->first_attribute();
 			attr; attr = attr->next_attribute()) {
-		XmlAttribute *xmlAttribute= new XmlAttribute(attr, mapTagReplacementValues);
+		attributeCount++;
+	}
+	attributes.reserve(attributeCount);
+	for (xml_attribute<> *attr = node->first_attribute();
+			attr; attr = attr->next_attribute()) {
+		XmlAttribute *xmlAttribute= (arena != NULL ? arena->newAttribute() : new XmlAttribute((XmlArena *)NULL));
 		attributes.push_back(xmlAttribute);
+		xmlAttribute->init(attr, mapTagReplacementValues);
 	}
 
 	//get value
@@ -718,7 +871,9 @@ XmlNode::XmlNode(xml_node<> *node, const std::map<string,string> &mapTagReplacem
 //			printf("\n----------------------\n** XML!! WILL REPLACE [%s]\n",xmlText.c_str());
 //			debugReplace = true;
 //		}
-		Properties::applyTagsToValue(xmlText,&mapTagReplacementValues, skipUpdatePathClimbingParts);
+		if(arena == NULL || arena->mayContainTags(node->value()) == true) {
+			Properties::applyTagsToValue(xmlText,&mapTagReplacementValues, skipUpdatePathClimbingParts);
+		}
 //		if(debugReplace) {
 //			printf("\n\n** XML!! REPLACED WITH [%s]\n===================\n",xmlText.c_str());
 //		}
@@ -726,21 +881,36 @@ XmlNode::XmlNode(xml_node<> *node, const std::map<string,string> &mapTagReplacem
 	}
 }
 
-XmlNode::XmlNode(const string &name): superNode(NULL) {
+XmlNode::XmlNode(const string &name): superNode(NULL), arena(NULL) {
 	this->name= name;
 }
 
 XmlNode::~XmlNode() {
+	releaseContent();
+}
+
+void XmlNode::releaseContent() {
 	for(unsigned int i=0; i<children.size(); ++i) {
-		delete children[i];
+		release(children[i]);
 	}
 	children.clear();
 	for(unsigned int i=0; i<attributes.size(); ++i) {
-		delete attributes[i];
+		XmlAttribute::release(attributes[i]);
 	}
 	attributes.clear();
 }
 
+void XmlNode::release(XmlNode *node) {
+	if(node != NULL) {
+		if(node->arena != NULL) {
+			node->~XmlNode();
+		}
+		else {
+			delete node;
+		}
+	}
+}
+
 XmlAttribute *XmlNode::getAttribute(unsigned int i) const {
 	if(i >= attributes.size()) {
 		throw megaglest_runtime_error(getName()+" node doesn't have " + uIntToStr(i) + " attributes",true);
@@ -750,7 +920,7 @@ XmlAttribute *XmlNode::getAttribute(unsigned int i) const {
 
 XmlAttribute *XmlNode::getAttribute(const string &name,bool mustExist) const {
 	for(unsigned int i = 0; i < attributes.size(); ++i) {
-		if(attributes[i]->getName() == name) {
+		if(attributes[i]->getNameView() == name) {
 			return attributes[i];
 		}
 	}
@@ -764,7 +934,7 @@ XmlAttribute *XmlNode::getAttribute(const string &name,bool mustExist) const {
 bool XmlNode::hasAttribute(const string &name) const {
 	bool result = false;
 	for(unsigned int i = 0; i < attributes.size(); ++i) {
-		if(attributes[i]->getName() == name) {
+		if(attributes[i]->getNameView() == name) {
 			result = true;
 			break;
 		}
@@ -776,7 +946,7 @@ int XmlNode::clearChild(const string &childName) {
 	int clearChildCount = 0;
 	for(int i = (int)children.size()-1; i >= 0; --i) {
 		if(children[i]->getName() == childName) {
-			delete children[i];
+			release(children[i]);
 			children.erase(children.begin()+i);
 			clearChildCount++;
 		}
@@ -937,7 +1107,7 @@ xml_node<>* XmlNode::buildElement(xml_document<> *document) const {
 	for(unsigned int i = 0; i < attributes.size(); ++i) {
 		node->append_attribute(
 				document->allocate_attribute(
-						document->allocate_string(attributes[i]->getName().c_str()),
+						document->allocate_string(attributes[i]->getNameView().c_str()),
 						document->allocate_string(attributes[i]->getValue().c_str())));
 	}
 
@@ -978,97 +1148,143 @@ XmlAttribute::XmlAttribute(DOMNode *attribute, const std::map<string,string> &ma
 
 	skipRestrictionCheck 			= false;
 	usesCommondata 					= false;
-	this->mapTagReplacementValues 	= mapTagReplacementValues;
+	arena							= NULL;
 	char str[strSize]				= "";
 
 	XMLString::transcode(attribute->getNodeValue(), str, strSize-1);
 	value= str;
 	usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-	skipRestrictionCheck = Properties::applyTagsToValue(this->value,&this->mapTagReplacementValues);
+	skipRestrictionCheck = Properties::applyTagsToValue(this->value,&mapTagReplacementValues);
+	valueView= XmlStringView(value);
 
 	XMLString::transcode(attribute->getNodeName(), str, strSize-1);
-	name= str;
+	setName(str);
 }
 
 #endif
 
-XmlAttribute::XmlAttribute(xml_attribute<> *attribute, const std::map<string,string> &mapTagReplacementValues) {
+XmlAttribute::XmlAttribute(XmlArena *arena) {
+	skipRestrictionCheck 			= false;
+	usesCommondata 					= false;
+	this->arena						= arena;
+}
+
+void XmlAttribute::init(xml_attribute<> *attribute, const std::map<string,string> &mapTagReplacementValues) {
 	if(attribute == NULL || attribute->name() == NULL) {
         throw megaglest_runtime_error("XML attribute seems to be corrupt!");
     }
 
-	skipRestrictionCheck 			= false;
-	usesCommondata 					= false;
-	if(mapTagReplacementValues.size() > 0) {
-		this->mapTagReplacementValues 	= mapTagReplacementValues;
+	// the tags are only looked for in the text that may hold them
+	if(arena != NULL && arena->mayContainTags(attribute->value()) == false) {
+		nameView= XmlStringView(attribute->name(), attribute->name_size());
+		valueView= XmlStringView(attribute->value(), attribute->value_size());
+		return;
 	}
+
 	//char str[strSize]				= "";
 
 	//XMLString::transcode(attribute->getNodeValue(), str, strSize-1);
 	value= attribute->value();
 	usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-	skipRestrictionCheck = Properties::applyTagsToValue(this->value,&this->mapTagReplacementValues);
+	skipRestrictionCheck = Properties::applyTagsToValue(this->value,&mapTagReplacementValues);
+	valueView= XmlStringView(value);
 
 	//XMLString::transcode(attribute->getNodeName(), str, strSize-1);
-	name= attribute->name();
+	if(arena != NULL) {
+		nameView= XmlStringView(attribute->name(), attribute->name_size());
+	}
+	else {
+		setName(attribute->name());
+	}
+}
+
+XmlAttribute::XmlAttribute(xml_attribute<> *attribute, const std::map<string,string> &mapTagReplacementValues) {
+	skipRestrictionCheck 			= false;
+	usesCommondata 					= false;
+	arena							= NULL;
+	init(attribute, mapTagReplacementValues);
 }
 
 XmlAttribute::XmlAttribute(const string &name, const string &value, const std::map<string,string> &mapTagReplacementValues) {
 	skipRestrictionCheck 			= false;
 	usesCommondata 					= false;
-	if(mapTagReplacementValues.size() > 0) {
-		this->mapTagReplacementValues 	= mapTagReplacementValues;
-	}
-	this->name						= name;
+	arena							= NULL;
+	setName(name);
 	this->value						= value;
 
 	usesCommondata = ((value.find("$COMMONDATAPATH") != string::npos) || (value.find("%%COMMONDATAPATH%%") != string::npos));
-	skipRestrictionCheck = Properties::applyTagsToValue(this->value,&this->mapTagReplacementValues);
+	skipRestrictionCheck = Properties::applyTagsToValue(this->value,&mapTagReplacementValues);
+	valueView= XmlStringView(this->value);
+}
+
+XmlAttribute::XmlAttribute(const string &name, const string &value, bool skipRestrictionCheck, bool usesCommondata) {
+	setName(name);
+	this->value						= value;
+	this->valueView					= XmlStringView(this->value);
+	this->skipRestrictionCheck		= skipRestrictionCheck;
+	this->usesCommondata			= usesCommondata;
+	this->arena						= NULL;
+}
+
+void XmlAttribute::setName(const string &name) {
+	this->name						= name;
+	this->nameView					= XmlStringView(this->name);
+}
+
+void XmlAttribute::release(XmlAttribute *attribute) {
+	if(attribute != NULL) {
+		if(attribute->arena != NULL) {
+			attribute->~XmlAttribute();
+		}
+		else {
+			delete attribute;
+		}
+	}
 }
 
 bool XmlAttribute::getBoolValue() const {
-	if(value == "true") {
+	if(valueView == "true") {
 		return true;
 	}
-	else if(value == "false") {
+	else if(valueView == "false") {
 		return false;
 	}
 	else {
-		throw megaglest_runtime_error("Not a valid bool value (true or false): " +getName()+": "+ value,true);
+		throw megaglest_runtime_error("Not a valid bool value (true or false): " +getName()+": "+ valueView.str(),true);
 	}
 }
 
 int XmlAttribute::getIntValue() const {
-	return strToInt(value);
+	return strToInt(valueView.str());
 }
 
 uint32 XmlAttribute::getUIntValue() const {
-	return strToUInt(value);
+	return strToUInt(valueView.str());
 }
 
 int XmlAttribute::getIntValue(int min, int max) const {
-	int i= strToInt(value);
+	int i= strToInt(valueView.str());
 	if(i<min || i>max){
-		throw megaglest_runtime_error("Xml Attribute int out of range: " + getName() + ": " + value,true);
+		throw megaglest_runtime_error("Xml Attribute int out of range: " + getName() + ": " + valueView.str(),true);
 	}
 	return i;
 }
 
 float XmlAttribute::getFloatValue() const{
-	return strToFloat(value);
+	return strToFloat(valueView.str());
 }
 
 float XmlAttribute::getFloatValue(float min, float max) const{
-	float f= strToFloat(value);
+	float f= strToFloat(valueView.str());
 	//printf("getFloatValue f = %.10f [%s]\n",f,value.c_str());
 	if(f<min || f>max){
-		throw megaglest_runtime_error("Xml attribute float out of range: " + getName() + ": " + value,true);
+		throw megaglest_runtime_error("Xml attribute float out of range: " + getName() + ": " + valueView.str(),true);
 	}
 	return f;
 }
 
 const string XmlAttribute::getValue(string prefixValue, bool trimValueWithStartingSlash) const {
-	string result = value;
+	string result = valueView.str();
 	if(skipRestrictionCheck == false && usesCommondata == false) {
 		if(trimValueWithStartingSlash == true) {
 			trimPathWithStartingSlash(result);
@@ -1082,16 +1298,17 @@ const string XmlAttribute::getRestrictedValue(string prefixValue, bool trimValue
 	if(skipRestrictionCheck == false && usesCommondata == false) {
 		const string allowedCharacters = "abcdefghijklmnopqrstuvwxyz1234567890._-/";
 
-		for(unsigned int i= 0; i<value.size(); ++i){
+		const char *value = valueView.c_str();
+		for(unsigned int i= 0; i<valueView.size(); ++i){
 			if(allowedCharacters.find(value[i])==string::npos){
 				throw megaglest_runtime_error(
-					string("The string \"" + value + "\" contains a character that is not allowed: \"") + value[i] +
+					string("The string \"" + valueView.str() + "\" contains a character that is not allowed: \"") + value[i] +
 					"\"\nFor portability reasons the only allowed characters in this field are: " + allowedCharacters,true);
 			}
 		}
 	}
 
-	string result = value;
+	string result = valueView.str();
 	if(skipRestrictionCheck == false && usesCommondata == false) {
 		if(trimValueWithStartingSlash == true) {
 			trimPathWithStartingSlash(result);
@@ -1103,6 +1320,7 @@ const string XmlAttribute::getRestrictedValue(string prefixValue, bool trimValue
 
 void XmlAttribute::setValue(string val) {
 	value = val;
+	valueView = XmlStringView(value);
 }
 
 }}//end namespace
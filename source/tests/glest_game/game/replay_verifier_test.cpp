@@ -0,0 +1,85 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "replay_verifier.h"
+
+using namespace Glest::Game;
+using namespace Shared::Xml;
+
+//
+// Tests for the saved game checksums a replay is verified against
+//
+class ReplayVerifierTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ReplayVerifierTest );
+
+	CPPUNIT_TEST( test_save_load );
+	CPPUNIT_TEST( test_mismatched_factions );
+	CPPUNIT_TEST( test_load_without_checksums );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+	static vector<uint32> getCRCs(uint32 first, uint32 second, uint32 third) {
+		vector<uint32> result;
+		result.push_back(first);
+		result.push_back(second);
+		result.push_back(third);
+		return result;
+	}
+
+public:
+
+	void test_save_load() {
+		ReplayVerifier saved;
+		saved.setFactionCRCs(getCRCs(1, 4000000000u, 0));
+
+		XmlTree xmlTree;
+		xmlTree.init("Game");
+		std::map<string,string> mapTagReplacements;
+		saved.saveGame(xmlTree.getRootNode(), mapTagReplacements);
+		CPPUNIT_ASSERT_EQUAL( 3, (int)xmlTree.getRootNode()->getChildList("FactionCRC").size() );
+
+		ReplayVerifier loaded;
+		loaded.loadGame(xmlTree.getRootNode());
+		CPPUNIT_ASSERT( loaded.hasFactionCRCs() == true );
+		CPPUNIT_ASSERT_EQUAL( (uint32)1, loaded.getFactionCRC(0) );
+		CPPUNIT_ASSERT_EQUAL( (uint32)4000000000u, loaded.getFactionCRC(1) );
+		CPPUNIT_ASSERT_EQUAL( (uint32)0, loaded.getFactionCRC(2) );
+		CPPUNIT_ASSERT( loaded.getMismatchedFactions(getCRCs(1, 4000000000u, 0)).empty() == true );
+	}
+	void test_mismatched_factions() {
+		ReplayVerifier verifier;
+		vector<uint32> crcs = getCRCs(10, 20, 30);
+		crcs.pop_back();
+		verifier.setFactionCRCs(crcs);
+
+		// the third faction has no saved checksum so compares against 0
+		vector<int> mismatches = verifier.getMismatchedFactions(getCRCs(10, 21, 30));
+		CPPUNIT_ASSERT_EQUAL( 2, (int)mismatches.size() );
+		CPPUNIT_ASSERT_EQUAL( 1, mismatches[0] );
+		CPPUNIT_ASSERT_EQUAL( 2, mismatches[1] );
+		CPPUNIT_ASSERT_EQUAL( (uint32)0, verifier.getFactionCRC(-1) );
+	}
+	void test_load_without_checksums() {
+		XmlTree xmlTree;
+		xmlTree.init("Game");
+		ReplayVerifier verifier;
+		verifier.setFactionCRCs(getCRCs(1, 2, 3));
+		verifier.loadGame(xmlTree.getRootNode());
+		CPPUNIT_ASSERT( verifier.hasFactionCRCs() == false );
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ReplayVerifierTest );
@@ -0,0 +1,101 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+#include <SDL.h>
+#include "sim_benchmark.h"
+
+using namespace Glest::Game;
+
+//
+// Tests for the simulation benchmark sections
+//
+class SimBenchmarkTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( SimBenchmarkTest );
+
+	CPPUNIT_TEST( test_ticks_to_micros );
+	CPPUNIT_TEST( test_section_names );
+	CPPUNIT_TEST( test_nested_timer_counted_once );
+	CPPUNIT_TEST( test_disabled );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+	static void spin(int64 micros) {
+		uint64 start = SimBenchmark::getTicks();
+		while(SimBenchmark::ticksToMicros(SimBenchmark::getTicks() - start) < micros) {
+		}
+	}
+
+public:
+
+	void setUp() {
+		Thread::setMainThreadId();
+		SimBenchmark::reset();
+		SimBenchmark::setEnabled(true);
+	}
+	void tearDown() {
+		SimBenchmark::setEnabled(false);
+		SimBenchmark::reset();
+	}
+
+	void test_ticks_to_micros() {
+		uint64 frequency = SDL_GetPerformanceFrequency();
+		CPPUNIT_ASSERT_EQUAL( (int64)0, SimBenchmark::ticksToMicros(0) );
+		CPPUNIT_ASSERT_EQUAL( (int64)1000000, SimBenchmark::ticksToMicros(frequency) );
+		CPPUNIT_ASSERT_EQUAL( (int64)1500000, SimBenchmark::ticksToMicros(frequency + frequency / 2) );
+		// a day of ticks times a million doesn't fit 64 bits
+		CPPUNIT_ASSERT_EQUAL( (int64)86400 * 1000000, SimBenchmark::ticksToMicros(frequency * 86400) );
+	}
+	void test_section_names() {
+		for(int i = 0; i < sbsCount; ++i) {
+			std::string name = SimBenchmark::getSectionName(static_cast<SimBenchmarkSection>(i));
+			CPPUNIT_ASSERT( name != "Unknown" );
+			for(int j = 0; j < i; ++j) {
+				CPPUNIT_ASSERT( name != SimBenchmark::getSectionName(static_cast<SimBenchmarkSection>(j)) );
+			}
+		}
+		CPPUNIT_ASSERT_EQUAL( std::string("Unknown"), std::string(SimBenchmark::getSectionName(sbsCount)) );
+	}
+	void test_nested_timer_counted_once() {
+		uint64 start = SimBenchmark::getTicks();
+		{
+			SimBenchmarkTimer outer(sbsPathFinding);
+			{
+				SimBenchmarkTimer inner(sbsPathFinding);
+				spin(5000);
+			}
+		}
+		int64 elapsed = SimBenchmark::ticksToMicros(SimBenchmark::getTicks() - start);
+
+		int64 counted = SimBenchmark::getSectionMicros(sbsPathFinding);
+		CPPUNIT_ASSERT( counted >= 5000 );
+		CPPUNIT_ASSERT( counted <= elapsed );
+		CPPUNIT_ASSERT_EQUAL( (int64)0, SimBenchmark::getSectionMicros(sbsAI) );
+
+		SimBenchmark::reset();
+		CPPUNIT_ASSERT_EQUAL( (int64)0, SimBenchmark::getSectionMicros(sbsPathFinding) );
+	}
+	void test_disabled() {
+		SimBenchmark::setEnabled(false);
+		{
+			SimBenchmarkTimer timer(sbsAI);
+			spin(1000);
+		}
+		CPPUNIT_ASSERT_EQUAL( (int64)0, SimBenchmark::getSectionMicros(sbsAI) );
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( SimBenchmarkTest );
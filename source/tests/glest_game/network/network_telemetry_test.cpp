@@ -0,0 +1,148 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "network_telemetry.h"
+
+using namespace Glest::Game;
+
+//
+// Tests for the network telemetry counters
+//
+class NetworkTelemetryTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( NetworkTelemetryTest );
+
+	CPPUNIT_TEST( test_frame_lag_buckets );
+	CPPUNIT_TEST( test_round_trip_echo );
+	CPPUNIT_TEST( test_disabled );
+	CPPUNIT_TEST( test_escape_json );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+	// the histogram fields of one counter in the JSON
+	static string getHistogram(const string &json, const string &name) {
+		size_t start = json.find("\"" + name + "\": {");
+		CPPUNIT_ASSERT( start != string::npos );
+		start = json.find("\"limits\"", start);
+		size_t end = json.find(" }", start);
+		CPPUNIT_ASSERT( start != string::npos && end != string::npos );
+		return json.substr(start, end - start);
+	}
+
+public:
+
+	void setUp() {
+		NetworkTelemetry::setEnabled(true);
+	}
+	void tearDown() {
+		NetworkTelemetry::setEnabled(false);
+	}
+
+	void test_frame_lag_buckets() {
+		NetworkTelemetry telemetry;
+		// a value on a limit goes to that bucket, one above it to the next
+		// and everything past the last limit to the last bucket
+		telemetry.addFrameLag(-2);
+		telemetry.addFrameLag(0);
+		telemetry.addFrameLag(1);
+		telemetry.addFrameLag(3);
+		telemetry.addFrameLag(4);
+		telemetry.addFrameLag(63);
+		telemetry.addFrameLag(64);
+		telemetry.addFrameLag(1000);
+
+		CPPUNIT_ASSERT_EQUAL( string("\"limits\": [0, 1, 3, 7, 15, 31, 63], \"counts\": [2, 1, 1, 1, 0, 0, 1, 2]"),
+				getHistogram(telemetry.getJSONFields(""), "frameLag") );
+	}
+	void test_round_trip_echo() {
+		NetworkTelemetry telemetry;
+		telemetry.addPingSent(1000);
+		// the echo of another ping is not a round trip
+		telemetry.addPingEcho(999);
+		telemetry.addPingEcho(1000);
+		// nor is a second echo of the same one
+		telemetry.addPingEcho(1000);
+
+		string json = telemetry.getJSONFields("");
+		CPPUNIT_ASSERT( json.find("\"roundTripMillis\": { \"samples\": 1,") != string::npos );
+		CPPUNIT_ASSERT_EQUAL( string("\"limits\": [10, 25, 50, 100, 200, 400, 800], \"counts\": [1, 0, 0, 0, 0, 0, 0, 0]"),
+				getHistogram(json, "roundTripMillis") );
+	}
+	void test_disabled() {
+		NetworkTelemetry telemetry;
+		NetworkTelemetry::setEnabled(false);
+		telemetry.addFrameLag(5);
+		telemetry.addSent(nmtPing, 100);
+		telemetry.addWait(1000);
+
+		string json = telemetry.getJSONFields("");
+		CPPUNIT_ASSERT( json.find("\"sent\": {},") != string::npos );
+		CPPUNIT_ASSERT( json.find("\"frameLag\": { \"samples\": 0,") != string::npos );
+		CPPUNIT_ASSERT( json.find("\"wait\": { \"samples\": 0,") != string::npos );
+
+		time_t lastWriteTime = 0;
+		CPPUNIT_ASSERT_EQUAL( false, NetworkTelemetry::isWriteDue(lastWriteTime, 0) );
+	}
+	void test_escape_json() {
+		CPPUNIT_ASSERT_EQUAL( string("plain name"), NetworkTelemetry::escapeJSON("plain name") );
+		CPPUNIT_ASSERT_EQUAL( string("say \\\"hi\\\""), NetworkTelemetry::escapeJSON("say \"hi\"") );
+		CPPUNIT_ASSERT_EQUAL( string("C:\\\\games\\\\"), NetworkTelemetry::escapeJSON("C:\\games\\") );
+		CPPUNIT_ASSERT_EQUAL( string("a\\nb\\rc\\td"), NetworkTelemetry::escapeJSON("a\nb\rc\td") );
+		CPPUNIT_ASSERT_EQUAL( string("\\u0001\\u001f"), NetworkTelemetry::escapeJSON("\x01\x1f") );
+		// utf8 is valid in JSON strings
+		CPPUNIT_ASSERT_EQUAL( string("Mart\xc3\xad\xc3\xb1o"), NetworkTelemetry::escapeJSON("Mart\xc3\xad\xc3\xb1o") );
+	}
+};
+
+//
+// Tests for the per frame network wait averages
+//
+class NetworkWaitStatsTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( NetworkWaitStatsTest );
+
+	CPPUNIT_TEST( test_interval_average );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_interval_average() {
+		NetworkWaitStats stats;
+		time_t now = 1000;
+		// the first wait starts the interval
+		CPPUNIT_ASSERT_EQUAL( false, stats.add(100, now) );
+		CPPUNIT_ASSERT_EQUAL( false, stats.add(500, now) );
+		CPPUNIT_ASSERT_EQUAL( (int64)500, stats.getLastFrameMicros() );
+		CPPUNIT_ASSERT_EQUAL( (int64)0, stats.getAverageMicros() );
+
+		CPPUNIT_ASSERT_EQUAL( true, stats.add(300, now + 1) );
+		CPPUNIT_ASSERT_EQUAL( (int64)300, stats.getAverageMicros() );
+		CPPUNIT_ASSERT_EQUAL( (int64)500, stats.getMaxMicros() );
+		CPPUNIT_ASSERT_EQUAL( 3, stats.getAverageFrames() );
+		CPPUNIT_ASSERT_EQUAL( string("last: 300 us avg: 300 us max: 500 us"), stats.toString() );
+
+		// the next interval starts from nothing
+		CPPUNIT_ASSERT_EQUAL( false, stats.add(0, now + 1) );
+		CPPUNIT_ASSERT_EQUAL( true, stats.add(20, now + 2) );
+		CPPUNIT_ASSERT_EQUAL( (int64)10, stats.getAverageMicros() );
+		CPPUNIT_ASSERT_EQUAL( (int64)20, stats.getMaxMicros() );
+		CPPUNIT_ASSERT_EQUAL( 2, stats.getAverageFrames() );
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( NetworkTelemetryTest );
+CPPUNIT_TEST_SUITE_REGISTRATION( NetworkWaitStatsTest );
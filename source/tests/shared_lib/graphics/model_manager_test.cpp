@@ -0,0 +1,236 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <stdio.h>
+#include <string.h>
+#include "model.h"
+#include "model_manager.h"
+#include "graphics_interface.h"
+#include "graphics_factory.h"
+#include "opengl.h"
+#include "platform_util.h"
+#include "platform_common.h"
+
+using namespace Shared::Graphics;
+using namespace Shared::Graphics::Gl;
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+
+typedef std::map<string,vector<pair<string, string> > > LoadedFileList;
+
+class TestModel : public Model {
+public:
+	TestModel(const string &path, LoadedFileList *loadedFileList, string *sourceLoader) {
+		load(path,false,loadedFileList,sourceLoader);
+	}
+	virtual void init() {}
+	virtual void end() {}
+};
+
+class TestModelFactory : public GraphicsFactory {
+public:
+	int loadCount;
+
+	TestModelFactory() : loadCount(0) {}
+	virtual Model *newModel(const string &path,TextureManager* textureManager,bool deletePixMapAfterLoad,LoadedFileList *loadedFileList, string *sourceLoader) {
+		loadCount++;
+		return new TestModel(path,loadedFileList,sourceLoader);
+	}
+};
+
+//
+// Tests for sharing models and their mesh data
+//
+class ModelManagerTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ModelManagerTest );
+
+	CPPUNIT_TEST( test_same_path );
+	CPPUNIT_TEST( test_same_content );
+	CPPUNIT_TEST( test_truncated_file );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+	TestModelFactory factory;
+	GraphicsFactory *oldFactory;
+
+	// a version 4 g3d file with one animated mesh
+	static void writeModel(const string &path, float offset, long truncateBy=0) {
+		const uint32 frameCount = 2;
+		const uint32 vertexCount = 3;
+		const uint32 indexCount = 3;
+
+		FILE *f = fopen(path.c_str(), "wb");
+		CPPUNIT_ASSERT( f != NULL );
+
+		FileHeader fileHeader;
+		memcpy(fileHeader.id, "G3D", 3);
+		fileHeader.version = 4;
+		fwrite(&fileHeader, sizeof(fileHeader), 1, f);
+
+		ModelHeader modelHeader;
+		modelHeader.meshCount = 1;
+		modelHeader.type = mtMorphMesh;
+		fwrite(&modelHeader, sizeof(modelHeader), 1, f);
+
+		MeshHeader meshHeader;
+		memset(&meshHeader, 0, sizeof(meshHeader));
+		strcpy(reinterpret_cast<char *>(meshHeader.name), "mesh");
+		meshHeader.frameCount = frameCount;
+		meshHeader.vertexCount = vertexCount;
+		meshHeader.indexCount = indexCount;
+		meshHeader.opacity = 1.0f;
+		fwrite(&meshHeader, sizeof(meshHeader), 1, f);
+
+		for(uint32 i = 0; i < frameCount * vertexCount; ++i) {
+			float vertex[3] = { offset + i, 1.0f, 2.0f };
+			fwrite(vertex, sizeof(vertex), 1, f);
+		}
+		for(uint32 i = 0; i < frameCount * vertexCount; ++i) {
+			float normal[3] = { 0.0f, 1.0f, 0.0f };
+			fwrite(normal, sizeof(normal), 1, f);
+		}
+		for(uint32 i = 0; i < indexCount; ++i) {
+			fwrite(&i, sizeof(i), 1, f);
+		}
+		long size = ftell(f);
+		fclose(f);
+		if(truncateBy > 0) {
+			truncateFile(path, size - truncateBy);
+		}
+	}
+
+	static void truncateFile(const string &path, long size) {
+		FILE *f = fopen(path.c_str(), "rb");
+		CPPUNIT_ASSERT( f != NULL );
+		vector<char> data(size);
+		CPPUNIT_ASSERT( fread(&data[0], size, 1, f) == 1 );
+		fclose(f);
+
+		f = fopen(path.c_str(), "wb");
+		CPPUNIT_ASSERT( f != NULL );
+		fwrite(&data[0], size, 1, f);
+		fclose(f);
+	}
+
+public:
+
+	void setUp() {
+		setVBOSupported(false);
+		oldFactory = GraphicsInterface::getInstance().getFactory();
+		GraphicsInterface::getInstance().setFactory(&factory);
+		factory.loadCount = 0;
+	}
+
+	void tearDown() {
+		GraphicsInterface::getInstance().setFactory(oldFactory);
+	}
+
+	void test_same_path() {
+		const string path = "model_manager_test_unit.g3d";
+		writeModel(path, 0.0f);
+
+		ModelManager modelManager;
+		LoadedFileList loadedFileList;
+		string firstLoader = "unit.xml";
+		string secondLoader = "other_unit.xml";
+
+		Model *first = modelManager.newModel(path, false, &loadedFileList, &firstLoader);
+		Model *second = modelManager.newModel(path, false, &loadedFileList, &secondLoader);
+		CPPUNIT_ASSERT( first == second );
+		CPPUNIT_ASSERT_EQUAL( 1, factory.loadCount );
+		CPPUNIT_ASSERT_EQUAL( 1, modelManager.getModelCount() );
+
+		// both loaders still list the file
+		CPPUNIT_ASSERT_EQUAL( 2, (int)loadedFileList[path].size() );
+		CPPUNIT_ASSERT_EQUAL( secondLoader, loadedFileList[path][1].first );
+
+		// the first end leaves it to the other user
+		modelManager.endModel(first);
+		CPPUNIT_ASSERT_EQUAL( 1, modelManager.getModelCount() );
+		CPPUNIT_ASSERT_EQUAL( 6u, second->getMesh(0)->getFrameCount() * second->getMesh(0)->getVertexCount() );
+		modelManager.endModel(second, true);
+		CPPUNIT_ASSERT_EQUAL( 0, modelManager.getModelCount() );
+		CPPUNIT_ASSERT_EQUAL( 0, modelManager.getSharedMeshDataCount() );
+
+		// and a new load reads the file again
+		Model *third = modelManager.newModel(path, false, NULL, NULL);
+		CPPUNIT_ASSERT_EQUAL( 2, factory.loadCount );
+		modelManager.endModel(third);
+
+		removeFile(path);
+	}
+
+	void test_same_content() {
+		const string firstPath = "model_manager_test_first.g3d";
+		const string copyPath = "model_manager_test_copy.g3d";
+		const string otherPath = "model_manager_test_other.g3d";
+		writeModel(firstPath, 0.0f);
+		writeModel(copyPath, 0.0f);
+		writeModel(otherPath, 10.0f);
+
+		ModelManager modelManager;
+		Model *first = modelManager.newModel(firstPath, false, NULL, NULL);
+		Model *copy = modelManager.newModel(copyPath, false, NULL, NULL);
+		Model *other = modelManager.newModel(otherPath, false, NULL, NULL);
+		CPPUNIT_ASSERT( first != copy );
+		CPPUNIT_ASSERT_EQUAL( 3, modelManager.getModelCount() );
+		CPPUNIT_ASSERT_EQUAL( 2, modelManager.getSharedMeshDataCount() );
+
+		const Mesh *firstMesh = first->getMesh(0);
+		const Mesh *copyMesh = copy->getMesh(0);
+		CPPUNIT_ASSERT( firstMesh->getSharedData() == copyMesh->getSharedData() );
+		CPPUNIT_ASSERT( firstMesh->getVertices() == copyMesh->getVertices() );
+		CPPUNIT_ASSERT( firstMesh->getIndices() == copyMesh->getIndices() );
+		CPPUNIT_ASSERT( firstMesh->getVertices() != other->getMesh(0)->getVertices() );
+		CPPUNIT_ASSERT_EQUAL( 2, firstMesh->getSharedData()->getReferenceCount() );
+
+		// each mesh still interpolates on its own
+		first->updateInterpolationData(0.25f, true);
+		copy->updateInterpolationData(0.75f, true);
+		CPPUNIT_ASSERT( firstMesh->getInterpolationData() != copyMesh->getInterpolationData() );
+
+		// the data outlives the model it was loaded for
+		modelManager.endModel(first);
+		CPPUNIT_ASSERT_EQUAL( 2, modelManager.getSharedMeshDataCount() );
+		CPPUNIT_ASSERT_EQUAL( 1, copyMesh->getSharedData()->getReferenceCount() );
+		CPPUNIT_ASSERT_EQUAL( 5.0f, copyMesh->getVertices()[5].x );
+		CPPUNIT_ASSERT_EQUAL( 2u, copyMesh->getIndices()[2] );
+
+		modelManager.endModel(copy);
+		modelManager.endModel(other);
+		CPPUNIT_ASSERT_EQUAL( 0, modelManager.getSharedMeshDataCount() );
+
+		removeFile(firstPath);
+		removeFile(copyPath);
+		removeFile(otherPath);
+	}
+
+	void test_truncated_file() {
+		const string path = "model_manager_test_truncated.g3d";
+		// the file ends in the middle of the indices
+		writeModel(path, 0.0f, 6);
+
+		ModelManager modelManager;
+		CPPUNIT_ASSERT_THROW( modelManager.newModel(path, false, NULL, NULL), megaglest_runtime_error );
+		CPPUNIT_ASSERT_EQUAL( 0, modelManager.getModelCount() );
+		CPPUNIT_ASSERT_EQUAL( 0, modelManager.getSharedMeshDataCount() );
+
+		removeFile(path);
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ModelManagerTest );
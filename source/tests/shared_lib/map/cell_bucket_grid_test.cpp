@@ -0,0 +1,118 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "cell_bucket_grid.h"
+#include <vector>
+#include <stdlib.h>
+
+using namespace Shared::Map;
+
+//
+// Tests for the bucketed cell occupant index used for unit range queries
+//
+class CellBucketGridTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( CellBucketGridTest );
+
+	CPPUNIT_TEST( test_add_replace_remove );
+	CPPUNIT_TEST( test_query_matches_cell_scan );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+private:
+	static const int gridW = 53;
+	static const int gridH = 37;
+	static const int layerCount = 3;
+
+public:
+
+	void test_add_replace_remove() {
+		CellBucketGrid<int> grid;
+		grid.init(20, 20);
+
+		grid.add(3, 4, 1, 100);
+		grid.add(3, 4, 2, 101);
+		CPPUNIT_ASSERT_EQUAL( 2, grid.getEntryCount() );
+
+		// same cell and layer replaces the occupant
+		grid.add(3, 4, 1, 102);
+		CPPUNIT_ASSERT_EQUAL( 2, grid.getEntryCount() );
+
+		std::vector<CellBucketGrid<int>::Entry> found;
+		grid.query(0, 0, 19, 19, found);
+		CPPUNIT_ASSERT_EQUAL( 2, (int)found.size() );
+		CPPUNIT_ASSERT_EQUAL( 102, found[0].item );
+		CPPUNIT_ASSERT_EQUAL( 101, found[1].item );
+
+		grid.remove(3, 4, 1);
+		grid.remove(3, 4, 0);
+		CPPUNIT_ASSERT_EQUAL( 1, grid.getEntryCount() );
+
+		found.clear();
+		grid.query(4, 0, 19, 19, found);
+		CPPUNIT_ASSERT_EQUAL( 0, (int)found.size() );
+	}
+
+	void test_query_matches_cell_scan() {
+		std::vector<int> cells(gridW * gridH * layerCount, 0);
+		CellBucketGrid<int> grid;
+		grid.init(gridW, gridH);
+
+		srand(1234);
+		for(int step = 0; step < 20000; ++step) {
+			int x = rand() % gridW;
+			int y = rand() % gridH;
+			int layer = rand() % layerCount;
+			int &occupant = cells[(y * gridW + x) * layerCount + layer];
+			if(rand() % 3 == 0) {
+				occupant = 0;
+				grid.remove(x, y, layer);
+			}
+			else {
+				occupant = step + 1;
+				grid.add(x, y, layer, occupant);
+			}
+
+			if(step % 500 == 0) {
+				int x0 = rand() % gridW - 5;
+				int y0 = rand() % gridH - 5;
+				int x1 = x0 + rand() % 30;
+				int y1 = y0 + rand() % 30;
+
+				std::vector<int> expected;
+				for(int i = x0; i <= x1; ++i) {
+					for(int j = y0; j <= y1; ++j) {
+						if(i < 0 || j < 0 || i >= gridW || j >= gridH) {
+							continue;
+						}
+						for(int k = 0; k < layerCount; ++k) {
+							if(cells[(j * gridW + i) * layerCount + k] != 0) {
+								expected.push_back(cells[(j * gridW + i) * layerCount + k]);
+							}
+						}
+					}
+				}
+
+				std::vector<CellBucketGrid<int>::Entry> found;
+				grid.query(x0, y0, x1, y1, found);
+				CPPUNIT_ASSERT_EQUAL( expected.size(), found.size() );
+				for(unsigned int i = 0; i < found.size(); ++i) {
+					CPPUNIT_ASSERT_EQUAL( expected[i], found[i].item );
+				}
+			}
+		}
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( CellBucketGridTest );
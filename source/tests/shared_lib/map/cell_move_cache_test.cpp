@@ -0,0 +1,251 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "cell_move_cache.h"
+#include "platform_common.h"
+#include <map>
+#include <vector>
+#include <stdio.h>
+
+using namespace Shared::Map;
+using namespace Shared::PlatformCommon;
+using Shared::Graphics::Vec2i;
+
+//
+// Tests for the flat movement query cache used by Map
+//
+class CellMoveCacheTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( CellMoveCacheTest );
+
+	CPPUNIT_TEST( test_direction_index );
+	CPPUNIT_TEST( test_store_and_invalidate );
+	CPPUNIT_TEST( test_generation_wrap );
+	CPPUNIT_TEST( test_cached_values_match_map );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+protected:
+	static const int gridSize = 256;
+
+	// Same layout as the lookup cache Map::aproxCanMove used to take
+	typedef std::map<Vec2i, std::map<Vec2i, std::map<int, std::map<int, std::map<int,bool> > > > > NestedCache;
+
+	static bool isPassable(int x, int y) {
+		return ((x * 7 + y * 13) % 11) != 0;
+	}
+
+public:
+
+	void test_direction_index() {
+		const Vec2i center(10, 10);
+		std::vector<int> seen(CellMoveCache::directionCount, 0);
+		for(int i = -1; i <= 1; ++i) {
+			for(int j = -1; j <= 1; ++j) {
+				int direction = CellMoveCache::getDirection(center, center + Vec2i(i, j));
+				if(i == 0 && j == 0) {
+					CPPUNIT_ASSERT_EQUAL( -1, direction );
+				}
+				else {
+					CPPUNIT_ASSERT( direction >= 0 && direction < CellMoveCache::directionCount );
+					seen[direction]++;
+				}
+			}
+		}
+		for(int i = 0; i < CellMoveCache::directionCount; ++i) {
+			CPPUNIT_ASSERT_EQUAL( 1, seen[i] );
+		}
+		CPPUNIT_ASSERT_EQUAL( -1, CellMoveCache::getDirection(center, center + Vec2i(2, 0)) );
+		CPPUNIT_ASSERT_EQUAL( -1, CellMoveCache::getDirection(center, center + Vec2i(-1, 3)) );
+	}
+
+	void test_store_and_invalidate() {
+		CellMoveCache cache;
+		cache.init(32, 32, 4);
+
+		bool result = false;
+		CPPUNIT_ASSERT_EQUAL( false, cache.lookup(0, Vec2i(3, 4), 2, result) );
+
+		cache.store(0, Vec2i(3, 4), 2, true);
+		cache.store(0, Vec2i(3, 4), 5, false);
+		CPPUNIT_ASSERT_EQUAL( true, cache.lookup(0, Vec2i(3, 4), 2, result) );
+		CPPUNIT_ASSERT_EQUAL( true, result );
+		CPPUNIT_ASSERT_EQUAL( true, cache.lookup(0, Vec2i(3, 4), 5, result) );
+		CPPUNIT_ASSERT_EQUAL( false, result );
+
+		// other directions, cells and layers are unaffected
+		CPPUNIT_ASSERT_EQUAL( false, cache.lookup(0, Vec2i(3, 4), 0, result) );
+		CPPUNIT_ASSERT_EQUAL( false, cache.lookup(0, Vec2i(4, 3), 2, result) );
+		CPPUNIT_ASSERT_EQUAL( false, cache.lookup(1, Vec2i(3, 4), 2, result) );
+
+		cache.invalidate();
+		CPPUNIT_ASSERT_EQUAL( false, cache.lookup(0, Vec2i(3, 4), 2, result) );
+		CPPUNIT_ASSERT_EQUAL( false, cache.lookup(0, Vec2i(3, 4), 5, result) );
+	}
+
+	void test_generation_wrap() {
+		CellMoveCache cache;
+		cache.init(8, 8, 1);
+
+		cache.store(0, Vec2i(1, 1), 0, true);
+		bool result = false;
+		// run the 16 bit stamps through a full wrap, an old entry must never come back
+		for(int i = 0; i < 70000; ++i) {
+			cache.invalidate();
+			CPPUNIT_ASSERT_EQUAL( false, cache.lookup(0, Vec2i(1, 1), 0, result) );
+			if(i == 65533) {
+				cache.store(0, Vec2i(2, 2), 1, true);
+			}
+		}
+	}
+
+	void test_cached_values_match_map() {
+		CellMoveCache cache;
+		cache.init(gridSize, gridSize, 1);
+		// the second pass is answered from the cache
+		for(int pass = 0; pass < 2; ++pass) {
+			for(int y = 1; y < 32; ++y) {
+				for(int x = 1; x < 32; ++x) {
+					const Vec2i pos1(x, y);
+					for(int j = -1; j <= 1; ++j) {
+						for(int k = -1; k <= 1; ++k) {
+							if(j == 0 && k == 0) {
+								continue;
+							}
+							Vec2i pos2 = pos1 + Vec2i(j, k);
+							int direction = CellMoveCache::getDirection(pos1, pos2);
+							bool value = false;
+							bool found = cache.lookup(0, pos1, direction, value);
+							CPPUNIT_ASSERT_EQUAL( pass == 1, found );
+							if(found == false) {
+								value = isPassable(pos2.x, pos2.y);
+								cache.store(0, pos1, direction, value);
+							}
+							CPPUNIT_ASSERT_EQUAL( isPassable(pos2.x, pos2.y), value );
+						}
+					}
+				}
+			}
+		}
+	}
+};
+
+//
+// Nested map against flat cache timings, run with megaglest_tests --benchmark
+//
+class CellMoveCacheBenchmark : public CellMoveCacheTest {
+	CPPUNIT_TEST_SUITE( CellMoveCacheBenchmark );
+
+	CPPUNIT_TEST( test_lookup_speed );
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void test_lookup_speed() {
+		const int iterations = 4;
+		std::vector<Vec2i> queries;
+		for(int y = 1; y < gridSize - 1; ++y) {
+			for(int x = 1; x < gridSize - 1; ++x) {
+				queries.push_back(Vec2i(x, y));
+			}
+		}
+
+		// nested std::map cache
+		int nestedFree = 0;
+		Chrono chronoNested(true);
+		for(int iteration = 0; iteration < iterations; ++iteration) {
+			NestedCache cache;
+			for(int pass = 0; pass < 2; ++pass) {
+				for(unsigned int i = 0; i < queries.size(); ++i) {
+					const Vec2i &pos1 = queries[i];
+					for(int j = -1; j <= 1; ++j) {
+						for(int k = -1; k <= 1; ++k) {
+							if(j == 0 && k == 0) {
+								continue;
+							}
+							Vec2i pos2 = pos1 + Vec2i(j, k);
+							bool value = false;
+							NestedCache::const_iterator iterFind1 = cache.find(pos1);
+							bool found = false;
+							if(iterFind1 != cache.end()) {
+								std::map<Vec2i, std::map<int, std::map<int, std::map<int,bool> > > >::const_iterator iterFind2 = iterFind1->second.find(pos2);
+								if(iterFind2 != iterFind1->second.end()) {
+									std::map<int, std::map<int, std::map<int,bool> > >::const_iterator iterFind3 = iterFind2->second.find(0);
+									if(iterFind3 != iterFind2->second.end()) {
+										std::map<int, std::map<int,bool> >::const_iterator iterFind4 = iterFind3->second.find(1);
+										if(iterFind4 != iterFind3->second.end()) {
+											std::map<int,bool>::const_iterator iterFind5 = iterFind4->second.find(0);
+											if(iterFind5 != iterFind4->second.end()) {
+												value = iterFind5->second;
+												found = true;
+											}
+										}
+									}
+								}
+							}
+							if(found == false) {
+								value = isPassable(pos2.x, pos2.y);
+								cache[pos1][pos2][0][1][0] = value;
+							}
+							nestedFree += (value ? 1 : 0);
+						}
+					}
+				}
+			}
+		}
+		int64 nestedMicros = chronoNested.getMicros();
+
+		// flat cache
+		int flatFree = 0;
+		CellMoveCache cache;
+		cache.init(gridSize, gridSize, 1);
+		Chrono chronoFlat(true);
+		for(int iteration = 0; iteration < iterations; ++iteration) {
+			cache.invalidate();
+			for(int pass = 0; pass < 2; ++pass) {
+				for(unsigned int i = 0; i < queries.size(); ++i) {
+					const Vec2i &pos1 = queries[i];
+					for(int j = -1; j <= 1; ++j) {
+						for(int k = -1; k <= 1; ++k) {
+							if(j == 0 && k == 0) {
+								continue;
+							}
+							Vec2i pos2 = pos1 + Vec2i(j, k);
+							int direction = CellMoveCache::getDirection(pos1, pos2);
+							bool value = false;
+							if(cache.lookup(0, pos1, direction, value) == false) {
+								value = isPassable(pos2.x, pos2.y);
+								cache.store(0, pos1, direction, value);
+							}
+							flatFree += (value ? 1 : 0);
+						}
+					}
+				}
+			}
+		}
+		int64 flatMicros = chronoFlat.getMicros();
+
+		CPPUNIT_ASSERT_EQUAL( nestedFree, flatFree );
+
+		double lookups = (double)queries.size() * 8 * 2 * iterations;
+		printf("\nMove cache benchmark: %.0f queries, nested map: %.0f queries/sec, flat: %.0f queries/sec\n",
+				lookups,
+				nestedMicros > 0 ? lookups * 1000000.0 / nestedMicros : 0.0,
+				flatMicros > 0 ? lookups * 1000000.0 / flatMicros : 0.0);
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( CellMoveCacheTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( CellMoveCacheBenchmark, "benchmarks" );
@@ -0,0 +1,330 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "cluster_graph.h"
+#include "binary_heap.h"
+#include "platform_common.h"
+#include <vector>
+#include <string>
+#include <stdio.h>
+
+using namespace Shared::Map;
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+using Shared::Graphics::Vec2i;
+
+//
+// Grid used as a test map for the cluster graph
+//
+class TestGridMap : public ClusterGraphPassability {
+public:
+	int w;
+	int h;
+	std::vector<char> blocked;
+
+	TestGridMap(int w, int h) : w(w), h(h), blocked(w * h, 0) {}
+
+	virtual bool isPassable(int x, int y) const {
+		if(x < 0 || y < 0 || x >= w || y >= h) {
+			return false;
+		}
+		return blocked[y * w + x] == 0;
+	}
+	void block(int x, int y, int sizeX, int sizeY) {
+		for(int j = y; j < y + sizeY && j < h; ++j) {
+			for(int i = x; i < x + sizeX && i < w; ++i) {
+				blocked[j * w + i] = 1;
+			}
+		}
+	}
+	void unblock(int x, int y, int sizeX, int sizeY) {
+		for(int j = y; j < y + sizeY && j < h; ++j) {
+			for(int i = x; i < x + sizeX && i < w; ++i) {
+				blocked[j * w + i] = 0;
+			}
+		}
+	}
+};
+
+//
+// Tests for the hierarchical path planning graph
+//
+class ClusterGraphTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ClusterGraphTest );
+
+	CPPUNIT_TEST( test_open_map_route );
+	CPPUNIT_TEST( test_unreachable_goal );
+	CPPUNIT_TEST( test_incremental_update_matches_rebuild );
+	CPPUNIT_TEST( test_separate_search_state );
+	CPPUNIT_TEST( test_abstract_search_expands_fewer_nodes );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+protected:
+
+	// Plain grid A* with the same movement rules, returns the number of
+	// expanded cells or -1 if the goal can't be reached
+	static int gridAStar(const TestGridMap &map, const Vec2i &from, const Vec2i &to) {
+		std::vector<int> costs(map.w * map.h, -1);
+		std::vector<char> closed(map.w * map.h, 0);
+		BinaryHeap<int,int> open;
+		costs[from.y * map.w + from.x] = 0;
+		open.push(0, from.y * map.w + from.x);
+
+		int expanded = 0;
+		while(open.empty() == false) {
+			int cell = open.pop();
+			if(closed[cell] != 0) {
+				continue;
+			}
+			closed[cell] = 1;
+			expanded++;
+			Vec2i pos(cell % map.w, cell / map.w);
+			if(pos == to) {
+				return expanded;
+			}
+			for(int i = -1; i <= 1; ++i) {
+				for(int j = -1; j <= 1; ++j) {
+					Vec2i sucPos = pos + Vec2i(i, j);
+					if((i == 0 && j == 0) || map.isPassable(sucPos.x, sucPos.y) == false) {
+						continue;
+					}
+					if(i != 0 && j != 0 &&
+						(map.isPassable(pos.x, sucPos.y) == false || map.isPassable(sucPos.x, pos.y) == false)) {
+						continue;
+					}
+					int sucCell = sucPos.y * map.w + sucPos.x;
+					int sucCost = costs[cell] + (i != 0 && j != 0 ? ClusterGraph::diagonalCost : ClusterGraph::straightCost);
+					if(closed[sucCell] == 0 && (costs[sucCell] < 0 || sucCost < costs[sucCell])) {
+						costs[sucCell] = sucCost;
+						int dx = abs(sucPos.x - to.x);
+						int dy = abs(sucPos.y - to.y);
+						int estimate = ClusterGraph::straightCost * (dx + dy) +
+								(ClusterGraph::diagonalCost - 2 * ClusterGraph::straightCost) * std::min(dx, dy);
+						open.push(sucCost + estimate, sucCell);
+					}
+				}
+			}
+		}
+		return -1;
+	}
+
+	// Long walls with a few gaps, the typical chokepoint layout
+	static void buildChokepointMap(TestGridMap &map) {
+		for(int x = map.w / 8; x < map.w; x += map.w / 8) {
+			map.block(x, 0, 2, map.h);
+			int gapCount = 2;
+			for(int gap = 0; gap < gapCount; ++gap) {
+				int gapY = ((x * 7 + gap * 131) % (map.h - 8)) + 2;
+				map.unblock(x, gapY, 2, 4);
+			}
+		}
+	}
+
+	// Scattered blocks similar to trees and buildings
+	static void buildForestMap(TestGridMap &map) {
+		unsigned int seed = 4242;
+		for(int i = 0; i < map.w * map.h / 40; ++i) {
+			seed = seed * 1103515245 + 12345;
+			int x = (seed >> 8) % map.w;
+			seed = seed * 1103515245 + 12345;
+			int y = (seed >> 8) % map.h;
+			map.block(x, y, 3, 2);
+		}
+		map.unblock(0, 0, 4, 4);
+		map.unblock(map.w - 4, map.h - 4, 4, 4);
+	}
+
+	static bool sameRoute(ClusterGraph &a, ClusterGraph &b, const Vec2i &from, const Vec2i &to) {
+		std::vector<Vec2i> routeA;
+		std::vector<Vec2i> routeB;
+		bool foundA = a.findPath(from, to, routeA);
+		bool foundB = b.findPath(from, to, routeB);
+		return foundA == foundB && routeA == routeB;
+	}
+
+public:
+
+	void test_open_map_route() {
+		TestGridMap map(64, 64);
+		ClusterGraph graph;
+		graph.init(map.w, map.h, &map);
+
+		std::vector<Vec2i> waypoints;
+		bool found = graph.findPath(Vec2i(1, 1), Vec2i(62, 62), waypoints);
+		CPPUNIT_ASSERT_EQUAL( true, found );
+		CPPUNIT_ASSERT( waypoints.empty() == false );
+		CPPUNIT_ASSERT( waypoints.back() == Vec2i(62, 62) );
+
+		// every waypoint moves closer to the goal on an open map
+		int lastDistance = 1 << 30;
+		for(unsigned int i = 0; i < waypoints.size(); ++i) {
+			int distance = abs(waypoints[i].x - 62) + abs(waypoints[i].y - 62);
+			CPPUNIT_ASSERT( distance <= lastDistance );
+			lastDistance = distance;
+		}
+	}
+
+	void test_unreachable_goal() {
+		TestGridMap map(64, 64);
+		map.block(30, 0, 2, 64);
+		ClusterGraph graph;
+		graph.init(map.w, map.h, &map);
+
+		std::vector<Vec2i> waypoints;
+		CPPUNIT_ASSERT_EQUAL( false, graph.findPath(Vec2i(1, 1), Vec2i(62, 62), waypoints) );
+
+		// opening a gap and marking it dirty reconnects the two halves
+		map.unblock(30, 40, 2, 3);
+		graph.setDirty(30, 40, 3);
+		CPPUNIT_ASSERT_EQUAL( true, graph.findPath(Vec2i(1, 1), Vec2i(62, 62), waypoints) );
+	}
+
+	void test_incremental_update_matches_rebuild() {
+		TestGridMap map(128, 128);
+		buildChokepointMap(map);
+
+		ClusterGraph incremental;
+		incremental.init(map.w, map.h, &map);
+		incremental.update();
+
+		// drop a few building footprints and only mark their area dirty
+		const int footprints[][2] = { {20, 20}, {47, 60}, {63, 63}, {100, 5}, {15, 110} };
+		for(unsigned int i = 0; i < sizeof(footprints) / sizeof(footprints[0]); ++i) {
+			map.block(footprints[i][0], footprints[i][1], 4, 4);
+			incremental.setDirty(footprints[i][0], footprints[i][1], 4);
+		}
+
+		ClusterGraph rebuilt;
+		rebuilt.init(map.w, map.h, &map);
+
+		CPPUNIT_ASSERT( sameRoute(incremental, rebuilt, Vec2i(1, 1), Vec2i(126, 126)) );
+		CPPUNIT_ASSERT( sameRoute(incremental, rebuilt, Vec2i(5, 120), Vec2i(120, 3)) );
+		CPPUNIT_ASSERT( sameRoute(incremental, rebuilt, Vec2i(64, 2), Vec2i(64, 125)) );
+		CPPUNIT_ASSERT_EQUAL( rebuilt.getNodeCount(), incremental.getNodeCount() );
+	}
+
+	void test_separate_search_state() {
+		TestGridMap map(128, 128);
+		buildChokepointMap(map);
+		ClusterGraph graph;
+		graph.init(map.w, map.h, &map);
+
+		// a dirty graph has to be updated before searching with outside state
+		ClusterGraphSearch first;
+		std::vector<Vec2i> firstRoute;
+		CPPUNIT_ASSERT_EQUAL( false, graph.findPath(first, Vec2i(1, 1), Vec2i(126, 126), firstRoute) );
+		graph.update();
+
+		std::vector<Vec2i> expectedRoute;
+		CPPUNIT_ASSERT_EQUAL( true, graph.findPath(Vec2i(1, 1), Vec2i(126, 126), expectedRoute) );
+
+		// searches with their own state don't disturb each other
+		ClusterGraphSearch second;
+		std::vector<Vec2i> secondRoute;
+		CPPUNIT_ASSERT_EQUAL( true, graph.findPath(first, Vec2i(1, 1), Vec2i(126, 126), firstRoute) );
+		CPPUNIT_ASSERT_EQUAL( true, graph.findPath(second, Vec2i(5, 120), Vec2i(120, 3), secondRoute) );
+		CPPUNIT_ASSERT( firstRoute == expectedRoute );
+		CPPUNIT_ASSERT_EQUAL( true, graph.findPath(first, Vec2i(1, 1), Vec2i(126, 126), firstRoute) );
+		CPPUNIT_ASSERT( firstRoute == expectedRoute );
+		CPPUNIT_ASSERT( sameRoute(graph, graph, Vec2i(5, 120), Vec2i(120, 3)) );
+	}
+
+	void test_abstract_search_expands_fewer_nodes() {
+		for(int layout = 0; layout < 2; ++layout) {
+			TestGridMap map(128, 128);
+			if(layout == 0) {
+				buildChokepointMap(map);
+			}
+			else {
+				buildForestMap(map);
+			}
+			ClusterGraph graph;
+			graph.init(map.w, map.h, &map);
+			graph.update();
+
+			const Vec2i from(1, 1);
+			const Vec2i to(126, 126);
+			int gridExpanded = gridAStar(map, from, to);
+			std::vector<Vec2i> waypoints;
+			int abstractExpanded = 0;
+			bool found = graph.findPath(from, to, waypoints, &abstractExpanded);
+
+			// both planners must agree on whether the goal is reachable
+			CPPUNIT_ASSERT_EQUAL( gridExpanded >= 0, found );
+			if(found == true) {
+				CPPUNIT_ASSERT( abstractExpanded < gridExpanded );
+			}
+		}
+	}
+};
+
+//
+// Planner timings on growing maps, run with megaglest_tests --benchmark
+//
+class ClusterGraphBenchmark : public ClusterGraphTest {
+	CPPUNIT_TEST_SUITE( ClusterGraphBenchmark );
+
+	CPPUNIT_TEST( test_map_set_speedup );
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void test_map_set_speedup() {
+		const int sizes[] = { 128, 256, 512 };
+		for(unsigned int sizeIndex = 0; sizeIndex < sizeof(sizes) / sizeof(sizes[0]); ++sizeIndex) {
+			for(int layout = 0; layout < 2; ++layout) {
+				int size = sizes[sizeIndex];
+				TestGridMap map(size, size);
+				if(layout == 0) {
+					buildChokepointMap(map);
+				}
+				else {
+					buildForestMap(map);
+				}
+
+				ClusterGraph graph;
+				graph.init(map.w, map.h, &map);
+				Chrono chronoBuild(true);
+				graph.update();
+				int64 buildMicros = chronoBuild.getMicros();
+
+				const Vec2i from(1, 1);
+				const Vec2i to(size - 2, size - 2);
+
+				Chrono chronoGrid(true);
+				int gridExpanded = gridAStar(map, from, to);
+				int64 gridMicros = chronoGrid.getMicros();
+
+				std::vector<Vec2i> waypoints;
+				int abstractExpanded = 0;
+				Chrono chronoAbstract(true);
+				bool found = graph.findPath(from, to, waypoints, &abstractExpanded);
+				int64 abstractMicros = chronoAbstract.getMicros();
+
+				CPPUNIT_ASSERT_EQUAL( gridExpanded >= 0, found );
+
+				printf("\nCluster graph %s %dx%d: build %lld us, grid A* %d nodes %lld us, abstract %d nodes %lld us",
+						(layout == 0 ? "chokepoints" : "forest"), size, size, (long long int)buildMicros,
+						gridExpanded, (long long int)gridMicros, abstractExpanded, (long long int)abstractMicros);
+			}
+		}
+		printf("\n");
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ClusterGraphTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( ClusterGraphBenchmark, "benchmarks" );
@@ -0,0 +1,164 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "team_visibility_map.h"
+#include <vector>
+
+using namespace Shared::Map;
+using Shared::Graphics::Vec2i;
+
+//
+// Tests for the reference counted per team visibility map
+//
+class TeamVisibilityMapTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( TeamVisibilityMapTest );
+
+	CPPUNIT_TEST( test_stamp_shape );
+	CPPUNIT_TEST( test_overlapping_stamps );
+	CPPUNIT_TEST( test_explored_is_kept );
+	CPPUNIT_TEST( test_changed_cells );
+	CPPUNIT_TEST( test_revealed_and_all_explored );
+	CPPUNIT_TEST( test_explored_runs );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_stamp_shape() {
+		const int size = 70;
+		TeamVisibilityMap visibility;
+		visibility.init(size, size, 2);
+
+		const Vec2i centers[] = { Vec2i(35, 35), Vec2i(0, 3), Vec2i(68, 66) };
+		for(int centerIndex = 0; centerIndex < 3; ++centerIndex) {
+			const Vec2i &center = centers[centerIndex];
+			for(int radius = 1; radius < 20; ++radius) {
+				visibility.init(size, size, 2);
+				visibility.addStamp(1, center, radius, radius + 6);
+
+				for(int y = 0; y < size; ++y) {
+					for(int x = 0; x < size; ++x) {
+						// the shape World::exploreCells has always used
+						float length = (Vec2i(x, y) - center).length();
+						CPPUNIT_ASSERT_EQUAL( length < radius, visibility.isVisible(1, x, y) );
+						CPPUNIT_ASSERT_EQUAL( length < radius + 6, visibility.isExplored(1, x, y) );
+						CPPUNIT_ASSERT_EQUAL( false, visibility.isVisible(0, x, y) );
+						CPPUNIT_ASSERT_EQUAL( false, visibility.isExplored(0, x, y) );
+					}
+				}
+			}
+		}
+	}
+
+	void test_overlapping_stamps() {
+		TeamVisibilityMap visibility;
+		visibility.init(40, 30, 1);
+
+		visibility.addStamp(0, Vec2i(10, 10), 5, 5);
+		visibility.addStamp(0, Vec2i(13, 10), 5, 5);
+		CPPUNIT_ASSERT_EQUAL( 2, visibility.getStampCount(0, 11, 10) );
+
+		visibility.removeStamp(0, Vec2i(10, 10), 5);
+		CPPUNIT_ASSERT_EQUAL( true, visibility.isVisible(0, 11, 10) );
+		CPPUNIT_ASSERT_EQUAL( false, visibility.isVisible(0, 7, 10) );
+		CPPUNIT_ASSERT_EQUAL( 1, visibility.getStampCount(0, 11, 10) );
+
+		visibility.removeStamp(0, Vec2i(13, 10), 5);
+		CPPUNIT_ASSERT_EQUAL( 0, visibility.getVisibleCellCount(0) );
+	}
+
+	void test_explored_is_kept() {
+		TeamVisibilityMap visibility;
+		visibility.init(40, 40, 1);
+
+		visibility.addStamp(0, Vec2i(20, 20), 4, 8);
+		int exploredCount = visibility.getExploredCellCount(0);
+		CPPUNIT_ASSERT( exploredCount > visibility.getVisibleCellCount(0) );
+
+		visibility.removeStamp(0, Vec2i(20, 20), 4);
+		CPPUNIT_ASSERT_EQUAL( 0, visibility.getVisibleCellCount(0) );
+		CPPUNIT_ASSERT_EQUAL( exploredCount, visibility.getExploredCellCount(0) );
+		CPPUNIT_ASSERT_EQUAL( true, visibility.isExplored(0, 20, 20) );
+	}
+
+	void test_changed_cells() {
+		TeamVisibilityMap visibility;
+		visibility.init(32, 32, 1);
+
+		std::vector<int> changed;
+		visibility.addStamp(0, Vec2i(16, 16), 3, 3, &changed);
+		int firstCount = (int)changed.size();
+		CPPUNIT_ASSERT( firstCount > 0 );
+
+		// a second stamp on the same spot changes nothing
+		changed.clear();
+		visibility.addStamp(0, Vec2i(16, 16), 3, 3, &changed);
+		CPPUNIT_ASSERT_EQUAL( 0, (int)changed.size() );
+
+		changed.clear();
+		visibility.removeStamp(0, Vec2i(16, 16), 3, &changed);
+		CPPUNIT_ASSERT_EQUAL( 0, (int)changed.size() );
+
+		visibility.removeStamp(0, Vec2i(16, 16), 3, &changed);
+		CPPUNIT_ASSERT_EQUAL( visibility.getExploredCellCount(0), (int)changed.size() );
+		CPPUNIT_ASSERT_EQUAL( 16 * 32 + 16, changed[changed.size() / 2] );
+	}
+
+	void test_revealed_and_all_explored() {
+		TeamVisibilityMap visibility;
+		visibility.init(45, 20, 2);
+
+		visibility.setRevealed(1, true);
+		CPPUNIT_ASSERT_EQUAL( true, visibility.isVisible(1, 44, 19) );
+		CPPUNIT_ASSERT_EQUAL( 45 * 20, visibility.getVisibleCellCount(1) );
+		CPPUNIT_ASSERT_EQUAL( false, visibility.isVisible(0, 44, 19) );
+
+		// stamps of a revealed team never hide a cell
+		visibility.addStamp(1, Vec2i(10, 10), 3, 3);
+		visibility.removeStamp(1, Vec2i(10, 10), 3);
+		CPPUNIT_ASSERT_EQUAL( true, visibility.isVisible(1, 10, 10) );
+
+		visibility.setAllExplored(0, true);
+		CPPUNIT_ASSERT_EQUAL( 45 * 20, visibility.getExploredCellCount(0) );
+		visibility.setAllExplored(0, false);
+		CPPUNIT_ASSERT_EQUAL( 0, visibility.getExploredCellCount(0) );
+	}
+
+	void test_explored_runs() {
+		const int width = 70;
+		const int height = 33;
+		TeamVisibilityMap visibility;
+		visibility.init(width, height, 2);
+
+		CPPUNIT_ASSERT_EQUAL( std::string("2310"), visibility.getExploredRuns(0) );
+
+		visibility.addStamp(0, Vec2i(0, 0), 4, 6);
+		visibility.addStamp(0, Vec2i(40, 20), 2, 9);
+		visibility.setExplored(0, width - 1, height - 1, true);
+
+		TeamVisibilityMap restored;
+		restored.init(width, height, 2);
+		restored.setExploredRuns(1, visibility.getExploredRuns(0));
+		for(int y = 0; y < height; ++y) {
+			for(int x = 0; x < width; ++x) {
+				CPPUNIT_ASSERT_EQUAL( visibility.isExplored(0, x, y), restored.isExplored(1, x, y) );
+			}
+		}
+		CPPUNIT_ASSERT_EQUAL( 0, restored.getVisibleCellCount(1) );
+		CPPUNIT_ASSERT_EQUAL( visibility.getExploredRuns(0), restored.getExploredRuns(1) );
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( TeamVisibilityMapTest );
@@ -0,0 +1,136 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "socket_reactor.h"
+#include <vector>
+
+using namespace Shared::Platform;
+
+//
+// Tests for the epoll socket reactor with loopback clients
+//
+class SocketReactorTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( SocketReactorTest );
+
+	CPPUNIT_TEST( test_loopback_clients );
+	CPPUNIT_TEST( test_wakeup );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	static const int listenerUserData = 100;
+	static const int testPort = 61377;
+	static const int clientCount = 3;
+
+	// events of one wait folded into per user data flags
+	static bool hasReadable(const std::vector<SocketReactorEvent> &events, int userData) {
+		for(unsigned int index = 0; index < events.size(); ++index) {
+			if(events[index].userData == userData && events[index].readable == true) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static std::vector<SocketReactorEvent> waitFor(SocketReactor &reactor, int userData) {
+		std::vector<SocketReactorEvent> result;
+		std::vector<SocketReactorEvent> events;
+		for(int attempt = 0; attempt < 20 && hasReadable(result, userData) == false; ++attempt) {
+			reactor.wait(events, 100);
+			result.insert(result.end(), events.begin(), events.end());
+		}
+		return result;
+	}
+
+public:
+
+	void test_loopback_clients() {
+		if(SocketReactor::isSupported() == false) {
+			return;
+		}
+		SocketReactor reactor;
+		CPPUNIT_ASSERT_EQUAL( true, reactor.init() );
+
+		ServerSocket listener(true);
+		listener.bind(testPort);
+		listener.listen(clientCount);
+		listener.setBlock(false);
+		CPPUNIT_ASSERT_EQUAL( true, reactor.addSocket(listener.getSocketId(), listenerUserData) );
+
+		std::vector<ClientSocket *> clients;
+		std::vector<Socket *> accepted;
+		for(int index = 0; index < clientCount; ++index) {
+			ClientSocket *client = new ClientSocket();
+			client->connect(Ip(127, 0, 0, 1), testPort);
+			clients.push_back(client);
+
+			CPPUNIT_ASSERT_EQUAL( true, hasReadable(waitFor(reactor, listenerUserData), listenerUserData) );
+			Socket *socket = listener.accept(false);
+			CPPUNIT_ASSERT( socket != NULL );
+			socket->setBlock(false);
+			accepted.push_back(socket);
+			CPPUNIT_ASSERT_EQUAL( true, reactor.addSocket(socket->getSocketId(), index) );
+		}
+
+		// every client gets its own user data back
+		for(int index = clientCount - 1; index >= 0; --index) {
+			const char message[] = "ping";
+			CPPUNIT_ASSERT_EQUAL( (int)sizeof(message), clients[index]->send(message, sizeof(message)) );
+			std::vector<SocketReactorEvent> events = waitFor(reactor, index);
+			CPPUNIT_ASSERT_EQUAL( true, hasReadable(events, index) );
+
+			char buffer[sizeof(message)];
+			CPPUNIT_ASSERT_EQUAL( (int)sizeof(message), accepted[index]->receive(buffer, sizeof(buffer), true) );
+			CPPUNIT_ASSERT_EQUAL( std::string(message), std::string(buffer) );
+		}
+
+		// edge triggered, a drained socket stays quiet
+		std::vector<SocketReactorEvent> events;
+		CPPUNIT_ASSERT_EQUAL( 0, reactor.wait(events, 50) );
+
+		// a closed client is reported as a hangup
+		clients[1]->disconnectSocket();
+		events = waitFor(reactor, 1);
+		bool gotHangup = false;
+		for(unsigned int index = 0; index < events.size(); ++index) {
+			if(events[index].userData == 1) {
+				gotHangup = (gotHangup || events[index].hangup == true);
+			}
+		}
+		CPPUNIT_ASSERT_EQUAL( true, gotHangup );
+
+		for(int index = 0; index < clientCount; ++index) {
+			reactor.removeSocket(accepted[index]->getSocketId());
+			delete accepted[index];
+			delete clients[index];
+		}
+		reactor.removeSocket(listener.getSocketId());
+	}
+
+	void test_wakeup() {
+		if(SocketReactor::isSupported() == false) {
+			return;
+		}
+		SocketReactor reactor;
+		CPPUNIT_ASSERT_EQUAL( true, reactor.init() );
+
+		reactor.wakeup();
+		std::vector<SocketReactorEvent> events;
+		time_t start = time(NULL);
+		CPPUNIT_ASSERT_EQUAL( 0, reactor.wait(events, 5000) );
+		CPPUNIT_ASSERT( difftime(time(NULL), start) < 2 );
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( SocketReactorTest );
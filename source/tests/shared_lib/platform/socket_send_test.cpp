@@ -0,0 +1,315 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "socket.h"
+#include "platform_common.h"
+#include <cstring>
+#include <vector>
+#include <stdio.h>
+
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+
+//
+// Tests for gather writes and send batches over loopback
+//
+class SocketSendTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( SocketSendTest );
+
+	CPPUNIT_TEST( test_gather_send );
+	CPPUNIT_TEST( test_send_batch );
+	CPPUNIT_TEST( test_byte_counts );
+	CPPUNIT_TEST( test_send_queue );
+	CPPUNIT_TEST( test_send_queue_limit );
+	CPPUNIT_TEST( test_receive_tap );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+protected:
+	static const int testPort = 61378;
+	static const int payloadSize = 32;
+
+	ServerSocket *listener;
+	ClientSocket *client;
+	Socket *accepted;
+
+	class ReceiveTap : public SocketReceiveTap {
+	public:
+		std::vector<char> bytes;
+		virtual void socketDataReceived(const void *data, int dataSize) {
+			const char *dataBuf = static_cast<const char *>(data);
+			bytes.insert(bytes.end(), dataBuf, dataBuf + dataSize);
+		}
+	};
+
+	// reads until size bytes arrived or the peer went quiet
+	bool receiveAll(char *buffer, int size) {
+		int received = 0;
+		for(int attempt = 0; attempt < 200 && received < size; ++attempt) {
+			if(accepted->hasDataToReadWithWait(10000) == true) {
+				int result = accepted->receive(&buffer[received], size - received, false);
+				if(result > 0) {
+					received += result;
+				}
+			}
+		}
+		return (received == size);
+	}
+
+	void drain(int size) {
+		std::vector<char> buffer(size);
+		CPPUNIT_ASSERT_EQUAL( true, receiveAll(&buffer[0], size) );
+	}
+
+public:
+
+	void setUp() {
+		listener = new ServerSocket(true);
+		listener->bind(testPort);
+		listener->listen(1);
+
+		client = new ClientSocket();
+		client->connect(Ip(127, 0, 0, 1), testPort);
+
+		accepted = NULL;
+		for(int attempt = 0; attempt < 100 && accepted == NULL; ++attempt) {
+			if(listener->hasDataToReadWithWait(10000) == true) {
+				accepted = listener->accept(false);
+			}
+		}
+		CPPUNIT_ASSERT( accepted != NULL );
+		accepted->setBlock(false);
+	}
+
+	void tearDown() {
+		delete accepted;
+		accepted = NULL;
+		delete client;
+		client = NULL;
+		delete listener;
+		listener = NULL;
+	}
+
+	void test_gather_send() {
+		const char type = 7;
+		const char header[] = "head";
+		const char body[] = "body of the message";
+		const void *parts[] 	= { &type, header, body };
+		const int partSizes[] 	= { 1, (int)sizeof(header), (int)sizeof(body) };
+		const int fullSize 		= partSizes[0] + partSizes[1] + partSizes[2];
+
+		CPPUNIT_ASSERT_EQUAL( fullSize, client->sendv(parts, partSizes, 3) );
+
+		char buffer[fullSize];
+		CPPUNIT_ASSERT_EQUAL( true, receiveAll(buffer, fullSize) );
+		CPPUNIT_ASSERT_EQUAL( type, buffer[0] );
+		CPPUNIT_ASSERT_EQUAL( std::string(header), std::string(&buffer[1]) );
+		CPPUNIT_ASSERT_EQUAL( std::string(body), std::string(&buffer[1 + sizeof(header)]) );
+	}
+
+	void test_send_batch() {
+		const char first[] = "first";
+		const char second[] = "second";
+
+		client->beginSendBatch();
+		client->beginSendBatch();
+		CPPUNIT_ASSERT_EQUAL( (int)sizeof(first), client->send(first, sizeof(first)) );
+		const void *parts[] 	= { second };
+		const int partSizes[] 	= { (int)sizeof(second) };
+		CPPUNIT_ASSERT_EQUAL( (int)sizeof(second), client->sendv(parts, partSizes, 1) );
+
+		// nothing leaves before the outermost batch is closed
+		CPPUNIT_ASSERT_EQUAL( true, client->endSendBatch() );
+		CPPUNIT_ASSERT_EQUAL( true, client->isSendBatchOpen() );
+		CPPUNIT_ASSERT_EQUAL( false, accepted->hasDataToReadWithWait(50000) );
+
+		CPPUNIT_ASSERT_EQUAL( true, client->endSendBatch() );
+		CPPUNIT_ASSERT_EQUAL( false, client->isSendBatchOpen() );
+
+		char buffer[sizeof(first) + sizeof(second)];
+		CPPUNIT_ASSERT_EQUAL( true, receiveAll(buffer, sizeof(buffer)) );
+		CPPUNIT_ASSERT_EQUAL( std::string(first), std::string(buffer) );
+		CPPUNIT_ASSERT_EQUAL( std::string(second), std::string(&buffer[sizeof(first)]) );
+	}
+
+	void test_byte_counts() {
+		const char message[] = "counted";
+		const void *parts[] 	= { message, message };
+		const int partSizes[] 	= { (int)sizeof(message), (int)sizeof(message) };
+
+		CPPUNIT_ASSERT_EQUAL( (int64)0, client->getSentByteCount() );
+		CPPUNIT_ASSERT_EQUAL( (int)sizeof(message), client->send(message, sizeof(message)) );
+		CPPUNIT_ASSERT_EQUAL( (int)sizeof(message) * 2, client->sendv(parts, partSizes, 2) );
+
+		// a batch is counted once when it is written out
+		client->beginSendBatch();
+		client->send(message, sizeof(message));
+		CPPUNIT_ASSERT_EQUAL( (int64)sizeof(message) * 3, client->getSentByteCount() );
+		CPPUNIT_ASSERT_EQUAL( true, client->endSendBatch() );
+		CPPUNIT_ASSERT_EQUAL( (int64)sizeof(message) * 4, client->getSentByteCount() );
+
+		drain(sizeof(message) * 4);
+		CPPUNIT_ASSERT_EQUAL( (int64)sizeof(message) * 4, accepted->getReceivedByteCount() );
+		CPPUNIT_ASSERT_EQUAL( (int64)0, accepted->getSentByteCount() );
+	}
+
+	void test_send_queue() {
+		// more than the socket buffers of both ends hold
+		const int chunkSize = 64 * 1024;
+		const int chunkCount = 256;
+		std::vector<char> chunk(chunkSize);
+		client->enableSendQueue();
+
+		Chrono chrono(true);
+		for(int index = 0; index < chunkCount; ++index) {
+			memset(&chunk[0], 'a' + (index % 26), chunkSize);
+			CPPUNIT_ASSERT_EQUAL( chunkSize, client->send(&chunk[0], chunkSize) );
+		}
+		// nobody reads yet, so the queue holds the rest instead of waiting
+		CPPUNIT_ASSERT( chrono.getMillis() < 1000 );
+		CPPUNIT_ASSERT( client->getSendQueueSize() > 0 );
+		CPPUNIT_ASSERT_EQUAL( (int64)chunkSize * chunkCount, client->getQueuedByteCount() );
+
+		std::vector<char> buffer(chunkSize);
+		for(int index = 0; index < chunkCount; ++index) {
+			int received = 0;
+			for(int attempt = 0; attempt < 500 && received < chunkSize; ++attempt) {
+				CPPUNIT_ASSERT_EQUAL( true, client->flushSendQueue() );
+				if(accepted->hasDataToReadWithWait(10000) == true) {
+					int result = accepted->receive(&buffer[received], chunkSize - received, false);
+					if(result > 0) {
+						received += result;
+					}
+				}
+			}
+			CPPUNIT_ASSERT_EQUAL( chunkSize, received );
+			CPPUNIT_ASSERT_EQUAL( (char)('a' + (index % 26)), buffer[0] );
+			CPPUNIT_ASSERT_EQUAL( (char)('a' + (index % 26)), buffer[chunkSize - 1] );
+		}
+		CPPUNIT_ASSERT_EQUAL( (int64)0, client->getSendQueueSize() );
+		CPPUNIT_ASSERT_EQUAL( (int64)chunkSize * chunkCount, client->getSentByteCount() );
+	}
+
+	void test_send_queue_limit() {
+		const int chunkSize = 64 * 1024;
+		const int maxQueueBytes = 256 * 1024;
+		std::vector<char> chunk(chunkSize, 'q');
+		client->enableSendQueue(maxQueueBytes);
+
+		// nobody reads, so the queue grows until the socket gives up
+		int result = 0;
+		int sentChunks = 0;
+		for(; sentChunks < 1024 && result >= 0; ++sentChunks) {
+			result = client->send(&chunk[0], chunkSize);
+		}
+		CPPUNIT_ASSERT_EQUAL( -1, result );
+		CPPUNIT_ASSERT( client->getSendQueueSize() <= maxQueueBytes + chunkSize );
+		CPPUNIT_ASSERT_EQUAL( false, client->isSocketValid() );
+	}
+
+	void test_receive_tap() {
+		const char first[] = "tapped";
+		const char second[] = "twice";
+		ReceiveTap tap;
+		accepted->setReceiveTap(&tap);
+
+		CPPUNIT_ASSERT_EQUAL( (int)sizeof(first), client->send(first, sizeof(first)) );
+		CPPUNIT_ASSERT_EQUAL( (int)sizeof(second), client->send(second, sizeof(second)) );
+		drain(sizeof(first) + sizeof(second));
+
+		// peeks are not received bytes
+		CPPUNIT_ASSERT_EQUAL( (int)sizeof(first), client->send(first, sizeof(first)) );
+		char peekBuffer[sizeof(first)];
+		for(int attempt = 0; attempt < 100 && accepted->peek(peekBuffer, sizeof(peekBuffer), false) <= 0; ++attempt) {
+			accepted->hasDataToReadWithWait(10000);
+		}
+		accepted->setReceiveTap(NULL);
+		drain(sizeof(first));
+
+		CPPUNIT_ASSERT_EQUAL( sizeof(first) + sizeof(second), tap.bytes.size() );
+		CPPUNIT_ASSERT_EQUAL( std::string(first), std::string(&tap.bytes[0]) );
+		CPPUNIT_ASSERT_EQUAL( std::string(second), std::string(&tap.bytes[sizeof(first)]) );
+	}
+};
+
+//
+// Loopback message rates, run with megaglest_tests --benchmark
+//
+class SocketSendBenchmark : public SocketSendTest {
+	CPPUNIT_TEST_SUITE( SocketSendBenchmark );
+
+	CPPUNIT_TEST( test_small_message_rate );
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void test_small_message_rate() {
+		const int messageCount = 20000;
+		const int messagesPerFrame = 16;
+		const int messageSize = 1 + payloadSize;
+		const char type = 3;
+		char payload[payloadSize];
+		memset(payload, 'x', payloadSize);
+
+		// a copy into a fresh buffer for every message
+		Chrono chronoCopy(true);
+		for(int index = 0; index < messageCount; index += messagesPerFrame) {
+			for(int message = 0; message < messagesPerFrame; ++message) {
+				char *out_buffer = new char[messageSize];
+				out_buffer[0] = type;
+				memcpy(&out_buffer[1], payload, payloadSize);
+				CPPUNIT_ASSERT_EQUAL( messageSize, client->send(out_buffer, messageSize) );
+				delete [] out_buffer;
+			}
+			drain(messagesPerFrame * messageSize);
+		}
+		int64 copyMicros = chronoCopy.getMicros();
+
+		// type and payload in one gather write
+		const void *parts[] 	= { &type, payload };
+		const int partSizes[] 	= { 1, payloadSize };
+		Chrono chronoGather(true);
+		for(int index = 0; index < messageCount; index += messagesPerFrame) {
+			for(int message = 0; message < messagesPerFrame; ++message) {
+				CPPUNIT_ASSERT_EQUAL( messageSize, client->sendv(parts, partSizes, 2) );
+			}
+			drain(messagesPerFrame * messageSize);
+		}
+		int64 gatherMicros = chronoGather.getMicros();
+
+		// all messages of a frame in one write
+		Chrono chronoBatch(true);
+		for(int index = 0; index < messageCount; index += messagesPerFrame) {
+			client->beginSendBatch();
+			for(int message = 0; message < messagesPerFrame; ++message) {
+				CPPUNIT_ASSERT_EQUAL( messageSize, client->sendv(parts, partSizes, 2) );
+			}
+			CPPUNIT_ASSERT_EQUAL( true, client->endSendBatch() );
+			drain(messagesPerFrame * messageSize);
+		}
+		int64 batchMicros = chronoBatch.getMicros();
+
+		printf("\nLoopback send benchmark: %d byte messages, copy: %.0f msgs/sec, gather: %.0f msgs/sec, batched by %d: %.0f msgs/sec\n",
+				messageSize,
+				copyMicros > 0 ? messageCount * 1000000.0 / copyMicros : 0.0,
+				gatherMicros > 0 ? messageCount * 1000000.0 / gatherMicros : 0.0,
+				messagesPerFrame,
+				batchMicros > 0 ? messageCount * 1000000.0 / batchMicros : 0.0);
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( SocketSendTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( SocketSendBenchmark, "benchmarks" );
@@ -0,0 +1,248 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "work_stealing_scheduler.h"
+#include "platform_util.h"
+#include "randomgen.h"
+#include "thread.h"
+#include <map>
+#include <vector>
+#include <string>
+
+using namespace Shared::PlatformCommon;
+using namespace Shared::Platform;
+using Shared::Util::RandomGen;
+
+//
+// Task list recording which worker ran each task
+//
+class CountingTaskList : public WorkStealingTaskInterface {
+public:
+	std::vector<int> runCount;
+	std::vector<int> workerUsed;
+	std::vector<int> reportedWorker;
+	int failAt;
+
+	explicit CountingTaskList(int taskCount) : runCount(taskCount, 0), workerUsed(taskCount, -1),
+		reportedWorker(taskCount, -1), failAt(-1) {}
+
+	virtual void executeTask(int workerIndex, int taskIndex) {
+		// uneven amounts of work so the fast workers have to steal
+		int spin = (taskIndex % 7 == 0 ? 20000 : 100);
+		volatile int sum = 0;
+		for(int i = 0; i < spin; ++i) {
+			sum += i;
+		}
+		runCount[taskIndex]++;
+		workerUsed[taskIndex] = workerIndex;
+		reportedWorker[taskIndex] = WorkStealingScheduler::getCurrentWorkerIndex();
+		if(taskIndex == failAt) {
+			throw megaglest_runtime_error("task failed");
+		}
+	}
+};
+
+//
+// Units of two factions looking up their faction's target cache the way
+// the unit pre-processing does: the cache is only read while the tasks
+// run, draws come from a generator seeded by the unit and the frame, and
+// stale targets are erased on the calling thread after the run
+//
+class PrecacheTaskList : public WorkStealingTaskInterface {
+public:
+	static const int factionCount = 2;
+
+	// target position and amount left, 0 once it's used up
+	std::map<int,int> cache[factionCount];
+	std::vector<int> unitFaction;
+	std::vector<int> results;
+	int frameIndex;
+
+	Mutex mutexStale;
+	std::vector<int> staleTargets[factionCount];
+
+	explicit PrecacheTaskList(int unitCount) : unitFaction(unitCount), results(unitCount, -1), frameIndex(0) {
+		for(int unitId = 0; unitId < unitCount; ++unitId) {
+			unitFaction[unitId] = (unitId % 5 == 0 ? 1 : 0);
+		}
+		for(int pos = 0; pos < 64; ++pos) {
+			cache[pos % factionCount][pos] = 1 + pos % 3;
+		}
+	}
+
+	virtual void executeTask(int workerIndex, int taskIndex) {
+		int faction = unitFaction[taskIndex];
+		RandomGen random;
+		random.init(taskIndex * 7919 + frameIndex);
+		bool forward = (random.randRange(0,1) == 0);
+
+		int result = -1;
+		std::vector<int> stale;
+		for(std::map<int,int>::iterator iter = cache[faction].begin(); iter != cache[faction].end(); ++iter) {
+			if(iter->second <= 0) {
+				stale.push_back(iter->first);
+			}
+			else if(result < 0 || forward == false) {
+				result = iter->first;
+			}
+		}
+		volatile int sum = 0;
+		for(int i = 0; i < (taskIndex % 3 == 0 ? 5000 : 50); ++i) {
+			sum += i;
+		}
+		results[taskIndex] = result;
+
+		MutexSafeWrapper safeMutex(&mutexStale);
+		staleTargets[faction].insert(staleTargets[faction].end(), stale.begin(), stale.end());
+	}
+
+	// the commit step, in unit order on the calling thread
+	void commit() {
+		for(int faction = 0; faction < factionCount; ++faction) {
+			for(unsigned int i = 0; i < staleTargets[faction].size(); ++i) {
+				cache[faction].erase(staleTargets[faction][i]);
+			}
+			staleTargets[faction].clear();
+		}
+		for(unsigned int unitId = 0; unitId < results.size(); ++unitId) {
+			if(results[unitId] >= 0) {
+				cache[unitFaction[unitId]][results[unitId]]--;
+			}
+		}
+		frameIndex++;
+	}
+};
+
+//
+// Tests for the work stealing scheduler used for the unit updates
+//
+class WorkStealingSchedulerTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( WorkStealingSchedulerTest );
+
+	CPPUNIT_TEST( test_every_task_runs_once );
+	CPPUNIT_TEST( test_repeated_runs );
+	CPPUNIT_TEST( test_task_error_is_rethrown );
+	CPPUNIT_TEST( test_schedulers_side_by_side );
+	CPPUNIT_TEST( test_serial_and_parallel_runs_match );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_every_task_runs_once() {
+		WorkStealingScheduler scheduler(4, 3);
+		CPPUNIT_ASSERT_EQUAL( 4, scheduler.getWorkerCount() );
+
+		CountingTaskList tasks(1000);
+		scheduler.run(&tasks, (int)tasks.runCount.size());
+
+		for(unsigned int i = 0; i < tasks.runCount.size(); ++i) {
+			CPPUNIT_ASSERT_EQUAL( 1, tasks.runCount[i] );
+			CPPUNIT_ASSERT( tasks.workerUsed[i] >= 0 && tasks.workerUsed[i] < scheduler.getWorkerCount() );
+			CPPUNIT_ASSERT_EQUAL( tasks.workerUsed[i], tasks.reportedWorker[i] );
+		}
+		// the calling thread is not a pool thread
+		CPPUNIT_ASSERT_EQUAL( 0, WorkStealingScheduler::getCurrentWorkerIndex() );
+	}
+
+	void test_repeated_runs() {
+		WorkStealingScheduler scheduler(3, 1);
+		for(int run = 0; run < 200; ++run) {
+			CountingTaskList tasks(run % 17);
+			scheduler.run(&tasks, (int)tasks.runCount.size());
+			for(unsigned int i = 0; i < tasks.runCount.size(); ++i) {
+				CPPUNIT_ASSERT_EQUAL( 1, tasks.runCount[i] );
+			}
+		}
+	}
+
+	void test_task_error_is_rethrown() {
+		WorkStealingScheduler scheduler(2, 2);
+		CountingTaskList tasks(50);
+		tasks.failAt = 31;
+
+		bool caught = false;
+		try {
+			scheduler.run(&tasks, (int)tasks.runCount.size());
+		}
+		catch(const megaglest_runtime_error &ex) {
+			caught = (std::string(ex.what()).find("task failed") != std::string::npos);
+		}
+		CPPUNIT_ASSERT_EQUAL( true, caught );
+
+		// the other chunks still ran and the scheduler can be reused
+		CPPUNIT_ASSERT_EQUAL( 1, tasks.runCount[0] );
+		CPPUNIT_ASSERT_EQUAL( 1, tasks.runCount[49] );
+		CountingTaskList next(10);
+		scheduler.run(&next, (int)next.runCount.size());
+		CPPUNIT_ASSERT_EQUAL( 1, next.runCount[9] );
+	}
+
+	void test_schedulers_side_by_side() {
+		WorkStealingScheduler scheduler(4, 1);
+		{
+			// a short lived pool must not take the worker indexes of the other
+			WorkStealingScheduler other(3, 1);
+			CountingTaskList tasks(300);
+			other.run(&tasks, (int)tasks.runCount.size());
+			for(unsigned int i = 0; i < tasks.runCount.size(); ++i) {
+				CPPUNIT_ASSERT_EQUAL( tasks.workerUsed[i], tasks.reportedWorker[i] );
+			}
+		}
+
+		CountingTaskList tasks(300);
+		scheduler.run(&tasks, (int)tasks.runCount.size());
+		for(unsigned int i = 0; i < tasks.runCount.size(); ++i) {
+			CPPUNIT_ASSERT_EQUAL( 1, tasks.runCount[i] );
+			CPPUNIT_ASSERT_EQUAL( tasks.workerUsed[i], tasks.reportedWorker[i] );
+		}
+	}
+
+	void test_serial_and_parallel_runs_match() {
+		const int unitCount = 120;
+		const int frameCount = 40;
+
+		// serially in unit order, like with world synch logging on
+		PrecacheTaskList serial(unitCount);
+		std::vector<int> serialResults;
+		for(int frame = 0; frame < frameCount; ++frame) {
+			for(int unitId = 0; unitId < unitCount; ++unitId) {
+				serial.executeTask(0, unitId);
+			}
+			serialResults.insert(serialResults.end(), serial.results.begin(), serial.results.end());
+			serial.commit();
+		}
+
+		for(int chunkSize = 1; chunkSize <= 4; chunkSize += 3) {
+			WorkStealingScheduler scheduler(4, chunkSize);
+			PrecacheTaskList parallel(unitCount);
+			std::vector<int> parallelResults;
+			for(int frame = 0; frame < frameCount; ++frame) {
+				scheduler.run(&parallel, unitCount);
+				parallelResults.insert(parallelResults.end(), parallel.results.begin(), parallel.results.end());
+				parallel.commit();
+			}
+
+			CPPUNIT_ASSERT( serialResults == parallelResults );
+			for(int faction = 0; faction < PrecacheTaskList::factionCount; ++faction) {
+				CPPUNIT_ASSERT( serial.cache[faction] == parallel.cache[faction] );
+			}
+		}
+		// the caches were used up on the way, so the runs saw stale targets
+		CPPUNIT_ASSERT( serial.cache[0].size() < 32 );
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( WorkStealingSchedulerTest );
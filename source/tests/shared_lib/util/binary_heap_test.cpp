@@ -0,0 +1,211 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "binary_heap.h"
+#include "platform_common.h"
+#include "vec.h"
+#include <map>
+#include <vector>
+#include <stdio.h>
+
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+using Shared::Graphics::Vec2i;
+
+//
+// Tests for the BinaryHeap used as the pathfinder open list
+//
+class BinaryHeapTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( BinaryHeapTest );
+
+	CPPUNIT_TEST( test_stable_order_matches_bucket_map );
+	CPPUNIT_TEST( test_grid_search_matches_map );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+protected:
+	static const int gridSize = 256;
+
+	// Greedy best first search over a grid with walls, expanding nodes in the
+	// same order as PathFinder::aStar. Returns the expanded cell sequence.
+	template<typename OpenList>
+	static std::vector<int> greedySearch(const std::vector<char> &walls, OpenList &open,
+										 const Vec2i &start, const Vec2i &goal, int maxNodes) {
+		std::vector<int> expanded;
+		std::vector<char> visited(walls.size(), 0);
+
+		open.add(start.dist(goal), start.y * gridSize + start.x);
+		visited[start.y * gridSize + start.x] = 1;
+		int nodeCount = 1;
+
+		while(open.empty() == false) {
+			int cell = open.take();
+			expanded.push_back(cell);
+			Vec2i pos(cell % gridSize, cell / gridSize);
+			if(pos == goal) {
+				break;
+			}
+			for(int i = 1; i >= -1; --i) {
+				for(int j = 1; j >= -1; --j) {
+					Vec2i sucPos = pos + Vec2i(i, j);
+					if(sucPos.x < 0 || sucPos.y < 0 || sucPos.x >= gridSize || sucPos.y >= gridSize) {
+						continue;
+					}
+					int sucCell = sucPos.y * gridSize + sucPos.x;
+					if(visited[sucCell] != 0 || walls[sucCell] != 0) {
+						continue;
+					}
+					if(nodeCount >= maxNodes) {
+						return expanded;
+					}
+					visited[sucCell] = 1;
+					nodeCount++;
+					open.add(sucPos.dist(goal), sucCell);
+				}
+			}
+		}
+		return expanded;
+	}
+
+	class MapOpenList {
+	public:
+		std::map<float, std::vector<int> > nodes;
+
+		bool empty() const { return nodes.empty(); }
+		void add(float key, int cell) { nodes[key].push_back(cell); }
+		int take() {
+			int result = nodes.begin()->second.front();
+			nodes.begin()->second.erase(nodes.begin()->second.begin());
+			if(nodes.begin()->second.empty()) {
+				nodes.erase(nodes.begin());
+			}
+			return result;
+		}
+	};
+
+	class HeapOpenList {
+	public:
+		BinaryHeap<int> nodes;
+
+		bool empty() const { return nodes.empty(); }
+		void add(float key, int cell) { nodes.push(key, cell); }
+		int take() { return nodes.pop(); }
+	};
+
+	static std::vector<char> buildWalls() {
+		std::vector<char> walls(gridSize * gridSize, 0);
+		// Vertical walls with staggered gaps force long detours
+		for(int x = 32; x < gridSize; x += 32) {
+			int gap = (x / 32) % 2 == 0 ? 8 : gridSize - 8;
+			for(int y = 0; y < gridSize; ++y) {
+				if(y < gap - 2 || y > gap + 2) {
+					walls[y * gridSize + x] = 1;
+				}
+			}
+		}
+		return walls;
+	}
+
+public:
+
+	void test_stable_order_matches_bucket_map() {
+		BinaryHeap<int> heap;
+		std::map<float, std::vector<int> > reference;
+
+		unsigned int seed = 12345;
+		for(int i = 0; i < 5000; ++i) {
+			seed = seed * 1103515245 + 12345;
+			// Few distinct keys so many entries share a bucket
+			float key = (float)((seed >> 16) % 37) * 0.5f;
+			heap.push(key, i);
+			reference[key].push_back(i);
+		}
+
+		while(reference.empty() == false) {
+			CPPUNIT_ASSERT_EQUAL( false, heap.empty() );
+			int expected = reference.begin()->second.front();
+			reference.begin()->second.erase(reference.begin()->second.begin());
+			if(reference.begin()->second.empty()) {
+				reference.erase(reference.begin());
+			}
+			CPPUNIT_ASSERT_EQUAL( expected, heap.pop() );
+		}
+		CPPUNIT_ASSERT_EQUAL( true, heap.empty() );
+	}
+
+	void test_grid_search_matches_map() {
+		const std::vector<char> walls = buildWalls();
+		const Vec2i start(2, 2);
+		const Vec2i goal(gridSize - 3, gridSize - 3);
+
+		MapOpenList mapOpen;
+		std::vector<int> mapExpanded = greedySearch(walls, mapOpen, start, goal, gridSize * gridSize);
+		HeapOpenList heapOpen;
+		std::vector<int> heapExpanded = greedySearch(walls, heapOpen, start, goal, gridSize * gridSize);
+
+		// Both open lists must expand exactly the same cells in the same order
+		CPPUNIT_ASSERT_EQUAL( mapExpanded.size(), heapExpanded.size() );
+		CPPUNIT_ASSERT( mapExpanded == heapExpanded );
+		CPPUNIT_ASSERT( mapExpanded.back() == goal.y * gridSize + goal.x );
+	}
+};
+
+//
+// Open list timings, run with megaglest_tests --benchmark
+//
+class BinaryHeapBenchmark : public BinaryHeapTest {
+	CPPUNIT_TEST_SUITE( BinaryHeapBenchmark );
+
+	CPPUNIT_TEST( test_grid_search_expansion_rate );
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void test_grid_search_expansion_rate() {
+		const std::vector<char> walls = buildWalls();
+		const Vec2i start(2, 2);
+		const Vec2i goal(gridSize - 3, gridSize - 3);
+		const int maxNodes = gridSize * gridSize;
+		const int iterations = 10;
+
+		std::vector<int> mapExpanded;
+		Chrono chronoMap(true);
+		for(int i = 0; i < iterations; ++i) {
+			MapOpenList open;
+			mapExpanded = greedySearch(walls, open, start, goal, maxNodes);
+		}
+		int64 mapMicros = chronoMap.getMicros();
+
+		std::vector<int> heapExpanded;
+		Chrono chronoHeap(true);
+		for(int i = 0; i < iterations; ++i) {
+			HeapOpenList open;
+			heapExpanded = greedySearch(walls, open, start, goal, maxNodes);
+		}
+		int64 heapMicros = chronoHeap.getMicros();
+
+		CPPUNIT_ASSERT( mapExpanded == heapExpanded );
+
+		double expansions = (double)mapExpanded.size() * iterations;
+		printf("\nOpen list benchmark: %d expansions per search, map: %.0f nodes/sec, heap: %.0f nodes/sec\n",
+				(int)mapExpanded.size(),
+				mapMicros > 0 ? expansions * 1000000.0 / mapMicros : 0.0,
+				heapMicros > 0 ? expansions * 1000000.0 / heapMicros : 0.0);
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( BinaryHeapTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( BinaryHeapBenchmark, "benchmarks" );
@@ -0,0 +1,125 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "checksum.h"
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <stdio.h>
+#include "platform_common.h"
+
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+//
+// Tests for the checksum class, network synch checks compare these
+// values between clients so they must never change
+//
+class ChecksumTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ChecksumTest );
+
+	CPPUNIT_TEST( test_known_value );
+	CPPUNIT_TEST( test_bytes_match_byte_wise );
+	CPPUNIT_TEST( test_integers_low_byte_first );
+	CPPUNIT_TEST( test_merged_file_lists );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_known_value() {
+		Checksum checksum;
+		checksum.addString("123456789");
+		CPPUNIT_ASSERT_EQUAL( (uint32)0xCBF43926, checksum.getSum() );
+	}
+
+	void test_bytes_match_byte_wise() {
+		srand(4321);
+		for(int length = 0; length < 70; ++length) {
+			std::vector<char> data(length + 1);
+			for(int index = 0; index < length; ++index) {
+				data[index] = (char)(rand() % 256);
+			}
+
+			Checksum byteWise;
+			byteWise.addInt(length);
+			for(int index = 0; index < length; ++index) {
+				byteWise.addByte(data[index]);
+			}
+
+			// start off the word boundary too
+			Checksum sliced;
+			sliced.addInt(length);
+			sliced.addBytes(&data[0], length);
+
+			CPPUNIT_ASSERT_EQUAL( byteWise.getSum(), sliced.getSum() );
+		}
+	}
+
+	void test_integers_low_byte_first() {
+		Checksum byteWise;
+		const char bytes[] = { 0x78, 0x56, 0x34, 0x12, (char)0xF0, (char)0xDE, (char)0xBC, (char)0x9A };
+		for(int index = 0; index < 8; ++index) {
+			byteWise.addByte(bytes[index]);
+		}
+
+		Checksum fromInt;
+		fromInt.addInt(0x12345678);
+		fromInt.addUInt(0x9ABCDEF0u);
+		CPPUNIT_ASSERT_EQUAL( byteWise.getSum(), fromInt.getSum() );
+
+		Checksum fromInt64;
+		fromInt64.addInt64((int64)0x9ABCDEF012345678LL);
+		CPPUNIT_ASSERT_EQUAL( byteWise.getSum(), fromInt64.getSum() );
+	}
+
+	void test_merged_file_lists() {
+		std::vector<std::string> files;
+		for(int index = 0; index < 6; ++index) {
+			char name[64] = "";
+			snprintf(name, 64, "checksum_test_file_%d.txt", index);
+			FILE *f = fopen(name, "wb");
+			CPPUNIT_ASSERT( f != NULL );
+			fprintf(f, "content %d", index * 31);
+			fclose(f);
+			files.push_back(name);
+		}
+
+		Checksum serial;
+		for(unsigned int index = 0; index < files.size(); ++index) {
+			serial.addFile(files[index]);
+		}
+
+		// loaders filling their own lists in any order, a file may be in more than one
+		Checksum first;
+		Checksum second;
+		for(int index = (int)files.size() - 1; index >= 0; --index) {
+			(index % 2 == 0 ? first : second).addFile(files[index]);
+		}
+		second.addFile(files[0]);
+		Checksum merged;
+		merged.addFiles(second);
+		merged.addFiles(first);
+
+		CPPUNIT_ASSERT_EQUAL( serial.getFileCount(), merged.getFileCount() );
+		CPPUNIT_ASSERT_EQUAL( serial.getSum(), merged.getSum() );
+
+		for(unsigned int index = 0; index < files.size(); ++index) {
+			removeFile(files[index]);
+		}
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ChecksumTest );
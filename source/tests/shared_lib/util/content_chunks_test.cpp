@@ -0,0 +1,186 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "content_chunks.h"
+#include "platform_common.h"
+#include <cstdio>
+
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+//
+// Tests for chunked content manifests and chunk level resume
+//
+class ContentChunksTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( ContentChunksTest );
+
+	CPPUNIT_TEST( test_file_chunks );
+	CPPUNIT_TEST( test_stale_chunks );
+	CPPUNIT_TEST( test_resume_out_of_order );
+	CPPUNIT_TEST( test_folder_manifest );
+	CPPUNIT_TEST( test_safe_paths );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+	string testFolder;
+	vector<unsigned char> content;
+
+	void saveFile(const string &file, const vector<unsigned char> &data) {
+		createDirectoryPaths(extractDirectoryPathFromFile(file));
+		FILE *fp = fopen(file.c_str(), "wb");
+		CPPUNIT_ASSERT( fp != NULL );
+		if(data.empty() == false) {
+			fwrite(&data[0], 1, data.size(), fp);
+		}
+		fclose(fp);
+	}
+
+	vector<unsigned char> loadFile(const string &file) {
+		vector<unsigned char> result;
+		FILE *fp = fopen(file.c_str(), "rb");
+		CPPUNIT_ASSERT( fp != NULL );
+		int value = 0;
+		while((value = fgetc(fp)) != EOF) {
+			result.push_back((unsigned char)value);
+		}
+		fclose(fp);
+		return result;
+	}
+
+public:
+
+	void setUp() {
+		testFolder = "content_chunks_test/";
+		removeFolder(testFolder);
+		createDirectoryPaths(testFolder);
+
+		// two and a half chunks
+		content.resize(ContentChunks::chunkSize * 2 + ContentChunks::chunkSize / 2);
+		for(unsigned int index = 0; index < content.size(); ++index) {
+			content[index] = (unsigned char)((index * 7) ^ (index >> 8));
+		}
+	}
+
+	void tearDown() {
+		removeFolder(testFolder);
+	}
+
+	void test_file_chunks() {
+		saveFile(testFolder + "map.mgm", content);
+
+		ContentChunkFile contentFile;
+		CPPUNIT_ASSERT_EQUAL( true, ContentChunks::getFileChunks(testFolder + "map.mgm", contentFile) );
+		CPPUNIT_ASSERT_EQUAL( (uint32)content.size(), contentFile.size );
+		CPPUNIT_ASSERT_EQUAL( (size_t)3, contentFile.chunkCRCs.size() );
+		CPPUNIT_ASSERT_EQUAL( (uint32)3, ContentChunks::getChunkCount(contentFile.size) );
+		CPPUNIT_ASSERT_EQUAL( ContentChunks::getChunkCRC(&content[ContentChunks::chunkSize], ContentChunks::chunkSize),
+				contentFile.chunkCRCs[1] );
+
+		vector<ContentChunkFile> manifest;
+		CPPUNIT_ASSERT_EQUAL( true, ContentChunks::buildFileManifest(testFolder + "map.mgm", manifest) );
+		CPPUNIT_ASSERT_EQUAL( (size_t)1, manifest.size() );
+		CPPUNIT_ASSERT_EQUAL( string("map.mgm"), manifest[0].path );
+
+		CPPUNIT_ASSERT_EQUAL( false, ContentChunks::getFileChunks(testFolder + "missing.mgm", contentFile) );
+	}
+
+	void test_stale_chunks() {
+		saveFile(testFolder + "remote.bin", content);
+		ContentChunkFile remote;
+		ContentChunks::getFileChunks(testFolder + "remote.bin", remote);
+
+		// a missing local copy needs everything
+		CPPUNIT_ASSERT_EQUAL( (size_t)3, ContentChunks::getStaleChunks(testFolder + "local.bin", remote).size() );
+
+		// only the changed middle chunk
+		vector<unsigned char> local = content;
+		local[ContentChunks::chunkSize + 10] ^= 0xFF;
+		saveFile(testFolder + "local.bin", local);
+		vector<uint32> stale = ContentChunks::getStaleChunks(testFolder + "local.bin", remote);
+		CPPUNIT_ASSERT_EQUAL( (size_t)1, stale.size() );
+		CPPUNIT_ASSERT_EQUAL( (uint32)1, stale[0] );
+
+		// a cut off last chunk
+		local = content;
+		local.resize(content.size() - 100);
+		saveFile(testFolder + "local.bin", local);
+		stale = ContentChunks::getStaleChunks(testFolder + "local.bin", remote);
+		CPPUNIT_ASSERT_EQUAL( (size_t)1, stale.size() );
+		CPPUNIT_ASSERT_EQUAL( (uint32)2, stale[0] );
+
+		saveFile(testFolder + "local.bin", content);
+		CPPUNIT_ASSERT_EQUAL( (size_t)0, ContentChunks::getStaleChunks(testFolder + "local.bin", remote).size() );
+	}
+
+	void test_resume_out_of_order() {
+		saveFile(testFolder + "remote.bin", content);
+		ContentChunkFile remote;
+		ContentChunks::getFileChunks(testFolder + "remote.bin", remote);
+
+		// a larger stale file is written over and cut to size
+		vector<unsigned char> stale(content.size() + ContentChunks::chunkSize, 0xAB);
+		string partFile = testFolder + "part/sub/remote.bin";
+		saveFile(partFile, stale);
+
+		const uint32 order[] = { 2, 0 };
+		for(unsigned int index = 0; index < 2; ++index) {
+			vector<unsigned char> chunk;
+			CPPUNIT_ASSERT_EQUAL( true, ContentChunks::readChunk(testFolder + "remote.bin", order[index], chunk) );
+			CPPUNIT_ASSERT_EQUAL( remote.chunkCRCs[order[index]], ContentChunks::getChunkCRC(&chunk[0], (uint32)chunk.size()) );
+			CPPUNIT_ASSERT_EQUAL( true, ContentChunks::writeChunk(partFile, order[index], &chunk[0], (uint32)chunk.size()) );
+		}
+		CPPUNIT_ASSERT_EQUAL( true, ContentChunks::setFileSize(partFile, remote.size) );
+
+		// the interrupted transfer only needs the chunk it never got
+		vector<uint32> missing = ContentChunks::getStaleChunks(partFile, remote);
+		CPPUNIT_ASSERT_EQUAL( (size_t)1, missing.size() );
+		CPPUNIT_ASSERT_EQUAL( (uint32)1, missing[0] );
+
+		vector<unsigned char> chunk;
+		ContentChunks::readChunk(testFolder + "remote.bin", 1, chunk);
+		CPPUNIT_ASSERT_EQUAL( true, ContentChunks::writeChunk(partFile, 1, &chunk[0], (uint32)chunk.size()) );
+		CPPUNIT_ASSERT( loadFile(partFile) == content );
+	}
+
+	void test_folder_manifest() {
+		vector<unsigned char> small(10, 1);
+		saveFile(testFolder + "tech/b.xml", small);
+		saveFile(testFolder + "tech/factions/a/a.xml", content);
+		saveFile(testFolder + "tech/empty.txt", vector<unsigned char>());
+
+		vector<ContentChunkFile> manifest;
+		CPPUNIT_ASSERT_EQUAL( true, ContentChunks::buildFolderManifest(testFolder + "tech", manifest) );
+		CPPUNIT_ASSERT_EQUAL( (size_t)3, manifest.size() );
+		CPPUNIT_ASSERT_EQUAL( string("b.xml"), manifest[0].path );
+		CPPUNIT_ASSERT_EQUAL( string("empty.txt"), manifest[1].path );
+		CPPUNIT_ASSERT_EQUAL( (size_t)0, manifest[1].chunkCRCs.size() );
+		CPPUNIT_ASSERT_EQUAL( string("factions/a/a.xml"), manifest[2].path );
+		CPPUNIT_ASSERT_EQUAL( (uint32)content.size(), manifest[2].size );
+
+		CPPUNIT_ASSERT_EQUAL( false, ContentChunks::buildFolderManifest(testFolder + "missing", manifest) );
+	}
+
+	void test_safe_paths() {
+		CPPUNIT_ASSERT_EQUAL( true, ContentChunks::isSafeRelativePath("factions/tech/tech.xml") );
+		CPPUNIT_ASSERT_EQUAL( true, ContentChunks::isSafeRelativePath("map..mgm") );
+		CPPUNIT_ASSERT_EQUAL( false, ContentChunks::isSafeRelativePath("") );
+		CPPUNIT_ASSERT_EQUAL( false, ContentChunks::isSafeRelativePath("/etc/passwd") );
+		CPPUNIT_ASSERT_EQUAL( false, ContentChunks::isSafeRelativePath("../glestuser.ini") );
+		CPPUNIT_ASSERT_EQUAL( false, ContentChunks::isSafeRelativePath("factions/..\\..\\x") );
+		CPPUNIT_ASSERT_EQUAL( false, ContentChunks::isSafeRelativePath("c:/x") );
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( ContentChunksTest );
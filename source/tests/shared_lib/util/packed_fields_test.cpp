@@ -0,0 +1,283 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "packed_fields.h"
+#include "packed_format.h"
+#include "platform_common.h"
+#include <cstring>
+#include <vector>
+#include <stdio.h>
+
+using namespace Shared::Util;
+using namespace Shared::PlatformCommon;
+
+//
+// Tests for the typed field archives that pack network messages
+//
+class PackedFieldsTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( PackedFieldsTest );
+
+	CPPUNIT_TEST( test_round_trip );
+	CPPUNIT_TEST( test_matches_format_string_layout );
+	CPPUNIT_TEST( test_string_bounds );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+protected:
+	// Same fields and order as a NetworkCommand, "hlhhhhlccHccll"
+	class Command {
+	public:
+		int16 networkCommandType;
+		int32 unitId;
+		int16 unitTypeId;
+		int16 commandTypeId;
+		int16 positionX;
+		int16 positionY;
+		int32 targetId;
+		int8 wantQueue;
+		int8 fromFactionIndex;
+		uint16 unitFactionUnitCount;
+		int8 unitFactionIndex;
+		int8 commandStateType;
+		int32 commandStateValue;
+		int32 unitCommandGroupId;
+
+		template<class Archive>
+		void serializeFields(Archive &archive) {
+			archive & networkCommandType & unitId & unitTypeId & commandTypeId
+				& positionX & positionY & targetId & wantQueue & fromFactionIndex
+				& unitFactionUnitCount & unitFactionIndex & commandStateType
+				& commandStateValue & unitCommandGroupId;
+		}
+
+		unsigned int pack(unsigned char *buf) {
+			return Shared::Util::pack(buf, "hlhhhhlccHccll",
+					networkCommandType, unitId, unitTypeId, commandTypeId,
+					positionX, positionY, targetId, wantQueue, fromFactionIndex,
+					unitFactionUnitCount, unitFactionIndex, commandStateType,
+					commandStateValue, unitCommandGroupId);
+		}
+	};
+
+	static Command makeCommand(int index) {
+		Command command;
+		command.networkCommandType		= (int16)(index % 12);
+		command.unitId					= 100000 + index;
+		command.unitTypeId				= (int16)(index % 40);
+		command.commandTypeId			= (int16)-1;
+		command.positionX				= (int16)(index % 256);
+		command.positionY				= (int16)-(index % 256);
+		command.targetId				= -1;
+		command.wantQueue				= (int8)(index & 1);
+		command.fromFactionIndex		= (int8)(index % 8);
+		command.unitFactionUnitCount	= (uint16)(60000 + index % 1000);
+		command.unitFactionIndex		= (int8)-(index % 8);
+		command.commandStateType		= 0;
+		command.commandStateValue		= -index;
+		command.unitCommandGroupId		= index * 3;
+		return command;
+	}
+
+public:
+
+	void test_round_trip() {
+		int8 c = -5;
+		uint8 C = 250;
+		int16 h = -12345;
+		uint16 H = 54321;
+		int32 l = -123456789;
+		uint32 L = 0xDEADBEEFu;
+		int64 q = -1234567890123LL;
+		uint64 Q = 0xFEDCBA9876543210ULL;
+		char text[16] = "megapack";
+
+		PackedFieldSizer sizer;
+		sizer & c & C & h & H & l & L & q & Q & PackedString(text, 16, 16);
+		CPPUNIT_ASSERT_EQUAL( (unsigned int)(1 + 1 + 2 + 2 + 4 + 4 + 8 + 8 + 2 + 15), sizer.getSize() );
+
+		std::vector<unsigned char> buf(sizer.getSize());
+		PackedFieldWriter writer(&buf[0]);
+		writer & c & C & h & H & l & L & q & Q & PackedString(text, 16, 16);
+		CPPUNIT_ASSERT_EQUAL( sizer.getSize(), writer.getPosition() );
+
+		// integers go out big endian
+		CPPUNIT_ASSERT_EQUAL( (unsigned char)0xDE, buf[10] );
+		CPPUNIT_ASSERT_EQUAL( (unsigned char)0xEF, buf[13] );
+
+		int8 c2 = 0;
+		uint8 C2 = 0;
+		int16 h2 = 0;
+		uint16 H2 = 0;
+		int32 l2 = 0;
+		uint32 L2 = 0;
+		int64 q2 = 0;
+		uint64 Q2 = 0;
+		char text2[16] = "";
+
+		PackedFieldReader reader(&buf[0]);
+		reader & c2 & C2 & h2 & H2 & l2 & L2 & q2 & Q2 & PackedString(text2, 16, 16);
+		CPPUNIT_ASSERT_EQUAL( sizer.getSize(), reader.getPosition() );
+
+		CPPUNIT_ASSERT_EQUAL( c, c2 );
+		CPPUNIT_ASSERT_EQUAL( C, C2 );
+		CPPUNIT_ASSERT_EQUAL( h, h2 );
+		CPPUNIT_ASSERT_EQUAL( H, H2 );
+		CPPUNIT_ASSERT_EQUAL( l, l2 );
+		CPPUNIT_ASSERT_EQUAL( L, L2 );
+		CPPUNIT_ASSERT( q == q2 );
+		CPPUNIT_ASSERT( Q == Q2 );
+		CPPUNIT_ASSERT_EQUAL( std::string("megapack"), std::string(text2) );
+	}
+
+	void test_matches_format_string_layout() {
+		// the archives have to produce what pack() did so both sides agree
+		for(int index = 0; index < 100; ++index) {
+			Command command = makeCommand(index * 37);
+
+			unsigned char formatBuf[64];
+			unsigned int formatSize = command.pack(formatBuf);
+
+			unsigned char typedBuf[64];
+			PackedFieldWriter writer(typedBuf);
+			command.serializeFields(writer);
+
+			PackedFieldSizer sizer;
+			command.serializeFields(sizer);
+
+			CPPUNIT_ASSERT_EQUAL( formatSize, writer.getPosition() );
+			CPPUNIT_ASSERT_EQUAL( formatSize, sizer.getSize() );
+			CPPUNIT_ASSERT_EQUAL( 0, memcmp(formatBuf, typedBuf, formatSize) );
+
+			Command decoded;
+			PackedFieldReader reader(typedBuf);
+			decoded.serializeFields(reader);
+			CPPUNIT_ASSERT_EQUAL( command.unitId, decoded.unitId );
+			CPPUNIT_ASSERT_EQUAL( command.positionY, decoded.positionY );
+			CPPUNIT_ASSERT_EQUAL( command.unitFactionUnitCount, decoded.unitFactionUnitCount );
+			CPPUNIT_ASSERT_EQUAL( command.unitFactionIndex, decoded.unitFactionIndex );
+			CPPUNIT_ASSERT_EQUAL( command.commandStateValue, decoded.commandStateValue );
+		}
+
+		// strings, "Ns" always sends N - 1 bytes
+		int8 type = 7;
+		int16 playerIndex = -2;
+		int32 frame = 4242;
+		int64 pingTime = 1381234567LL;
+		char name[60];
+		memset(name, 0, sizeof(name));
+		strcpy(name, "player one");
+
+		unsigned char formatBuf[128];
+		unsigned int formatSize = pack(formatBuf, "chlq60s", type, playerIndex, frame, pingTime, name);
+
+		unsigned char typedBuf[128];
+		PackedFieldWriter writer(typedBuf);
+		writer & type & playerIndex & frame & pingTime & PackedString(name, 60, 60);
+
+		CPPUNIT_ASSERT_EQUAL( formatSize, writer.getPosition() );
+		CPPUNIT_ASSERT_EQUAL( 0, memcmp(formatBuf, typedBuf, formatSize) );
+	}
+
+	void test_string_bounds() {
+		// a buffer smaller than the packed width is padded with zeros
+		char shortText[4] = "abc";
+		unsigned char buf[64];
+		memset(buf, 0xFF, sizeof(buf));
+		PackedFieldWriter writer(buf);
+		writer & PackedString(shortText, 4, 10);
+		CPPUNIT_ASSERT_EQUAL( (unsigned int)(2 + 9), writer.getPosition() );
+		CPPUNIT_ASSERT_EQUAL( (unsigned char)9, buf[1] );
+		CPPUNIT_ASSERT_EQUAL( (unsigned char)'c', buf[4] );
+		CPPUNIT_ASSERT_EQUAL( (unsigned char)0, buf[10] );
+		CPPUNIT_ASSERT_EQUAL( (unsigned char)0xFF, buf[11] );
+
+		// and only gets what fits when reading
+		char smallBuffer[4];
+		memset(smallBuffer, 'x', sizeof(smallBuffer));
+		unsigned char longText[2 + 9] = { 0, 9, 'l', 'o', 'n', 'g', 'e', 'r', 0, 0, 0 };
+		PackedFieldReader reader(longText);
+		reader & PackedString(smallBuffer, 4, 10);
+		CPPUNIT_ASSERT_EQUAL( (unsigned int)(2 + 9), reader.getPosition() );
+		CPPUNIT_ASSERT_EQUAL( std::string("lon"), std::string(smallBuffer) );
+
+		// a length larger than the field can't move past it
+		unsigned char hostile[2 + 9 + 1] = { 0xFF, 0xFF, 'a', 'b', 0, 0, 0, 0, 0, 0, 0, 42 };
+		char text[10];
+		int8 next = 0;
+		PackedFieldReader hostileReader(hostile);
+		hostileReader & PackedString(text, 10, 10) & next;
+		CPPUNIT_ASSERT_EQUAL( (unsigned int)(2 + 9 + 1), hostileReader.getPosition() );
+		CPPUNIT_ASSERT_EQUAL( std::string("ab"), std::string(text) );
+		CPPUNIT_ASSERT_EQUAL( (int8)42, next );
+	}
+};
+
+//
+// Format string against typed field packing rates, run with megaglest_tests --benchmark
+//
+class PackedFieldsBenchmark : public PackedFieldsTest {
+	CPPUNIT_TEST_SUITE( PackedFieldsBenchmark );
+
+	CPPUNIT_TEST( test_command_pack_rate );
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void test_command_pack_rate() {
+		const int commandCount = 1000;
+		const int iterations = 200;
+
+		std::vector<Command> commands;
+		for(int index = 0; index < commandCount; ++index) {
+			commands.push_back(makeCommand(index));
+		}
+		std::vector<unsigned char> formatBuf(commandCount * 64);
+		std::vector<unsigned char> typedBuf(commandCount * 64);
+
+		unsigned int formatSize = 0;
+		Chrono chronoFormat(true);
+		for(int i = 0; i < iterations; ++i) {
+			formatSize = 0;
+			for(int index = 0; index < commandCount; ++index) {
+				formatSize += commands[index].pack(&formatBuf[formatSize]);
+			}
+		}
+		int64 formatMicros = chronoFormat.getMicros();
+
+		unsigned int typedSize = 0;
+		Chrono chronoTyped(true);
+		for(int i = 0; i < iterations; ++i) {
+			PackedFieldWriter writer(&typedBuf[0]);
+			for(int index = 0; index < commandCount; ++index) {
+				commands[index].serializeFields(writer);
+			}
+			typedSize = writer.getPosition();
+		}
+		int64 typedMicros = chronoTyped.getMicros();
+
+		CPPUNIT_ASSERT_EQUAL( formatSize, typedSize );
+		CPPUNIT_ASSERT_EQUAL( 0, memcmp(&formatBuf[0], &typedBuf[0], typedSize) );
+
+		double packed = (double)commandCount * iterations;
+		printf("\nCommand pack benchmark: %u bytes per %d commands, format string: %.0f commands/sec, typed fields: %.0f commands/sec\n",
+				typedSize, commandCount,
+				formatMicros > 0 ? packed * 1000000.0 / formatMicros : 0.0,
+				typedMicros > 0 ? packed * 1000000.0 / typedMicros : 0.0);
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( PackedFieldsTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( PackedFieldsBenchmark, "benchmarks" );
@@ -0,0 +1,103 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include "varint_buffer.h"
+
+using namespace Shared::Util;
+
+//
+// Tests for the varint writer and reader used by compact network messages
+//
+class VarintBufferTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( VarintBufferTest );
+
+	CPPUNIT_TEST( test_unsigned_sizes );
+	CPPUNIT_TEST( test_round_trip );
+	CPPUNIT_TEST( test_truncated_input );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+public:
+
+	void test_unsigned_sizes() {
+		VarintWriter writer;
+		writer.writeUInt(0);
+		CPPUNIT_ASSERT_EQUAL( 1, writer.getSize() );
+		writer.writeUInt(127);
+		CPPUNIT_ASSERT_EQUAL( 2, writer.getSize() );
+		writer.writeUInt(128);
+		CPPUNIT_ASSERT_EQUAL( 4, writer.getSize() );
+		writer.writeUInt(0xFFFFFFFFu);
+		CPPUNIT_ASSERT_EQUAL( 9, writer.getSize() );
+
+		CPPUNIT_ASSERT_EQUAL( 1, VarintWriter::getUIntSize(127) );
+		CPPUNIT_ASSERT_EQUAL( 3, VarintWriter::getUIntSize(16384) );
+
+		// small negative numbers stay one byte
+		CPPUNIT_ASSERT_EQUAL( (uint32)1, VarintWriter::zigzagEncode(-1) );
+		CPPUNIT_ASSERT_EQUAL( (uint32)2, VarintWriter::zigzagEncode(1) );
+	}
+
+	void test_round_trip() {
+		const int32 values[] = { 0, 1, -1, 63, -64, 64, 300, -300, 0x7FFFFFFF, (int32)0x80000000 };
+		const int valueCount = sizeof(values) / sizeof(values[0]);
+
+		VarintWriter writer;
+		for(int index = 0; index < valueCount; ++index) {
+			writer.writeInt(values[index]);
+			writer.writeUInt((uint32)values[index]);
+		}
+		writer.writeFixedUInt(0xDEADBEEFu);
+		writer.writeByte(7);
+		writer.writeString("techs/megapack");
+		writer.writeString("");
+
+		VarintReader reader(&writer.getBuffer()[0], writer.getSize());
+		for(int index = 0; index < valueCount; ++index) {
+			CPPUNIT_ASSERT_EQUAL( values[index], reader.readInt() );
+			CPPUNIT_ASSERT_EQUAL( (uint32)values[index], reader.readUInt() );
+		}
+		CPPUNIT_ASSERT_EQUAL( (uint32)0xDEADBEEFu, reader.readFixedUInt() );
+		CPPUNIT_ASSERT_EQUAL( (unsigned char)7, reader.readByte() );
+		CPPUNIT_ASSERT_EQUAL( std::string("techs/megapack"), reader.readString() );
+		CPPUNIT_ASSERT_EQUAL( std::string(""), reader.readString() );
+		CPPUNIT_ASSERT_EQUAL( true, reader.isAtEnd() );
+		CPPUNIT_ASSERT_EQUAL( false, reader.hasFailed() );
+	}
+
+	void test_truncated_input() {
+		const unsigned char unfinished[] = { 0x80, 0x80 };
+		VarintReader reader(unfinished, 2);
+		CPPUNIT_ASSERT_EQUAL( (uint32)0, reader.readUInt() );
+		CPPUNIT_ASSERT_EQUAL( true, reader.hasFailed() );
+
+		const unsigned char tooLong[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+		VarintReader longReader(tooLong, 6);
+		longReader.readUInt();
+		CPPUNIT_ASSERT_EQUAL( true, longReader.hasFailed() );
+
+		VarintReader emptyReader(unfinished, 0);
+		emptyReader.readFixedUInt();
+		CPPUNIT_ASSERT_EQUAL( true, emptyReader.hasFailed() );
+
+		// a string longer than what is left
+		const unsigned char shortString[] = { 0x05, 'a', 'b' };
+		VarintReader stringReader(shortString, 3);
+		CPPUNIT_ASSERT_EQUAL( std::string(""), stringReader.readString() );
+		CPPUNIT_ASSERT_EQUAL( true, stringReader.hasFailed() );
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( VarintBufferTest );
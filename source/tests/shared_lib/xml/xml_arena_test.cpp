@@ -0,0 +1,282 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <fstream>
+#include <stdio.h>
+#include "xml_parser.h"
+#include "xml_arena.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "properties.h"
+#include "conversion.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using namespace Shared::Xml;
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+using namespace Shared::Util;
+
+//
+// Tests for XML trees allocated in an arena
+//
+class XmlArenaTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( XmlArenaTest );
+
+	CPPUNIT_TEST( test_same_tree );
+	CPPUNIT_TEST( test_edit_arena_tree );
+	CPPUNIT_TEST( test_failed_load );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+protected:
+	static string getUnitXml(int index) {
+		string id = intToStr(index);
+		string xml =
+			"<?xml version=\"1.0\" standalone=\"no\"?>"
+			"<unit>"
+			"<parameters>"
+			"<size value=\"2\"/>"
+			"<height value=\"3\"/>"
+			"<max-hp value=\"" + intToStr(1000 + index) + "\" regeneration=\"0\"/>"
+			"<max-ep value=\"0\"/>"
+			"<armor value=\"" + intToStr(index % 20) + "\"/>"
+			"<armor-type value=\"stone\"/>"
+			"<sight value=\"15\"/>"
+			"<time value=\"300\"/>"
+			"<multi-selection value=\"false\"/>"
+			"<cellmap value=\"false\"/>"
+			"<levels/>"
+			"<fields><field value=\"land\"/></fields>"
+			"<properties/>"
+			"<light enabled=\"false\"/>"
+			"<unit-requirements/>"
+			"<upgrade-requirements/>"
+			"<resource-requirements><resource name=\"wood\" amount=\"" + id + "\"/></resource-requirements>"
+			"<image path=\"images/unit" + id + ".bmp\"/>"
+			"<image-cancel path=\"$COMMONDATAPATH/images/cancel.bmp\"/>"
+			"<meeting-point value=\"true\" image-path=\"images/meeting_point.bmp\"/>"
+			"<selection-sounds enabled=\"true\">"
+			"<sound path=\"sounds/unit" + id + "_select1.wav\"/>"
+			"<sound path=\"sounds/unit" + id + "_select2.wav\"/>"
+			"</selection-sounds>"
+			"<command-sounds enabled=\"true\">"
+			"<sound path=\"sounds/unit" + id + "_ok1.wav\"/>"
+			"</command-sounds>"
+			"</parameters>"
+			"<skills>";
+		const char *skillNames[] = { "stop", "move", "attack", "be_built", "die", "produce" };
+		for(int skill = 0; skill < 6; ++skill) {
+			xml += string("<skill><type value=\"") + skillNames[skill] + "\"/>"
+				"<name value=\"" + skillNames[skill] + "_skill\"/>"
+				"<ep-cost value=\"0\"/><speed value=\"" + intToStr(100 + skill * 50) + "\"/>"
+				"<anim-speed value=\"100\"/>"
+				"<animation path=\"models/unit" + id + "_" + skillNames[skill] + ".g3d\"/>"
+				"<sound enabled=\"true\" start-time=\"0\"><sound-file path=\"sounds/" + skillNames[skill] + ".wav\"/></sound>"
+				"</skill>";
+		}
+		xml += "</skills><commands>"
+			"<command><type value=\"stop\"/><name value=\"stop\"/>"
+			"<image path=\"images/stop.bmp\"/><unit-requirements/><upgrade-requirements/>"
+			"<stop-skill value=\"stop_skill\"/></command>"
+			"<command><type value=\"move\"/><name value=\"move\"/>"
+			"<image path=\"images/move.bmp\"/><unit-requirements/><upgrade-requirements/>"
+			"<move-skill value=\"move_skill\"/></command>"
+			"</commands>"
+			"<description>Unit number " + id + "</description>"
+			"</unit>";
+		return xml;
+	}
+
+	static void writeFile(const string &file, const string &data) {
+		std::ofstream out(file.c_str(), std::ios::binary);
+		out << data;
+	}
+
+	static void assertSameTree(const XmlNode *expected, const XmlNode *actual) {
+		CPPUNIT_ASSERT( actual != NULL );
+		CPPUNIT_ASSERT_EQUAL( expected->getName(), actual->getName() );
+		CPPUNIT_ASSERT_EQUAL( expected->getText(), actual->getText() );
+		CPPUNIT_ASSERT_EQUAL( expected->getAttributeCount(), actual->getAttributeCount() );
+		for(unsigned int i = 0; i < expected->getAttributeCount(); ++i) {
+			const XmlAttribute *expectedAttribute = expected->getAttribute(i);
+			const XmlAttribute *actualAttribute = actual->getAttribute(i);
+			CPPUNIT_ASSERT_EQUAL( expectedAttribute->getName(), actualAttribute->getName() );
+			CPPUNIT_ASSERT_EQUAL( expectedAttribute->getValue("prefix/"), actualAttribute->getValue("prefix/") );
+			CPPUNIT_ASSERT( actual->getAttribute(expectedAttribute->getName()) == actualAttribute );
+		}
+		CPPUNIT_ASSERT_EQUAL( expected->getChildCount(), actual->getChildCount() );
+		for(unsigned int i = 0; i < expected->getChildCount(); ++i) {
+			assertSameTree(expected->getChild(i), actual->getChild(i));
+		}
+	}
+
+	static size_t getHeapInUse() {
+#if defined(__GLIBC__) && defined(__GLIBC_PREREQ)
+#if __GLIBC_PREREQ(2,33)
+		return mallinfo2().uordblks;
+#else
+		return (size_t)mallinfo().uordblks;
+#endif
+#else
+		return 0;
+#endif
+	}
+
+public:
+
+	void test_same_tree() {
+		std::map<string,string> mapTagReplacementValues;
+		mapTagReplacementValues["$COMMONDATAPATH"] = "techs/test/commondata/";
+
+		XmlTree heapTree;
+		heapTree.setArenaEnabled(false);
+		heapTree.loadFromString(getUnitXml(7), mapTagReplacementValues);
+		CPPUNIT_ASSERT( heapTree.getArena() == NULL );
+
+		XmlTree arenaTree;
+		arenaTree.loadFromString(getUnitXml(7), mapTagReplacementValues);
+		CPPUNIT_ASSERT( arenaTree.getArena() != NULL );
+
+		assertSameTree(heapTree.getRootNode(), arenaTree.getRootNode());
+
+		// values with tags own their replaced text and skip the prefix
+		const XmlNode *parameters = arenaTree.getRootNode()->getChild("parameters");
+		CPPUNIT_ASSERT_EQUAL( string("techs/test/commondata//images/cancel.bmp"),
+				parameters->getChild("image-cancel")->getAttribute("path")->getValue("prefix/") );
+		CPPUNIT_ASSERT_EQUAL( string("prefix/images/unit7.bmp"),
+				parameters->getChild("image")->getAttribute("path")->getRestrictedValue("prefix/") );
+		CPPUNIT_ASSERT_EQUAL( 1007, parameters->getChild("max-hp")->getAttribute("value")->getIntValue() );
+		CPPUNIT_ASSERT_EQUAL( false, parameters->getChild("multi-selection")->getAttribute("value")->getBoolValue() );
+		CPPUNIT_ASSERT( parameters->getChild("max-hp")->getAttribute("value")->getValueView() == "1007" );
+		CPPUNIT_ASSERT( parameters->getChild("max-hp")->hasAttribute("regeneration") == true );
+		CPPUNIT_ASSERT( parameters->getChild("max-hp")->getAttribute("missing",false) == NULL );
+		CPPUNIT_ASSERT_EQUAL( string("Unit number 7"), arenaTree.getRootNode()->getChild("description")->getText() );
+	}
+
+	void test_edit_arena_tree() {
+		std::map<string,string> mapTagReplacementValues;
+		XmlTree arenaTree;
+		arenaTree.loadFromString(getUnitXml(3), mapTagReplacementValues);
+		XmlNode *rootNode = arenaTree.getRootNode();
+
+		// nodes and attributes added later are owned by the tree as usual
+		XmlNode *added = rootNode->addChild("added", "text");
+		added->addAttribute("name", "value", mapTagReplacementValues);
+		rootNode->getChild("parameters")->getChild("size")->getAttribute("value")->setValue("4");
+		CPPUNIT_ASSERT_EQUAL( 1, rootNode->clearChild("commands") );
+
+		// saving keeps no element text, the rest has to come back
+		XmlTree copyTree;
+		copyTree.setArenaEnabled(false);
+		copyTree.loadFromString(arenaTree.saveToString(), mapTagReplacementValues);
+		CPPUNIT_ASSERT_EQUAL( rootNode->getChildCount(), copyTree.getRootNode()->getChildCount() );
+		assertSameTree(rootNode->getChild("skills"), copyTree.getRootNode()->getChild("skills"));
+		CPPUNIT_ASSERT_EQUAL( 4, copyTree.getRootNode()->getChild("parameters")->getChild("size")->getAttribute("value")->getIntValue() );
+		CPPUNIT_ASSERT_EQUAL( string("value"), copyTree.getRootNode()->getChild("added")->getAttribute("name")->getValue() );
+		CPPUNIT_ASSERT_EQUAL( false, copyTree.getRootNode()->hasChild("commands") );
+	}
+
+	void test_failed_load() {
+		std::map<string,string> mapTagReplacementValues;
+		XmlTree arenaTree;
+		// the attribute is broken after a good part of the tree was built
+		string xml = getUnitXml(1);
+		xml = xml.substr(0, xml.find("<commands>")) + "<commands><command name=\"x/></commands></unit>";
+
+		bool failed = false;
+		try {
+			arenaTree.loadFromString(xml, mapTagReplacementValues);
+		}
+		catch(const megaglest_runtime_error &) {
+			failed = true;
+		}
+		CPPUNIT_ASSERT( failed == true );
+		CPPUNIT_ASSERT( arenaTree.getRootNode() == NULL );
+
+		// and the tree can be used again
+		arenaTree.loadFromString(getUnitXml(1), mapTagReplacementValues);
+		CPPUNIT_ASSERT( arenaTree.getRootNode() != NULL );
+	}
+};
+
+//
+// Heap against arena tree load times and memory, run with megaglest_tests --benchmark
+//
+class XmlArenaBenchmark : public XmlArenaTest {
+	CPPUNIT_TEST_SUITE( XmlArenaBenchmark );
+
+	CPPUNIT_TEST( test_techtree_load_rate );
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void test_techtree_load_rate() {
+		// the unit files of a techtree with four factions
+		const int unitCount = 160;
+		vector<string> files;
+		for(int i = 0; i < unitCount; ++i) {
+			string file = "xml_arena_test_unit" + intToStr(i) + ".xml";
+			writeFile(file, getUnitXml(i));
+			files.push_back(file);
+		}
+
+		std::map<string,string> mapExtraTagReplacementValues;
+		mapExtraTagReplacementValues["$COMMONDATAPATH"] = "techs/test/commondata/";
+		std::map<string,string> mapTagReplacementValues = Properties::getTagReplacementValues(&mapExtraTagReplacementValues);
+
+		int64 micros[2] = { 0, 0 };
+		size_t heapBytes[2] = { 0, 0 };
+		size_t arenaBytes = 0;
+		// all trees stay loaded to see what a techtree holds at its peak
+		for(int mode = 0; mode < 2; ++mode) {
+			size_t heapBefore = getHeapInUse();
+			vector<XmlTree *> trees;
+			Chrono chrono(true);
+			for(unsigned int i = 0; i < files.size(); ++i) {
+				XmlTree *xmlTree = new XmlTree();
+				xmlTree->setArenaEnabled(mode == 1);
+				xmlTree->load(files[i], mapTagReplacementValues, false, true);
+				trees.push_back(xmlTree);
+			}
+			micros[mode] = chrono.getMicros();
+			heapBytes[mode] = getHeapInUse() - heapBefore;
+
+			for(unsigned int i = 0; i < trees.size(); ++i) {
+				if(trees[i]->getArena() != NULL) {
+					arenaBytes += trees[i]->getArena()->getAllocatedBytes();
+				}
+				delete trees[i];
+			}
+		}
+		for(unsigned int i = 0; i < files.size(); ++i) {
+			removeFile(files[i]);
+		}
+
+		CPPUNIT_ASSERT( arenaBytes > 0 );
+		printf("\nXML arena benchmark: %d files, heap trees: %.2f msecs %d KB, arena trees: %.2f msecs %d KB (%d KB in arenas)\n",
+				(int)files.size(),
+				micros[0] / 1000.0, (int)(heapBytes[0] / 1024),
+				micros[1] / 1000.0, (int)(heapBytes[1] / 1024),
+				(int)(arenaBytes / 1024));
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( XmlArenaTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( XmlArenaBenchmark, "benchmarks" );
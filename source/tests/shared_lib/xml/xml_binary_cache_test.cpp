@@ -0,0 +1,258 @@
+// ==============================================================
+//	This file is part of MegaGlest Unit Tests (www.megaglest.org)
+//
+//	Copyright (C) 2026 MegaGlest Team
+//
+//	You can redistribute this code and/or modify it under
+//	the terms of the GNU General Public License as published
+//	by the Free Software Foundation; either version 2 of the
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <fstream>
+#include <stdio.h>
+#include "xml_parser.h"
+#include "xml_binary_cache.h"
+#include "platform_common.h"
+#include "platform_util.h"
+#include "properties.h"
+#include "common_scoped_ptr.h"
+
+using namespace Shared::Xml;
+using namespace Shared::Platform;
+using namespace Shared::PlatformCommon;
+using namespace Shared::Util;
+
+//
+// Tests for the binary cache of parsed XML trees
+//
+class XmlBinaryCacheTest : public CppUnit::TestFixture {
+	// Register the suite of tests for this fixture
+	CPPUNIT_TEST_SUITE( XmlBinaryCacheTest );
+
+	CPPUNIT_TEST( test_tree_round_trip );
+	CPPUNIT_TEST( test_damaged_blob );
+	CPPUNIT_TEST( test_cache_file );
+
+	CPPUNIT_TEST_SUITE_END();
+	// End of Fixture registration
+
+protected:
+	static string getUnitXml() {
+		return
+			"<?xml version=\"1.0\" standalone=\"no\"?>"
+			"<unit>"
+			"<parameters>"
+			"<size value=\"2\"/>"
+			"<height value=\"3\"/>"
+			"<max-hp value=\"1200\" regeneration=\"0\"/>"
+			"<image path=\"images/castle.bmp\"/>"
+			"<sound path=\"$COMMONDATAPATH/sounds/build.wav\"/>"
+			"<properties/>"
+			"</parameters>"
+			"<skills>"
+			"<skill><type value=\"stop\"/><name value=\"stop_skill\"/><speed value=\"1000\"/></skill>"
+			"<skill><type value=\"be_built\"/><name value=\"be_built_skill\"/><speed value=\"300\"/></skill>"
+			"<skill><type value=\"die\"/><name value=\"die_skill\"/><speed value=\"300\"/></skill>"
+			"</skills>"
+			"<description>A castle</description>"
+			"</unit>";
+	}
+
+	static void assertSameTree(const XmlNode *expected, const XmlNode *actual) {
+		CPPUNIT_ASSERT( actual != NULL );
+		CPPUNIT_ASSERT_EQUAL( expected->getName(), actual->getName() );
+		CPPUNIT_ASSERT_EQUAL( expected->getText(), actual->getText() );
+		CPPUNIT_ASSERT_EQUAL( expected->getAttributeCount(), actual->getAttributeCount() );
+		for(unsigned int i = 0; i < expected->getAttributeCount(); ++i) {
+			const XmlAttribute *expectedAttribute = expected->getAttribute(i);
+			const XmlAttribute *actualAttribute = actual->getAttribute(i);
+			CPPUNIT_ASSERT_EQUAL( expectedAttribute->getName(), actualAttribute->getName() );
+			CPPUNIT_ASSERT_EQUAL( expectedAttribute->getValue("prefix/"), actualAttribute->getValue("prefix/") );
+		}
+		CPPUNIT_ASSERT_EQUAL( expected->getChildCount(), actual->getChildCount() );
+		for(unsigned int i = 0; i < expected->getChildCount(); ++i) {
+			assertSameTree(expected->getChild(i), actual->getChild(i));
+		}
+	}
+
+	static void writeFile(const string &file, const string &data) {
+		std::ofstream out(file.c_str(), std::ios::binary);
+		out << data;
+	}
+
+public:
+
+	void test_tree_round_trip() {
+		std::map<string,string> mapTagReplacementValues;
+		mapTagReplacementValues["$COMMONDATAPATH"] = "techs/test/commondata/";
+
+		XmlTree xmlTree;
+		xmlTree.loadFromString(getUnitXml(), mapTagReplacementValues);
+
+		string data = XmlBinaryCache::encodeTree(xmlTree.getRootNode());
+		auto_ptr<XmlNode> decoded(XmlBinaryCache::decodeTree(data));
+		assertSameTree(xmlTree.getRootNode(), decoded.get());
+
+		// tags stay replaced and attributes that used them still skip the prefix
+		const XmlAttribute *sound = decoded->getChild("parameters")->getChild("sound")->getAttribute("path");
+		CPPUNIT_ASSERT_EQUAL( string("techs/test/commondata//sounds/build.wav"), sound->getValue("prefix/") );
+		CPPUNIT_ASSERT_EQUAL( string("prefix/images/castle.bmp"),
+				decoded->getChild("parameters")->getChild("image")->getAttribute("path")->getValue("prefix/") );
+	}
+
+	void test_damaged_blob() {
+		std::map<string,string> mapTagReplacementValues;
+		XmlTree xmlTree;
+		xmlTree.loadFromString(getUnitXml(), mapTagReplacementValues);
+		string data = XmlBinaryCache::encodeTree(xmlTree.getRootNode());
+
+		// every truncation has to fail cleanly instead of giving half a tree
+		for(unsigned int size = 0; size < data.size(); ++size) {
+			XmlNode *decoded = XmlBinaryCache::decodeTree(data.substr(0, size));
+			CPPUNIT_ASSERT( decoded == NULL );
+		}
+		CPPUNIT_ASSERT( XmlBinaryCache::decodeTree(data + "x") == NULL );
+
+		string hostile = data;
+		hostile[0] = (char)0x7F;
+		auto_ptr<XmlNode> decoded(XmlBinaryCache::decodeTree(hostile));
+		CPPUNIT_ASSERT( decoded.get() == NULL );
+	}
+
+	void test_cache_file() {
+		const string xmlFile = "xml_binary_cache_test_unit.xml";
+		const string cacheFile = "xml_binary_cache_test.cache";
+		writeFile(xmlFile, getUnitXml());
+		removeFile(cacheFile);
+
+		std::map<string,string> mapTagReplacementValues;
+		mapTagReplacementValues["$COMMONDATAPATH"] = "techs/test/commondata/";
+
+		XmlTree xmlTree;
+		xmlTree.loadFromString(getUnitXml(), mapTagReplacementValues);
+
+		{
+			XmlBinaryCache cache(cacheFile, 1234);
+			CPPUNIT_ASSERT_EQUAL( false, cache.load() );
+			CPPUNIT_ASSERT( cache.getTree(xmlFile, mapTagReplacementValues, false) == NULL );
+
+			XmlTree fileTree;
+			fileTree.load(xmlFile, mapTagReplacementValues);
+			assertSameTree(xmlTree.getRootNode(), fileTree.getRootNode());
+			cache.addTree(xmlFile, mapTagReplacementValues, false, fileTree.getRootNode());
+			CPPUNIT_ASSERT_EQUAL( true, cache.save() );
+		}
+		{
+			XmlBinaryCache cache(cacheFile, 1234);
+			CPPUNIT_ASSERT_EQUAL( true, cache.load() );
+			CPPUNIT_ASSERT_EQUAL( 1, cache.getEntryCount() );
+			auto_ptr<XmlNode> cached(cache.getTree(xmlFile, mapTagReplacementValues, false));
+			assertSameTree(xmlTree.getRootNode(), cached.get());
+
+			// other tags or flags are a different tree
+			std::map<string,string> otherTags;
+			CPPUNIT_ASSERT( cache.getTree(xmlFile, otherTags, false) == NULL );
+			CPPUNIT_ASSERT( cache.getTree(xmlFile, mapTagReplacementValues, true) == NULL );
+			CPPUNIT_ASSERT_EQUAL( 1, cache.getHitCount() );
+			CPPUNIT_ASSERT_EQUAL( 2, cache.getMissCount() );
+		}
+		{
+			// a new techtree CRC drops everything
+			XmlBinaryCache cache(cacheFile, 4321);
+			CPPUNIT_ASSERT_EQUAL( false, cache.load() );
+			CPPUNIT_ASSERT_EQUAL( 0, cache.getEntryCount() );
+		}
+		{
+			// and so does an edited file even if the CRC was not updated
+			writeFile(xmlFile, getUnitXml() + "\n");
+			XmlBinaryCache cache(cacheFile, 1234);
+			CPPUNIT_ASSERT_EQUAL( true, cache.load() );
+			CPPUNIT_ASSERT( cache.getTree(xmlFile, mapTagReplacementValues, false) == NULL );
+		}
+		{
+			// XmlTree::load goes through the active cache
+			XmlBinaryCache cache(cacheFile, 1234);
+			cache.load();
+			XmlBinaryCache::setActive(&cache);
+			for(int i = 0; i < 2; ++i) {
+				XmlTree fileTree;
+				fileTree.load(xmlFile, mapTagReplacementValues);
+				assertSameTree(xmlTree.getRootNode(), fileTree.getRootNode());
+			}
+			XmlBinaryCache::setActive(NULL);
+
+			CPPUNIT_ASSERT_EQUAL( 1, cache.getMissCount() );
+			CPPUNIT_ASSERT_EQUAL( 1, cache.getHitCount() );
+		}
+		{
+			// the cache was not saved and misses again
+			XmlBinaryCache cache(cacheFile, 1234);
+			cache.load();
+			CPPUNIT_ASSERT( cache.getTree(xmlFile, mapTagReplacementValues, false) == NULL );
+		}
+
+		removeFile(xmlFile);
+		removeFile(cacheFile);
+	}
+};
+
+//
+// Parse against cache load times, run with megaglest_tests --benchmark
+//
+class XmlBinaryCacheBenchmark : public XmlBinaryCacheTest {
+	CPPUNIT_TEST_SUITE( XmlBinaryCacheBenchmark );
+
+	CPPUNIT_TEST( test_load_rate );
+
+	CPPUNIT_TEST_SUITE_END();
+
+public:
+
+	void test_load_rate() {
+		// a faction sized file
+		string xml = "<?xml version=\"1.0\" standalone=\"no\"?><faction><units>";
+		for(int i = 0; i < 200; ++i) {
+			xml += getUnitXml().substr(string("<?xml version=\"1.0\" standalone=\"no\"?>").size());
+		}
+		xml += "</units></faction>";
+
+		const string xmlFile = "xml_binary_cache_test_rate.xml";
+		writeFile(xmlFile, xml);
+
+		std::map<string,string> mapTagReplacementValues = Properties::getTagReplacementValues();
+		const int iterations = 20;
+
+		Chrono chronoParse(true);
+		for(int i = 0; i < iterations; ++i) {
+			XmlTree xmlTree;
+			xmlTree.load(xmlFile, mapTagReplacementValues);
+		}
+		int64 parseMicros = chronoParse.getMicros();
+
+		XmlBinaryCache cache("", 0);
+		{
+			XmlTree xmlTree;
+			xmlTree.load(xmlFile, mapTagReplacementValues);
+			cache.addTree(xmlFile, mapTagReplacementValues, false, xmlTree.getRootNode());
+		}
+		Chrono chronoCache(true);
+		for(int i = 0; i < iterations; ++i) {
+			auto_ptr<XmlNode> cached(cache.getTree(xmlFile, mapTagReplacementValues, false));
+			CPPUNIT_ASSERT( cached.get() != NULL );
+		}
+		int64 cacheMicros = chronoCache.getMicros();
+		removeFile(xmlFile);
+
+		printf("\nXML cache benchmark: %d bytes, parse: %.2f msecs per file, cache: %.2f msecs per file\n",
+				(int)xml.size(),
+				parseMicros / 1000.0 / iterations,
+				cacheMicros / 1000.0 / iterations);
+	}
+};
+
+// Suite Registrations
+CPPUNIT_TEST_SUITE_REGISTRATION( XmlBinaryCacheTest );
+CPPUNIT_TEST_SUITE_NAMED_REGISTRATION( XmlBinaryCacheBenchmark, "benchmarks" );
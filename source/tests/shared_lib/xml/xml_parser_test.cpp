@@ -171,6 +171,8 @@ class XmlIoRapidTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST_EXCEPTION( test_load_file_malformed_content,  megaglest_runtime_error );
 	CPPUNIT_TEST_EXCEPTION( test_save_file_null_node,  megaglest_runtime_error );
 	CPPUNIT_TEST(test_save_file_valid_node );
+	CPPUNIT_TEST( test_save_load_string );
+	CPPUNIT_TEST_EXCEPTION( test_load_string_malformed_content,  megaglest_runtime_error );
 
 	CPPUNIT_TEST_SUITE_END();
 	// End of Fixture registration
@@ -230,6 +232,28 @@ public:
 
 		delete rootNode;
 	}
+
+	void test_save_load_string() {
+		XmlNode rootNode("saved-game");
+		rootNode.addAttribute("version","v1", std::map<string,string>());
+		XmlNode *childNode = rootNode.addChild("Game");
+		childNode->addAttribute("frame","42", std::map<string,string>());
+
+		string xmlData = XmlIoRapid::getInstance().saveToString(&rootNode);
+		CPPUNIT_ASSERT( xmlData.empty() == false );
+
+		XmlNode *loadedNode = XmlIoRapid::getInstance().loadFromString(xmlData, std::map<string,string>());
+		CPPUNIT_ASSERT( loadedNode != NULL );
+		CPPUNIT_ASSERT_EQUAL( string("saved-game"), loadedNode->getName() );
+		CPPUNIT_ASSERT_EQUAL( string("v1"), loadedNode->getAttribute("version")->getValue() );
+		CPPUNIT_ASSERT_EQUAL( 42, loadedNode->getChild("Game")->getAttribute("frame")->getIntValue() );
+
+		delete loadedNode;
+	}
+	void test_load_string_malformed_content() {
+		XmlNode *rootNode = XmlIoRapid::getInstance().loadFromString("<menu><button></menu>", std::map<string,string>());
+		delete rootNode;
+	}
 };
 
 //
@@ -245,6 +269,7 @@ class XmlTreeTest : public CppUnit::TestFixture {
 	CPPUNIT_TEST( test_init );
 	CPPUNIT_TEST_EXCEPTION( test_load_simultaneously_same_file,  megaglest_runtime_error );
 	CPPUNIT_TEST( test_load_simultaneously_different_file );
+	CPPUNIT_TEST( test_save_load_string );
 
 	CPPUNIT_TEST_SUITE_END();
 	// End of Fixture registration
@@ -314,6 +339,17 @@ public:
 		XmlTree xmlInstance2;
 		xmlInstance2.load(test_filename2, std::map<string,string>());
 	}
+	void test_save_load_string() {
+		XmlTree xmlInstance;
+		xmlInstance.init("testRoot");
+		xmlInstance.getRootNode()->addChild("child");
+
+		XmlTree xmlLoaded;
+		xmlLoaded.loadFromString(xmlInstance.saveToString(), std::map<string,string>());
+		CPPUNIT_ASSERT( xmlLoaded.getRootNode() != NULL );
+		CPPUNIT_ASSERT_EQUAL( string("testRoot"), xmlLoaded.getRootNode()->getName() );
+		CPPUNIT_ASSERT_EQUAL( (unsigned int)1, (unsigned int)xmlLoaded.getRootNode()->getChildCount() );
+	}
 };
 
 
@@ -12,12 +12,24 @@
 #include <cppunit/CompilerOutputter.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
 #include <cppunit/ui/text/TestRunner.h>
+#include <string.h>
 
 
 int main(int argc, char* argv[])
 {
+  // Timings are registered as "benchmarks" and only run with --benchmark,
+  // the unit tests stay quiet
+  bool runBenchmarks = false;
+  for(int i = 1; i < argc; ++i) {
+    if(strcmp(argv[i], "--benchmark") == 0) {
+      runBenchmarks = true;
+    }
+  }
+
   // Get the top level suite from the registry
-  CppUnit::Test *suite = CppUnit::TestFactoryRegistry::getRegistry().makeTest();
+  CppUnit::Test *suite = (runBenchmarks == true ?
+		  CppUnit::TestFactoryRegistry::getRegistry("benchmarks").makeTest() :
+		  CppUnit::TestFactoryRegistry::getRegistry().makeTest());
 
   // Adds the test to the list of test to run
   CppUnit::TextUi::TestRunner runner;